@@ -10,7 +10,10 @@
 #include <getopt.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <net/if.h>
+#include <sys/utsname.h>
 
 #include <rte_eal.h>
 #include <rte_alarm.h>
@@ -27,6 +30,10 @@
 #include <rte_ring.h>
 #include <rte_string_fns.h>
 #include <rte_pdump.h>
+#ifdef RTE_LIBRTE_PCAPNG
+#include <rte_pcapng.h>
+#endif
+#include <rte_version.h>
 
 #define CMD_LINE_OPT_PDUMP "pdump"
 #define CMD_LINE_OPT_PDUMP_NUM 256
@@ -41,6 +48,7 @@
 #define PDUMP_RING_SIZE_ARG "ring-size"
 #define PDUMP_MSIZE_ARG "mbuf-size"
 #define PDUMP_NUM_MBUFS_ARG "total-num-mbufs"
+#define PDUMP_FORMAT_ARG "format"
 
 #define VDEV_NAME_FMT "net_pcap_%s_%d"
 #define VDEV_PCAP_ARGS_FMT "tx_pcap=%s"
@@ -55,6 +63,9 @@
 #define RX_STR "rx"
 #define TX_STR "tx"
 
+#define FORMAT_PCAP_STR "pcap"
+#define FORMAT_PCAPNG_STR "pcapng"
+
 /* Maximum long option length for option parsing. */
 #define APP_ARG_TCPDUMP_MAX_TUPLES 54
 #define MBUF_POOL_CACHE_SIZE 250
@@ -87,6 +98,11 @@ enum pdump_by {
 	DEVICE_ID = 2
 };
 
+enum pdump_format {
+	FORMAT_PCAP = 0,
+	FORMAT_PCAPNG = 1
+};
+
 static const char * const valid_pdump_arguments[] = {
 	PDUMP_PORT_ARG,
 	PDUMP_PCI_ARG,
@@ -97,6 +113,7 @@ static const char * const valid_pdump_arguments[] = {
 	PDUMP_RING_SIZE_ARG,
 	PDUMP_MSIZE_ARG,
 	PDUMP_NUM_MBUFS_ARG,
+	PDUMP_FORMAT_ARG,
 	NULL
 };
 
@@ -116,6 +133,7 @@ struct pdump_tuples {
 	uint32_t ring_size;
 	uint16_t mbuf_data_size;
 	uint32_t total_num_mbufs;
+	enum pdump_format format;
 
 	/* params for library API call */
 	uint32_t dir;
@@ -131,6 +149,10 @@ struct pdump_tuples {
 	enum pcap_stream tx_vdev_stream_type;
 	bool single_pdump_dev;
 
+	/* pcapng writers, used instead of vdevs for the pcapng format */
+	struct rte_pcapng *rx_pcapng;
+	struct rte_pcapng *tx_pcapng;
+
 	/* stats */
 	struct pdump_stats stats;
 } __rte_cache_aligned;
@@ -160,7 +182,8 @@ pdump_usage(const char *prgname)
 			" tx-dev=<iface or pcap file>,"
 			"[ring-size=<ring size>default:16384],"
 			"[mbuf-size=<mbuf data size>default:2176],"
-			"[total-num-mbufs=<number of mbufs>default:65535]'\n",
+			"[total-num-mbufs=<number of mbufs>default:65535],"
+			"[format=<pcap or pcapng>default:pcap]'\n",
 			prgname);
 }
 
@@ -212,6 +235,27 @@ parse_rxtxdev(const char *key, const char *value, void *extra_args)
 	return 0;
 }
 
+static int
+parse_format(const char *key, const char *value, void *extra_args)
+{
+	struct pdump_tuples *pt = extra_args;
+
+	if (!strcmp(value, FORMAT_PCAP_STR))
+		pt->format = FORMAT_PCAP;
+#ifdef RTE_LIBRTE_PCAPNG
+	else if (!strcmp(value, FORMAT_PCAPNG_STR))
+		pt->format = FORMAT_PCAPNG;
+#endif
+	else {
+		printf("invalid value:\"%s\" for key:\"%s\", "
+			"value must be %s or %s\n", value, key,
+			FORMAT_PCAP_STR, FORMAT_PCAPNG_STR);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static int
 parse_uint_value(const char *key, const char *value, void *extra_args)
 {
@@ -370,6 +414,25 @@ parse_pdump(const char *optarg)
 	} else
 		pt->total_num_mbufs = MBUFS_PER_POOL;
 
+	/* format parsing and validation */
+	cnt1 = rte_kvargs_count(kvlist, PDUMP_FORMAT_ARG);
+	if (cnt1 == 1) {
+		ret = rte_kvargs_process(kvlist, PDUMP_FORMAT_ARG,
+						&parse_format, pt);
+		if (ret < 0)
+			goto free_kvlist;
+	} else
+		pt->format = FORMAT_PCAP;
+
+	if (pt->format == FORMAT_PCAPNG &&
+			(pt->rx_vdev_stream_type == IFACE ||
+			 pt->tx_vdev_stream_type == IFACE)) {
+		printf("--pdump=\"%s\": pcapng format can only be "
+			"written to a file\n", optarg);
+		ret = -1;
+		goto free_kvlist;
+	}
+
 	num_tuples++;
 
 free_kvlist:
@@ -459,7 +522,8 @@ disable_pdump(struct pdump_tuples *pt)
 }
 
 static inline void
-pdump_rxtx(struct rte_ring *ring, uint16_t vdev_id, struct pdump_stats *stats)
+pdump_rxtx(struct rte_ring *ring, uint16_t vdev_id, struct rte_pcapng *pcapng,
+	struct pdump_stats *stats)
 {
 	/* write input packets of port to vdev for pdump */
 	struct rte_mbuf *rxtx_bufs[BURST_SIZE];
@@ -469,6 +533,24 @@ pdump_rxtx(struct rte_ring *ring, uint16_t vdev_id, struct pdump_stats *stats)
 			(void *)rxtx_bufs, BURST_SIZE, NULL);
 	stats->dequeue_pkts += nb_in_deq;
 
+#ifdef RTE_LIBRTE_PCAPNG
+	if (nb_in_deq && pcapng) {
+		uint16_t i;
+
+		/* the whole burst goes to the file in one write */
+		if (rte_pcapng_write_packets(pcapng, rxtx_bufs,
+				nb_in_deq) < 0)
+			stats->freed_pkts += nb_in_deq;
+		else
+			stats->tx_pkts += nb_in_deq;
+		for (i = 0; i < nb_in_deq; i++)
+			rte_pktmbuf_free(rxtx_bufs[i]);
+		return;
+	}
+#else
+	RTE_SET_USED(pcapng);
+#endif
+
 	if (nb_in_deq) {
 		/* then sent on vdev */
 		uint16_t nb_in_txd = rte_eth_tx_burst(
@@ -487,10 +569,10 @@ pdump_rxtx(struct rte_ring *ring, uint16_t vdev_id, struct pdump_stats *stats)
 
 static void
 free_ring_data(struct rte_ring *ring, uint16_t vdev_id,
-		struct pdump_stats *stats)
+		struct rte_pcapng *pcapng, struct pdump_stats *stats)
 {
 	while (rte_ring_count(ring))
-		pdump_rxtx(ring, vdev_id, stats);
+		pdump_rxtx(ring, vdev_id, pcapng, stats);
 }
 
 static void
@@ -532,9 +614,21 @@ cleanup_pdump_resources(void)
 		* the vdev, in order to release mbufs to the mepool.
 		**/
 		if (pt->dir & RTE_PDUMP_FLAG_RX)
-			free_ring_data(pt->rx_ring, pt->rx_vdev_id, &pt->stats);
+			free_ring_data(pt->rx_ring, pt->rx_vdev_id,
+					pt->rx_pcapng, &pt->stats);
 		if (pt->dir & RTE_PDUMP_FLAG_TX)
-			free_ring_data(pt->tx_ring, pt->tx_vdev_id, &pt->stats);
+			free_ring_data(pt->tx_ring, pt->tx_vdev_id,
+					pt->tx_pcapng, &pt->stats);
+
+#ifdef RTE_LIBRTE_PCAPNG
+		/* Close the pcapng file(s) written */
+		if (pt->format == FORMAT_PCAPNG) {
+			rte_pcapng_close(pt->rx_pcapng);
+			if (!pt->single_pdump_dev)
+				rte_pcapng_close(pt->tx_pcapng);
+			continue;
+		}
+#endif
 
 		/* Remove the vdev(s) created */
 		if (pt->dir & RTE_PDUMP_FLAG_RX) {
@@ -619,6 +713,100 @@ configure_vdev(uint16_t port_id)
 	return 0;
 }
 
+#ifdef RTE_LIBRTE_PCAPNG
+static struct rte_pcapng *
+create_pcapng(const char *path, uint16_t port)
+{
+	struct rte_pcapng *pcapng;
+	struct utsname uts;
+	char osname[SIZE];
+	int fd;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return NULL;
+
+	if (uname(&uts) < 0)
+		strlcpy(osname, "unknown", sizeof(osname));
+	else
+		snprintf(osname, sizeof(osname), "%s %s",
+			 uts.sysname, uts.release);
+
+	pcapng = rte_pcapng_fdopen(fd, osname, NULL, rte_version(), NULL);
+	if (pcapng == NULL) {
+		close(fd);
+		return NULL;
+	}
+
+	if (rte_pcapng_add_interface(pcapng, port, NULL, NULL) < 0) {
+		rte_pcapng_close(pcapng);
+		return NULL;
+	}
+
+	return pcapng;
+}
+
+static void
+create_pcapng_writers(struct pdump_tuples *pt, int i)
+{
+	char ring_name[SIZE];
+
+	if (pt->dump_by_type == DEVICE_ID &&
+			rte_eth_dev_get_port_by_name(pt->device_id,
+						     &pt->port) != 0) {
+		cleanup_rings();
+		rte_exit(EXIT_FAILURE, "cannot find device %s:%s:%d\n",
+			pt->device_id, __func__, __LINE__);
+	}
+
+	if (pt->dir & RTE_PDUMP_FLAG_RX) {
+		snprintf(ring_name, SIZE, RX_RING, i);
+		pt->rx_ring = rte_ring_create(ring_name, pt->ring_size,
+				rte_socket_id(), 0);
+		if (pt->rx_ring == NULL) {
+			cleanup_rings();
+			rte_exit(EXIT_FAILURE, "%s:%s:%d\n",
+					rte_strerror(rte_errno),
+					__func__, __LINE__);
+		}
+
+		pt->rx_pcapng = create_pcapng(pt->rx_dev, pt->port);
+		if (pt->rx_pcapng == NULL) {
+			cleanup_rings();
+			rte_exit(EXIT_FAILURE,
+				"pcapng file %s creation failed:%s:%d\n",
+				pt->rx_dev, __func__, __LINE__);
+		}
+	}
+
+	if (pt->dir & RTE_PDUMP_FLAG_TX) {
+		snprintf(ring_name, SIZE, TX_RING, i);
+		pt->tx_ring = rte_ring_create(ring_name, pt->ring_size,
+				rte_socket_id(), 0);
+		if (pt->tx_ring == NULL) {
+			cleanup_rings();
+			rte_exit(EXIT_FAILURE, "%s:%s:%d\n",
+					rte_strerror(rte_errno),
+					__func__, __LINE__);
+		}
+
+		/* both directions are written to the same file */
+		if (pt->single_pdump_dev) {
+			pt->tx_pcapng = pt->rx_pcapng;
+			return;
+		}
+
+		pt->tx_pcapng = create_pcapng(pt->tx_dev, pt->port);
+		if (pt->tx_pcapng == NULL) {
+			cleanup_rings();
+			rte_exit(EXIT_FAILURE,
+				"pcapng file %s creation failed:%s:%d\n",
+				pt->tx_dev, __func__, __LINE__);
+		}
+	}
+}
+#endif
+
 static void
 create_mp_ring_vdev(void)
 {
@@ -651,6 +839,13 @@ create_mp_ring_vdev(void)
 		}
 		pt->mp = mbuf_pool;
 
+#ifdef RTE_LIBRTE_PCAPNG
+		if (pt->format == FORMAT_PCAPNG) {
+			create_pcapng_writers(pt, i);
+			continue;
+		}
+#endif
+
 		if (pt->dir == RTE_PDUMP_FLAG_RXTX) {
 			/* if captured packets has to send to the same vdev */
 			/* create rx_ring */
@@ -818,29 +1013,32 @@ enable_pdump(void)
 	int i;
 	struct pdump_tuples *pt;
 	int ret = 0, ret1 = 0;
+	uint32_t flags;
 
 	for (i = 0; i < num_tuples; i++) {
 		pt = &pdump_t[i];
+		flags = (pt->format == FORMAT_PCAPNG) ?
+				RTE_PDUMP_FLAG_PCAPNG : 0;
 		if (pt->dir == RTE_PDUMP_FLAG_RXTX) {
 			if (pt->dump_by_type == DEVICE_ID) {
 				ret = rte_pdump_enable_by_deviceid(
 						pt->device_id,
 						pt->queue,
-						RTE_PDUMP_FLAG_RX,
+						RTE_PDUMP_FLAG_RX | flags,
 						pt->rx_ring,
 						pt->mp, NULL);
 				ret1 = rte_pdump_enable_by_deviceid(
 						pt->device_id,
 						pt->queue,
-						RTE_PDUMP_FLAG_TX,
+						RTE_PDUMP_FLAG_TX | flags,
 						pt->tx_ring,
 						pt->mp, NULL);
 			} else if (pt->dump_by_type == PORT_ID) {
 				ret = rte_pdump_enable(pt->port, pt->queue,
-						RTE_PDUMP_FLAG_RX,
+						RTE_PDUMP_FLAG_RX | flags,
 						pt->rx_ring, pt->mp, NULL);
 				ret1 = rte_pdump_enable(pt->port, pt->queue,
-						RTE_PDUMP_FLAG_TX,
+						RTE_PDUMP_FLAG_TX | flags,
 						pt->tx_ring, pt->mp, NULL);
 			}
 		} else if (pt->dir == RTE_PDUMP_FLAG_RX) {
@@ -848,22 +1046,22 @@ enable_pdump(void)
 				ret = rte_pdump_enable_by_deviceid(
 						pt->device_id,
 						pt->queue,
-						pt->dir, pt->rx_ring,
+						pt->dir | flags, pt->rx_ring,
 						pt->mp, NULL);
 			else if (pt->dump_by_type == PORT_ID)
 				ret = rte_pdump_enable(pt->port, pt->queue,
-						pt->dir,
+						pt->dir | flags,
 						pt->rx_ring, pt->mp, NULL);
 		} else if (pt->dir == RTE_PDUMP_FLAG_TX) {
 			if (pt->dump_by_type == DEVICE_ID)
 				ret = rte_pdump_enable_by_deviceid(
 						pt->device_id,
 						pt->queue,
-						pt->dir,
+						pt->dir | flags,
 						pt->tx_ring, pt->mp, NULL);
 			else if (pt->dump_by_type == PORT_ID)
 				ret = rte_pdump_enable(pt->port, pt->queue,
-						pt->dir,
+						pt->dir | flags,
 						pt->tx_ring, pt->mp, NULL);
 		}
 		if (ret < 0 || ret1 < 0) {
@@ -877,9 +1075,11 @@ static inline void
 pdump_packets(struct pdump_tuples *pt)
 {
 	if (pt->dir & RTE_PDUMP_FLAG_RX)
-		pdump_rxtx(pt->rx_ring, pt->rx_vdev_id, &pt->stats);
+		pdump_rxtx(pt->rx_ring, pt->rx_vdev_id, pt->rx_pcapng,
+				&pt->stats);
 	if (pt->dir & RTE_PDUMP_FLAG_TX)
-		pdump_rxtx(pt->tx_ring, pt->tx_vdev_id, &pt->stats);
+		pdump_rxtx(pt->tx_ring, pt->tx_vdev_id, pt->tx_pcapng,
+				&pt->stats);
 }
 
 static int
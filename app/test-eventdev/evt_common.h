@@ -69,6 +69,10 @@ struct evt_options {
 	enum evt_prod_type prod_type;
 	uint8_t timdev_use_burst;
 	uint8_t timdev_cnt;
+	uint8_t ena_vector;
+	uint16_t vector_size;
+	uint64_t vector_tmo_nsec;
+	uint8_t nb_sched_lcores;
 };
 
 static inline bool
@@ -103,39 +107,59 @@ evt_has_all_types_queue(uint8_t dev_id)
 }
 
 static inline int
-evt_service_setup(uint32_t service_id)
+evt_service_setup_lcores(uint32_t service_id, uint8_t nb_lcores)
 {
 	int32_t core_cnt;
+	int32_t i;
 	unsigned int lcore = 0;
 	uint32_t core_array[RTE_MAX_LCORE];
 	uint8_t cnt;
-	uint8_t min_cnt = UINT8_MAX;
+	uint8_t min_cnt;
 
 	if (!rte_service_lcore_count())
 		return -ENOENT;
 
+	/* Running a service on several cores needs it to be MT safe. */
+	if (nb_lcores > 1 && rte_service_probe_capability(service_id,
+				RTE_SERVICE_CAP_MT_SAFE) != 1)
+		return -ENOTSUP;
+
 	core_cnt = rte_service_lcore_list(core_array,
 			RTE_MAX_LCORE);
-	if (core_cnt < 0)
+	if (core_cnt < 0 || core_cnt < nb_lcores)
 		return -ENOENT;
-	/* Get the core which has least number of services running. */
-	while (core_cnt--) {
-		/* Reset default mapping */
-		rte_service_map_lcore_set(service_id,
-				core_array[core_cnt], 0);
-		cnt = rte_service_lcore_count_services(
-				core_array[core_cnt]);
-		if (cnt < min_cnt) {
-			lcore = core_array[core_cnt];
-			min_cnt = cnt;
+
+	/* Reset default mapping */
+	for (i = 0; i < core_cnt; i++)
+		rte_service_map_lcore_set(service_id, core_array[i], 0);
+
+	while (nb_lcores--) {
+		/* Get the core which has least number of services running. */
+		min_cnt = UINT8_MAX;
+		for (i = core_cnt - 1; i >= 0; i--) {
+			if (rte_service_map_lcore_get(service_id,
+						core_array[i]) == 1)
+				continue;
+			cnt = rte_service_lcore_count_services(
+					core_array[i]);
+			if (cnt < min_cnt) {
+				lcore = core_array[i];
+				min_cnt = cnt;
+			}
 		}
+		if (rte_service_map_lcore_set(service_id, lcore, 1))
+			return -ENOENT;
 	}
-	if (rte_service_map_lcore_set(service_id, lcore, 1))
-		return -ENOENT;
 
 	return 0;
 }
 
+static inline int
+evt_service_setup(uint32_t service_id)
+{
+	return evt_service_setup_lcores(service_id, 1);
+}
+
 static inline int
 evt_configure_eventdev(struct evt_options *opt, uint8_t nb_queues,
 		uint8_t nb_ports)
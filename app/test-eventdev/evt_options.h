@@ -40,6 +40,10 @@
 #define EVT_TIMER_TICK_NSEC      ("timer_tick_nsec")
 #define EVT_MAX_TMO_NSEC         ("max_tmo_nsec")
 #define EVT_EXPIRY_NSEC          ("expiry_nsec")
+#define EVT_ENA_VECTOR           ("enable_vector")
+#define EVT_VECTOR_SZ            ("vector_size")
+#define EVT_VECTOR_TMO           ("vector_tmo_ns")
+#define EVT_SCHED_LCORES         ("sched_lcores")
 #define EVT_HELP                 ("help")
 
 void evt_options_default(struct evt_options *opt);
@@ -246,6 +250,11 @@ evt_dump_producer_type(struct evt_options *opt)
 		snprintf(name, EVT_PROD_MAX_NAME_LEN,
 				"Ethdev Rx Adapter producers");
 		evt_dump("nb_ethdev", "%d", rte_eth_dev_count_avail());
+		if (opt->ena_vector) {
+			evt_dump("vector_size", "%d", opt->vector_size);
+			evt_dump("vector_tmo_ns", "%"PRIu64"",
+					opt->vector_tmo_nsec);
+		}
 		break;
 	case EVT_PROD_TYPE_EVENT_TIMER_ADPTR:
 		if (opt->timdev_use_burst)
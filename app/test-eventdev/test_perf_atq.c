@@ -214,9 +214,11 @@ perf_atq_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	if (!evt_has_distributed_sched(opt->dev_id)) {
 		uint32_t service_id;
 		rte_event_dev_service_id_get(opt->dev_id, &service_id);
-		ret = evt_service_setup(service_id);
+		ret = evt_service_setup_lcores(service_id,
+				opt->nb_sched_lcores);
 		if (ret) {
-			evt_err("No service lcore found to run event dev.");
+			evt_err("Failed to map event dev service to %d service lcore(s).",
+					opt->nb_sched_lcores);
 			return ret;
 		}
 	}
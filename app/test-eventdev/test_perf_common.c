@@ -462,10 +462,23 @@ perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 				const struct rte_event_port_conf *port_conf)
 {
 	struct test_perf *t = evt_test_priv(test);
-	uint16_t port, prod;
+	uint8_t queues[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint16_t nb_links, nb_groups;
+	uint16_t port, prod, queue;
 	int ret = -1;
 
-	/* setup one port per worker, linking to all queues */
+	/*
+	 * With several service lcores scheduling, the workers are split in
+	 * groups, each one linked to the queues of its own producers, so that
+	 * the scheduler can spread the groups over its service lcores. The
+	 * events of a producer only go through the queues of its stride.
+	 */
+	nb_groups = RTE_MIN(opt->nb_sched_lcores, nb_queues / stride);
+	nb_groups = RTE_MIN(nb_groups, evt_nr_active_lcores(opt->wlcores));
+	if (evt_has_distributed_sched(opt->dev_id) || nb_groups == 0)
+		nb_groups = 1;
+
+	/* setup one port per worker, linking to the queues of its group */
 	for (port = 0; port < evt_nr_active_lcores(opt->wlcores);
 				port++) {
 		struct worker_data *w = &t->worker[port];
@@ -482,9 +495,26 @@ perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
 			return ret;
 		}
 
-		ret = rte_event_port_link(opt->dev_id, port, NULL, NULL, 0);
-		if (ret != nb_queues) {
-			evt_err("failed to link all queues to port %d", port);
+		if (nb_groups == 1) {
+			ret = rte_event_port_link(opt->dev_id, port, NULL,
+					NULL, 0);
+			if (ret != nb_queues) {
+				evt_err("failed to link all queues to port %d",
+						port);
+				return -EINVAL;
+			}
+			continue;
+		}
+
+		nb_links = 0;
+		for (queue = 0; queue < nb_queues; queue++)
+			if ((queue / stride) % nb_groups == port % nb_groups)
+				queues[nb_links++] = queue;
+
+		ret = rte_event_port_link(opt->dev_id, port, queues, NULL,
+				nb_links);
+		if (ret != nb_links) {
+			evt_err("failed to link group queues to port %d", port);
 			return -EINVAL;
 		}
 	}
@@ -631,6 +661,8 @@ perf_opt_dump(struct evt_options *opt, uint8_t nb_queues)
 	evt_dump_queue_priority(opt);
 	evt_dump_sched_type_list(opt);
 	evt_dump_producer_type(opt);
+	if (!evt_has_distributed_sched(opt->dev_id))
+		evt_dump("nb_sched_lcores", "%d", opt->nb_sched_lcores);
 }
 
 void
@@ -150,6 +150,11 @@ pipeline_opt_check(struct evt_options *opt, uint64_t nb_queues)
 	if (evt_has_invalid_sched_type(opt))
 		return -1;
 
+	if (opt->ena_vector && !opt->vector_size) {
+		evt_err("vector_size must be non zero");
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -176,7 +181,6 @@ pipeline_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 		},
 	};
 
-	RTE_SET_USED(opt);
 	if (!rte_eth_dev_count_avail()) {
 		evt_err("No ethernet ports found.");
 		return -ENODEV;
@@ -236,6 +240,11 @@ pipeline_ethdev_setup(struct evt_test *test, struct evt_options *opt)
 		rte_eth_promiscuous_enable(i);
 	}
 
+	if (opt->ena_vector && t->internal_port) {
+		evt_err("event vectorization needs the Tx adapter service");
+		return -ENOTSUP;
+	}
+
 	return 0;
 }
 
@@ -278,7 +287,8 @@ pipeline_event_port_setup(struct evt_test *test, struct evt_options *opt,
 
 int
 pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
-		struct rte_event_port_conf prod_conf)
+		struct rte_event_port_conf prod_conf,
+		struct rte_mempool *vector_pool)
 {
 	int ret = 0;
 	uint16_t prod;
@@ -287,7 +297,15 @@ pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
 	memset(&queue_conf, 0,
 			sizeof(struct rte_event_eth_rx_adapter_queue_conf));
 	queue_conf.ev.sched_type = opt->sched_type_list[0];
+	if (opt->ena_vector) {
+		queue_conf.rx_queue_flags |=
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+		queue_conf.vector_sz = opt->vector_size;
+		queue_conf.vector_timeout_ns = opt->vector_tmo_nsec;
+		queue_conf.vector_mp = vector_pool;
+	}
 	RTE_ETH_FOREACH_DEV(prod) {
+		struct rte_event_eth_rx_adapter_vector_limits limits;
 		uint32_t cap;
 
 		ret = rte_event_eth_rx_adapter_caps_get(opt->dev_id,
@@ -298,6 +316,40 @@ pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
 					opt->dev_id);
 			return ret;
 		}
+
+		if (opt->ena_vector) {
+			if (!(cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR)) {
+				evt_err("event vectorization is not supported"
+						" by rx adapter[%d]", prod);
+				return -ENOTSUP;
+			}
+
+			ret = rte_event_eth_rx_adapter_vector_limits_get(
+					opt->dev_id, prod, &limits);
+			if (ret) {
+				evt_err("failed to get vector limits");
+				return ret;
+			}
+
+			if (opt->vector_size < limits.min_sz ||
+					opt->vector_size > limits.max_sz) {
+				evt_err("vector_size %d out of range [%d, %d]",
+						opt->vector_size,
+						limits.min_sz, limits.max_sz);
+				return -EINVAL;
+			}
+
+			if (opt->vector_tmo_nsec < limits.min_timeout_ns ||
+					opt->vector_tmo_nsec >
+					limits.max_timeout_ns) {
+				evt_err("vector_tmo_ns %"PRIu64" out of range"
+						" [%"PRIu64", %"PRIu64"]",
+						opt->vector_tmo_nsec,
+						limits.min_timeout_ns,
+						limits.max_timeout_ns);
+				return -EINVAL;
+			}
+		}
 		queue_conf.ev.queue_id = prod * stride;
 		ret = rte_event_eth_rx_adapter_create(prod, opt->dev_id,
 				&prod_conf);
@@ -424,6 +476,22 @@ pipeline_mempool_setup(struct evt_test *test, struct evt_options *opt)
 		return -ENOMEM;
 	}
 
+	if (opt->ena_vector) {
+		char name[RTE_MEMPOOL_NAMESIZE];
+		unsigned int nb_elem;
+
+		/* partial vectors of all the queues and the vectors in flight */
+		nb_elem = RTE_MAX(opt->pool_sz / opt->vector_size, 1) * 2;
+		snprintf(name, sizeof(name), "%s_vector", test->name);
+		t->vector_pool = rte_event_vector_pool_create(name, nb_elem, 0,
+				opt->vector_size, opt->socket_id);
+		if (t->vector_pool == NULL) {
+			evt_err("failed to create vector mempool");
+			rte_mempool_free(t->pool);
+			return -ENOMEM;
+		}
+	}
+
 	return 0;
 }
 
@@ -434,6 +502,7 @@ pipeline_mempool_destroy(struct evt_test *test, struct evt_options *opt)
 	struct test_pipeline *t = evt_test_priv(test);
 
 	rte_mempool_free(t->pool);
+	rte_mempool_free(t->vector_pool);
 }
 
 int
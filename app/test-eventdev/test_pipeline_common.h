@@ -48,6 +48,7 @@ struct test_pipeline {
 	uint32_t nb_flows;
 	uint64_t outstand_pkts;
 	struct rte_mempool *pool;
+	struct rte_mempool *vector_pool;
 	struct worker_data worker[EVT_MAX_PORTS];
 	struct evt_options *opt;
 	uint8_t sched_type_list[EVT_MAX_STAGES] __rte_cache_aligned;
@@ -101,6 +102,14 @@ pipeline_fwd_event(struct rte_event *ev, uint8_t sched)
 	ev->sched_type = sched;
 }
 
+static __rte_always_inline void
+pipeline_fwd_event_vector(struct rte_event *ev, uint8_t sched)
+{
+	ev->event_type = RTE_EVENT_TYPE_CPU_VECTOR;
+	ev->op = RTE_EVENT_OP_FORWARD;
+	ev->sched_type = sched;
+}
+
 static __rte_always_inline void
 pipeline_event_tx(const uint8_t dev, const uint8_t port,
 		struct rte_event * const ev)
@@ -144,6 +153,43 @@ pipeline_event_enqueue_burst(const uint8_t dev, const uint8_t port,
 	}
 }
 
+/*
+ * The Tx adapter handles mbuf events only: split a vector event into NEW
+ * events to the Tx queues and release it, returns the number of packets.
+ */
+static __rte_always_inline uint16_t
+pipeline_event_vector_tx(const uint8_t dev, const uint8_t port,
+		struct rte_event *ev, const uint8_t *tx_queue)
+{
+	struct rte_event_vector *vec = ev->vec;
+	struct rte_event tx_ev[BURST_SIZE];
+	const uint16_t nb_elem = vec->nb_elem;
+	struct rte_mbuf *m;
+	uint16_t i, j, n;
+
+	for (i = 0; i < nb_elem; i += n) {
+		n = RTE_MIN(nb_elem - i, BURST_SIZE);
+		for (j = 0; j < n; j++) {
+			m = vec->mbufs[i + j];
+			rte_event_eth_tx_adapter_txq_set(m, 0);
+			tx_ev[j].event = 0;
+			tx_ev[j].flow_id = ev->flow_id;
+			tx_ev[j].queue_id = tx_queue[m->port];
+			tx_ev[j].op = RTE_EVENT_OP_NEW;
+			tx_ev[j].event_type = RTE_EVENT_TYPE_CPU;
+			tx_ev[j].sched_type = RTE_SCHED_TYPE_ATOMIC;
+			tx_ev[j].mbuf = m;
+		}
+		pipeline_event_enqueue_burst(dev, port, tx_ev, n);
+	}
+
+	rte_mempool_put(rte_mempool_from_obj(vec), vec);
+	ev->op = RTE_EVENT_OP_RELEASE;
+	pipeline_event_enqueue(dev, port, ev);
+
+	return nb_elem;
+}
+
 static inline int
 pipeline_nb_event_ports(struct evt_options *opt)
 {
@@ -155,7 +201,8 @@ int pipeline_opt_check(struct evt_options *opt, uint64_t nb_queues);
 int pipeline_test_setup(struct evt_test *test, struct evt_options *opt);
 int pipeline_ethdev_setup(struct evt_test *test, struct evt_options *opt);
 int pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
-		struct rte_event_port_conf prod_conf);
+		struct rte_event_port_conf prod_conf,
+		struct rte_mempool *vector_pool);
 int pipeline_event_tx_adapter_setup(struct evt_options *opt,
 		struct rte_event_port_conf prod_conf);
 int pipeline_mempool_setup(struct evt_test *test, struct evt_options *opt);
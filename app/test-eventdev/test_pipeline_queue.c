@@ -192,6 +192,57 @@ pipeline_queue_worker_multi_stage_fwd(void *arg)
 	return 0;
 }
 
+static __rte_noinline int
+pipeline_queue_worker_single_stage_fwd_vector(void *arg)
+{
+	PIPELINE_WORKER_SINGLE_STAGE_INIT;
+	const uint8_t *tx_queue = t->tx_evqueue_id;
+
+	while (t->done == false) {
+		uint16_t event = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
+
+		if (!event) {
+			rte_pause();
+			continue;
+		}
+
+		w->processed_pkts += pipeline_event_vector_tx(dev, port, &ev,
+				tx_queue);
+	}
+
+	return 0;
+}
+
+static __rte_noinline int
+pipeline_queue_worker_multi_stage_fwd_vector(void *arg)
+{
+	PIPELINE_WORKER_MULTI_STAGE_INIT;
+	const uint8_t *tx_queue = t->tx_evqueue_id;
+
+	while (t->done == false) {
+		uint16_t event = rte_event_dequeue_burst(dev, port, &ev, 1, 0);
+
+		if (!event) {
+			rte_pause();
+			continue;
+		}
+
+		cq_id = ev.queue_id % nb_stages;
+
+		if (cq_id == last_queue) {
+			w->processed_pkts += pipeline_event_vector_tx(dev,
+					port, &ev, tx_queue);
+			continue;
+		}
+
+		ev.queue_id++;
+		pipeline_fwd_event_vector(&ev, sched_type_list[cq_id]);
+		pipeline_event_enqueue(dev, port, &ev);
+	}
+
+	return 0;
+}
+
 static __rte_noinline int
 pipeline_queue_worker_multi_stage_burst_tx(void *arg)
 {
@@ -278,6 +329,16 @@ worker_wrapper(void *arg)
 	const uint8_t nb_stages = opt->nb_stages;
 	RTE_SET_USED(opt);
 
+	/* vector events carry a burst of packets, dequeue them one by one */
+	if (opt->ena_vector) {
+		if (nb_stages == 1)
+			return pipeline_queue_worker_single_stage_fwd_vector(
+					arg);
+		else
+			return pipeline_queue_worker_multi_stage_fwd_vector(
+					arg);
+	}
+
 	if (nb_stages == 1) {
 		if (!burst && internal_port)
 			return pipeline_queue_worker_single_stage_tx(arg);
@@ -407,7 +468,8 @@ pipeline_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
 	 *	q2, q5 configured as ATOMIC | SINGLE_LINK
 	 *
 	 */
-	ret = pipeline_event_rx_adapter_setup(opt, nb_stages + 1, p_conf);
+	ret = pipeline_event_rx_adapter_setup(opt, nb_stages + 1, p_conf,
+			t->vector_pool);
 	if (ret)
 		return ret;
 
@@ -392,6 +392,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "GRO autotest",
+        "Command": "gro_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Hash function autotest",
         "Command": "hash_functions_autotest",
@@ -512,6 +518,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Pcapng autotest",
+        "Command": "pcapng_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Pdump autotest",
         "Command": "pdump_autotest",
@@ -579,6 +591,12 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Eventdev dsw devargs autotest",
+        "Command": "eventdev_dsw_devargs_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Eventdev selftest sw",
         "Command": "eventdev_selftest_sw",
@@ -591,6 +609,18 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Vhost async autotest",
+        "Command": "vhost_async_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Memif PMD autotest",
+        "Command": "memif_pmd_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Mempool performance autotest",
         "Command": "mempool_perf_autotest",
@@ -609,6 +639,24 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "GRO performance autotest",
+        "Command": "gro_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "GSO performance autotest",
+        "Command": "gso_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "IPv4 reassembly performance autotest",
+        "Command": "reassembly_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Hash read-write concurrency autotest",
         "Command": "hash_readwrite_autotest",
@@ -658,6 +706,42 @@
         "Func":    default_autotest,
         "Report":  None,
     },
+    {
+        "Name":    "Pcap pmd autotest",
+        "Command": "pcap_pmd_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Pcap pmd perf autotest",
+        "Command": "pcap_pmd_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Vhost pmd perf autotest",
+        "Command": "vhost_pmd_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Exception path perf autotest",
+        "Command": "exception_path_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Tap pmd perf autotest",
+        "Command": "tap_pmd_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
+    {
+        "Name":    "Af_packet pmd perf autotest",
+        "Command": "af_packet_pmd_perf_autotest",
+        "Func":    default_autotest,
+        "Report":  None,
+    },
     {
         "Name":    "Distributor perf autotest",
         "Command": "distributor_perf_autotest",
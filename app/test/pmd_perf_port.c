@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "pmd_perf_port.h"
+
+struct rte_mempool *
+pmd_perf_pool_create(const char *name, unsigned int nb_mbufs,
+		uint16_t data_room)
+{
+	struct rte_mempool *mp;
+
+	mp = rte_pktmbuf_pool_create(name, nb_mbufs, 0, 0, data_room,
+			rte_socket_id());
+	if (mp == NULL)
+		printf("Cannot create mbuf pool %s\n", name);
+
+	return mp;
+}
+
+int
+pmd_perf_port_create(const char *name, const char *args,
+		const struct rte_eth_conf *conf, uint16_t nb_desc,
+		struct rte_mempool *mp, uint16_t *port)
+{
+	struct rte_eth_dev_info dev_info;
+	struct rte_eth_conf port_conf;
+
+	if (rte_vdev_init(name, args) != 0)
+		return -1;
+	if (rte_eth_dev_get_port_by_name(name, port) != 0 ||
+			rte_eth_dev_info_get(*port, &dev_info) != 0)
+		goto uninit;
+
+	memset(&port_conf, 0, sizeof(port_conf));
+	if (conf != NULL)
+		port_conf = *conf;
+	port_conf.rxmode.offloads &= dev_info.rx_offload_capa;
+	port_conf.txmode.offloads &= dev_info.tx_offload_capa;
+	if (rte_eth_dev_configure(*port, 1, 1, &port_conf) != 0 ||
+			rte_eth_rx_queue_setup(*port, 0, nb_desc,
+				rte_socket_id(), NULL, mp) != 0 ||
+			rte_eth_tx_queue_setup(*port, 0, nb_desc,
+				rte_socket_id(), NULL) != 0 ||
+			rte_eth_dev_start(*port) != 0) {
+		printf("Cannot start %s\n", name);
+		goto uninit;
+	}
+
+	return 0;
+
+uninit:
+	rte_vdev_uninit(name);
+	return -1;
+}
+
+void
+pmd_perf_port_destroy(uint16_t port)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+
+	if (rte_eth_dev_get_name_by_port(port, name) != 0)
+		return;
+	rte_eth_dev_stop(port);
+	rte_eth_dev_close(port);
+	rte_vdev_uninit(name);
+}
+
+int
+pmd_perf_fill_burst(struct rte_mempool *mp, struct rte_mbuf **pkts,
+		uint16_t nb, uint16_t len, uint16_t ether_type)
+{
+	struct rte_ether_hdr *eth;
+	uint16_t i;
+
+	if (rte_pktmbuf_alloc_bulk(mp, pkts, nb) != 0)
+		return -1;
+
+	for (i = 0; i < nb; i++) {
+		eth = (struct rte_ether_hdr *)rte_pktmbuf_append(pkts[i], len);
+		memset(eth, 0, len);
+		memset(&eth->d_addr, 0xff, RTE_ETHER_ADDR_LEN);
+		eth->s_addr.addr_bytes[0] = 0x02;
+		eth->ether_type = rte_cpu_to_be_16(ether_type);
+	}
+
+	return 0;
+}
+
+void
+pmd_perf_free_burst(struct rte_mbuf **pkts, uint16_t nb)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+uint64_t
+pmd_perf_port_receive(uint16_t port, uint16_t ether_type,
+		uint64_t max_pkts, uint64_t max_bytes, bool wait,
+		struct pmd_perf_rx_stats *stats)
+{
+	struct rte_mbuf *pkts[PMD_PERF_BURST_SIZE];
+	struct rte_ether_hdr *eth;
+	uint64_t end = rte_get_timer_cycles() +
+		rte_get_timer_hz() * PMD_PERF_WAIT_MS / 1000;
+	uint64_t nb_pkts = 0, nb_bytes = 0, start;
+	uint16_t i, nb_rx;
+
+	while (nb_pkts < max_pkts && nb_bytes < max_bytes &&
+			rte_get_timer_cycles() < end) {
+		start = rte_rdtsc_precise();
+		nb_rx = rte_eth_rx_burst(port, 0, pkts, PMD_PERF_BURST_SIZE);
+		if (nb_rx == 0) {
+			if (!wait)
+				break;
+			/* let the kernel threads run on this core */
+			sched_yield();
+			continue;
+		}
+		stats->cycles += rte_rdtsc_precise() - start;
+		for (i = 0; i < nb_rx; i++) {
+			eth = rte_pktmbuf_mtod(pkts[i], struct rte_ether_hdr *);
+			if (eth->ether_type == rte_cpu_to_be_16(ether_type)) {
+				nb_bytes += rte_pktmbuf_pkt_len(pkts[i]);
+				nb_pkts++;
+			}
+			rte_pktmbuf_free(pkts[i]);
+		}
+	}
+	stats->pkts += nb_pkts;
+	stats->bytes += nb_bytes;
+
+	return nb_pkts;
+}
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _PMD_PERF_PORT_H_
+#define _PMD_PERF_PORT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Ports and packets shared by the performance tests of the virtual PMDs:
+ * each test creates vdev ports with a single queue pair, sends bursts of
+ * broadcast Ethernet frames and receives them back on a port.
+ */
+
+#define PMD_PERF_BURST_SIZE 32
+#define PMD_PERF_PKT_LEN 64
+#define PMD_PERF_WAIT_MS 100
+/* Local experimental ethertype, ignored by the kernel stack */
+#define PMD_PERF_ETHER_TYPE 0x88B5
+
+struct rte_eth_conf;
+struct rte_mbuf;
+struct rte_mempool;
+
+/* Receive counters, accumulated by pmd_perf_port_receive() */
+struct pmd_perf_rx_stats {
+	uint64_t pkts;
+	uint64_t bytes;
+	uint64_t cycles;
+};
+
+/* Create a pool of mbufs of data_room bytes, print an error on failure */
+struct rte_mempool *pmd_perf_pool_create(const char *name,
+		unsigned int nb_mbufs, uint16_t data_room);
+
+/*
+ * Create a vdev port with one queue pair of nb_desc descriptors and start
+ * it. The offloads of conf which the port doesn't support are dropped,
+ * a NULL conf is the default configuration.
+ */
+int pmd_perf_port_create(const char *name, const char *args,
+		const struct rte_eth_conf *conf, uint16_t nb_desc,
+		struct rte_mempool *mp, uint16_t *port);
+
+/* Stop and close a port created by pmd_perf_port_create() */
+void pmd_perf_port_destroy(uint16_t port);
+
+/*
+ * Allocate nb broadcast frames of len bytes with the given ethertype,
+ * the rest of the frames is zeroed.
+ */
+int pmd_perf_fill_burst(struct rte_mempool *mp, struct rte_mbuf **pkts,
+		uint16_t nb, uint16_t len, uint16_t ether_type);
+
+/* Free the mbufs of a burst */
+void pmd_perf_free_burst(struct rte_mbuf **pkts, uint16_t nb);
+
+/*
+ * Receive on queue 0 of a port and count the frames of the given
+ * ethertype, the other ones come from the kernel stack. Stop once
+ * max_pkts frames or max_bytes bytes are counted, or after
+ * PMD_PERF_WAIT_MS. When wait is not set, stop at the first empty burst.
+ * Return the number of frames counted.
+ */
+uint64_t pmd_perf_port_receive(uint16_t port, uint16_t ether_type,
+		uint64_t max_pkts, uint64_t max_bytes, bool wait,
+		struct pmd_perf_rx_stats *stats);
+
+#endif /* _PMD_PERF_PORT_H_ */
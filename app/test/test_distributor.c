@@ -16,6 +16,7 @@
 #define ITER_POWER 20 /* log 2 of how many iterations we do when timing. */
 #define BURST 32
 #define BIG_BATCH 1024
+#define PINNED_FLOWS 16
 
 struct worker_params {
 	char name[64];
@@ -508,6 +509,142 @@ test_flush_with_worker_shutdown(struct worker_params *wp,
 	return 0;
 }
 
+/* worker function for the flow pinning test, it marks each packet with
+ * the id of the worker handling it.
+ */
+static int
+handle_work_flow_pinning(void *arg)
+{
+	struct rte_mbuf *buf[8] __rte_cache_aligned;
+	struct worker_params *wp = arg;
+	struct rte_distributor *db = wp->dist;
+	unsigned int num = 0;
+	unsigned int id = __atomic_fetch_add(&worker_idx, 1, __ATOMIC_RELAXED);
+	unsigned int i;
+
+	for (i = 0; i < 8; i++)
+		buf[i] = NULL;
+	num = rte_distributor_get_pkt(db, id, buf, buf, num);
+	while (!quit) {
+		worker_stats[id].handled_packets += num;
+		for (i = 0; i < num; i++)
+			buf[i]->udata64 = id + 1;
+		num = rte_distributor_get_pkt(db, id,
+				buf, buf, num);
+	}
+	worker_stats[id].handled_packets += num;
+	for (i = 0; i < num; i++)
+		buf[i]->udata64 = id + 1;
+	rte_distributor_return_pkt(db, id, buf, num);
+	return 0;
+}
+
+/* checks the packets returned in the flow pinning test, each flow having
+ * to be handled by a single worker. Packets from other tests still being
+ * returned are skipped, as are the second returns of recycled mbufs.
+ */
+static int
+check_flow_pinning(struct rte_mbuf **bufs, struct rte_mbuf **returns,
+		unsigned int num, uint64_t *flow_worker, uint8_t *seen,
+		unsigned int *num_pinned)
+{
+	unsigned int i, j, flow;
+
+	for (i = 0; i < num; i++) {
+		for (j = 0; j < BIG_BATCH; j++)
+			if (returns[i] == bufs[j])
+				break;
+		if (j == BIG_BATCH || seen[j] || returns[i]->udata64 == 0)
+			continue;
+
+		seen[j] = 1;
+		(*num_pinned)++;
+		flow = returns[i]->hash.usr;
+		if (flow_worker[flow] == 0)
+			flow_worker[flow] = returns[i]->udata64;
+		if (returns[i]->udata64 != flow_worker[flow]) {
+			printf("line %d: Flow %u handled by workers %"PRIu64
+					" and %"PRIu64"\n", __LINE__, flow,
+					flow_worker[flow] - 1,
+					returns[i]->udata64 - 1);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* test flow pinning: send BIG_BATCH packets of PINNED_FLOWS flows through
+ * the distributor and check that each flow was handled by a single worker.
+ */
+static int
+sanity_test_flow_pinning(struct worker_params *wp, struct rte_mempool *p)
+{
+	struct rte_distributor *db = wp->dist;
+	struct rte_mbuf *bufs[BIG_BATCH], *returns[BIG_BATCH];
+	uint64_t flow_worker[PINNED_FLOWS] = { 0 };
+	uint8_t seen[BIG_BATCH] = { 0 };
+	unsigned int i, num, num_pinned = 0, retries = 0;
+	int ret = -1;
+
+	printf("=== Flow pinning test (%s) ===\n", wp->name);
+	clear_packet_count();
+	rte_distributor_flush(db);
+	rte_distributor_clear_returns(db);
+
+	if (rte_distributor_flow_pinning_set(db, 1) != 0) {
+		printf("line %d: Error enabling flow pinning\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, BIG_BATCH) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		rte_distributor_flow_pinning_set(db, 0);
+		return -1;
+	}
+	for (i = 0; i < BIG_BATCH; i++) {
+		bufs[i]->hash.usr = i % PINNED_FLOWS;
+		bufs[i]->udata64 = 0;
+	}
+
+	for (i = 0; i < BIG_BATCH / BURST; i++) {
+		rte_distributor_process(db, &bufs[i * BURST], BURST);
+		num = rte_distributor_returned_pkts(db, returns, BIG_BATCH);
+		if (check_flow_pinning(bufs, returns, num, flow_worker,
+				seen, &num_pinned) < 0)
+			goto out;
+	}
+	if (rte_distributor_flow_pinning_set(db, 0) != -EBUSY) {
+		printf("line %d: Flow pinning changed with packets in flight\n",
+				__LINE__);
+		goto out;
+	}
+	do {
+		rte_distributor_flush(db);
+		num = rte_distributor_returned_pkts(db, returns, BIG_BATCH);
+		if (check_flow_pinning(bufs, returns, num, flow_worker,
+				seen, &num_pinned) < 0)
+			goto out;
+		retries++;
+	} while ((num_pinned < BIG_BATCH) && (retries < 100));
+
+	if (num_pinned != BIG_BATCH) {
+		printf("line %d: Missing packets, got %u\n",
+				__LINE__, num_pinned);
+		goto out;
+	}
+
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+	printf("Flow pinning test done\n\n");
+	ret = 0;
+out:
+	rte_distributor_flush(db);
+	rte_distributor_flow_pinning_set(db, 0);
+	rte_mempool_put_bulk(p, (void *)bufs, BIG_BATCH);
+	return ret;
+}
+
 static
 int test_error_distributor_create_name(void)
 {
@@ -684,6 +821,20 @@ test_distributor(void)
 			printf("Too few cores to run worker shutdown test\n");
 		}
 
+		if (dist[i] == ds) {
+			if (rte_distributor_flow_pinning_set(ds, 1) !=
+					-EINVAL) {
+				printf("Flow pinning enabled in single mode\n");
+				return -1;
+			}
+			continue;
+		}
+
+		rte_eal_mp_remote_launch(handle_work_flow_pinning,
+				&worker_params, SKIP_MASTER);
+		if (sanity_test_flow_pinning(&worker_params, p) < 0)
+			goto err;
+		quit_workers(&worker_params, p);
 	}
 
 	if (test_error_distributor_create_numworkers() == -1 ||
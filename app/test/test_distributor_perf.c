@@ -260,6 +260,18 @@ test_distributor_perf(void)
 	rte_eal_mp_remote_launch(handle_work, db, SKIP_MASTER);
 	if (perf_test(db, p) < 0)
 		return -1;
+
+	printf("=== Performance test of distributor (burst mode, flow pinning) ===\n");
+	rte_distributor_flush(db);
+	if (rte_distributor_flow_pinning_set(db, 1) != 0) {
+		printf("Error enabling flow pinning\n");
+		return -1;
+	}
+	if (perf_test(db, p) < 0)
+		return -1;
+	/* quit_workers() relies on the dynamic distribution */
+	rte_distributor_flush(db);
+	rte_distributor_flow_pinning_set(db, 0);
 	quit_workers(db, p);
 
 	return 0;
@@ -5,6 +5,7 @@
 
 #include <string.h>
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_mempool.h>
 #include <rte_mbuf.h>
 #include <rte_cryptodev.h>
@@ -35,6 +36,12 @@
 #define NB_TEST_QUEUES             2
 #define NUM_CORES                  1
 #define CRYPTODEV_NAME_NULL_PMD    crypto_null
+#define TEST_ENQ_BATCH_SIZE        8
+#define TEST_ENQ_BATCH_NB_OPS      20
+#define TEST_ENQ_FLUSH_TIMEOUT_NS  100000
+#define PERF_NB_OPS                (1 << 18)
+#define PERF_NB_INFLIGHT           256
+#define PERF_BURST_SIZE            32
 
 #define MBUF_SIZE              (sizeof(struct rte_mbuf) + \
 				RTE_PKTMBUF_HEADROOM + PACKET_LENGTH)
@@ -153,6 +160,12 @@ test_crypto_adapter_stats(void)
 		stats.event_enq_retry_count);
 	printf(" + Event enqueue fail count       %" PRIx64 "\n",
 		stats.event_enq_fail_count);
+	printf(" + Cryptodev enqueue timeouts     %" PRIx64 "\n",
+		stats.crypto_enq_timeout_count);
+	printf(" + Event dequeue backpressure     %" PRIx64 "\n",
+		stats.event_deq_backpressure_count);
+	printf(" + Cryptodev dequeue backpressure %" PRIx64 "\n",
+		stats.crypto_deq_backpressure_count);
 	printf(" +------------------------------------------------------+\n");
 
 	rte_event_crypto_adapter_stats_reset(TEST_ADAPTER_ID);
@@ -224,8 +237,7 @@ test_op_forward_mode(uint8_t session_less)
 		op->sess_type = RTE_CRYPTO_OP_SESSIONLESS;
 		first_xform = &cipher_xform;
 		sym_op->xform = first_xform;
-		uint32_t len = IV_OFFSET + MAXIMUM_IV_LENGTH +
-				(sizeof(struct rte_crypto_sym_xform) * 2);
+		uint32_t len = IV_OFFSET + MAXIMUM_IV_LENGTH;
 		op->private_data_offset = len;
 		/* Fill in private data information */
 		rte_memcpy(&m_data.response_info, &response_info,
@@ -323,6 +335,284 @@ test_session_with_op_forward_mode(void)
 	return TEST_SUCCESS;
 }
 
+static int
+test_op_forward_mode_batch(void)
+{
+	struct rte_event_crypto_adapter_stats stats;
+	struct rte_crypto_sym_xform cipher_xform;
+	struct rte_cryptodev_sym_session *sess;
+	union rte_event_crypto_metadata m_data;
+	struct rte_crypto_op *op;
+	struct rte_event ev;
+	uint64_t timeout;
+	uint32_t cap;
+	int ret, i, nb_recv;
+
+	ret = rte_event_crypto_adapter_caps_get(TEST_ADAPTER_ID, evdev, &cap);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get adapter capabilities\n");
+
+	/* Batching is done by the SW adapter only */
+	if (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD)
+		return TEST_SKIPPED;
+
+	map_adapter_service_core();
+
+	ret = rte_event_crypto_adapter_enq_batch_set(TEST_ADAPTER_ID,
+			TEST_ENQ_BATCH_SIZE, TEST_ENQ_FLUSH_TIMEOUT_NS);
+	TEST_ASSERT_SUCCESS(ret, "Failed to set the enqueue batch\n");
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_start(TEST_ADAPTER_ID),
+				"Failed to start event crypto adapter");
+	rte_event_crypto_adapter_stats_reset(TEST_ADAPTER_ID);
+
+	memset(&cipher_xform, 0, sizeof(cipher_xform));
+	cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	memset(&m_data, 0, sizeof(m_data));
+	rte_memcpy(&m_data.response_info, &response_info,
+		   sizeof(response_info));
+	rte_memcpy(&m_data.request_info, &request_info,
+		   sizeof(request_info));
+
+	sess = rte_cryptodev_sym_session_create(params.session_mpool);
+	TEST_ASSERT_NOT_NULL(sess, "Session creation failed\n");
+	rte_cryptodev_sym_session_init(TEST_CDEV_ID, sess, &cipher_xform,
+				       params.session_priv_mpool);
+	rte_cryptodev_sym_session_set_user_data(sess, &m_data,
+						sizeof(m_data));
+
+	/* Not a multiple of the batch size, the last ops are only submitted
+	 * to the cryptodev on flush timeout.
+	 */
+	for (i = 0; i < TEST_ENQ_BATCH_NB_OPS; i++) {
+		op = rte_crypto_op_alloc(params.op_mpool,
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+		TEST_ASSERT_NOT_NULL(op,
+			"Failed to allocate symmetric crypto operation struct\n");
+
+		rte_crypto_op_attach_sym_session(op, sess);
+		op->sym->m_src = alloc_fill_mbuf(params.mbuf_pool, text_64B,
+						 PACKET_LENGTH, 0);
+		TEST_ASSERT_NOT_NULL(op->sym->m_src,
+				     "Failed to allocate mbuf!\n");
+		op->sym->cipher.data.offset = 0;
+		op->sym->cipher.data.length = PACKET_LENGTH;
+
+		memset(&ev, 0, sizeof(ev));
+		ev.queue_id = TEST_CRYPTO_EV_QUEUE_ID;
+		ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		ev.flow_id = 0xAABB;
+		ev.event_ptr = op;
+
+		ret = rte_event_enqueue_burst(evdev, TEST_APP_PORT_ID, &ev,
+					      NUM);
+		TEST_ASSERT_EQUAL(ret, NUM,
+				  "Failed to send event to crypto adapter\n");
+	}
+
+	nb_recv = 0;
+	timeout = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (nb_recv < TEST_ENQ_BATCH_NB_OPS &&
+	       rte_get_timer_cycles() < timeout) {
+		if (rte_event_dequeue_burst(evdev, TEST_APP_PORT_ID, &ev,
+					    NUM, 0) == 0) {
+			rte_pause();
+			continue;
+		}
+
+		op = ev.event_ptr;
+		rte_pktmbuf_free(op->sym->m_src);
+		rte_crypto_op_free(op);
+		nb_recv++;
+	}
+
+	rte_cryptodev_sym_session_clear(TEST_CDEV_ID, sess);
+	rte_cryptodev_sym_session_free(sess);
+
+	TEST_ASSERT_EQUAL(nb_recv, TEST_ENQ_BATCH_NB_OPS,
+			  "Received %d of %d crypto ops\n", nb_recv,
+			  TEST_ENQ_BATCH_NB_OPS);
+
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT(stats.crypto_enq_timeout_count > 0,
+		    "Partial batch not submitted on timeout\n");
+	TEST_ASSERT_EQUAL(stats.crypto_enq_count, TEST_ENQ_BATCH_NB_OPS,
+			  "Unexpected cryptodev enqueue count\n");
+
+	test_crypto_adapter_stats();
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Run PERF_NB_OPS crypto ops through the adapter, keeping PERF_NB_INFLIGHT
+ * of them in flight, and return the number of cycles spent per op. The
+ * event device and adapter services run on this lcore, between the bursts
+ * of the application, so the result is the total CPU cost of an op.
+ */
+static int
+perf_op_forward_mode(struct rte_cryptodev_sym_session *sess,
+		     uint32_t evdev_service_id, uint32_t adapter_service_id,
+		     uint16_t batch_size, uint64_t flush_timeout_ns,
+		     double *cycles_per_op)
+{
+	struct rte_crypto_op *ops[PERF_NB_INFLIGHT];
+	struct rte_event ev[PERF_BURST_SIZE];
+	uint32_t nb_sent, nb_recv, nb_free;
+	uint64_t start, cycles, timeout;
+	uint16_t i, n;
+	int ret;
+
+	ret = rte_event_crypto_adapter_enq_batch_set(TEST_ADAPTER_ID,
+			batch_size, flush_timeout_ns);
+	TEST_ASSERT_SUCCESS(ret, "Failed to set the enqueue batch\n");
+
+	ret = rte_crypto_op_bulk_alloc(params.op_mpool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, ops, PERF_NB_INFLIGHT);
+	TEST_ASSERT_EQUAL(ret, PERF_NB_INFLIGHT,
+			  "Failed to allocate crypto ops\n");
+
+	for (i = 0; i < PERF_NB_INFLIGHT; i++) {
+		rte_crypto_op_attach_sym_session(ops[i], sess);
+		ops[i]->sym->m_src = alloc_fill_mbuf(params.mbuf_pool,
+				text_64B, PACKET_LENGTH, 0);
+		TEST_ASSERT_NOT_NULL(ops[i]->sym->m_src,
+				     "Failed to allocate mbuf!\n");
+		ops[i]->sym->cipher.data.offset = 0;
+		ops[i]->sym->cipher.data.length = PACKET_LENGTH;
+	}
+
+	nb_sent = 0;
+	nb_recv = 0;
+	nb_free = PERF_NB_INFLIGHT;
+	start = rte_rdtsc();
+	timeout = rte_get_timer_cycles() + rte_get_timer_hz();
+
+	while (nb_recv < PERF_NB_OPS) {
+		TEST_ASSERT(rte_get_timer_cycles() < timeout,
+			    "Stalled after %u of %u crypto ops sent, %u received\n",
+			    nb_sent, PERF_NB_OPS, nb_recv);
+
+		n = RTE_MIN(nb_free, PERF_NB_OPS - nb_sent);
+		n = RTE_MIN(n, PERF_BURST_SIZE);
+		for (i = 0; i < n; i++) {
+			memset(&ev[i], 0, sizeof(ev[i]));
+			ev[i].queue_id = TEST_CRYPTO_EV_QUEUE_ID;
+			ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+			ev[i].flow_id = TEST_APP_EV_FLOWID;
+			ev[i].event_ptr = ops[nb_free - n + i];
+		}
+		if (n > 0) {
+			n = rte_event_enqueue_burst(evdev, TEST_APP_PORT_ID,
+					ev, n);
+			nb_free -= n;
+			nb_sent += n;
+		}
+
+		rte_service_run_iter_on_app_lcore(evdev_service_id, 1);
+		rte_service_run_iter_on_app_lcore(adapter_service_id, 1);
+
+		n = rte_event_dequeue_burst(evdev, TEST_APP_PORT_ID, ev,
+				PERF_BURST_SIZE, 0);
+		for (i = 0; i < n; i++) {
+			ops[nb_free++] = ev[i].event_ptr;
+			ops[nb_free - 1]->status =
+				RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
+		}
+		nb_recv += n;
+		if (n > 0)
+			timeout = rte_get_timer_cycles() + rte_get_timer_hz();
+	}
+
+	cycles = rte_rdtsc() - start;
+	*cycles_per_op = (double)cycles / PERF_NB_OPS;
+
+	for (i = 0; i < PERF_NB_INFLIGHT; i++)
+		rte_pktmbuf_free(ops[i]->sym->m_src);
+	rte_mempool_put_bulk(params.op_mpool, (void **)ops, PERF_NB_INFLIGHT);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_op_forward_mode_perf(void)
+{
+	static const struct {
+		uint16_t batch_size;
+		uint64_t flush_timeout_ns;
+	} perf_cfg[] = {
+		{ 1, 0 },
+		{ 8, 10000 },
+		{ 32, 10000 },
+	};
+	struct rte_crypto_sym_xform cipher_xform;
+	struct rte_cryptodev_sym_session *sess;
+	union rte_event_crypto_metadata m_data;
+	uint32_t evdev_service_id, adapter_service_id;
+	double cycles_per_op;
+	uint32_t cap;
+	unsigned int i;
+	int ret;
+
+	ret = rte_event_crypto_adapter_caps_get(TEST_ADAPTER_ID, evdev, &cap);
+	TEST_ASSERT_SUCCESS(ret, "Failed to get adapter capabilities\n");
+
+	/* Batching is done by the SW adapter only */
+	if (cap & RTE_EVENT_CRYPTO_ADAPTER_CAP_INTERNAL_PORT_OP_FWD)
+		return TEST_SKIPPED;
+
+	if (rte_event_dev_service_id_get(evdev, &evdev_service_id) != 0)
+		return TEST_SKIPPED;
+	TEST_ASSERT_SUCCESS(rte_service_map_lcore_set(evdev_service_id,
+				slcore_id, 0), "Failed to unmap evdev service");
+	rte_service_lcore_stop(slcore_id);
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_start(TEST_ADAPTER_ID),
+				"Failed to start event crypto adapter");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_service_id_get(
+				TEST_ADAPTER_ID, &adapter_service_id),
+				"Failed to get adapter service id");
+
+	memset(&cipher_xform, 0, sizeof(cipher_xform));
+	cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	memset(&m_data, 0, sizeof(m_data));
+	rte_memcpy(&m_data.response_info, &response_info,
+		   sizeof(response_info));
+	rte_memcpy(&m_data.request_info, &request_info,
+		   sizeof(request_info));
+
+	sess = rte_cryptodev_sym_session_create(params.session_mpool);
+	TEST_ASSERT_NOT_NULL(sess, "Session creation failed\n");
+	rte_cryptodev_sym_session_init(TEST_CDEV_ID, sess, &cipher_xform,
+				       params.session_priv_mpool);
+	rte_cryptodev_sym_session_set_user_data(sess, &m_data,
+						sizeof(m_data));
+
+	printf("Crypto adapter forward mode, %u ops, %u in flight:\n",
+	       PERF_NB_OPS, PERF_NB_INFLIGHT);
+	for (i = 0; i < RTE_DIM(perf_cfg); i++) {
+		ret = perf_op_forward_mode(sess, evdev_service_id,
+				adapter_service_id, perf_cfg[i].batch_size,
+				perf_cfg[i].flush_timeout_ns, &cycles_per_op);
+		if (ret != TEST_SUCCESS)
+			break;
+		printf("  batch %2u, flush timeout %5" PRIu64 " ns: "
+		       "%.0f cycles/op, %.3f Mops/s\n",
+		       perf_cfg[i].batch_size, perf_cfg[i].flush_timeout_ns,
+		       cycles_per_op, rte_get_tsc_hz() / cycles_per_op / 1E6);
+	}
+
+	rte_cryptodev_sym_session_clear(TEST_CDEV_ID, sess);
+	rte_cryptodev_sym_session_free(sess);
+
+	return ret;
+}
+
 static int
 send_op_recv_ev(struct rte_crypto_op *op)
 {
@@ -408,8 +698,7 @@ test_op_new_mode(uint8_t session_less)
 		op->sess_type = RTE_CRYPTO_OP_SESSIONLESS;
 		first_xform = &cipher_xform;
 		sym_op->xform = first_xform;
-		uint32_t len = IV_OFFSET + MAXIMUM_IV_LENGTH +
-				(sizeof(struct rte_crypto_sym_xform) * 2);
+		uint32_t len = IV_OFFSET + MAXIMUM_IV_LENGTH;
 		op->private_data_offset = len;
 		/* Fill in private data information */
 		rte_memcpy(&m_data.response_info, &response_info,
@@ -497,7 +786,8 @@ configure_cryptodev(void)
 			NUM_MBUFS, MBUF_CACHE_SIZE,
 			DEFAULT_NUM_XFORMS *
 			sizeof(struct rte_crypto_sym_xform) +
-			MAXIMUM_IV_LENGTH,
+			MAXIMUM_IV_LENGTH +
+			sizeof(union rte_event_crypto_metadata),
 			rte_socket_id());
 	if (params.op_mpool == NULL) {
 		RTE_LOG(ERR, USER1, "Can't create CRYPTO_OP_POOL\n");
@@ -531,12 +821,14 @@ configure_cryptodev(void)
 
 	params.session_mpool = rte_cryptodev_sym_session_pool_create(
 			"CRYPTO_ADAPTER_SESSION_MP",
-			MAX_NB_SESSIONS, 0, 0, 0, SOCKET_ID_ANY);
+			MAX_NB_SESSIONS, 0, 0,
+			sizeof(union rte_event_crypto_metadata),
+			SOCKET_ID_ANY);
 	TEST_ASSERT_NOT_NULL(params.session_mpool,
 			"session mempool allocation failed\n");
 
 	params.session_priv_mpool = rte_mempool_create(
-				"CRYPTO_ADAPTER_SESSION_MP_PRIV",
+				"CRYPTO_AD_SESS_MP_PRIV",
 				MAX_NB_SESSIONS,
 				session_size,
 				0, 0, NULL, NULL, NULL,
@@ -680,6 +972,25 @@ test_crypto_adapter_create(void)
 	return TEST_SUCCESS;
 }
 
+static int
+test_crypto_adapter_enq_batch_set(void)
+{
+	TEST_ASSERT(rte_event_crypto_adapter_enq_batch_set(TEST_ADAPTER_ID, 0,
+			TEST_ENQ_FLUSH_TIMEOUT_NS) < 0,
+			"Batch size 0 accepted\n");
+	TEST_ASSERT(rte_event_crypto_adapter_enq_batch_set(TEST_ADAPTER_ID,
+			UINT16_MAX, TEST_ENQ_FLUSH_TIMEOUT_NS) < 0,
+			"Too large batch size accepted\n");
+	TEST_ASSERT(rte_event_crypto_adapter_enq_batch_set(
+			RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE, 1, 0) < 0,
+			"Invalid adapter id accepted\n");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_enq_batch_set(
+			TEST_ADAPTER_ID, TEST_ENQ_BATCH_SIZE, 0),
+			"Failed to set the enqueue batch\n");
+
+	return TEST_SUCCESS;
+}
+
 static int
 test_crypto_adapter_qp_add_del(void)
 {
@@ -912,6 +1223,10 @@ static struct unit_test_suite functional_testsuite = {
 				test_crypto_adapter_free,
 				test_crypto_adapter_stats),
 
+		TEST_CASE_ST(test_crypto_adapter_create,
+				test_crypto_adapter_free,
+				test_crypto_adapter_enq_batch_set),
+
 		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
 				test_crypto_adapter_stop,
 				test_session_with_op_forward_mode),
@@ -920,6 +1235,10 @@ static struct unit_test_suite functional_testsuite = {
 				test_crypto_adapter_stop,
 				test_sessionless_with_op_forward_mode),
 
+		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
+				test_crypto_adapter_stop,
+				test_op_forward_mode_batch),
+
 		TEST_CASE_ST(test_crypto_adapter_conf_op_new_mode,
 				test_crypto_adapter_stop,
 				test_session_with_op_new_mode),
@@ -932,11 +1251,33 @@ static struct unit_test_suite functional_testsuite = {
 	}
 };
 
+static struct unit_test_suite perf_testsuite = {
+	.suite_name = "Event crypto adapter perf test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+
+		TEST_CASE_ST(test_crypto_adapter_conf_op_forward_mode,
+				test_crypto_adapter_stop,
+				test_op_forward_mode_perf),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
 static int
 test_event_crypto_adapter(void)
 {
 	return unit_test_suite_runner(&functional_testsuite);
 }
 
+static int
+test_event_crypto_adapter_perf(void)
+{
+	return unit_test_suite_runner(&perf_testsuite);
+}
+
 REGISTER_TEST_COMMAND(event_crypto_adapter_autotest,
 		test_event_crypto_adapter);
+REGISTER_TEST_COMMAND(event_crypto_adapter_perf_autotest,
+		test_event_crypto_adapter_perf);
@@ -654,6 +654,233 @@ adapter_start_stop(void)
 	return TEST_SUCCESS;
 }
 
+static int
+adapter_queue_event_vector_config(void)
+{
+	struct rte_event_eth_rx_adapter_vector_limits limits;
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_mempool *vector_mp;
+	struct rte_event ev;
+	int err;
+
+	if (!(default_params.caps &
+			RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR)) {
+		err = rte_event_eth_rx_adapter_vector_limits_get(TEST_DEV_ID,
+				TEST_ETHDEV_ID, &limits);
+		TEST_ASSERT(err == -ENOTSUP, "Expected -ENOTSUP got %d", err);
+		return TEST_SUCCESS;
+	}
+
+	err = rte_event_eth_rx_adapter_vector_limits_get(TEST_DEV_ID,
+			TEST_ETHDEV_ID, NULL);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_vector_limits_get(TEST_DEV_ID,
+			TEST_ETHDEV_ID, &limits);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT(limits.min_sz <= limits.max_sz &&
+		    limits.min_timeout_ns <= limits.max_timeout_ns,
+		    "Invalid vector limits");
+
+	vector_mp = rte_event_vector_pool_create("vector_pool", 64, 0,
+			limits.min_sz, rte_socket_id());
+	TEST_ASSERT(vector_mp != NULL, "Failed to create vector pool");
+
+	memset(&ev, 0, sizeof(ev));
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.priority = 0;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+	queue_config.vector_sz = limits.min_sz;
+	queue_config.vector_timeout_ns = limits.min_timeout_ns;
+
+	/* missing vector pool */
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	/* vectors larger than the pool elements */
+	queue_config.vector_mp = vector_mp;
+	queue_config.vector_sz = limits.min_sz + 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	/* timeout out of limits */
+	queue_config.vector_sz = limits.min_sz;
+	queue_config.vector_timeout_ns = limits.max_timeout_ns + 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	queue_config.vector_timeout_ns = limits.min_timeout_ns;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	rte_mempool_free(vector_mp);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_queue_seqn_config(void)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event ev;
+	int err;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_PARALLEL;
+	ev.priority = 0;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.rx_queue_flags = RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN |
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+
+	/* vectors are not numbered */
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	queue_config.rx_queue_flags = RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1, &queue_config);
+	if (default_params.caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT) {
+		TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+		return TEST_SUCCESS;
+	}
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
+static int
+adapter_shards(void)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_config;
+	struct rte_event_eth_rx_adapter_stats stats[2];
+	uint32_t service_id[2];
+	struct rte_event ev;
+	uint16_t i;
+	int err;
+
+	err = rte_event_eth_rx_adapter_shards_set(TEST_INST_ID, 0);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_shards_set(1, 2);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_shards_set(TEST_INST_ID, 2);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_shard_service_id_get(TEST_INST_ID, 0,
+							    &service_id[0]);
+	TEST_ASSERT(err == -ESRCH, "Expected -ESRCH got %d", err);
+
+	if (default_params.caps & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT ||
+		!(default_params.caps &
+			RTE_EVENT_ETH_RX_ADAPTER_CAP_MULTI_EVENTQ) ||
+		default_params.rx_rings < 2)
+		return TEST_SUCCESS;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.queue_id = 0;
+	ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ev.priority = 0;
+
+	memset(&queue_config, 0, sizeof(queue_config));
+	queue_config.rx_queue_flags =
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID;
+	queue_config.ev = ev;
+	queue_config.servicing_weight = 1;
+	queue_config.shard_id = 2;
+
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 0, &queue_config);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	/* queue 0 on shard 1, the other queues are balanced */
+	queue_config.shard_id = 1;
+	err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID, TEST_ETHDEV_ID,
+						 0, &queue_config);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	queue_config.rx_queue_flags = 0;
+	for (i = 1; i < default_params.rx_rings; i++) {
+		err = rte_event_eth_rx_adapter_queue_add(TEST_INST_ID,
+						TEST_ETHDEV_ID, i,
+						&queue_config);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	}
+
+	err = rte_event_eth_rx_adapter_shards_set(TEST_INST_ID, 4);
+	TEST_ASSERT(err == -EBUSY, "Expected -EBUSY got %d", err);
+
+	for (i = 0; i < 2; i++) {
+		err = rte_event_eth_rx_adapter_shard_service_id_get(
+				TEST_INST_ID, i, &service_id[i]);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	}
+	TEST_ASSERT(service_id[0] != service_id[1],
+		    "Shards share service %u", service_id[0]);
+
+	err = rte_event_eth_rx_adapter_shard_service_id_get(TEST_INST_ID, 2,
+							    &service_id[0]);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_stats_reset(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_start(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	/* both shards poll Rx queues */
+	for (i = 0; i < 2; i++) {
+		rte_service_run_iter_on_app_lcore(service_id[i], 1);
+		err = rte_event_eth_rx_adapter_shard_stats_get(TEST_INST_ID,
+							       i, &stats[i]);
+		TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+		TEST_ASSERT(stats[i].rx_poll_count != 0,
+			    "Shard %u did not poll", i);
+	}
+
+	err = rte_event_eth_rx_adapter_stop(TEST_INST_ID);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	err = rte_event_eth_rx_adapter_shard_stats_get(TEST_INST_ID, 2,
+						       &stats[0]);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_rx_adapter_queue_del(TEST_INST_ID, TEST_ETHDEV_ID,
+						 -1);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return TEST_SUCCESS;
+}
+
 static int
 adapter_stats(void)
 {
@@ -684,6 +911,11 @@ static struct unit_test_suite event_eth_rx_tests = {
 					adapter_multi_eth_add_del),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_start_stop),
 		TEST_CASE_ST(adapter_create, adapter_free, adapter_stats),
+		TEST_CASE_ST(adapter_create, adapter_free,
+					adapter_queue_event_vector_config),
+		TEST_CASE_ST(adapter_create, adapter_free, adapter_shards),
+		TEST_CASE_ST(adapter_create, adapter_free,
+					adapter_queue_seqn_config),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
@@ -453,6 +453,141 @@ tx_adapter_single(uint16_t port, uint16_t tx_queue_id,
 	return -1;
 }
 
+static void
+tx_adapter_run_service(unsigned int nb_iter)
+{
+	while (nb_iter--) {
+		if (eid != ~0ULL)
+			rte_service_run_iter_on_app_lcore(eid, 0);
+		rte_service_run_iter_on_app_lcore(tid, 0);
+	}
+}
+
+#define REORDER_WINDOW		8
+#define REORDER_NB_PKTS		9
+#define REORDER_FLUSH_ITER	4096
+/* Shares the low bits of the flow identifier of flow 1 */
+#define REORDER_FLOW2		(1 + 1024)
+#define REORDER_TXQ		0
+/* Tx queue without reordering */
+#define REORDER_TXQ_NONE	1
+
+static int
+tx_adapter_reorder(uint8_t ev_qid)
+{
+	/* Packets in enqueue order, seqn 5 of flow 1 is never sent */
+	static const struct {
+		uint32_t flow_id;
+		uint32_t seqn;
+		uint16_t txq;
+	} pkts[REORDER_NB_PKTS] = {
+		{ 1, 2, REORDER_TXQ },
+		{ REORDER_FLOW2, 1, REORDER_TXQ },
+		{ 1, 0, REORDER_TXQ },
+		{ 1, 1000, REORDER_TXQ_NONE },
+		{ 1, 1, REORDER_TXQ },
+		{ REORDER_FLOW2, 0, REORDER_TXQ },
+		{ 1, 4, REORDER_TXQ },
+		{ 1, 3, REORDER_TXQ },
+		{ 1, 6, REORDER_TXQ },
+	};
+	struct rte_event_eth_tx_adapter_stats stats;
+	struct rte_mbuf bufs[REORDER_NB_PKTS];
+	struct rte_mbuf *r[REORDER_NB_PKTS];
+	uint32_t next_seqn[2];
+	struct rte_event event;
+	uint16_t nb_rx;
+	uint32_t i, j, k;
+	int err;
+
+	err = rte_event_eth_tx_adapter_reorder_set(TEST_INST_ID,
+						TEST_ETHDEV_ID, REORDER_TXQ, 3);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_reorder_set(TEST_INST_ID,
+			TEST_ETHDEV_ID, REORDER_TXQ,
+			RTE_EVENT_ETH_TX_ADAPTER_REORDER_MAX_WINDOW * 2);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_reorder_set(TEST_INST_ID,
+			TEST_ETHDEV_ID, MAX_NUM_QUEUE, REORDER_WINDOW);
+	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
+
+	err = rte_event_eth_tx_adapter_reorder_set(TEST_INST_ID,
+			TEST_ETHDEV_ID, REORDER_TXQ, REORDER_WINDOW);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	for (i = 0; i < REORDER_NB_PKTS; i++) {
+		memset(&event, 0, sizeof(event));
+		event.queue_id = ev_qid;
+		event.op = RTE_EVENT_OP_NEW;
+		event.event_type = RTE_EVENT_TYPE_CPU;
+		event.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		event.flow_id = pkts[i].flow_id;
+		event.mbuf = &bufs[i];
+
+		bufs[i].port = TEST_ETHDEV_ID;
+		bufs[i].seqn = pkts[i].seqn;
+		rte_event_eth_tx_adapter_txq_set(&bufs[i], pkts[i].txq);
+
+		TEST_ASSERT(rte_event_enqueue_burst(TEST_DEV_ID, 0, &event,
+						    1) == 1,
+			    "Unable to enqueue to eventdev");
+
+		if (i != REORDER_NB_PKTS - 2)
+			continue;
+
+		/* The first mbufs of each flow are transmitted in sequence */
+		tx_adapter_run_service(REORDER_FLUSH_ITER);
+		nb_rx = rte_eth_rx_burst(TEST_ETHDEV_PAIR_ID, REORDER_TXQ, r,
+					 RTE_DIM(r));
+		TEST_ASSERT_EQUAL(nb_rx, REORDER_NB_PKTS - 2,
+				  "Expected %u mbufs got %u",
+				  REORDER_NB_PKTS - 2, nb_rx);
+		memset(next_seqn, 0, sizeof(next_seqn));
+		for (j = 0; j < nb_rx; j++) {
+			k = pkts[r[j] - bufs].flow_id == REORDER_FLOW2;
+			TEST_ASSERT_EQUAL(r[j]->seqn, next_seqn[k],
+					  "Expected seqn %u got %u",
+					  next_seqn[k], r[j]->seqn);
+			next_seqn[k]++;
+		}
+
+		/* The mbuf of the other Tx queue is not reordered */
+		nb_rx = rte_eth_rx_burst(TEST_ETHDEV_PAIR_ID, REORDER_TXQ_NONE,
+					 r, RTE_DIM(r));
+		TEST_ASSERT_EQUAL(nb_rx, 1, "Expected 1 mbuf got %u", nb_rx);
+		TEST_ASSERT_EQUAL(r[0]->seqn, 1000,
+				  "Expected seqn 1000 got %u", r[0]->seqn);
+	}
+
+	/* The last mbuf waits for the missing one until the flow stalls */
+	tx_adapter_run_service(REORDER_FLUSH_ITER);
+	nb_rx = rte_eth_rx_burst(TEST_ETHDEV_PAIR_ID, REORDER_TXQ, r,
+				 RTE_DIM(r));
+	TEST_ASSERT_EQUAL(nb_rx, 1, "Expected 1 mbuf got %u", nb_rx);
+	TEST_ASSERT_EQUAL(r[0]->seqn, 6, "Expected seqn 6 got %u",
+			  r[0]->seqn);
+
+	err = rte_event_eth_tx_adapter_stats_get(TEST_INST_ID, &stats);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+	TEST_ASSERT_EQUAL(stats.tx_packets, REORDER_NB_PKTS,
+			"stats.tx_packets expected %u got %"PRIu64,
+			REORDER_NB_PKTS, stats.tx_packets);
+	TEST_ASSERT_EQUAL(stats.tx_reorder_skipped, 1,
+			"stats.tx_reorder_skipped expected 1 got %"PRIu64,
+			stats.tx_reorder_skipped);
+	TEST_ASSERT_EQUAL(stats.tx_reorder_late, 0,
+			"stats.tx_reorder_late expected 0 got %"PRIu64,
+			stats.tx_reorder_late);
+
+	err = rte_event_eth_tx_adapter_reorder_set(TEST_INST_ID,
+						TEST_ETHDEV_ID, -1, 0);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
+	return rte_event_eth_tx_adapter_stats_reset(TEST_INST_ID);
+}
+
 static int
 tx_adapter_service(void)
 {
@@ -612,6 +747,9 @@ tx_adapter_service(void)
 			0,
 			stats.tx_packets);
 
+	err = tx_adapter_reorder(ev_qid);
+	TEST_ASSERT(err == 0, "Expected 0 got %d", err);
+
 	err = rte_event_eth_tx_adapter_stats_get(1, &stats);
 	TEST_ASSERT(err == -EINVAL, "Expected -EINVAL got %d", err);
 
@@ -1020,7 +1020,55 @@ test_eventdev_selftest_octeontx2(void)
 	return test_eventdev_selftest_impl("otx2_eventdev", "");
 }
 
+static int
+test_eventdev_dsw_devargs_probe(const char *args)
+{
+	int ret;
+
+	ret = rte_vdev_init("event_dsw_args", args);
+	if (ret == 0)
+		rte_vdev_uninit("event_dsw_args");
+
+	return ret;
+}
+
+static int
+test_eventdev_dsw_devargs(void)
+{
+	static const char *const invalid_args[] = {
+		"unknown_arg=1",
+		"migration_interval=500,unknown_arg=1",
+		"migration_interval=0",
+		"migration_interval=abc",
+		"load_update_interval=0",
+		"max_migration_flows=0",
+		"max_migration_flows=1000",
+	};
+	unsigned int i;
+
+	if (test_eventdev_dsw_devargs_probe("") != 0)
+		return TEST_SKIPPED;
+
+	TEST_ASSERT_SUCCESS(test_eventdev_dsw_devargs_probe(
+		"migration_interval=500,load_update_interval=100,"
+		"max_migration_flows=4"),
+		"Failed to probe event_dsw with valid parameters");
+
+	for (i = 0; i < RTE_DIM(invalid_args); i++) {
+		TEST_ASSERT_FAIL(test_eventdev_dsw_devargs_probe(
+			invalid_args[i]),
+			"Probed event_dsw with \"%s\"", invalid_args[i]);
+		TEST_ASSERT_EQUAL(rte_event_dev_get_dev_id("event_dsw_args"),
+			-ENODEV, "Device left behind by \"%s\"",
+			invalid_args[i]);
+	}
+
+	return TEST_SUCCESS;
+}
+
 REGISTER_TEST_COMMAND(eventdev_common_autotest, test_eventdev_common);
+REGISTER_TEST_COMMAND(eventdev_dsw_devargs_autotest,
+		test_eventdev_dsw_devargs);
 REGISTER_TEST_COMMAND(eventdev_selftest_sw, test_eventdev_selftest_sw);
 REGISTER_TEST_COMMAND(eventdev_selftest_octeontx,
 		test_eventdev_selftest_octeontx);
@@ -0,0 +1,836 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_gro.h>
+
+#include "test.h"
+
+/*
+ * Functional tests of the TCP/IPv6, VxLAN TCP/IPv6 and UDP/IPv4
+ * fragment GRO types: merging of in order and out of order packets,
+ * trimming of the Ethernet padding and the checks that must prevent
+ * a merge.
+ */
+
+#define NB_MBUFS 256
+#define MAX_PKTS 8
+#define BIG_PAYLOAD_LEN 40000
+#define BIG_BUF_SIZE (RTE_PKTMBUF_HEADROOM + BIG_PAYLOAD_LEN + 256)
+
+#define TCP_PAYLOAD_LEN 100
+#define FRAG_PAYLOAD_LEN 96
+#define PAD_LEN 8
+#define PAD_BYTE 0xee
+
+#define VXLAN_PORT 4789
+#define VXLAN_VNI 42
+
+#define TCP6_HDR_LEN (sizeof(struct rte_ether_hdr) + \
+		sizeof(struct rte_ipv6_hdr) + sizeof(struct rte_tcp_hdr))
+#define VXLAN_L2_LEN (sizeof(struct rte_udp_hdr) + \
+		sizeof(struct rte_vxlan_hdr) + sizeof(struct rte_ether_hdr))
+#define VXLAN_HDR_LEN (sizeof(struct rte_ether_hdr) + \
+		sizeof(struct rte_ipv4_hdr) + VXLAN_L2_LEN + \
+		sizeof(struct rte_ipv6_hdr) + sizeof(struct rte_tcp_hdr))
+#define UDP4_HDR_LEN (sizeof(struct rte_ether_hdr) + \
+		sizeof(struct rte_ipv4_hdr))
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *big_pool;
+
+static const struct rte_gro_param tcp6_param = {
+	.gro_types = RTE_GRO_TCP_IPV6,
+	.max_flow_num = 4,
+	.max_item_per_flow = MAX_PKTS,
+};
+
+static const struct rte_gro_param vxlan_tcp6_param = {
+	.gro_types = RTE_GRO_IPV4_VXLAN_TCP_IPV6,
+	.max_flow_num = 4,
+	.max_item_per_flow = MAX_PKTS,
+};
+
+static const struct rte_gro_param udp4_param = {
+	.gro_types = RTE_GRO_UDP_IPV4,
+	.max_flow_num = 4,
+	.max_item_per_flow = MAX_PKTS,
+};
+
+/* Byte at the offset of the TCP stream or of the UDP datagram */
+static inline uint8_t
+payload_byte(uint32_t off)
+{
+	return (uint8_t)(off % 251);
+}
+
+static void
+fill_payload(uint8_t *p, uint32_t off, uint16_t len, uint16_t pad_len)
+{
+	uint16_t i;
+
+	for (i = 0; i < len; i++)
+		p[i] = payload_byte(off + i);
+	memset(p + len, PAD_BYTE, pad_len);
+}
+
+/* Check the payload of a possibly segmented packet */
+static int
+check_payload(struct rte_mbuf *m, uint32_t hdr_len, uint32_t off,
+		uint32_t len)
+{
+	const uint8_t *b;
+	uint8_t copy;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL(m->pkt_len, hdr_len + len,
+			"Expected packet length %u got %u",
+			hdr_len + len, m->pkt_len);
+	for (i = 0; i < len; i++) {
+		b = rte_pktmbuf_read(m, hdr_len + i, 1, &copy);
+		TEST_ASSERT_NOT_NULL(b, "Cannot read payload byte %u", i);
+		TEST_ASSERT_EQUAL(*b, payload_byte(off + i),
+				"Bad payload byte %u", i);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static void
+free_pkts(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+static void
+init_eth_hdr(struct rte_ether_hdr *eth, uint16_t ether_type)
+{
+	static const struct rte_ether_addr src = {
+		.addr_bytes = {0x02, 0, 0, 0, 0, 0x01} };
+	static const struct rte_ether_addr dst = {
+		.addr_bytes = {0x02, 0, 0, 0, 0, 0x02} };
+
+	rte_ether_addr_copy(&src, &eth->s_addr);
+	rte_ether_addr_copy(&dst, &eth->d_addr);
+	eth->ether_type = rte_cpu_to_be_16(ether_type);
+}
+
+static void
+init_ipv6_tcp_hdr(struct rte_ipv6_hdr *ip6, struct rte_tcp_hdr *tcp,
+		uint32_t seq, uint16_t payload_len, uint8_t tcp_flags)
+{
+	ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip6->payload_len = rte_cpu_to_be_16(sizeof(*tcp) + payload_len);
+	ip6->proto = IPPROTO_TCP;
+	ip6->hop_limits = 64;
+	ip6->src_addr[0] = 0xfd;
+	ip6->src_addr[15] = 1;
+	ip6->dst_addr[0] = 0xfd;
+	ip6->dst_addr[15] = 2;
+
+	tcp->src_port = rte_cpu_to_be_16(1024);
+	tcp->dst_port = rte_cpu_to_be_16(80);
+	tcp->sent_seq = rte_cpu_to_be_32(seq);
+	tcp->recv_ack = rte_cpu_to_be_32(1);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = tcp_flags;
+	tcp->rx_win = rte_cpu_to_be_16(UINT16_MAX);
+}
+
+static struct rte_mbuf *
+make_tcp6_pkt(struct rte_mempool *mp, uint32_t seq, uint16_t payload_len,
+		uint8_t tcp_flags, uint16_t pad_len)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_tcp_hdr *tcp;
+	struct rte_mbuf *m;
+
+	m = rte_pktmbuf_alloc(mp);
+	if (m == NULL)
+		return NULL;
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(m,
+			TCP6_HDR_LEN + payload_len + pad_len);
+	if (eth == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(eth, 0, TCP6_HDR_LEN);
+
+	init_eth_hdr(eth, RTE_ETHER_TYPE_IPV6);
+	ip6 = (struct rte_ipv6_hdr *)(eth + 1);
+	tcp = (struct rte_tcp_hdr *)(ip6 + 1);
+	init_ipv6_tcp_hdr(ip6, tcp, seq, payload_len, tcp_flags);
+	fill_payload((uint8_t *)(tcp + 1), seq, payload_len, pad_len);
+
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+		RTE_PTYPE_L4_TCP;
+	m->l2_len = sizeof(*eth);
+	m->l3_len = sizeof(*ip6);
+	m->l4_len = sizeof(*tcp);
+
+	return m;
+}
+
+static struct rte_mbuf *
+make_vxlan_tcp6_pkt(uint32_t seq, uint16_t payload_len, uint8_t tcp_flags,
+		uint16_t outer_ip_id, int outer_df, uint32_t vni,
+		uint16_t pad_len)
+{
+	struct rte_ether_hdr *outer_eth, *eth;
+	struct rte_ipv4_hdr *outer_ip;
+	struct rte_udp_hdr *udp;
+	struct rte_vxlan_hdr *vxlan;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_tcp_hdr *tcp;
+	struct rte_mbuf *m;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+	outer_eth = (struct rte_ether_hdr *)rte_pktmbuf_append(m,
+			VXLAN_HDR_LEN + payload_len + pad_len);
+	if (outer_eth == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(outer_eth, 0, VXLAN_HDR_LEN);
+
+	init_eth_hdr(outer_eth, RTE_ETHER_TYPE_IPV4);
+	outer_ip = (struct rte_ipv4_hdr *)(outer_eth + 1);
+	outer_ip->version_ihl = RTE_IPV4_VHL_DEF;
+	outer_ip->total_length = rte_cpu_to_be_16(VXLAN_HDR_LEN -
+			sizeof(*outer_eth) + payload_len);
+	outer_ip->packet_id = rte_cpu_to_be_16(outer_ip_id);
+	outer_ip->fragment_offset =
+		rte_cpu_to_be_16(outer_df ? RTE_IPV4_HDR_DF_FLAG : 0);
+	outer_ip->time_to_live = 64;
+	outer_ip->next_proto_id = IPPROTO_UDP;
+	outer_ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(192, 168, 0, 1));
+	outer_ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(192, 168, 0, 2));
+
+	udp = (struct rte_udp_hdr *)(outer_ip + 1);
+	udp->src_port = rte_cpu_to_be_16(49152);
+	udp->dst_port = rte_cpu_to_be_16(VXLAN_PORT);
+	udp->dgram_len = rte_cpu_to_be_16(VXLAN_HDR_LEN -
+			sizeof(*outer_eth) - sizeof(*outer_ip) + payload_len);
+
+	vxlan = (struct rte_vxlan_hdr *)(udp + 1);
+	vxlan->vx_flags = rte_cpu_to_be_32(0x08000000);
+	vxlan->vx_vni = rte_cpu_to_be_32(vni << 8);
+
+	eth = (struct rte_ether_hdr *)(vxlan + 1);
+	init_eth_hdr(eth, RTE_ETHER_TYPE_IPV6);
+	ip6 = (struct rte_ipv6_hdr *)(eth + 1);
+	tcp = (struct rte_tcp_hdr *)(ip6 + 1);
+	init_ipv6_tcp_hdr(ip6, tcp, seq, payload_len, tcp_flags);
+	fill_payload((uint8_t *)(tcp + 1), seq, payload_len, pad_len);
+
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+		RTE_PTYPE_L4_UDP | RTE_PTYPE_TUNNEL_VXLAN |
+		RTE_PTYPE_INNER_L2_ETHER | RTE_PTYPE_INNER_L3_IPV6 |
+		RTE_PTYPE_INNER_L4_TCP;
+	m->outer_l2_len = sizeof(*outer_eth);
+	m->outer_l3_len = sizeof(*outer_ip);
+	m->l2_len = VXLAN_L2_LEN;
+	m->l3_len = sizeof(*ip6);
+	m->l4_len = sizeof(*tcp);
+
+	return m;
+}
+
+static struct rte_mbuf *
+make_udp4_frag(uint16_t ip_id, uint16_t frag_offset, uint16_t payload_len,
+		int more_frags, uint8_t proto, uint16_t pad_len)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_mbuf *m;
+	uint16_t frag_off;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(m,
+			UDP4_HDR_LEN + payload_len + pad_len);
+	if (eth == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(eth, 0, UDP4_HDR_LEN);
+
+	init_eth_hdr(eth, RTE_ETHER_TYPE_IPV4);
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	ip->version_ihl = RTE_IPV4_VHL_DEF;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + payload_len);
+	ip->packet_id = rte_cpu_to_be_16(ip_id);
+	frag_off = frag_offset / RTE_IPV4_HDR_OFFSET_UNITS;
+	if (more_frags)
+		frag_off |= RTE_IPV4_HDR_MF_FLAG;
+	ip->fragment_offset = rte_cpu_to_be_16(frag_off);
+	ip->time_to_live = 64;
+	ip->next_proto_id = proto;
+	ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 2));
+	fill_payload((uint8_t *)(ip + 1), frag_offset, payload_len, pad_len);
+
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+		RTE_PTYPE_L4_FRAG;
+	m->l2_len = sizeof(*eth);
+	m->l3_len = sizeof(*ip);
+
+	return m;
+}
+
+static int
+check_tcp6_pkt(struct rte_mbuf *m, uint32_t seq, uint32_t len,
+		uint16_t nb_segs)
+{
+	struct rte_ipv6_hdr *ip6;
+	struct rte_tcp_hdr *tcp;
+
+	ip6 = rte_pktmbuf_mtod_offset(m, struct rte_ipv6_hdr *,
+			sizeof(struct rte_ether_hdr));
+	tcp = (struct rte_tcp_hdr *)(ip6 + 1);
+
+	TEST_ASSERT_EQUAL(m->nb_segs, nb_segs, "Expected %u segments got %u",
+			nb_segs, m->nb_segs);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq), seq,
+			"Expected sequence number %u got %u", seq,
+			rte_be_to_cpu_32(tcp->sent_seq));
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip6->payload_len),
+			sizeof(*tcp) + len,
+			"Bad IPv6 payload length %u",
+			rte_be_to_cpu_16(ip6->payload_len));
+
+	return check_payload(m, TCP6_HDR_LEN, seq, len);
+}
+
+static int
+check_vxlan_tcp6_pkt(struct rte_mbuf *m, uint32_t seq, uint32_t len,
+		uint16_t nb_segs)
+{
+	struct rte_ipv4_hdr *outer_ip;
+	struct rte_udp_hdr *udp;
+	struct rte_ipv6_hdr *ip6;
+	struct rte_tcp_hdr *tcp;
+
+	outer_ip = rte_pktmbuf_mtod_offset(m, struct rte_ipv4_hdr *,
+			sizeof(struct rte_ether_hdr));
+	udp = (struct rte_udp_hdr *)(outer_ip + 1);
+	ip6 = (struct rte_ipv6_hdr *)((char *)udp + VXLAN_L2_LEN);
+	tcp = (struct rte_tcp_hdr *)(ip6 + 1);
+
+	TEST_ASSERT_EQUAL(m->nb_segs, nb_segs, "Expected %u segments got %u",
+			nb_segs, m->nb_segs);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq), seq,
+			"Expected sequence number %u got %u", seq,
+			rte_be_to_cpu_32(tcp->sent_seq));
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(outer_ip->total_length),
+			VXLAN_HDR_LEN - sizeof(struct rte_ether_hdr) + len,
+			"Bad outer IPv4 total length %u",
+			rte_be_to_cpu_16(outer_ip->total_length));
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(udp->dgram_len),
+			VXLAN_HDR_LEN - sizeof(struct rte_ether_hdr) -
+			sizeof(*outer_ip) + len,
+			"Bad outer UDP length %u",
+			rte_be_to_cpu_16(udp->dgram_len));
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip6->payload_len),
+			sizeof(*tcp) + len,
+			"Bad inner IPv6 payload length %u",
+			rte_be_to_cpu_16(ip6->payload_len));
+
+	return check_payload(m, VXLAN_HDR_LEN, seq, len);
+}
+
+static int
+check_udp4_pkt(struct rte_mbuf *m, uint16_t frag_offset, uint32_t len,
+		int more_frags, uint16_t nb_segs)
+{
+	struct rte_ipv4_hdr *ip;
+	uint16_t frag_off;
+
+	ip = rte_pktmbuf_mtod_offset(m, struct rte_ipv4_hdr *,
+			sizeof(struct rte_ether_hdr));
+	frag_off = rte_be_to_cpu_16(ip->fragment_offset);
+
+	TEST_ASSERT_EQUAL(m->nb_segs, nb_segs, "Expected %u segments got %u",
+			nb_segs, m->nb_segs);
+	TEST_ASSERT_EQUAL((frag_off & RTE_IPV4_HDR_OFFSET_MASK) *
+			RTE_IPV4_HDR_OFFSET_UNITS, frag_offset,
+			"Expected fragment offset %u got %u", frag_offset,
+			(frag_off & RTE_IPV4_HDR_OFFSET_MASK) *
+			RTE_IPV4_HDR_OFFSET_UNITS);
+	TEST_ASSERT_EQUAL(!!(frag_off & RTE_IPV4_HDR_MF_FLAG), !!more_frags,
+			"Bad MF bit");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+			sizeof(*ip) + len, "Bad IPv4 total length %u",
+			rte_be_to_cpu_16(ip->total_length));
+
+	return check_payload(m, UDP4_HDR_LEN, frag_offset, len);
+}
+
+/* Reassemble a burst of packets none of which must be merged */
+static int
+check_no_merge(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		const struct rte_gro_param *param)
+{
+	uint16_t nb_out, i;
+
+	for (i = 0; i < nb_pkts; i++)
+		TEST_ASSERT_NOT_NULL(pkts[i], "Cannot allocate packet %u", i);
+
+	nb_out = rte_gro_reassemble_burst(pkts, nb_pkts, param);
+	for (i = 0; i < nb_out; i++)
+		TEST_ASSERT_EQUAL(pkts[i]->nb_segs, 1,
+				"Packet %u was merged", i);
+	free_pkts(pkts, nb_out);
+	TEST_ASSERT_EQUAL(nb_out, nb_pkts, "Expected %u packets got %u",
+			nb_pkts, nb_out);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_tcp6_merge(void)
+{
+	/* Segment indexes in arrival order */
+	static const uint8_t orders[][3] = {
+		{0, 1, 2},
+		{1, 0, 2},
+		{2, 1, 0},
+	};
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint16_t nb_out;
+	uint32_t i, j;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(orders); i++) {
+		for (j = 0; j < 3; j++) {
+			pkts[j] = make_tcp6_pkt(pkt_pool,
+					orders[i][j] * TCP_PAYLOAD_LEN,
+					TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG, 0);
+			TEST_ASSERT_NOT_NULL(pkts[j], "Cannot allocate packet");
+		}
+
+		nb_out = rte_gro_reassemble_burst(pkts, 3, &tcp6_param);
+		ret = nb_out == 1 ? check_tcp6_pkt(pkts[0], 0,
+				3 * TCP_PAYLOAD_LEN, 3) : TEST_FAILED;
+		free_pkts(pkts, nb_out);
+		TEST_ASSERT_SUCCESS(ret, "Bad merge of order %u, %u packets",
+				i, nb_out);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_tcp6_padding(void)
+{
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint16_t nb_out;
+	int ret;
+
+	pkts[0] = make_tcp6_pkt(pkt_pool, 0, 10, RTE_TCP_ACK_FLAG, PAD_LEN);
+	pkts[1] = make_tcp6_pkt(pkt_pool, 10, 10, RTE_TCP_ACK_FLAG, PAD_LEN);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"Cannot allocate packets");
+
+	nb_out = rte_gro_reassemble_burst(pkts, 2, &tcp6_param);
+	ret = nb_out == 1 ? check_tcp6_pkt(pkts[0], 0, 20, 2) : TEST_FAILED;
+	free_pkts(pkts, nb_out);
+	TEST_ASSERT_SUCCESS(ret, "Bad merge of padded packets, %u packets",
+			nb_out);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_tcp6_no_merge(void)
+{
+	struct rte_mbuf *pkts[MAX_PKTS];
+
+	/* Sequence number gap */
+	pkts[0] = make_tcp6_pkt(pkt_pool, 0, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 0);
+	pkts[1] = make_tcp6_pkt(pkt_pool, 2 * TCP_PAYLOAD_LEN,
+			TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &tcp6_param),
+			"Segments with a gap merged");
+
+	/* PSH flag */
+	pkts[0] = make_tcp6_pkt(pkt_pool, 0, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 0);
+	pkts[1] = make_tcp6_pkt(pkt_pool, TCP_PAYLOAD_LEN, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG | RTE_TCP_PSH_FLAG, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &tcp6_param),
+			"Segment with PSH merged");
+
+	/* No payload */
+	pkts[0] = make_tcp6_pkt(pkt_pool, 0, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 0);
+	pkts[1] = make_tcp6_pkt(pkt_pool, TCP_PAYLOAD_LEN, 0,
+			RTE_TCP_ACK_FLAG, PAD_LEN);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &tcp6_param),
+			"Segment without payload merged");
+
+	/* Merged packet longer than the maximum IP packet length */
+	pkts[0] = make_tcp6_pkt(big_pool, 0, BIG_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 0);
+	pkts[1] = make_tcp6_pkt(big_pool, BIG_PAYLOAD_LEN, BIG_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &tcp6_param),
+			"Too long segments merged");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_vxlan_tcp6_merge(void)
+{
+	/* Segment indexes in arrival order */
+	static const uint8_t orders[][3] = {
+		{0, 1, 2},
+		{1, 0, 2},
+		{2, 1, 0},
+	};
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint16_t nb_out;
+	uint32_t i, j;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(orders); i++) {
+		/* The outer IPv4 IDs follow the segments */
+		for (j = 0; j < 3; j++) {
+			pkts[j] = make_vxlan_tcp6_pkt(
+					orders[i][j] * TCP_PAYLOAD_LEN,
+					TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG,
+					1 + orders[i][j], 0, VXLAN_VNI, 0);
+			TEST_ASSERT_NOT_NULL(pkts[j], "Cannot allocate packet");
+		}
+
+		nb_out = rte_gro_reassemble_burst(pkts, 3, &vxlan_tcp6_param);
+		ret = nb_out == 1 ? check_vxlan_tcp6_pkt(pkts[0], 0,
+				3 * TCP_PAYLOAD_LEN, 3) : TEST_FAILED;
+		free_pkts(pkts, nb_out);
+		TEST_ASSERT_SUCCESS(ret, "Bad merge of order %u, %u packets",
+				i, nb_out);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_vxlan_tcp6_padding(void)
+{
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint16_t nb_out;
+	int ret;
+
+	pkts[0] = make_vxlan_tcp6_pkt(0, 10, RTE_TCP_ACK_FLAG, 1, 1,
+			VXLAN_VNI, PAD_LEN);
+	pkts[1] = make_vxlan_tcp6_pkt(10, 10, RTE_TCP_ACK_FLAG, 7, 1,
+			VXLAN_VNI, PAD_LEN);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"Cannot allocate packets");
+
+	/* The outer IPv4 ID of DF packets is ignored */
+	nb_out = rte_gro_reassemble_burst(pkts, 2, &vxlan_tcp6_param);
+	ret = nb_out == 1 ? check_vxlan_tcp6_pkt(pkts[0], 0, 20, 2) :
+		TEST_FAILED;
+	free_pkts(pkts, nb_out);
+	TEST_ASSERT_SUCCESS(ret, "Bad merge of padded packets, %u packets",
+			nb_out);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_vxlan_tcp6_no_merge(void)
+{
+	struct rte_mbuf *pkts[MAX_PKTS];
+
+	/* Outer IPv4 ID gap without DF */
+	pkts[0] = make_vxlan_tcp6_pkt(0, TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG,
+			1, 0, VXLAN_VNI, 0);
+	pkts[1] = make_vxlan_tcp6_pkt(TCP_PAYLOAD_LEN, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 3, 0, VXLAN_VNI, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &vxlan_tcp6_param),
+			"Packets with an outer IPv4 ID gap merged");
+
+	/* Different outer DF bits */
+	pkts[0] = make_vxlan_tcp6_pkt(0, TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG,
+			1, 1, VXLAN_VNI, 0);
+	pkts[1] = make_vxlan_tcp6_pkt(TCP_PAYLOAD_LEN, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 2, 0, VXLAN_VNI, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &vxlan_tcp6_param),
+			"Packets with different outer DF bits merged");
+
+	/* Different VNIs */
+	pkts[0] = make_vxlan_tcp6_pkt(0, TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG,
+			1, 0, VXLAN_VNI, 0);
+	pkts[1] = make_vxlan_tcp6_pkt(TCP_PAYLOAD_LEN, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG, 2, 0, VXLAN_VNI + 1, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &vxlan_tcp6_param),
+			"Packets of different VNIs merged");
+
+	/* Inner FIN flag */
+	pkts[0] = make_vxlan_tcp6_pkt(0, TCP_PAYLOAD_LEN, RTE_TCP_ACK_FLAG,
+			1, 0, VXLAN_VNI, 0);
+	pkts[1] = make_vxlan_tcp6_pkt(TCP_PAYLOAD_LEN, TCP_PAYLOAD_LEN,
+			RTE_TCP_ACK_FLAG | RTE_TCP_FIN_FLAG, 2, 0,
+			VXLAN_VNI, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &vxlan_tcp6_param),
+			"Packet with FIN merged");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_udp4_merge(void)
+{
+	/* Fragment indexes in arrival order */
+	static const uint8_t orders[][3] = {
+		{0, 1, 2},
+		{2, 0, 1},
+		{1, 2, 0},
+	};
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint16_t nb_out;
+	uint32_t i, j;
+	int ret;
+
+	for (i = 0; i < RTE_DIM(orders); i++) {
+		for (j = 0; j < 3; j++) {
+			pkts[j] = make_udp4_frag(1,
+					orders[i][j] * FRAG_PAYLOAD_LEN,
+					FRAG_PAYLOAD_LEN, orders[i][j] != 2,
+					IPPROTO_UDP, 0);
+			TEST_ASSERT_NOT_NULL(pkts[j], "Cannot allocate packet");
+		}
+
+		nb_out = rte_gro_reassemble_burst(pkts, 3, &udp4_param);
+		ret = nb_out == 1 ? check_udp4_pkt(pkts[0], 0,
+				3 * FRAG_PAYLOAD_LEN, 0, 3) : TEST_FAILED;
+		free_pkts(pkts, nb_out);
+		TEST_ASSERT_SUCCESS(ret, "Bad merge of order %u, %u packets",
+				i, nb_out);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_udp4_padding(void)
+{
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint16_t nb_out;
+	int ret;
+
+	/* Fragments shorter than the minimum Ethernet frame */
+	pkts[0] = make_udp4_frag(1, 0, 16, 1, IPPROTO_UDP, PAD_LEN);
+	pkts[1] = make_udp4_frag(1, 16, 10, 0, IPPROTO_UDP, PAD_LEN);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"Cannot allocate packets");
+
+	nb_out = rte_gro_reassemble_burst(pkts, 2, &udp4_param);
+	ret = nb_out == 1 ? check_udp4_pkt(pkts[0], 0, 26, 0, 2) :
+		TEST_FAILED;
+	free_pkts(pkts, nb_out);
+	TEST_ASSERT_SUCCESS(ret, "Bad merge of padded fragments, %u packets",
+			nb_out);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_udp4_timeout_flush(void)
+{
+	struct rte_gro_param param = udp4_param;
+	struct rte_mbuf *pkts[MAX_PKTS];
+	uint64_t timeout = rte_get_tsc_hz() * 10;
+	uint16_t nb_out;
+	void *ctx;
+	int ret;
+
+	param.socket_id = rte_socket_id();
+	ctx = rte_gro_ctx_create(&param);
+	TEST_ASSERT_NOT_NULL(ctx, "Cannot create GRO context");
+
+	/* The middle fragment is missing */
+	pkts[0] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(1, 2 * FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN,
+			0, IPPROTO_UDP, 0);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"Cannot allocate packets");
+	ret = rte_gro_reassemble(pkts, 2, ctx);
+	TEST_ASSERT_EQUAL(ret, 0, "%d fragments not stored", ret);
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 2,
+			"Expected 2 stored fragments");
+
+	nb_out = rte_gro_timeout_flush(ctx, timeout, RTE_GRO_UDP_IPV4, pkts,
+			MAX_PKTS);
+	TEST_ASSERT_EQUAL(nb_out, 0, "%u fragments flushed before timeout",
+			nb_out);
+
+	/* The incomplete datagram is flushed unmodified */
+	nb_out = rte_gro_timeout_flush(ctx, 0, RTE_GRO_UDP_IPV4, pkts,
+			MAX_PKTS);
+	ret = TEST_FAILED;
+	if (nb_out == 2 && check_udp4_pkt(pkts[0], 0, FRAG_PAYLOAD_LEN, 1,
+				1) == TEST_SUCCESS)
+		ret = check_udp4_pkt(pkts[1], 2 * FRAG_PAYLOAD_LEN,
+				FRAG_PAYLOAD_LEN, 0, 1);
+	free_pkts(pkts, nb_out);
+	if (ret != TEST_SUCCESS) {
+		rte_gro_ctx_destroy(ctx);
+		TEST_ASSERT_SUCCESS(ret, "Bad timeout flush, %u fragments",
+				nb_out);
+	}
+
+	/* The middle fragment arrives in a later burst */
+	pkts[0] = make_udp4_frag(1, 2 * FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN,
+			0, IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_UDP, 0);
+	pkts[2] = make_udp4_frag(1, FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN, 1,
+			IPPROTO_UDP, 0);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL && pkts[2] != NULL,
+			"Cannot allocate packets");
+	ret = rte_gro_reassemble(pkts, 2, ctx);
+	ret += rte_gro_reassemble(&pkts[2], 1, ctx);
+	TEST_ASSERT_EQUAL(ret, 0, "%d fragments not stored", ret);
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 1,
+			"Expected 1 reassembled datagram");
+
+	nb_out = rte_gro_timeout_flush(ctx, 0, RTE_GRO_UDP_IPV4, pkts,
+			MAX_PKTS);
+	ret = nb_out == 1 ? check_udp4_pkt(pkts[0], 0, 3 * FRAG_PAYLOAD_LEN,
+			0, 3) : TEST_FAILED;
+	free_pkts(pkts, nb_out);
+	rte_gro_ctx_destroy(ctx);
+	TEST_ASSERT_SUCCESS(ret, "Bad reassembly, %u packets", nb_out);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_udp4_no_merge(void)
+{
+	struct rte_mbuf *pkts[MAX_PKTS];
+
+	/* Different IPv4 IDs */
+	pkts[0] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(2, FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN, 0,
+			IPPROTO_UDP, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &udp4_param),
+			"Fragments of different datagrams merged");
+
+	/* Offset gap */
+	pkts[0] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(1, 2 * FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN,
+			0, IPPROTO_UDP, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &udp4_param),
+			"Fragments with a gap merged");
+
+	/* Overlapping fragments */
+	pkts[0] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(1, FRAG_PAYLOAD_LEN / 2, FRAG_PAYLOAD_LEN,
+			0, IPPROTO_UDP, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &udp4_param),
+			"Overlapping fragments merged");
+
+	/* Fragment following the last one */
+	pkts[0] = make_udp4_frag(1, FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN, 0,
+			IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(1, 2 * FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN,
+			1, IPPROTO_UDP, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &udp4_param),
+			"Fragment merged after the last one");
+
+	/* Unfragmented datagram */
+	pkts[0] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_UDP, 0);
+	pkts[1] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 0, IPPROTO_UDP, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &udp4_param),
+			"Unfragmented datagram merged");
+
+	/* Fragments of a TCP segment */
+	pkts[0] = make_udp4_frag(1, 0, FRAG_PAYLOAD_LEN, 1, IPPROTO_TCP, 0);
+	pkts[1] = make_udp4_frag(1, FRAG_PAYLOAD_LEN, FRAG_PAYLOAD_LEN, 0,
+			IPPROTO_TCP, 0);
+	TEST_ASSERT_SUCCESS(check_no_merge(pkts, 2, &udp4_param),
+			"TCP fragments merged");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_setup(void)
+{
+	pkt_pool = rte_pktmbuf_pool_create("test_gro_pool", NB_MBUFS, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (pkt_pool == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return TEST_FAILED;
+	}
+
+	big_pool = rte_pktmbuf_pool_create("test_gro_big_pool", MAX_PKTS, 0,
+			0, BIG_BUF_SIZE, rte_socket_id());
+	if (big_pool == NULL) {
+		printf("Cannot create big mbuf pool\n");
+		rte_mempool_free(pkt_pool);
+		pkt_pool = NULL;
+		return TEST_FAILED;
+	}
+
+	return TEST_SUCCESS;
+}
+
+static void
+test_gro_teardown(void)
+{
+	rte_mempool_free(big_pool);
+	big_pool = NULL;
+	rte_mempool_free(pkt_pool);
+	pkt_pool = NULL;
+}
+
+static struct unit_test_suite gro_test_suite = {
+	.suite_name = "GRO Unit Test Suite",
+	.setup = test_gro_setup,
+	.teardown = test_gro_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_gro_tcp6_merge),
+		TEST_CASE(test_gro_tcp6_padding),
+		TEST_CASE(test_gro_tcp6_no_merge),
+		TEST_CASE(test_gro_vxlan_tcp6_merge),
+		TEST_CASE(test_gro_vxlan_tcp6_padding),
+		TEST_CASE(test_gro_vxlan_tcp6_no_merge),
+		TEST_CASE(test_gro_udp4_merge),
+		TEST_CASE(test_gro_udp4_padding),
+		TEST_CASE(test_gro_udp4_timeout_flush),
+		TEST_CASE(test_gro_udp4_no_merge),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_gro(void)
+{
+	return unit_test_suite_runner(&gro_test_suite);
+}
+
+REGISTER_TEST_COMMAND(gro_autotest, test_gro);
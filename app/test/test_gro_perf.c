@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_gro.h>
+
+#include "test.h"
+
+/*
+ * Measure the cost of rte_gro_reassemble() according to the number of
+ * active flows. The TCP/IPv4 segments of the flows are interleaved, so
+ * each packet requires a lookup among all the flows of the table.
+ */
+
+#define SEGS_PER_FLOW 4
+#define PAYLOAD_LEN 64
+#define BURST_SIZE 32U
+#define ITERATIONS 16
+#define MAX_FLOW_NUM 4096
+#define NB_MBUFS (MAX_FLOW_NUM * SEGS_PER_FLOW)
+#define HDR_LEN (sizeof(struct rte_ether_hdr) + \
+		sizeof(struct rte_ipv4_hdr) + sizeof(struct rte_tcp_hdr))
+
+static const uint32_t flow_nums[] = {16, 64, 256, 1024, MAX_FLOW_NUM};
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mbuf *pkts[NB_MBUFS];
+
+static void
+init_tcp4_pkt(struct rte_mbuf *m, uint32_t flow, uint32_t seg)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_tcp_hdr *tcp;
+
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(m,
+			HDR_LEN + PAYLOAD_LEN);
+	memset(eth, 0, HDR_LEN);
+	eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	ip->version_ihl = RTE_IPV4_VHL_DEF;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + sizeof(*tcp) +
+			PAYLOAD_LEN);
+	ip->fragment_offset = rte_cpu_to_be_16(RTE_IPV4_HDR_DF_FLAG);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_TCP;
+	ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, flow >> 8, flow));
+	ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(10, 1, 0, 1));
+
+	tcp = (struct rte_tcp_hdr *)(ip + 1);
+	tcp->src_port = rte_cpu_to_be_16(1024 + flow);
+	tcp->dst_port = rte_cpu_to_be_16(80);
+	tcp->sent_seq = rte_cpu_to_be_32(seg * PAYLOAD_LEN);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = RTE_TCP_ACK_FLAG;
+
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+		RTE_PTYPE_L4_TCP;
+	m->l2_len = sizeof(*eth);
+	m->l3_len = sizeof(*ip);
+	m->l4_len = sizeof(*tcp);
+}
+
+static int
+test_gro_perf_flows(uint32_t nb_flows)
+{
+	struct rte_gro_param param = {
+		.gro_types = RTE_GRO_TCP_IPV4,
+		.max_flow_num = nb_flows,
+		.max_item_per_flow = SEGS_PER_FLOW,
+		.socket_id = rte_socket_id(),
+	};
+	uint32_t nb_pkts = nb_flows * SEGS_PER_FLOW;
+	uint64_t start, reassemble_cycles = 0, flush_cycles = 0;
+	uint32_t i, j, iter, nb_out;
+	uint16_t nb_unprocessed;
+	void *ctx;
+
+	ctx = rte_gro_ctx_create(&param);
+	if (ctx == NULL) {
+		printf("Cannot create GRO context for %u flows\n", nb_flows);
+		return -1;
+	}
+
+	for (iter = 0; iter < ITERATIONS; iter++) {
+		if (rte_pktmbuf_alloc_bulk(pkt_pool, pkts, nb_pkts) != 0) {
+			printf("Cannot allocate %u packets\n", nb_pkts);
+			goto error;
+		}
+		/* interleave the segments of all the flows */
+		for (i = 0; i < nb_pkts; i++)
+			init_tcp4_pkt(pkts[i], i % nb_flows, i / nb_flows);
+
+		start = rte_rdtsc_precise();
+		for (i = 0; i < nb_pkts; i += BURST_SIZE) {
+			nb_unprocessed = rte_gro_reassemble(&pkts[i],
+					RTE_MIN(BURST_SIZE, nb_pkts - i), ctx);
+			if (nb_unprocessed != 0) {
+				printf("%u packets not merged\n",
+						nb_unprocessed);
+				goto error;
+			}
+		}
+		reassemble_cycles += rte_rdtsc_precise() - start;
+
+		start = rte_rdtsc_precise();
+		nb_out = rte_gro_timeout_flush(ctx, 0, RTE_GRO_TCP_IPV4,
+				pkts, nb_pkts);
+		flush_cycles += rte_rdtsc_precise() - start;
+
+		if (nb_out != nb_flows) {
+			printf("%u packets flushed, expected %u\n", nb_out,
+					nb_flows);
+			goto error;
+		}
+		for (j = 0; j < nb_out; j++) {
+			if (pkts[j]->pkt_len !=
+					HDR_LEN + SEGS_PER_FLOW * PAYLOAD_LEN) {
+				printf("Bad merged packet length %u\n",
+						pkts[j]->pkt_len);
+				goto error;
+			}
+		}
+		for (j = 0; j < nb_out; j++)
+			rte_pktmbuf_free(pkts[j]);
+	}
+
+	printf("%8u %16"PRIu64" %16"PRIu64"\n", nb_flows,
+			reassemble_cycles / (ITERATIONS * nb_pkts),
+			flush_cycles / (ITERATIONS * nb_flows));
+
+	rte_gro_ctx_destroy(ctx);
+	return 0;
+
+error:
+	rte_gro_ctx_destroy(ctx);
+	return -1;
+}
+
+static int
+test_gro_perf(void)
+{
+	unsigned int i;
+	int ret = 0;
+
+	pkt_pool = rte_pktmbuf_pool_create("GRO_PERF_POOL", NB_MBUFS, 0, 0,
+			RTE_PKTMBUF_HEADROOM + HDR_LEN + PAYLOAD_LEN,
+			rte_socket_id());
+	if (pkt_pool == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+
+	printf("TCP/IPv4 GRO, %u segments of %u bytes per flow\n",
+			SEGS_PER_FLOW, PAYLOAD_LEN);
+	printf("%8s %16s %16s\n", "flows", "cycles/packet", "flush cyc/flow");
+	for (i = 0; i < RTE_DIM(flow_nums); i++) {
+		ret = test_gro_perf_flows(flow_nums[i]);
+		if (ret != 0)
+			break;
+	}
+
+	rte_mempool_free(pkt_pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(gro_perf_autotest, test_gro_perf);
@@ -0,0 +1,346 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_gso.h>
+
+#include "test.h"
+
+/*
+ * Measure the number of GSO segments produced per second by
+ * rte_gso_segment() for the supported packet types, after checking
+ * the segments of each type once.
+ */
+
+#define PAYLOAD_LEN 16000U
+#define GSO_SIZE 1500U
+#define MAX_SEGS 64
+#define ITERATIONS 20000
+#define NB_MBUFS 2048
+#define BIG_MBUF_SIZE (RTE_PKTMBUF_HEADROOM + 256 + PAYLOAD_LEN)
+
+#define VXLAN_HDR_LEN 8
+#define GRE_HDR_LEN 4
+#define VXLAN_PORT 4789
+
+#define TUNNEL_VXLAN 1
+#define TUNNEL_GRE 2
+
+struct gso_perf_type {
+	const char *name;
+	uint32_t gso_types;
+	uint8_t outer_ip; /* 0 for no tunnel, 4 or 6 */
+	uint8_t tunnel; /* TUNNEL_VXLAN or TUNNEL_GRE */
+	uint8_t inner_ip; /* 4 or 6 */
+	uint8_t l4_proto; /* IPPROTO_TCP or IPPROTO_UDP */
+};
+
+static const struct gso_perf_type gso_perf_types[] = {
+	{ "TCP/IPv4", DEV_TX_OFFLOAD_TCP_TSO, 0, 0, 4, IPPROTO_TCP },
+	{ "TCP/IPv6", DEV_TX_OFFLOAD_TCP_TSO, 0, 0, 6, IPPROTO_TCP },
+	{ "VxLAN/IPv6 TCP/IPv4", DEV_TX_OFFLOAD_VXLAN_TNL_TSO,
+		6, TUNNEL_VXLAN, 4, IPPROTO_TCP },
+	{ "VxLAN/IPv4 TCP/IPv6", DEV_TX_OFFLOAD_VXLAN_TNL_TSO,
+		4, TUNNEL_VXLAN, 6, IPPROTO_TCP },
+	{ "VxLAN/IPv6 TCP/IPv6", DEV_TX_OFFLOAD_VXLAN_TNL_TSO,
+		6, TUNNEL_VXLAN, 6, IPPROTO_TCP },
+	{ "GRE/IPv6 TCP/IPv4", DEV_TX_OFFLOAD_GRE_TNL_TSO,
+		6, TUNNEL_GRE, 4, IPPROTO_TCP },
+	{ "GRE/IPv6 TCP/IPv6", DEV_TX_OFFLOAD_GRE_TNL_TSO,
+		6, TUNNEL_GRE, 6, IPPROTO_TCP },
+	{ "UDP/IPv4", DEV_TX_OFFLOAD_UDP_TSO, 0, 0, 4, IPPROTO_UDP },
+	{ "UDP/IPv6", DEV_TX_OFFLOAD_UDP_TSO, 0, 0, 6, IPPROTO_UDP },
+};
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *hdr_pool;
+static struct rte_mempool *indirect_pool;
+
+static uint16_t
+write_ip_hdr(char *p, uint8_t version, uint8_t proto, uint16_t pyld_len)
+{
+	struct rte_ipv4_hdr *ipv4_hdr;
+	struct rte_ipv6_hdr *ipv6_hdr;
+
+	if (version == 4) {
+		ipv4_hdr = (struct rte_ipv4_hdr *)p;
+		ipv4_hdr->version_ihl = RTE_IPV4_VHL_DEF;
+		ipv4_hdr->total_length = rte_cpu_to_be_16(sizeof(*ipv4_hdr) +
+				pyld_len);
+		ipv4_hdr->packet_id = rte_cpu_to_be_16(1);
+		ipv4_hdr->fragment_offset =
+			rte_cpu_to_be_16(RTE_IPV4_HDR_DF_FLAG);
+		ipv4_hdr->time_to_live = 64;
+		ipv4_hdr->next_proto_id = proto;
+		ipv4_hdr->src_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 1));
+		ipv4_hdr->dst_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 2));
+		return sizeof(*ipv4_hdr);
+	}
+
+	ipv6_hdr = (struct rte_ipv6_hdr *)p;
+	ipv6_hdr->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ipv6_hdr->payload_len = rte_cpu_to_be_16(pyld_len);
+	ipv6_hdr->proto = proto;
+	ipv6_hdr->hop_limits = 64;
+	ipv6_hdr->src_addr[15] = 1;
+	ipv6_hdr->dst_addr[15] = 2;
+	return sizeof(*ipv6_hdr);
+}
+
+static struct rte_mbuf *
+build_pkt(const struct gso_perf_type *type)
+{
+	struct rte_ether_hdr *eth_hdr;
+	struct rte_udp_hdr *udp_hdr;
+	struct rte_tcp_hdr *tcp_hdr;
+	struct rte_mbuf *m;
+	uint16_t l4_len, inner_len, outer_pyld_len, off = 0;
+	char *p;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	l4_len = type->l4_proto == IPPROTO_TCP ? sizeof(*tcp_hdr) :
+		sizeof(*udp_hdr);
+	m->l3_len = type->inner_ip == 4 ? sizeof(struct rte_ipv4_hdr) :
+		sizeof(struct rte_ipv6_hdr);
+	m->l4_len = l4_len;
+	m->l2_len = sizeof(*eth_hdr);
+	inner_len = m->l3_len + l4_len + PAYLOAD_LEN;
+
+	p = rte_pktmbuf_append(m, 256 + PAYLOAD_LEN);
+	memset(p, 0, 256);
+	eth_hdr = (struct rte_ether_hdr *)p;
+
+	if (type->outer_ip != 0) {
+		m->ol_flags |= type->outer_ip == 4 ? PKT_TX_OUTER_IPV4 :
+			PKT_TX_OUTER_IPV6;
+		eth_hdr->ether_type = rte_cpu_to_be_16(type->outer_ip == 4 ?
+				RTE_ETHER_TYPE_IPV4 : RTE_ETHER_TYPE_IPV6);
+		m->outer_l2_len = sizeof(*eth_hdr);
+		off = sizeof(*eth_hdr);
+
+		if (type->tunnel == TUNNEL_VXLAN) {
+			m->ol_flags |= PKT_TX_TUNNEL_VXLAN;
+			m->l2_len = sizeof(*udp_hdr) + VXLAN_HDR_LEN +
+				sizeof(*eth_hdr);
+			outer_pyld_len = m->l2_len + inner_len;
+			m->outer_l3_len = write_ip_hdr(p + off,
+					type->outer_ip, IPPROTO_UDP,
+					outer_pyld_len);
+			off += m->outer_l3_len;
+			udp_hdr = (struct rte_udp_hdr *)(p + off);
+			udp_hdr->dst_port = rte_cpu_to_be_16(VXLAN_PORT);
+			udp_hdr->dgram_len = rte_cpu_to_be_16(outer_pyld_len);
+			off += sizeof(*udp_hdr) + VXLAN_HDR_LEN;
+			eth_hdr = (struct rte_ether_hdr *)(p + off);
+			eth_hdr->ether_type = rte_cpu_to_be_16(
+					type->inner_ip == 4 ?
+					RTE_ETHER_TYPE_IPV4 :
+					RTE_ETHER_TYPE_IPV6);
+			off += sizeof(*eth_hdr);
+		} else {
+			m->ol_flags |= PKT_TX_TUNNEL_GRE;
+			m->l2_len = GRE_HDR_LEN;
+			m->outer_l3_len = write_ip_hdr(p + off,
+					type->outer_ip, IPPROTO_GRE,
+					m->l2_len + inner_len);
+			off += m->outer_l3_len;
+			*(uint16_t *)(p + off + 2) = rte_cpu_to_be_16(
+					type->inner_ip == 4 ?
+					RTE_ETHER_TYPE_IPV4 :
+					RTE_ETHER_TYPE_IPV6);
+			off += GRE_HDR_LEN;
+		}
+	} else {
+		eth_hdr->ether_type = rte_cpu_to_be_16(type->inner_ip == 4 ?
+				RTE_ETHER_TYPE_IPV4 : RTE_ETHER_TYPE_IPV6);
+		off = sizeof(*eth_hdr);
+	}
+
+	m->ol_flags |= type->inner_ip == 4 ? PKT_TX_IPV4 : PKT_TX_IPV6;
+	off += write_ip_hdr(p + off, type->inner_ip, type->l4_proto,
+			l4_len + PAYLOAD_LEN);
+	if (type->l4_proto == IPPROTO_TCP) {
+		m->ol_flags |= PKT_TX_TCP_SEG;
+		tcp_hdr = (struct rte_tcp_hdr *)(p + off);
+		tcp_hdr->sent_seq = rte_cpu_to_be_32(1000);
+		tcp_hdr->data_off = (sizeof(*tcp_hdr) / 4) << 4;
+		tcp_hdr->tcp_flags = RTE_TCP_ACK_FLAG | RTE_TCP_PSH_FLAG;
+	} else {
+		m->ol_flags |= PKT_TX_UDP_SEG;
+		udp_hdr = (struct rte_udp_hdr *)(p + off);
+		udp_hdr->dgram_len = rte_cpu_to_be_16(l4_len + PAYLOAD_LEN);
+	}
+	off += l4_len;
+
+	/* trim the unused header room */
+	memmove(p + off, p + 256, PAYLOAD_LEN);
+	rte_pktmbuf_trim(m, 256 - off);
+	return m;
+}
+
+/* Check the payload and the innermost L3 length of the segments */
+static int
+check_segments(const struct gso_perf_type *type, struct rte_mbuf *pkt,
+		struct rte_mbuf **segs, int nb_segs)
+{
+	struct rte_ipv4_hdr *ipv4_hdr;
+	struct rte_ipv6_hdr *ipv6_hdr;
+	uint32_t hdr_len, l3_off, pyld_len, total = 0;
+	int i;
+
+	l3_off = pkt->outer_l2_len + pkt->outer_l3_len + pkt->l2_len;
+	hdr_len = l3_off + pkt->l3_len +
+		(type->l4_proto == IPPROTO_TCP ? pkt->l4_len : 0);
+
+	for (i = 0; i < nb_segs; i++) {
+		if (segs[i]->pkt_len > GSO_SIZE) {
+			printf("%s: segment %d too long: %u\n", type->name, i,
+					segs[i]->pkt_len);
+			return -1;
+		}
+		pyld_len = segs[i]->pkt_len - hdr_len;
+		if (type->inner_ip == 4) {
+			ipv4_hdr = rte_pktmbuf_mtod_offset(segs[i],
+					struct rte_ipv4_hdr *, l3_off);
+			if (rte_be_to_cpu_16(ipv4_hdr->total_length) !=
+					segs[i]->pkt_len - l3_off)
+				goto bad_len;
+		} else {
+			ipv6_hdr = rte_pktmbuf_mtod_offset(segs[i],
+					struct rte_ipv6_hdr *, l3_off);
+			if (rte_be_to_cpu_16(ipv6_hdr->payload_len) !=
+					segs[i]->pkt_len - l3_off -
+					sizeof(*ipv6_hdr))
+				goto bad_len;
+			/* IPv6 fragments carry a fragment header */
+			if (type->l4_proto == IPPROTO_UDP)
+				pyld_len -= RTE_IPV6_FRAG_HDR_SIZE;
+		}
+		total += pyld_len;
+	}
+
+	if (total != PAYLOAD_LEN +
+			(type->l4_proto == IPPROTO_UDP ? pkt->l4_len : 0)) {
+		printf("%s: %u bytes of payload in %d segments\n",
+				type->name, total, nb_segs);
+		return -1;
+	}
+	return 0;
+
+bad_len:
+	printf("%s: bad L3 length in segment %d\n", type->name, i);
+	return -1;
+}
+
+static int
+test_gso_perf_type(const struct gso_perf_type *type)
+{
+	struct rte_gso_ctx ctx = {
+		.direct_pool = hdr_pool,
+		.indirect_pool = indirect_pool,
+		.flag = 0,
+		.gso_types = type->gso_types,
+		.gso_size = GSO_SIZE,
+	};
+	struct rte_mbuf *segs[MAX_SEGS];
+	struct rte_mbuf *pkt;
+	uint64_t ol_flags, start, cycles, nb_total = 0;
+	uint32_t iter;
+	int nb_segs, i;
+
+	pkt = build_pkt(type);
+	if (pkt == NULL) {
+		printf("%s: cannot build packet\n", type->name);
+		return -1;
+	}
+	ol_flags = pkt->ol_flags;
+
+	/* Keep the input packet: the segments only hold a reference. */
+	rte_mbuf_refcnt_update(pkt, 1);
+	nb_segs = rte_gso_segment(pkt, &ctx, segs, MAX_SEGS);
+	if (nb_segs <= 1 || check_segments(type, pkt, segs, nb_segs) < 0) {
+		printf("%s: segmentation failed (%d)\n", type->name, nb_segs);
+		goto error;
+	}
+	for (i = 0; i < nb_segs; i++)
+		rte_pktmbuf_free(segs[i]);
+
+	start = rte_rdtsc_precise();
+	for (iter = 0; iter < ITERATIONS; iter++) {
+		pkt->ol_flags = ol_flags;
+		rte_mbuf_refcnt_update(pkt, 1);
+		nb_segs = rte_gso_segment(pkt, &ctx, segs, MAX_SEGS);
+		if (nb_segs <= 1)
+			break;
+		for (i = 0; i < nb_segs; i++)
+			rte_pktmbuf_free(segs[i]);
+		nb_total += nb_segs;
+	}
+	cycles = rte_rdtsc_precise() - start;
+	if (iter != ITERATIONS) {
+		printf("%s: segmentation failed (%d)\n", type->name, nb_segs);
+		goto error;
+	}
+
+	printf("%-22s %8d %12"PRIu64" %14.2f\n", type->name, nb_segs,
+			cycles / nb_total,
+			(double)nb_total * rte_get_tsc_hz() / cycles / 1e6);
+	rte_pktmbuf_free(pkt);
+	return 0;
+
+error:
+	rte_pktmbuf_free(pkt);
+	return -1;
+}
+
+static int
+test_gso_perf(void)
+{
+	unsigned int i;
+	int ret = -1;
+
+	pkt_pool = rte_pktmbuf_pool_create("GSO_PKT_POOL", 32, 0, 0,
+			BIG_MBUF_SIZE, rte_socket_id());
+	hdr_pool = rte_pktmbuf_pool_create("GSO_HDR_POOL", NB_MBUFS, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	indirect_pool = rte_pktmbuf_pool_create("GSO_INDIRECT_POOL", NB_MBUFS,
+			0, 0, 0, rte_socket_id());
+	if (pkt_pool == NULL || hdr_pool == NULL || indirect_pool == NULL) {
+		printf("Cannot create mbuf pools\n");
+		goto exit;
+	}
+
+	printf("%u bytes of payload, segment size %u\n", PAYLOAD_LEN,
+			GSO_SIZE);
+	printf("%-22s %8s %12s %14s\n", "type", "segments", "cycles/seg",
+			"Msegs/s");
+	for (i = 0; i < RTE_DIM(gso_perf_types); i++) {
+		if (test_gso_perf_type(&gso_perf_types[i]) < 0)
+			goto exit;
+	}
+	ret = 0;
+
+exit:
+	rte_mempool_free(pkt_pool);
+	rte_mempool_free(hdr_pool);
+	rte_mempool_free(indirect_pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(gso_perf_autotest, test_gso_perf);
@@ -0,0 +1,226 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_pcapng.h>
+
+#include "test.h"
+
+#define NUM_PACKETS 128
+#define NUM_MBUFS (4 * NUM_PACKETS)
+#define PKT_LEN 61	/* not a multiple of 4, exercises padding */
+#define SEG_LEN 40
+
+#define BLOCK_SECTION 0x0A0D0D0A
+#define BLOCK_INTERFACE 1
+#define BLOCK_ENHANCED_PACKET 6
+
+struct block_header {
+	uint32_t type;
+	uint32_t length;
+};
+
+static struct rte_mempool *mp;
+
+static int
+test_setup(void)
+{
+	mp = rte_pktmbuf_pool_create("pcapng_test_pool", NUM_MBUFS, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL) {
+		printf("%s: mempool creation failed\n", __func__);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+test_teardown(void)
+{
+	rte_mempool_free(mp);
+	mp = NULL;
+}
+
+/* Build a two segment packet with a recognizable payload */
+static struct rte_mbuf *
+make_packet(unsigned int n)
+{
+	struct rte_mbuf *m, *seg;
+	uint8_t *data;
+	unsigned int i;
+
+	m = rte_pktmbuf_alloc(mp);
+	seg = rte_pktmbuf_alloc(mp);
+	if (m == NULL || seg == NULL) {
+		rte_pktmbuf_free(m);
+		rte_pktmbuf_free(seg);
+		return NULL;
+	}
+
+	data = (uint8_t *)rte_pktmbuf_append(m, SEG_LEN);
+	for (i = 0; i < SEG_LEN; i++)
+		data[i] = n + i;
+	data = (uint8_t *)rte_pktmbuf_append(seg, PKT_LEN - SEG_LEN);
+	for (i = SEG_LEN; i < PKT_LEN; i++)
+		data[i - SEG_LEN] = n + i;
+	rte_pktmbuf_chain(m, seg);
+
+	return m;
+}
+
+/* Walk the blocks of the file and check the packet payloads */
+static int
+check_file(const char *name, unsigned int nb_pkts)
+{
+	unsigned int nb_section = 0, nb_interface = 0, nb_epb = 0;
+	struct block_header hdr;
+	uint8_t buf[RTE_MBUF_DEFAULT_DATAROOM];
+	uint32_t trailer, cap_len;
+	unsigned int i;
+	FILE *f;
+
+	f = fopen(name, "r");
+	TEST_ASSERT_NOT_NULL(f, "cannot open %s", name);
+
+	while (fread(&hdr, sizeof(hdr), 1, f) == 1) {
+		TEST_ASSERT(hdr.length % 4 == 0 &&
+			    hdr.length >= sizeof(hdr) + sizeof(trailer) &&
+			    hdr.length - sizeof(hdr) <= sizeof(buf),
+			    "bad block length %u", hdr.length);
+		TEST_ASSERT(fread(buf, hdr.length - sizeof(hdr), 1, f) == 1,
+			    "truncated block");
+		memcpy(&trailer, buf + hdr.length - sizeof(hdr) -
+		       sizeof(trailer), sizeof(trailer));
+		TEST_ASSERT_EQUAL(hdr.length, trailer,
+				  "block length mismatch");
+
+		switch (hdr.type) {
+		case BLOCK_SECTION:
+			nb_section++;
+			break;
+		case BLOCK_INTERFACE:
+			nb_interface++;
+			break;
+		case BLOCK_ENHANCED_PACKET:
+			/* interface id, timestamp (2), captured length */
+			memcpy(&cap_len, buf + 3 * sizeof(uint32_t),
+			       sizeof(cap_len));
+			TEST_ASSERT_EQUAL(cap_len, PKT_LEN,
+					  "bad captured length %u", cap_len);
+			for (i = 0; i < PKT_LEN; i++)
+				TEST_ASSERT_EQUAL(buf[5 * sizeof(uint32_t) + i],
+						  (uint8_t)(nb_epb + i),
+						  "packet %u data mismatch",
+						  nb_epb);
+			nb_epb++;
+			break;
+		default:
+			TEST_ASSERT(0, "unexpected block type %#x", hdr.type);
+		}
+	}
+	fclose(f);
+
+	TEST_ASSERT_EQUAL(nb_section, 1, "expected one section header");
+	TEST_ASSERT_EQUAL(nb_interface, 1, "expected one interface block");
+	TEST_ASSERT_EQUAL(nb_epb, nb_pkts, "expected %u packets, found %u",
+			  nb_pkts, nb_epb);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_pcapng_write(void)
+{
+	struct rte_mbuf *orig[NUM_PACKETS], *copy[NUM_PACKETS];
+	char file_name[] = "/tmp/test_pcapng_XXXXXX";
+	/* enhanced packet block header of the first copy */
+	uint32_t epb[7];
+	struct rte_pcapng *pcapng;
+	unsigned int i;
+	ssize_t len;
+	int fd, ret;
+
+	fd = mkstemp(file_name);
+	TEST_ASSERT(fd >= 0, "cannot create temporary file");
+
+	pcapng = rte_pcapng_fdopen(fd, "os", "hw", "pcapng_autotest",
+				   "test");
+	TEST_ASSERT_NOT_NULL(pcapng, "rte_pcapng_fdopen failed");
+
+	ret = rte_pcapng_add_interface(pcapng, 0, "test0", NULL);
+	TEST_ASSERT_EQUAL(ret, 0, "rte_pcapng_add_interface failed");
+	ret = rte_pcapng_add_interface(pcapng, 0, "test0", NULL);
+	TEST_ASSERT(ret < 0 && rte_errno == EEXIST,
+		    "port added twice");
+
+	for (i = 0; i < NUM_PACKETS; i++) {
+		orig[i] = make_packet(i);
+		TEST_ASSERT_NOT_NULL(orig[i], "packet allocation failed");
+		copy[i] = rte_pcapng_copy(0, i % 4, orig[i], mp, UINT32_MAX,
+				rte_rdtsc(), (i & 1) ?
+				RTE_PCAPNG_DIRECTION_OUT :
+				RTE_PCAPNG_DIRECTION_IN);
+		TEST_ASSERT_NOT_NULL(copy[i], "rte_pcapng_copy failed");
+		TEST_ASSERT_EQUAL(rte_pktmbuf_pkt_len(copy[i]),
+				  rte_pcapng_mbuf_size(PKT_LEN),
+				  "unexpected copy length");
+		rte_pktmbuf_free(orig[i]);
+	}
+
+	memcpy(epb, rte_pktmbuf_mtod(copy[0], void *), sizeof(epb));
+	len = rte_pcapng_write_packets(pcapng, copy, NUM_PACKETS);
+	TEST_ASSERT_EQUAL(len, NUM_PACKETS * rte_pcapng_mbuf_size(PKT_LEN),
+			  "rte_pcapng_write_packets failed");
+	TEST_ASSERT(memcmp(epb, rte_pktmbuf_mtod(copy[0], void *),
+			   sizeof(epb)) == 0,
+		    "packet modified by rte_pcapng_write_packets");
+	for (i = 0; i < NUM_PACKETS; i++)
+		rte_pktmbuf_free(copy[i]);
+
+	/* packets of a port without interface block are rejected */
+	orig[0] = make_packet(0);
+	TEST_ASSERT_NOT_NULL(orig[0], "packet allocation failed");
+	copy[0] = rte_pcapng_copy(1, 0, orig[0], mp, UINT32_MAX,
+			rte_rdtsc(), RTE_PCAPNG_DIRECTION_IN);
+	TEST_ASSERT_NOT_NULL(copy[0], "rte_pcapng_copy failed");
+	len = rte_pcapng_write_packets(pcapng, copy, 1);
+	TEST_ASSERT(len < 0 && rte_errno == EINVAL,
+		    "packet of unknown port written");
+	rte_pktmbuf_free(orig[0]);
+	rte_pktmbuf_free(copy[0]);
+
+	rte_pcapng_close(pcapng);
+
+	ret = check_file(file_name, NUM_PACKETS);
+	unlink(file_name);
+
+	return ret;
+}
+
+static struct unit_test_suite pcapng_test_suite  = {
+	.setup = test_setup,
+	.teardown = test_teardown,
+	.suite_name = "pcapng Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_pcapng_write),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_pcapng(void)
+{
+	return unit_test_suite_runner(&pcapng_test_suite);
+}
+
+REGISTER_TEST_COMMAND(pcapng_autotest, test_pcapng);
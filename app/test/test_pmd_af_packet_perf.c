@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Measure the AF_PACKET PMD on a veth pair: a port attached to each end,
+ * the packets sent by the first port are received by the second one.
+ * TPACKET_V2 frame rings, TPACKET_V3 block rings and the io_uring mode are
+ * measured. The Rx bursts are polled after each Tx burst without waiting,
+ * as the TPACKET_V3 blocks are only visible once full or retired by the
+ * kernel.
+ */
+
+#define AFP_PERF_IFACE0 "dpdk_afp0"
+#define AFP_PERF_IFACE1 "dpdk_afp1"
+#define IP_LINK "ip link "
+#define AFP_PERF_ARGS "blocksz=65536,framesz=2048,framecnt=1024"
+#define RING_SIZE 1024
+#define BURST_SIZE PMD_PERF_BURST_SIZE
+#define NB_MBUFS (4 * RING_SIZE + 8 * BURST_SIZE)
+#define PKT_LEN PMD_PERF_PKT_LEN
+#define ITERATIONS 4096
+
+static const char * const afp_perf_ifaces[] = {
+	AFP_PERF_IFACE0,
+	AFP_PERF_IFACE1,
+};
+
+/* The io_uring mode is skipped on kernels without io_uring sendmsg() */
+static const struct afp_perf_mode {
+	const char *name;
+	const char *args;
+	bool optional;
+} afp_perf_modes[] = {
+	{ "TPACKET_V2", "tpacket_v3=0", false },
+	{ "TPACKET_V3", "tpacket_v3=1", false },
+	{ "io_uring", "io_uring=1", true },
+};
+
+static struct rte_mempool *pkt_pool;
+static uint16_t ports[RTE_DIM(afp_perf_ifaces)];
+
+static int
+port_create(unsigned int i, const struct afp_perf_mode *mode)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	char args[128];
+
+	snprintf(name, sizeof(name), "net_af_packet_perf%u", i);
+	snprintf(args, sizeof(args), "iface=%s,%s,%s",
+			afp_perf_ifaces[i], AFP_PERF_ARGS, mode->args);
+
+	return pmd_perf_port_create(name, args, NULL, RING_SIZE, pkt_pool,
+			&ports[i]);
+}
+
+static int
+veth_loop(const struct afp_perf_mode *mode)
+{
+	struct pmd_perf_rx_stats drained = { 0 }, rx = { 0 };
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t tx_cycles = 0, start, total;
+	uint64_t nb_tx = 0;
+	unsigned int i;
+	uint16_t nb;
+
+	/* drain the packets sent by the kernel on link up */
+	pmd_perf_port_receive(ports[1], PMD_PERF_ETHER_TYPE, UINT64_MAX,
+			UINT64_MAX, false, &drained);
+
+	total = rte_rdtsc();
+	for (i = 0; i < ITERATIONS; i++) {
+		if (pmd_perf_fill_burst(pkt_pool, pkts, BURST_SIZE, PKT_LEN,
+				PMD_PERF_ETHER_TYPE) != 0) {
+			printf("Cannot allocate packets\n");
+			return -1;
+		}
+
+		start = rte_rdtsc_precise();
+		nb = rte_eth_tx_burst(ports[0], 0, pkts, BURST_SIZE);
+		tx_cycles += rte_rdtsc_precise() - start;
+		nb_tx += nb;
+		pmd_perf_free_burst(&pkts[nb], BURST_SIZE - nb);
+
+		pmd_perf_port_receive(ports[1], PMD_PERF_ETHER_TYPE,
+				nb_tx - rx.pkts, UINT64_MAX, false, &rx);
+	}
+	pmd_perf_port_receive(ports[1], PMD_PERF_ETHER_TYPE, nb_tx - rx.pkts,
+			UINT64_MAX, true, &rx);
+	total = rte_rdtsc() - total;
+
+	if (nb_tx == 0 || rx.pkts == 0) {
+		printf("No packet through the veth pair\n");
+		return -1;
+	}
+
+	printf("%10s %10"PRIu64" %12"PRIu64" %10"PRIu64" %12"PRIu64
+			" %12"PRIu64"\n",
+			mode->name,
+			nb_tx, tx_cycles / nb_tx, rx.pkts, rx.cycles / rx.pkts,
+			total / rx.pkts);
+
+	return 0;
+}
+
+static int
+test_pmd_af_packet_perf(void)
+{
+	unsigned int i, m, nb_ports = 0;
+	int ret = 0;
+
+	if (system(IP_LINK "add " AFP_PERF_IFACE0 " type veth peer name "
+			AFP_PERF_IFACE1 " > /dev/null 2>&1") != 0) {
+		printf("Cannot create a veth pair, skipping\n");
+		return TEST_SKIPPED;
+	}
+	if (system(IP_LINK "set " AFP_PERF_IFACE0 " up") != 0 ||
+			system(IP_LINK "set " AFP_PERF_IFACE1 " up") != 0) {
+		printf("Cannot set the veth pair up\n");
+		ret = -1;
+		goto delete_veth;
+	}
+
+	pkt_pool = pmd_perf_pool_create("AFP_PERF_POOL", NB_MBUFS,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	if (pkt_pool == NULL) {
+		ret = -1;
+		goto delete_veth;
+	}
+
+	printf("Veth pair %s -> %s, %u bytes packets, bursts of %u\n",
+			AFP_PERF_IFACE0, AFP_PERF_IFACE1, PKT_LEN, BURST_SIZE);
+	printf("%10s %10s %12s %10s %12s %12s\n", "mode", "sent",
+			"tx cyc/pkt", "received", "rx cyc/pkt", "cyc/pkt");
+	for (m = 0; m < RTE_DIM(afp_perf_modes) && ret == 0; m++) {
+		for (nb_ports = 0; nb_ports < RTE_DIM(afp_perf_ifaces);
+				nb_ports++)
+			if (port_create(nb_ports, &afp_perf_modes[m]) != 0)
+				break;
+		if (nb_ports < RTE_DIM(afp_perf_ifaces)) {
+			printf("Cannot create the af_packet ports in %s mode\n",
+					afp_perf_modes[m].name);
+			if (!afp_perf_modes[m].optional)
+				ret = -1;
+		} else {
+			ret = veth_loop(&afp_perf_modes[m]);
+		}
+		for (i = 0; i < nb_ports; i++)
+			pmd_perf_port_destroy(ports[i]);
+	}
+
+	rte_mempool_free(pkt_pool);
+delete_veth:
+	if (system(IP_LINK "del " AFP_PERF_IFACE0) != 0)
+		printf("Cannot delete %s\n", AFP_PERF_IFACE0);
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(af_packet_pmd_perf_autotest, test_pmd_af_packet_perf);
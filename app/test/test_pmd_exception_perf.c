@@ -0,0 +1,229 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netpacket/packet.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_string_fns.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Compare the exception paths to the kernel networking stack: virtio-user
+ * with the vhost-net backend, the tap PMD and the KNI PMD. Bursts of
+ * packets sent on the port are received by a packet socket bound to the
+ * kernel interface of the port, sent back by the socket on the interface,
+ * and received again on the port. The round trip, including the socket
+ * calls which are the same for all the ports, and the port Tx are timed.
+ * The ports which cannot be created on the system are skipped.
+ */
+
+#define RING_SIZE 1024
+#define BURST_SIZE PMD_PERF_BURST_SIZE
+#define NB_MBUFS (2 * RING_SIZE + 4 * BURST_SIZE)
+#define PKT_LEN PMD_PERF_PKT_LEN
+#define ITERATIONS 4096
+
+struct exception_port {
+	const char *name;
+	const char *args;
+	const char *ifname;
+	const char *kernel_dev;
+};
+
+static const struct exception_port exception_ports[] = {
+	{ "net_virtio_user_exc", "path=/dev/vhost-net,iface=dpdk_vu_exc,"
+		"queue_size=1024", "dpdk_vu_exc", "/dev/vhost-net" },
+	{ "net_tap_exc", "iface=dpdk_tap_exc", "dpdk_tap_exc",
+		"/dev/net/tun" },
+	/* the KNI interface is named after the port, without "net_" */
+	{ "net_kni_exc", "", "kni_exc", "/dev/kni" },
+};
+
+static struct rte_mempool *pkt_pool;
+
+/* Bring the kernel interface up and bind a packet socket to it */
+static int
+kernel_socket_open(const char *ifname)
+{
+	struct sockaddr_ll sll;
+	struct ifreq ifr;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0)
+		return -1;
+	memset(&ifr, 0, sizeof(ifr));
+	strlcpy(ifr.ifr_name, ifname, IFNAMSIZ);
+	if (ioctl(fd, SIOCGIFFLAGS, &ifr) < 0) {
+		close(fd);
+		return -1;
+	}
+	ifr.ifr_flags |= IFF_UP;
+	if (ioctl(fd, SIOCSIFFLAGS, &ifr) < 0) {
+		printf("Cannot set %s up: %s\n", ifname, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	close(fd);
+
+	fd = socket(AF_PACKET, SOCK_RAW | SOCK_NONBLOCK,
+			htons(PMD_PERF_ETHER_TYPE));
+	if (fd < 0) {
+		printf("Cannot open packet socket: %s\n", strerror(errno));
+		return -1;
+	}
+	memset(&sll, 0, sizeof(sll));
+	sll.sll_family = AF_PACKET;
+	sll.sll_protocol = htons(PMD_PERF_ETHER_TYPE);
+	sll.sll_ifindex = if_nametoindex(ifname);
+	if (sll.sll_ifindex == 0 ||
+			bind(fd, (struct sockaddr *)&sll, sizeof(sll)) < 0) {
+		printf("Cannot bind packet socket to %s\n", ifname);
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/* Receive the packets of the port on the kernel side and send them back */
+static unsigned int
+kernel_reflect(int fd, unsigned int nb)
+{
+	uint8_t buf[RTE_ETHER_MAX_LEN];
+	struct sockaddr_ll from;
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	socklen_t len;
+	unsigned int n = 0;
+	ssize_t size;
+
+	while (n < nb) {
+		len = sizeof(from);
+		size = recvfrom(fd, buf, sizeof(buf), 0,
+				(struct sockaddr *)&from, &len);
+		if (size < 0) {
+			if (errno != EAGAIN ||
+					poll(&pfd, 1, PMD_PERF_WAIT_MS) <= 0)
+				break;
+			continue;
+		}
+		/* the packets sent back are also seen by the socket */
+		if (from.sll_pkttype == PACKET_OUTGOING)
+			continue;
+		if (send(fd, buf, size, 0) == size)
+			n++;
+	}
+
+	return n;
+}
+
+static int
+exception_loop(const struct exception_port *p, uint16_t port, int fd)
+{
+	struct pmd_perf_rx_stats drained = { 0 }, back = { 0 };
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t tx_cycles = 0, start, total;
+	uint64_t nb_tx = 0;
+	unsigned int i, n;
+	uint16_t nb;
+
+	/* drain the packets sent by the kernel on link up */
+	pmd_perf_port_receive(port, PMD_PERF_ETHER_TYPE, UINT64_MAX,
+			UINT64_MAX, true, &drained);
+
+	total = rte_rdtsc();
+	for (i = 0; i < ITERATIONS; i++) {
+		if (pmd_perf_fill_burst(pkt_pool, pkts, BURST_SIZE, PKT_LEN,
+				PMD_PERF_ETHER_TYPE) != 0) {
+			printf("Cannot allocate packets\n");
+			return -1;
+		}
+
+		start = rte_rdtsc_precise();
+		nb = rte_eth_tx_burst(port, 0, pkts, BURST_SIZE);
+		tx_cycles += rte_rdtsc_precise() - start;
+		nb_tx += nb;
+		pmd_perf_free_burst(&pkts[nb], BURST_SIZE - nb);
+
+		n = kernel_reflect(fd, nb);
+		pmd_perf_port_receive(port, PMD_PERF_ETHER_TYPE, n, UINT64_MAX,
+				true, &back);
+	}
+	total = rte_rdtsc() - total;
+
+	if (nb_tx == 0 || back.pkts == 0) {
+		printf("No packet through %s\n", p->name);
+		return -1;
+	}
+
+	printf("%20s %12"PRIu64" %12"PRIu64" %12"PRIu64" %12"PRIu64"\n",
+			p->name, nb_tx, tx_cycles / nb_tx,
+			back.pkts, total / back.pkts);
+
+	return 0;
+}
+
+static int
+test_pmd_exception_perf(void)
+{
+	const struct exception_port *p;
+	unsigned int i, nb_run = 0;
+	uint16_t port;
+	int fd, ret = 0;
+
+	pkt_pool = pmd_perf_pool_create("EXC_PERF_POOL", NB_MBUFS,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	if (pkt_pool == NULL)
+		return -1;
+
+	printf("Kernel exception path, %u bytes packets, bursts of %u\n",
+			PKT_LEN, BURST_SIZE);
+	printf("%20s %12s %12s %12s %12s\n", "port", "sent",
+			"tx cyc/pkt", "returned", "cyc/pkt");
+	for (i = 0; i < RTE_DIM(exception_ports) && ret == 0; i++) {
+		p = &exception_ports[i];
+		if (access(p->kernel_dev, R_OK | W_OK) != 0 ||
+				pmd_perf_port_create(p->name, p->args, NULL,
+					RING_SIZE, pkt_pool, &port) != 0) {
+			printf("%20s not available\n", p->name);
+			continue;
+		}
+
+		fd = kernel_socket_open(p->ifname);
+		if (fd < 0) {
+			ret = -1;
+		} else {
+			ret = exception_loop(p, port, fd);
+			close(fd);
+			nb_run++;
+		}
+
+		pmd_perf_port_destroy(port);
+	}
+
+	rte_mempool_free(pkt_pool);
+
+	if (ret == 0 && nb_run == 0)
+		return TEST_SKIPPED;
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(exception_path_perf_autotest, test_pmd_exception_perf);
@@ -0,0 +1,514 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_pool_ops.h>
+#include <rte_memory.h>
+#include <rte_mempool.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Functional tests of the zero-copy slave mode of the memif PMD, with a
+ * zero-copy slave connected to a master in the same process. The packets
+ * sent in each direction, including multi-segment ones, packets larger
+ * than the mbufs of the slave and mbufs spanning two memory segments,
+ * must be received complete and in order.
+ */
+
+#define MASTER_NAME "net_memif_master"
+#define SLAVE_NAME "net_memif_slave_zc"
+#define LOG2_RING_SIZE 8
+#define RING_SIZE (1 << LOG2_RING_SIZE)
+#define NB_MBUFS (32 * RING_SIZE)
+#define NB_PKTS 32
+#define PKT_LEN 256
+/* larger than the data room of an mbuf, the slave receives a chain */
+#define BIG_PKT_LEN 5000
+#define SEG_LEN 100
+#define LINK_WAIT_MS 5000
+#define RX_WAIT_MS 1000
+
+static struct rte_mempool *pkt_pool;
+static char socket_path[PATH_MAX];
+static uint16_t master_port;
+static uint16_t slave_port;
+
+/*
+ * The memory of the slave mbufs is shared, not DMAed: the pool is not
+ * IOVA contiguous, so that some mbufs span two memory segments.
+ */
+static struct rte_mempool *
+pool_create(void)
+{
+	struct rte_pktmbuf_pool_private priv = {
+		.mbuf_data_room_size = RTE_MBUF_DEFAULT_BUF_SIZE,
+	};
+	struct rte_mempool *mp;
+
+	mp = rte_mempool_create_empty("MEMIF_TEST_POOL", NB_MBUFS,
+			sizeof(struct rte_mbuf) + RTE_MBUF_DEFAULT_BUF_SIZE, 0,
+			sizeof(priv), rte_socket_id(), MEMPOOL_F_NO_IOVA_CONTIG);
+	if (mp == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return NULL;
+	}
+	if (rte_mempool_set_ops_byname(mp, rte_mbuf_best_mempool_ops(),
+			NULL) != 0 || rte_mempool_populate_default(mp) < 0) {
+		printf("Cannot populate mbuf pool\n");
+		rte_mempool_free(mp);
+		return NULL;
+	}
+	rte_pktmbuf_pool_init(mp, &priv);
+	rte_mempool_obj_iter(mp, rte_pktmbuf_init, NULL);
+
+	return mp;
+}
+
+/* Byte at offset off of packet seq, the Ethernet header is overwritten */
+static inline uint8_t
+pkt_byte(uint16_t seq, uint32_t off)
+{
+	return (uint8_t)(seq * 7 + off);
+}
+
+static void
+fill_data(uint8_t *data, uint16_t seq, uint32_t off, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		data[i] = pkt_byte(seq, off + i);
+}
+
+static void
+fill_ether_hdr(struct rte_mbuf *m)
+{
+	struct rte_ether_hdr *eth = rte_pktmbuf_mtod(m, struct rte_ether_hdr *);
+
+	memset(&eth->d_addr, 0xff, RTE_ETHER_ADDR_LEN);
+	memset(&eth->s_addr, 0, RTE_ETHER_ADDR_LEN);
+	eth->ether_type = rte_cpu_to_be_16(PMD_PERF_ETHER_TYPE);
+}
+
+/* Allocate a packet of len bytes in segments of at most seg_len bytes */
+static struct rte_mbuf *
+make_pkt(uint16_t seq, uint32_t len, uint16_t seg_len)
+{
+	struct rte_mbuf *head = NULL, *m;
+	uint32_t off = 0;
+	uint16_t n;
+	uint8_t *data;
+
+	while (off < len) {
+		m = rte_pktmbuf_alloc(pkt_pool);
+		if (m == NULL) {
+			rte_pktmbuf_free(head);
+			return NULL;
+		}
+		n = RTE_MIN(len - off, (uint32_t)seg_len);
+		n = RTE_MIN(n, rte_pktmbuf_tailroom(m));
+		data = (uint8_t *)rte_pktmbuf_append(m, n);
+		if (head != NULL && rte_pktmbuf_chain(head, m) != 0) {
+			rte_pktmbuf_free(m);
+			rte_pktmbuf_free(head);
+			return NULL;
+		}
+		if (head == NULL)
+			head = m;
+		fill_data(data, seq, off, n);
+		off += n;
+	}
+	fill_ether_hdr(head);
+
+	return head;
+}
+
+static int
+check_pkt(struct rte_mbuf *m, uint16_t seq, uint32_t len)
+{
+	const uint8_t *b;
+	uint8_t copy;
+	uint32_t i;
+
+	if (m->pkt_len != len) {
+		printf("Packet %u: length %u instead of %u\n", seq,
+			m->pkt_len, len);
+		return -1;
+	}
+	for (i = sizeof(struct rte_ether_hdr); i < len; i++) {
+		b = rte_pktmbuf_read(m, i, 1, &copy);
+		if (b == NULL || *b != pkt_byte(seq, i)) {
+			printf("Packet %u: bad byte %u\n", seq, i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Send the packets, the ones not sent are freed */
+static uint16_t
+send_pkts(uint16_t port, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t nb_tx;
+
+	nb_tx = rte_eth_tx_burst(port, 0, pkts, nb_pkts);
+	pmd_perf_free_burst(&pkts[nb_tx], nb_pkts - nb_tx);
+
+	return nb_tx;
+}
+
+/*
+ * Receive nb_pkts packets of len bytes numbered from first, in bursts of
+ * at most burst_size packets.
+ */
+static int
+receive_pkts(uint16_t port, uint16_t first, uint16_t nb_pkts, uint32_t len,
+		uint16_t burst_size)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	uint16_t nb_rx = 0, n, i;
+	uint64_t end;
+	int ret = 0;
+
+	end = rte_get_timer_cycles() + rte_get_timer_hz() * RX_WAIT_MS / 1000;
+	while (nb_rx < nb_pkts && rte_get_timer_cycles() < end) {
+		n = rte_eth_rx_burst(port, 0, pkts,
+				RTE_MIN(burst_size, nb_pkts - nb_rx));
+		for (i = 0; i < n; i++)
+			if (ret == 0)
+				ret = check_pkt(pkts[i], first + nb_rx + i,
+						len);
+		pmd_perf_free_burst(pkts, n);
+		nb_rx += n;
+	}
+	if (nb_rx != nb_pkts) {
+		printf("Received %u packets instead of %u\n", nb_rx, nb_pkts);
+		return -1;
+	}
+
+	return ret;
+}
+
+/* Send packets of len bytes in segments of seg_len bytes, from port */
+static int
+send_receive(uint16_t tx_port, uint16_t rx_port, uint32_t len,
+		uint16_t seg_len, uint16_t rx_burst_size)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	uint16_t i;
+
+	for (i = 0; i < NB_PKTS; i++) {
+		pkts[i] = make_pkt(i, len, seg_len);
+		if (pkts[i] == NULL) {
+			pmd_perf_free_burst(pkts, i);
+			printf("Cannot allocate packets\n");
+			return -1;
+		}
+	}
+	if (send_pkts(tx_port, pkts, NB_PKTS) != NB_PKTS) {
+		printf("Cannot send packets\n");
+		return -1;
+	}
+
+	return receive_pkts(rx_port, 0, NB_PKTS, len, rx_burst_size);
+}
+
+static int
+test_memif_zc_slave_tx(void)
+{
+	TEST_ASSERT_SUCCESS(send_receive(slave_port, master_port, PKT_LEN,
+			PKT_LEN, NB_PKTS), "Single segment packets");
+	TEST_ASSERT_SUCCESS(send_receive(slave_port, master_port, PKT_LEN,
+			SEG_LEN, NB_PKTS), "Multi-segment packets");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_memif_zc_slave_rx(void)
+{
+	TEST_ASSERT_SUCCESS(send_receive(master_port, slave_port, PKT_LEN,
+			PKT_LEN, NB_PKTS), "Single segment packets");
+	TEST_ASSERT_SUCCESS(send_receive(master_port, slave_port, BIG_PKT_LEN,
+			SEG_LEN, NB_PKTS), "Packets larger than an mbuf");
+	/* the packets left on the ring are received by the next bursts */
+	TEST_ASSERT_SUCCESS(send_receive(master_port, slave_port, BIG_PKT_LEN,
+			BIG_PKT_LEN, 3), "Packets received in small bursts");
+
+	return TEST_SUCCESS;
+}
+
+/* Ring full of packets taking several descriptors */
+static int
+test_memif_zc_slave_rx_ring_full(void)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	uint16_t nb_sent = 0, nb_tx, i;
+
+	/* send until the master has no slot left for a whole packet */
+	do {
+		for (i = 0; i < NB_PKTS; i++) {
+			pkts[i] = make_pkt(nb_sent + i, BIG_PKT_LEN,
+					   BIG_PKT_LEN);
+			TEST_ASSERT_NOT_NULL(pkts[i],
+					"Cannot allocate packets");
+		}
+		nb_tx = send_pkts(master_port, pkts, NB_PKTS);
+		nb_sent += nb_tx;
+	} while (nb_tx == NB_PKTS);
+	TEST_ASSERT(nb_sent > 0, "No slot posted by the slave");
+	TEST_ASSERT(nb_sent < RING_SIZE, "%u packets sent on the ring",
+			nb_sent);
+
+	TEST_ASSERT_SUCCESS(receive_pkts(slave_port, 0, nb_sent, BIG_PKT_LEN,
+			NB_PKTS), "Packets of a full ring");
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Get the offset of the end of the memory segment in the data room of an
+ * mbuf, or 0 if the data room is in a single memory segment.
+ */
+static uint32_t
+page_cross_offset(struct rte_mbuf *m)
+{
+	const struct rte_memseg *ms;
+	uintptr_t start, end;
+
+	start = rte_pktmbuf_mtod(m, uintptr_t);
+	end = start + rte_pktmbuf_tailroom(m);
+	ms = rte_mem_virt2memseg((void *)start, NULL);
+	if (ms == NULL || (uintptr_t)ms->addr + ms->len >= end)
+		return 0;
+
+	return (uintptr_t)ms->addr + ms->len - start;
+}
+
+/* Send an mbuf whose data spans two memory segments from the slave */
+static int
+test_memif_zc_slave_tx_page_cross(void)
+{
+	struct rte_mbuf *pkts[NB_MBUFS];
+	struct rte_mbuf *m = NULL;
+	uint32_t offset = 0, len;
+	uint16_t nb = 0, i;
+
+	/* look for such an mbuf among the free ones */
+	while (nb < NB_MBUFS && (pkts[nb] = rte_pktmbuf_alloc(pkt_pool)) !=
+			NULL)
+		nb++;
+	for (i = 0; i < nb && m == NULL; i++) {
+		offset = page_cross_offset(pkts[i]);
+		if (offset > sizeof(struct rte_ether_hdr)) {
+			m = pkts[i];
+			pkts[i] = NULL;
+		}
+	}
+	pmd_perf_free_burst(pkts, nb);
+	if (m == NULL) {
+		printf("No mbuf spanning two memory segments\n");
+		return TEST_SKIPPED;
+	}
+
+	len = RTE_MIN(offset + PKT_LEN, (uint32_t)rte_pktmbuf_tailroom(m));
+	fill_data((uint8_t *)rte_pktmbuf_append(m, len), 0, 0, len);
+	fill_ether_hdr(m);
+
+	TEST_ASSERT_EQUAL(send_pkts(slave_port, &m, 1), 1,
+			"Cannot send the packet");
+	TEST_ASSERT_SUCCESS(receive_pkts(master_port, 0, 1, len, 1),
+			"Packet spanning two memory segments");
+
+	return TEST_SUCCESS;
+}
+
+/* The mbufs sent by the slave are freed once consumed by the master */
+static int
+test_memif_zc_slave_tx_free(void)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	uint16_t i;
+	int ret = TEST_SUCCESS;
+
+	for (i = 0; i < NB_PKTS; i++) {
+		pkts[i] = make_pkt(i, PKT_LEN, PKT_LEN);
+		TEST_ASSERT_NOT_NULL(pkts[i], "Cannot allocate packets");
+		/* keep the packet to check that the PMD frees it */
+		rte_mbuf_refcnt_update(pkts[i], 1);
+	}
+	TEST_ASSERT_EQUAL(rte_eth_tx_burst(slave_port, 0, pkts, NB_PKTS),
+			NB_PKTS, "Cannot send packets");
+	for (i = 0; i < NB_PKTS; i++)
+		if (rte_mbuf_refcnt_read(pkts[i]) != 2)
+			ret = TEST_FAILED;
+	if (ret != TEST_SUCCESS)
+		printf("Packets freed before the master consumed them\n");
+
+	if (receive_pkts(master_port, 0, NB_PKTS, PKT_LEN, NB_PKTS) != 0)
+		ret = TEST_FAILED;
+	/* the consumed mbufs are freed at the next burst */
+	rte_eth_tx_burst(slave_port, 0, NULL, 0);
+	for (i = 0; i < NB_PKTS; i++) {
+		if (rte_mbuf_refcnt_read(pkts[i]) != 1) {
+			printf("Packet %u not freed\n", i);
+			ret = TEST_FAILED;
+			continue;
+		}
+		rte_pktmbuf_free(pkts[i]);
+	}
+
+	return ret;
+}
+
+/*
+ * The zero-copy slave exports the memsegs of its mempool as memif regions,
+ * which needs each of them at the start of its own file: not the case
+ * with --no-huge or --single-file-segments.
+ */
+static void
+check_memseg_export(struct rte_mempool *mp __rte_unused, void *opaque,
+		struct rte_mempool_memhdr *memhdr,
+		unsigned int mem_idx __rte_unused)
+{
+	int *exportable = opaque;
+	const struct rte_memseg *ms;
+	void *addr = memhdr->addr;
+	void *end = RTE_PTR_ADD(memhdr->addr, memhdr->len);
+	size_t offset;
+
+	while (*exportable && addr < end) {
+		ms = rte_mem_virt2memseg(addr, NULL);
+		if (ms == NULL || rte_memseg_get_fd_offset(ms, &offset) < 0 ||
+				offset != 0)
+			*exportable = 0;
+		else
+			addr = RTE_PTR_ADD(ms->addr, ms->len);
+	}
+}
+
+static int
+wait_link_up(uint16_t port)
+{
+	struct rte_eth_link link;
+	int ms;
+
+	for (ms = 0; ms < LINK_WAIT_MS; ms += 10) {
+		memset(&link, 0, sizeof(link));
+		rte_eth_link_get_nowait(port, &link);
+		if (link.link_status == ETH_LINK_UP)
+			return 0;
+		rte_delay_ms(10);
+	}
+
+	return -1;
+}
+
+static int
+test_memif_setup(void)
+{
+	char args[PATH_MAX + 128];
+	int exportable = 1;
+
+	pkt_pool = pool_create();
+	if (pkt_pool == NULL)
+		return -1;
+	rte_mempool_mem_iter(pkt_pool, check_memseg_export, &exportable);
+	if (!exportable) {
+		printf("Zero-copy needs a hugepage file per memory segment\n");
+		rte_mempool_free(pkt_pool);
+		pkt_pool = NULL;
+		return TEST_SKIPPED;
+	}
+	snprintf(socket_path, sizeof(socket_path), "/tmp/memif_test_%d.sock",
+			getpid());
+	unlink(socket_path);
+
+	snprintf(args, sizeof(args), "role=master,id=0,socket=%s,rsize=%d",
+			socket_path, LOG2_RING_SIZE);
+	if (pmd_perf_port_create(MASTER_NAME, args, NULL, RING_SIZE,
+			pkt_pool, &master_port) != 0) {
+		printf("Cannot create %s\n", MASTER_NAME);
+		goto free_pool;
+	}
+
+	/*
+	 * The sockets of a process are identified by their path, the slave
+	 * connects to the same file through another path.
+	 */
+	snprintf(args, sizeof(args),
+			"role=slave,id=0,socket=/%s,rsize=%d,zero-copy=yes",
+			socket_path, LOG2_RING_SIZE);
+	if (pmd_perf_port_create(SLAVE_NAME, args, NULL, RING_SIZE, pkt_pool,
+			&slave_port) != 0) {
+		printf("Cannot create %s\n", SLAVE_NAME);
+		goto destroy_master;
+	}
+
+	if (wait_link_up(master_port) != 0 || wait_link_up(slave_port) != 0) {
+		printf("memif connection not established\n");
+		pmd_perf_port_destroy(slave_port);
+		goto destroy_master;
+	}
+	/* the slave posts its Rx mbufs to the master when polling */
+	if (rte_eth_rx_burst(slave_port, 0, NULL, 0) != 0) {
+		printf("Unexpected packets received\n");
+		pmd_perf_port_destroy(slave_port);
+		goto destroy_master;
+	}
+
+	return 0;
+
+destroy_master:
+	pmd_perf_port_destroy(master_port);
+	unlink(socket_path);
+free_pool:
+	rte_mempool_free(pkt_pool);
+	pkt_pool = NULL;
+	return -1;
+}
+
+static void
+test_memif_teardown(void)
+{
+	pmd_perf_port_destroy(slave_port);
+	pmd_perf_port_destroy(master_port);
+	unlink(socket_path);
+	rte_mempool_free(pkt_pool);
+	pkt_pool = NULL;
+}
+
+static struct unit_test_suite memif_test_suite = {
+	.suite_name = "memif zero-copy slave test suite",
+	.setup = test_memif_setup,
+	.teardown = test_memif_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_memif_zc_slave_tx),
+		TEST_CASE(test_memif_zc_slave_rx),
+		TEST_CASE(test_memif_zc_slave_rx_ring_full),
+		TEST_CASE(test_memif_zc_slave_tx_page_cross),
+		TEST_CASE(test_memif_zc_slave_tx_free),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_pmd_memif(void)
+{
+	return unit_test_suite_runner(&memif_test_suite);
+}
+
+REGISTER_TEST_COMMAND(memif_pmd_autotest, test_pmd_memif);
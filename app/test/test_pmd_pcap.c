@@ -0,0 +1,360 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "test.h"
+
+/*
+ * Functional tests of the infinite_rx mode of the pcap PMD: replay of the
+ * preloaded file, clones of the preloaded packets and pacing of the replay
+ * at a fixed rate or at the pace of the file timestamps.
+ */
+
+#define PCAP_TEST_NAME "net_pcap_test"
+#define NB_FILE_PKTS 4
+#define PKT_LEN 64
+#define PKT_GAP_US 10000	/* gap between the file timestamps */
+#define NB_MBUF 1024
+#define NB_DESC 512
+#define MAX_BURST 32
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_LINKTYPE_ETHERNET 1
+
+struct pcap_file_header {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct pcap_record_header {
+	uint32_t ts_sec;
+	uint32_t ts_usec;
+	uint32_t incl_len;
+	uint32_t orig_len;
+};
+
+static struct rte_mempool *mp;
+static char pcap_file[] = "/tmp/test_pmd_pcap_XXXXXX";
+
+/* The byte after the Ethernet header is the index of the packet in the file */
+static int
+write_pcap_file(void)
+{
+	struct pcap_file_header hdr = {
+		.magic = PCAP_MAGIC,
+		.version_major = 2,
+		.version_minor = 4,
+		.snaplen = UINT16_MAX,
+		.linktype = PCAP_LINKTYPE_ETHERNET,
+	};
+	struct pcap_record_header rec;
+	uint8_t pkt[PKT_LEN];
+	unsigned int i;
+	FILE *f;
+	int fd;
+
+	fd = mkstemp(pcap_file);
+	if (fd < 0)
+		return -1;
+	f = fdopen(fd, "w");
+	if (f == NULL) {
+		close(fd);
+		return -1;
+	}
+
+	fwrite(&hdr, sizeof(hdr), 1, f);
+	for (i = 0; i < NB_FILE_PKTS; i++) {
+		rec.ts_sec = (i * PKT_GAP_US) / US_PER_S;
+		rec.ts_usec = (i * PKT_GAP_US) % US_PER_S;
+		rec.incl_len = PKT_LEN;
+		rec.orig_len = PKT_LEN;
+		memset(pkt, 0, sizeof(pkt));
+		memset(pkt, 0xff, RTE_ETHER_ADDR_LEN);
+		pkt[RTE_ETHER_HDR_LEN] = i;
+		fwrite(&rec, sizeof(rec), 1, f);
+		fwrite(pkt, sizeof(pkt), 1, f);
+	}
+
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+static int
+pcap_port_create(const char *devargs, uint16_t *port)
+{
+	struct rte_eth_conf conf;
+	char args[PATH_MAX + 128];
+
+	memset(&conf, 0, sizeof(conf));
+	snprintf(args, sizeof(args), "rx_pcap=%s,infinite_rx=1%s",
+			pcap_file, devargs);
+
+	if (rte_vdev_init(PCAP_TEST_NAME, args) < 0)
+		return -1;
+
+	if (rte_eth_dev_get_port_by_name(PCAP_TEST_NAME, port) != 0 ||
+			rte_eth_dev_configure(*port, 1, 1, &conf) < 0 ||
+			rte_eth_rx_queue_setup(*port, 0, NB_DESC,
+				rte_eth_dev_socket_id(*port), NULL, mp) < 0 ||
+			rte_eth_tx_queue_setup(*port, 0, NB_DESC,
+				rte_eth_dev_socket_id(*port), NULL) < 0 ||
+			rte_eth_dev_start(*port) < 0) {
+		rte_vdev_uninit(PCAP_TEST_NAME);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+pcap_port_destroy(uint16_t port)
+{
+	rte_eth_dev_stop(port);
+	rte_eth_dev_close(port);
+	rte_vdev_uninit(PCAP_TEST_NAME);
+}
+
+static unsigned int
+pkt_index(struct rte_mbuf *m)
+{
+	return *rte_pktmbuf_mtod_offset(m, uint8_t *, RTE_ETHER_HDR_LEN);
+}
+
+/* Receive the packets due until the deadline, checking their order */
+static int
+receive_until(uint16_t port, uint64_t deadline, uint64_t *nb_rx,
+		uint64_t max_rx)
+{
+	struct rte_mbuf *pkts[MAX_BURST];
+	uint16_t i, n;
+	int ret = 0;
+
+	while (*nb_rx < max_rx && rte_get_timer_cycles() < deadline) {
+		n = rte_eth_rx_burst(port, 0, pkts,
+				RTE_MIN((uint64_t)MAX_BURST, max_rx - *nb_rx));
+		for (i = 0; i < n; i++) {
+			if (pkts[i]->pkt_len != PKT_LEN ||
+					pkt_index(pkts[i]) !=
+					(*nb_rx + i) % NB_FILE_PKTS)
+				ret = -1;
+			rte_pktmbuf_free(pkts[i]);
+		}
+		*nb_rx += n;
+	}
+
+	return ret;
+}
+
+static int
+test_setup(void)
+{
+	mp = rte_pktmbuf_pool_create("pcap_test_pool", NB_MBUF, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mp == NULL) {
+		printf("%s: mempool creation failed\n", __func__);
+		return -1;
+	}
+
+	if (write_pcap_file() < 0) {
+		printf("%s: cannot write %s\n", __func__, pcap_file);
+		rte_mempool_free(mp);
+		mp = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+test_teardown(void)
+{
+	unlink(pcap_file);
+	rte_mempool_free(mp);
+	mp = NULL;
+}
+
+/* The file is replayed in order, again and again */
+static int
+test_pcap_infinite_rx_replay(void)
+{
+	const uint64_t nb_pkts = 10 * NB_FILE_PKTS + 1;
+	uint64_t nb_rx = 0;
+	uint16_t port;
+	int ret;
+
+	if (pcap_port_create("", &port) < 0) {
+		printf("Cannot create pcap port, is the pcap PMD enabled?\n");
+		return TEST_SKIPPED;
+	}
+
+	ret = receive_until(port, rte_get_timer_cycles() + rte_get_timer_hz(),
+			&nb_rx, nb_pkts);
+	pcap_port_destroy(port);
+
+	TEST_ASSERT_SUCCESS(ret, "Packets replayed out of order");
+	TEST_ASSERT_EQUAL(nb_rx, nb_pkts,
+			"Received %" PRIu64 " packets instead of %" PRIu64,
+			nb_rx, nb_pkts);
+
+	return TEST_SUCCESS;
+}
+
+/* The clones are indirect mbufs holding a reference on the preloaded data */
+static int
+test_pcap_infinite_rx_clone(void)
+{
+	struct rte_mbuf *pkts[NB_FILE_PKTS];
+	uint16_t i, n, port;
+	int ret = TEST_SUCCESS;
+
+	if (pcap_port_create(",infinite_rx_clone=1", &port) < 0) {
+		printf("Cannot create pcap port, is the pcap PMD enabled?\n");
+		return TEST_SKIPPED;
+	}
+
+	n = rte_eth_rx_burst(port, 0, pkts, NB_FILE_PKTS);
+	if (n != NB_FILE_PKTS) {
+		printf("Received %u packets instead of %u\n", n, NB_FILE_PKTS);
+		ret = TEST_FAILED;
+	}
+	for (i = 0; i < n; i++) {
+		if (!RTE_MBUF_CLONED(pkts[i]) ||
+				rte_mbuf_refcnt_read(rte_mbuf_from_indirect(
+					pkts[i])) < 2 ||
+				pkts[i]->pkt_len != PKT_LEN ||
+				pkt_index(pkts[i]) != i) {
+			printf("Packet %u is not a clone of the file one\n", i);
+			ret = TEST_FAILED;
+		}
+	}
+
+	/* The preloaded packets outlive the port while clones are held */
+	pcap_port_destroy(port);
+	for (i = 0; i < n; i++) {
+		if (pkt_index(pkts[i]) != i)
+			ret = TEST_FAILED;
+		rte_pktmbuf_free(pkts[i]);
+	}
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(mp), NB_MBUF,
+			"Mbufs leaked");
+
+	return ret;
+}
+
+/* infinite_rx_rate paces the replay, without catching up after a pause */
+static int
+test_pcap_infinite_rx_rate(void)
+{
+	const uint64_t rate = 10000;
+	const uint64_t hz = rte_get_timer_hz();
+	struct rte_mbuf *pkts[MAX_BURST];
+	char devargs[64];
+	uint64_t nb_rx = 0, expected;
+	uint16_t port, n;
+	int ret;
+
+	snprintf(devargs, sizeof(devargs), ",infinite_rx_rate=%" PRIu64, rate);
+	if (pcap_port_create(devargs, &port) < 0) {
+		printf("Cannot create pcap port, is the pcap PMD enabled?\n");
+		return TEST_SKIPPED;
+	}
+
+	/* Poll for 100 ms */
+	ret = receive_until(port, rte_get_timer_cycles() + hz / 10, &nb_rx,
+			UINT64_MAX);
+	expected = rate / 10;
+
+	/* Time elapsed without polling is not caught up with */
+	rte_delay_ms(50);
+	n = rte_eth_rx_burst(port, 0, pkts, MAX_BURST);
+	while (n > 0)
+		rte_pktmbuf_free(pkts[--n]);
+	n = rte_eth_rx_burst(port, 0, pkts, MAX_BURST);
+	pcap_port_destroy(port);
+
+	TEST_ASSERT_SUCCESS(ret, "Packets replayed out of order");
+	TEST_ASSERT(nb_rx >= expected * 8 / 10 && nb_rx <= expected * 12 / 10,
+			"Received %" PRIu64 " packets in 100 ms at %" PRIu64
+			" pps", nb_rx, rate);
+	TEST_ASSERT(n <= 1, "Received %u packets right after a burst", n);
+	while (n > 0)
+		rte_pktmbuf_free(pkts[--n]);
+
+	return TEST_SUCCESS;
+}
+
+/* infinite_rx_timing replays the gaps between the file timestamps */
+static int
+test_pcap_infinite_rx_timing(void)
+{
+	const uint64_t hz = rte_get_timer_hz();
+	const uint64_t gap = hz * PKT_GAP_US / US_PER_S;
+	uint64_t nb_rx = 0, start, elapsed;
+	uint16_t port;
+	int ret;
+
+	if (pcap_port_create(",infinite_rx_timing=1", &port) < 0) {
+		printf("Cannot create pcap port, is the pcap PMD enabled?\n");
+		return TEST_SKIPPED;
+	}
+
+	/* The first packet is due at once */
+	start = rte_get_timer_cycles();
+	ret = receive_until(port, start + hz, &nb_rx, 1);
+	start = rte_get_timer_cycles();
+	if (ret == 0)
+		ret = receive_until(port, start + hz, &nb_rx, NB_FILE_PKTS);
+	elapsed = rte_get_timer_cycles() - start;
+	pcap_port_destroy(port);
+
+	TEST_ASSERT_SUCCESS(ret, "Packets replayed out of order");
+	TEST_ASSERT_EQUAL(nb_rx, NB_FILE_PKTS, "Received %" PRIu64 " packets",
+			nb_rx);
+	/* Tolerate the timer granularity, not missing gaps */
+	TEST_ASSERT(elapsed >= (NB_FILE_PKTS - 1) * gap * 9 / 10 &&
+			elapsed < (NB_FILE_PKTS - 1) * gap + hz / 10,
+			"File replayed in %" PRIu64 " us instead of %u us",
+			elapsed * US_PER_S / hz,
+			(NB_FILE_PKTS - 1) * PKT_GAP_US);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite pcap_pmd_test_suite  = {
+	.setup = test_setup,
+	.teardown = test_teardown,
+	.suite_name = "pcap PMD Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_pcap_infinite_rx_replay),
+		TEST_CASE(test_pcap_infinite_rx_clone),
+		TEST_CASE(test_pcap_infinite_rx_rate),
+		TEST_CASE(test_pcap_infinite_rx_timing),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_pmd_pcap(void)
+{
+	return unit_test_suite_runner(&pcap_pmd_test_suite);
+}
+
+REGISTER_TEST_COMMAND(pcap_pmd_autotest, test_pmd_pcap);
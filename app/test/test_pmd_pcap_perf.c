@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <rte_bus_vdev.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Capture and replay rates of the pcap PMD: packets are written to a pcap
+ * file through a tx_pcap port, then read back through a rx_pcap port,
+ * with and without the rx_mmap mode.
+ */
+
+#define PCAP_PERF_TX_NAME "net_pcap_perf_tx"
+#define PCAP_PERF_RX_NAME "net_pcap_perf_rx"
+#define NB_PKTS (1 << 19)
+#define NB_MBUF 2048
+#define NB_DESC 512
+
+static struct rte_mempool *mp;
+
+static void
+print_rate(const char *test, uint64_t nb_pkts, uint64_t cycles)
+{
+	printf("%-16s: %" PRIu64 " packets, %.1F cycles/packet, %.2F Mpps\n",
+			test, nb_pkts, (double)cycles / nb_pkts,
+			(double)nb_pkts * rte_get_tsc_hz() / cycles / 1e6);
+}
+
+/* Write NB_PKTS packets to the file, the same burst is sent again and again */
+static int
+test_pcap_capture(const char *file)
+{
+	struct rte_mbuf *pkts[PMD_PERF_BURST_SIZE];
+	char args[PATH_MAX + 16];
+	uint64_t start, end;
+	unsigned int i, n;
+	uint16_t port;
+
+	snprintf(args, sizeof(args), "tx_pcap=%s", file);
+	if (pmd_perf_port_create(PCAP_PERF_TX_NAME, args, NULL, NB_DESC, mp,
+			&port) < 0) {
+		printf("Cannot create pcap port, is the pcap PMD enabled?\n");
+		return TEST_SKIPPED;
+	}
+
+	if (pmd_perf_fill_burst(mp, pkts, PMD_PERF_BURST_SIZE,
+			PMD_PERF_PKT_LEN, PMD_PERF_ETHER_TYPE) != 0) {
+		pmd_perf_port_destroy(port);
+		return TEST_FAILED;
+	}
+
+	start = rte_rdtsc_precise();
+	for (n = 0; n < NB_PKTS; n += PMD_PERF_BURST_SIZE) {
+		/* keep the packets for the next burst */
+		for (i = 0; i < PMD_PERF_BURST_SIZE; i++)
+			rte_mbuf_refcnt_update(pkts[i], 1);
+		rte_eth_tx_burst(port, 0, pkts, PMD_PERF_BURST_SIZE);
+	}
+	end = rte_rdtsc_precise();
+
+	pmd_perf_free_burst(pkts, PMD_PERF_BURST_SIZE);
+	pmd_perf_port_destroy(port);
+
+	print_rate("capture", NB_PKTS, end - start);
+
+	return TEST_SUCCESS;
+}
+
+/* Read the file back until its end */
+static int
+test_pcap_replay(const char *test, const char *file, const char *devargs)
+{
+	struct rte_mbuf *pkts[PMD_PERF_BURST_SIZE];
+	char args[PATH_MAX + 32];
+	uint64_t start, end;
+	uint64_t nb_rx = 0, nb_bytes = 0;
+	uint16_t i, n, port;
+
+	snprintf(args, sizeof(args), "rx_pcap=%s%s", file, devargs);
+	if (pmd_perf_port_create(PCAP_PERF_RX_NAME, args, NULL, NB_DESC, mp,
+			&port) < 0) {
+		printf("Cannot create pcap port with %s\n", args);
+		return TEST_FAILED;
+	}
+
+	start = rte_rdtsc_precise();
+	while ((n = rte_eth_rx_burst(port, 0, pkts,
+			PMD_PERF_BURST_SIZE)) != 0) {
+		for (i = 0; i < n; i++) {
+			nb_bytes += rte_pktmbuf_pkt_len(pkts[i]);
+			rte_pktmbuf_free(pkts[i]);
+		}
+		nb_rx += n;
+	}
+	end = rte_rdtsc_precise();
+
+	pmd_perf_port_destroy(port);
+
+	TEST_ASSERT_EQUAL(nb_rx, NB_PKTS,
+			"%s: received %" PRIu64 " packets", test, nb_rx);
+	TEST_ASSERT_EQUAL(nb_bytes, (uint64_t)NB_PKTS * PMD_PERF_PKT_LEN,
+			"%s: received %" PRIu64 " bytes", test, nb_bytes);
+
+	print_rate(test, nb_rx, end - start);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_pmd_pcap_perf(void)
+{
+	char file[] = "/tmp/test_pcap_perf_XXXXXX";
+	int fd, ret;
+
+	mp = pmd_perf_pool_create("pcap_perf_pool", NB_MBUF,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	if (mp == NULL)
+		return TEST_FAILED;
+
+	fd = mkstemp(file);
+	if (fd < 0) {
+		printf("Cannot create temporary file\n");
+		rte_mempool_free(mp);
+		return TEST_FAILED;
+	}
+	close(fd);
+
+	ret = test_pcap_capture(file);
+	if (ret == TEST_SUCCESS)
+		ret = test_pcap_replay("replay (copy)", file, "");
+	if (ret == TEST_SUCCESS)
+		ret = test_pcap_replay("replay (mmap)", file, ",rx_mmap=1");
+
+	unlink(file);
+	rte_mempool_free(mp);
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(pcap_pmd_perf_autotest, test_pmd_pcap_perf);
@@ -0,0 +1,300 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/sockios.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_string_fns.h>
+#include <rte_tcp.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Measure the tap PMD on a local tap pair: the kernel interfaces of two tap
+ * ports are attached to a bridge, which forwards the packets sent on the
+ * first port to the second one without going through the network stack.
+ * Small packets give the cost per packet of the Tx and Rx bursts, TSO
+ * packets the cost of sending large TCP segments through the kernel.
+ */
+
+#define TAP_PERF_IFACE0 "dtap_perf0"
+#define TAP_PERF_IFACE1 "dtap_perf1"
+#define TAP_PERF_BRIDGE "dtap_perf_br"
+#define RING_SIZE 1024
+#define BURST_SIZE PMD_PERF_BURST_SIZE
+#define NB_MBUFS (4 * RING_SIZE + 8 * BURST_SIZE)
+#define PKT_LEN PMD_PERF_PKT_LEN
+#define ITERATIONS 4096
+#define TSO_BURST_SIZE 8
+#define TSO_ITERATIONS 256
+#define TSO_SEG_SIZE 1448
+#define TSO_PKT_LEN 60000
+#define TSO_NB_MBUFS (4 * TSO_BURST_SIZE)
+
+static const struct {
+	const char *name;
+	const char *args;
+} tap_perf_ports[] = {
+	{ "net_tap_perf0", "iface=" TAP_PERF_IFACE0 },
+	{ "net_tap_perf1", "iface=" TAP_PERF_IFACE1 },
+};
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *tso_pool;
+static uint16_t ports[RTE_DIM(tap_perf_ports)];
+/* the kernel aggregates the TSO segments for the receiving port */
+static bool tso_lro;
+
+static int
+port_create(unsigned int i)
+{
+	struct rte_eth_conf conf;
+
+	/* the first port sends, the second one receives the TSO packets */
+	memset(&conf, 0, sizeof(conf));
+	conf.txmode.offloads = DEV_TX_OFFLOAD_IPV4_CKSUM |
+		DEV_TX_OFFLOAD_TCP_CKSUM | DEV_TX_OFFLOAD_TCP_TSO |
+		DEV_TX_OFFLOAD_MULTI_SEGS;
+	conf.rxmode.offloads = DEV_RX_OFFLOAD_SCATTER | DEV_RX_OFFLOAD_TCP_LRO;
+
+	return pmd_perf_port_create(tap_perf_ports[i].name,
+			tap_perf_ports[i].args, &conf, RING_SIZE, pkt_pool,
+			&ports[i]);
+}
+
+static int
+set_iface_up(int sock, const char *ifname, bool up)
+{
+	struct ifreq ifr;
+
+	memset(&ifr, 0, sizeof(ifr));
+	strlcpy(ifr.ifr_name, ifname, IFNAMSIZ);
+	if (ioctl(sock, SIOCGIFFLAGS, &ifr) < 0)
+		return -1;
+	if (up)
+		ifr.ifr_flags |= IFF_UP;
+	else
+		ifr.ifr_flags &= ~IFF_UP;
+	return ioctl(sock, SIOCSIFFLAGS, &ifr);
+}
+
+/* Attach the kernel interfaces of the ports to a new bridge */
+static int
+bridge_create(int sock)
+{
+	struct ifreq ifr;
+
+	if (ioctl(sock, SIOCBRADDBR, TAP_PERF_BRIDGE) < 0)
+		return -1;
+
+	memset(&ifr, 0, sizeof(ifr));
+	strlcpy(ifr.ifr_name, TAP_PERF_BRIDGE, IFNAMSIZ);
+	ifr.ifr_ifindex = if_nametoindex(TAP_PERF_IFACE0);
+	if (ifr.ifr_ifindex == 0 || ioctl(sock, SIOCBRADDIF, &ifr) < 0)
+		goto destroy;
+	ifr.ifr_ifindex = if_nametoindex(TAP_PERF_IFACE1);
+	if (ifr.ifr_ifindex == 0 || ioctl(sock, SIOCBRADDIF, &ifr) < 0)
+		goto destroy;
+	if (set_iface_up(sock, TAP_PERF_BRIDGE, true) < 0)
+		goto destroy;
+
+	return 0;
+
+destroy:
+	ioctl(sock, SIOCBRDELBR, TAP_PERF_BRIDGE);
+	return -1;
+}
+
+static void
+bridge_destroy(int sock)
+{
+	set_iface_up(sock, TAP_PERF_BRIDGE, false);
+	ioctl(sock, SIOCBRDELBR, TAP_PERF_BRIDGE);
+}
+
+/* Single segment TCP packets to be segmented in TSO_SEG_SIZE payloads */
+static int
+fill_tso_burst(struct rte_mbuf **pkts, uint16_t nb)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_tcp_hdr *tcp;
+	uint16_t i;
+
+	if (rte_pktmbuf_alloc_bulk(tso_pool, pkts, nb) != 0)
+		return -1;
+
+	for (i = 0; i < nb; i++) {
+		eth = (struct rte_ether_hdr *)rte_pktmbuf_append(pkts[i],
+				TSO_PKT_LEN);
+		if (eth == NULL) {
+			for (i = 0; i < nb; i++)
+				rte_pktmbuf_free(pkts[i]);
+			return -1;
+		}
+		memset(eth, 0, sizeof(*eth) + sizeof(*ip) + sizeof(*tcp));
+		memset(&eth->d_addr, 0xff, RTE_ETHER_ADDR_LEN);
+		eth->s_addr.addr_bytes[0] = 0x02;
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+		ip = (struct rte_ipv4_hdr *)(eth + 1);
+		ip->version_ihl = 0x45;
+		ip->total_length = rte_cpu_to_be_16(TSO_PKT_LEN - sizeof(*eth));
+		ip->time_to_live = 64;
+		ip->next_proto_id = IPPROTO_TCP;
+		ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(192, 0, 2, 1));
+		ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(192, 0, 2, 2));
+		tcp = (struct rte_tcp_hdr *)(ip + 1);
+		tcp->src_port = rte_cpu_to_be_16(1024);
+		tcp->dst_port = rte_cpu_to_be_16(1025);
+		tcp->data_off = (sizeof(*tcp) / 4) << 4;
+		tcp->tcp_flags = RTE_TCP_ACK_FLAG;
+		tcp->rx_win = rte_cpu_to_be_16(UINT16_MAX);
+
+		pkts[i]->l2_len = sizeof(*eth);
+		pkts[i]->l3_len = sizeof(*ip);
+		pkts[i]->l4_len = sizeof(*tcp);
+		pkts[i]->tso_segsz = TSO_SEG_SIZE;
+		pkts[i]->ol_flags = PKT_TX_TCP_SEG | PKT_TX_IPV4 |
+			PKT_TX_IP_CKSUM | PKT_TX_TCP_CKSUM;
+	}
+
+	return 0;
+}
+
+static int
+tap_pair_loop(bool tso)
+{
+	struct pmd_perf_rx_stats drained = { 0 }, rx = { 0 };
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint16_t burst = tso ? TSO_BURST_SIZE : BURST_SIZE;
+	uint16_t ether_type = tso ? RTE_ETHER_TYPE_IPV4 : PMD_PERF_ETHER_TYPE;
+	unsigned int iterations = tso ? TSO_ITERATIONS : ITERATIONS;
+	uint64_t tx_cycles = 0, start, total;
+	uint64_t nb_tx = 0;
+	unsigned int i;
+	uint16_t nb;
+	int ret;
+
+	/* drain the packets sent by the kernel on link up */
+	pmd_perf_port_receive(ports[1], 0, UINT64_MAX, UINT64_MAX, true,
+			&drained);
+
+	total = rte_rdtsc();
+	for (i = 0; i < iterations; i++) {
+		ret = tso ? fill_tso_burst(pkts, burst) :
+			pmd_perf_fill_burst(pkt_pool, pkts, burst, PKT_LEN,
+				PMD_PERF_ETHER_TYPE);
+		if (ret != 0) {
+			printf("Cannot allocate packets\n");
+			return -1;
+		}
+
+		start = rte_rdtsc_precise();
+		nb = rte_eth_tx_burst(ports[0], 0, pkts, burst);
+		tx_cycles += rte_rdtsc_precise() - start;
+		nb_tx += nb;
+		pmd_perf_free_burst(&pkts[nb], burst - nb);
+
+		/* the segments have their own headers */
+		pmd_perf_port_receive(ports[1], ether_type, UINT64_MAX,
+				tso ? nb * (TSO_PKT_LEN - 64) : nb * PKT_LEN,
+				true, &rx);
+	}
+	total = rte_rdtsc() - total;
+
+	if (nb_tx == 0 || rx.pkts == 0) {
+		printf("No packet through the tap pair\n");
+		return -1;
+	}
+
+	printf("%10s %10"PRIu64" %12"PRIu64" %10"PRIu64" %12"PRIu64
+			" %12"PRIu64"\n",
+			tso ? "TSO" : "64 bytes", nb_tx, tx_cycles / nb_tx,
+			rx.pkts, rx.cycles / rx.pkts, total * 1024 / rx.bytes);
+
+	return 0;
+}
+
+static int
+test_pmd_tap_perf(void)
+{
+	struct rte_eth_dev_info dev_info;
+	unsigned int i, nb_ports = 0;
+	int sock, ret = 0;
+
+	if (access("/dev/net/tun", R_OK | W_OK) != 0) {
+		printf("No tun device, skipping\n");
+		return TEST_SKIPPED;
+	}
+
+	pkt_pool = pmd_perf_pool_create("TAP_PERF_POOL", NB_MBUFS,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	tso_pool = pmd_perf_pool_create("TAP_PERF_TSO_POOL", TSO_NB_MBUFS,
+			RTE_PKTMBUF_HEADROOM + TSO_PKT_LEN);
+	if (pkt_pool == NULL || tso_pool == NULL) {
+		ret = -1;
+		goto free_pools;
+	}
+
+	for (nb_ports = 0; nb_ports < RTE_DIM(tap_perf_ports); nb_ports++)
+		if (port_create(nb_ports) != 0)
+			break;
+	if (nb_ports < RTE_DIM(tap_perf_ports)) {
+		printf("Cannot create the tap ports\n");
+		ret = -1;
+		goto destroy_ports;
+	}
+	if (rte_eth_dev_info_get(ports[1], &dev_info) != 0) {
+		ret = -1;
+		goto destroy_ports;
+	}
+	tso_lro = (dev_info.rx_offload_capa & DEV_RX_OFFLOAD_TCP_LRO) != 0;
+
+	sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sock < 0 || bridge_create(sock) != 0) {
+		printf("Cannot bridge the tap ports, skipping\n");
+		ret = TEST_SKIPPED;
+		goto close_sock;
+	}
+
+	printf("Tap pair %s -> %s, bursts of %u and %u\n", TAP_PERF_IFACE0,
+			TAP_PERF_IFACE1, BURST_SIZE, TSO_BURST_SIZE);
+	printf("%10s %10s %12s %10s %12s %12s\n", "packets", "sent",
+			"tx cyc/pkt", "received", "rx cyc/pkt", "cyc/KB");
+	ret = tap_pair_loop(false);
+	if (ret == 0 && tso_lro)
+		ret = tap_pair_loop(true);
+	else if (ret == 0)
+		printf("%10s not available\n", "TSO");
+
+	bridge_destroy(sock);
+close_sock:
+	if (sock >= 0)
+		close(sock);
+destroy_ports:
+	for (i = 0; i < nb_ports; i++)
+		pmd_perf_port_destroy(ports[i]);
+free_pools:
+	rte_mempool_free(tso_pool);
+	rte_mempool_free(pkt_pool);
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(tap_pmd_perf_autotest, test_pmd_tap_perf);
@@ -0,0 +1,200 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Measure the cost of the vhost library datapath with a vhost-user
+ * loopback: a virtio-user port is connected to a vhost port in the same
+ * process. Bursts of packets are sent on the virtio-user port, dequeued
+ * from and enqueued back to the vhost port, and received again on the
+ * virtio-user port. The vhost dequeue and enqueue and the virtio-user
+ * Tx and Rx are timed, with the split and the packed ring layouts, and
+ * with the vectorized virtio paths of the packed ring.
+ */
+
+#define VHOST_NAME "net_vhost_perf"
+#define VIRTIO_USER_NAME "net_virtio_user_perf"
+#define RING_SIZE 256
+#define BURST_SIZE PMD_PERF_BURST_SIZE
+#define NB_MBUFS (4 * RING_SIZE + 4 * BURST_SIZE)
+#define PKT_LEN PMD_PERF_PKT_LEN
+#define ITERATIONS (1 << 20)
+#define LINK_WAIT_MS 5000
+
+/* The vectorized Rx path needs mergeable buffers to be disabled */
+static const struct vhost_perf_ring {
+	const char *name;
+	int packed;
+	int vectorized;
+} rings[] = {
+	{ "split", 0, 0 },
+	{ "packed", 1, 0 },
+	{ "packed vec", 1, 1 },
+};
+
+static struct rte_mempool *pkt_pool;
+static char socket_path[PATH_MAX];
+
+static int
+wait_link_up(uint16_t port)
+{
+	struct rte_eth_link link;
+	int ms;
+
+	for (ms = 0; ms < LINK_WAIT_MS; ms += 10) {
+		memset(&link, 0, sizeof(link));
+		rte_eth_link_get_nowait(port, &link);
+		if (link.link_status == ETH_LINK_UP)
+			return 0;
+		rte_delay_ms(10);
+	}
+
+	return -1;
+}
+
+static int
+loopback(uint16_t virtio_port, uint16_t vhost_port,
+		const struct vhost_perf_ring *ring)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	uint64_t deq_cycles = 0, enq_cycles = 0, tx_cycles = 0, rx_cycles = 0;
+	uint64_t nb_deq = 0, nb_enq = 0, nb_tx = 0, nb_rx = 0;
+	uint64_t start;
+	uint16_t nb = 0, n;
+	unsigned int i;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		/* packets lost on the way are replaced */
+		if (nb < BURST_SIZE) {
+			if (pmd_perf_fill_burst(pkt_pool, &pkts[nb],
+					BURST_SIZE - nb, PKT_LEN,
+					PMD_PERF_ETHER_TYPE) != 0) {
+				printf("Cannot allocate packets\n");
+				pmd_perf_free_burst(pkts, nb);
+				return -1;
+			}
+			nb = BURST_SIZE;
+		}
+
+		start = rte_rdtsc_precise();
+		n = rte_eth_tx_burst(virtio_port, 0, pkts, nb);
+		tx_cycles += rte_rdtsc_precise() - start;
+		nb_tx += n;
+		pmd_perf_free_burst(&pkts[n], nb - n);
+
+		start = rte_rdtsc_precise();
+		nb = rte_eth_rx_burst(vhost_port, 0, pkts, BURST_SIZE);
+		deq_cycles += rte_rdtsc_precise() - start;
+		nb_deq += nb;
+
+		start = rte_rdtsc_precise();
+		n = rte_eth_tx_burst(vhost_port, 0, pkts, nb);
+		enq_cycles += rte_rdtsc_precise() - start;
+		nb_enq += n;
+		pmd_perf_free_burst(&pkts[n], nb - n);
+
+		start = rte_rdtsc_precise();
+		nb = rte_eth_rx_burst(virtio_port, 0, pkts, BURST_SIZE);
+		rx_cycles += rte_rdtsc_precise() - start;
+		nb_rx += nb;
+	}
+	pmd_perf_free_burst(pkts, nb);
+
+	if (nb_deq == 0 || nb_enq == 0 || nb_tx == 0 || nb_rx == 0) {
+		printf("No packet through the %s ring\n", ring->name);
+		return -1;
+	}
+
+	printf("%10s %12"PRIu64" %12"PRIu64" %12"PRIu64" %12"PRIu64
+			" %12"PRIu64"\n", ring->name, nb_rx,
+			deq_cycles / nb_deq, enq_cycles / nb_enq,
+			tx_cycles / nb_tx, rx_cycles / nb_rx);
+
+	return 0;
+}
+
+static int
+test_vhost_loopback(const struct vhost_perf_ring *ring)
+{
+	uint16_t vhost_port, virtio_port;
+	char args[PATH_MAX + 128];
+	int ret;
+
+	unlink(socket_path);
+
+	snprintf(args, sizeof(args), "iface=%s,queues=1", socket_path);
+	if (pmd_perf_port_create(VHOST_NAME, args, NULL, RING_SIZE, pkt_pool,
+			&vhost_port) != 0) {
+		printf("Cannot create %s\n", VHOST_NAME);
+		return TEST_SKIPPED;
+	}
+
+	snprintf(args, sizeof(args),
+			"path=%s,queues=1,packed_vq=%d,in_order=1,mrg_rxbuf=0,"
+			"vectorized=%d", socket_path, ring->packed,
+			ring->vectorized);
+	if (pmd_perf_port_create(VIRTIO_USER_NAME, args, NULL, RING_SIZE,
+			pkt_pool, &virtio_port) != 0) {
+		printf("Cannot create %s\n", VIRTIO_USER_NAME);
+		pmd_perf_port_destroy(vhost_port);
+		unlink(socket_path);
+		return TEST_SKIPPED;
+	}
+
+	if (wait_link_up(vhost_port) != 0) {
+		printf("vhost-user connection not established\n");
+		ret = -1;
+	} else {
+		ret = loopback(virtio_port, vhost_port, ring);
+	}
+
+	pmd_perf_port_destroy(virtio_port);
+	pmd_perf_port_destroy(vhost_port);
+	unlink(socket_path);
+
+	return ret;
+}
+
+static int
+test_pmd_vhost_perf(void)
+{
+	unsigned int i;
+	int ret = 0;
+
+	pkt_pool = pmd_perf_pool_create("VHOST_PERF_POOL", NB_MBUFS,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	if (pkt_pool == NULL)
+		return -1;
+	snprintf(socket_path, sizeof(socket_path), "/tmp/vhost_perf_%d.sock",
+			getpid());
+
+	printf("vhost-user loopback, %u bytes packets, bursts of %u\n",
+			PKT_LEN, BURST_SIZE);
+	printf("%10s %12s %12s %12s %12s %12s\n", "ring", "looped",
+			"vhost deq", "vhost enq", "virtio tx", "virtio rx");
+	for (i = 0; i < RTE_DIM(rings); i++) {
+		ret = test_vhost_loopback(&rings[i]);
+		if (ret != 0)
+			break;
+	}
+
+	rte_mempool_free(pkt_pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(vhost_pmd_perf_autotest, test_pmd_vhost_perf);
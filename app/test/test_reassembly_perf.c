@@ -0,0 +1,216 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_ip_frag.h>
+
+#include "test.h"
+
+/*
+ * Measure the cost of the IPv4 reassembly according to the number of
+ * concurrent datagrams. The first fragments of all the datagrams are
+ * added to the table before their last fragments, so each fragment
+ * requires a lookup among all the datagrams of the table. Then the
+ * table is filled again, and all its entries are expired.
+ */
+
+#define FRAG_LEN 16
+#define BURST_SIZE 32U
+#define MAX_DGRAM_NUM (1U << 20)
+#define NB_MBUFS (MAX_DGRAM_NUM + 2 * BURST_SIZE)
+#define HDR_LEN (sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr))
+#define BUCKET_ENTRIES 8
+
+static const uint32_t dgram_nums[] = {1024, 1U << 16, MAX_DGRAM_NUM};
+
+static struct rte_mempool *pkt_pool;
+static struct rte_ip_frag_death_row death_row;
+
+static void
+init_ipv4_frag(struct rte_mbuf *m, uint32_t dgram, int last)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(m,
+			HDR_LEN + FRAG_LEN);
+	memset(eth, 0, HDR_LEN);
+	eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+
+	ip = (struct rte_ipv4_hdr *)(eth + 1);
+	ip->version_ihl = RTE_IPV4_VHL_DEF;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + FRAG_LEN);
+	ip->packet_id = rte_cpu_to_be_16(dgram);
+	ip->fragment_offset = last ?
+		rte_cpu_to_be_16(FRAG_LEN / RTE_IPV4_HDR_OFFSET_UNITS) :
+		rte_cpu_to_be_16(RTE_IPV4_HDR_MF_FLAG);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(10, dgram >> 16, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(10, 255, 0, 1));
+
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4;
+	m->l2_len = sizeof(*eth);
+	m->l3_len = sizeof(*ip);
+}
+
+/*
+ * Add one fragment of each datagram to the table, with the packet or
+ * the burst API. Return the number of reassembled datagrams, or -1.
+ */
+static int
+add_frags(struct rte_ip_frag_tbl *tbl, uint32_t nb_dgrams, int last,
+		int burst, uint64_t tms, uint64_t *cycles)
+{
+	struct rte_mbuf *pkts[BURST_SIZE], *m;
+	struct rte_ipv4_hdr *ip;
+	uint32_t i, j, n, nb_out = 0, nb_reasm;
+	uint64_t start;
+
+	for (i = 0; i < nb_dgrams; i += n) {
+		n = RTE_MIN(BURST_SIZE, nb_dgrams - i);
+		if (rte_pktmbuf_alloc_bulk(pkt_pool, pkts, n) != 0) {
+			printf("Cannot allocate %u packets\n", n);
+			return -1;
+		}
+		for (j = 0; j < n; j++)
+			init_ipv4_frag(pkts[j], i + j, last);
+
+		start = rte_rdtsc_precise();
+		if (burst) {
+			nb_reasm = rte_ipv4_frag_reassemble_burst(tbl,
+					&death_row, pkts, n, tms);
+		} else {
+			nb_reasm = 0;
+			for (j = 0; j < n; j++) {
+				ip = rte_pktmbuf_mtod_offset(pkts[j],
+						struct rte_ipv4_hdr *,
+						pkts[j]->l2_len);
+				m = rte_ipv4_frag_reassemble_packet(tbl,
+						&death_row, pkts[j], tms, ip);
+				if (m != NULL)
+					pkts[nb_reasm++] = m;
+			}
+		}
+		*cycles += rte_rdtsc_precise() - start;
+
+		for (j = 0; j < nb_reasm; j++) {
+			if (pkts[j]->pkt_len != HDR_LEN + 2 * FRAG_LEN) {
+				printf("Bad reassembled packet length %u\n",
+						pkts[j]->pkt_len);
+				return -1;
+			}
+			rte_pktmbuf_free(pkts[j]);
+		}
+		nb_out += nb_reasm;
+		rte_ip_frag_free_death_row(&death_row, 0);
+	}
+
+	return nb_out;
+}
+
+static int
+test_reassembly_perf_dgrams(uint32_t nb_dgrams, int burst)
+{
+	struct rte_ip_frag_tbl *tbl;
+	uint64_t insert_cycles = 0, reasm_cycles = 0, expire_cycles = 0;
+	uint64_t start, tms, max_cycles;
+	int ret;
+
+	max_cycles = rte_get_tsc_hz();
+	tbl = rte_ip_frag_table_create(
+			RTE_MAX(nb_dgrams / (BUCKET_ENTRIES * 2), 1U),
+			BUCKET_ENTRIES, nb_dgrams, max_cycles, rte_socket_id());
+	if (tbl == NULL) {
+		printf("Cannot create table for %u datagrams\n", nb_dgrams);
+		return -1;
+	}
+	tms = rte_rdtsc();
+
+	/* the first fragments are stored, the last ones reassembled */
+	ret = add_frags(tbl, nb_dgrams, 0, burst, tms, &insert_cycles);
+	if (ret != 0 || tbl->use_entries != nb_dgrams) {
+		printf("%u datagrams stored, expected %u\n",
+				tbl->use_entries, nb_dgrams);
+		goto error;
+	}
+	ret = add_frags(tbl, nb_dgrams, 1, burst, tms, &reasm_cycles);
+	if (ret != (int)nb_dgrams || tbl->use_entries != 0) {
+		printf("%d datagrams reassembled, expected %u\n", ret,
+				nb_dgrams);
+		goto error;
+	}
+
+	/* fill the table again, and let all the entries time out */
+	ret = add_frags(tbl, nb_dgrams, 0, burst, tms, &insert_cycles);
+	if (ret != 0) {
+		printf("%d datagrams reassembled, expected 0\n", ret);
+		goto error;
+	}
+	tms += max_cycles + 1;
+	while (tbl->use_entries != 0) {
+		start = rte_rdtsc_precise();
+		rte_frag_table_del_expired_entries(tbl, &death_row, tms);
+		expire_cycles += rte_rdtsc_precise() - start;
+		if (death_row.cnt == 0) {
+			printf("%u entries not expired\n", tbl->use_entries);
+			goto error;
+		}
+		rte_ip_frag_free_death_row(&death_row, 0);
+	}
+
+	printf("%8u %8s %16"PRIu64" %16"PRIu64" %16"PRIu64"\n", nb_dgrams,
+			burst ? "burst" : "packet",
+			insert_cycles / (2 * nb_dgrams),
+			reasm_cycles / nb_dgrams,
+			expire_cycles / nb_dgrams);
+
+	rte_ip_frag_table_destroy(tbl);
+	return 0;
+
+error:
+	rte_ip_frag_free_death_row(&death_row, 0);
+	rte_ip_frag_table_destroy(tbl);
+	return -1;
+}
+
+static int
+test_reassembly_perf(void)
+{
+	unsigned int i;
+	int ret = 0;
+
+	pkt_pool = rte_pktmbuf_pool_create("REASSEMBLY_PERF_POOL", NB_MBUFS,
+			0, 0, RTE_PKTMBUF_HEADROOM + HDR_LEN + FRAG_LEN,
+			rte_socket_id());
+	if (pkt_pool == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+
+	printf("IPv4 reassembly, 2 fragments of %u bytes per datagram\n",
+			FRAG_LEN);
+	printf("%8s %8s %16s %16s %16s\n", "dgrams", "api",
+			"insert cyc/frag", "reasm cyc/frag",
+			"expire cyc/dgram");
+	for (i = 0; i < RTE_DIM(dgram_nums) * 2; i++) {
+		ret = test_reassembly_perf_dgrams(dgram_nums[i / 2], i % 2);
+		if (ret != 0)
+			break;
+	}
+
+	rte_mempool_free(pkt_pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(reassembly_perf_autotest, test_reassembly_perf);
@@ -268,8 +268,10 @@ test_reorder_drain(void)
 		ret = -1;
 		goto exit;
 	}
-	if (robufs[0] != NULL)
+	if (robufs[0] != NULL) {
 		rte_pktmbuf_free(robufs[0]);
+		robufs[0] = NULL;
+	}
 
 	/* Insert more packets
 	 * RB[] = {NULL, NULL, NULL, NULL}
@@ -303,8 +305,10 @@ test_reorder_drain(void)
 		goto exit;
 	}
 	for (i = 0; i < 3; i++) {
-		if (robufs[i] != NULL)
+		if (robufs[i] != NULL) {
 			rte_pktmbuf_free(robufs[i]);
+			robufs[i] = NULL;
+		}
 	}
 
 	/*
@@ -330,6 +334,441 @@ test_reorder_drain(void)
 	return ret;
 }
 
+static int
+test_reorder_insert_bulk(void)
+{
+	static const uint32_t seqns[] = {0, 3, 7, 1, 2, 6, 5, 4, 8, 30, 9};
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = RTE_DIM(seqns);
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	unsigned int i, cnt;
+	int ret = -1;
+
+	memset(robufs, 0, sizeof(robufs));
+	b = rte_reorder_create("test_insert_bulk", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	if (rte_pktmbuf_alloc_bulk(p, bufs, num_bufs) != 0) {
+		printf("%s:%d: Packet allocation failed\n", __func__, __LINE__);
+		rte_reorder_free(b);
+		return -1;
+	}
+	for (i = 0; i < num_bufs; i++)
+		bufs[i]->seqn = seqns[i];
+
+	/* A full window out of order, then seqn 8 moving it by one */
+	cnt = rte_reorder_insert_bulk(b, bufs, size + 1);
+	if (cnt != size + 1) {
+		printf("%s:%d: %u packets inserted\n", __func__, __LINE__, cnt);
+		goto exit;
+	}
+	for (i = 0; i < cnt; i++)
+		bufs[i] = NULL;
+
+	/* Stops at the out of range packet */
+	cnt = rte_reorder_insert_bulk(b, &bufs[size + 1], 2);
+	if (cnt != 0 || rte_errno != ERANGE) {
+		printf("%s:%d: out of range packet inserted\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+	cnt = rte_reorder_insert_bulk(b, &bufs[size + 2], 1);
+	if (cnt != 1) {
+		printf("%s:%d: packet not inserted\n", __func__, __LINE__);
+		goto exit;
+	}
+	bufs[size + 2] = NULL;
+
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	if (cnt != size + 2) {
+		printf("%s:%d: %u packets drained\n", __func__, __LINE__, cnt);
+		goto exit;
+	}
+	for (i = 0; i < cnt; i++) {
+		if (robufs[i]->seqn != i) {
+			printf("%s:%d: seqn %u drained at %u\n", __func__,
+					__LINE__, robufs[i]->seqn, i);
+			goto exit;
+		}
+	}
+
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
+static int
+reorder_drain_up_to_seqn(unsigned int flags)
+{
+	static const uint32_t seqns[] = {0, 1, 3, 5, 6, 2, 100};
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = RTE_DIM(seqns);
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	unsigned int i, cnt, nb_robufs = 0;
+	int ret = -1;
+
+	memset(robufs, 0, sizeof(robufs));
+	b = rte_reorder_create_with_flags("test_drain_up_to", rte_socket_id(),
+			size, flags);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	if (rte_pktmbuf_alloc_bulk(p, bufs, num_bufs) != 0) {
+		printf("%s:%d: Packet allocation failed\n", __func__, __LINE__);
+		rte_reorder_free(b);
+		return -1;
+	}
+	for (i = 0; i < num_bufs; i++)
+		bufs[i]->seqn = seqns[i];
+
+	/* OB[] = {0, 1, NULL, 3, NULL, 5, 6, NULL} */
+	if (rte_reorder_insert_bulk(b, bufs, 5) != 5) {
+		printf("%s:%d: packets not inserted\n", __func__, __LINE__);
+		goto exit;
+	}
+	for (i = 0; i < 5; i++)
+		bufs[i] = NULL;
+
+	/* Skips the gap at seqn 2 */
+	cnt = rte_reorder_drain_up_to_seqn(b, robufs, num_bufs, 4);
+	nb_robufs = cnt;
+	if (cnt != 3 || robufs[0]->seqn != 0 || robufs[1]->seqn != 1 ||
+			robufs[2]->seqn != 3) {
+		printf("%s:%d: %u packets drained\n", __func__, __LINE__, cnt);
+		goto exit;
+	}
+
+	/* seqn 2 is now late */
+	if (rte_reorder_insert(b, bufs[5]) != -1 || rte_errno != ERANGE) {
+		printf("%s:%d: late packet inserted\n", __func__, __LINE__);
+		goto exit;
+	}
+
+	cnt = rte_reorder_drain_up_to_seqn(b, &robufs[nb_robufs],
+			num_bufs - nb_robufs, 7);
+	nb_robufs += cnt;
+	if (cnt != 2 || robufs[3]->seqn != 5 || robufs[4]->seqn != 6) {
+		printf("%s:%d: %u packets drained\n", __func__, __LINE__, cnt);
+		goto exit;
+	}
+
+	/* An empty window jumps straight to the requested seqn */
+	cnt = rte_reorder_drain_up_to_seqn(b, robufs, 0, 100);
+	cnt += rte_reorder_drain_up_to_seqn(b, &robufs[nb_robufs],
+			num_bufs - nb_robufs, 100);
+	if (cnt != 0) {
+		printf("%s:%d: %u packets drained\n", __func__, __LINE__, cnt);
+		goto exit;
+	}
+	if (rte_reorder_insert(b, bufs[6]) != 0) {
+		printf("%s:%d: packet not inserted\n", __func__, __LINE__);
+		goto exit;
+	}
+	bufs[6] = NULL;
+	cnt = rte_reorder_drain(b, &robufs[nb_robufs], num_bufs - nb_robufs);
+	nb_robufs += cnt;
+	if (cnt != 1 || robufs[5]->seqn != 100) {
+		printf("%s:%d: %u packets drained\n", __func__, __LINE__, cnt);
+		goto exit;
+	}
+
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
+static int
+test_reorder_drain_up_to_seqn(void)
+{
+	if (reorder_drain_up_to_seqn(0) != 0)
+		return -1;
+	return reorder_drain_up_to_seqn(RTE_REORDER_F_MP_INSERT);
+}
+
+#define MP_PRODUCERS 8
+#define MP_MBUFS_PER_PRODUCER 2048
+#define MP_NUM_MBUFS (MP_PRODUCERS * MP_MBUFS_PER_PRODUCER)
+#define MP_REORDER_BUFFER_SIZE 1024
+
+struct mp_producer {
+	struct rte_reorder_buffer *b;
+	struct rte_mbuf **mbufs;
+	unsigned int next; /**< index of the next mbuf, by steps of MP_PRODUCERS */
+};
+
+static struct mp_producer mp_producers[MP_PRODUCERS];
+static unsigned int mp_nb_lcores;
+
+/* Insert one burst of this producer's mbufs, retrying later on ENOSPC */
+static void
+mp_producer_step(struct mp_producer *pr)
+{
+	struct rte_mbuf *burst[BURST];
+	unsigned int i, n;
+
+	for (n = 0, i = pr->next; n < BURST && i < MP_NUM_MBUFS;
+			i += MP_PRODUCERS)
+		burst[n++] = pr->mbufs[i];
+
+	pr->next += MP_PRODUCERS * rte_reorder_insert_bulk(pr->b, burst, n);
+}
+
+static int
+mp_producer_loop(void *arg)
+{
+	unsigned int idx = (uintptr_t)arg;
+	unsigned int i, done;
+
+	do {
+		done = 1;
+		for (i = idx; i < MP_PRODUCERS; i += mp_nb_lcores) {
+			if (mp_producers[i].next < MP_NUM_MBUFS) {
+				mp_producer_step(&mp_producers[i]);
+				done = 0;
+			}
+		}
+	} while (!done);
+
+	return 0;
+}
+
+/*
+ * MP_PRODUCERS producers insert interleaved sequence numbers while this lcore
+ * drains. Without worker lcores, the producers take turns with the drain on
+ * this lcore.
+ */
+static int
+test_reorder_mp_insert(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	struct rte_mbuf **mbufs, *robufs[BURST];
+	unsigned int i, lcore_id, cnt, drained = 0, misordered = 0;
+	uint64_t start, cycles;
+	int ret = -1;
+
+	mbufs = rte_malloc(NULL, MP_NUM_MBUFS * sizeof(*mbufs), 0);
+	TEST_ASSERT_NOT_NULL(mbufs, "Failed to allocate mbuf array");
+	if (rte_pktmbuf_alloc_bulk(p, mbufs, MP_NUM_MBUFS) != 0) {
+		printf("%s:%d: Packet allocation failed\n", __func__, __LINE__);
+		rte_free(mbufs);
+		return -1;
+	}
+	for (i = 0; i < MP_NUM_MBUFS; i++)
+		mbufs[i]->seqn = i;
+
+	b = rte_reorder_create_with_flags("test_mp_insert", rte_socket_id(),
+			MP_REORDER_BUFFER_SIZE, RTE_REORDER_F_MP_INSERT);
+	if (b == NULL) {
+		printf("%s:%d: Failed to create reorder buffer\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+
+	/* seqn 0 is inserted first so that it is the start of the window */
+	if (rte_reorder_insert(b, mbufs[0]) != 0) {
+		printf("%s:%d: packet not inserted\n", __func__, __LINE__);
+		goto exit;
+	}
+	for (i = 0; i < MP_PRODUCERS; i++) {
+		mp_producers[i].b = b;
+		mp_producers[i].mbufs = mbufs;
+		mp_producers[i].next = i == 0 ? MP_PRODUCERS : i;
+	}
+
+	mp_nb_lcores = RTE_MIN(rte_lcore_count() - 1,
+			(unsigned int)MP_PRODUCERS);
+	start = rte_rdtsc();
+	i = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (i == mp_nb_lcores)
+			break;
+		rte_eal_remote_launch(mp_producer_loop,
+				(void *)(uintptr_t)i++, lcore_id);
+	}
+
+	while (drained < MP_NUM_MBUFS) {
+		if (mp_nb_lcores == 0) {
+			for (i = 0; i < MP_PRODUCERS; i++)
+				if (mp_producers[i].next < MP_NUM_MBUFS)
+					mp_producer_step(&mp_producers[i]);
+		}
+		cnt = rte_reorder_drain(b, robufs, BURST);
+		for (i = 0; i < cnt; i++) {
+			if (robufs[i]->seqn != drained + i)
+				misordered++;
+		}
+		drained += cnt;
+	}
+	cycles = rte_rdtsc() - start;
+	rte_eal_mp_wait_lcore();
+
+	if (misordered != 0) {
+		printf("%s:%d: %u packets drained out of order\n",
+				__func__, __LINE__, misordered);
+		goto exit;
+	}
+	printf("%u producers on %u lcores: %"PRIu64" cycles per packet\n",
+			MP_PRODUCERS, mp_nb_lcores == 0 ? 1 : mp_nb_lcores,
+			cycles / MP_NUM_MBUFS);
+
+	ret = 0;
+exit:
+	/* All mbufs have been drained, none is left in b */
+	rte_reorder_free(b);
+	for (i = 0; i < MP_NUM_MBUFS; i++)
+		rte_pktmbuf_free(mbufs[i]);
+	rte_free(mbufs);
+	return ret;
+}
+
+static int
+test_reorder_ready_full(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 4;
+	const unsigned int num_bufs = 5;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	int ret = 0;
+	unsigned int i, cnt;
+
+	b = rte_reorder_create("test_ready_full", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+		bufs[i]->seqn = i;
+		robufs[i] = NULL;
+	}
+
+	/* Fill the order buffer:
+	 * RB[] = {NULL, NULL, NULL, NULL}
+	 * OB[] = {0, 1, 2, 3}
+	 */
+	for (i = 0; i < size; i++) {
+		rte_reorder_insert(b, bufs[i]);
+		bufs[i] = NULL;
+	}
+
+	/* The ready buffer has room for size - 1 packets only:
+	 * RB[] = {0, 1, 2, NULL}
+	 * OB[] = {NULL, NULL, NULL, 3} then {3, 4, NULL, NULL}
+	 */
+	if (rte_reorder_insert(b, bufs[size]) != 0) {
+		printf("%s:%d: packet %u not inserted\n", __func__, __LINE__,
+				size);
+		ret = -1;
+		goto exit;
+	}
+	bufs[size] = NULL;
+
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	if (cnt != num_bufs) {
+		printf("%s:%d:%d: number of expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+	for (i = 0; i < cnt; i++) {
+		if (robufs[i]->seqn != i) {
+			printf("%s:%d: seqn %u drained at %u\n", __func__,
+					__LINE__, robufs[i]->seqn, i);
+			ret = -1;
+			goto exit;
+		}
+	}
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
+static int
+test_reorder_free_drained(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 4;
+	const unsigned int num_bufs = 5;
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[num_bufs];
+	unsigned int i, cnt, avail;
+	int ret = 0;
+
+	b = rte_reorder_create("test_free_drained", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+		bufs[i]->seqn = i;
+		robufs[i] = NULL;
+	}
+
+	/* Overflow the order buffer so that packets go through the ready
+	 * buffer, then drain all of them:
+	 * RB[] = {0, 1, 2, NULL}
+	 * OB[] = {3, 4, NULL, NULL}
+	 */
+	for (i = 0; i < num_bufs; i++) {
+		rte_reorder_insert(b, bufs[i]);
+		bufs[i] = NULL;
+	}
+	cnt = rte_reorder_drain(b, robufs, num_bufs);
+	if (cnt != num_bufs) {
+		printf("%s:%d:%d: number of expected packets not drained\n",
+				__func__, __LINE__, cnt);
+		ret = -1;
+		goto exit;
+	}
+
+	/* The drained packets belong to the application now */
+	avail = rte_mempool_avail_count(p);
+	rte_reorder_free(b);
+	b = NULL;
+	if (rte_mempool_avail_count(p) != avail) {
+		printf("%s:%d: drained packets freed with the reorder buffer\n",
+				__func__, __LINE__);
+		ret = -1;
+	}
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
 static int
 test_setup(void)
 {
@@ -380,6 +819,11 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_ready_full),
+		TEST_CASE(test_reorder_free_drained),
+		TEST_CASE(test_reorder_insert_bulk),
+		TEST_CASE(test_reorder_drain_up_to_seqn),
+		TEST_CASE(test_reorder_mp_insert),
 		TEST_CASES_END()
 	}
 };
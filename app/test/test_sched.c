@@ -22,18 +22,6 @@
 #define TC              2
 #define QUEUE           0
 
-static struct rte_sched_subport_params subport_param[] = {
-	{
-		.tb_rate = 1250000000,
-		.tb_size = 1000000,
-
-		.tc_rate = {1250000000, 1250000000, 1250000000, 1250000000,
-			1250000000, 1250000000, 1250000000, 1250000000, 1250000000,
-			1250000000, 1250000000, 1250000000, 1250000000},
-		.tc_period = 10,
-	},
-};
-
 static struct rte_sched_pipe_params pipe_profile[] = {
 	{ /* Profile #0 */
 		.tb_rate = 305175,
@@ -48,17 +36,30 @@ static struct rte_sched_pipe_params pipe_profile[] = {
 	},
 };
 
+static struct rte_sched_subport_params subport_param[] = {
+	{
+		.tb_rate = 1250000000,
+		.tb_size = 1000000,
+
+		.tc_rate = {1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000, 1250000000,
+			1250000000, 1250000000, 1250000000, 1250000000},
+		.tc_period = 10,
+		.n_pipes_per_subport_enabled = 1024,
+		.qsize = {32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32},
+		.pipe_profiles = pipe_profile,
+		.n_pipe_profiles = 1,
+		.n_max_pipe_profiles = 2,
+	},
+};
+
 static struct rte_sched_port_params port_param = {
 	.socket = 0, /* computed */
 	.rate = 0, /* computed */
 	.mtu = 1522,
 	.frame_overhead = RTE_SCHED_FRAME_OVERHEAD_DEFAULT,
 	.n_subports_per_port = 1,
-	.n_pipes_per_subport = 1024,
-	.qsize = {32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32},
-	.pipe_profiles = pipe_profile,
-	.n_pipe_profiles = 1,
-	.n_max_pipe_profiles = 1,
+	.n_pipes_per_subport = 2048,
 };
 
 #define NB_MBUF          32
@@ -113,6 +114,167 @@ prepare_pkt(struct rte_sched_port *port, struct rte_mbuf *mbuf)
 }
 
 
+#define SHAPER_PKTS      10
+
+/*
+ * Two shards of the same physical port, each owning one subport, share
+ * a port shaper that allows a bit more than SHAPER_PKTS packets.
+ */
+static int
+test_sched_shaper(struct rte_mempool *mp)
+{
+	struct rte_sched_shaper_params shaper_param = {
+		.socket = SOCKET,
+		.rate = 1,
+		.tb_size = (SHAPER_PKTS + 2) *
+			(60 + RTE_SCHED_FRAME_OVERHEAD_DEFAULT),
+	};
+	struct rte_sched_port_params shard_param = port_param;
+	struct rte_sched_port *shard[2];
+	struct rte_sched_shaper *shaper;
+	struct rte_mbuf *in_mbufs[SHAPER_PKTS];
+	struct rte_mbuf *out_mbufs[SHAPER_PKTS];
+	uint32_t subport;
+	int i, err;
+
+	shaper = rte_sched_shaper_create(&shaper_param);
+	TEST_ASSERT_NOT_NULL(shaper, "Error creating port shaper\n");
+
+	shard_param.n_subports_per_port = 2;
+
+	for (subport = 0; subport < 2; subport++) {
+		shard_param.name = subport ? "shard_1" : "shard_0";
+		shard[subport] = rte_sched_port_config(&shard_param);
+		TEST_ASSERT_NOT_NULL(shard[subport], "Error config shard\n");
+
+		err = rte_sched_subport_config(shard[subport], subport,
+			subport_param);
+		TEST_ASSERT_SUCCESS(err, "Error config shard subport, err=%d\n",
+			err);
+		err = rte_sched_pipe_config(shard[subport], subport, PIPE, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config shard pipe, err=%d\n",
+			err);
+		err = rte_sched_port_shaper_attach(shard[subport], shaper);
+		TEST_ASSERT_SUCCESS(err, "Error attaching shaper, err=%d\n",
+			err);
+
+		for (i = 0; i < SHAPER_PKTS; i++) {
+			in_mbufs[i] = rte_pktmbuf_alloc(mp);
+			TEST_ASSERT_NOT_NULL(in_mbufs[i],
+				"Packet allocation failed\n");
+			prepare_pkt(shard[subport], in_mbufs[i]);
+			rte_sched_port_pkt_write(shard[subport], in_mbufs[i],
+				subport, PIPE, TC, QUEUE, RTE_COLOR_YELLOW);
+		}
+
+		err = rte_sched_port_enqueue(shard[subport], in_mbufs,
+			SHAPER_PKTS);
+		TEST_ASSERT_EQUAL(err, SHAPER_PKTS, "Wrong enqueue, err=%d\n",
+			err);
+	}
+
+	/* The first shard gets all its packets out */
+	err = rte_sched_port_dequeue(shard[0], out_mbufs, SHAPER_PKTS);
+	TEST_ASSERT_EQUAL(err, SHAPER_PKTS, "Wrong dequeue, err=%d\n", err);
+	for (i = 0; i < err; i++)
+		rte_pktmbuf_free(out_mbufs[i]);
+
+	/* The second one only gets the remaining port credits */
+	err = rte_sched_port_dequeue(shard[1], out_mbufs, SHAPER_PKTS);
+	TEST_ASSERT_EQUAL(err, 2, "Wrong shaped dequeue, err=%d\n", err);
+	for (i = 0; i < err; i++)
+		rte_pktmbuf_free(out_mbufs[i]);
+
+	/* Detached from the shaper, the shard is no longer limited */
+	err = rte_sched_port_shaper_attach(shard[1], NULL);
+	TEST_ASSERT_SUCCESS(err, "Error detaching shaper, err=%d\n", err);
+	err = rte_sched_port_dequeue(shard[1], out_mbufs, SHAPER_PKTS);
+	TEST_ASSERT_EQUAL(err, SHAPER_PKTS - 2, "Wrong dequeue, err=%d\n", err);
+	for (i = 0; i < err; i++)
+		rte_pktmbuf_free(out_mbufs[i]);
+
+	rte_sched_port_free(shard[0]);
+	rte_sched_port_free(shard[1]);
+	rte_sched_shaper_free(shaper);
+
+	return 0;
+}
+
+#define INVALID_PKTS     7
+
+/*
+ * Packets sent to a subport that is not configured on the port, or to a
+ * pipe that is not enabled in its subport, have no queue: enqueue drops
+ * them and keeps the others, whether the burst runs through the pipeline
+ * or not.
+ */
+static int
+test_sched_invalid_queue(struct rte_mempool *mp)
+{
+	static const uint32_t pkt_path[INVALID_PKTS][2] = {
+		{ 0, PIPE }, /* valid */
+		{ 0, 1024 }, /* pipe not enabled */
+		{ 1, PIPE }, /* subport not configured */
+		{ 0, PIPE }, /* valid */
+		{ 3, PIPE }, /* subport beyond the port */
+		{ 0, 2047 }, /* pipe not enabled */
+		{ 0, PIPE }, /* valid */
+	};
+	struct rte_sched_port_params invalid_param = port_param;
+	struct rte_mbuf *in_mbufs[INVALID_PKTS];
+	struct rte_mbuf *out_mbufs[INVALID_PKTS];
+	struct rte_sched_port *port;
+	unsigned int avail;
+	uint32_t n_pkts;
+	int i, err;
+
+	invalid_param.name = "invalid_queue";
+	invalid_param.n_subports_per_port = 2;
+
+	port = rte_sched_port_config(&invalid_param);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	err = rte_sched_subport_config(port, 0, subport_param);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+	err = rte_sched_pipe_config(port, 0, PIPE, 0);
+	TEST_ASSERT_SUCCESS(err, "Error config sched pipe, err=%d\n", err);
+
+	avail = rte_mempool_avail_count(mp);
+
+	/* Full burst through the enqueue pipeline, then a short one */
+	for (n_pkts = INVALID_PKTS; n_pkts > 0; n_pkts /= 2) {
+		int n_valid = 0;
+
+		for (i = 0; i < (int)n_pkts; i++) {
+			in_mbufs[i] = rte_pktmbuf_alloc(mp);
+			TEST_ASSERT_NOT_NULL(in_mbufs[i],
+				"Packet allocation failed\n");
+			prepare_pkt(port, in_mbufs[i]);
+			rte_sched_port_pkt_write(port, in_mbufs[i],
+				pkt_path[i][0], pkt_path[i][1], TC, QUEUE,
+				RTE_COLOR_YELLOW);
+			if (pkt_path[i][0] == 0 && pkt_path[i][1] == PIPE)
+				n_valid++;
+		}
+
+		err = rte_sched_port_enqueue(port, in_mbufs, n_pkts);
+		TEST_ASSERT_EQUAL(err, n_valid, "Wrong enqueue, err=%d\n", err);
+
+		err = rte_sched_port_dequeue(port, out_mbufs, n_pkts);
+		TEST_ASSERT_EQUAL(err, n_valid, "Wrong dequeue, err=%d\n", err);
+		for (i = 0; i < err; i++)
+			rte_pktmbuf_free(out_mbufs[i]);
+
+		/* The dropped packets went back to the pool */
+		TEST_ASSERT_EQUAL(rte_mempool_avail_count(mp), avail,
+			"Dropped packets leaked\n");
+	}
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -121,7 +283,8 @@ test_sched(void)
 {
 	struct rte_mempool *mp = NULL;
 	struct rte_sched_port *port = NULL;
-	uint32_t pipe;
+	struct rte_sched_pipe_params pipe_profile_2;
+	uint32_t pipe, pipe_profile_id;
 	struct rte_mbuf *in_mbufs[10];
 	struct rte_mbuf *out_mbufs[10];
 	int i;
@@ -140,11 +303,25 @@ test_sched(void)
 	err = rte_sched_subport_config(port, SUBPORT, subport_param);
 	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
 
-	for (pipe = 0; pipe < port_param.n_pipes_per_subport; pipe ++) {
+	for (pipe = 0; pipe < subport_param[0].n_pipes_per_subport_enabled; pipe++) {
 		err = rte_sched_pipe_config(port, SUBPORT, pipe, 0);
 		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n", pipe, err);
 	}
 
+	/* Only the enabled pipes of the subport are allocated */
+	err = rte_sched_pipe_config(port, SUBPORT, pipe, 0);
+	TEST_ASSERT_FAIL(err, "Pipe %u beyond the enabled pipes configured\n", pipe);
+
+	/* Pipe profiles are added to the subport pipe profile table */
+	pipe_profile_2 = pipe_profile[0];
+	pipe_profile_2.tb_rate *= 2;
+	err = rte_sched_subport_pipe_profile_add(port, SUBPORT, &pipe_profile_2,
+		&pipe_profile_id);
+	TEST_ASSERT_SUCCESS(err, "Error adding pipe profile, err=%d\n", err);
+	TEST_ASSERT_EQUAL(pipe_profile_id, 1, "Wrong pipe profile id\n");
+	err = rte_sched_pipe_config(port, SUBPORT, PIPE, pipe_profile_id);
+	TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n", PIPE, err);
+
 	for (i = 0; i < 10; i++) {
 		in_mbufs[i] = rte_pktmbuf_alloc(mp);
 		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
@@ -189,9 +366,16 @@ test_sched(void)
 	TEST_ASSERT_EQUAL(queue_stats.n_pkts, 10, "Wrong queue stats\n");
 #endif
 
+	for (i = 0; i < 10; i++)
+		rte_pktmbuf_free(out_mbufs[i]);
+
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_invalid_queue(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_shaper(mp);
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
@@ -0,0 +1,438 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eth_vhost.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_mempool.h>
+#include <rte_vhost_async.h>
+
+#include "pmd_perf_port.h"
+#include "test.h"
+
+/*
+ * Check the asynchronous enqueue API of the vhost library with a fake copy
+ * engine, on a virtio-user port connected to a vhost port in the same
+ * process. The engine copies the packets when they are completed, and
+ * only accepts and completes the number of packets the test allows. The
+ * packets completed by the engine must reach the virtio-user port in
+ * submission order, including the ones given back to the caller by a
+ * partial submission and sent again. When the virtio-user port is closed
+ * with copies in flight, vhost must wait for their completion before
+ * stopping the ring and unmapping the guest memory.
+ */
+
+#define VHOST_NAME "net_vhost_async"
+#define VIRTIO_USER_NAME "net_virtio_user_async"
+#define RING_SIZE 256
+#define NB_MBUFS (4 * RING_SIZE)
+#define NB_PKTS 8
+#define PKT_LEN PMD_PERF_PKT_LEN
+#define LINK_WAIT_MS 5000
+/* delay of the completions of the copies in flight at disconnection */
+#define DISCONNECT_DELAY_MS 200
+/* the vhost virtqueue of the receive queue of the guest */
+#define ENQUEUE_QUEUE 0
+#define ENGINE_MAX_SEGS 4
+/* memory regions virtio-user can share with vhost, one per memory file */
+#define VIRTIO_USER_MAX_REGIONS 8
+
+/* Copies of a packet accepted by the fake engine */
+struct engine_pkt {
+	struct rte_vhost_async_seg segs[ENGINE_MAX_SEGS];
+	uint16_t nr_segs;
+};
+
+static struct rte_mempool *pkt_pool;
+static char socket_path[PATH_MAX];
+
+/* Packets accepted by the fake engine, copied at completion */
+static struct engine_pkt engine_pkts[RING_SIZE];
+static uint16_t engine_head;
+/* Packets the fake engine accepts at the next submission */
+static uint16_t engine_accept;
+/* Packets accepted by the fake engine and not reported completed */
+static uint16_t engine_copied;
+/* Packets the fake engine may report completed */
+static uint16_t engine_done;
+/* TSC cycle before which the fake engine completes nothing */
+static uint64_t engine_deadline;
+
+static int32_t
+engine_transfer_data(int vid __rte_unused, uint16_t queue_id __rte_unused,
+		const struct rte_vhost_async_desc *descs, uint16_t count)
+{
+	struct engine_pkt *pkt;
+	uint16_t i;
+
+	count = RTE_MIN(count, engine_accept);
+	count = RTE_MIN(count, RING_SIZE - engine_copied);
+	for (i = 0; i < count; i++) {
+		if (descs[i].nr_segs > ENGINE_MAX_SEGS)
+			break;
+		pkt = &engine_pkts[(engine_head + engine_copied + i) %
+				RING_SIZE];
+		memcpy(pkt->segs, descs[i].segs,
+				descs[i].nr_segs * sizeof(pkt->segs[0]));
+		pkt->nr_segs = descs[i].nr_segs;
+	}
+	engine_copied += i;
+
+	return i;
+}
+
+static int32_t
+engine_check_completed_copies(int vid __rte_unused,
+		uint16_t queue_id __rte_unused, uint16_t max_packets)
+{
+	struct engine_pkt *pkt;
+	uint16_t n, i, j;
+
+	if (rte_rdtsc() < engine_deadline)
+		return 0;
+
+	n = RTE_MIN(max_packets, RTE_MIN(engine_copied, engine_done));
+	for (i = 0; i < n; i++) {
+		pkt = &engine_pkts[engine_head];
+		for (j = 0; j < pkt->nr_segs; j++)
+			memcpy(pkt->segs[j].dst, pkt->segs[j].src,
+					pkt->segs[j].len);
+		engine_head = (engine_head + 1) % RING_SIZE;
+	}
+	engine_copied -= n;
+	engine_done -= n;
+
+	return n;
+}
+
+static struct rte_vhost_async_channel_ops engine_ops = {
+	.transfer_data = engine_transfer_data,
+	.check_completed_copies = engine_check_completed_copies,
+};
+
+/* Distinct files backing the EAL memory, up to VIRTIO_USER_MAX_REGIONS */
+struct memory_files {
+	int fds[VIRTIO_USER_MAX_REGIONS];
+	unsigned int nb;
+};
+
+static int
+add_memory_file(const struct rte_memseg_list *msl __rte_unused,
+		const struct rte_memseg *ms, void *arg)
+{
+	struct memory_files *files = arg;
+	unsigned int i;
+	int fd;
+
+	fd = rte_memseg_get_fd_thread_unsafe(ms);
+	if (fd < 0)
+		return 1;
+	for (i = 0; i < files->nb; i++)
+		if (files->fds[i] == fd)
+			return 0;
+	if (files->nb == VIRTIO_USER_MAX_REGIONS)
+		return 1;
+	files->fds[files->nb++] = fd;
+
+	return 0;
+}
+
+/*
+ * virtio-user shares the memory with vhost file by file: with a file per
+ * hugepage, there are usually too many of them, unless the EAL is run
+ * with --single-file-segments.
+ */
+static int
+memory_shareable(void)
+{
+	struct memory_files files = { .nb = 0 };
+
+	return rte_memseg_walk(add_memory_file, &files) == 0;
+}
+
+static int
+wait_link_up(uint16_t port)
+{
+	struct rte_eth_link link;
+	int ms;
+
+	for (ms = 0; ms < LINK_WAIT_MS; ms += 10) {
+		memset(&link, 0, sizeof(link));
+		rte_eth_link_get_nowait(port, &link);
+		if (link.link_status == ETH_LINK_UP)
+			return 0;
+		rte_delay_ms(10);
+	}
+
+	return -1;
+}
+
+/* Receive nb packets on the virtio-user port, numbered from first */
+static int
+check_received(uint16_t virtio_port, uint16_t first, uint16_t nb)
+{
+	struct rte_mbuf *pkts[PMD_PERF_BURST_SIZE];
+	uint16_t nb_rx, i;
+	uint8_t *data;
+	int ret = 0;
+
+	nb_rx = rte_eth_rx_burst(virtio_port, 0, pkts, PMD_PERF_BURST_SIZE);
+	if (nb_rx != nb) {
+		printf("Received %u packets instead of %u\n", nb_rx, nb);
+		ret = -1;
+	}
+	for (i = 0; i < nb_rx; i++) {
+		data = rte_pktmbuf_mtod(pkts[i], uint8_t *);
+		if (rte_pktmbuf_pkt_len(pkts[i]) != PKT_LEN ||
+				data[sizeof(struct rte_ether_hdr)] !=
+				(uint8_t)(first + i)) {
+			printf("Packet %u received out of order\n", first + i);
+			ret = -1;
+		}
+	}
+	pmd_perf_free_burst(pkts, nb_rx);
+
+	return ret;
+}
+
+static int
+async_enqueue(int vid, uint16_t virtio_port)
+{
+	struct rte_mbuf *pkts[NB_PKTS], *done[PMD_PERF_BURST_SIZE];
+	uint16_t nb_sent = 0, nb_done, i;
+	uint8_t *data;
+	int ret = -1;
+
+	if (pmd_perf_fill_burst(pkt_pool, pkts, NB_PKTS, PKT_LEN,
+			PMD_PERF_ETHER_TYPE) != 0) {
+		printf("Cannot allocate packets\n");
+		return -1;
+	}
+	for (i = 0; i < NB_PKTS; i++) {
+		data = rte_pktmbuf_mtod(pkts[i], uint8_t *);
+		data[sizeof(struct rte_ether_hdr)] = i;
+	}
+	engine_copied = 0;
+	engine_done = 0;
+
+	if (rte_vhost_async_channel_register(vid, ENQUEUE_QUEUE, 0,
+			&engine_ops) != 0) {
+		printf("Cannot register the copy engine\n");
+		goto out;
+	}
+
+	/* the buffers of the packets not accepted are given back */
+	engine_accept = NB_PKTS / 2;
+	nb_sent = rte_vhost_submit_enqueue_burst(vid, ENQUEUE_QUEUE, pkts,
+			NB_PKTS);
+	if (nb_sent != NB_PKTS / 2 ||
+			rte_vhost_async_get_inflight(vid, ENQUEUE_QUEUE) !=
+			NB_PKTS / 2) {
+		printf("Partial submission: %u packets submitted\n", nb_sent);
+		goto unregister;
+	}
+
+	engine_accept = UINT16_MAX;
+	nb_sent += rte_vhost_submit_enqueue_burst(vid, ENQUEUE_QUEUE,
+			&pkts[nb_sent], NB_PKTS - nb_sent);
+	if (nb_sent != NB_PKTS ||
+			rte_vhost_async_get_inflight(vid, ENQUEUE_QUEUE) !=
+			NB_PKTS) {
+		printf("Submission: %u packets submitted\n", nb_sent);
+		goto unregister;
+	}
+
+	if (rte_vhost_async_channel_unregister(vid, ENQUEUE_QUEUE) == 0) {
+		printf("Copy engine unregistered with packets in flight\n");
+		goto out;
+	}
+
+	/* nothing is returned to the guest before the completion */
+	if (rte_vhost_poll_enqueue_completed(vid, ENQUEUE_QUEUE, done,
+			PMD_PERF_BURST_SIZE) != 0 ||
+			check_received(virtio_port, 0, 0) != 0)
+		goto unregister;
+
+	engine_done = 3;
+	nb_done = rte_vhost_poll_enqueue_completed(vid, ENQUEUE_QUEUE, done,
+			PMD_PERF_BURST_SIZE);
+	for (i = 0; i < nb_done; i++)
+		if (done[i] != pkts[i])
+			break;
+	pmd_perf_free_burst(done, nb_done);
+	if (nb_done != 3 || i != nb_done ||
+			rte_vhost_async_get_inflight(vid, ENQUEUE_QUEUE) !=
+			NB_PKTS - 3) {
+		printf("Partial completion: %u packets completed\n", nb_done);
+		goto unregister;
+	}
+	if (check_received(virtio_port, 0, 3) != 0)
+		goto unregister;
+
+	engine_done = UINT16_MAX;
+	nb_done = rte_vhost_poll_enqueue_completed(vid, ENQUEUE_QUEUE, done,
+			PMD_PERF_BURST_SIZE);
+	for (i = 0; i < nb_done; i++)
+		if (done[i] != pkts[3 + i])
+			break;
+	pmd_perf_free_burst(done, nb_done);
+	if (nb_done != NB_PKTS - 3 || i != nb_done ||
+			rte_vhost_async_get_inflight(vid, ENQUEUE_QUEUE) != 0) {
+		printf("Completion: %u packets completed\n", nb_done);
+		goto unregister;
+	}
+	if (check_received(virtio_port, 3, NB_PKTS - 3) != 0)
+		goto unregister;
+
+	ret = 0;
+
+unregister:
+	/* complete the packets left in flight so that they can be freed */
+	engine_done = UINT16_MAX;
+	while (rte_vhost_async_get_inflight(vid, ENQUEUE_QUEUE) > 0) {
+		nb_done = rte_vhost_poll_enqueue_completed(vid, ENQUEUE_QUEUE,
+				done, PMD_PERF_BURST_SIZE);
+		pmd_perf_free_burst(done, nb_done);
+	}
+	if (rte_vhost_async_channel_unregister(vid, ENQUEUE_QUEUE) != 0) {
+		printf("Cannot unregister the copy engine\n");
+		ret = -1;
+	}
+out:
+	pmd_perf_free_burst(&pkts[nb_sent], NB_PKTS - nb_sent);
+	return ret;
+}
+
+/* Close the virtio-user port while the copies of packets are in flight */
+static int
+async_disconnect(int vid, uint16_t virtio_port)
+{
+	struct rte_mbuf *pkts[NB_PKTS];
+	uint16_t nb_sent, i;
+	int ret = 0;
+
+	if (pmd_perf_fill_burst(pkt_pool, pkts, NB_PKTS, PKT_LEN,
+			PMD_PERF_ETHER_TYPE) != 0) {
+		printf("Cannot allocate packets\n");
+		pmd_perf_port_destroy(virtio_port);
+		return -1;
+	}
+	/* keep the packets to check that vhost frees them */
+	for (i = 0; i < NB_PKTS; i++)
+		rte_mbuf_refcnt_update(pkts[i], 1);
+	engine_copied = 0;
+	engine_done = UINT16_MAX;
+	engine_accept = UINT16_MAX;
+
+	if (rte_vhost_async_channel_register(vid, ENQUEUE_QUEUE, 0,
+			&engine_ops) != 0) {
+		printf("Cannot register the copy engine\n");
+		pmd_perf_port_destroy(virtio_port);
+		for (i = 0; i < NB_PKTS; i++)
+			rte_mbuf_refcnt_update(pkts[i], -1);
+		pmd_perf_free_burst(pkts, NB_PKTS);
+		return -1;
+	}
+
+	engine_deadline = rte_rdtsc() +
+		rte_get_tsc_hz() * DISCONNECT_DELAY_MS / 1000;
+	nb_sent = rte_vhost_submit_enqueue_burst(vid, ENQUEUE_QUEUE, pkts,
+			NB_PKTS);
+	if (nb_sent != NB_PKTS) {
+		printf("Submission: %u packets submitted\n", nb_sent);
+		ret = -1;
+	}
+
+	/* the ring is stopped and the memory unmapped after the copies */
+	pmd_perf_port_destroy(virtio_port);
+	engine_deadline = 0;
+
+	if (engine_copied != 0) {
+		printf("%u copies not completed at disconnection\n",
+			engine_copied);
+		ret = -1;
+	}
+	for (i = nb_sent; i < NB_PKTS; i++)
+		rte_mbuf_refcnt_update(pkts[i], -1);
+	for (i = 0; i < NB_PKTS; i++) {
+		/* the packets still owned by vhost are leaked */
+		if (rte_mbuf_refcnt_read(pkts[i]) != 1) {
+			printf("Packet %u in flight not freed\n", i);
+			ret = -1;
+			continue;
+		}
+		rte_pktmbuf_free(pkts[i]);
+	}
+
+	return ret;
+}
+
+static int
+test_vhost_async(void)
+{
+	uint16_t vhost_port, virtio_port;
+	char args[PATH_MAX + 128];
+	int vid, ret;
+
+	if (!memory_shareable()) {
+		printf("Too many memory files for virtio-user, use --single-file-segments\n");
+		return TEST_SKIPPED;
+	}
+
+	pkt_pool = pmd_perf_pool_create("VHOST_ASYNC_POOL", NB_MBUFS,
+			RTE_MBUF_DEFAULT_BUF_SIZE);
+	if (pkt_pool == NULL)
+		return -1;
+	snprintf(socket_path, sizeof(socket_path), "/tmp/vhost_async_%d.sock",
+			getpid());
+	unlink(socket_path);
+
+	snprintf(args, sizeof(args), "iface=%s,queues=1", socket_path);
+	if (pmd_perf_port_create(VHOST_NAME, args, NULL, RING_SIZE, pkt_pool,
+			&vhost_port) != 0) {
+		printf("Cannot create %s\n", VHOST_NAME);
+		ret = TEST_SKIPPED;
+		goto free_pool;
+	}
+
+	snprintf(args, sizeof(args), "path=%s,queues=1,packed_vq=0",
+			socket_path);
+	if (pmd_perf_port_create(VIRTIO_USER_NAME, args, NULL, RING_SIZE,
+			pkt_pool, &virtio_port) != 0) {
+		printf("Cannot create %s\n", VIRTIO_USER_NAME);
+		ret = TEST_SKIPPED;
+		goto destroy_vhost;
+	}
+
+	if (wait_link_up(vhost_port) != 0 ||
+			(vid = rte_eth_vhost_get_vid_from_port_id(vhost_port)) <
+			0) {
+		printf("vhost-user connection not established\n");
+		ret = -1;
+	} else {
+		ret = async_enqueue(vid, virtio_port);
+	}
+
+	if (ret == 0)
+		ret = async_disconnect(vid, virtio_port);
+	else
+		pmd_perf_port_destroy(virtio_port);
+destroy_vhost:
+	pmd_perf_port_destroy(vhost_port);
+	unlink(socket_path);
+free_pool:
+	rte_mempool_free(pkt_pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(vhost_async_autotest, test_vhost_async);
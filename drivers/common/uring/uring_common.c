@@ -0,0 +1,219 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+/**
+ * @file
+ * io_uring setup and submission shared by the PMDs doing batched I/O.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+
+#include <uring_autoconf.h>
+#include <uring_common.h>
+
+#ifdef HAVE_IO_URING
+
+#include <linux/io_uring.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+
+struct uring {
+	int fd;                         /* io_uring file descriptor */
+	unsigned int nb_prep;           /* prepared, not submitted entries */
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_array;
+	unsigned int sq_mask;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;
+	size_t cq_ring_size;
+	size_t sqes_size;
+};
+
+struct uring *
+uring_create(unsigned int entries)
+{
+	struct io_uring_params params;
+	struct uring *ur;
+	int err;
+
+	ur = rte_zmalloc(NULL, sizeof(*ur), 0);
+	if (ur == NULL) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	ur->sq_ring = MAP_FAILED;
+	ur->cq_ring = MAP_FAILED;
+	ur->sqes = MAP_FAILED;
+
+	memset(&params, 0, sizeof(params));
+	ur->fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (ur->fd < 0)
+		goto error;
+
+	ur->sq_ring_size = params.sq_off.array +
+		params.sq_entries * sizeof(unsigned int);
+	ur->sq_ring = mmap(NULL, ur->sq_ring_size, PROT_READ | PROT_WRITE,
+			   MAP_SHARED | MAP_POPULATE, ur->fd,
+			   IORING_OFF_SQ_RING);
+	if (ur->sq_ring == MAP_FAILED)
+		goto error;
+	ur->cq_ring_size = params.cq_off.cqes +
+		params.cq_entries * sizeof(struct io_uring_cqe);
+	ur->cq_ring = mmap(NULL, ur->cq_ring_size, PROT_READ | PROT_WRITE,
+			   MAP_SHARED | MAP_POPULATE, ur->fd,
+			   IORING_OFF_CQ_RING);
+	if (ur->cq_ring == MAP_FAILED)
+		goto error;
+	ur->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ur->sqes = mmap(NULL, ur->sqes_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ur->fd, IORING_OFF_SQES);
+	if (ur->sqes == MAP_FAILED)
+		goto error;
+
+	ur->sq_head = RTE_PTR_ADD(ur->sq_ring, params.sq_off.head);
+	ur->sq_tail = RTE_PTR_ADD(ur->sq_ring, params.sq_off.tail);
+	ur->sq_array = RTE_PTR_ADD(ur->sq_ring, params.sq_off.array);
+	ur->sq_mask = *(unsigned int *)RTE_PTR_ADD(ur->sq_ring,
+						   params.sq_off.ring_mask);
+	ur->cq_head = RTE_PTR_ADD(ur->cq_ring, params.cq_off.head);
+	ur->cq_tail = RTE_PTR_ADD(ur->cq_ring, params.cq_off.tail);
+	ur->cqes = RTE_PTR_ADD(ur->cq_ring, params.cq_off.cqes);
+	ur->cq_mask = *(unsigned int *)RTE_PTR_ADD(ur->cq_ring,
+						   params.cq_off.ring_mask);
+
+	return ur;
+
+error:
+	err = errno;
+	uring_destroy(ur);
+	errno = err;
+	return NULL;
+}
+
+void
+uring_destroy(struct uring *ur)
+{
+	if (ur == NULL)
+		return;
+	if (ur->sqes != MAP_FAILED)
+		munmap(ur->sqes, ur->sqes_size);
+	if (ur->cq_ring != MAP_FAILED)
+		munmap(ur->cq_ring, ur->cq_ring_size);
+	if (ur->sq_ring != MAP_FAILED)
+		munmap(ur->sq_ring, ur->sq_ring_size);
+	if (ur->fd >= 0)
+		close(ur->fd);
+	rte_free(ur);
+}
+
+struct io_uring_sqe *
+uring_get_sqe(struct uring *ur)
+{
+	unsigned int tail = *ur->sq_tail + ur->nb_prep;
+	unsigned int idx = tail & ur->sq_mask;
+	struct io_uring_sqe *sqe = &ur->sqes[idx];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->user_data = ur->nb_prep;
+	ur->sq_array[idx] = idx;
+	ur->nb_prep++;
+	return sqe;
+}
+
+int
+uring_submit(struct uring *ur, int *res)
+{
+	unsigned int nb = ur->nb_prep;
+	unsigned int done = 0;
+	unsigned int head, tail;
+	int ret;
+
+	if (nb == 0)
+		return 0;
+	ur->nb_prep = 0;
+	__atomic_store_n(ur->sq_tail, *ur->sq_tail + nb, __ATOMIC_RELEASE);
+	do {
+		ret = syscall(__NR_io_uring_enter, ur->fd, nb, nb,
+			      IORING_ENTER_GETEVENTS, NULL, 0);
+	} while (ret < 0 && errno == EINTR);
+	if (ret < 0) {
+		/* Nothing was consumed, drop the entries */
+		__atomic_store_n(ur->sq_tail,
+				 __atomic_load_n(ur->sq_head, __ATOMIC_ACQUIRE),
+				 __ATOMIC_RELEASE);
+		return -errno;
+	}
+
+	while (done < nb) {
+		head = *ur->cq_head;
+		tail = __atomic_load_n(ur->cq_tail, __ATOMIC_ACQUIRE);
+		if (head == tail) {
+			/* A signal interrupted the wait */
+			ret = syscall(__NR_io_uring_enter, ur->fd, 0,
+				      nb - done, IORING_ENTER_GETEVENTS,
+				      NULL, 0);
+			if (ret < 0 && errno != EINTR)
+				return -errno;
+			continue;
+		}
+		for (; head != tail; head++) {
+			struct io_uring_cqe *cqe;
+
+			cqe = &ur->cqes[head & ur->cq_mask];
+			res[cqe->user_data] = cqe->res;
+			done++;
+		}
+		__atomic_store_n(ur->cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	return nb;
+}
+
+#else /* HAVE_IO_URING */
+
+struct uring *
+uring_create(unsigned int entries __rte_unused)
+{
+	errno = ENOTSUP;
+	return NULL;
+}
+
+void
+uring_destroy(struct uring *ur __rte_unused)
+{
+}
+
+struct io_uring_sqe *
+uring_get_sqe(struct uring *ur __rte_unused)
+{
+	return NULL;
+}
+
+int
+uring_submit(struct uring *ur __rte_unused, int *res __rte_unused)
+{
+	return -ENOTSUP;
+}
+
+#endif /* HAVE_IO_URING */
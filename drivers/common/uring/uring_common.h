@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _URING_COMMON_H_
+#define _URING_COMMON_H_
+
+/*
+ * Minimal io_uring, without liburing, shared by the PMDs which submit the
+ * I/O of a whole burst to the kernel in one system call. The drivers fill
+ * the submission queue entries for their operations, this code sets up
+ * the rings and submits the entries.
+ */
+struct uring;
+struct io_uring_sqe;
+
+/**
+ * Create an io_uring able to hold a burst of operations.
+ *
+ * @param entries
+ *   Maximum number of operations submitted at once.
+ *
+ * @return
+ *   The io_uring on success, NULL otherwise and errno is set.
+ */
+struct uring *uring_create(unsigned int entries);
+
+/**
+ * Destroy an io_uring, NULL is accepted.
+ */
+void uring_destroy(struct uring *ur);
+
+/**
+ * Get the next submission queue entry, zeroed, for the driver to fill its
+ * opcode and arguments. It is submitted by the next uring_submit(), and
+ * no more than the number of entries of the io_uring may be prepared.
+ *
+ * @return
+ *   The entry, NULL if io_uring is not supported.
+ */
+struct io_uring_sqe *uring_get_sqe(struct uring *ur);
+
+/**
+ * Submit the prepared operations with a single system call and wait for
+ * their completion.
+ *
+ * @param res
+ *   Filled with the result of each operation, in the order they were
+ *   prepared: the number of bytes transferred, or a negative errno.
+ *
+ * @return
+ *   The number of operations, negative errno value if none could be
+ *   submitted.
+ */
+int uring_submit(struct uring *ur, int *res);
+
+#endif /* _URING_COMMON_H_ */
@@ -2,15 +2,22 @@
  * Copyright(c) 2018 Ericsson AB
  */
 
+#include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include <rte_cycles.h>
 #include <rte_eventdev_pmd.h>
 #include <rte_eventdev_pmd_vdev.h>
+#include <rte_kvargs.h>
 #include <rte_random.h>
 
 #include "dsw_evdev.h"
 
+#define MIGRATION_INTERVAL_ARG "migration_interval"
+#define LOAD_UPDATE_INTERVAL_ARG "load_update_interval"
+#define MAX_MIGRATION_FLOWS_ARG "max_migration_flows"
+
 #define EVENTDEV_NAME_DSW_PMD event_dsw
 
 static int
@@ -61,10 +68,10 @@ dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	rte_atomic16_init(&port->load);
 
 	port->load_update_interval =
-		(DSW_LOAD_UPDATE_INTERVAL * rte_get_timer_hz()) / US_PER_S;
+		(dsw->load_update_interval * rte_get_timer_hz()) / US_PER_S;
 
 	port->migration_interval =
-		(DSW_MIGRATION_INTERVAL * rte_get_timer_hz()) / US_PER_S;
+		(dsw->migration_interval * rte_get_timer_hz()) / US_PER_S;
 
 	dev->data->ports[port_id] = port;
 
@@ -368,6 +375,15 @@ dsw_close(struct rte_eventdev *dev)
 	return 0;
 }
 
+static int
+dsw_eth_rx_adapter_caps_get(const struct rte_eventdev *dev __rte_unused,
+			    const struct rte_eth_dev *eth_dev __rte_unused,
+			    uint32_t *caps)
+{
+	*caps = RTE_EVENT_ETH_RX_ADAPTER_SW_CAP;
+	return 0;
+}
+
 static struct rte_eventdev_ops dsw_evdev_ops = {
 	.port_setup = dsw_port_setup,
 	.port_def_conf = dsw_port_def_conf,
@@ -382,20 +398,110 @@ static struct rte_eventdev_ops dsw_evdev_ops = {
 	.dev_start = dsw_start,
 	.dev_stop = dsw_stop,
 	.dev_close = dsw_close,
+	.eth_rx_adapter_caps_get = dsw_eth_rx_adapter_caps_get,
 	.xstats_get = dsw_xstats_get,
 	.xstats_get_names = dsw_xstats_get_names,
 	.xstats_get_by_name = dsw_xstats_get_by_name
 };
 
+static int
+set_interval(const char *key __rte_unused, const char *value, void *opaque)
+{
+	uint32_t *interval = opaque;
+	char *end;
+	unsigned long val;
+
+	errno = 0;
+	val = strtoul(value, &end, 10);
+	if (errno != 0 || *end != '\0' || val == 0 || val > UINT32_MAX)
+		return -1;
+
+	*interval = val;
+	return 0;
+}
+
+static int
+set_max_migration_flows(const char *key __rte_unused, const char *value,
+			void *opaque)
+{
+	uint8_t *max_flows = opaque;
+	int val;
+
+	val = atoi(value);
+	if (val < 1 || val > DSW_MAX_FLOWS_PER_MIGRATION)
+		return -1;
+
+	*max_flows = val;
+	return 0;
+}
+
+static int
+dsw_parse_args(const char *name, const char *params, uint32_t *mig_interval,
+	       uint32_t *load_interval, uint8_t *max_mig_flows)
+{
+	static const char *const args[] = {
+		MIGRATION_INTERVAL_ARG,
+		LOAD_UPDATE_INTERVAL_ARG,
+		MAX_MIGRATION_FLOWS_ARG,
+		NULL
+	};
+	struct rte_kvargs *kvlist;
+	int ret;
+
+	if (params == NULL || params[0] == '\0')
+		return 0;
+
+	kvlist = rte_kvargs_parse(params, args);
+	if (kvlist == NULL) {
+		RTE_LOG(ERR, EVENTDEV, "%s: invalid parameters \"%s\"\n",
+			name, params);
+		return -EINVAL;
+	}
+
+	ret = rte_kvargs_process(kvlist, MIGRATION_INTERVAL_ARG,
+				 set_interval, mig_interval);
+	if (ret != 0) {
+		RTE_LOG(ERR, EVENTDEV, "%s: invalid %s parameter\n", name,
+			MIGRATION_INTERVAL_ARG);
+		goto out;
+	}
+
+	ret = rte_kvargs_process(kvlist, LOAD_UPDATE_INTERVAL_ARG,
+				 set_interval, load_interval);
+	if (ret != 0) {
+		RTE_LOG(ERR, EVENTDEV, "%s: invalid %s parameter\n", name,
+			LOAD_UPDATE_INTERVAL_ARG);
+		goto out;
+	}
+
+	ret = rte_kvargs_process(kvlist, MAX_MIGRATION_FLOWS_ARG,
+				 set_max_migration_flows, max_mig_flows);
+	if (ret != 0)
+		RTE_LOG(ERR, EVENTDEV, "%s: invalid %s parameter\n", name,
+			MAX_MIGRATION_FLOWS_ARG);
+
+out:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
 static int
 dsw_probe(struct rte_vdev_device *vdev)
 {
 	const char *name;
 	struct rte_eventdev *dev;
 	struct dsw_evdev *dsw;
+	uint32_t migration_interval = DSW_MIGRATION_INTERVAL;
+	uint32_t load_update_interval = DSW_LOAD_UPDATE_INTERVAL;
+	uint8_t max_migration_flows = DSW_MAX_FLOWS_PER_MIGRATION;
 
 	name = rte_vdev_device_name(vdev);
 
+	if (dsw_parse_args(name, rte_vdev_device_args(vdev),
+			   &migration_interval, &load_update_interval,
+			   &max_migration_flows) < 0)
+		return -EINVAL;
+
 	dev = rte_event_pmd_vdev_init(name, sizeof(struct dsw_evdev),
 				      rte_socket_id());
 	if (dev == NULL)
@@ -414,6 +520,9 @@ dsw_probe(struct rte_vdev_device *vdev)
 
 	dsw = dev->data->dev_private;
 	dsw->data = dev->data;
+	dsw->migration_interval = migration_interval;
+	dsw->load_update_interval = load_update_interval;
+	dsw->max_migration_flows = max_migration_flows;
 
 	return 0;
 }
@@ -436,3 +545,7 @@ static struct rte_vdev_driver evdev_dsw_pmd_drv = {
 };
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_DSW_PMD, evdev_dsw_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(EVENTDEV_NAME_DSW_PMD,
+			      MIGRATION_INTERVAL_ARG "=<us> "
+			      LOAD_UPDATE_INTERVAL_ARG "=<us> "
+			      MAX_MIGRATION_FLOWS_ARG "=<int>");
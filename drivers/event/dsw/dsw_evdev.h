@@ -78,6 +78,10 @@
  * which the ports send and receive control messages, which in turn is
  * largely a function of how much cycles are spent the processing of
  * an event burst.
+ *
+ * Both this and the load update interval are defaults, which may be
+ * overridden with the "migration_interval" and "load_update_interval"
+ * device arguments.
  */
 #define DSW_MIGRATION_INTERVAL (1000)
 #define DSW_MIN_SOURCE_LOAD_FOR_MIGRATION (DSW_LOAD_FROM_PERCENT(70))
@@ -85,13 +89,28 @@
 
 #define DSW_MAX_EVENTS_RECORDED (128)
 
+/* The number of flows which may be moved in a single migration
+ * (i.e. pause/unpause) round. Moving several flows at once amortizes
+ * the cost of the control message exchange over more than one flow,
+ * and allows an overloaded port to shed load quicker. The default
+ * may be lowered with the "max_migration_flows" device argument.
+ */
+#define DSW_MAX_FLOWS_PER_MIGRATION (8)
+
+/* The number of flows (the most heavily loaded ones first), for which
+ * the estimated load is kept from the last migration consideration,
+ * to be exposed as xstats.
+ */
+#define DSW_MAX_FLOW_LOADS_RECORDED (8)
+
 /* Only one outstanding migration per port is allowed */
-#define DSW_MAX_PAUSED_FLOWS (DSW_MAX_PORTS)
+#define DSW_MAX_PAUSED_FLOWS (DSW_MAX_PORTS*DSW_MAX_FLOWS_PER_MIGRATION)
 
 /* Enough room for paus request/confirm and unpaus request/confirm for
- * all possible senders.
+ * all possible senders and all flows in a migration.
  */
-#define DSW_CTL_IN_RING_SIZE ((DSW_MAX_PORTS-1)*4)
+#define DSW_CTL_IN_RING_SIZE						\
+	((DSW_MAX_PORTS-1)*4*DSW_MAX_FLOWS_PER_MIGRATION)
 
 /* With DSW_SORT_DEQUEUED enabled, the scheduler will, at the point of
  * dequeue(), arrange events so that events with the same flow id on
@@ -157,11 +176,21 @@ struct dsw_port {
 
 	uint64_t migration_start;
 	uint64_t migrations;
+	uint64_t migration_rounds;
 	uint64_t migration_latency;
+	uint64_t max_migration_latency;
 
-	uint8_t migration_target_port_id;
-	struct dsw_queue_flow migration_target_qf;
-	uint8_t cfm_cnt;
+	uint8_t migration_target_port_ids[DSW_MAX_FLOWS_PER_MIGRATION];
+	struct dsw_queue_flow
+		migration_target_qfs[DSW_MAX_FLOWS_PER_MIGRATION];
+	uint8_t migration_target_qfs_len;
+	uint16_t cfm_cnt;
+
+	/* Estimated load of the most heavily loaded flows, as seen
+	 * at the last migration consideration.
+	 */
+	uint16_t flow_loads_len;
+	int16_t flow_loads[DSW_MAX_FLOW_LOADS_RECORDED];
 
 	uint16_t paused_flows_len;
 	struct dsw_queue_flow paused_flows[DSW_MAX_PAUSED_FLOWS];
@@ -219,6 +248,11 @@ struct dsw_evdev {
 	uint8_t num_queues;
 	int32_t max_inflight;
 
+	/* Device arguments */
+	uint32_t migration_interval;
+	uint32_t load_update_interval;
+	uint8_t max_migration_flows;
+
 	rte_atomic32_t credits_on_loan __rte_cache_aligned;
 };
 
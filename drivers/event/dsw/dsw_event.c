@@ -323,6 +323,7 @@ dsw_find_lowest_load_port(uint8_t *port_ids, uint16_t num_port_ids,
 struct dsw_queue_flow_burst {
 	struct dsw_queue_flow queue_flow;
 	uint16_t count;
+	int16_t load;
 };
 
 static inline int
@@ -396,19 +397,48 @@ dsw_retrieve_port_loads(struct dsw_evdev *dsw, int16_t *port_loads,
 	return below_limit;
 }
 
-static bool
+/* The load of a flow is estimated by its share of the recorded
+ * events, applied to the load of the port.
+ */
+static void
+dsw_estimate_flow_loads(struct dsw_queue_flow_burst *bursts,
+			uint16_t num_bursts, uint16_t num_events,
+			int16_t port_load)
+{
+	uint16_t i;
+
+	for (i = 0; i < num_bursts; i++)
+		bursts[i].load = ((int32_t)port_load * bursts[i].count) /
+			num_events;
+}
+
+static void
+dsw_port_record_flow_loads(struct dsw_port *port,
+			   struct dsw_queue_flow_burst *bursts,
+			   uint16_t num_bursts)
+{
+	uint16_t i;
+
+	/* The bursts are sorted in ascending order. */
+	for (i = 0; i < num_bursts && i < DSW_MAX_FLOW_LOADS_RECORDED; i++)
+		port->flow_loads[i] = bursts[num_bursts - 1 - i].load;
+
+	port->flow_loads_len = i;
+}
+
+static int
 dsw_select_migration_target(struct dsw_evdev *dsw,
 			    struct dsw_port *source_port,
 			    struct dsw_queue_flow_burst *bursts,
 			    uint16_t num_bursts, int16_t *port_loads,
-			    int16_t max_load, struct dsw_queue_flow *target_qf,
-			    uint8_t *target_port_id)
+			    int16_t max_load, uint8_t *target_port_id)
 {
-	uint16_t source_load = port_loads[source_port->id];
+	int16_t source_load = port_loads[source_port->id];
 	uint16_t i;
 
 	for (i = 0; i < num_bursts; i++) {
 		struct dsw_queue_flow *qf = &bursts[i].queue_flow;
+		int16_t flow_load = bursts[i].load;
 
 		if (dsw_port_is_flow_paused(source_port, qf->queue_id,
 					    qf->flow_hash))
@@ -422,18 +452,76 @@ dsw_select_migration_target(struct dsw_evdev *dsw,
 					  source_port->id, port_loads,
 					  target_port_id, &target_load);
 
-		if (target_load < source_load &&
-		    target_load < max_load) {
-			*target_qf = *qf;
-			return true;
-		}
+		/* The target port must remain less loaded than the
+		 * source port after the move. Otherwise, a large flow
+		 * would just be migrated back and forth between the
+		 * two ports.
+		 */
+		if (target_load + flow_load < source_load - flow_load &&
+		    target_load + flow_load < max_load)
+			return i;
 	}
 
 	DSW_LOG_DP_PORT(DEBUG, source_port->id, "For the %d flows considered, "
 			"no target port found with load less than %d.\n",
 			num_bursts, DSW_LOAD_TO_PERCENT(max_load));
 
-	return false;
+	return -1;
+}
+
+/* Select up to max_migration_flows flows to be moved in this
+ * migration round. The estimated port loads are adjusted after every
+ * selection, so that several flows are not all moved to the same,
+ * previously lightly loaded, port.
+ */
+static uint8_t
+dsw_select_migration_targets(struct dsw_evdev *dsw,
+			     struct dsw_port *source_port,
+			     struct dsw_queue_flow_burst *bursts,
+			     uint16_t num_bursts, int16_t *port_loads)
+{
+	uint8_t num_targets = 0;
+
+	/* There's no point in moving all flows away from the port. */
+	while (num_targets < dsw->max_migration_flows && num_bursts > 1 &&
+	       port_loads[source_port->id] >=
+	       DSW_MIN_SOURCE_LOAD_FOR_MIGRATION) {
+		uint8_t target_port_id;
+		int idx;
+
+		/* The strategy is to first try to find a flow to move
+		 * to a port with low load (below the migration-attempt
+		 * threshold). If that fails, we try to find a port
+		 * which is below the max threshold, and also less
+		 * loaded than this port is.
+		 */
+		idx = dsw_select_migration_target(dsw, source_port, bursts,
+					  num_bursts, port_loads,
+					  DSW_MIN_SOURCE_LOAD_FOR_MIGRATION,
+					  &target_port_id);
+		if (idx < 0)
+			idx = dsw_select_migration_target(dsw, source_port,
+					  bursts, num_bursts, port_loads,
+					  DSW_MAX_TARGET_LOAD_FOR_MIGRATION,
+					  &target_port_id);
+		if (idx < 0)
+			break;
+
+		source_port->migration_target_qfs[num_targets] =
+			bursts[idx].queue_flow;
+		source_port->migration_target_port_ids[num_targets] =
+			target_port_id;
+		num_targets++;
+
+		port_loads[target_port_id] += bursts[idx].load;
+		port_loads[source_port->id] -= bursts[idx].load;
+
+		num_bursts--;
+		memmove(&bursts[idx], &bursts[idx + 1],
+			(num_bursts - idx) * sizeof(bursts[0]));
+	}
+
+	return num_targets;
 }
 
 static uint8_t
@@ -616,27 +704,73 @@ dsw_port_migration_stats(struct dsw_port *port)
 
 	migration_latency = (rte_get_timer_cycles() - port->migration_start);
 	port->migration_latency += migration_latency;
-	port->migrations++;
+	if (migration_latency > port->max_migration_latency)
+		port->max_migration_latency = migration_latency;
+	port->migrations += port->migration_target_qfs_len;
+	port->migration_rounds++;
 }
 
 static void
 dsw_port_end_migration(struct dsw_evdev *dsw, struct dsw_port *port)
 {
-	uint8_t queue_id = port->migration_target_qf.queue_id;
-	uint16_t flow_hash = port->migration_target_qf.flow_hash;
+	uint8_t i;
 
 	port->migration_state = DSW_MIGRATION_STATE_IDLE;
 	port->seen_events_len = 0;
 
 	dsw_port_migration_stats(port);
 
-	if (dsw->queues[queue_id].schedule_type != RTE_SCHED_TYPE_PARALLEL) {
+	for (i = 0; i < port->migration_target_qfs_len; i++) {
+		uint8_t queue_id = port->migration_target_qfs[i].queue_id;
+		uint16_t flow_hash = port->migration_target_qfs[i].flow_hash;
+
 		dsw_port_remove_paused_flow(port, queue_id, flow_hash);
 		dsw_port_flush_paused_events(dsw, port, queue_id, flow_hash);
+
+		DSW_LOG_DP_PORT(DEBUG, port->id, "Migration completed for "
+				"queue_id %d flow_hash %d.\n", queue_id,
+				flow_hash);
 	}
 
-	DSW_LOG_DP_PORT(DEBUG, port->id, "Migration completed for queue_id "
-			"%d flow_hash %d.\n", queue_id, flow_hash);
+	port->migration_target_qfs_len = 0;
+}
+
+/* No need to go through the whole pause procedure for parallel
+ * queues, since atomic/ordered semantics need not to be maintained,
+ * so such flows are moved right away, and removed from the set of
+ * flows being migrated.
+ */
+static void
+dsw_port_move_parallel_flows(struct dsw_evdev *dsw,
+			     struct dsw_port *source_port)
+{
+	uint8_t i = 0;
+
+	while (i < source_port->migration_target_qfs_len) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+		uint8_t last_idx = source_port->migration_target_qfs_len - 1;
+
+		if (dsw->queues[qf->queue_id].schedule_type !=
+		    RTE_SCHED_TYPE_PARALLEL) {
+			i++;
+			continue;
+		}
+
+		/* Single byte-sized stores are always atomic. */
+		dsw->queues[qf->queue_id].flow_to_port_map[qf->flow_hash] =
+			source_port->migration_target_port_ids[i];
+
+		source_port->migrations++;
+
+		source_port->migration_target_qfs[i] =
+			source_port->migration_target_qfs[last_idx];
+		source_port->migration_target_port_ids[i] =
+			source_port->migration_target_port_ids[last_idx];
+		source_port->migration_target_qfs_len--;
+	}
+
+	rte_smp_wmb();
 }
 
 static void
@@ -651,6 +785,7 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 	uint16_t num_bursts;
 	int16_t source_port_load;
 	int16_t port_loads[dsw->num_ports];
+	uint8_t i;
 
 	if (now < source_port->next_migration)
 		return;
@@ -716,6 +851,11 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 	 */
 	num_bursts = dsw_sort_qfs_to_bursts(seen_events, seen_events_len,
 					    bursts);
+
+	dsw_estimate_flow_loads(bursts, num_bursts, seen_events_len,
+				source_port_load);
+	dsw_port_record_flow_loads(source_port, bursts, num_bursts);
+
 	/* For non-big-little systems, there's no point in moving the
 	 * only (known) flow.
 	 */
@@ -727,54 +867,29 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 		return;
 	}
 
-	/* The strategy is to first try to find a flow to move to a
-	 * port with low load (below the migration-attempt
-	 * threshold). If that fails, we try to find a port which is
-	 * below the max threshold, and also less loaded than this
-	 * port is.
-	 */
-	if (!dsw_select_migration_target(dsw, source_port, bursts, num_bursts,
-					 port_loads,
-					 DSW_MIN_SOURCE_LOAD_FOR_MIGRATION,
-					 &source_port->migration_target_qf,
-					 &source_port->migration_target_port_id)
-	    &&
-	    !dsw_select_migration_target(dsw, source_port, bursts, num_bursts,
-					 port_loads,
-					 DSW_MAX_TARGET_LOAD_FOR_MIGRATION,
-					 &source_port->migration_target_qf,
-				       &source_port->migration_target_port_id))
+	source_port->migration_target_qfs_len =
+		dsw_select_migration_targets(dsw, source_port, bursts,
+					     num_bursts, port_loads);
+	if (source_port->migration_target_qfs_len == 0)
 		return;
 
-	DSW_LOG_DP_PORT(DEBUG, source_port->id, "Migrating queue_id %d "
-			"flow_hash %d from port %d to port %d.\n",
-			source_port->migration_target_qf.queue_id,
-			source_port->migration_target_qf.flow_hash,
-			source_port->id, source_port->migration_target_port_id);
+	for (i = 0; i < source_port->migration_target_qfs_len; i++)
+		DSW_LOG_DP_PORT(DEBUG, source_port->id, "Migrating queue_id "
+				"%d flow_hash %d from port %d to port %d.\n",
+				source_port->migration_target_qfs[i].queue_id,
+				source_port->migration_target_qfs[i].flow_hash,
+				source_port->id,
+				source_port->migration_target_port_ids[i]);
 
-	/* We have a winner. */
+	/* We have a winner (or several). */
 
 	source_port->migration_state = DSW_MIGRATION_STATE_PAUSING;
 	source_port->migration_start = rte_get_timer_cycles();
 
-	/* No need to go through the whole pause procedure for
-	 * parallel queues, since atomic/ordered semantics need not to
-	 * be maintained.
-	 */
-
-	if (dsw->queues[source_port->migration_target_qf.queue_id].schedule_type
-	    == RTE_SCHED_TYPE_PARALLEL) {
-		uint8_t queue_id = source_port->migration_target_qf.queue_id;
-		uint16_t flow_hash = source_port->migration_target_qf.flow_hash;
-		uint8_t dest_port_id = source_port->migration_target_port_id;
-
-		/* Single byte-sized stores are always atomic. */
-		dsw->queues[queue_id].flow_to_port_map[flow_hash] =
-			dest_port_id;
-		rte_smp_wmb();
+	dsw_port_move_parallel_flows(dsw, source_port);
 
+	if (source_port->migration_target_qfs_len == 0) {
 		dsw_port_end_migration(dsw, source_port);
-
 		return;
 	}
 
@@ -783,14 +898,18 @@ dsw_port_consider_migration(struct dsw_evdev *dsw,
 	 */
 	dsw_port_flush_out_buffers(dsw, source_port);
 
-	dsw_port_add_paused_flow(source_port,
-				 source_port->migration_target_qf.queue_id,
-				 source_port->migration_target_qf.flow_hash);
-
-	dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_PAUS_REQ,
-			       source_port->migration_target_qf.queue_id,
-			       source_port->migration_target_qf.flow_hash);
 	source_port->cfm_cnt = 0;
+
+	for (i = 0; i < source_port->migration_target_qfs_len; i++) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+
+		dsw_port_add_paused_flow(source_port, qf->queue_id,
+					 qf->flow_hash);
+
+		dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_PAUS_REQ,
+				       qf->queue_id, qf->flow_hash);
+	}
 }
 
 static void
@@ -824,11 +943,29 @@ dsw_port_handle_unpause_flow(struct dsw_evdev *dsw, struct dsw_port *port,
 
 #define FORWARD_BURST_SIZE (32)
 
+/* Returns the migration destination port of the event's flow, or -1
+ * in case the flow is not being migrated.
+ */
+static int
+dsw_port_migration_dest(struct dsw_port *port, const struct rte_event *event)
+{
+	uint16_t flow_hash = dsw_flow_id_hash(event->flow_id);
+	uint8_t i;
+
+	for (i = 0; i < port->migration_target_qfs_len; i++) {
+		struct dsw_queue_flow *qf = &port->migration_target_qfs[i];
+
+		if (qf->queue_id == event->queue_id &&
+		    qf->flow_hash == flow_hash)
+			return port->migration_target_port_ids[i];
+	}
+
+	return -1;
+}
+
 static void
-dsw_port_forward_migrated_flow(struct dsw_port *source_port,
-			       struct rte_event_ring *dest_ring,
-			       uint8_t queue_id,
-			       uint16_t flow_hash)
+dsw_port_forward_migrated_flows(struct dsw_evdev *dsw,
+				struct dsw_port *source_port)
 {
 	uint16_t events_left;
 
@@ -856,8 +993,14 @@ dsw_port_forward_migrated_flow(struct dsw_port *source_port,
 		 */
 		for (i = 0; i < in_len; i++) {
 			struct rte_event *e = &in_burst[i];
-			if (e->queue_id == queue_id &&
-			    dsw_flow_id_hash(e->flow_id) == flow_hash) {
+			int dest_port_id;
+
+			dest_port_id = dsw_port_migration_dest(source_port, e);
+
+			if (dest_port_id >= 0) {
+				struct rte_event_ring *dest_ring =
+					dsw->ports[dest_port_id].in_ring;
+
 				while (rte_event_ring_enqueue_burst(dest_ring,
 								    e, 1,
 								    NULL) != 1)
@@ -874,32 +1017,40 @@ dsw_port_forward_migrated_flow(struct dsw_port *source_port,
 }
 
 static void
-dsw_port_move_migrating_flow(struct dsw_evdev *dsw,
-			     struct dsw_port *source_port)
+dsw_port_move_migrating_flows(struct dsw_evdev *dsw,
+			      struct dsw_port *source_port)
 {
-	uint8_t queue_id = source_port->migration_target_qf.queue_id;
-	uint16_t flow_hash = source_port->migration_target_qf.flow_hash;
-	uint8_t dest_port_id = source_port->migration_target_port_id;
-	struct dsw_port *dest_port = &dsw->ports[dest_port_id];
+	uint8_t i;
 
 	dsw_port_flush_out_buffers(dsw, source_port);
 
 	rte_smp_wmb();
 
-	dsw->queues[queue_id].flow_to_port_map[flow_hash] =
-		dest_port_id;
+	for (i = 0; i < source_port->migration_target_qfs_len; i++) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+
+		dsw->queues[qf->queue_id].flow_to_port_map[qf->flow_hash] =
+			source_port->migration_target_port_ids[i];
+	}
 
-	dsw_port_forward_migrated_flow(source_port, dest_port->in_ring,
-				       queue_id, flow_hash);
+	dsw_port_forward_migrated_flows(dsw, source_port);
 
 	/* Flow table update and migration destination port's enqueues
 	 * must be seen before the control message.
 	 */
 	rte_smp_wmb();
 
-	dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_UNPAUS_REQ, queue_id,
-			       flow_hash);
 	source_port->cfm_cnt = 0;
+
+	for (i = 0; i < source_port->migration_target_qfs_len; i++) {
+		struct dsw_queue_flow *qf =
+			&source_port->migration_target_qfs[i];
+
+		dsw_port_ctl_broadcast(dsw, source_port, DSW_CTL_UNPAUS_REQ,
+				       qf->queue_id, qf->flow_hash);
+	}
+
 	source_port->migration_state = DSW_MIGRATION_STATE_UNPAUSING;
 }
 
@@ -908,7 +1059,9 @@ dsw_port_handle_confirm(struct dsw_evdev *dsw, struct dsw_port *port)
 {
 	port->cfm_cnt++;
 
-	if (port->cfm_cnt == (dsw->num_ports-1)) {
+	/* One confirmation per flow and peer port is expected. */
+	if (port->cfm_cnt ==
+	    (dsw->num_ports-1) * port->migration_target_qfs_len) {
 		switch (port->migration_state) {
 		case DSW_MIGRATION_STATE_PAUSING:
 			DSW_LOG_DP_PORT(DEBUG, port->id, "Going into forwarding "
@@ -969,7 +1122,7 @@ dsw_port_bg_process(struct dsw_evdev *dsw, struct dsw_port *port)
 {
 	if (unlikely(port->migration_state == DSW_MIGRATION_STATE_FORWARDING &&
 		     port->pending_releases == 0))
-		dsw_port_move_migrating_flow(dsw, port);
+		dsw_port_move_migrating_flows(dsw, port);
 
 	/* Polling the control ring is relatively inexpensive, and
 	 * polling it often helps bringing down migration latency, so
@@ -37,12 +37,19 @@ struct dsw_xstat_dev {
 
 typedef
 uint64_t (*dsw_xstats_port_get_value_fn)(struct dsw_evdev *dsw,
-					 uint8_t port_id, uint8_t queue_id);
+					 uint8_t port_id, uint8_t param);
+
+/* What the (optional) second parameter of a port xstat refers to. */
+enum dsw_xstats_param {
+	DSW_XSTATS_PARAM_NONE,
+	DSW_XSTATS_PARAM_QUEUE,
+	DSW_XSTATS_PARAM_FLOW_RANK
+};
 
 struct dsw_xstats_port {
 	const char *name_fmt;
 	dsw_xstats_port_get_value_fn get_value_fn;
-	bool per_queue;
+	enum dsw_xstats_param param;
 };
 
 static uint64_t
@@ -85,17 +92,20 @@ dsw_xstats_port_get_queue_dequeued(struct dsw_evdev *dsw, uint8_t port_id,
 }
 
 DSW_GEN_PORT_ACCESS_FN(migrations)
+DSW_GEN_PORT_ACCESS_FN(migration_rounds)
 
 static uint64_t
 dsw_xstats_port_get_migration_latency(struct dsw_evdev *dsw, uint8_t port_id,
 				      uint8_t queue_id __rte_unused)
 {
 	uint64_t total_latency = dsw->ports[port_id].migration_latency;
-	uint64_t num_migrations = dsw->ports[port_id].migrations;
+	uint64_t num_rounds = dsw->ports[port_id].migration_rounds;
 
-	return num_migrations > 0 ? total_latency / num_migrations : 0;
+	return num_rounds > 0 ? total_latency / num_rounds : 0;
 }
 
+DSW_GEN_PORT_ACCESS_FN(max_migration_latency)
+
 static uint64_t
 dsw_xstats_port_get_event_proc_latency(struct dsw_evdev *dsw, uint8_t port_id,
 				       uint8_t queue_id __rte_unused)
@@ -121,33 +131,52 @@ dsw_xstats_port_get_load(struct dsw_evdev *dsw, uint8_t port_id,
 	return DSW_LOAD_TO_PERCENT(load);
 }
 
+static uint64_t
+dsw_xstats_port_get_flow_load(struct dsw_evdev *dsw, uint8_t port_id,
+			      uint8_t rank)
+{
+	struct dsw_port *port = &dsw->ports[port_id];
+
+	if (rank >= port->flow_loads_len)
+		return 0;
+
+	return DSW_LOAD_TO_PERCENT(port->flow_loads[rank]);
+}
+
 DSW_GEN_PORT_ACCESS_FN(last_bg)
 
 static struct dsw_xstats_port dsw_port_xstats[] = {
 	{ "port_%u_new_enqueued", dsw_xstats_port_get_new_enqueued,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_forward_enqueued", dsw_xstats_port_get_forward_enqueued,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_release_enqueued", dsw_xstats_port_get_release_enqueued,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_queue_%u_enqueued", dsw_xstats_port_get_queue_enqueued,
-	  true },
+	  DSW_XSTATS_PARAM_QUEUE },
 	{ "port_%u_dequeued", dsw_xstats_port_get_dequeued,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_queue_%u_dequeued", dsw_xstats_port_get_queue_dequeued,
-	  true },
+	  DSW_XSTATS_PARAM_QUEUE },
 	{ "port_%u_migrations", dsw_xstats_port_get_migrations,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
+	{ "port_%u_migration_rounds", dsw_xstats_port_get_migration_rounds,
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_migration_latency", dsw_xstats_port_get_migration_latency,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
+	{ "port_%u_max_migration_latency",
+	  dsw_xstats_port_get_max_migration_latency,
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_event_proc_latency", dsw_xstats_port_get_event_proc_latency,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_inflight_credits", dsw_xstats_port_get_inflight_credits,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
 	{ "port_%u_load", dsw_xstats_port_get_load,
-	  false },
+	  DSW_XSTATS_PARAM_NONE },
+	{ "port_%u_flow_%u_load", dsw_xstats_port_get_flow_load,
+	  DSW_XSTATS_PARAM_FLOW_RANK },
 	{ "port_%u_last_bg", dsw_xstats_port_get_last_bg,
-	  false }
+	  DSW_XSTATS_PARAM_NONE }
 };
 
 static int
@@ -164,12 +193,26 @@ dsw_xstats_dev_get_names(struct rte_event_dev_xstats_name *xstats_names,
 	return i;
 }
 
+static unsigned int
+dsw_xstats_port_num_params(struct dsw_evdev *dsw,
+			   struct dsw_xstats_port *xstat)
+{
+	switch (xstat->param) {
+	case DSW_XSTATS_PARAM_QUEUE:
+		return dsw->num_queues;
+	case DSW_XSTATS_PARAM_FLOW_RANK:
+		return DSW_MAX_FLOW_LOADS_RECORDED;
+	default:
+		return 0;
+	}
+}
+
 static int
 dsw_xstats_port_get_names(struct dsw_evdev *dsw, uint8_t port_id,
 			  struct rte_event_dev_xstats_name *xstats_names,
 			  unsigned int *ids, unsigned int size)
 {
-	uint8_t queue_id = 0;
+	uint8_t param = 0;
 	unsigned int id_idx;
 	unsigned int stat_idx;
 
@@ -178,13 +221,13 @@ dsw_xstats_port_get_names(struct dsw_evdev *dsw, uint8_t port_id,
 	     id_idx++) {
 		struct dsw_xstats_port *xstat = &dsw_port_xstats[stat_idx];
 
-		if (xstat->per_queue) {
-			ids[id_idx] = DSW_XSTATS_ID_CREATE(stat_idx, queue_id);
+		if (xstat->param != DSW_XSTATS_PARAM_NONE) {
+			ids[id_idx] = DSW_XSTATS_ID_CREATE(stat_idx, param);
 			snprintf(xstats_names[id_idx].name,
 				 RTE_EVENT_DEV_XSTATS_NAME_SIZE,
 				 dsw_port_xstats[stat_idx].name_fmt, port_id,
-				 queue_id);
-			queue_id++;
+				 param);
+			param++;
 		} else {
 			ids[id_idx] = stat_idx;
 			snprintf(xstats_names[id_idx].name,
@@ -192,9 +235,9 @@ dsw_xstats_port_get_names(struct dsw_evdev *dsw, uint8_t port_id,
 				 dsw_port_xstats[stat_idx].name_fmt, port_id);
 		}
 
-		if (!(xstat->per_queue && queue_id < dsw->num_queues)) {
+		if (param >= dsw_xstats_port_num_params(dsw, xstat)) {
 			stat_idx++;
-			queue_id = 0;
+			param = 0;
 		}
 	}
 	return id_idx;
@@ -249,12 +292,12 @@ dsw_xstats_port_get(const struct rte_eventdev *dev, uint8_t port_id,
 		unsigned int id = ids[i];
 		unsigned int stat_idx = DSW_XSTATS_ID_GET_STAT(id);
 		struct dsw_xstats_port *xstat = &dsw_port_xstats[stat_idx];
-		uint8_t queue_id = 0;
+		uint8_t param = 0;
 
-		if (xstat->per_queue)
-			queue_id = DSW_XSTATS_ID_GET_PARAM(id);
+		if (xstat->param != DSW_XSTATS_PARAM_NONE)
+			param = DSW_XSTATS_ID_GET_PARAM(id);
 
-		values[i] = xstat->get_value_fn(dsw, port_id, queue_id);
+		values[i] = xstat->get_value_fn(dsw, port_id, param);
 	}
 	return n;
 }
@@ -19,6 +19,7 @@
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define SCHED_SHARDS_ARG "sched_shards"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
@@ -56,6 +57,14 @@ sw_port_link(struct rte_eventdev *dev, void *port, const uint8_t queues[],
 		if (j < q->cq_num_mapped_cqs)
 			continue;
 
+		/* the QIDs and ports are partitioned among the scheduler
+		 * shards at start, a link cannot cross two shards afterwards
+		 */
+		if (sw->started && q->shard != p->shard) {
+			rte_errno = EINVAL;
+			break;
+		}
+
 		if (q->type == SW_SCHED_TYPE_DIRECT) {
 			/* check directed qids only map to one port */
 			if (p->num_qids_mapped > 0) {
@@ -369,7 +378,7 @@ sw_init_qid_iqs(struct sw_evdev *sw)
 			continue;
 
 		for (j = 0; j < SW_IQS_MAX; j++)
-			iq_init(sw, &qid->iq[j]);
+			iq_init(&sw->shards[qid->shard], &qid->iq[j]);
 	}
 }
 
@@ -385,6 +394,13 @@ sw_qids_empty(struct sw_evdev *sw)
 		}
 	}
 
+	/* events handed off between shards are on their way to a qid */
+	for (i = 0; i < sw->nb_shards; i++) {
+		if (sw->shards[i].handoff_ring != NULL &&
+				rte_event_ring_count(sw->shards[i].handoff_ring))
+			return 0;
+	}
+
 	return 1;
 }
 
@@ -429,9 +445,9 @@ sw_drain_ports(struct rte_eventdev *dev)
 }
 
 static void
-sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
+sw_drain_queue(struct rte_eventdev *dev, struct sw_sched_shard *shard,
+		struct sw_iq *iq)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	eventdev_stop_flush_t flush;
 	uint8_t dev_id;
 	void *arg;
@@ -443,7 +459,7 @@ sw_drain_queue(struct rte_eventdev *dev, struct sw_iq *iq)
 	while (iq_count(iq) > 0) {
 		struct rte_event ev;
 
-		iq_dequeue_burst(sw, iq, &ev, 1);
+		iq_dequeue_burst(shard, iq, &ev, 1);
 
 		if (flush)
 			flush(dev_id, ev, arg);
@@ -457,8 +473,11 @@ sw_drain_queues(struct rte_eventdev *dev)
 	unsigned int i, j;
 
 	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+
 		for (j = 0; j < SW_IQS_MAX; j++)
-			sw_drain_queue(dev, &sw->qids[i].iq[j]);
+			sw_drain_queue(dev, &sw->shards[qid->shard],
+					&qid->iq[j]);
 	}
 }
 
@@ -475,7 +494,8 @@ sw_clean_qid_iqs(struct rte_eventdev *dev)
 		for (j = 0; j < SW_IQS_MAX; j++) {
 			if (!qid->iq[j].head)
 				continue;
-			iq_free_chunk_list(sw, qid->iq[j].head);
+			iq_free_chunk_list(&sw->shards[qid->shard],
+					qid->iq[j].head);
 			qid->iq[j].head = NULL;
 		}
 	}
@@ -517,7 +537,9 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
+	char buf[RTE_RING_NAMESIZE];
 	int num_chunks, i;
+	uint32_t s;
 
 	sw->qid_count = conf->nb_event_queues;
 	sw->port_count = conf->nb_event_ports;
@@ -528,24 +550,49 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	num_chunks = ((SW_INFLIGHT_EVENTS_TOTAL/SW_EVS_PER_Q_CHUNK)+1) +
 			sw->qid_count*SW_IQS_MAX*2;
 
-	/* If this is a reconfiguration, free the previous IQ allocation. All
-	 * IQ chunk references were cleaned out of the QIDs in sw_stop(), and
-	 * will be reinitialized in sw_start().
+	/* Each shard may end up owning all the events, so each one gets
+	 * chunks for the worst case.
 	 */
-	if (sw->chunks)
-		rte_free(sw->chunks);
+	for (s = 0; s < sw->nb_shards; s++) {
+		struct sw_sched_shard *shard = &sw->shards[s];
 
-	sw->chunks = rte_malloc_socket(NULL,
-				       sizeof(struct sw_queue_chunk) *
-				       num_chunks,
-				       0,
-				       sw->data->socket_id);
-	if (!sw->chunks)
-		return -ENOMEM;
+		/* If this is a reconfiguration, free the previous IQ
+		 * allocation. All IQ chunk references were cleaned out of
+		 * the QIDs in sw_stop(), and will be reinitialized in
+		 * sw_start().
+		 */
+		if (shard->chunks)
+			rte_free(shard->chunks);
+
+		shard->chunks = rte_malloc_socket(NULL,
+					       sizeof(struct sw_queue_chunk) *
+					       num_chunks,
+					       0,
+					       sw->data->socket_id);
+		if (!shard->chunks)
+			return -ENOMEM;
+
+		shard->chunk_list_head = NULL;
+		for (i = 0; i < num_chunks; i++)
+			iq_free_chunk(shard, &shard->chunks[i]);
+
+		if (sw->nb_shards == 1 || shard->handoff_ring != NULL)
+			continue;
 
-	sw->chunk_list_head = NULL;
-	for (i = 0; i < num_chunks; i++)
-		iq_free_chunk(sw, &sw->chunks[i]);
+		/* The handoff ring can hold all the events of the device,
+		 * so that handing events over never fails.
+		 */
+		snprintf(buf, sizeof(buf), "sw%d_s%u_handoff",
+				dev->data->dev_id, s);
+		shard->handoff_ring = rte_event_ring_create(buf,
+				SW_INFLIGHT_EVENTS_TOTAL, sw->data->socket_id,
+				RING_F_SC_DEQ | RING_F_EXACT_SZ);
+		if (shard->handoff_ring == NULL) {
+			SW_LOG_ERR("Error creating handoff ring for shard %u\n",
+					s);
+			return -ENOMEM;
+		}
+	}
 
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
@@ -629,16 +676,44 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	static const char * const q_type_strings[] = {
 			"Ordered", "Atomic", "Parallel", "Directed"
 	};
+	struct sw_sched_shard total = {0};
 	uint32_t i;
 	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
 			sw->port_count, sw->qid_count);
 
+	for (i = 0; i < sw->nb_shards; i++) {
+		const struct sw_sched_shard *shard = &sw->shards[i];
+
+		total.stats.rx_pkts += shard->stats.rx_pkts;
+		total.stats.rx_dropped += shard->stats.rx_dropped;
+		total.stats.tx_pkts += shard->stats.tx_pkts;
+		total.sched_called += shard->sched_called;
+		total.sched_cq_qid_called += shard->sched_cq_qid_called;
+		total.sched_no_iq_enqueues += shard->sched_no_iq_enqueues;
+		total.sched_no_cq_enqueues += shard->sched_no_cq_enqueues;
+	}
+
 	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+		total.stats.rx_pkts, total.stats.rx_dropped,
+		total.stats.tx_pkts);
+	fprintf(f, "\tsched calls: %"PRIu64"\n", total.sched_called);
+	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+		total.sched_cq_qid_called);
+	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+		total.sched_no_iq_enqueues);
+	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+		total.sched_no_cq_enqueues);
+	if (sw->nb_shards > 1) {
+		for (i = 0; i < sw->nb_shards; i++) {
+			const struct sw_sched_shard *shard = &sw->shards[i];
+
+			fprintf(f, "\tshard %u: qids %u ports %u calls %"PRIu64
+				" rx %"PRIu64" tx %"PRIu64" handoff %"PRIu64
+				"\n", i, shard->qid_count, shard->port_count,
+				shard->sched_called, shard->stats.rx_pkts,
+				shard->stats.tx_pkts, shard->handoff_pkts);
+		}
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -654,8 +729,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 				COL_RED, i, COL_RESET);
 			continue;
 		}
-		fprintf(f, "  Port %d %s\n", i,
-			p->is_directed ? " (SingleCons)" : "");
+		fprintf(f, "  Port %d %s (shard %u)\n", i,
+			p->is_directed ? " (SingleCons)" : "", p->shard);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64
 			"\t%sinflight %d%s\n", sw->ports[i].stats.rx_pkts,
 			sw->ports[i].stats.rx_dropped,
@@ -719,7 +794,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		int affinities_per_port[SW_PORTS_MAX] = {0};
 		uint32_t inflights = 0;
 
-		fprintf(f, "  Queue %d (%s)\n", i, q_type_strings[qid->type]);
+		fprintf(f, "  Queue %d (%s) (shard %u)\n", i,
+			q_type_strings[qid->type], qid->shard);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64"\n",
 			qid->stats.rx_pkts, qid->stats.rx_dropped,
 			qid->stats.tx_pkts);
@@ -770,6 +846,93 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	}
 }
 
+static uint32_t
+sw_group_find(uint16_t *parent, uint32_t node)
+{
+	while (parent[node] != node) {
+		parent[node] = parent[parent[node]];
+		node = parent[node];
+	}
+	return node;
+}
+
+/* Partition the QIDs and ports among the scheduler shards. A QID and all the
+ * ports linked to it must be owned by the same shard, so the groups of QIDs
+ * and ports connected by links are assigned as a whole: the largest groups
+ * first, each one to the least loaded shard.
+ */
+static void
+sw_partition_shards(struct sw_evdev *sw)
+{
+	const uint32_t nb_nodes = sw->qid_count + sw->port_count;
+	uint16_t parent[RTE_EVENT_MAX_QUEUES_PER_DEV + SW_PORTS_MAX];
+	uint16_t weight[RTE_EVENT_MAX_QUEUES_PER_DEV + SW_PORTS_MAX] = {0};
+	int16_t owner[RTE_EVENT_MAX_QUEUES_PER_DEV + SW_PORTS_MAX];
+	uint32_t shard_weight[SW_SCHED_SHARDS_MAX] = {0};
+	uint32_t i, j, used_shards = 0;
+
+	/* QID i is node i, port i is node qid_count + i */
+	for (i = 0; i < nb_nodes; i++) {
+		parent[i] = i;
+		owner[i] = -1;
+	}
+
+	for (i = 0; i < sw->qid_count; i++) {
+		const struct sw_qid *qid = &sw->qids[i];
+
+		for (j = 0; j < qid->cq_num_mapped_cqs; j++) {
+			uint32_t a = sw_group_find(parent, i);
+			uint32_t b = sw_group_find(parent,
+					sw->qid_count + qid->cq_map[j]);
+			parent[b] = a;
+		}
+	}
+
+	for (i = 0; i < nb_nodes; i++)
+		weight[sw_group_find(parent, i)]++;
+
+	for (;;) {
+		uint32_t group = nb_nodes, shard = 0;
+
+		for (i = 0; i < nb_nodes; i++)
+			if (parent[i] == i && owner[i] < 0 &&
+					(group == nb_nodes ||
+					 weight[i] > weight[group]))
+				group = i;
+		if (group == nb_nodes)
+			break;
+
+		for (i = 1; i < sw->nb_shards; i++)
+			if (shard_weight[i] < shard_weight[shard])
+				shard = i;
+
+		used_shards += (shard_weight[shard] == 0);
+		shard_weight[shard] += weight[group];
+		owner[group] = shard;
+	}
+
+	for (i = 0; i < sw->nb_shards; i++) {
+		sw->shards[i].qid_count = 0;
+		sw->shards[i].port_count = 0;
+	}
+
+	for (i = 0; i < sw->qid_count; i++)
+		sw->qids[i].shard = owner[sw_group_find(parent, i)];
+
+	for (i = 0; i < sw->port_count; i++) {
+		struct sw_port *p = &sw->ports[i];
+		struct sw_sched_shard *shard;
+
+		p->shard = owner[sw_group_find(parent, sw->qid_count + i)];
+		shard = &sw->shards[p->shard];
+		shard->port_ids[shard->port_count++] = i;
+	}
+
+	if (used_shards < sw->nb_shards)
+		SW_LOG_INFO("Only %u of %u scheduler shards have work, the queues and ports are linked in too few groups\n",
+				used_shards, sw->nb_shards);
+}
+
 static int
 sw_start(struct rte_eventdev *dev)
 {
@@ -800,18 +963,22 @@ sw_start(struct rte_eventdev *dev)
 			return -ENOLINK;
 		}
 
-	/* build up our prioritized array of qids */
+	sw_partition_shards(sw);
+
+	/* build up the prioritized array of qids of each shard */
 	/* We don't use qsort here, as if all/multiple entries have the same
 	 * priority, the result is non-deterministic. From "man 3 qsort":
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
 			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
+				struct sw_sched_shard *shard =
+					&sw->shards[sw->qids[i].shard];
+
+				shard->qids_prioritized[shard->qid_count++] =
+					&sw->qids[i];
 			}
 		}
 	}
@@ -871,11 +1038,19 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->nb_shards; i++) {
+		struct sw_sched_shard *shard = &sw->shards[i];
+
+		memset(&shard->stats, 0, sizeof(shard->stats));
+		shard->sched_called = 0;
+		shard->sched_no_iq_enqueues = 0;
+		shard->sched_no_cq_enqueues = 0;
+		shard->sched_cq_qid_called = 0;
+		shard->handoff_pkts = 0;
+
+		rte_event_ring_free(shard->handoff_ring);
+		shard->handoff_ring = NULL;
+	}
 
 	return 0;
 }
@@ -910,6 +1085,16 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_sched_shards(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *shards = opaque;
+	*shards = atoi(value);
+	if (*shards < 1 || *shards > SW_SCHED_SHARDS_MAX)
+		return -1;
+	return 0;
+}
+
 
 static int32_t sw_sched_service_func(void *args)
 {
@@ -918,6 +1103,13 @@ static int32_t sw_sched_service_func(void *args)
 	return 0;
 }
 
+static int32_t sw_sched_service_func_mt(void *args)
+{
+	struct rte_eventdev *dev = args;
+	sw_event_schedule_mt(dev);
+	return 0;
+}
+
 static int
 sw_probe(struct rte_vdev_device *vdev)
 {
@@ -957,6 +1149,7 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		SCHED_SHARDS_ARG,
 		NULL
 	};
 	const char *name;
@@ -966,6 +1159,8 @@ sw_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int sched_shards = 1;
+	int i;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -1007,13 +1202,24 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_SHARDS_ARG,
+					set_sched_shards, &sched_shards);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched shards parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, sched_shards=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			sched_shards);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -1038,6 +1244,12 @@ sw_probe(struct rte_vdev_device *vdev)
 	/* copy values passed from vdev command line to instance */
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
+	sw->nb_shards = sched_shards;
+	for (i = 0; i < sched_shards; i++) {
+		sw->shards[i].sw = sw;
+		sw->shards[i].id = i;
+		rte_atomic32_init(&sw->shards[i].running);
+	}
 
 	/* register service with EAL */
 	struct rte_service_spec service;
@@ -1048,6 +1260,13 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	/* with several shards, the service may run on several cores at once,
+	 * each one running a different shard
+	 */
+	if (sched_shards > 1) {
+		service.callback = sw_sched_service_func_mt;
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	}
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
@@ -1082,7 +1301,8 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int> "
+		SCHED_SHARDS_ARG "=<int>");
 
 /* declared extern in header, for access from other .c files */
 int eventdev_sw_log_level;
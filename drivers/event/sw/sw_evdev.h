@@ -21,6 +21,8 @@
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+/* max number of scheduler shards, each one run by one service core */
+#define SW_SCHED_SHARDS_MAX 16
 
 /* Should be power-of-two minus one, to leave room for the next pointer */
 #define SW_EVS_PER_Q_CHUNK 255
@@ -127,6 +129,9 @@ struct sw_qid {
 	uint32_t window_size;          /* Used to wrap reorder_buffer_index */
 
 	uint8_t priority;
+
+	/* scheduler shard owning this QID, set at start */
+	uint8_t shard;
 };
 
 struct sw_hist_list_entry {
@@ -201,8 +206,51 @@ struct sw_port {
 	struct rte_event cq_buf[MAX_SW_CONS_Q_DEPTH];
 
 	uint8_t num_qids_mapped;
+
+	/* scheduler shard pulling from and scheduling to this port */
+	uint8_t shard;
 };
 
+/*
+ * A scheduler shard owns a set of QIDs together with all the ports linked
+ * to them, so that the flow pinning, history lists and reorder buffers of
+ * a QID are only touched by one shard. Shards run concurrently on different
+ * service cores; events pulled by one shard but destined to a QID of another
+ * shard are handed over through the handoff ring of the destination shard.
+ */
+struct sw_sched_shard {
+	struct sw_evdev *sw;
+	uint8_t id;
+
+	/* set while a service core runs this shard */
+	rte_atomic32_t running;
+
+	/* IQ chunks of the QIDs owned by this shard */
+	struct sw_queue_chunk *chunk_list_head;
+	struct sw_queue_chunk *chunks;
+
+	/* Owned QIDs sorted by priority level, and owned ports */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint32_t port_count;
+	uint8_t port_ids[SW_PORTS_MAX];
+
+	/* Events destined to the QIDs of this shard, enqueued by others */
+	struct rte_event_ring *handoff_ring;
+	/* Events buffered for the handoff rings of other shards */
+	uint16_t handoff_buf_count[SW_SCHED_SHARDS_MAX];
+	struct rte_event
+		handoff_buf[SW_SCHED_SHARDS_MAX][SCHED_DEQUEUE_BURST_SIZE];
+
+	/* Stats */
+	struct sw_point_stats stats;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+	uint64_t handoff_pkts;
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -227,22 +275,15 @@ struct sw_evdev {
 
 	/* Internal queues - one per logical queue */
 	struct sw_qid qids[RTE_EVENT_MAX_QUEUES_PER_DEV] __rte_cache_aligned;
-	struct sw_queue_chunk *chunk_list_head;
-	struct sw_queue_chunk *chunks;
 
 	/* Cache how many packets are in each cq */
 	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	/* Scheduler shards, QIDs and ports are partitioned among them */
+	struct sw_sched_shard shards[SW_SCHED_SHARDS_MAX];
+	uint32_t nb_shards;
 
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
 
 	uint8_t started;
 	uint32_t credit_update_quanta;
@@ -278,6 +319,8 @@ uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
 void sw_event_schedule(struct rte_eventdev *dev);
+void sw_event_schedule_shard(struct sw_sched_shard *shard);
+void sw_event_schedule_mt(struct rte_eventdev *dev);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
@@ -5,6 +5,7 @@
 #include <rte_ring.h>
 #include <rte_hash_crc.h>
 #include <rte_event_ring.h>
+#include <rte_per_lcore.h>
 #include "sw_evdev.h"
 #include "iq_chunk.h"
 
@@ -27,8 +28,8 @@
 #define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
 
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count)
+sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
 	struct rte_event blocked_qes[MAX_PER_IQ_DEQUEUE];
@@ -43,7 +44,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	 */
 	uint32_t qid_id = qid->id;
 
-	iq_dequeue_burst(sw, &qid->iq[iq_num], qes, count);
+	iq_dequeue_burst(shard, &qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
 		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
@@ -104,14 +105,15 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			p->cq_buf_count = 0;
 		}
 	}
-	iq_put_back(sw, &qid->iq[iq_num], blocked_qes, nb_blocked);
+	iq_put_back(shard, &qid->iq[iq_num], blocked_qes, nb_blocked);
 
 	return count - nb_blocked;
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count, int keep_order)
+sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count,
+		int keep_order)
 {
 	uint32_t i;
 	uint32_t cq_idx = qid->cq_next_tx;
@@ -168,7 +170,7 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 					(void *)&p->hist_list[head].rob_entry);
 
 		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
-		iq_pop(sw, &qid->iq[iq_num]);
+		iq_pop(shard, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
 		p->inflights++;
@@ -181,8 +183,9 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count __rte_unused)
+sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		struct sw_qid * const qid, uint32_t iq_num,
+		unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
 	struct sw_port *port = &sw->ports[cq_id];
@@ -194,7 +197,7 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 
 	/* burst dequeue from the QID IQ ring */
 	struct sw_iq *iq = &qid->iq[iq_num];
-	uint32_t ret = iq_dequeue_burst(sw, iq,
+	uint32_t ret = iq_dequeue_burst(shard, iq,
 			&port->cq_buf[port->cq_buf_count], count_free);
 	port->cq_buf_count += ret;
 
@@ -209,15 +212,15 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_evdev *sw, struct sw_sched_shard *shard)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
 
-	sw->sched_cq_qid_called++;
+	shard->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	for (qid_idx = 0; qid_idx < shard->qid_count; qid_idx++) {
+		struct sw_qid *qid = shard->qids_prioritized[qid_idx];
 
 		int type = qid->type;
 		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
@@ -231,14 +234,14 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 
 		if (count > 0) {
 			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
-						iq_num, count);
+				pkts_done += sw_schedule_dir_to_cq(sw, shard,
+						qid, iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
-						iq_num, count);
+				pkts_done += sw_schedule_atomic_to_cq(sw, shard,
+						qid, iq_num, count);
 			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
-						iq_num, count,
+				pkts_done += sw_schedule_parallel_to_cq(sw,
+						shard, qid, iq_num, count,
 						type == RTE_SCHED_TYPE_ORDERED);
 		}
 
@@ -254,19 +257,99 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 	return pkts;
 }
 
+static void
+sw_handoff_flush_shard(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		uint8_t dest)
+{
+	struct rte_event_ring *ring = sw->shards[dest].handoff_ring;
+	uint16_t count = shard->handoff_buf_count[dest];
+	uint16_t done = 0;
+
+	/* The handoff rings are sized to hold all the events of the device,
+	 * so the enqueue cannot fail for long.
+	 */
+	while (done < count)
+		done += rte_event_ring_enqueue_burst(ring,
+				&shard->handoff_buf[dest][done],
+				count - done, NULL);
+
+	shard->handoff_buf_count[dest] = 0;
+}
+
+static void
+sw_handoff_flush(struct sw_evdev *sw, struct sw_sched_shard *shard)
+{
+	uint32_t i;
+
+	for (i = 0; i < sw->nb_shards; i++)
+		if (shard->handoff_buf_count[i] > 0)
+			sw_handoff_flush_shard(sw, shard, i);
+}
+
+/* Push a QE into the IQ of its QID, at the right priority. The IQs may only
+ * be touched by the shard owning the QID, so the QE is handed over to that
+ * shard if it is not this one.
+ */
+static __rte_always_inline void
+sw_enqueue_to_qid(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		const struct rte_event *qe)
+{
+	struct sw_qid *qid = &sw->qids[qe->queue_id];
+	uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+
+	if (unlikely(qid->shard != shard->id)) {
+		uint8_t dest = qid->shard;
+
+		shard->handoff_buf[dest][shard->handoff_buf_count[dest]++] =
+			*qe;
+		if (shard->handoff_buf_count[dest] == SCHED_DEQUEUE_BURST_SIZE)
+			sw_handoff_flush_shard(sw, shard, dest);
+		return;
+	}
+
+	qid->iq_pkt_mask |= (1 << (iq_num));
+	iq_enqueue(shard, &qid->iq[iq_num], qe);
+	qid->iq_pkt_count[iq_num]++;
+	qid->stats.rx_pkts++;
+}
+
+/* Take the QEs handed over by the other shards */
+static uint32_t
+sw_schedule_pull_handoff(struct sw_evdev *sw, struct sw_sched_shard *shard)
+{
+	struct rte_event qes[SCHED_DEQUEUE_BURST_SIZE];
+	uint32_t pkts = 0;
+	uint32_t i, n;
+
+	if (shard->handoff_ring == NULL)
+		return 0;
+
+	do {
+		n = rte_event_ring_dequeue_burst(shard->handoff_ring, qes,
+				RTE_DIM(qes), NULL);
+		for (i = 0; i < n; i++)
+			sw_enqueue_to_qid(sw, shard, &qes[i]);
+		pkts += n;
+	} while (n == RTE_DIM(qes) && (int)pkts < sw->sched_quanta);
+
+	shard->handoff_pkts += pkts;
+
+	return pkts;
+}
+
 /* This function will perform re-ordering of packets, and injecting into
- * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
- * contiguous in that array, this function accepts a "range" of QIDs to scan.
+ * the appropriate QID IQ, for the ordered QIDs of the shard.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_evdev *sw, struct sw_sched_shard *shard)
 {
 	/* Perform egress reordering */
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
+	uint32_t qid_idx;
 
-	for (; qid_start < qid_end; qid_start++) {
-		struct sw_qid *qid = &sw->qids[qid_start];
+	for (qid_idx = 0; qid_idx < shard->qid_count; qid_idx++) {
+		struct sw_qid *qid = shard->qids_prioritized[qid_idx];
 		int i, num_entries_in_use;
 
 		if (qid->type != RTE_SCHED_TYPE_ORDERED)
@@ -285,32 +368,20 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				break;
 
 			for (j = 0; j < entry->num_fragments; j++) {
-				uint16_t dest_qid;
-				uint16_t dest_iq;
-
 				int idx = entry->fragment_index + j;
 				qe = &entry->fragments[idx];
 
-				dest_qid = qe->queue_id;
-				dest_iq  = PRIO_TO_IQ(qe->priority);
-
-				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+				if (qe->queue_id >= sw->qid_count) {
+					shard->stats.rx_dropped++;
 					continue;
 				}
 
 				pkts_iter++;
 
-				struct sw_qid *q = &sw->qids[dest_qid];
-				struct sw_iq *iq = &q->iq[dest_iq];
-
 				/* we checked for space above, so enqueue must
 				 * succeed
 				 */
-				iq_enqueue(sw, iq, qe);
-				q->iq_pkt_mask |= (1 << (dest_iq));
-				q->iq_pkt_count[dest_iq]++;
-				q->stats.rx_pkts++;
+				sw_enqueue_to_qid(sw, shard, qe);
 			}
 
 			entry->ready = (j != entry->num_fragments);
@@ -343,7 +414,8 @@ sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
 }
 
 static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		uint32_t port_id, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
 	uint32_t pkts_iter = 0;
@@ -363,15 +435,6 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 		if (!allow_reorder && !eop)
 			flags = QE_FLAG_VALID;
 
-		/*
-		 * if we don't have space for this packet in an IQ,
-		 * then move on to next queue. Technically, for a
-		 * packet that needs reordering, we don't need to check
-		 * here, but it simplifies things not to special-case
-		 */
-		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
-		struct sw_qid *qid = &sw->qids[qe->queue_id];
-
 		/* now process based on flags. Note that for directed
 		 * queues, the enqueue_flush masks off all but the
 		 * valid flag. This makes FWD and PARTIAL enqueues just
@@ -422,7 +485,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				 */
 				int num_frag = rob_entry->num_fragments;
 				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
+					shard->stats.rx_dropped++;
 				else {
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
@@ -430,14 +493,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				goto end_qe;
 			}
 
-			/* Use the iq_num from above to push the QE
-			 * into the qid at the right priority
-			 */
-
-			qid->iq_pkt_mask |= (1 << (iq_num));
-			iq_enqueue(sw, &qid->iq[iq_num], qe);
-			qid->iq_pkt_count[iq_num]++;
-			qid->stats.rx_pkts++;
+			sw_enqueue_to_qid(sw, shard, qe);
 			pkts_iter++;
 		}
 
@@ -450,19 +506,22 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(sw, shard, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_evdev *sw,
+		struct sw_sched_shard *shard, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(sw, shard, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_evdev *sw, struct sw_sched_shard *shard,
+		uint32_t port_id)
 {
 	uint32_t pkts_iter = 0;
 	struct sw_port *port = &sw->ports[port_id];
@@ -478,19 +537,9 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 		if ((flags & QE_FLAG_VALID) == 0)
 			goto end_qe;
 
-		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
-		struct sw_qid *qid = &sw->qids[qe->queue_id];
-		struct sw_iq *iq = &qid->iq[iq_num];
-
 		port->stats.rx_pkts++;
 
-		/* Use the iq_num from above to push the QE
-		 * into the qid at the right priority
-		 */
-		qid->iq_pkt_mask |= (1 << (iq_num));
-		iq_enqueue(sw, iq, qe);
-		qid->iq_pkt_count[iq_num]++;
-		qid->stats.rx_pkts++;
+		sw_enqueue_to_qid(sw, shard, qe);
 		pkts_iter++;
 
 end_qe:
@@ -502,45 +551,55 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 }
 
 void
-sw_event_schedule(struct rte_eventdev *dev)
+sw_event_schedule_shard(struct sw_sched_shard *shard)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
+	struct sw_evdev *sw = shard->sw;
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	shard->sched_called++;
 	if (unlikely(!sw->started))
 		return;
 
 	do {
 		uint32_t in_pkts_this_iteration = 0;
 
+		sw_schedule_pull_handoff(sw, shard);
+
 		/* Pull from rx_ring for ports */
 		do {
 			in_pkts = 0;
-			for (i = 0; i < sw->port_count; i++) {
-				/* ack the unlinks in progress as done */
-				if (sw->ports[i].unlinks_in_progress)
-					sw->ports[i].unlinks_in_progress = 0;
+			for (i = 0; i < shard->port_count; i++) {
+				uint32_t port_id = shard->port_ids[i];
+				struct sw_port *port = &sw->ports[port_id];
 
-				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
-				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+				/* ack the unlinks in progress as done */
+				if (port->unlinks_in_progress)
+					port->unlinks_in_progress = 0;
+
+				if (port->is_directed)
+					in_pkts += sw_schedule_pull_port_dir(sw,
+							shard, port_id);
+				else if (port->num_ordered_qids > 0)
+					in_pkts += sw_schedule_pull_port_lb(sw,
+							shard, port_id);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(
+							sw, shard, port_id);
 			}
 
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
-					sw->qid_count);
+			in_pkts += sw_schedule_reorder(sw, shard);
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
-		out_pkts = sw_schedule_qid_to_cq(sw);
+		/* hand the QEs for other shards over in bursts */
+		sw_handoff_flush(sw, shard);
+
+		out_pkts = sw_schedule_qid_to_cq(sw, shard);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -548,21 +607,67 @@ sw_event_schedule(struct rte_eventdev *dev)
 			break;
 	} while ((int)out_pkts_total < sched_quanta);
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	shard->stats.tx_pkts += out_pkts_total;
+	shard->stats.rx_pkts += in_pkts_total;
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	shard->sched_no_iq_enqueues += (in_pkts_total == 0);
+	shard->sched_no_cq_enqueues += (out_pkts_total == 0);
 
 	/* push all the internal buffered QEs in port->cq_ring to the
 	 * worker cores: aka, do the ring transfers batched.
 	 */
-	for (i = 0; i < sw->port_count; i++) {
-		struct rte_event_ring *worker = sw->ports[i].cq_worker_ring;
-		rte_event_ring_enqueue_burst(worker, sw->ports[i].cq_buf,
-				sw->ports[i].cq_buf_count,
-				&sw->cq_ring_space[i]);
-		sw->ports[i].cq_buf_count = 0;
+	for (i = 0; i < shard->port_count; i++) {
+		uint32_t port_id = shard->port_ids[i];
+		struct rte_event_ring *worker =
+			sw->ports[port_id].cq_worker_ring;
+		rte_event_ring_enqueue_burst(worker,
+				sw->ports[port_id].cq_buf,
+				sw->ports[port_id].cq_buf_count,
+				&sw->cq_ring_space[port_id]);
+		sw->ports[port_id].cq_buf_count = 0;
 	}
+}
+
+/* Run all the shards in turn, from a single core */
+void
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i;
+
+	for (i = 0; i < sw->nb_shards; i++)
+		sw_event_schedule_shard(&sw->shards[i]);
+}
+
+/* Hint of the next shard to try on each lcore, so that the service cores
+ * running the scheduler do not all contend for the same shard.
+ */
+static RTE_DEFINE_PER_LCORE(uint32_t, sw_next_shard);
+
+/* Run the first shard not already being run by another service core. This
+ * is what allows the scheduler service to be mapped to several cores.
+ */
+void
+sw_event_schedule_mt(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t next = RTE_PER_LCORE(sw_next_shard);
+	uint32_t i;
+
+	for (i = 0; i < sw->nb_shards; i++) {
+		uint32_t shard_id = (next + i) % sw->nb_shards;
+		struct sw_sched_shard *shard = &sw->shards[shard_id];
+
+		if (!rte_atomic32_test_and_set(&shard->running))
+			continue;
 
+		sw_event_schedule_shard(shard);
+
+		/* the shard state must be seen by the next core running it */
+		rte_smp_mb();
+		rte_atomic32_clear(&shard->running);
+
+		RTE_PER_LCORE(sw_next_shard) = shard_id + 1;
+		return;
+	}
 }
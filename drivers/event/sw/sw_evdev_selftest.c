@@ -2951,6 +2951,135 @@ dev_stop_flush(struct test *t) /* test to check we can properly flush events */
 	return -1;
 }
 
+#define SHARDS_FLOWS 4
+#define SHARDS_EVENTS 64
+
+static int
+sched_shards(struct test *t) /* test scheduling with several shards */
+{
+	const uint8_t rx_port = 0;
+	const uint8_t w1_port = 1;
+	const uint8_t w2_port = 2;
+	const uint8_t tx_port = 3;
+	uint32_t next_seq[SHARDS_FLOWS] = {0};
+	struct rte_event ev[SHARDS_EVENTS];
+	const struct sw_evdev *sw;
+	uint32_t rx_cnt = 0;
+	int i, j, n;
+
+	/* Three groups of linked queues and ports, which two shards get:
+	 *
+	 * rx_port -> qid0 -> w1_port -> qid1 -> w2_port -> qid2 -> tx_port
+	 *
+	 * qid0 and qid1 end up in different shards, so each forward from a
+	 * port to the next queue goes through the handoff between shards.
+	 */
+	if (init(t, 3, tx_port + 1) < 0 ||
+			create_ports(t, tx_port + 1) < 0 ||
+			create_atomic_qids(t, 2) < 0 ||
+			create_directed_qids(t, 1, &tx_port)) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	/* init() cleared the service of this instance */
+	rte_event_dev_service_id_get(evdev, &t->service_id);
+
+	if (rte_event_port_link(evdev, t->port[w1_port], &t->qid[0], NULL,
+			1) != 1 ||
+			rte_event_port_link(evdev, t->port[w2_port],
+				&t->qid[1], NULL, 1) != 1) {
+		printf("%d: error mapping lb qid\n", __LINE__);
+		goto err;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		goto err;
+	}
+
+	sw = sw_pmd_priv(&rte_eventdevs[evdev]);
+	if (sw->qids[0].shard == sw->qids[1].shard ||
+			sw->ports[w1_port].shard != sw->qids[0].shard ||
+			sw->ports[w2_port].shard != sw->qids[1].shard) {
+		printf("%d: Unexpected shard partitioning\n", __LINE__);
+		goto err;
+	}
+
+	/* a link across shards would break the atomic guarantees */
+	if (rte_event_port_link(evdev, t->port[w1_port], &t->qid[1], NULL,
+			1) != 0) {
+		printf("%d: Link across shards was accepted\n", __LINE__);
+		goto err;
+	}
+
+	for (i = 0; i < SHARDS_EVENTS; i++) {
+		ev[i] = (struct rte_event){
+			.op = RTE_EVENT_OP_NEW,
+			.queue_id = t->qid[0],
+			.sched_type = RTE_SCHED_TYPE_ATOMIC,
+			.flow_id = i % SHARDS_FLOWS,
+			.u64 = i / SHARDS_FLOWS,
+		};
+	}
+	for (i = 0; i < SHARDS_EVENTS; i += n) {
+		n = rte_event_enqueue_burst(evdev, t->port[rx_port], &ev[i],
+				RTE_MIN(SHARDS_EVENTS - i, 32));
+		if (n == 0) {
+			printf("%d: Error enqueuing events\n", __LINE__);
+			goto err;
+		}
+	}
+
+	for (i = 0; i < 100 && rx_cnt < SHARDS_EVENTS; i++) {
+		rte_service_run_iter_on_app_lcore(t->service_id, 1);
+
+		/* forward all events from one worker stage to the next */
+		for (j = w1_port; j <= w2_port; j++) {
+			int k, sent = 0;
+
+			n = rte_event_dequeue_burst(evdev, t->port[j], ev,
+					RTE_DIM(ev), 0);
+			for (k = 0; k < n; k++) {
+				ev[k].op = RTE_EVENT_OP_FORWARD;
+				ev[k].queue_id = t->qid[j];
+			}
+			while (sent < n)
+				sent += rte_event_enqueue_burst(evdev,
+						t->port[j], &ev[sent],
+						n - sent);
+		}
+
+		n = rte_event_dequeue_burst(evdev, t->port[tx_port], ev,
+				RTE_DIM(ev), 0);
+		for (j = 0; j < n; j++) {
+			uint32_t flow = ev[j].flow_id;
+
+			if (flow >= SHARDS_FLOWS ||
+					ev[j].u64 != next_seq[flow]) {
+				printf("%d: Flow %u out of order\n", __LINE__,
+						flow);
+				goto err;
+			}
+			next_seq[flow]++;
+		}
+		rx_cnt += n;
+	}
+
+	if (rx_cnt != SHARDS_EVENTS) {
+		printf("%d: Expected %d events at tx port, got %u\n", __LINE__,
+				SHARDS_EVENTS, rx_cnt);
+		goto err;
+	}
+
+	cleanup(t);
+	return 0;
+err:
+	rte_event_dev_dump(evdev, stdout);
+	cleanup(t);
+	return -1;
+}
+
 static int
 worker_loopback_worker_fn(void *arg)
 {
@@ -3386,6 +3515,36 @@ test_sw_eventdev(void)
 		printf("### Need at least 3 cores for the tests.\n");
 	}
 
+	/* the sharded scheduler test uses its own instance */
+	const char *shards_eventdev_name = "event_sw_shards";
+	int main_evdev = evdev;
+	uint32_t main_service_id = t->service_id;
+
+	if (rte_vdev_init(shards_eventdev_name, "sched_shards=2") < 0) {
+		printf("Error creating sharded eventdev\n");
+		goto test_fail;
+	}
+	evdev = rte_event_dev_get_dev_id(shards_eventdev_name);
+	if (evdev < 0 ||
+			rte_event_dev_service_id_get(evdev, &t->service_id) < 0) {
+		printf("Error finding sharded eventdev\n");
+		rte_vdev_uninit(shards_eventdev_name);
+		evdev = main_evdev;
+		goto test_fail;
+	}
+	rte_service_runstate_set(t->service_id, 1);
+	rte_service_set_runstate_mapped_check(t->service_id, 0);
+
+	printf("*** Running Scheduler Shards test...\n");
+	ret = sched_shards(t);
+	rte_vdev_uninit(shards_eventdev_name);
+	evdev = main_evdev;
+	t->service_id = main_service_id;
+	if (ret != 0) {
+		printf("ERROR - Scheduler Shards test FAILED.\n");
+		goto test_fail;
+	}
+
 	/*
 	 * Free test instance, leaving mempool initialized, and a pointer to it
 	 * in static eventdev_func_mempool, as it is re-used on re-runs
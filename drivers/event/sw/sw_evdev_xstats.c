@@ -50,15 +50,24 @@ static uint64_t
 get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
 		enum xstats_type type, int extra_arg __rte_unused)
 {
-	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
-	default: return -1;
+	uint64_t val = 0;
+	uint32_t i;
+
+	/* device stats are the sum of the stats of the scheduler shards */
+	for (i = 0; i < sw->nb_shards; i++) {
+		const struct sw_sched_shard *shard = &sw->shards[i];
+
+		switch (type) {
+		case rx: val += shard->stats.rx_pkts; break;
+		case tx: val += shard->stats.tx_pkts; break;
+		case dropped: val += shard->stats.rx_dropped; break;
+		case calls: val += shard->sched_called; break;
+		case no_iq_enq: val += shard->sched_no_iq_enqueues; break;
+		case no_cq_enq: val += shard->sched_no_cq_enqueues; break;
+		default: return -1;
+		}
 	}
+	return val;
 }
 
 static uint64_t
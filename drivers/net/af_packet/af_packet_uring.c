@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+/**
+ * @file
+ * Batched recvmsg() and sendmsg() on AF_PACKET sockets through io_uring.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#include <af_packet_autoconf.h>
+#include <af_packet_uring.h>
+
+#ifdef HAVE_IO_URING_MSG
+
+#include <linux/io_uring.h>
+
+/**
+ * Queue a recvmsg() or sendmsg() on a socket.
+ *
+ * The operations never wait: on an empty socket a receive completes with
+ * -EAGAIN, so that no operation is left pending in the kernel. The message
+ * must stay valid until the operation is submitted.
+ */
+void
+af_packet_uring_prep_msg(struct uring *ur, int fd, bool send,
+			 struct msghdr *msg)
+{
+	struct io_uring_sqe *sqe = uring_get_sqe(ur);
+
+	sqe->opcode = send ? IORING_OP_SENDMSG : IORING_OP_RECVMSG;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)msg;
+	sqe->len = 1;
+	sqe->msg_flags = MSG_DONTWAIT;
+}
+
+#else /* HAVE_IO_URING_MSG */
+
+void
+af_packet_uring_prep_msg(struct uring *ur __rte_unused,
+			 int fd __rte_unused, bool send __rte_unused,
+			 struct msghdr *msg __rte_unused)
+{
+}
+
+#endif /* HAVE_IO_URING_MSG */
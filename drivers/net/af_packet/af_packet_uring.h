@@ -0,0 +1,22 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _AF_PACKET_URING_H_
+#define _AF_PACKET_URING_H_
+
+#include <stdbool.h>
+#include <sys/socket.h>
+
+#include <uring_common.h>
+
+/*
+ * In io_uring mode, an AF_PACKET socket has no PACKET_MMAP ring: the
+ * kernel copies the packets straight from and to the mbufs, and the
+ * recvmsg() or sendmsg() calls of a whole burst are submitted to the
+ * kernel in one system call.
+ */
+void af_packet_uring_prep_msg(struct uring *ur, int fd, bool send,
+			      struct msghdr *msg);
+
+#endif /* _AF_PACKET_URING_H_ */
@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
+#include <linux/sockios.h>
 #include <arpa/inet.h>
 #include <net/if.h>
 #include <sys/types.h>
@@ -27,18 +28,30 @@
 #include <unistd.h>
 #include <poll.h>
 
+#include "af_packet_autoconf.h"
+#include "af_packet_uring.h"
+
 #define ETH_AF_PACKET_IFACE_ARG		"iface"
 #define ETH_AF_PACKET_NUM_Q_ARG		"qpairs"
 #define ETH_AF_PACKET_BLOCKSIZE_ARG	"blocksz"
 #define ETH_AF_PACKET_FRAMESIZE_ARG	"framesz"
 #define ETH_AF_PACKET_FRAMECOUNT_ARG	"framecnt"
 #define ETH_AF_PACKET_QDISC_BYPASS_ARG	"qdisc_bypass"
+#define ETH_AF_PACKET_TPACKET_V3_ARG	"tpacket_v3"
+#define ETH_AF_PACKET_IO_URING_ARG	"io_uring"
 
 #define DFLT_FRAME_SIZE		(1 << 11)
 #define DFLT_FRAME_COUNT	(1 << 9)
+/* TPACKET_V3 block retire timeout, in milliseconds */
+#define DFLT_BLOCK_TOV		1
 
 #define RTE_PMD_AF_PACKET_MAX_RINGS 16
 
+/* io_uring mode: operations per submission, and segments per Tx packet */
+#define AF_PACKET_URING_BURST	32
+#define AF_PACKET_URING_MAX_SEGS	8
+#define AF_PACKET_AUXDATA_SPACE CMSG_SPACE(sizeof(struct tpacket_auxdata))
+
 struct pkt_rx_queue {
 	int sockfd;
 
@@ -50,8 +63,21 @@ struct pkt_rx_queue {
 	struct rte_mempool *mb_pool;
 	uint16_t in_port;
 
+	/* TPACKET_V3: next packet and packets left in the current block */
+	struct tpacket3_hdr *pkt;
+	unsigned int pkts_left;
+
+	/* io_uring mode: one receive message per mbuf of the burst */
+	struct uring *uring;
+	struct msghdr msgs[AF_PACKET_URING_BURST];
+	struct iovec iovs[AF_PACKET_URING_BURST];
+	uint8_t cmsgs[AF_PACKET_URING_BURST][AF_PACKET_AUXDATA_SPACE];
+	/* the last burst was full, the socket may have more packets */
+	int uring_full;
+
 	volatile unsigned long rx_pkts;
 	volatile unsigned long rx_bytes;
+	volatile unsigned long err_pkts;
 };
 
 struct pkt_tx_queue {
@@ -63,6 +89,11 @@ struct pkt_tx_queue {
 	unsigned int framecount;
 	unsigned int framenum;
 
+	/* io_uring mode: one send message per packet of the burst */
+	struct uring *uring;
+	struct msghdr msgs[AF_PACKET_URING_BURST];
+	struct iovec iovs[AF_PACKET_URING_BURST * AF_PACKET_URING_MAX_SEGS];
+
 	volatile unsigned long tx_pkts;
 	volatile unsigned long err_pkts;
 	volatile unsigned long tx_bytes;
@@ -75,7 +106,10 @@ struct pmd_internals {
 	char *if_name;
 	struct rte_ether_addr eth_addr;
 
-	struct tpacket_req req;
+	int tpver;
+	unsigned int tp_hdrlen;
+	unsigned int io_uring;
+	struct tpacket_req3 req;
 
 	struct pkt_rx_queue rx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
 	struct pkt_tx_queue tx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
@@ -88,6 +122,8 @@ static const char *valid_arguments[] = {
 	ETH_AF_PACKET_FRAMESIZE_ARG,
 	ETH_AF_PACKET_FRAMECOUNT_ARG,
 	ETH_AF_PACKET_QDISC_BYPASS_ARG,
+	ETH_AF_PACKET_TPACKET_V3_ARG,
+	ETH_AF_PACKET_IO_URING_ARG,
 	NULL
 };
 
@@ -169,12 +205,98 @@ eth_af_packet_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 }
 
 /*
- * Callback to handle sending packets through a real NIC.
+ * With TPACKET_V3, the kernel fills whole blocks of variable sized packets
+ * and hands a block to user space when it is full or when its retire
+ * timeout expires. The block is given back to the kernel as soon as its
+ * last packet is copied, without waiting for the end of the burst.
  */
 static uint16_t
-eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+eth_af_packet_rx_v3(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
-	struct tpacket2_hdr *ppd;
+	struct pkt_rx_queue *pkt_q = queue;
+	struct tpacket_block_desc *pbd;
+	struct tpacket3_hdr *ppd;
+	struct rte_mbuf *mbuf;
+	uint16_t num_rx = 0;
+	unsigned long num_rx_bytes = 0;
+	unsigned long num_err = 0;
+	unsigned int framenum = pkt_q->framenum;
+
+	pbd = (struct tpacket_block_desc *)pkt_q->rd[framenum].iov_base;
+	while (num_rx < nb_pkts) {
+		/* open the next block filled by the kernel */
+		if (pkt_q->pkts_left == 0) {
+			if ((pbd->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+				break;
+			rte_smp_rmb();
+			pkt_q->pkts_left = pbd->hdr.bh1.num_pkts;
+			pkt_q->pkt = (struct tpacket3_hdr *)((uint8_t *)pbd +
+				pbd->hdr.bh1.offset_to_first_pkt);
+		}
+
+		if (pkt_q->pkts_left != 0) {
+			mbuf = rte_pktmbuf_alloc(pkt_q->mb_pool);
+			if (unlikely(mbuf == NULL))
+				break;
+
+			ppd = pkt_q->pkt;
+			/* blocks may hold packets larger than a frame */
+			if (unlikely(ppd->tp_snaplen >
+					rte_pktmbuf_tailroom(mbuf))) {
+				rte_pktmbuf_free(mbuf);
+				num_err++;
+			} else {
+				rte_pktmbuf_pkt_len(mbuf) = ppd->tp_snaplen;
+				rte_pktmbuf_data_len(mbuf) = ppd->tp_snaplen;
+				memcpy(rte_pktmbuf_mtod(mbuf, void *),
+				       (uint8_t *)ppd + ppd->tp_mac,
+				       ppd->tp_snaplen);
+				if (ppd->tp_status & TP_STATUS_VLAN_VALID) {
+					mbuf->vlan_tci = ppd->hv1.tp_vlan_tci;
+					mbuf->ol_flags |= (PKT_RX_VLAN |
+						PKT_RX_VLAN_STRIPPED);
+				}
+				mbuf->port = pkt_q->in_port;
+				bufs[num_rx++] = mbuf;
+				num_rx_bytes += mbuf->pkt_len;
+			}
+
+			pkt_q->pkt = (struct tpacket3_hdr *)((uint8_t *)ppd +
+				ppd->tp_next_offset);
+			pkt_q->pkts_left--;
+		}
+
+		/* retire the block once all its packets are copied */
+		if (pkt_q->pkts_left == 0) {
+			rte_smp_mb();
+			pbd->hdr.bh1.block_status = TP_STATUS_KERNEL;
+			if (++framenum >= pkt_q->framecount)
+				framenum = 0;
+			pbd = (struct tpacket_block_desc *)
+				pkt_q->rd[framenum].iov_base;
+		}
+	}
+	pkt_q->framenum = framenum;
+	pkt_q->rx_pkts += num_rx;
+	pkt_q->rx_bytes += num_rx_bytes;
+	pkt_q->err_pkts += num_err;
+	return num_rx;
+}
+
+/* Tx frames have the same fields in a different layout for TPACKET_V3 */
+#define TX_FRAME_FIELD(ppd, tpver, field) \
+	(*((tpver) == TPACKET_V3 ? \
+	   &((struct tpacket3_hdr *)(ppd))->field : \
+	   &((struct tpacket2_hdr *)(ppd))->field))
+
+/*
+ * Callback to handle sending packets through a real NIC.
+ */
+static __rte_always_inline uint16_t
+eth_af_packet_tx_common(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts,
+			const int tpver)
+{
+	void *ppd;
 	struct rte_mbuf *mbuf;
 	uint8_t *pbuf;
 	unsigned int framecount, framenum;
@@ -182,11 +304,13 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	struct pkt_tx_queue *pkt_q = queue;
 	uint16_t num_tx = 0;
 	unsigned long num_tx_bytes = 0;
+	unsigned int hdrlen;
 	int i;
 
 	if (unlikely(nb_pkts == 0))
 		return 0;
 
+	hdrlen = tpver == TPACKET_V3 ? TPACKET3_HDRLEN : TPACKET2_HDRLEN;
 	memset(&pfd, 0, sizeof(pfd));
 	pfd.fd = pkt_q->sockfd;
 	pfd.events = POLLOUT;
@@ -194,7 +318,7 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 
 	framecount = pkt_q->framecount;
 	framenum = pkt_q->framenum;
-	ppd = (struct tpacket2_hdr *) pkt_q->rd[framenum].iov_base;
+	ppd = pkt_q->rd[framenum].iov_base;
 	for (i = 0; i < nb_pkts; i++) {
 		mbuf = *bufs++;
 
@@ -213,13 +337,13 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		}
 
 		/* point at the next incoming frame */
-		if ((ppd->tp_status != TP_STATUS_AVAILABLE) &&
+		if ((TX_FRAME_FIELD(ppd, tpver, tp_status) !=
+				TP_STATUS_AVAILABLE) &&
 		    (poll(&pfd, 1, -1) < 0))
 			break;
 
 		/* copy the tx frame data */
-		pbuf = (uint8_t *) ppd + TPACKET2_HDRLEN -
-			sizeof(struct sockaddr_ll);
+		pbuf = (uint8_t *) ppd + hdrlen - sizeof(struct sockaddr_ll);
 
 		struct rte_mbuf *tmp_mbuf = mbuf;
 		while (tmp_mbuf) {
@@ -229,14 +353,14 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			tmp_mbuf = tmp_mbuf->next;
 		}
 
-		ppd->tp_len = mbuf->pkt_len;
-		ppd->tp_snaplen = mbuf->pkt_len;
+		TX_FRAME_FIELD(ppd, tpver, tp_len) = mbuf->pkt_len;
+		TX_FRAME_FIELD(ppd, tpver, tp_snaplen) = mbuf->pkt_len;
 
 		/* release incoming frame and advance ring buffer */
-		ppd->tp_status = TP_STATUS_SEND_REQUEST;
+		TX_FRAME_FIELD(ppd, tpver, tp_status) = TP_STATUS_SEND_REQUEST;
 		if (++framenum >= framecount)
 			framenum = 0;
-		ppd = (struct tpacket2_hdr *) pkt_q->rd[framenum].iov_base;
+		ppd = pkt_q->rd[framenum].iov_base;
 
 		num_tx++;
 		num_tx_bytes += mbuf->pkt_len;
@@ -257,6 +381,166 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return i;
 }
 
+static uint16_t
+eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	return eth_af_packet_tx_common(queue, bufs, nb_pkts, TPACKET_V2);
+}
+
+static uint16_t
+eth_af_packet_tx_v3(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	return eth_af_packet_tx_common(queue, bufs, nb_pkts, TPACKET_V3);
+}
+
+/*
+ * In io_uring mode, the kernel copies the packets straight into the mbufs.
+ * Unless the last burst was full, an empty socket is detected with a single
+ * ioctl() before any mbuf is allocated. A burst then allocates its mbufs,
+ * and frees those left unused when the socket has fewer packets to receive.
+ */
+static uint16_t
+eth_af_packet_rx_uring(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_rx_queue *pkt_q = queue;
+	struct rte_mbuf *mbufs[AF_PACKET_URING_BURST];
+	int res[AF_PACKET_URING_BURST];
+	struct tpacket_auxdata *aux;
+	struct cmsghdr *cmsg;
+	struct rte_mbuf *mbuf;
+	struct msghdr *msg;
+	uint16_t num_rx = 0;
+	unsigned long num_rx_bytes = 0;
+	unsigned long num_err = 0;
+	int i, nb, ret, next_len;
+
+	nb = RTE_MIN(nb_pkts, AF_PACKET_URING_BURST);
+	if (unlikely(nb == 0))
+		return 0;
+
+	/* length of the next packet, 0 when there is none */
+	if (!pkt_q->uring_full &&
+	    ioctl(pkt_q->sockfd, SIOCINQ, &next_len) == 0 && next_len == 0)
+		return 0;
+
+	if (rte_pktmbuf_alloc_bulk(pkt_q->mb_pool, mbufs, nb) != 0)
+		return 0;
+
+	for (i = 0; i < nb; i++) {
+		msg = &pkt_q->msgs[i];
+		pkt_q->iovs[i].iov_base = rte_pktmbuf_mtod(mbufs[i], void *);
+		pkt_q->iovs[i].iov_len = rte_pktmbuf_tailroom(mbufs[i]);
+		memset(msg, 0, sizeof(*msg));
+		msg->msg_iov = &pkt_q->iovs[i];
+		msg->msg_iovlen = 1;
+		msg->msg_control = pkt_q->cmsgs[i];
+		msg->msg_controllen = AF_PACKET_AUXDATA_SPACE;
+		af_packet_uring_prep_msg(pkt_q->uring, pkt_q->sockfd, false,
+					 msg);
+	}
+
+	ret = uring_submit(pkt_q->uring, res);
+	for (i = 0; i < nb; i++) {
+		mbuf = mbufs[i];
+		msg = &pkt_q->msgs[i];
+		/* -EAGAIN: no more packets on the socket */
+		if (ret < 0 || res[i] < 0 || (msg->msg_flags & MSG_TRUNC)) {
+			if (ret >= 0 && res[i] != -EAGAIN)
+				num_err++;
+			rte_pktmbuf_free(mbuf);
+			continue;
+		}
+
+		rte_pktmbuf_pkt_len(mbuf) = res[i];
+		rte_pktmbuf_data_len(mbuf) = res[i];
+		for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+		     cmsg = CMSG_NXTHDR(msg, cmsg)) {
+			if (cmsg->cmsg_level != SOL_PACKET ||
+			    cmsg->cmsg_type != PACKET_AUXDATA)
+				continue;
+			aux = (struct tpacket_auxdata *)CMSG_DATA(cmsg);
+			if (aux->tp_status & TP_STATUS_VLAN_VALID) {
+				mbuf->vlan_tci = aux->tp_vlan_tci;
+				mbuf->ol_flags |= (PKT_RX_VLAN |
+					PKT_RX_VLAN_STRIPPED);
+			}
+		}
+		mbuf->port = pkt_q->in_port;
+		bufs[num_rx++] = mbuf;
+		num_rx_bytes += mbuf->pkt_len;
+	}
+	pkt_q->uring_full = (num_rx + num_err == (unsigned int)nb);
+	pkt_q->rx_pkts += num_rx;
+	pkt_q->rx_bytes += num_rx_bytes;
+	pkt_q->err_pkts += num_err;
+	return num_rx;
+}
+
+/*
+ * In io_uring mode, the kernel copies the packets straight from the mbuf
+ * segments. The mbufs are freed once the whole burst is sent.
+ */
+static uint16_t
+eth_af_packet_tx_uring(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pkt_tx_queue *pkt_q = queue;
+	struct rte_mbuf *mbufs[AF_PACKET_URING_BURST];
+	int res[AF_PACKET_URING_BURST];
+	struct rte_mbuf *mbuf, *seg;
+	struct iovec *iov;
+	struct msghdr *msg;
+	unsigned long num_tx_bytes = 0;
+	uint16_t num_tx = 0;
+	uint16_t i = 0;
+	int n, nb, ret;
+
+	while (i < nb_pkts) {
+		nb = 0;
+		iov = pkt_q->iovs;
+		for (; i < nb_pkts && nb < AF_PACKET_URING_BURST; i++) {
+			mbuf = bufs[i];
+
+			/* insert vlan info if necessary */
+			if ((mbuf->ol_flags & PKT_TX_VLAN_PKT) &&
+			    rte_vlan_insert(&mbuf)) {
+				rte_pktmbuf_free(mbuf);
+				continue;
+			}
+			if (mbuf->nb_segs > AF_PACKET_URING_MAX_SEGS) {
+				rte_pktmbuf_free(mbuf);
+				continue;
+			}
+
+			msg = &pkt_q->msgs[nb];
+			memset(msg, 0, sizeof(*msg));
+			msg->msg_iov = iov;
+			for (seg = mbuf; seg != NULL; seg = seg->next) {
+				iov->iov_base = rte_pktmbuf_mtod(seg, void *);
+				iov->iov_len = rte_pktmbuf_data_len(seg);
+				iov++;
+			}
+			msg->msg_iovlen = mbuf->nb_segs;
+			af_packet_uring_prep_msg(pkt_q->uring, pkt_q->sockfd,
+						 true, msg);
+			mbufs[nb++] = mbuf;
+		}
+
+		ret = uring_submit(pkt_q->uring, res);
+		for (n = 0; n < nb; n++) {
+			if (ret >= 0 && res[n] == (int)mbufs[n]->pkt_len) {
+				num_tx++;
+				num_tx_bytes += mbufs[n]->pkt_len;
+			}
+			rte_pktmbuf_free(mbufs[n]);
+		}
+	}
+
+	pkt_q->tx_pkts += num_tx;
+	pkt_q->err_pkts += nb_pkts - num_tx;
+	pkt_q->tx_bytes += num_tx_bytes;
+	return nb_pkts;
+}
+
 static int
 eth_dev_start(struct rte_eth_dev *dev)
 {
@@ -318,7 +602,8 @@ static int
 eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 {
 	unsigned i, imax;
-	unsigned long rx_total = 0, tx_total = 0, tx_err_total = 0;
+	unsigned long rx_total = 0, rx_err_total = 0;
+	unsigned long tx_total = 0, tx_err_total = 0;
 	unsigned long rx_bytes_total = 0, tx_bytes_total = 0;
 	const struct pmd_internals *internal = dev->data->dev_private;
 
@@ -328,6 +613,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 		igb_stats->q_ipackets[i] = internal->rx_queue[i].rx_pkts;
 		igb_stats->q_ibytes[i] = internal->rx_queue[i].rx_bytes;
 		rx_total += igb_stats->q_ipackets[i];
+		rx_err_total += internal->rx_queue[i].err_pkts;
 		rx_bytes_total += igb_stats->q_ibytes[i];
 	}
 
@@ -343,6 +629,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *igb_stats)
 
 	igb_stats->ipackets = rx_total;
 	igb_stats->ibytes = rx_bytes_total;
+	igb_stats->ierrors = rx_err_total;
 	igb_stats->opackets = tx_total;
 	igb_stats->oerrors = tx_err_total;
 	igb_stats->obytes = tx_bytes_total;
@@ -358,6 +645,7 @@ eth_stats_reset(struct rte_eth_dev *dev)
 	for (i = 0; i < internal->nb_queues; i++) {
 		internal->rx_queue[i].rx_pkts = 0;
 		internal->rx_queue[i].rx_bytes = 0;
+		internal->rx_queue[i].err_pkts = 0;
 	}
 
 	for (i = 0; i < internal->nb_queues; i++) {
@@ -402,9 +690,10 @@ eth_rx_queue_setup(struct rte_eth_dev *dev,
 	buf_size = rte_pktmbuf_data_room_size(pkt_q->mb_pool) -
 		RTE_PKTMBUF_HEADROOM;
 	data_size = internals->req.tp_frame_size;
-	data_size -= TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
+	data_size -= internals->tp_hdrlen - sizeof(struct sockaddr_ll);
 
-	if (data_size > buf_size) {
+	/* packets larger than the mbufs are dropped in io_uring mode */
+	if (data_size > buf_size && !internals->io_uring) {
 		PMD_LOG(ERR,
 			"%s: %d bytes will not fit in mbuf (%d bytes)",
 			dev->device->name, data_size, buf_size);
@@ -439,7 +728,7 @@ eth_dev_mtu_set(struct rte_eth_dev *dev, uint16_t mtu)
 	int ret;
 	int s;
 	unsigned int data_size = internals->req.tp_frame_size -
-				 TPACKET2_HDRLEN;
+				 internals->tp_hdrlen;
 
 	if (mtu > data_size)
 		return -EINVAL;
@@ -533,6 +822,141 @@ open_packet_iface(const char *key __rte_unused,
 	return 0;
 }
 
+/*
+ * Sets up the PACKET_MMAP Rx and Tx rings of a queue pair socket
+ */
+static int
+setup_packet_mmap(struct pmd_internals *internals,
+		  struct pkt_rx_queue *rx_queue,
+		  struct pkt_tx_queue *tx_queue, int qsockfd,
+		  unsigned int numa_node, const char *name, const char *iface)
+{
+	struct tpacket_req3 *req = &internals->req;
+	int tpver = internals->tpver;
+	unsigned int i, rdsize;
+	int rc;
+
+	/* only the Rx blocks are retired on timeout */
+	if (tpver == TPACKET_V3)
+		req->tp_retire_blk_tov = DFLT_BLOCK_TOV;
+	rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
+	req->tp_retire_blk_tov = 0;
+	if (rc == -1) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: could not set PACKET_RX_RING on AF_PACKET socket for %s",
+			name, iface);
+		return -1;
+	}
+
+	rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
+	if (rc == -1 && tpver == TPACKET_V3 && errno == EINVAL) {
+		/* kernels before 4.11 only have TPACKET_V3 Rx rings */
+		PMD_LOG(ERR,
+			"%s: TPACKET_V3 PACKET_TX_RING rejected on AF_PACKET socket for %s, it needs Linux 4.11 or later: use tpacket_v3=0",
+			name, iface);
+		return -1;
+	}
+	if (rc == -1) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: could not set PACKET_TX_RING on AF_PACKET "
+			"socket for %s", name, iface);
+		return -1;
+	}
+
+	/* TPACKET_V3 descriptors point to the Rx blocks */
+	if (tpver == TPACKET_V3)
+		rx_queue->framecount = req->tp_block_nr;
+	else
+		rx_queue->framecount = req->tp_frame_nr;
+
+	rx_queue->map = mmap(NULL, 2 * req->tp_block_size * req->tp_block_nr,
+			    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
+			    qsockfd, 0);
+	if (rx_queue->map == MAP_FAILED) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: call to mmap failed on AF_PACKET socket for %s",
+			name, iface);
+		return -1;
+	}
+
+	/* rdsize is same for both Tx and Rx */
+	rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
+
+	rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
+	if (rx_queue->rd == NULL)
+		return -1;
+	if (tpver == TPACKET_V3) {
+		for (i = 0; i < req->tp_block_nr; ++i) {
+			rx_queue->rd[i].iov_base = rx_queue->map +
+				(i * req->tp_block_size);
+			rx_queue->rd[i].iov_len = req->tp_block_size;
+		}
+	} else {
+		for (i = 0; i < req->tp_frame_nr; ++i) {
+			rx_queue->rd[i].iov_base = rx_queue->map +
+				(i * req->tp_frame_size);
+			rx_queue->rd[i].iov_len = req->tp_frame_size;
+		}
+	}
+
+	tx_queue->framecount = req->tp_frame_nr;
+	tx_queue->frame_data_size = req->tp_frame_size;
+	tx_queue->frame_data_size -= internals->tp_hdrlen -
+		sizeof(struct sockaddr_ll);
+
+	tx_queue->map = rx_queue->map + req->tp_block_size * req->tp_block_nr;
+
+	tx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
+	if (tx_queue->rd == NULL)
+		return -1;
+	for (i = 0; i < req->tp_frame_nr; ++i) {
+		tx_queue->rd[i].iov_base = tx_queue->map +
+			(i * req->tp_frame_size);
+		tx_queue->rd[i].iov_len = req->tp_frame_size;
+	}
+
+	return 0;
+}
+
+/*
+ * Sets up the io_uring instances of a queue pair socket, which has no
+ * PACKET_MMAP ring
+ */
+static int
+setup_packet_uring(struct pkt_rx_queue *rx_queue,
+		   struct pkt_tx_queue *tx_queue,
+		   int qsockfd, const char *name, const char *iface)
+{
+	int auxdata = 1;
+
+	/* get the stripped VLAN tags along with the packets */
+	if (setsockopt(qsockfd, SOL_PACKET, PACKET_AUXDATA,
+		       &auxdata, sizeof(auxdata)) == -1) {
+		PMD_LOG_ERRNO(ERR,
+			"%s: could not set PACKET_AUXDATA on AF_PACKET socket for %s",
+			name, iface);
+		return -1;
+	}
+
+#ifndef HAVE_IO_URING_MSG
+	errno = ENOTSUP;
+	goto error;
+#endif
+	rx_queue->uring = uring_create(AF_PACKET_URING_BURST);
+	if (rx_queue->uring == NULL)
+		goto error;
+	tx_queue->uring = uring_create(AF_PACKET_URING_BURST);
+	if (tx_queue->uring == NULL)
+		goto error;
+	return 0;
+
+error:
+	/* io_uring recvmsg() and sendmsg() need Linux 5.3 or later */
+	PMD_LOG_ERRNO(ERR, "%s: could not create io_uring for %s",
+		name, iface);
+	return -1;
+}
+
 static int
 rte_pmd_init_internals(struct rte_vdev_device *dev,
                        const int sockfd,
@@ -542,6 +966,8 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
                        unsigned int framesize,
                        unsigned int framecnt,
 		       unsigned int qdisc_bypass,
+		       unsigned int tpacket_v3,
+		       unsigned int io_uring,
                        struct pmd_internals **internals,
                        struct rte_eth_dev **eth_dev,
                        struct rte_kvargs *kvlist)
@@ -554,12 +980,12 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	size_t ifnamelen;
 	unsigned k_idx;
 	struct sockaddr_ll sockaddr;
-	struct tpacket_req *req;
+	struct tpacket_req3 *req;
 	struct pkt_rx_queue *rx_queue;
 	struct pkt_tx_queue *tx_queue;
 	int rc, tpver, discard;
 	int qsockfd = -1;
-	unsigned int i, q, rdsize;
+	unsigned int q;
 #if defined(PACKET_FANOUT)
 	int fanout_arg;
 #endif
@@ -597,6 +1023,15 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 	req->tp_frame_size = framesize;
 	req->tp_frame_nr = framecnt;
 
+	if (tpacket_v3) {
+		(*internals)->tpver = TPACKET_V3;
+		(*internals)->tp_hdrlen = TPACKET3_HDRLEN;
+	} else {
+		(*internals)->tpver = TPACKET_V2;
+		(*internals)->tp_hdrlen = TPACKET2_HDRLEN;
+	}
+	(*internals)->io_uring = io_uring;
+
 	ifnamelen = strlen(pair->value);
 	if (ifnamelen < sizeof(ifr.ifr_name)) {
 		memcpy(ifr.ifr_name, pair->value, ifnamelen);
@@ -645,7 +1080,7 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 			return -1;
 		}
 
-		tpver = TPACKET_V2;
+		tpver = (*internals)->tpver;
 		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_VERSION,
 				&tpver, sizeof(tpver));
 		if (rc == -1) {
@@ -678,62 +1113,18 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 		RTE_SET_USED(qdisc_bypass);
 #endif
 
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_RX_RING, req, sizeof(*req));
-		if (rc == -1) {
-			PMD_LOG_ERRNO(ERR,
-				"%s: could not set PACKET_RX_RING on AF_PACKET socket for %s",
-				name, pair->value);
-			goto error;
-		}
-
-		rc = setsockopt(qsockfd, SOL_PACKET, PACKET_TX_RING, req, sizeof(*req));
-		if (rc == -1) {
-			PMD_LOG_ERRNO(ERR,
-				"%s: could not set PACKET_TX_RING on AF_PACKET "
-				"socket for %s", name, pair->value);
-			goto error;
-		}
-
 		rx_queue = &((*internals)->rx_queue[q]);
-		rx_queue->framecount = req->tp_frame_nr;
-
-		rx_queue->map = mmap(NULL, 2 * req->tp_block_size * req->tp_block_nr,
-				    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED,
-				    qsockfd, 0);
-		if (rx_queue->map == MAP_FAILED) {
-			PMD_LOG_ERRNO(ERR,
-				"%s: call to mmap failed on AF_PACKET socket for %s",
-				name, pair->value);
-			goto error;
-		}
-
-		/* rdsize is same for both Tx and Rx */
-		rdsize = req->tp_frame_nr * sizeof(*(rx_queue->rd));
-
-		rx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
-		if (rx_queue->rd == NULL)
-			goto error;
-		for (i = 0; i < req->tp_frame_nr; ++i) {
-			rx_queue->rd[i].iov_base = rx_queue->map + (i * framesize);
-			rx_queue->rd[i].iov_len = req->tp_frame_size;
-		}
-		rx_queue->sockfd = qsockfd;
-
 		tx_queue = &((*internals)->tx_queue[q]);
-		tx_queue->framecount = req->tp_frame_nr;
-		tx_queue->frame_data_size = req->tp_frame_size;
-		tx_queue->frame_data_size -= TPACKET2_HDRLEN -
-			sizeof(struct sockaddr_ll);
-
-		tx_queue->map = rx_queue->map + req->tp_block_size * req->tp_block_nr;
-
-		tx_queue->rd = rte_zmalloc_socket(name, rdsize, 0, numa_node);
-		if (tx_queue->rd == NULL)
+		if (io_uring)
+			rc = setup_packet_uring(rx_queue, tx_queue, qsockfd,
+						name, pair->value);
+		else
+			rc = setup_packet_mmap(*internals, rx_queue, tx_queue,
+					       qsockfd, numa_node, name,
+					       pair->value);
+		if (rc == -1)
 			goto error;
-		for (i = 0; i < req->tp_frame_nr; ++i) {
-			tx_queue->rd[i].iov_base = tx_queue->map + (i * framesize);
-			tx_queue->rd[i].iov_len = req->tp_frame_size;
-		}
+		rx_queue->sockfd = qsockfd;
 		tx_queue->sockfd = qsockfd;
 
 		rc = bind(qsockfd, (const struct sockaddr*)&sockaddr, sizeof(sockaddr));
@@ -791,6 +1182,8 @@ rte_pmd_init_internals(struct rte_vdev_device *dev,
 
 		rte_free((*internals)->rx_queue[q].rd);
 		rte_free((*internals)->tx_queue[q].rd);
+		uring_destroy((*internals)->rx_queue[q].uring);
+		uring_destroy((*internals)->tx_queue[q].uring);
 		if (((*internals)->rx_queue[q].sockfd != 0) &&
 			((*internals)->rx_queue[q].sockfd != qsockfd))
 			close((*internals)->rx_queue[q].sockfd);
@@ -816,6 +1209,8 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	unsigned int framecount = DFLT_FRAME_COUNT;
 	unsigned int qpairs = 1;
 	unsigned int qdisc_bypass = 1;
+	unsigned int tpacket_v3 = 0;
+	unsigned int io_uring = 0;
 
 	/* do some parameter checking */
 	if (*sockfd < 0)
@@ -879,6 +1274,33 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 			}
 			continue;
 		}
+		if (strstr(pair->key, ETH_AF_PACKET_TPACKET_V3_ARG) != NULL) {
+			tpacket_v3 = atoi(pair->value);
+			if (tpacket_v3 > 1) {
+				PMD_LOG(ERR,
+					"%s: invalid tpacket_v3 value",
+					name);
+				return -1;
+			}
+			continue;
+		}
+		if (strstr(pair->key, ETH_AF_PACKET_IO_URING_ARG) != NULL) {
+			io_uring = atoi(pair->value);
+			if (io_uring > 1) {
+				PMD_LOG(ERR,
+					"%s: invalid io_uring value",
+					name);
+				return -1;
+			}
+			continue;
+		}
+	}
+
+	if (io_uring && tpacket_v3) {
+		PMD_LOG(ERR,
+			"%s: io_uring mode has no PACKET_MMAP ring, tpacket_v3 is not supported",
+			name);
+		return -1;
 	}
 
 	if (framesize > blocksize) {
@@ -900,17 +1322,27 @@ rte_eth_from_packet(struct rte_vdev_device *dev,
 	PMD_LOG(INFO, "%s:\tblock count %d", name, blockcount);
 	PMD_LOG(INFO, "%s:\tframe size %d", name, framesize);
 	PMD_LOG(INFO, "%s:\tframe count %d", name, framecount);
+	PMD_LOG(INFO, "%s:\tTPACKET version %d", name, tpacket_v3 ? 3 : 2);
+	PMD_LOG(INFO, "%s:\tio_uring %s", name, io_uring ? "on" : "off");
 
 	if (rte_pmd_init_internals(dev, *sockfd, qpairs,
 				   blocksize, blockcount,
 				   framesize, framecount,
-				   qdisc_bypass,
+				   qdisc_bypass, tpacket_v3, io_uring,
 				   &internals, &eth_dev,
 				   kvlist) < 0)
 		return -1;
 
-	eth_dev->rx_pkt_burst = eth_af_packet_rx;
-	eth_dev->tx_pkt_burst = eth_af_packet_tx;
+	if (io_uring) {
+		eth_dev->rx_pkt_burst = eth_af_packet_rx_uring;
+		eth_dev->tx_pkt_burst = eth_af_packet_tx_uring;
+	} else if (tpacket_v3) {
+		eth_dev->rx_pkt_burst = eth_af_packet_rx_v3;
+		eth_dev->tx_pkt_burst = eth_af_packet_tx_v3;
+	} else {
+		eth_dev->rx_pkt_burst = eth_af_packet_rx;
+		eth_dev->tx_pkt_burst = eth_af_packet_tx;
+	}
 
 	rte_eth_dev_probing_finish(eth_dev);
 	return 0;
@@ -974,7 +1406,7 @@ rte_pmd_af_packet_remove(struct rte_vdev_device *dev)
 {
 	struct rte_eth_dev *eth_dev = NULL;
 	struct pmd_internals *internals;
-	struct tpacket_req *req;
+	struct tpacket_req3 *req;
 	unsigned q;
 
 	PMD_LOG(INFO, "Closing AF_PACKET ethdev on numa socket %u",
@@ -997,10 +1429,13 @@ rte_pmd_af_packet_remove(struct rte_vdev_device *dev)
 	internals = eth_dev->data->dev_private;
 	req = &internals->req;
 	for (q = 0; q < internals->nb_queues; q++) {
-		munmap(internals->rx_queue[q].map,
-			2 * req->tp_block_size * req->tp_block_nr);
+		if (internals->rx_queue[q].map != MAP_FAILED)
+			munmap(internals->rx_queue[q].map,
+				2 * req->tp_block_size * req->tp_block_nr);
 		rte_free(internals->rx_queue[q].rd);
 		rte_free(internals->tx_queue[q].rd);
+		uring_destroy(internals->rx_queue[q].uring);
+		uring_destroy(internals->tx_queue[q].uring);
 	}
 	free(internals->if_name);
 
@@ -1022,7 +1457,9 @@ RTE_PMD_REGISTER_PARAM_STRING(net_af_packet,
 	"blocksz=<int> "
 	"framesz=<int> "
 	"framecnt=<int> "
-	"qdisc_bypass=<0|1>");
+	"qdisc_bypass=<0|1> "
+	"tpacket_v3=<0|1> "
+	"io_uring=<0|1>");
 
 RTE_INIT(af_packet_init_log)
 {
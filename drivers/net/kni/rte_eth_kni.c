@@ -50,6 +50,7 @@ struct pmd_internals {
 	int is_kni_started;
 
 	pthread_t thread;
+	int is_thread_started;
 	int stop_thread;
 	int no_request_thread;
 
@@ -164,6 +165,7 @@ eth_kni_dev_start(struct rte_eth_dev *dev)
 				"Fail to create kni request thread");
 			return -1;
 		}
+		internals->is_thread_started = 1;
 	}
 
 	dev->data->dev_link.link_status = 1;
@@ -177,7 +179,8 @@ eth_kni_dev_stop(struct rte_eth_dev *dev)
 	struct pmd_internals *internals = dev->data->dev_private;
 	int ret;
 
-	if (internals->no_request_thread == 0) {
+	/* The thread is not created if the port did not start */
+	if (internals->is_thread_started) {
 		internals->stop_thread = 1;
 
 		ret = pthread_cancel(internals->thread);
@@ -189,6 +192,7 @@ eth_kni_dev_stop(struct rte_eth_dev *dev)
 			PMD_LOG(ERR, "Can't join the thread");
 
 		internals->stop_thread = 0;
+		internals->is_thread_started = 0;
 	}
 
 	dev->data->dev_link.link_status = 0;
@@ -521,6 +521,31 @@ memif_intr_unregister_handler(struct rte_intr_handle *intr_handle, void *arg)
 	rte_free(cc);
 }
 
+void
+memif_intr_unregister_sync(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *pmd = dev->data->dev_private;
+	struct memif_control_channel *cc;
+	struct rte_intr_handle ih;
+
+	rte_spinlock_lock(&pmd->cc_lock);
+	cc = pmd->cc;
+	if (cc != NULL)
+		ih = cc->intr_handle;
+	rte_spinlock_unlock(&pmd->cc_lock);
+	if (cc == NULL || ih.fd <= 0)
+		return;
+
+	/*
+	 * The interrupt source is looked up by fd only, cc is not accessed:
+	 * it is freed by memif_intr_unregister_handler() once the interrupt
+	 * thread disconnected the device.
+	 */
+	while (rte_intr_callback_unregister(&ih, memif_intr_handler, cc) ==
+			-EAGAIN)
+		rte_pause();
+}
+
 void
 memif_disconnect(struct rte_eth_dev *dev)
 {
@@ -568,11 +593,15 @@ memif_disconnect(struct rte_eth_dev *dev)
 							memif_intr_handler,
 							pmd->cc,
 							memif_intr_unregister_handler);
-			} else if (ret > 0) {
+			} else if (ret > 0 || ret == -ENOENT) {
+				/* removed here or by memif_intr_unregister_sync() */
 				close(ih->fd);
 				rte_free(pmd->cc);
+				ret = 1;
 			}
+			rte_spinlock_lock(&pmd->cc_lock);
 			pmd->cc = NULL;
+			rte_spinlock_unlock(&pmd->cc_lock);
 			if (ret <= 0)
 				MIF_LOG(WARNING,
 					"Failed to unregister control channel callback.");
@@ -615,6 +644,24 @@ memif_disconnect(struct rte_eth_dev *dev)
 		}
 	}
 
+	/* free the mbufs still referenced by the zero-copy rings */
+	if (pmd->role == MEMIF_ROLE_SLAVE &&
+	    (pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY) &&
+	    rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		for (i = 0; i < pmd->run.num_s2m_rings; i++) {
+			if (dev->data->tx_queues == NULL)
+				break;
+			memif_free_stored_mbufs(proc_private,
+						dev->data->tx_queues[i]);
+		}
+		for (i = 0; i < pmd->run.num_m2s_rings; i++) {
+			if (dev->data->rx_queues == NULL)
+				break;
+			memif_free_stored_mbufs(proc_private,
+						dev->data->rx_queues[i]);
+		}
+	}
+
 	memif_free_regions(proc_private);
 
 	/* reset connection configuration */
@@ -860,16 +907,12 @@ memif_listener_handler(void *arg)
 		rte_free(cc);
 }
 
-#define MEMIF_SOCKET_UN_SIZE	\
-	(offsetof(struct sockaddr_un, sun_path) + MEMIF_SOCKET_KEY_LEN)
-
 static struct memif_socket *
 memif_socket_create(struct pmd_internals *pmd,
 		    const char *key, uint8_t listener)
 {
 	struct memif_socket *sock;
-	struct sockaddr_un *un;
-	char un_buf[MEMIF_SOCKET_UN_SIZE];
+	struct sockaddr_un un;
 	int sockfd;
 	int ret;
 	int on = 1;
@@ -889,16 +932,15 @@ memif_socket_create(struct pmd_internals *pmd,
 		if (sockfd < 0)
 			goto error;
 
-		memset(un_buf, 0, sizeof(un_buf));
-		un = (struct sockaddr_un *)un_buf;
-		un->sun_family = AF_UNIX;
-		strlcpy(un->sun_path, sock->filename, MEMIF_SOCKET_KEY_LEN);
+		memset(&un, 0, sizeof(un));
+		un.sun_family = AF_UNIX;
+		strlcpy(un.sun_path, sock->filename, sizeof(un.sun_path));
 
 		ret = setsockopt(sockfd, SOL_SOCKET, SO_PASSCRED, &on,
 				 sizeof(on));
 		if (ret < 0)
 			goto error;
-		ret = bind(sockfd, (struct sockaddr *)un, MEMIF_SOCKET_UN_SIZE);
+		ret = bind(sockfd, (struct sockaddr *)&un, sizeof(un));
 		if (ret < 0)
 			goto error;
 		ret = listen(sockfd, 1);
@@ -50,6 +50,17 @@ int memif_socket_init(struct rte_eth_dev *dev, const char *socket_filename);
  */
 void memif_disconnect(struct rte_eth_dev *dev);
 
+/**
+ * Wait for the interrupt thread to be done with the control channel and
+ * remove its callback, so that the device can be disconnected from another
+ * thread. If the interrupt thread disconnected the device meanwhile, the
+ * control channel is released.
+ *
+ * @param dev
+ *   memif device
+ */
+void memif_intr_unregister_sync(struct rte_eth_dev *dev);
+
 /**
  * If device is properly configured, enable connection establishment.
  *
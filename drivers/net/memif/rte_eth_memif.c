@@ -22,6 +22,7 @@
 #include <rte_malloc.h>
 #include <rte_kvargs.h>
 #include <rte_bus_vdev.h>
+#include <rte_eal_memconfig.h>
 #include <rte_string_fns.h>
 
 #include "rte_eth_memif.h"
@@ -61,6 +62,7 @@ struct mp_region_msg {
 	char port_name[RTE_DEV_NAME_MAX_LEN];
 	memif_region_index_t idx;
 	memif_region_size_t size;
+	void *addr; /* address of a zero-copy region, shared with EAL memory */
 };
 
 static int
@@ -89,6 +91,9 @@ memif_mp_send_region(const struct rte_mp_msg *msg, const void *peer)
 	reply_param->idx = msg_param->idx;
 	if (proc_private->regions[msg_param->idx] != NULL) {
 		reply_param->size = proc_private->regions[msg_param->idx]->region_size;
+		if (proc_private->regions[msg_param->idx]->is_external)
+			reply_param->addr =
+				proc_private->regions[msg_param->idx]->addr;
 		reply.fds[0] = proc_private->regions[msg_param->idx]->fd;
 		reply.num_fds = 1;
 	}
@@ -153,7 +158,9 @@ memif_mp_request_regions(struct rte_eth_dev *dev)
 				return -1;
 			}
 			r->fd = reply->fds[0];
-			r->addr = NULL;
+			/* EAL memory is mapped at the same address */
+			r->addr = reply_param->addr;
+			r->is_external = r->addr != NULL;
 
 			proc_private->regions[reply_param->idx] = r;
 			proc_private->regions_num++;
@@ -289,13 +296,13 @@ eth_memif_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			goto no_free_bufs;
 		mbuf = mbuf_head;
 		mbuf->port = mq->in_port;
+		dst_off = 0;
 
 next_slot:
 		s0 = cur_slot & mask;
 		d0 = &ring->desc[s0];
 
 		src_len = d0->length;
-		dst_off = 0;
 		src_off = 0;
 
 		do {
@@ -418,6 +425,8 @@ eth_memif_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		dst_off = 0;
 		dst_len = (type == MEMIF_RING_S2M) ?
 			pmd->run.pkt_buffer_size : d0->length;
+		d0->flags = 0;
+		n_free--;
 
 next_in_chain:
 		src_off = 0;
@@ -454,14 +463,13 @@ eth_memif_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			d0->length = dst_off;
 		}
 
-		if (rte_pktmbuf_is_contiguous(mbuf) == 0) {
+		if (mbuf->next != NULL) {
 			mbuf = mbuf->next;
 			goto next_in_chain;
 		}
 
 		n_tx_pkts++;
 		slot++;
-		n_free--;
 		rte_pktmbuf_free(mbuf_head);
 	}
 
@@ -485,6 +493,294 @@ eth_memif_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return n_tx_pkts;
 }
 
+/*
+ * Point a descriptor to a buffer of the EAL memory exported in zero-copy
+ * mode. Region 0 only holds the rings. Each region is a memory segment,
+ * mapped on its own by the master: return the number of bytes of the
+ * buffer in the region of its start, or -1 if it is not exported.
+ */
+static inline int
+memif_set_zc_buffer(struct pmd_process_private *proc_private,
+		    memif_desc_t *d, void *addr, uint32_t len)
+{
+	struct memif_region *r;
+	memif_region_index_t i;
+	uintptr_t offset;
+
+	for (i = 1; i < proc_private->regions_num; i++) {
+		r = proc_private->regions[i];
+		offset = (uintptr_t)addr - (uintptr_t)r->addr;
+		if ((uintptr_t)addr >= (uintptr_t)r->addr &&
+		    offset < r->region_size) {
+			d->region = i;
+			d->offset = offset;
+			return RTE_MIN(len, r->region_size - offset);
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Zero-copy slave Rx: the master copies the packets directly into the
+ * mbufs posted on the ring.
+ */
+static uint16_t
+eth_memif_rx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct memif_queue *mq = queue;
+	struct pmd_internals *pmd = rte_eth_devices[mq->in_port].data->dev_private;
+	struct pmd_process_private *proc_private =
+		rte_eth_devices[mq->in_port].process_private;
+	memif_ring_t *ring = memif_get_ring_from_queue(proc_private, mq);
+	uint16_t cur_slot, last_slot, n_slots, ring_size, mask, s0;
+	uint16_t n_rx_pkts = 0;
+	uint16_t mbuf_size = rte_pktmbuf_data_room_size(mq->mempool) -
+		RTE_PKTMBUF_HEADROOM;
+	memif_desc_t *d0;
+	struct rte_mbuf *mbuf, *mbuf_head;
+	uint64_t b;
+	ssize_t size __rte_unused;
+	uint16_t head, n, i;
+	int len;
+	struct rte_eth_link link;
+
+	if (unlikely((pmd->flags & ETH_MEMIF_FLAG_CONNECTED) == 0))
+		return 0;
+	if (unlikely(ring == NULL)) {
+		/* Secondary process will attempt to request regions. */
+		rte_eth_link_get(mq->in_port, &link);
+		return 0;
+	}
+
+	/* consume interrupt */
+	if ((ring->flags & MEMIF_RING_FLAG_MASK_INT) == 0)
+		size = read(mq->intr_handle.fd, &b, sizeof(b));
+
+	ring_size = 1 << mq->log2_ring_size;
+	mask = ring_size - 1;
+
+	cur_slot = mq->last_tail;
+	last_slot = ring->tail;
+	if (cur_slot == last_slot)
+		goto refill;
+	n_slots = last_slot - cur_slot;
+
+	/* the descriptors are written before the tail */
+	rte_smp_rmb();
+
+	while (n_slots && n_rx_pkts < nb_pkts) {
+		/* a packet is received once all its descriptors are */
+		for (n = 0; n < n_slots; n++)
+			if ((ring->desc[(cur_slot + n) & mask].flags &
+			     MEMIF_DESC_FLAG_NEXT) == 0)
+				break;
+		if (unlikely(n == n_slots))
+			break;
+
+		s0 = cur_slot & mask;
+		d0 = &ring->desc[s0];
+		mbuf_head = mq->buffers[s0];
+		mbuf = mbuf_head;
+		mbuf->port = mq->in_port;
+		rte_pktmbuf_data_len(mbuf) = d0->length;
+		rte_pktmbuf_pkt_len(mbuf) = d0->length;
+		cur_slot++;
+		n_slots--;
+
+		for (; n > 0; n--) {
+			s0 = cur_slot & mask;
+			d0 = &ring->desc[s0];
+			mbuf->next = mq->buffers[s0];
+			mbuf = mbuf->next;
+			rte_pktmbuf_data_len(mbuf) = d0->length;
+			rte_pktmbuf_pkt_len(mbuf_head) += d0->length;
+			mbuf_head->nb_segs++;
+			cur_slot++;
+			n_slots--;
+		}
+
+		mq->n_bytes += rte_pktmbuf_pkt_len(mbuf_head);
+		*bufs++ = mbuf_head;
+		n_rx_pkts++;
+	}
+
+	mq->last_tail = cur_slot;
+
+refill:
+	/* post new mbufs in place of the received ones */
+	head = ring->head;
+	n_slots = ring_size - head + mq->last_tail;
+
+	while (n_slots) {
+		s0 = head & mask;
+		n = RTE_MIN(n_slots, (uint16_t)(ring_size - s0));
+		if (unlikely(rte_pktmbuf_alloc_bulk(mq->mempool,
+						    &mq->buffers[s0], n) < 0))
+			break;
+
+		for (i = 0; i < n; i++) {
+			/* the buffer is cut at the end of its region */
+			d0 = &ring->desc[s0 + i];
+			len = memif_set_zc_buffer(proc_private, d0,
+					rte_pktmbuf_mtod(mq->buffers[s0 + i],
+							 void *), mbuf_size);
+			if (unlikely(len < 0))
+				break;
+			d0->length = len;
+			d0->flags = 0;
+		}
+		head += i;
+		n_slots -= i;
+
+		if (unlikely(i < n)) {
+			/* mbuf out of the memory exported at connection */
+			for (; i < n; i++)
+				rte_pktmbuf_free(mq->buffers[s0 + i]);
+			break;
+		}
+	}
+
+	rte_smp_wmb();
+	ring->head = head;
+
+	mq->n_pkts += n_rx_pkts;
+	return n_rx_pkts;
+}
+
+/*
+ * Zero-copy slave Tx: the descriptors point to the mbuf data, the mbufs
+ * are freed once the master has consumed them.
+ */
+static uint16_t
+eth_memif_tx_zc(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct memif_queue *mq = queue;
+	struct pmd_internals *pmd = rte_eth_devices[mq->in_port].data->dev_private;
+	struct pmd_process_private *proc_private =
+		rte_eth_devices[mq->in_port].process_private;
+	memif_ring_t *ring = memif_get_ring_from_queue(proc_private, mq);
+	uint16_t slot, saved_slot, n_free, ring_size, mask, n_tx_pkts = 0;
+	uint16_t n_sent = 0;
+	memif_desc_t *d0 = NULL;
+	struct rte_mbuf *mbuf;
+	struct rte_mbuf *mbuf_head;
+	uint8_t *data;
+	uint32_t data_len;
+	int len;
+	uint64_t a;
+	ssize_t size;
+	struct rte_eth_link link;
+
+	if (unlikely((pmd->flags & ETH_MEMIF_FLAG_CONNECTED) == 0))
+		return 0;
+	if (unlikely(ring == NULL)) {
+		/* Secondary process will attempt to request regions. */
+		rte_eth_link_get(mq->in_port, &link);
+		return 0;
+	}
+
+	ring_size = 1 << mq->log2_ring_size;
+	mask = ring_size - 1;
+
+	/* free the mbufs consumed by the master */
+	slot = ring->tail;
+	while (mq->last_tail != slot) {
+		mbuf = mq->buffers[mq->last_tail & mask];
+		if (mbuf != NULL)
+			rte_pktmbuf_free_seg(mbuf);
+		mq->last_tail++;
+	}
+
+	slot = ring->head;
+	n_free = ring_size - slot + mq->last_tail;
+
+	while (n_tx_pkts < nb_pkts) {
+		mbuf_head = bufs[n_tx_pkts];
+		saved_slot = slot;
+		mbuf = mbuf_head;
+		len = 0;
+		do {
+			/*
+			 * A segment spanning two memory segments takes a
+			 * descriptor in each, the mbuf is freed with the
+			 * last one.
+			 */
+			data = rte_pktmbuf_mtod(mbuf, uint8_t *);
+			data_len = rte_pktmbuf_data_len(mbuf);
+			do {
+				if ((uint16_t)(slot - saved_slot) == n_free) {
+					slot = saved_slot;
+					goto no_free_slots;
+				}
+				d0 = &ring->desc[slot & mask];
+				len = memif_set_zc_buffer(proc_private, d0,
+							  data, data_len);
+				if (unlikely(len < 0))
+					break;
+				d0->length = len;
+				d0->flags = MEMIF_DESC_FLAG_NEXT;
+				mq->buffers[slot & mask] = NULL;
+				slot++;
+				data += len;
+				data_len -= len;
+			} while (data_len > 0);
+			if (unlikely(len < 0))
+				break;
+			mq->buffers[(slot - 1) & mask] = mbuf;
+			mbuf = mbuf->next;
+		} while (mbuf != NULL);
+
+		n_tx_pkts++;
+		if (unlikely(len < 0)) {
+			/* mbuf out of the memory exported at connection */
+			slot = saved_slot;
+			rte_pktmbuf_free(mbuf_head);
+			continue;
+		}
+
+		d0->flags = 0;
+		n_free -= slot - saved_slot;
+		mq->n_bytes += rte_pktmbuf_pkt_len(mbuf_head);
+		n_sent++;
+	}
+
+no_free_slots:
+	rte_smp_wmb();
+	ring->head = slot;
+
+	if ((ring->flags & MEMIF_RING_FLAG_MASK_INT) == 0) {
+		a = 1;
+		size = write(mq->intr_handle.fd, &a, sizeof(a));
+		if (unlikely(size < 0)) {
+			MIF_LOG(WARNING,
+				"Failed to send interrupt. %s", strerror(errno));
+		}
+	}
+
+	mq->n_pkts += n_sent;
+	return n_tx_pkts;
+}
+
+void
+memif_free_stored_mbufs(struct pmd_process_private *proc_private,
+			struct memif_queue *mq)
+{
+	memif_ring_t *ring = memif_get_ring_from_queue(proc_private, mq);
+	uint16_t mask = (1 << mq->log2_ring_size) - 1;
+
+	if (mq->buffers == NULL || ring == NULL)
+		return;
+
+	/* the slave posted the slots up to the head */
+	while (mq->last_tail != ring->head) {
+		/* no mbuf in the first slots of a split Tx segment */
+		if (mq->buffers[mq->last_tail & mask] != NULL)
+			rte_pktmbuf_free_seg(mq->buffers[mq->last_tail & mask]);
+		mq->last_tail++;
+	}
+}
+
 void
 memif_free_regions(struct pmd_process_private *proc_private)
 {
@@ -499,7 +795,8 @@ memif_free_regions(struct pmd_process_private *proc_private)
 		r = proc_private->regions[i];
 		if (r != NULL) {
 			if (r->addr != NULL) {
-				munmap(r->addr, r->region_size);
+				if (!r->is_external)
+					munmap(r->addr, r->region_size);
 				if (r->fd > 0) {
 					close(r->fd);
 					r->fd = -1;
@@ -589,10 +886,135 @@ memif_region_init_shm(struct rte_eth_dev *dev, uint8_t has_buffers)
 	return ret;
 }
 
+/*
+ * Export a memseg as a zero-copy region. A region maps a file of the EAL
+ * memory from its start, as the memif protocol has no file offset: only
+ * memsegs at the start of their file can be exported, or the memory
+ * placed before them would be shared with the master as well.
+ * Called with the memory hotplug lock held.
+ */
 static int
-memif_regions_init(struct rte_eth_dev *dev)
+memif_region_add_zc(struct pmd_process_private *proc_private,
+		    const struct rte_memseg *ms)
 {
+	struct memif_region *r;
+	memif_region_index_t i;
+	size_t offset;
+	int fd;
+
+	fd = rte_memseg_get_fd_thread_unsafe(ms);
+	if (fd < 0 || rte_memseg_get_fd_offset_thread_unsafe(ms, &offset) < 0) {
+		MIF_LOG(ERR, "Zero-copy needs file backed memory: %s.",
+			rte_strerror(rte_errno));
+		return -1;
+	}
+	if (offset != 0) {
+		MIF_LOG(ERR, "Zero-copy can't export a part of a memory file, "
+			"don't use --single-file-segments.");
+		return -1;
+	}
+	if (ms->len > UINT32_MAX) {
+		MIF_LOG(ERR, "Memory out of the memif offset range.");
+		return -1;
+	}
+
+	/* the memseg backs several mempool chunks */
+	for (i = 1; i < proc_private->regions_num; i++)
+		if (proc_private->regions[i]->addr == ms->addr)
+			return 0;
+
+	if (proc_private->regions_num >= ETH_MEMIF_MAX_REGION_NUM) {
+		MIF_LOG(ERR, "Too many regions, use larger hugepages.");
+		return -1;
+	}
+
+	r = rte_zmalloc("region", sizeof(struct memif_region), 0);
+	if (r == NULL) {
+		MIF_LOG(ERR, "Failed to alloc memif region.");
+		return -1;
+	}
+
+	/* the descriptor of the file is owned by EAL */
+	r->fd = dup(fd);
+	if (r->fd < 0) {
+		MIF_LOG(ERR, "Failed to dup memory fd: %s.", strerror(errno));
+		rte_free(r);
+		return -1;
+	}
+	r->addr = ms->addr;
+	r->region_size = ms->len;
+	r->pkt_buffer_offset = 0;
+	r->is_external = 1;
+
+	proc_private->regions[proc_private->regions_num] = r;
+	proc_private->regions_num++;
+
+	return 0;
+}
+
+struct memif_zc_export {
+	struct pmd_process_private *proc_private;
 	int ret;
+};
+
+/*
+ * Export the memsegs backing a memory chunk of a mempool.
+ * Called with the memory hotplug lock held.
+ */
+static void
+memif_region_init_zc(struct rte_mempool *mp __rte_unused, void *opaque,
+		     struct rte_mempool_memhdr *memhdr,
+		     unsigned int mem_idx __rte_unused)
+{
+	struct memif_zc_export *exp = opaque;
+	const struct rte_memseg_list *msl;
+	const struct rte_memseg *ms;
+	void *addr = memhdr->addr;
+	void *end = RTE_PTR_ADD(memhdr->addr, memhdr->len);
+
+	while (exp->ret == 0 && addr < end) {
+		msl = rte_mem_virt2memseg_list(addr);
+		ms = msl != NULL ? rte_mem_virt2memseg(addr, msl) : NULL;
+		if (ms == NULL || msl->external) {
+			MIF_LOG(ERR, "Zero-copy needs mempools in EAL memory.");
+			exp->ret = -1;
+			return;
+		}
+		exp->ret = memif_region_add_zc(exp->proc_private, ms);
+		addr = RTE_PTR_ADD(ms->addr, ms->len);
+	}
+}
+
+static int
+memif_regions_init(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *pmd = dev->data->dev_private;
+	struct memif_zc_export exp;
+	struct memif_queue *mq;
+	int ret, i;
+
+	if (pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY) {
+		/*
+		 * Region 0 holds the rings, the packet buffers are mbufs
+		 * of the Rx queue mempools, exported as the following
+		 * regions.
+		 */
+		ret = memif_region_init_shm(dev, /* has buffer */ 0);
+		if (ret < 0)
+			return ret;
+
+		exp.proc_private = dev->process_private;
+		exp.ret = 0;
+		rte_mcfg_mem_read_lock();
+		for (i = 0; i < pmd->run.num_m2s_rings && exp.ret == 0; i++) {
+			mq = dev->data->rx_queues[i];
+			rte_mempool_mem_iter(mq->mempool, memif_region_init_zc,
+					     &exp);
+		}
+		rte_mcfg_mem_read_unlock();
+
+		return exp.ret;
+	}
 
 	/* create one buffer region */
 	ret = memif_region_init_shm(dev, /* has buffer */ 1);
@@ -617,6 +1039,9 @@ memif_init_rings(struct rte_eth_dev *dev)
 		ring->tail = 0;
 		ring->cookie = MEMIF_COOKIE;
 		ring->flags = 0;
+		/* zero-copy descriptors are set by the data path */
+		if (pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY)
+			continue;
 		for (j = 0; j < (1 << pmd->run.log2_ring_size); j++) {
 			slot = i * (1 << pmd->run.log2_ring_size) + j;
 			ring->desc[j].region = 0;
@@ -633,6 +1058,8 @@ memif_init_rings(struct rte_eth_dev *dev)
 		ring->tail = 0;
 		ring->cookie = MEMIF_COOKIE;
 		ring->flags = 0;
+		if (pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY)
+			continue;
 		for (j = 0; j < (1 << pmd->run.log2_ring_size); j++) {
 			slot = (i + pmd->run.num_s2m_rings) *
 			    (1 << pmd->run.log2_ring_size) + j;
@@ -645,8 +1072,29 @@ memif_init_rings(struct rte_eth_dev *dev)
 	}
 }
 
+/* zero-copy mode: allocate the table of the mbufs referenced by a ring */
+static int
+memif_init_zc_buffers(struct rte_eth_dev *dev, struct memif_queue *mq)
+{
+	struct pmd_internals *pmd = dev->data->dev_private;
+
+	if ((pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY) == 0)
+		return 0;
+
+	rte_free(mq->buffers);
+	mq->buffers = rte_zmalloc_socket("memif-zc-buffers",
+			sizeof(struct rte_mbuf *) << mq->log2_ring_size,
+			RTE_CACHE_LINE_SIZE, dev->data->numa_node);
+	if (mq->buffers == NULL) {
+		MIF_LOG(ERR, "Failed to alloc zero-copy buffers table.");
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
 /* called only by slave */
-static void
+static int
 memif_init_queues(struct rte_eth_dev *dev)
 {
 	struct pmd_internals *pmd = dev->data->dev_private;
@@ -667,6 +1115,8 @@ memif_init_queues(struct rte_eth_dev *dev)
 				"Failed to create eventfd for tx queue %d: %s.", i,
 				strerror(errno));
 		}
+		if (memif_init_zc_buffers(dev, mq) < 0)
+			return -ENOMEM;
 	}
 
 	for (i = 0; i < pmd->run.num_m2s_rings; i++) {
@@ -683,7 +1133,11 @@ memif_init_queues(struct rte_eth_dev *dev)
 				"Failed to create eventfd for rx queue %d: %s.", i,
 				strerror(errno));
 		}
+		if (memif_init_zc_buffers(dev, mq) < 0)
+			return -ENOMEM;
 	}
+
+	return 0;
 }
 
 int
@@ -697,7 +1151,9 @@ memif_init_regions_and_queues(struct rte_eth_dev *dev)
 
 	memif_init_rings(dev);
 
-	memif_init_queues(dev);
+	ret = memif_init_queues(dev);
+	if (ret < 0)
+		return ret;
 
 	return 0;
 }
@@ -799,6 +1255,7 @@ memif_dev_close(struct rte_eth_dev *dev)
 	int i;
 
 	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		memif_intr_unregister_sync(dev);
 		memif_msg_enq_disconnect(pmd->cc, "Device closed", 0);
 		memif_disconnect(dev);
 
@@ -860,6 +1317,7 @@ memif_tx_queue_setup(struct rte_eth_dev *dev,
 	mq->n_bytes = 0;
 	mq->intr_handle.fd = -1;
 	mq->intr_handle.type = RTE_INTR_HANDLE_EXT;
+	mq->in_port = dev->data->port_id;
 	dev->data->tx_queues[qid] = mq;
 
 	return 0;
@@ -903,6 +1361,7 @@ memif_queue_release(void *queue)
 	if (!mq)
 		return;
 
+	rte_free(mq->buffers);
 	rte_free(mq);
 }
 
@@ -1038,8 +1497,9 @@ memif_create(struct rte_vdev_device *vdev, enum memif_role_t role,
 	const unsigned int numa_node = vdev->device.numa_node;
 	const char *name = rte_vdev_device_name(vdev);
 
-	if (flags & ETH_MEMIF_FLAG_ZERO_COPY) {
-		MIF_LOG(ERR, "Zero-copy slave not supported.");
+	/* only the slave creates the regions, the master copies */
+	if ((flags & ETH_MEMIF_FLAG_ZERO_COPY) && role == MEMIF_ROLE_MASTER) {
+		MIF_LOG(ERR, "Zero-copy master not supported.");
 		return -1;
 	}
 
@@ -1063,6 +1523,7 @@ memif_create(struct rte_vdev_device *vdev, enum memif_role_t role,
 	memset(pmd, 0, sizeof(*pmd));
 
 	pmd->id = id;
+	rte_spinlock_init(&pmd->cc_lock);
 	pmd->flags = flags;
 	pmd->flags |= ETH_MEMIF_FLAG_DISABLED;
 	pmd->role = role;
@@ -1089,10 +1550,15 @@ memif_create(struct rte_vdev_device *vdev, enum memif_role_t role,
 
 	eth_dev->dev_ops = &ops;
 	eth_dev->device = &vdev->device;
-	eth_dev->rx_pkt_burst = eth_memif_rx;
-	eth_dev->tx_pkt_burst = eth_memif_tx;
+	if (pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY) {
+		eth_dev->rx_pkt_burst = eth_memif_rx_zc;
+		eth_dev->tx_pkt_burst = eth_memif_tx_zc;
+	} else {
+		eth_dev->rx_pkt_burst = eth_memif_rx;
+		eth_dev->tx_pkt_burst = eth_memif_tx;
+	}
 
-	eth_dev->data->dev_flags &= RTE_ETH_DEV_CLOSE_REMOVE;
+	eth_dev->data->dev_flags |= RTE_ETH_DEV_CLOSE_REMOVE;
 
 	rte_eth_dev_probing_finish(eth_dev);
 
@@ -1252,6 +1718,7 @@ rte_pmd_memif_probe(struct rte_vdev_device *vdev)
 	struct rte_ether_addr *ether_addr = rte_zmalloc("",
 		sizeof(struct rte_ether_addr), 0);
 	struct rte_eth_dev *eth_dev;
+	struct pmd_internals *pmd;
 
 	rte_eth_random_addr(ether_addr->addr_bytes);
 
@@ -1266,8 +1733,14 @@ rte_pmd_memif_probe(struct rte_vdev_device *vdev)
 
 		eth_dev->dev_ops = &ops;
 		eth_dev->device = &vdev->device;
-		eth_dev->rx_pkt_burst = eth_memif_rx;
-		eth_dev->tx_pkt_burst = eth_memif_tx;
+		pmd = eth_dev->data->dev_private;
+		if (pmd->flags & ETH_MEMIF_FLAG_ZERO_COPY) {
+			eth_dev->rx_pkt_burst = eth_memif_rx_zc;
+			eth_dev->tx_pkt_burst = eth_memif_tx_zc;
+		} else {
+			eth_dev->rx_pkt_burst = eth_memif_rx;
+			eth_dev->tx_pkt_burst = eth_memif_tx;
+		}
 
 		if (!rte_eal_primary_proc_alive(NULL)) {
 			MIF_LOG(ERR, "Primary process is missing");
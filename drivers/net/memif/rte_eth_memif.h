@@ -14,6 +14,7 @@
 #include <rte_ethdev_driver.h>
 #include <rte_ether.h>
 #include <rte_interrupts.h>
+#include <rte_spinlock.h>
 
 #include "memif.h"
 
@@ -46,6 +47,8 @@ struct memif_region {
 	int fd;					/**< shared memory file descriptor */
 	uint32_t pkt_buffer_offset;
 	/**< offset from 'addr' to first packet buffer */
+	uint8_t is_external;
+	/**< EAL memory exported in zero-copy mode, not mapped by memif */
 };
 
 struct memif_queue {
@@ -69,6 +72,9 @@ struct memif_queue {
 
 	memif_ring_t *ring;			/**< pointer to ring */
 
+	struct rte_mbuf **buffers;
+	/**< zero-copy mode: mbufs referenced by the ring, indexed by slot */
+
 	struct rte_intr_handle intr_handle;	/**< interrupt handle */
 
 	memif_log2_ring_size_t log2_ring_size;	/**< log2 of ring size */
@@ -91,6 +97,7 @@ struct pmd_internals {
 	char secret[ETH_MEMIF_SECRET_SIZE]; /**< secret (optional security parameter) */
 
 	struct memif_control_channel *cc;	/**< control channel */
+	rte_spinlock_t cc_lock;			/**< control channel release lock */
 
 	/* remote info */
 	char remote_name[RTE_DEV_NAME_MAX_LEN];		/**< remote app name */
@@ -133,6 +140,18 @@ struct pmd_process_private {
  */
 void memif_free_regions(struct pmd_process_private *proc_private);
 
+/**
+ * Free the mbufs of a zero-copy queue which are still referenced
+ * by its ring.
+ *
+ * @param proc_private
+ *   device process private data
+ * @param mq
+ *   memif queue
+ */
+void memif_free_stored_mbufs(struct pmd_process_private *proc_private,
+			     struct memif_queue *mq);
+
 /**
  * Finalize connection establishment process. Map shared memory file
  * (master role), initialize ring queue, set link status up.
@@ -4,11 +4,16 @@
  * All rights reserved.
  */
 
+#include <errno.h>
+#include <fcntl.h>
 #include <time.h>
 
 #include <net/if.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #if defined(RTE_EXEC_ENV_FREEBSD)
@@ -18,9 +23,12 @@
 
 #include <pcap.h>
 
+#include <rte_atomic.h>
+#include <rte_byteorder.h>
 #include <rte_cycles.h>
 #include <rte_ethdev_driver.h>
 #include <rte_ethdev_vdev.h>
+#include <rte_ip.h>
 #include <rte_kvargs.h>
 #include <rte_malloc.h>
 #include <rte_mbuf.h>
@@ -40,11 +48,45 @@
 #define ETH_PCAP_IFACE_ARG    "iface"
 #define ETH_PCAP_PHY_MAC_ARG  "phy_mac"
 #define ETH_PCAP_INFINITE_RX_ARG  "infinite_rx"
+#define ETH_PCAP_INFINITE_RX_CLONE_ARG  "infinite_rx_clone"
+#define ETH_PCAP_INFINITE_RX_RATE_ARG  "infinite_rx_rate"
+#define ETH_PCAP_INFINITE_RX_TIMING_ARG  "infinite_rx_timing"
+#define ETH_PCAP_RX_MMAP_ARG  "rx_mmap"
 
 #define ETH_PCAP_ARG_MAXLEN	64
 
 #define RTE_PMD_PCAP_MAX_QUEUES 16
 
+/* Number of packets written to a pcap file per writev() call */
+#define ETH_PCAP_TX_WRITEV_BURST 64
+#define ETH_PCAP_TX_WRITEV_IOV 256
+
+/* Largest burst of the rx_mmap mode, bounded by the external buffer
+ * reference counter update which is a signed 16 bits value.
+ */
+#define ETH_PCAP_RX_MMAP_BURST 1024
+
+/*
+ * The pcap file mapped by the rx_mmap mode is split in chunks, each with
+ * its own external buffer shared info. The size of a chunk ensures that it
+ * cannot hold more packets than the 16 bits reference counter can count.
+ */
+#define ETH_PCAP_RX_MMAP_CHUNK (512 * 1024)
+
+/* Magic numbers of the classic pcap file format, see pcap-savefile(5) */
+#define PCAP_MAGIC_USEC		0xa1b2c3d4
+#define PCAP_MAGIC_NSEC		0xa1b23c4d
+#define PCAP_MAGIC_USEC_SWAPPED	0xd4c3b2a1
+#define PCAP_MAGIC_NSEC_SWAPPED	0x4d3cb2a1
+
+/* Record header of the classic pcap file format */
+struct pcap_rec_hdr {
+	uint32_t ts_sec;
+	uint32_t ts_frac;	/* microseconds or nanoseconds */
+	uint32_t caplen;
+	uint32_t len;
+};
+
 static char errbuf[PCAP_ERRBUF_SIZE];
 static struct timeval start_time;
 static uint64_t start_cycles;
@@ -67,6 +109,31 @@ struct pcap_rx_queue {
 
 	/* Contains pre-generated packets to be looped through */
 	struct rte_ring *pkts;
+
+	/* Pacing of the infinite_rx mode */
+	uint64_t rate_cycles;	/* cycles between two packets at fixed rate */
+	uint64_t next_tsc;	/* time the next packet is due */
+	uint64_t prev_ts;	/* file timestamp of the previous packet */
+	struct rte_mbuf *next_pkt; /* packet dequeued but not due yet */
+};
+
+/*
+ * Pcap file mapped in memory for the rx_mmap mode. Received packets are
+ * external buffers pointing directly into the mapping. The reader holds a
+ * reference on the chunk it is reading, and each received packet holds
+ * a reference on the chunk it belongs to. The mapping is released once
+ * the references of all chunks are gone.
+ */
+struct pcap_mmap_file {
+	uint8_t *addr;
+	size_t size;
+	size_t offset;		/* offset of the next record */
+	unsigned int chunk;	/* chunk held by the reader */
+	unsigned int nb_chunks;
+	int swapped;
+	int nsec;
+	rte_atomic32_t nb_chunks_used;
+	struct rte_mbuf_ext_shared_info shinfo[];
 };
 
 struct pcap_tx_queue {
@@ -86,10 +153,15 @@ struct pmd_internals {
 	int single_iface;
 	int phy_mac;
 	unsigned int infinite_rx;
+	unsigned int infinite_rx_clone;
+	unsigned int infinite_rx_timing;
+	uint64_t infinite_rx_rate;
+	unsigned int rx_mmap;
 };
 
 struct pmd_process_private {
 	pcap_t *rx_pcap[RTE_PMD_PCAP_MAX_QUEUES];
+	struct pcap_mmap_file *rx_mmap[RTE_PMD_PCAP_MAX_QUEUES];
 	pcap_t *tx_pcap[RTE_PMD_PCAP_MAX_QUEUES];
 	pcap_dumper_t *tx_dumper[RTE_PMD_PCAP_MAX_QUEUES];
 };
@@ -114,6 +186,10 @@ struct pmd_devargs_all {
 	unsigned int is_rx_pcap;
 	unsigned int is_rx_iface;
 	unsigned int infinite_rx;
+	unsigned int infinite_rx_clone;
+	unsigned int infinite_rx_timing;
+	uint64_t infinite_rx_rate;
+	unsigned int rx_mmap;
 };
 
 static const char *valid_arguments[] = {
@@ -125,6 +201,10 @@ static const char *valid_arguments[] = {
 	ETH_PCAP_IFACE_ARG,
 	ETH_PCAP_PHY_MAC_ARG,
 	ETH_PCAP_INFINITE_RX_ARG,
+	ETH_PCAP_INFINITE_RX_CLONE_ARG,
+	ETH_PCAP_INFINITE_RX_RATE_ARG,
+	ETH_PCAP_INFINITE_RX_TIMING_ARG,
+	ETH_PCAP_RX_MMAP_ARG,
 	NULL
 };
 
@@ -179,30 +259,129 @@ eth_pcap_rx_jumbo(struct rte_mempool *mb_pool, struct rte_mbuf *mbuf,
 	return mbuf->nb_segs;
 }
 
+/*
+ * Number of packets that can be received by a queue paced at a fixed rate.
+ */
+static uint16_t
+infinite_rx_rate_budget(struct pcap_rx_queue *pcap_q, uint16_t nb_pkts)
+{
+	uint64_t now = rte_get_timer_cycles();
+	uint64_t budget;
+
+	if (now < pcap_q->next_tsc)
+		return 0;
+
+	budget = (now - pcap_q->next_tsc) / pcap_q->rate_cycles + 1;
+	if (budget > nb_pkts) {
+		/* Do not catch up with the time the queue was not polled */
+		pcap_q->next_tsc = now;
+		budget = nb_pkts;
+	}
+	pcap_q->next_tsc += budget * pcap_q->rate_cycles;
+
+	return budget;
+}
+
+/*
+ * Next packet of a queue replaying the gaps between the timestamps of
+ * the file, NULL if it is not due yet.
+ */
+static struct rte_mbuf *
+infinite_rx_next_timed(struct pcap_rx_queue *pcap_q, uint64_t now)
+{
+	struct rte_mbuf *pcap_buf = pcap_q->next_pkt;
+
+	if (pcap_buf == NULL) {
+		if (rte_ring_dequeue(pcap_q->pkts, (void **)&pcap_buf) != 0)
+			return NULL;
+
+		/* Restart the clock when late by more than one second */
+		if (pcap_q->next_tsc + hz < now)
+			pcap_q->next_tsc = now;
+		/* No gap when the file wraps around */
+		if (pcap_buf->timestamp > pcap_q->prev_ts)
+			pcap_q->next_tsc += (pcap_buf->timestamp -
+					pcap_q->prev_ts) * hz / US_PER_S;
+		pcap_q->prev_ts = pcap_buf->timestamp;
+		pcap_q->next_pkt = pcap_buf;
+	}
+
+	if (pcap_q->next_tsc > now)
+		return NULL;
+
+	pcap_q->next_pkt = NULL;
+	return pcap_buf;
+}
+
+/*
+ * The packets handed out in infinite_rx_clone mode are indirect mbufs
+ * sharing the data of the preloaded packets, so they are not writable: an
+ * mbuf may only be modified when it is direct and not shared. With the mbuf
+ * debug checks, the checksum of each preloaded packet is recorded in its
+ * udata64 and checked before each clone, catching an application writing
+ * to a clone.
+ */
+static inline void
+infinite_rx_clone_check(const struct rte_mbuf *pcap_buf)
+{
+#ifdef RTE_LIBRTE_MBUF_DEBUG
+	if (rte_raw_cksum(rte_pktmbuf_mtod(pcap_buf, const void *),
+			pcap_buf->data_len) != pcap_buf->udata64)
+		rte_panic("pcap: preloaded packet modified through a clone\n");
+#else
+	RTE_SET_USED(pcap_buf);
+#endif
+}
+
 static uint16_t
 eth_pcap_rx_infinite(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
 	int i;
 	struct pcap_rx_queue *pcap_q = queue;
+	const struct pmd_internals *internals =
+		rte_eth_devices[pcap_q->port_id].data->dev_private;
+	uint64_t now = 0;
 	uint32_t rx_bytes = 0;
 
 	if (unlikely(nb_pkts == 0))
 		return 0;
 
+	if (internals->infinite_rx_rate) {
+		nb_pkts = infinite_rx_rate_budget(pcap_q, nb_pkts);
+		if (nb_pkts == 0)
+			return 0;
+	} else if (internals->infinite_rx_timing) {
+		now = rte_get_timer_cycles();
+		if (pcap_q->next_pkt != NULL && pcap_q->next_tsc > now)
+			return 0;
+	}
+
 	if (rte_pktmbuf_alloc_bulk(pcap_q->mb_pool, bufs, nb_pkts) != 0)
 		return 0;
 
 	for (i = 0; i < nb_pkts; i++) {
 		struct rte_mbuf *pcap_buf;
-		int err = rte_ring_dequeue(pcap_q->pkts, (void **)&pcap_buf);
-		if (err)
-			return i;
-
-		rte_memcpy(rte_pktmbuf_mtod(bufs[i], void *),
-				rte_pktmbuf_mtod(pcap_buf, void *),
-				pcap_buf->data_len);
-		bufs[i]->data_len = pcap_buf->data_len;
-		bufs[i]->pkt_len = pcap_buf->pkt_len;
+
+		if (internals->infinite_rx_timing) {
+			pcap_buf = infinite_rx_next_timed(pcap_q, now);
+			if (pcap_buf == NULL)
+				break;
+		} else if (rte_ring_dequeue(pcap_q->pkts,
+				(void **)&pcap_buf) != 0) {
+			break;
+		}
+
+		if (internals->infinite_rx_clone) {
+			/* Share the preloaded data, the clone is read-only */
+			infinite_rx_clone_check(pcap_buf);
+			rte_pktmbuf_attach(bufs[i], pcap_buf);
+		} else {
+			rte_memcpy(rte_pktmbuf_mtod(bufs[i], void *),
+					rte_pktmbuf_mtod(pcap_buf, void *),
+					pcap_buf->data_len);
+			bufs[i]->data_len = pcap_buf->data_len;
+			bufs[i]->pkt_len = pcap_buf->pkt_len;
+		}
 		bufs[i]->port = pcap_q->port_id;
 		rx_bytes += pcap_buf->data_len;
 
@@ -210,6 +389,10 @@ eth_pcap_rx_infinite(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		rte_ring_enqueue(pcap_q->pkts, pcap_buf);
 	}
 
+	/* Return the mbufs not needed to the pool */
+	while (nb_pkts > i)
+		rte_pktmbuf_free(bufs[--nb_pkts]);
+
 	pcap_q->rx_stat.pkts += i;
 	pcap_q->rx_stat.bytes += rx_bytes;
 
@@ -279,6 +462,127 @@ eth_pcap_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_rx;
 }
 
+static void
+pcap_mmap_chunk_free(void *addr __rte_unused, void *opaque)
+{
+	struct pcap_mmap_file *mf = opaque;
+
+	if (rte_atomic32_dec_and_test(&mf->nb_chunks_used)) {
+		munmap(mf->addr, mf->size);
+		rte_free(mf);
+	}
+}
+
+/*
+ * Add the references of the packets received from the chunk held by the
+ * reader, then release the chunks up to the given one.
+ */
+static void
+pcap_mmap_chunk_move(struct pcap_mmap_file *mf, uint16_t nb_refs,
+		unsigned int chunk)
+{
+	if (nb_refs != 0)
+		rte_mbuf_ext_refcnt_update(&mf->shinfo[mf->chunk], nb_refs);
+
+	while (mf->chunk < chunk) {
+		if (rte_mbuf_ext_refcnt_update(&mf->shinfo[mf->chunk],
+				-1) == 0)
+			pcap_mmap_chunk_free(NULL, mf);
+		mf->chunk++;
+	}
+}
+
+static uint16_t
+eth_pcap_rx_mmap(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	const struct pcap_rec_hdr *rec;
+	struct pmd_process_private *pp;
+	struct pcap_rx_queue *pcap_q = queue;
+	struct pcap_mmap_file *mf;
+	struct rte_mbuf *mbuf;
+	uint32_t caplen, ts_sec, ts_frac;
+	uint32_t rx_bytes = 0;
+	uint16_t num_rx = 0;
+	uint16_t nb_refs = 0;
+	unsigned int chunk;
+
+	pp = rte_eth_devices[pcap_q->port_id].process_private;
+	mf = pp->rx_mmap[pcap_q->queue_id];
+
+	/* The file could not be mapped, read it through libpcap instead */
+	if (unlikely(mf == NULL))
+		return eth_pcap_rx(queue, bufs, nb_pkts);
+
+	if (unlikely(nb_pkts == 0 || mf->offset >= mf->size))
+		return 0;
+
+	nb_pkts = RTE_MIN(nb_pkts, ETH_PCAP_RX_MMAP_BURST);
+	if (rte_pktmbuf_alloc_bulk(pcap_q->mb_pool, bufs, nb_pkts) != 0)
+		return 0;
+
+	/* Attach each packet of the file to an mbuf, no data is copied */
+	while (num_rx < nb_pkts) {
+		if (mf->size - mf->offset < sizeof(*rec)) {
+			mf->offset = mf->size;
+			break;
+		}
+
+		rec = (const struct pcap_rec_hdr *)(mf->addr + mf->offset);
+		caplen = rec->caplen;
+		ts_sec = rec->ts_sec;
+		ts_frac = rec->ts_frac;
+		if (mf->swapped) {
+			caplen = rte_bswap32(caplen);
+			ts_sec = rte_bswap32(ts_sec);
+			ts_frac = rte_bswap32(ts_frac);
+		}
+
+		/* Truncated last record */
+		if (mf->size - mf->offset - sizeof(*rec) < caplen) {
+			mf->offset = mf->size;
+			break;
+		}
+
+		chunk = mf->offset / ETH_PCAP_RX_MMAP_CHUNK;
+		if (chunk != mf->chunk) {
+			pcap_mmap_chunk_move(mf, nb_refs, chunk);
+			nb_refs = 0;
+		}
+		mf->offset += sizeof(*rec) + caplen;
+
+		/* The length of an mbuf data buffer is 16 bits */
+		if (unlikely(caplen == 0 || caplen > UINT16_MAX)) {
+			pcap_q->rx_stat.err_pkts++;
+			continue;
+		}
+
+		mbuf = bufs[num_rx];
+		rte_pktmbuf_attach_extbuf(mbuf, (void *)(uintptr_t)(rec + 1),
+				RTE_BAD_IOVA, (uint16_t)caplen,
+				&mf->shinfo[chunk]);
+		mbuf->data_len = (uint16_t)caplen;
+		mbuf->pkt_len = caplen;
+		mbuf->timestamp = (uint64_t)ts_sec * 1000000 +
+				(mf->nsec ? ts_frac / 1000 : ts_frac);
+		mbuf->ol_flags |= PKT_RX_TIMESTAMP;
+		mbuf->port = pcap_q->port_id;
+		nb_refs++;
+		num_rx++;
+		rx_bytes += caplen;
+	}
+
+	if (nb_refs != 0)
+		rte_mbuf_ext_refcnt_update(&mf->shinfo[mf->chunk], nb_refs);
+
+	while (nb_pkts > num_rx)
+		rte_pktmbuf_free(bufs[--nb_pkts]);
+
+	pcap_q->rx_stat.pkts += num_rx;
+	pcap_q->rx_stat.bytes += rx_bytes;
+
+	return num_rx;
+}
+
 static uint16_t
 eth_null_rx(void *queue __rte_unused,
 		struct rte_mbuf **bufs __rte_unused,
@@ -298,22 +602,55 @@ calculate_timestamp(struct timeval *ts) {
 	timeradd(&start_time, &cur_time, ts);
 }
 
+/*
+ * Write a vector of buffers entirely, resuming after partial writes.
+ */
+static int
+pcap_writev_all(int fd, struct iovec *iov, int iovcnt)
+{
+	ssize_t n;
+
+	while (iovcnt > 0) {
+		n = writev(fd, iov, iovcnt);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+
+		while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+			n -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (char *)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+
+	return 0;
+}
+
 /*
  * Callback to handle writing packets to a pcap file.
  */
 static uint16_t
 eth_pcap_tx_dumper(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
-	unsigned int i;
-	struct rte_mbuf *mbuf;
+	unsigned int i, first, nb_hdr, nb_iov;
+	struct rte_mbuf *mbuf, *seg;
 	struct pmd_process_private *pp;
 	struct pcap_tx_queue *dumper_q = queue;
+	struct pcap_rec_hdr hdr[ETH_PCAP_TX_WRITEV_BURST];
+	struct iovec iov[ETH_PCAP_TX_WRITEV_IOV];
 	uint16_t num_tx = 0;
-	uint32_t tx_bytes = 0;
-	struct pcap_pkthdr header;
+	uint32_t tx_bytes = 0, burst_bytes;
+	uint32_t caplen, len, seg_len;
 	pcap_dumper_t *dumper;
-	unsigned char temp_data[RTE_ETH_PCAP_SNAPLEN];
-	size_t len;
+	struct timeval ts;
+	FILE *f;
+	int fd;
 
 	pp = rte_eth_devices[dumper_q->port_id].process_private;
 	dumper = pp->tx_dumper[dumper_q->queue_id];
@@ -321,44 +658,81 @@ eth_pcap_tx_dumper(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	if (dumper == NULL || nb_pkts == 0)
 		return 0;
 
-	/* writes the nb_pkts packets to the previously opened pcap file
-	 * dumper */
-	for (i = 0; i < nb_pkts; i++) {
-		mbuf = bufs[i];
-		len = rte_pktmbuf_pkt_len(mbuf);
-		if (unlikely(!rte_pktmbuf_is_contiguous(mbuf) &&
-				len > sizeof(temp_data))) {
-			PMD_LOG(ERR,
-				"Dropping multi segment PCAP packet. Size (%zd) > max size (%zd).",
-				len, sizeof(temp_data));
-			rte_pktmbuf_free(mbuf);
-			continue;
+	/*
+	 * Records are written directly to the file descriptor, anything
+	 * still buffered by libpcap (i.e. the file header) goes first.
+	 */
+	f = pcap_dump_file(dumper);
+	fflush(f);
+	fd = fileno(f);
+
+	/*
+	 * Gather the record headers and the mbuf segments of the burst
+	 * and write them with as few writev() calls as possible,
+	 * multi-segment packets do not need to be linearized.
+	 */
+	i = 0;
+	while (i < nb_pkts) {
+		first = i;
+		nb_hdr = 0;
+		nb_iov = 0;
+		burst_bytes = 0;
+
+		for (; i < nb_pkts && nb_hdr < ETH_PCAP_TX_WRITEV_BURST; i++) {
+			mbuf = bufs[i];
+			if (nb_iov + 1 + mbuf->nb_segs > ETH_PCAP_TX_WRITEV_IOV) {
+				if (nb_iov != 0)
+					break;
+				/* too many segments for a single writev() */
+				PMD_LOG(ERR,
+					"Dropping PCAP packet with %u segments.",
+					mbuf->nb_segs);
+				dumper_q->tx_stat.err_pkts++;
+				first++;
+				continue;
+			}
+
+			len = rte_pktmbuf_pkt_len(mbuf);
+			caplen = RTE_MIN(len, (uint32_t)RTE_ETH_PCAP_SNAPSHOT_LEN);
+			calculate_timestamp(&ts);
+			hdr[nb_hdr].ts_sec = ts.tv_sec;
+			hdr[nb_hdr].ts_frac = ts.tv_usec;
+			hdr[nb_hdr].caplen = caplen;
+			hdr[nb_hdr].len = len;
+			iov[nb_iov].iov_base = &hdr[nb_hdr];
+			iov[nb_iov].iov_len = sizeof(hdr[nb_hdr]);
+			nb_hdr++;
+			nb_iov++;
+
+			for (seg = mbuf; seg != NULL && caplen > 0;
+					seg = seg->next) {
+				seg_len = RTE_MIN(caplen, (uint32_t)seg->data_len);
+				iov[nb_iov].iov_base = rte_pktmbuf_mtod(seg, void *);
+				iov[nb_iov].iov_len = seg_len;
+				nb_iov++;
+				caplen -= seg_len;
+			}
+			burst_bytes += len;
 		}
 
-		calculate_timestamp(&header.ts);
-		header.len = len;
-		header.caplen = header.len;
-		/* rte_pktmbuf_read() returns a pointer to the data directly
-		 * in the mbuf (when the mbuf is contiguous) or, otherwise,
-		 * a pointer to temp_data after copying into it.
-		 */
-		pcap_dump((u_char *)dumper, &header,
-			rte_pktmbuf_read(mbuf, 0, len, temp_data));
+		if (nb_iov == 0)
+			continue;
 
-		num_tx++;
-		tx_bytes += len;
-		rte_pktmbuf_free(mbuf);
+		if (unlikely(pcap_writev_all(fd, iov, nb_iov) < 0)) {
+			PMD_LOG(ERR, "Writing to %s failed: %s",
+				dumper_q->name, strerror(errno));
+			dumper_q->tx_stat.err_pkts += i - first;
+			continue;
+		}
+		num_tx += i - first;
+		tx_bytes += burst_bytes;
 	}
 
-	/*
-	 * Since there's no place to hook a callback when the forwarding
-	 * process stops and to make sure the pcap file is actually written,
-	 * we flush the pcap dumper within each burst.
-	 */
-	pcap_dump_flush(dumper);
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(bufs[i]);
+
 	dumper_q->tx_stat.pkts += num_tx;
 	dumper_q->tx_stat.bytes += tx_bytes;
-	dumper_q->tx_stat.err_pkts += nb_pkts - num_tx;
 
 	return nb_pkts;
 }
@@ -511,6 +885,111 @@ open_single_rx_pcap(const char *pcap_filename, pcap_t **pcap)
 	return 0;
 }
 
+/*
+ * Map a classic pcap file in memory for the rx_mmap mode. Files in other
+ * formats (e.g. pcapng) are left to libpcap.
+ */
+static int
+open_single_rx_mmap(const char *pcap_filename, struct pcap_mmap_file **mmap_file)
+{
+	const struct pcap_file_header *header;
+	struct pcap_mmap_file *mf;
+	unsigned int i, nb_chunks;
+	int swapped, nsec, fd;
+	struct stat st;
+	void *addr;
+
+	fd = open(pcap_filename, O_RDONLY);
+	if (fd < 0) {
+		PMD_LOG(ERR, "Couldn't open %s: %s", pcap_filename,
+			strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*header)) {
+		PMD_LOG(ERR, "Couldn't map %s: not a pcap file",
+			pcap_filename);
+		close(fd);
+		return -1;
+	}
+
+	/* Private writable mapping, so that packets can be modified */
+	addr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		PMD_LOG(ERR, "Couldn't map %s: %s", pcap_filename,
+			strerror(errno));
+		return -1;
+	}
+
+	header = addr;
+	switch (header->magic) {
+	case PCAP_MAGIC_USEC:
+		swapped = 0;
+		nsec = 0;
+		break;
+	case PCAP_MAGIC_NSEC:
+		swapped = 0;
+		nsec = 1;
+		break;
+	case PCAP_MAGIC_USEC_SWAPPED:
+		swapped = 1;
+		nsec = 0;
+		break;
+	case PCAP_MAGIC_NSEC_SWAPPED:
+		swapped = 1;
+		nsec = 1;
+		break;
+	default:
+		PMD_LOG(INFO, "%s is not a classic pcap file, reading it with libpcap",
+			pcap_filename);
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+	nb_chunks = (st.st_size + ETH_PCAP_RX_MMAP_CHUNK - 1) /
+		ETH_PCAP_RX_MMAP_CHUNK;
+	mf = rte_zmalloc(NULL, sizeof(*mf) + nb_chunks * sizeof(mf->shinfo[0]),
+			RTE_CACHE_LINE_SIZE);
+	if (mf == NULL) {
+		PMD_LOG(ERR, "Failed to allocate memory for %s",
+			pcap_filename);
+		munmap(addr, st.st_size);
+		return -1;
+	}
+
+	mf->addr = addr;
+	mf->size = st.st_size;
+	mf->offset = sizeof(*header);
+	mf->chunk = 0;
+	mf->nb_chunks = nb_chunks;
+	mf->swapped = swapped;
+	mf->nsec = nsec;
+	rte_atomic32_set(&mf->nb_chunks_used, nb_chunks);
+	/* The reader holds a reference on every chunk it did not read yet */
+	for (i = 0; i < nb_chunks; i++) {
+		mf->shinfo[i].free_cb = pcap_mmap_chunk_free;
+		mf->shinfo[i].fcb_opaque = mf;
+		rte_mbuf_ext_refcnt_set(&mf->shinfo[i], 1);
+	}
+
+	*mmap_file = mf;
+	return 0;
+}
+
+/*
+ * Release the references of the reader, the mapping stays valid as long as
+ * received packets point into it.
+ */
+static void
+close_single_rx_mmap(struct pcap_mmap_file *mf)
+{
+	pcap_mmap_chunk_move(mf, 0, mf->nb_chunks);
+}
+
 static uint64_t
 count_packets_in_pcap(pcap_t **pcap, struct pcap_rx_queue *pcap_q)
 {
@@ -585,6 +1064,15 @@ eth_dev_start(struct rte_eth_dev *dev)
 		}
 	}
 
+	/* Map the rx pcap files, libpcap is used for those that fail */
+	for (i = 0; internals->rx_mmap && i < dev->data->nb_rx_queues; i++) {
+		rx = &internals->rx_queue[i];
+
+		if (pp->rx_mmap[i] == NULL &&
+				strcmp(rx->type, ETH_PCAP_RX_PCAP_ARG) == 0)
+			open_single_rx_mmap(rx->name, &pp->rx_mmap[i]);
+	}
+
 status_up:
 	for (i = 0; i < dev->data->nb_rx_queues; i++)
 		dev->data->rx_queue_state[i] = RTE_ETH_QUEUE_STATE_STARTED;
@@ -634,6 +1122,11 @@ eth_dev_stop(struct rte_eth_dev *dev)
 			pcap_close(pp->rx_pcap[i]);
 			pp->rx_pcap[i] = NULL;
 		}
+
+		if (pp->rx_mmap[i] != NULL) {
+			close_single_rx_mmap(pp->rx_mmap[i]);
+			pp->rx_mmap[i] = NULL;
+		}
 	}
 
 status_down:
@@ -673,6 +1166,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 {
 	unsigned int i;
 	unsigned long rx_packets_total = 0, rx_bytes_total = 0;
+	unsigned long rx_packets_err_total = 0;
 	unsigned long tx_packets_total = 0, tx_bytes_total = 0;
 	unsigned long tx_packets_err_total = 0;
 	const struct pmd_internals *internal = dev->data->dev_private;
@@ -683,6 +1177,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 		stats->q_ibytes[i] = internal->rx_queue[i].rx_stat.bytes;
 		rx_packets_total += stats->q_ipackets[i];
 		rx_bytes_total += stats->q_ibytes[i];
+		rx_packets_err_total += internal->rx_queue[i].rx_stat.err_pkts;
 	}
 
 	for (i = 0; i < RTE_ETHDEV_QUEUE_STAT_CNTRS &&
@@ -696,6 +1191,7 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 
 	stats->ipackets = rx_packets_total;
 	stats->ibytes = rx_bytes_total;
+	stats->ierrors = rx_packets_err_total;
 	stats->opackets = tx_packets_total;
 	stats->obytes = tx_bytes_total;
 	stats->oerrors = tx_packets_err_total;
@@ -712,6 +1208,7 @@ eth_stats_reset(struct rte_eth_dev *dev)
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
 		internal->rx_queue[i].rx_stat.pkts = 0;
 		internal->rx_queue[i].rx_stat.bytes = 0;
+		internal->rx_queue[i].rx_stat.err_pkts = 0;
 	}
 
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
@@ -738,6 +1235,9 @@ eth_dev_close(struct rte_eth_dev *dev)
 				rte_pktmbuf_free(pcap_buf);
 
 			rte_ring_free(pcap_q->pkts);
+
+			rte_pktmbuf_free(pcap_q->next_pkt);
+			pcap_q->next_pkt = NULL;
 		}
 	}
 
@@ -812,6 +1312,11 @@ eth_rx_queue_setup(struct rte_eth_dev *dev,
 						"mode.");
 				return -EINVAL;
 			}
+#ifdef RTE_LIBRTE_MBUF_DEBUG
+			bufs[0]->udata64 = rte_raw_cksum(
+					rte_pktmbuf_mtod(bufs[0], const void *),
+					bufs[0]->data_len);
+#endif
 
 			rte_ring_enqueue_bulk(pcap_q->pkts,
 					(void * const *)bufs, 1, NULL);
@@ -822,6 +1327,14 @@ eth_rx_queue_setup(struct rte_eth_dev *dev,
 		 */
 		pcap_q->rx_stat.pkts = 0;
 		pcap_q->rx_stat.bytes = 0;
+
+		pcap_q->rate_cycles = 0;
+		if (internals->infinite_rx_rate)
+			pcap_q->rate_cycles = RTE_MAX(hz /
+					internals->infinite_rx_rate, 1);
+		pcap_q->next_tsc = 0;
+		pcap_q->prev_ts = UINT64_MAX;
+		pcap_q->next_pkt = NULL;
 	}
 
 	return 0;
@@ -1075,6 +1588,36 @@ get_infinite_rx_arg(const char *key __rte_unused,
 	return 0;
 }
 
+static int
+get_infinite_rx_rate_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	uint64_t *infinite_rx_rate = extra_args;
+	char *end;
+
+	errno = 0;
+	*infinite_rx_rate = strtoull(value, &end, 10);
+	if (errno != 0 || end == value || *end != '\0') {
+		PMD_LOG(ERR, "Invalid packet rate %s", value);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static int
+get_rx_mmap_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	if (extra_args) {
+		const int rx_mmap = atoi(value);
+		int *enable_rx_mmap = extra_args;
+
+		if (rx_mmap > 0)
+			*enable_rx_mmap = 1;
+	}
+	return 0;
+}
+
 static int
 pmd_init_internals(struct rte_vdev_device *vdev,
 		const unsigned int nb_rx_queues,
@@ -1301,9 +1844,15 @@ eth_from_pcaps(struct rte_vdev_device *vdev,
 	}
 
 	internals->infinite_rx = infinite_rx;
+	internals->infinite_rx_clone = devargs_all->infinite_rx_clone;
+	internals->infinite_rx_timing = devargs_all->infinite_rx_timing;
+	internals->infinite_rx_rate = devargs_all->infinite_rx_rate;
+	internals->rx_mmap = devargs_all->rx_mmap;
 	/* Assign rx ops. */
 	if (infinite_rx)
 		eth_dev->rx_pkt_burst = eth_pcap_rx_infinite;
+	else if (devargs_all->rx_mmap)
+		eth_dev->rx_pkt_burst = eth_pcap_rx_mmap;
 	else if (devargs_all->is_rx_pcap || devargs_all->is_rx_iface ||
 			single_iface)
 		eth_dev->rx_pkt_burst = eth_pcap_rx;
@@ -1338,6 +1887,7 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 		.is_tx_pcap = 0,
 		.is_tx_iface = 0,
 		.infinite_rx = 0,
+		.rx_mmap = 0,
 	};
 
 	name = rte_vdev_device_name(dev);
@@ -1433,6 +1983,61 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 					"for %s", name);
 		}
 
+		/*
+		 * We check how the infinite rx packets are handed out
+		 * and paced.
+		 */
+		ret = rte_kvargs_process(kvlist,
+				ETH_PCAP_INFINITE_RX_CLONE_ARG,
+				&get_infinite_rx_arg,
+				&devargs_all.infinite_rx_clone);
+		if (ret < 0)
+			goto free_kvlist;
+		ret = rte_kvargs_process(kvlist,
+				ETH_PCAP_INFINITE_RX_TIMING_ARG,
+				&get_infinite_rx_arg,
+				&devargs_all.infinite_rx_timing);
+		if (ret < 0)
+			goto free_kvlist;
+		ret = rte_kvargs_process(kvlist,
+				ETH_PCAP_INFINITE_RX_RATE_ARG,
+				&get_infinite_rx_rate_arg,
+				&devargs_all.infinite_rx_rate);
+		if (ret < 0)
+			goto free_kvlist;
+
+		if (!devargs_all.infinite_rx &&
+				(devargs_all.infinite_rx_clone ||
+				 devargs_all.infinite_rx_timing ||
+				 devargs_all.infinite_rx_rate)) {
+			PMD_LOG(WARNING, "infinite_rx options are ignored since "
+					"infinite_rx is not enabled for %s", name);
+			devargs_all.infinite_rx_clone = 0;
+			devargs_all.infinite_rx_timing = 0;
+			devargs_all.infinite_rx_rate = 0;
+		}
+		if (devargs_all.infinite_rx_timing &&
+				devargs_all.infinite_rx_rate) {
+			PMD_LOG(ERR, "infinite_rx_timing and infinite_rx_rate "
+					"cannot be used together for %s", name);
+			ret = -EINVAL;
+			goto free_kvlist;
+		}
+
+		/*
+		 * We check whether we want to read the pcap files through
+		 * a memory mapping instead of libpcap.
+		 */
+		ret = rte_kvargs_process(kvlist, ETH_PCAP_RX_MMAP_ARG,
+				&get_rx_mmap_arg, &devargs_all.rx_mmap);
+		if (ret < 0)
+			goto free_kvlist;
+		if (devargs_all.rx_mmap && devargs_all.infinite_rx) {
+			PMD_LOG(WARNING, "rx_mmap is ignored in infinite_rx mode for %s",
+					name);
+			devargs_all.rx_mmap = 0;
+		}
+
 		ret = rte_kvargs_process(kvlist, ETH_PCAP_RX_PCAP_ARG,
 				&open_rx_pcap, &pcaps);
 	} else if (devargs_all.is_rx_iface) {
@@ -1516,7 +2121,10 @@ pmd_pcap_probe(struct rte_vdev_device *dev)
 		}
 
 		eth_dev->process_private = pp;
-		eth_dev->rx_pkt_burst = eth_pcap_rx;
+		if (internal->rx_mmap)
+			eth_dev->rx_pkt_burst = eth_pcap_rx_mmap;
+		else
+			eth_dev->rx_pkt_burst = eth_pcap_rx;
 		if (devargs_all.is_tx_pcap)
 			eth_dev->tx_pkt_burst = eth_pcap_tx_dumper;
 		else
@@ -1584,7 +2192,11 @@ RTE_PMD_REGISTER_PARAM_STRING(net_pcap,
 	ETH_PCAP_TX_IFACE_ARG "=<ifc> "
 	ETH_PCAP_IFACE_ARG "=<ifc> "
 	ETH_PCAP_PHY_MAC_ARG "=<int>"
-	ETH_PCAP_INFINITE_RX_ARG "=<0|1>");
+	ETH_PCAP_INFINITE_RX_ARG "=<0|1> "
+	ETH_PCAP_INFINITE_RX_CLONE_ARG "=<0|1> "
+	ETH_PCAP_INFINITE_RX_RATE_ARG "=<pps> "
+	ETH_PCAP_INFINITE_RX_TIMING_ARG "=<0|1> "
+	ETH_PCAP_RX_MMAP_ARG "=<0|1>");
 
 RTE_INIT(eth_pcap_init_log)
 {
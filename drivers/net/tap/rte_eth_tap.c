@@ -131,9 +131,7 @@ static int
 tun_alloc(struct pmd_internals *pmd, int is_keepalive)
 {
 	struct ifreq ifr;
-#ifdef IFF_MULTI_QUEUE
 	unsigned int features;
-#endif
 	int fd;
 
 	memset(&ifr, 0, sizeof(struct ifreq));
@@ -152,7 +150,6 @@ tun_alloc(struct pmd_internals *pmd, int is_keepalive)
 		goto error;
 	}
 
-#ifdef IFF_MULTI_QUEUE
 	/* Grab the TUN features to verify we can work multi-queue */
 	if (ioctl(fd, TUNGETFEATURES, &features) < 0) {
 		TAP_LOG(ERR, "unable to get TUN/TAP features");
@@ -160,6 +157,7 @@ tun_alloc(struct pmd_internals *pmd, int is_keepalive)
 	}
 	TAP_LOG(DEBUG, "%s Features %08x", TUN_TAP_DEV_PATH, features);
 
+#ifdef IFF_MULTI_QUEUE
 	if (features & IFF_MULTI_QUEUE) {
 		TAP_LOG(DEBUG, "  Multi-queue support for %d queues",
 			RTE_PMD_TAP_MAX_QUEUES);
@@ -171,6 +169,14 @@ tun_alloc(struct pmd_internals *pmd, int is_keepalive)
 		TAP_LOG(DEBUG, "  Single queue only support");
 	}
 
+	/*
+	 * A virtio-net header after the packet information carries the
+	 * checksum and segmentation offloads to and from the kernel.
+	 */
+	if (features & IFF_VNET_HDR)
+		ifr.ifr_flags |= IFF_VNET_HDR;
+	pmd->vnet_hdr = !!(ifr.ifr_flags & IFF_VNET_HDR);
+
 	/* Set the TUN/TAP configuration and set the name if needed */
 	if (ioctl(fd, TUNSETIFF, (void *)&ifr) < 0) {
 		TAP_LOG(WARNING, "Unable to set TUNSETIFF for %s: %s",
@@ -306,7 +312,9 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 		/* IPv6 extensions are not supported */
 		return;
 	}
-	if (l4 == RTE_PTYPE_L4_UDP || l4 == RTE_PTYPE_L4_TCP) {
+	/* Skip the L4 checksums already reported by the kernel */
+	if ((l4 == RTE_PTYPE_L4_UDP || l4 == RTE_PTYPE_L4_TCP) &&
+	    !(mbuf->ol_flags & PKT_RX_L4_CKSUM_MASK)) {
 		l4_hdr = rte_pktmbuf_mtod_offset(mbuf, void *, l2_len + l3_len);
 		/* Don't verify checksum for multi-segment packets. */
 		if (mbuf->nb_segs > 1)
@@ -321,6 +329,23 @@ tap_verify_csum(struct rte_mbuf *mbuf)
 	}
 }
 
+/* Translate the offloads reported by the kernel in the virtio-net header */
+static void
+tap_rx_vnet_offload(struct rte_mbuf *mbuf, const struct virtio_net_hdr *vnet)
+{
+	/* A packet of the local stack has a partial L4 checksum */
+	if (vnet->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM)
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_NONE;
+	else if (vnet->flags & VIRTIO_NET_HDR_F_DATA_VALID)
+		mbuf->ol_flags |= PKT_RX_L4_CKSUM_GOOD;
+
+	/* Not segmented TCP packet, with TUN_F_TSO4 or TUN_F_TSO6 */
+	if (vnet->gso_type != VIRTIO_NET_HDR_GSO_NONE) {
+		mbuf->ol_flags |= PKT_RX_LRO;
+		mbuf->tso_segsz = vnet->gso_size;
+	}
+}
+
 static uint64_t
 tap_rx_offload_get_port_capa(void)
 {
@@ -339,6 +364,108 @@ tap_rx_offload_get_queue_capa(void)
 	       DEV_RX_OFFLOAD_TCP_CKSUM;
 }
 
+/*
+ * Read a burst of packets in single segment mbufs with one system call.
+ * The mbufs of the reads which found no packet are kept for the next burst.
+ */
+static uint16_t
+tap_rx_batch(struct rx_queue *rxq, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct pmd_process_private *process_private;
+	struct rte_mbuf *mbufs[TAP_BATCH_SIZE];
+	int res[TAP_BATCH_SIZE];
+	struct uring *ur;
+	uint16_t num_rx = 0;
+	unsigned long num_rx_bytes = 0;
+	unsigned int i, n, nb_new, nb_read;
+	int fd;
+
+	process_private = rte_eth_devices[rxq->in_port].process_private;
+	ur = process_private->rxq_urings[rxq->queue_id];
+	fd = process_private->rxq_fds[rxq->queue_id];
+	while (num_rx < nb_pkts) {
+		n = RTE_MIN(nb_pkts - num_rx, TAP_BATCH_SIZE);
+
+		/* Replace the mbufs filled by the previous reads */
+		nb_new = 0;
+		for (i = 0; i < n; i++)
+			nb_new += rxq->batch_mbufs[i] == NULL;
+		if (nb_new && rte_pktmbuf_alloc_bulk(rxq->mp, mbufs, nb_new)) {
+			rxq->stats.rx_nombuf++;
+			break;
+		}
+		for (i = 0; nb_new != 0; i++) {
+			struct rte_mbuf *buf;
+
+			if (rxq->batch_mbufs[i] != NULL)
+				continue;
+			buf = mbufs[--nb_new];
+			rxq->batch_mbufs[i] = buf;
+			rxq->batch_iovecs[i][1].iov_base =
+				rte_pktmbuf_mtod(buf, void *);
+			rxq->batch_iovecs[i][1].iov_len =
+				rte_pktmbuf_tailroom(buf);
+		}
+
+		for (i = 0; i < n; i++)
+			tap_uring_prep_rw(ur, fd, false,
+					  rxq->batch_iovecs[i], 2);
+		if (uring_submit(ur, res) < 0)
+			break;
+
+		nb_read = 0;
+		for (i = 0; i < n; i++) {
+			struct rte_mbuf *mbuf = rxq->batch_mbufs[i];
+			int len = res[i];
+
+			if (unlikely(len == -EOPNOTSUPP || len == -EINVAL)) {
+				/* Non-blocking reads are not supported */
+				TAP_LOG(INFO, "%s: no batched Rx on queue %d",
+					rte_eth_devices[rxq->in_port].data->name,
+					rxq->queue_id);
+				process_private->rxq_urings[rxq->queue_id] =
+					NULL;
+				uring_destroy(ur);
+				goto end;
+			}
+			if (len < (int)rxq->hdr_len)
+				continue;
+			nb_read++;
+
+			/* Packet couldn't fit in the provided mbuf */
+			if (unlikely(rxq->batch_hdrs[i].pi.flags &
+				     TUN_PKT_STRIP)) {
+				rxq->stats.ierrors++;
+				continue;
+			}
+
+			len -= rxq->hdr_len;
+			rxq->batch_mbufs[i] = NULL;
+			mbuf->data_len = len;
+			mbuf->pkt_len = len;
+			mbuf->port = rxq->in_port;
+			mbuf->packet_type = rte_net_get_ptype(mbuf, NULL,
+					RTE_PTYPE_ALL_MASK);
+			if (rxq->hdr_len > sizeof(struct tun_pi))
+				tap_rx_vnet_offload(mbuf,
+						    &rxq->batch_hdrs[i].vnet);
+			if (rxq->rxmode->offloads & DEV_RX_OFFLOAD_CHECKSUM)
+				tap_verify_csum(mbuf);
+
+			bufs[num_rx++] = mbuf;
+			num_rx_bytes += mbuf->pkt_len;
+		}
+		/* The queue is empty */
+		if (nb_read < n)
+			break;
+	}
+end:
+	rxq->stats.ipackets += num_rx;
+	rxq->stats.ibytes += num_rx_bytes;
+
+	return num_rx;
+}
+
 /* Callback to handle the rx burst of packets to the correct interface and
  * file descriptor(s) in a multi-queue setup.
  */
@@ -357,6 +484,9 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		rxq->trigger_seen = trigger;
 	process_private = rte_eth_devices[rxq->in_port].process_private;
 	rte_compiler_barrier();
+	if (process_private->rxq_urings[rxq->queue_id] != NULL &&
+	    !(rxq->rxmode->offloads & DEV_RX_OFFLOAD_SCATTER))
+		return tap_rx_batch(rxq, bufs, nb_pkts);
 	for (num_rx = 0; num_rx < nb_pkts; ) {
 		struct rte_mbuf *mbuf = rxq->pool;
 		struct rte_mbuf *seg = NULL;
@@ -368,17 +498,16 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 			*rxq->iovecs,
 			1 + (rxq->rxmode->offloads & DEV_RX_OFFLOAD_SCATTER ?
 			     rxq->nb_rx_desc : 1));
-		if (len < (int)sizeof(struct tun_pi))
+		if (len < (int)rxq->hdr_len)
 			break;
 
 		/* Packet couldn't fit in the provided mbuf */
-		if (unlikely(rxq->pi.flags & TUN_PKT_STRIP)) {
+		if (unlikely(rxq->hdr.pi.flags & TUN_PKT_STRIP)) {
 			rxq->stats.ierrors++;
 			continue;
 		}
 
-		len -= sizeof(struct tun_pi);
-
+		len -= rxq->hdr_len;
 		mbuf->pkt_len = len;
 		mbuf->port = rxq->in_port;
 		while (1) {
@@ -422,6 +551,8 @@ pmd_rx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 		seg->next = NULL;
 		mbuf->packet_type = rte_net_get_ptype(mbuf, NULL,
 						      RTE_PTYPE_ALL_MASK);
+		if (rxq->hdr_len > sizeof(struct tun_pi))
+			tap_rx_vnet_offload(mbuf, &rxq->hdr.vnet);
 		if (rxq->rxmode->offloads & DEV_RX_OFFLOAD_CHECKSUM)
 			tap_verify_csum(mbuf);
 
@@ -520,6 +651,18 @@ tap_tx_l3_cksum(char *packet, uint64_t ol_flags, unsigned int l2_len,
 	}
 }
 
+/* Protocol of the packet information header, needed by a TUN interface */
+static uint16_t
+tap_tun_proto(struct rte_mbuf *mbuf)
+{
+	char *buff_data = rte_pktmbuf_mtod(mbuf, void *);
+	int proto = (*buff_data & 0xf0);
+
+	return (proto == 0x40) ? rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) :
+		((proto == 0x60) ? rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) :
+		 0x00);
+}
+
 static inline void
 tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 			struct rte_mbuf **pmbufs,
@@ -537,7 +680,6 @@ tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 		struct tun_pi pi = { .flags = 0, .proto = 0x00 };
 		struct rte_mbuf *seg = mbuf;
 		char m_copy[mbuf->data_len];
-		int proto;
 		int n;
 		int j;
 		int k; /* current index in iovecs for copying segments */
@@ -560,13 +702,7 @@ tap_write_mbufs(struct tx_queue *txq, uint16_t num_mbufs,
 			 * then compares whether its v4 or v6. If first byte
 			 * is 4 or 6, then protocol field is updated.
 			 */
-			char *buff_data = rte_pktmbuf_mtod(seg, void *);
-			proto = (*buff_data & 0xf0);
-			pi.proto = (proto == 0x40) ?
-				rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) :
-				((proto == 0x60) ?
-					rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) :
-					0x00);
+			pi.proto = tap_tun_proto(seg);
 		}
 
 		k = 0;
@@ -724,6 +860,222 @@ pmd_tx_burst(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_packets;
 }
 
+/*
+ * Prepare a packet to be written with a virtio-net header: the checksums
+ * and the TCP segmentation are left to the kernel, which expects the L4
+ * checksum field to hold the pseudo-header checksum and, for TSO, the L3
+ * length of the whole packet. These headers are updated in a copy.
+ *
+ * @return
+ *   Number of iovecs describing the packet, -1 if it cannot be sent.
+ */
+static int
+tap_tx_vnet_prepare(struct tx_queue *txq, struct rte_mbuf *mbuf,
+		    struct tap_pkt_hdr *hdr, uint8_t *copy,
+		    struct iovec *iovecs)
+{
+	struct virtio_net_hdr *vnet = &hdr->vnet;
+	uint64_t ol_flags = mbuf->ol_flags;
+	uint16_t l4_off = mbuf->l2_len + mbuf->l3_len;
+	uint16_t copy_len = 0;
+	uint16_t csum_offset = 0;
+	struct rte_mbuf *seg;
+	void *l3_hdr;
+	int k = 0;
+
+	memset(hdr, 0, sizeof(*hdr));
+	if (txq->type == ETH_TUNTAP_TYPE_TUN)
+		hdr->pi.proto = tap_tun_proto(mbuf);
+	iovecs[k].iov_base = hdr;
+	iovecs[k].iov_len = sizeof(*hdr);
+	k++;
+
+	if (ol_flags & PKT_TX_TCP_SEG) {
+		if (unlikely(mbuf->tso_segsz == 0 ||
+			     mbuf->pkt_len - mbuf->l2_len > UINT16_MAX))
+			return -1;
+		copy_len = l4_off + mbuf->l4_len;
+		csum_offset = offsetof(struct rte_tcp_hdr, cksum);
+		vnet->gso_type = (ol_flags & PKT_TX_IPV4) ?
+			VIRTIO_NET_HDR_GSO_TCPV4 : VIRTIO_NET_HDR_GSO_TCPV6;
+		vnet->gso_size = mbuf->tso_segsz;
+		vnet->hdr_len = copy_len;
+	} else if (txq->csum) {
+		switch (ol_flags & PKT_TX_L4_MASK) {
+		case PKT_TX_TCP_CKSUM:
+			copy_len = l4_off + sizeof(struct rte_tcp_hdr);
+			csum_offset = offsetof(struct rte_tcp_hdr, cksum);
+			break;
+		case PKT_TX_UDP_CKSUM:
+			copy_len = l4_off + sizeof(struct rte_udp_hdr);
+			csum_offset = offsetof(struct rte_udp_hdr, dgram_cksum);
+			break;
+		default:
+			if (ol_flags & PKT_TX_IP_CKSUM)
+				copy_len = l4_off;
+		}
+	}
+
+	seg = mbuf;
+	if (copy_len) {
+		/* Support only headers included in the first segment */
+		if (unlikely(copy_len > TAP_HDR_COPY_MAX ||
+			     copy_len > rte_pktmbuf_data_len(mbuf)))
+			return -1;
+		rte_memcpy(copy, rte_pktmbuf_mtod(mbuf, void *), copy_len);
+		l3_hdr = copy + mbuf->l2_len;
+		if (ol_flags & PKT_TX_IPV4) {
+			struct rte_ipv4_hdr *iph = l3_hdr;
+
+			if (ol_flags & PKT_TX_TCP_SEG)
+				iph->total_length = rte_cpu_to_be_16(
+					mbuf->pkt_len - mbuf->l2_len);
+			if (ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_TCP_SEG)) {
+				iph->hdr_checksum = 0;
+				iph->hdr_checksum = rte_ipv4_cksum(iph);
+			}
+		} else if (ol_flags & PKT_TX_TCP_SEG) {
+			struct rte_ipv6_hdr *iph = l3_hdr;
+
+			iph->payload_len = rte_cpu_to_be_16(mbuf->pkt_len -
+				mbuf->l2_len - sizeof(struct rte_ipv6_hdr));
+		}
+		if (csum_offset) {
+			uint16_t *l4_cksum = (uint16_t *)
+				(copy + l4_off + csum_offset);
+
+			*l4_cksum = (ol_flags & PKT_TX_IPV4) ?
+				rte_ipv4_phdr_cksum(l3_hdr, 0) :
+				rte_ipv6_phdr_cksum(l3_hdr, 0);
+			vnet->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+			vnet->csum_start = l4_off;
+			vnet->csum_offset = csum_offset;
+		}
+		iovecs[k].iov_base = copy;
+		iovecs[k].iov_len = copy_len;
+		k++;
+	}
+
+	if (rte_pktmbuf_data_len(seg) > copy_len) {
+		iovecs[k].iov_base = rte_pktmbuf_mtod_offset(seg, void *,
+							     copy_len);
+		iovecs[k].iov_len = rte_pktmbuf_data_len(seg) - copy_len;
+		k++;
+	}
+	for (seg = seg->next; seg != NULL; seg = seg->next) {
+		iovecs[k].iov_base = rte_pktmbuf_mtod(seg, void *);
+		iovecs[k].iov_len = rte_pktmbuf_data_len(seg);
+		k++;
+	}
+
+	return k;
+}
+
+/* Write the batched packets with one system call and free them */
+static void
+tap_tx_batch_flush(struct tx_queue *txq, struct uring *ur, int fd,
+		   struct rte_mbuf **pkts, const int *iovcnt, uint16_t nb,
+		   uint16_t *num_packets, unsigned long *num_tx_bytes)
+{
+	int res[TAP_BATCH_SIZE];
+	uint16_t i;
+
+	if (nb == 0)
+		return;
+	if (uring_submit(ur, res) < 0) {
+		/* Fall back to one system call per packet */
+		for (i = 0; i < nb; i++)
+			res[i] = writev(fd, txq->batch_iovecs[i], iovcnt[i]);
+	}
+	for (i = 0; i < nb; i++) {
+		if (res[i] > 0) {
+			(*num_packets)++;
+			(*num_tx_bytes) += rte_pktmbuf_pkt_len(pkts[i]);
+		} else {
+			txq->stats.errs++;
+		}
+		rte_pktmbuf_free(pkts[i]);
+	}
+}
+
+/* Callback to send packets with a virtio-net header on the tap interface,
+ * a burst at once when io_uring is available.
+ */
+static uint16_t
+pmd_tx_burst_vnet(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct tx_queue *txq = queue;
+	struct pmd_process_private *process_private;
+	struct uring *ur;
+	int iovcnt[TAP_BATCH_SIZE];
+	uint16_t num_tx;
+	uint16_t num_packets = 0;
+	unsigned long num_tx_bytes = 0;
+	uint32_t max_size;
+	uint16_t nb = 0;
+	int fd;
+
+	process_private = rte_eth_devices[txq->out_port].process_private;
+	ur = process_private->txq_urings[txq->queue_id];
+	fd = process_private->txq_fds[txq->queue_id];
+	max_size = *txq->mtu + (RTE_ETHER_HDR_LEN + RTE_ETHER_CRC_LEN + 4);
+	for (num_tx = 0; num_tx < nb_pkts; num_tx++) {
+		struct rte_mbuf *mbuf = bufs[num_tx];
+		int n;
+
+		/* stats.errs will be incremented */
+		if (!(mbuf->ol_flags & PKT_TX_TCP_SEG) &&
+		    rte_pktmbuf_pkt_len(mbuf) > max_size)
+			break;
+
+		if (ur != NULL && mbuf->nb_segs + 2 <= TAP_BATCH_IOV_MAX) {
+			n = tap_tx_vnet_prepare(txq, mbuf,
+						&txq->batch_hdrs[nb],
+						txq->batch_copies[nb],
+						txq->batch_iovecs[nb]);
+			if (n < 0)
+				break;
+			tap_uring_prep_rw(ur, fd, true, txq->batch_iovecs[nb],
+					  n);
+			iovcnt[nb++] = n;
+			if (nb == TAP_BATCH_SIZE) {
+				tap_tx_batch_flush(txq, ur, fd,
+						   bufs + num_tx + 1 - nb,
+						   iovcnt, nb, &num_packets,
+						   &num_tx_bytes);
+				nb = 0;
+			}
+		} else {
+			struct iovec iovecs[mbuf->nb_segs + 2];
+
+			/* Keep the packets in order */
+			tap_tx_batch_flush(txq, ur, fd, bufs + num_tx - nb,
+					   iovcnt, nb, &num_packets,
+					   &num_tx_bytes);
+			nb = 0;
+			n = tap_tx_vnet_prepare(txq, mbuf, &txq->batch_hdrs[0],
+						txq->batch_copies[0], iovecs);
+			if (n < 0)
+				break;
+			if (writev(fd, iovecs, n) > 0) {
+				num_packets++;
+				num_tx_bytes += rte_pktmbuf_pkt_len(mbuf);
+			} else {
+				txq->stats.errs++;
+			}
+			rte_pktmbuf_free(mbuf);
+		}
+	}
+	tap_tx_batch_flush(txq, ur, fd, bufs + num_tx - nb, iovcnt, nb,
+			   &num_packets, &num_tx_bytes);
+
+	txq->stats.opackets += num_packets;
+	txq->stats.errs += nb_pkts - num_tx;
+	txq->stats.obytes += num_tx_bytes;
+
+	return num_tx;
+}
+
 static const char *
 tap_ioctl_req2str(unsigned long request)
 {
@@ -871,6 +1223,13 @@ tap_dev_configure(struct rte_eth_dev *dev)
 			RTE_PMD_TAP_MAX_QUEUES);
 		return -1;
 	}
+	/* Aggregated TCP packets do not fit in a single mbuf */
+	if ((dev->data->dev_conf.rxmode.offloads & DEV_RX_OFFLOAD_TCP_LRO) &&
+	    !(dev->data->dev_conf.rxmode.offloads & DEV_RX_OFFLOAD_SCATTER)) {
+		TAP_LOG(ERR, "%s: TCP LRO needs the scatter Rx offload",
+			dev->device->name);
+		return -EINVAL;
+	}
 
 	TAP_LOG(INFO, "%s: %s: TX configured queues number: %u",
 		dev->device->name, pmd->name, dev->data->nb_tx_queues);
@@ -928,6 +1287,9 @@ tap_dev_info(struct rte_eth_dev *dev, struct rte_eth_dev_info *dev_info)
 	dev_info->min_rx_bufsize = 0;
 	dev_info->speed_capa = tap_dev_speed_capa();
 	dev_info->rx_queue_offload_capa = tap_rx_offload_get_queue_capa();
+	/* The kernel can send TCP packets before segmentation */
+	if (internals->vnet_hdr)
+		dev_info->rx_queue_offload_capa |= DEV_RX_OFFLOAD_TCP_LRO;
 	dev_info->rx_offload_capa = tap_rx_offload_get_port_capa() |
 				    dev_info->rx_queue_offload_capa;
 	dev_info->tx_queue_offload_capa = tap_tx_offload_get_queue_capa();
@@ -1024,6 +1386,10 @@ tap_dev_close(struct rte_eth_dev *dev)
 			close(process_private->txq_fds[i]);
 			process_private->txq_fds[i] = -1;
 		}
+		uring_destroy(process_private->rxq_urings[i]);
+		process_private->rxq_urings[i] = NULL;
+		uring_destroy(process_private->txq_urings[i]);
+		process_private->txq_urings[i] = NULL;
 	}
 
 	if (internals->remote_if_index) {
@@ -1047,10 +1413,17 @@ tap_rx_queue_release(void *queue)
 {
 	struct rx_queue *rxq = queue;
 	struct pmd_process_private *process_private;
+	int i;
 
 	if (!rxq)
 		return;
 	process_private = rte_eth_devices[rxq->in_port].process_private;
+	for (i = 0; i < TAP_BATCH_SIZE; i++) {
+		rte_pktmbuf_free(rxq->batch_mbufs[i]);
+		rxq->batch_mbufs[i] = NULL;
+	}
+	uring_destroy(process_private->rxq_urings[rxq->queue_id]);
+	process_private->rxq_urings[rxq->queue_id] = NULL;
 	if (process_private->rxq_fds[rxq->queue_id] > 0) {
 		close(process_private->rxq_fds[rxq->queue_id]);
 		process_private->rxq_fds[rxq->queue_id] = -1;
@@ -1070,6 +1443,8 @@ tap_tx_queue_release(void *queue)
 	if (!txq)
 		return;
 	process_private = rte_eth_devices[txq->out_port].process_private;
+	uring_destroy(process_private->txq_urings[txq->queue_id]);
+	process_private->txq_urings[txq->queue_id] = NULL;
 
 	if (process_private->txq_fds[txq->queue_id] > 0) {
 		close(process_private->txq_fds[txq->queue_id]);
@@ -1274,7 +1649,8 @@ tap_setup_queue(struct rte_eth_dev *dev,
 		fd = &process_private->txq_fds[qid];
 		other_fd = &process_private->rxq_fds[qid];
 		dir = "tx";
-		gso_ctx = &tx->gso_ctx;
+		/* The kernel segments the packets with a virtio-net header */
+		gso_ctx = pmd->vnet_hdr ? NULL : &tx->gso_ctx;
 	}
 	if (*fd != -1) {
 		/* fd for this queue already exists */
@@ -1312,16 +1688,38 @@ tap_setup_queue(struct rte_eth_dev *dev,
 	}
 
 	tx->type = pmd->type;
+	tx->vnet_hdr = pmd->vnet_hdr;
 
 	return *fd;
 }
 
+/* Let the kernel send packets with partial checksums or not segmented */
+static int
+tap_rx_offload_set(struct pmd_internals *pmd, int fd, uint64_t offloads)
+{
+	unsigned int tun_offloads = 0;
+
+	if (!pmd->vnet_hdr)
+		return 0;
+	if (offloads & DEV_RX_OFFLOAD_TCP_LRO)
+		tun_offloads = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+	else if (offloads & (DEV_RX_OFFLOAD_UDP_CKSUM |
+			     DEV_RX_OFFLOAD_TCP_CKSUM))
+		tun_offloads = TUN_F_CSUM;
+	if (ioctl(fd, TUNSETOFFLOAD, tun_offloads) < 0) {
+		TAP_LOG(WARNING, "%s: unable to set offloads %#x: %s",
+			pmd->name, tun_offloads, strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
 static int
 tap_rx_queue_setup(struct rte_eth_dev *dev,
 		   uint16_t rx_queue_id,
 		   uint16_t nb_rx_desc,
 		   unsigned int socket_id,
-		   const struct rte_eth_rxconf *rx_conf __rte_unused,
+		   const struct rte_eth_rxconf *rx_conf,
 		   struct rte_mempool *mp)
 {
 	struct pmd_internals *internals = dev->data->dev_private;
@@ -1349,6 +1747,13 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 			dev->data->nb_rx_queues);
 		return -1;
 	}
+	/* The Rx burst reads multi-segment packets with the port offload */
+	if ((rx_conf->offloads & DEV_RX_OFFLOAD_TCP_LRO) &&
+	    !(dev->data->dev_conf.rxmode.offloads & DEV_RX_OFFLOAD_SCATTER)) {
+		TAP_LOG(ERR, "%s: TCP LRO needs the scatter Rx offload",
+			dev->device->name);
+		return -EINVAL;
+	}
 
 	rxq->mp = mp;
 	rxq->trigger_seen = 1; /* force initial burst */
@@ -1372,8 +1777,30 @@ tap_rx_queue_setup(struct rte_eth_dev *dev,
 		goto error;
 	}
 
-	(*rxq->iovecs)[0].iov_len = sizeof(struct tun_pi);
-	(*rxq->iovecs)[0].iov_base = &rxq->pi;
+	rxq->hdr_len = sizeof(struct tun_pi);
+	if (internals->vnet_hdr)
+		rxq->hdr_len += sizeof(struct virtio_net_hdr);
+	(*rxq->iovecs)[0].iov_len = rxq->hdr_len;
+	(*rxq->iovecs)[0].iov_base = &rxq->hdr;
+	for (i = 0; i < TAP_BATCH_SIZE; i++) {
+		rxq->batch_iovecs[i][0].iov_len = rxq->hdr_len;
+		rxq->batch_iovecs[i][0].iov_base = &rxq->batch_hdrs[i];
+	}
+
+	ret = tap_rx_offload_set(internals, fd, rx_conf->offloads |
+				 dev->data->dev_conf.rxmode.offloads);
+	if (ret < 0)
+		goto error;
+
+	/* Batched reads if io_uring is available */
+	if (process_private->rxq_urings[rx_queue_id] == NULL) {
+		process_private->rxq_urings[rx_queue_id] =
+			uring_create(TAP_BATCH_SIZE);
+		if (process_private->rxq_urings[rx_queue_id] == NULL)
+			TAP_LOG(DEBUG, "%s: no io_uring for Rx queue %d: %s",
+				internals->name, rx_queue_id,
+				strerror(errno));
+	}
 
 	for (i = 1; i <= nb_desc; i++) {
 		*tmp = rte_pktmbuf_alloc(rxq->mp);
@@ -1434,6 +1861,17 @@ tap_tx_queue_setup(struct rte_eth_dev *dev,
 	ret = tap_setup_queue(dev, internals, tx_queue_id, 0);
 	if (ret == -1)
 		return -1;
+
+	/* Batched writes if io_uring is available */
+	if (internals->vnet_hdr &&
+	    process_private->txq_urings[tx_queue_id] == NULL) {
+		process_private->txq_urings[tx_queue_id] =
+			uring_create(TAP_BATCH_SIZE);
+		if (process_private->txq_urings[tx_queue_id] == NULL)
+			TAP_LOG(DEBUG, "%s: no io_uring for Tx queue %d: %s",
+				internals->name, tx_queue_id,
+				strerror(errno));
+	}
 	TAP_LOG(DEBUG,
 		"  TX TUNTAP device name %s, qid %d on fd %d csum %s",
 		internals->name, tx_queue_id,
@@ -1772,6 +2210,8 @@ eth_dev_tap_create(struct rte_vdev_device *vdev, const char *tap_name,
 		goto error_exit;
 	}
 	TAP_LOG(DEBUG, "allocated %s", pmd->name);
+	if (pmd->vnet_hdr)
+		dev->tx_pkt_burst = pmd_tx_burst_vnet;
 
 	ifr.ifr_mtu = dev->data->mtu;
 	if (tap_ioctl(pmd, SIOCSIFMTU, &ifr, 1, LOCAL_AND_REMOTE) < 0)
@@ -2094,6 +2534,7 @@ tap_mp_attach_queues(const char *port_name, struct rte_eth_dev *dev)
 	struct ipc_queues *request_param = (struct ipc_queues *)request.param;
 	struct ipc_queues *reply_param;
 	struct pmd_process_private *process_private = dev->process_private;
+	struct pmd_internals *pmd = dev->data->dev_private;
 	int queue, fd_iterator;
 
 	/* Prepare the request */
@@ -2127,6 +2568,16 @@ tap_mp_attach_queues(const char *port_name, struct rte_eth_dev *dev)
 	for (queue = 0; queue < reply_param->txq_count; queue++)
 		process_private->txq_fds[queue] = reply->fds[fd_iterator++];
 	free(reply);
+
+	/* The io_uring instances for batched I/O are per process */
+	for (queue = 0; queue < dev->data->nb_rx_queues; queue++)
+		process_private->rxq_urings[queue] =
+			uring_create(TAP_BATCH_SIZE);
+	if (pmd->vnet_hdr) {
+		for (queue = 0; queue < dev->data->nb_tx_queues; queue++)
+			process_private->txq_urings[queue] =
+				uring_create(TAP_BATCH_SIZE);
+	}
 	return 0;
 }
 
@@ -2218,6 +2669,9 @@ rte_pmd_tap_probe(struct rte_vdev_device *dev)
 		eth_dev->device = &dev->device;
 		eth_dev->rx_pkt_burst = pmd_rx_burst;
 		eth_dev->tx_pkt_burst = pmd_tx_burst;
+		if (((struct pmd_internals *)
+		     eth_dev->data->dev_private)->vnet_hdr)
+			eth_dev->tx_pkt_burst = pmd_tx_burst_vnet;
 		if (!rte_eal_primary_proc_alive(NULL)) {
 			TAP_LOG(ERR, "Primary process is missing");
 			return -1;
@@ -2353,6 +2807,10 @@ rte_pmd_tap_remove(struct rte_vdev_device *dev)
 			close(process_private->txq_fds[i]);
 			process_private->txq_fds[i] = -1;
 		}
+		uring_destroy(process_private->rxq_urings[i]);
+		process_private->rxq_urings[i] = NULL;
+		uring_destroy(process_private->txq_urings[i]);
+		process_private->txq_urings[i] = NULL;
 	}
 
 	close(internals->ioctl_sock);
@@ -12,11 +12,13 @@
 #include <net/if.h>
 
 #include <linux/if_tun.h>
+#include <linux/virtio_net.h>
 
 #include <rte_ethdev_driver.h>
 #include <rte_ether.h>
 #include <rte_gso.h>
 #include "tap_log.h"
+#include "tap_uring.h"
 
 #ifdef IFF_MULTI_QUEUE
 #define RTE_PMD_TAP_MAX_QUEUES	TAP_MAX_QUEUES
@@ -25,6 +27,13 @@
 #endif
 #define MAX_GSO_MBUFS 64
 
+/* Packets read or written by one system call on a queue */
+#define TAP_BATCH_SIZE 32
+/* Iovecs of a batched packet: headers, headers copy and segments */
+#define TAP_BATCH_IOV_MAX 16
+/* Room to update the L2, L3 and L4 headers of a packet sent */
+#define TAP_HDR_COPY_MAX 256
+
 enum rte_tuntap_type {
 	ETH_TUNTAP_TYPE_UNKNOWN,
 	ETH_TUNTAP_TYPE_TUN,
@@ -42,6 +51,12 @@ struct pkt_stats {
 	uint64_t rx_nombuf;             /* Nb of RX mbuf alloc failures */
 };
 
+/* Headers before each packet read from or written to a queue */
+struct tap_pkt_hdr {
+	struct tun_pi pi;               /* Packet information */
+	struct virtio_net_hdr vnet;     /* Offloads, with IFF_VNET_HDR */
+};
+
 struct rx_queue {
 	struct rte_mempool *mp;         /* Mempool for RX packets */
 	uint32_t trigger_seen;          /* Last seen Rx trigger value */
@@ -52,17 +67,27 @@ struct rx_queue {
 	struct rte_eth_rxmode *rxmode;  /* RX features */
 	struct rte_mbuf *pool;          /* mbufs pool for this queue */
 	struct iovec (*iovecs)[];       /* descriptors for this queue */
-	struct tun_pi pi;               /* packet info for iovecs */
+	struct tap_pkt_hdr hdr;         /* packet headers for iovecs */
+	uint16_t hdr_len;               /* Length of the packet headers */
+	/* Single segment mbufs and descriptors for batched reads */
+	struct rte_mbuf *batch_mbufs[TAP_BATCH_SIZE];
+	struct tap_pkt_hdr batch_hdrs[TAP_BATCH_SIZE];
+	struct iovec batch_iovecs[TAP_BATCH_SIZE][2];
 };
 
 struct tx_queue {
 	int type;                       /* Type field - TUN|TAP */
 	uint16_t *mtu;                  /* Pointer to MTU from dev_data */
 	uint16_t csum:1;                /* Enable checksum offloading */
+	uint16_t vnet_hdr:1;            /* Offloads done by the kernel */
 	struct pkt_stats stats;         /* Stats for this TX queue */
 	struct rte_gso_ctx gso_ctx;     /* GSO context */
 	uint16_t out_port;              /* Port ID */
 	uint16_t queue_id;		/* queue ID*/
+	/* Headers and descriptors for batched writes */
+	struct tap_pkt_hdr batch_hdrs[TAP_BATCH_SIZE];
+	uint8_t batch_copies[TAP_BATCH_SIZE][TAP_HDR_COPY_MAX];
+	struct iovec batch_iovecs[TAP_BATCH_SIZE][TAP_BATCH_IOV_MAX];
 };
 
 struct pmd_internals {
@@ -80,6 +105,7 @@ struct pmd_internals {
 	int flower_support;               /* 1 if kernel supports, else 0 */
 	int flower_vlan_support;          /* 1 if kernel supports, else 0 */
 	int rss_enabled;                  /* 1 if RSS is enabled, else 0 */
+	int vnet_hdr;                     /* 1 if IFF_VNET_HDR is set */
 	/* implicit rules set when RSS is enabled */
 	int map_fd;                       /* BPF RSS map fd */
 	int bpf_fd[RTE_PMD_TAP_MAX_QUEUES];/* List of bpf fds per queue */
@@ -96,6 +122,9 @@ struct pmd_internals {
 struct pmd_process_private {
 	int rxq_fds[RTE_PMD_TAP_MAX_QUEUES];
 	int txq_fds[RTE_PMD_TAP_MAX_QUEUES];
+	/* Batched I/O, NULL if io_uring is not available */
+	struct uring *rxq_urings[RTE_PMD_TAP_MAX_QUEUES];
+	struct uring *txq_urings[RTE_PMD_TAP_MAX_QUEUES];
 };
 
 /* tap_intr.c */
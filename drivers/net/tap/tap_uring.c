@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+/**
+ * @file
+ * Batched I/O on the tap queues through io_uring.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#include <tap_autoconf.h>
+#include <tap_uring.h>
+
+#ifdef HAVE_IO_URING
+
+#include <linux/io_uring.h>
+
+#ifndef RWF_NOWAIT
+#define RWF_NOWAIT 0x00000008
+#endif
+
+/**
+ * Queue a vectored read or write on a tap queue.
+ *
+ * The reads never wait for a packet: on an empty queue they complete
+ * with -EAGAIN, so that no read is left pending in the kernel.
+ */
+void
+tap_uring_prep_rw(struct uring *ur, int fd, bool write,
+		  const struct iovec *iov, int iovcnt)
+{
+	struct io_uring_sqe *sqe = uring_get_sqe(ur);
+
+	sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+	sqe->fd = fd;
+	sqe->addr = (uintptr_t)iov;
+	sqe->len = iovcnt;
+	sqe->rw_flags = write ? 0 : RWF_NOWAIT;
+}
+
+#else /* HAVE_IO_URING */
+
+void
+tap_uring_prep_rw(struct uring *ur __rte_unused, int fd __rte_unused,
+		  bool write __rte_unused,
+		  const struct iovec *iov __rte_unused,
+		  int iovcnt __rte_unused)
+{
+}
+
+#endif /* HAVE_IO_URING */
@@ -0,0 +1,22 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _TAP_URING_H_
+#define _TAP_URING_H_
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include <uring_common.h>
+
+/*
+ * A tap queue file descriptor is a character device: it reads or writes a
+ * single packet per system call and does not support recvmmsg() and
+ * sendmmsg(). An io_uring submits the vectored reads or writes of a whole
+ * burst to the kernel in one system call instead.
+ */
+void tap_uring_prep_rw(struct uring *ur, int fd, bool write,
+		       const struct iovec *iov, int iovcnt);
+
+#endif /* _TAP_URING_H_ */
@@ -17,6 +17,7 @@
 #include <rte_spinlock.h>
 
 #include "rte_eth_vhost.h"
+#include "rte_eth_vhost_async.h"
 
 static int vhost_logtype;
 
@@ -31,7 +32,10 @@ enum {VIRTIO_RXQ, VIRTIO_TXQ, VIRTIO_QNUM};
 #define ETH_VHOST_DEQUEUE_ZERO_COPY	"dequeue-zero-copy"
 #define ETH_VHOST_IOMMU_SUPPORT		"iommu-support"
 #define ETH_VHOST_POSTCOPY_SUPPORT	"postcopy-support"
+#define ETH_VHOST_ASYNC_COPY_LCORE	"async-copy-lcore"
 #define VHOST_MAX_PKT_BURST 32
+/* Packets shorter than this are copied by the lcore enqueuing them */
+#define VHOST_ASYNC_COPY_THRESHOLD 256
 
 static const char *valid_arguments[] = {
 	ETH_VHOST_IFACE_ARG,
@@ -40,6 +44,7 @@ static const char *valid_arguments[] = {
 	ETH_VHOST_DEQUEUE_ZERO_COPY,
 	ETH_VHOST_IOMMU_SUPPORT,
 	ETH_VHOST_POSTCOPY_SUPPORT,
+	ETH_VHOST_ASYNC_COPY_LCORE,
 	NULL
 };
 
@@ -89,6 +94,8 @@ struct vhost_queue {
 	uint16_t port;
 	uint16_t virtqueue_id;
 	struct vhost_stats stats;
+	/* serializes the submissions and completions of async copies */
+	rte_spinlock_t async_lock;
 };
 
 struct pmd_internal {
@@ -99,6 +106,10 @@ struct pmd_internal {
 	int vid;
 	rte_atomic32_t started;
 	uint8_t vlan_strip;
+	/* copy engine of the enqueue path, NULL if copies are synchronous */
+	struct eth_vhost_async *async;
+	/* the enqueue queues of the device use the copy engine */
+	uint8_t async_attached;
 };
 
 struct internal_list {
@@ -367,6 +378,21 @@ vhost_update_packet_xstats(struct vhost_queue *vq,
 	}
 }
 
+/* Return to the guest the packets whose copies are done, and free them */
+static void
+eth_vhost_async_complete(struct vhost_queue *r)
+{
+	struct rte_mbuf *pkts[VHOST_MAX_PKT_BURST];
+	uint16_t i, nb_pkts;
+
+	do {
+		nb_pkts = rte_vhost_poll_enqueue_completed(r->vid,
+				r->virtqueue_id, pkts, VHOST_MAX_PKT_BURST);
+		for (i = 0; i < nb_pkts; i++)
+			rte_pktmbuf_free(pkts[i]);
+	} while (nb_pkts == VHOST_MAX_PKT_BURST);
+}
+
 static uint16_t
 eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
@@ -412,6 +438,22 @@ eth_vhost_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 
 	vhost_update_packet_xstats(r, bufs, nb_rx);
 
+	/*
+	 * Complete the copies of the paired Tx queue, in case its lcore
+	 * stopped sending, unless it is in a Tx burst.
+	 */
+	if (r->internal->async_attached) {
+		struct rte_eth_dev_data *data = rte_eth_devices[r->port].data;
+		uint16_t qid = r->virtqueue_id / VIRTIO_QNUM;
+		struct vhost_queue *txq;
+
+		txq = qid < data->nb_tx_queues ? data->tx_queues[qid] : NULL;
+		if (txq != NULL && rte_spinlock_trylock(&txq->async_lock)) {
+			eth_vhost_async_complete(txq);
+			rte_spinlock_unlock(&txq->async_lock);
+		}
+	}
+
 out:
 	rte_atomic32_set(&r->while_queuing, 0);
 
@@ -449,14 +491,25 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 		++nb_send;
 	}
 
+	/*
+	 * The packets submitted to the copy engine are freed once their
+	 * copies are done, not before the stats are updated.
+	 */
+	if (r->internal->async_attached)
+		rte_spinlock_lock(&r->async_lock);
+
 	/* Enqueue packets to guest RX queue */
 	while (nb_send) {
 		uint16_t nb_pkts;
 		uint16_t num = (uint16_t)RTE_MIN(nb_send,
 						 VHOST_MAX_PKT_BURST);
 
-		nb_pkts = rte_vhost_enqueue_burst(r->vid, r->virtqueue_id,
-						  &bufs[nb_tx], num);
+		if (r->internal->async_attached)
+			nb_pkts = rte_vhost_submit_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
+		else
+			nb_pkts = rte_vhost_enqueue_burst(r->vid,
+					r->virtqueue_id, &bufs[nb_tx], num);
 
 		nb_tx += nb_pkts;
 		nb_send -= nb_pkts;
@@ -479,8 +532,13 @@ eth_vhost_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	for (i = nb_tx; i < nb_bufs; i++)
 		vhost_count_multicast_broadcast(r, bufs[i]);
 
-	for (i = 0; likely(i < nb_tx); i++)
-		rte_pktmbuf_free(bufs[i]);
+	if (r->internal->async_attached) {
+		eth_vhost_async_complete(r);
+		rte_spinlock_unlock(&r->async_lock);
+	} else {
+		for (i = 0; likely(i < nb_tx); i++)
+			rte_pktmbuf_free(bufs[i]);
+	}
 out:
 	rte_atomic32_set(&r->while_queuing, 0);
 
@@ -715,6 +773,57 @@ queue_setup(struct rte_eth_dev *eth_dev, struct pmd_internal *internal)
 	}
 }
 
+static void
+async_teardown(struct pmd_internal *internal, int vid)
+{
+	struct rte_mbuf *pkts[VHOST_MAX_PKT_BURST];
+	uint16_t i, n, qid;
+
+	for (qid = VIRTIO_RXQ; qid < internal->max_queues * VIRTIO_QNUM;
+			qid += VIRTIO_QNUM) {
+		/* the copies in flight must be completed to unregister */
+		while (rte_vhost_async_get_inflight(vid, qid) > 0) {
+			n = rte_vhost_poll_enqueue_completed(vid, qid, pkts,
+					VHOST_MAX_PKT_BURST);
+			for (i = 0; i < n; i++)
+				rte_pktmbuf_free(pkts[i]);
+			if (n == 0)
+				rte_pause();
+		}
+		rte_vhost_async_channel_unregister(vid, qid);
+	}
+
+	eth_vhost_async_detach(vid);
+	internal->async_attached = 0;
+}
+
+static void
+async_setup(struct pmd_internal *internal, int vid)
+{
+	uint16_t nb_queues, qid;
+
+	nb_queues = RTE_MIN(internal->max_queues,
+			rte_vhost_get_vring_num(vid) / VIRTIO_QNUM);
+
+	if (eth_vhost_async_attach(internal->async, vid) < 0)
+		goto fail;
+
+	for (qid = VIRTIO_RXQ; qid < nb_queues * VIRTIO_QNUM;
+			qid += VIRTIO_QNUM) {
+		if (rte_vhost_async_channel_register(vid, qid,
+				VHOST_ASYNC_COPY_THRESHOLD,
+				&eth_vhost_async_ops) < 0)
+			goto fail;
+	}
+
+	internal->async_attached = 1;
+	return;
+
+fail:
+	VHOST_LOG(NOTICE, "Async copy not available on device %d\n", vid);
+	async_teardown(internal, vid);
+}
+
 static int
 new_device(int vid)
 {
@@ -763,6 +872,9 @@ new_device(int vid)
 	for (i = 0; i < rte_vhost_get_vring_num(vid); i++)
 		rte_vhost_enable_guest_notification(vid, i, 0);
 
+	if (internal->async)
+		async_setup(internal, vid);
+
 	rte_vhost_get_mtu(vid, &eth_dev->data->mtu);
 
 	eth_dev->data->dev_link.link_status = ETH_LINK_UP;
@@ -800,6 +912,9 @@ destroy_device(int vid)
 	rte_atomic32_set(&internal->dev_attached, 0);
 	update_queuing_status(eth_dev);
 
+	if (internal->async_attached)
+		async_teardown(internal, vid);
+
 	eth_dev->data->dev_link.link_status = ETH_LINK_DOWN;
 
 	if (eth_dev->data->rx_queues && eth_dev->data->tx_queues) {
@@ -1000,6 +1115,7 @@ eth_dev_close(struct rte_eth_dev *dev)
 		for (i = 0; i < dev->data->nb_tx_queues; i++)
 			rte_free(dev->data->tx_queues[i]);
 
+	eth_vhost_async_free(internal->async);
 	free(internal->dev_name);
 	free(internal->iface_name);
 	rte_free(internal);
@@ -1049,6 +1165,7 @@ eth_tx_queue_setup(struct rte_eth_dev *dev, uint16_t tx_queue_id,
 	}
 
 	vq->virtqueue_id = tx_queue_id * VIRTIO_QNUM + VIRTIO_RXQ;
+	rte_spinlock_init(&vq->async_lock);
 	dev->data->tx_queues[tx_queue_id] = vq;
 
 	return 0;
@@ -1201,7 +1318,8 @@ static const struct eth_dev_ops ops = {
 
 static int
 eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
-	int16_t queues, const unsigned int numa_node, uint64_t flags)
+	int16_t queues, const unsigned int numa_node, uint64_t flags,
+	int async_lcore)
 {
 	const char *name = rte_vdev_device_name(dev);
 	struct rte_eth_dev_data *data;
@@ -1249,6 +1367,16 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 	if (internal->iface_name == NULL)
 		goto error;
 
+	if (async_lcore >= 0) {
+		internal->async = eth_vhost_async_create(name, queues,
+				async_lcore, numa_node);
+		if (internal->async == NULL) {
+			VHOST_LOG(ERR, "Failed to run async copy on lcore %d\n",
+				async_lcore);
+			goto error;
+		}
+	}
+
 	list->eth_dev = eth_dev;
 	pthread_mutex_lock(&internal_list_lock);
 	TAILQ_INSERT_TAIL(&internal_list, list, next);
@@ -1289,6 +1417,7 @@ eth_dev_vhost_create(struct rte_vdev_device *dev, char *iface_name,
 
 error:
 	if (internal) {
+		eth_vhost_async_free(internal->async);
 		free(internal->iface_name);
 		free(internal->dev_name);
 	}
@@ -1339,6 +1468,8 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 	int dequeue_zero_copy = 0;
 	int iommu_support = 0;
 	int postcopy_support = 0;
+	uint16_t async_lcore;
+	int async_copy = 0;
 	struct rte_eth_dev *eth_dev;
 	const char *name = rte_vdev_device_name(dev);
 
@@ -1420,11 +1551,20 @@ rte_pmd_vhost_probe(struct rte_vdev_device *dev)
 			flags |= RTE_VHOST_USER_POSTCOPY_SUPPORT;
 	}
 
+	if (rte_kvargs_count(kvlist, ETH_VHOST_ASYNC_COPY_LCORE) == 1) {
+		ret = rte_kvargs_process(kvlist, ETH_VHOST_ASYNC_COPY_LCORE,
+					 &open_int, &async_lcore);
+		if (ret < 0)
+			goto out_free;
+
+		async_copy = 1;
+	}
+
 	if (dev->device.numa_node == SOCKET_ID_ANY)
 		dev->device.numa_node = rte_socket_id();
 
 	eth_dev_vhost_create(dev, iface_name, queues, dev->device.numa_node,
-		flags);
+		flags, async_copy ? async_lcore : -1);
 
 out_free:
 	rte_kvargs_free(kvlist);
@@ -1468,7 +1608,8 @@ RTE_PMD_REGISTER_PARAM_STRING(net_vhost,
 	"client=<0|1> "
 	"dequeue-zero-copy=<0|1> "
 	"iommu-support=<0|1> "
-	"postcopy-support=<0|1>");
+	"postcopy-support=<0|1> "
+	"async-copy-lcore=<int>");
 
 RTE_INIT(vhost_init_log)
 {
@@ -0,0 +1,281 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_atomic.h>
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_memcpy.h>
+#include <rte_pause.h>
+#include <rte_service.h>
+#include <rte_service_component.h>
+
+#include "rte_eth_vhost_async.h"
+
+/* Same limit as the number of devices of the vhost library */
+#define ETH_VHOST_ASYNC_MAX_VID 1024
+
+#define ETH_VHOST_ASYNC_JOBS 1024
+#define ETH_VHOST_ASYNC_JOBS_MASK (ETH_VHOST_ASYNC_JOBS - 1)
+/* Larger than the copies of a submitted burst, which always fit */
+#define ETH_VHOST_ASYNC_SEGS 4096
+#define ETH_VHOST_ASYNC_SEGS_MASK (ETH_VHOST_ASYNC_SEGS - 1)
+
+/* The copies of a packet, in the segment ring of its channel */
+struct eth_vhost_async_job {
+	uint32_t seg_idx;
+	uint32_t nr_segs;
+};
+
+/*
+ * Single producer, single consumer channel between the lcore enqueuing
+ * on a vhost queue and the engine. The counters are free running.
+ */
+struct eth_vhost_async_channel {
+	/* written by the enqueuing lcore */
+	uint32_t job_head;
+	uint32_t seg_head;
+	uint32_t job_reported;
+	volatile uint32_t job_prod;
+
+	/* written by the engine */
+	volatile uint32_t job_tail __rte_cache_aligned;
+	volatile uint32_t seg_tail;
+
+	struct eth_vhost_async_job jobs[ETH_VHOST_ASYNC_JOBS]
+		__rte_cache_aligned;
+	struct rte_vhost_async_seg segs[ETH_VHOST_ASYNC_SEGS];
+} __rte_cache_aligned;
+
+struct eth_vhost_async {
+	uint32_t service_id;
+	unsigned int lcore_id;
+	uint16_t nb_channels;
+	struct eth_vhost_async_channel channels[];
+};
+
+static struct eth_vhost_async *async_devs[ETH_VHOST_ASYNC_MAX_VID];
+
+/* The enqueue virtqueues of a port are the even ones */
+static inline struct eth_vhost_async_channel *
+async_channel(int vid, uint16_t queue_id)
+{
+	struct eth_vhost_async *async;
+
+	if (unlikely(vid < 0 || vid >= ETH_VHOST_ASYNC_MAX_VID))
+		return NULL;
+
+	async = async_devs[vid];
+	if (unlikely(async == NULL || (queue_id >> 1) >= async->nb_channels))
+		return NULL;
+
+	return &async->channels[queue_id >> 1];
+}
+
+static int32_t
+eth_vhost_async_transfer(int vid, uint16_t queue_id,
+		const struct rte_vhost_async_desc *descs, uint16_t count)
+{
+	struct eth_vhost_async_channel *ch = async_channel(vid, queue_id);
+	struct eth_vhost_async_job *job;
+	uint32_t job_tail, seg_tail;
+	uint16_t i, j;
+
+	if (ch == NULL)
+		return -1;
+
+	job_tail = ch->job_tail;
+	seg_tail = ch->seg_tail;
+	rte_smp_rmb();
+
+	for (i = 0; i < count; i++) {
+		const struct rte_vhost_async_desc *desc = &descs[i];
+
+		if (ch->job_head - job_tail == ETH_VHOST_ASYNC_JOBS ||
+				ch->seg_head + desc->nr_segs - seg_tail >
+				ETH_VHOST_ASYNC_SEGS)
+			break;
+
+		for (j = 0; j < desc->nr_segs; j++)
+			ch->segs[(ch->seg_head + j) &
+				ETH_VHOST_ASYNC_SEGS_MASK] = desc->segs[j];
+
+		job = &ch->jobs[ch->job_head & ETH_VHOST_ASYNC_JOBS_MASK];
+		job->seg_idx = ch->seg_head;
+		job->nr_segs = desc->nr_segs;
+		ch->seg_head += desc->nr_segs;
+		ch->job_head++;
+	}
+
+	if (i) {
+		rte_smp_wmb();
+		ch->job_prod = ch->job_head;
+	}
+
+	return i;
+}
+
+static int32_t
+eth_vhost_async_check_completed(int vid, uint16_t queue_id,
+		uint16_t max_packets)
+{
+	struct eth_vhost_async_channel *ch = async_channel(vid, queue_id);
+	uint32_t n;
+
+	if (ch == NULL)
+		return -1;
+
+	n = RTE_MIN(ch->job_tail - ch->job_reported, (uint32_t)max_packets);
+	ch->job_reported += n;
+
+	return n;
+}
+
+struct rte_vhost_async_channel_ops eth_vhost_async_ops = {
+	.transfer_data = eth_vhost_async_transfer,
+	.check_completed_copies = eth_vhost_async_check_completed,
+};
+
+/* Do the pending copies of all the channels of a port */
+static int32_t
+eth_vhost_async_run(void *arg)
+{
+	struct eth_vhost_async *async = arg;
+	struct eth_vhost_async_channel *ch;
+	struct eth_vhost_async_job *job;
+	struct rte_vhost_async_seg *seg;
+	uint32_t prod, tail, j;
+	uint16_t i;
+
+	for (i = 0; i < async->nb_channels; i++) {
+		ch = &async->channels[i];
+		prod = ch->job_prod;
+		tail = ch->job_tail;
+		if (prod == tail)
+			continue;
+
+		rte_smp_rmb();
+
+		/* complete the packets one by one, for a low latency */
+		for (; tail != prod; tail++) {
+			job = &ch->jobs[tail & ETH_VHOST_ASYNC_JOBS_MASK];
+			for (j = 0; j < job->nr_segs; j++) {
+				seg = &ch->segs[(job->seg_idx + j) &
+					ETH_VHOST_ASYNC_SEGS_MASK];
+				rte_memcpy(seg->dst, seg->src, seg->len);
+			}
+
+			rte_smp_wmb();
+			ch->seg_tail = job->seg_idx + job->nr_segs;
+			ch->job_tail = tail + 1;
+		}
+	}
+
+	return 0;
+}
+
+struct eth_vhost_async *
+eth_vhost_async_create(const char *name, uint16_t nb_queues,
+		unsigned int lcore_id, int socket_id)
+{
+	struct rte_service_spec service;
+	struct eth_vhost_async *async;
+	int ret;
+
+	if (lcore_id >= RTE_MAX_LCORE || lcore_id == rte_get_master_lcore() ||
+			(!rte_lcore_is_enabled(lcore_id) &&
+			!rte_lcore_has_role(lcore_id, ROLE_SERVICE)))
+		return NULL;
+
+	async = rte_zmalloc_socket(name, sizeof(*async) + nb_queues *
+			sizeof(struct eth_vhost_async_channel),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (async == NULL)
+		return NULL;
+	async->nb_channels = nb_queues;
+	async->lcore_id = lcore_id;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name), "%s_async", name);
+	service.callback = eth_vhost_async_run;
+	service.callback_userdata = async;
+	service.socket_id = socket_id;
+
+	if (rte_service_component_register(&service, &async->service_id))
+		goto free;
+
+	if (rte_service_component_runstate_set(async->service_id, 1) ||
+			rte_service_runstate_set(async->service_id, 1))
+		goto unregister;
+
+	/* the lcore becomes a service core if it is not already one */
+	if (!rte_lcore_has_role(lcore_id, ROLE_SERVICE)) {
+		ret = rte_service_lcore_add(lcore_id);
+		if (ret && ret != -EALREADY)
+			goto unregister;
+	}
+
+	if (rte_service_map_lcore_set(async->service_id, lcore_id, 1))
+		goto unregister;
+
+	ret = rte_service_lcore_start(lcore_id);
+	if (ret && ret != -EALREADY) {
+		rte_service_map_lcore_set(async->service_id, lcore_id, 0);
+		goto unregister;
+	}
+
+	return async;
+
+unregister:
+	rte_service_runstate_set(async->service_id, 0);
+	rte_service_component_runstate_set(async->service_id, 0);
+	rte_service_component_unregister(async->service_id);
+free:
+	rte_free(async);
+	return NULL;
+}
+
+void
+eth_vhost_async_free(struct eth_vhost_async *async)
+{
+	if (async == NULL)
+		return;
+
+	rte_service_map_lcore_set(async->service_id, async->lcore_id, 0);
+	rte_service_runstate_set(async->service_id, 0);
+	rte_service_component_runstate_set(async->service_id, 0);
+
+	/* wait for the last run of the engine */
+	while (rte_service_may_be_active(async->service_id) == 1 &&
+			rte_eal_get_lcore_state(async->lcore_id) == RUNNING)
+		rte_pause();
+
+	rte_service_component_unregister(async->service_id);
+	rte_free(async);
+}
+
+int
+eth_vhost_async_attach(struct eth_vhost_async *async, int vid)
+{
+	if (vid < 0 || vid >= ETH_VHOST_ASYNC_MAX_VID)
+		return -1;
+
+	async_devs[vid] = async;
+
+	return 0;
+}
+
+void
+eth_vhost_async_detach(int vid)
+{
+	if (vid < 0 || vid >= ETH_VHOST_ASYNC_MAX_VID)
+		return;
+
+	async_devs[vid] = NULL;
+}
@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_ETH_VHOST_ASYNC_H_
+#define _RTE_ETH_VHOST_ASYNC_H_
+
+#include <stdint.h>
+
+#include <rte_vhost_async.h>
+
+/*
+ * Software copy engine of the vhost PMD: the enqueue copies of the
+ * vhost queues of a port are done by an EAL service, run on another
+ * lcore than the one calling the Tx burst.
+ */
+
+struct eth_vhost_async;
+
+/* Copy engine operations registered on the vhost enqueue queues */
+extern struct rte_vhost_async_channel_ops eth_vhost_async_ops;
+
+/*
+ * Create the copy engine of a port, with a channel for each of its
+ * queues, and run it on the given lcore.
+ */
+struct eth_vhost_async *
+eth_vhost_async_create(const char *name, uint16_t nb_queues,
+		unsigned int lcore_id, int socket_id);
+
+void
+eth_vhost_async_free(struct eth_vhost_async *async);
+
+/*
+ * Bind the vhost device to the copy engine of its port, for the copy
+ * operations called with its identifier.
+ */
+int
+eth_vhost_async_attach(struct eth_vhost_async *async, int vid);
+
+void
+eth_vhost_async_detach(int vid);
+
+#endif /* _RTE_ETH_VHOST_ASYNC_H_ */
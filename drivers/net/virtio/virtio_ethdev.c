@@ -1497,7 +1497,16 @@ set_rxtx_funcs(struct rte_eth_dev *eth_dev)
 	struct virtio_hw *hw = eth_dev->data->dev_private;
 
 	eth_dev->tx_pkt_prepare = virtio_xmit_pkts_prepare;
-	if (vtpci_packed_queue(hw)) {
+	if (vtpci_packed_queue(hw) && hw->use_packed_vec_tx) {
+		PMD_INIT_LOG(INFO,
+			"virtio: using packed ring vectorized Tx path on port %u",
+			eth_dev->data->port_id);
+		eth_dev->tx_pkt_burst = virtio_xmit_pkts_packed_vec;
+#ifdef CC_AVX512_SUPPORT
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F))
+			eth_dev->tx_pkt_burst = virtio_xmit_pkts_packed_avx512;
+#endif
+	} else if (vtpci_packed_queue(hw)) {
 		PMD_INIT_LOG(INFO,
 			"virtio: using packed ring %s Tx path on port %u",
 			hw->use_inorder_tx ? "inorder" : "standard",
@@ -1516,7 +1525,17 @@ set_rxtx_funcs(struct rte_eth_dev *eth_dev)
 	}
 
 	if (vtpci_packed_queue(hw)) {
-		if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF)) {
+		if (hw->use_packed_vec_rx) {
+			PMD_INIT_LOG(INFO,
+				"virtio: using packed ring vectorized Rx path on port %u",
+				eth_dev->data->port_id);
+			eth_dev->rx_pkt_burst = virtio_recv_pkts_packed_vec;
+#ifdef CC_AVX512_SUPPORT
+			if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F))
+				eth_dev->rx_pkt_burst =
+					virtio_recv_pkts_packed_avx512;
+#endif
+		} else if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF)) {
 			PMD_INIT_LOG(INFO,
 				"virtio: using packed ring mergeable buffer Rx path on port %u",
 				eth_dev->data->port_id);
@@ -1835,6 +1854,46 @@ virtio_set_vtpci_ops(struct virtio_hw *hw)
 		VTPCI_OPS(hw) = &legacy_ops;
 }
 
+#define VIRTIO_ARG_VDPA       "vdpa"
+#define VIRTIO_ARG_VECTORIZED "vectorized"
+
+static int virtio_bool_devarg_handler(__rte_unused const char *key,
+		const char *value, __rte_unused void *opaque)
+{
+	if (strcmp(value, "1"))
+		return -1;
+
+	return 0;
+}
+
+static int
+virtio_bool_devarg(struct rte_devargs *devargs, const char *key)
+{
+	struct rte_kvargs *kvlist;
+	int ret = 0;
+
+	if (devargs == NULL)
+		return 0;
+
+	kvlist = rte_kvargs_parse(devargs->args, NULL);
+	if (kvlist == NULL)
+		return 0;
+
+	if (!rte_kvargs_count(kvlist, key))
+		goto exit;
+
+	/* the mode is selected when there's a key-value pair: key=1 */
+	if (rte_kvargs_process(kvlist, key,
+				virtio_bool_devarg_handler, NULL) < 0) {
+		goto exit;
+	}
+	ret = 1;
+
+exit:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
 /*
  * This function is based on probe() function in virtio_pci.c
  * It returns 0 on success.
@@ -1893,6 +1952,8 @@ eth_virtio_dev_init(struct rte_eth_dev *eth_dev)
 		ret = vtpci_init(RTE_ETH_DEV_TO_PCI(eth_dev), hw);
 		if (ret)
 			goto err_vtpci_init;
+		hw->vectorized = virtio_bool_devarg(eth_dev->device->devargs,
+				VIRTIO_ARG_VECTORIZED);
 	}
 
 	/* reset device and negotiate default features */
@@ -1936,44 +1997,6 @@ eth_virtio_dev_uninit(struct rte_eth_dev *eth_dev)
 	return 0;
 }
 
-static int vdpa_check_handler(__rte_unused const char *key,
-		const char *value, __rte_unused void *opaque)
-{
-	if (strcmp(value, "1"))
-		return -1;
-
-	return 0;
-}
-
-static int
-vdpa_mode_selected(struct rte_devargs *devargs)
-{
-	struct rte_kvargs *kvlist;
-	const char *key = "vdpa";
-	int ret = 0;
-
-	if (devargs == NULL)
-		return 0;
-
-	kvlist = rte_kvargs_parse(devargs->args, NULL);
-	if (kvlist == NULL)
-		return 0;
-
-	if (!rte_kvargs_count(kvlist, key))
-		goto exit;
-
-	/* vdpa mode selected when there's a key-value pair: vdpa=1 */
-	if (rte_kvargs_process(kvlist, key,
-				vdpa_check_handler, NULL) < 0) {
-		goto exit;
-	}
-	ret = 1;
-
-exit:
-	rte_kvargs_free(kvlist);
-	return ret;
-}
-
 static int eth_virtio_pci_probe(struct rte_pci_driver *pci_drv __rte_unused,
 	struct rte_pci_device *pci_dev)
 {
@@ -1983,7 +2006,7 @@ static int eth_virtio_pci_probe(struct rte_pci_driver *pci_drv __rte_unused,
 	}
 
 	/* virtio pmd skips probe if device needs to work in vdpa mode */
-	if (vdpa_mode_selected(pci_dev->device.devargs))
+	if (virtio_bool_devarg(pci_dev->device.devargs, VIRTIO_ARG_VDPA))
 		return 1;
 
 	return rte_eth_dev_pci_generic_probe(pci_dev, sizeof(struct virtio_hw),
@@ -2141,6 +2164,13 @@ virtio_dev_configure(struct rte_eth_dev *dev)
 	if (vtpci_packed_queue(hw)) {
 		hw->use_simple_rx = 0;
 		hw->use_inorder_rx = 0;
+		/* the vectorized paths rely on in-order completions */
+		hw->use_packed_vec_rx = hw->vectorized &&
+			vtpci_with_feature(hw, VIRTIO_F_IN_ORDER);
+		hw->use_packed_vec_tx = hw->vectorized && hw->use_inorder_tx;
+	} else {
+		hw->use_packed_vec_rx = 0;
+		hw->use_packed_vec_tx = 0;
 	}
 
 #if defined RTE_ARCH_ARM64 || defined RTE_ARCH_ARM
@@ -2150,6 +2180,7 @@ virtio_dev_configure(struct rte_eth_dev *dev)
 #endif
 	if (vtpci_with_feature(hw, VIRTIO_NET_F_MRG_RXBUF)) {
 		 hw->use_simple_rx = 0;
+		 hw->use_packed_vec_rx = 0;
 	}
 
 	if (rx_offloads & (DEV_RX_OFFLOAD_UDP_CKSUM |
@@ -2454,6 +2485,9 @@ __rte_unused uint8_t is_rx)
 RTE_PMD_EXPORT_NAME(net_virtio, __COUNTER__);
 RTE_PMD_REGISTER_PCI_TABLE(net_virtio, pci_id_virtio_map);
 RTE_PMD_REGISTER_KMOD_DEP(net_virtio, "* igb_uio | uio_pci_generic | vfio-pci");
+RTE_PMD_REGISTER_PARAM_STRING(net_virtio,
+	VIRTIO_ARG_VDPA "=<0|1> "
+	VIRTIO_ARG_VECTORIZED "=<0|1>");
 
 RTE_INIT(virtio_init_log)
 {
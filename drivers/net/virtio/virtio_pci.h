@@ -247,6 +247,9 @@ struct virtio_hw {
 	uint8_t     use_simple_rx;
 	uint8_t     use_inorder_rx;
 	uint8_t     use_inorder_tx;
+	uint8_t     use_packed_vec_rx;
+	uint8_t     use_packed_vec_tx;
+	uint8_t     vectorized;
 	uint8_t     weak_barriers;
 	bool        has_tx_offload;
 	bool        has_rx_offload;
@@ -60,4 +60,8 @@ struct virtnet_ctl {
 
 int virtio_rxq_vec_setup(struct virtnet_rx *rxvq);
 
+struct virtio_net_hdr;
+
+int virtio_rx_offload(struct rte_mbuf *m, struct virtio_net_hdr *hdr);
+
 #endif /* _VIRTIO_RXTX_H_ */
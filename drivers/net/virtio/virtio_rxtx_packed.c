@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+
+#include "virtio_rxtx_packed.h"
+
+uint16_t
+virtio_recv_pkts_packed_vec(void *rx_queue, struct rte_mbuf **rx_pkts,
+			    uint16_t nb_pkts)
+{
+	return virtio_recv_pkts_packed_batch(rx_queue, rx_pkts, nb_pkts);
+}
+
+uint16_t
+virtio_xmit_pkts_packed_vec(void *tx_queue, struct rte_mbuf **tx_pkts,
+			    uint16_t nb_pkts)
+{
+	return virtio_xmit_pkts_packed_batch(tx_queue, tx_pkts, nb_pkts);
+}
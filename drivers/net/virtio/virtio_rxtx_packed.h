@@ -0,0 +1,510 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _VIRTIO_RXTX_PACKED_H_
+#define _VIRTIO_RXTX_PACKED_H_
+
+#include <stdint.h>
+
+#include <rte_branch_prediction.h>
+#include <rte_ethdev_driver.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+
+#ifdef __AVX512F__
+#include <rte_vect.h>
+#endif
+
+#include "virtio_logs.h"
+#include "virtio_ethdev.h"
+#include "virtqueue.h"
+#include "virtio_rxtx.h"
+
+/*
+ * Packed ring Rx/Tx paths working on batches of descriptors.
+ *
+ * A batch is the set of descriptors sharing one cache line, 4 of them
+ * with 64 bytes cache lines. A batch is only processed at once when
+ * it is aligned on its cache line and does not wrap around the ring,
+ * so that its descriptors share the same wrap counter: the flags of
+ * all its descriptors are checked together, and its descriptors are
+ * made available with a single barrier. Otherwise, the descriptors
+ * are processed one by one.
+ *
+ * This file is built once for the default instruction set, and once
+ * with AVX512F on x86, which checks and writes the 4 descriptors of a
+ * batch with 512-bit loads and stores.
+ */
+
+#define PACKED_BATCH_SIZE \
+	((uint16_t)(RTE_CACHE_LINE_SIZE / sizeof(struct vring_packed_desc)))
+#define PACKED_BATCH_MASK (PACKED_BATCH_SIZE - 1)
+
+#ifdef __AVX512F__
+/* 64-bit lanes holding the len, id and flags fields of the descriptors */
+#define PACKED_LEN_ID_FLAGS_LANES 0xaa
+/* offset of the flags field in those lanes */
+#define PACKED_FLAGS_BITS_OFFSET 48
+/* 32-bit lanes holding the addr and len fields of the descriptors */
+#define PACKED_ADDR_LEN_WORDS 0x7777
+/* 32-bit lanes holding the id and flags fields of the descriptors */
+#define PACKED_ID_FLAGS_WORDS 0x8888
+#endif
+
+/* Can the batch starting at this ring index be processed at once? */
+static inline int
+virtqueue_batch_aligned_packed(struct virtqueue *vq, uint16_t idx)
+{
+	return (idx & PACKED_BATCH_MASK) == 0 &&
+		idx + PACKED_BATCH_SIZE <= vq->vq_nentries;
+}
+
+/* Check that all the descriptors of a batch have been used. */
+static inline int
+virtqueue_batch_used_packed(struct virtqueue *vq,
+			    struct vring_packed_desc *desc)
+{
+	uint16_t used = vq->vq_packed.used_wrap_counter ?
+		VRING_PACKED_DESC_F_AVAIL_USED : 0;
+#ifdef __AVX512F__
+	const __m512i flags_mask = _mm512_set1_epi64(
+		(uint64_t)VRING_PACKED_DESC_F_AVAIL_USED <<
+		PACKED_FLAGS_BITS_OFFSET);
+	__m512i v;
+
+	RTE_BUILD_BUG_ON(PACKED_BATCH_SIZE != 4);
+
+	v = _mm512_and_si512(_mm512_loadu_si512((void *)desc), flags_mask);
+	return _mm512_mask_cmpneq_epu64_mask(PACKED_LEN_ID_FLAGS_LANES, v,
+		_mm512_set1_epi64((uint64_t)used <<
+			PACKED_FLAGS_BITS_OFFSET)) == 0;
+#else
+	uint16_t diff = 0;
+	unsigned int i;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		diff |= (desc[i].flags & VRING_PACKED_DESC_F_AVAIL_USED) ^ used;
+
+	return diff == 0;
+#endif
+}
+
+/*
+ * Fill the descriptors of a batch, with consecutive ids starting at id,
+ * and make them available to the device once they are all written.
+ */
+static inline void
+virtqueue_batch_write_packed(struct virtqueue *vq,
+			     struct vring_packed_desc *desc,
+			     const uint64_t *addr, const uint32_t *len,
+			     uint16_t id, uint16_t flags)
+{
+#ifdef __AVX512F__
+	uint64_t id_flags[PACKED_BATCH_SIZE];
+	unsigned int i;
+	__m512i v;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		id_flags[i] = (uint64_t)(id + i) << 32 |
+			(uint64_t)flags << PACKED_FLAGS_BITS_OFFSET | len[i];
+
+	v = _mm512_set_epi64(id_flags[3], addr[3], id_flags[2], addr[2],
+		id_flags[1], addr[1], id_flags[0], addr[0]);
+
+	/* the id and flags fields share the same 32-bit word */
+	_mm512_mask_storeu_epi32(desc, PACKED_ADDR_LEN_WORDS, v);
+	virtio_wmb(vq->hw->weak_barriers);
+	_mm512_mask_storeu_epi32(desc, PACKED_ID_FLAGS_WORDS, v);
+#else
+	unsigned int i;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		desc[i].addr = addr[i];
+		desc[i].len = len[i];
+		desc[i].id = id + i;
+	}
+
+	virtio_wmb(vq->hw->weak_barriers);
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		desc[i].flags = flags;
+#endif
+}
+
+static inline void
+virtqueue_avail_advance_packed(struct virtqueue *vq, uint16_t num)
+{
+	vq->vq_avail_idx += num;
+	if (vq->vq_avail_idx >= vq->vq_nentries) {
+		vq->vq_avail_idx -= vq->vq_nentries;
+		vq->vq_packed.cached_flags ^= VRING_PACKED_DESC_F_AVAIL_USED;
+	}
+	vq->vq_free_cnt -= num;
+}
+
+static inline void
+virtqueue_used_advance_packed(struct virtqueue *vq, uint16_t num)
+{
+	vq->vq_used_cons_idx += num;
+	if (vq->vq_used_cons_idx >= vq->vq_nentries) {
+		vq->vq_used_cons_idx -= vq->vq_nentries;
+		vq->vq_packed.used_wrap_counter ^= 1;
+	}
+	vq->vq_free_cnt += num;
+}
+
+static inline int
+virtqueue_dequeue_batch_packed_vec(struct virtqueue *vq,
+				   struct rte_mbuf **rx_pkts, uint32_t *len)
+{
+	uint16_t used_idx = vq->vq_used_cons_idx;
+	struct vring_packed_desc *desc = &vq->vq_packed.ring.desc[used_idx];
+	struct rte_mbuf *cookie;
+	unsigned int i;
+
+	if (!virtqueue_batch_aligned_packed(vq, used_idx) ||
+	    !virtqueue_batch_used_packed(vq, desc))
+		return -1;
+
+	virtio_rmb(vq->hw->weak_barriers);
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		cookie = vq->vq_descx[desc[i].id].cookie;
+		if (unlikely(cookie == NULL))
+			return -1;
+		len[i] = desc[i].len;
+		rx_pkts[i] = cookie;
+	}
+
+	/* The mbufs now belong to the caller */
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		vq->vq_descx[desc[i].id].cookie = NULL;
+		rte_prefetch0(rx_pkts[i]);
+		rte_packet_prefetch(rte_pktmbuf_mtod(rx_pkts[i], void *));
+	}
+
+	virtqueue_used_advance_packed(vq, PACKED_BATCH_SIZE);
+	return 0;
+}
+
+static inline int
+virtqueue_dequeue_single_packed_vec(struct virtqueue *vq,
+				    struct rte_mbuf **rx_pkts, uint32_t *len)
+{
+	uint16_t used_idx = vq->vq_used_cons_idx;
+	struct vring_packed_desc *desc = &vq->vq_packed.ring.desc[used_idx];
+	struct rte_mbuf *cookie;
+
+	if (!desc_is_used(desc, vq))
+		return -1;
+
+	virtio_rmb(vq->hw->weak_barriers);
+
+	cookie = vq->vq_descx[desc->id].cookie;
+	if (unlikely(cookie == NULL)) {
+		PMD_DRV_LOG(ERR, "vring descriptor with no mbuf cookie at %u",
+			used_idx);
+		return -1;
+	}
+	vq->vq_descx[desc->id].cookie = NULL;
+	*len = desc->len;
+	rte_prefetch0(cookie);
+	rte_packet_prefetch(rte_pktmbuf_mtod(cookie, void *));
+	*rx_pkts = cookie;
+
+	virtqueue_used_advance_packed(vq, 1);
+	return 0;
+}
+
+/* Refill all the free descriptors of the Rx ring with new mbufs. */
+static inline uint16_t
+virtqueue_refill_packed_vec(struct virtnet_rx *rxvq)
+{
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	uint16_t free_cnt = vq->vq_free_cnt;
+	struct rte_mbuf *new_pkts[free_cnt];
+	uint64_t addr[PACKED_BATCH_SIZE];
+	uint32_t len[PACKED_BATCH_SIZE];
+	struct vring_packed_desc *desc;
+	struct rte_mbuf *m;
+	uint16_t idx, i, j, n;
+
+	if (free_cnt == 0)
+		return 0;
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(rxvq->mpool, new_pkts,
+					    free_cnt) != 0)) {
+		rte_eth_devices[rxvq->port_id].data->rx_mbuf_alloc_failed +=
+			free_cnt;
+		return 0;
+	}
+
+	for (i = 0; i < free_cnt; i += n) {
+		idx = vq->vq_avail_idx;
+		desc = &vq->vq_packed.ring.desc[idx];
+
+		if (free_cnt - i >= PACKED_BATCH_SIZE &&
+		    virtqueue_batch_aligned_packed(vq, idx)) {
+			for (j = 0; j < PACKED_BATCH_SIZE; j++) {
+				m = new_pkts[i + j];
+				vq->vq_descx[idx + j].cookie = m;
+				vq->vq_descx[idx + j].ndescs = 1;
+				addr[j] = VIRTIO_MBUF_ADDR(m, vq) +
+					RTE_PKTMBUF_HEADROOM -
+					hw->vtnet_hdr_size;
+				len[j] = m->buf_len - RTE_PKTMBUF_HEADROOM +
+					hw->vtnet_hdr_size;
+			}
+			virtqueue_batch_write_packed(vq, desc, addr, len, idx,
+				vq->vq_packed.cached_flags);
+			n = PACKED_BATCH_SIZE;
+		} else {
+			vq->vq_descx[idx].cookie = new_pkts[i];
+			vq->vq_descx[idx].ndescs = 1;
+			desc->addr = VIRTIO_MBUF_ADDR(new_pkts[i], vq) +
+				RTE_PKTMBUF_HEADROOM - hw->vtnet_hdr_size;
+			desc->len = new_pkts[i]->buf_len -
+				RTE_PKTMBUF_HEADROOM + hw->vtnet_hdr_size;
+			desc->id = idx;
+			virtio_wmb(hw->weak_barriers);
+			desc->flags = vq->vq_packed.cached_flags;
+			n = 1;
+		}
+		virtqueue_avail_advance_packed(vq, n);
+	}
+
+	return free_cnt;
+}
+
+static inline uint16_t
+virtio_recv_pkts_packed_batch(struct virtnet_rx *rxvq,
+			      struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
+{
+	struct virtqueue *vq = rxvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	uint32_t len[RTE_PMD_VIRTIO_RX_MAX_BURST];
+	struct rte_mbuf *rcv_pkts[RTE_PMD_VIRTIO_RX_MAX_BURST];
+	uint32_t hdr_size = hw->vtnet_hdr_size;
+	struct virtio_net_hdr *hdr;
+	struct rte_mbuf *rxm;
+	uint16_t num, nb_dq = 0, nb_rx = 0, i;
+
+	if (unlikely(hw->started == 0))
+		return 0;
+
+	num = RTE_MIN(RTE_PMD_VIRTIO_RX_MAX_BURST, nb_pkts);
+	while (nb_dq < num) {
+		if (num - nb_dq >= PACKED_BATCH_SIZE &&
+		    virtqueue_dequeue_batch_packed_vec(vq, &rcv_pkts[nb_dq],
+						       &len[nb_dq]) == 0) {
+			nb_dq += PACKED_BATCH_SIZE;
+			continue;
+		}
+		if (virtqueue_dequeue_single_packed_vec(vq, &rcv_pkts[nb_dq],
+							&len[nb_dq]) != 0)
+			break;
+		nb_dq++;
+	}
+	PMD_RX_LOG(DEBUG, "dequeue:%d", nb_dq);
+
+	for (i = 0; i < nb_dq; i++) {
+		rxm = rcv_pkts[i];
+
+		if (unlikely(len[i] < hdr_size + RTE_ETHER_HDR_LEN)) {
+			PMD_RX_LOG(ERR, "Packet drop");
+			rte_pktmbuf_free(rxm);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		rxm->port = rxvq->port_id;
+		rxm->data_off = RTE_PKTMBUF_HEADROOM;
+		rxm->ol_flags = 0;
+		rxm->vlan_tci = 0;
+
+		rxm->pkt_len = (uint32_t)(len[i] - hdr_size);
+		rxm->data_len = (uint16_t)(len[i] - hdr_size);
+
+		if (hw->vlan_strip)
+			rte_vlan_strip(rxm);
+
+		hdr = (struct virtio_net_hdr *)((char *)rxm->buf_addr +
+			RTE_PKTMBUF_HEADROOM - hdr_size);
+		if (hw->has_rx_offload && virtio_rx_offload(rxm, hdr) < 0) {
+			rte_pktmbuf_free(rxm);
+			rxvq->stats.errors++;
+			continue;
+		}
+
+		virtio_update_packet_stats(&rxvq->stats, rxm);
+		rx_pkts[nb_rx++] = rxm;
+	}
+
+	rxvq->stats.packets += nb_rx;
+
+	if (likely(virtqueue_refill_packed_vec(rxvq) != 0)) {
+		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
+			virtqueue_notify(vq);
+			PMD_RX_LOG(DEBUG, "Notified");
+		}
+	}
+
+	return nb_rx;
+}
+
+/* Can the virtio-net header be pushed in the headroom of the mbuf? */
+static inline int
+virtio_tx_can_push_packed_vec(struct virtio_hw *hw, struct rte_mbuf *m)
+{
+	return rte_mbuf_refcnt_read(m) == 1 &&
+		RTE_MBUF_DIRECT(m) &&
+		m->nb_segs == 1 &&
+		rte_pktmbuf_headroom(m) >= hw->vtnet_hdr_size &&
+		rte_is_aligned(rte_pktmbuf_mtod(m, char *),
+			__alignof__(struct virtio_net_hdr_mrg_rxbuf));
+}
+
+static inline void
+virtio_tx_push_hdr_packed_vec(struct virtnet_tx *txvq, struct rte_mbuf *m)
+{
+	struct virtio_hw *hw = txvq->vq->hw;
+	struct virtio_net_hdr *hdr;
+
+	virtio_update_packet_stats(&txvq->stats, m);
+
+	/* prepend cannot fail, checked by caller */
+	hdr = (struct virtio_net_hdr *)
+		rte_pktmbuf_prepend(m, hw->vtnet_hdr_size);
+	m->pkt_len -= hw->vtnet_hdr_size;
+
+	/* if offload disabled, hdr is not zeroed yet, do it now */
+	if (!hw->has_tx_offload)
+		virtqueue_clear_net_hdr(hdr);
+	else
+		virtqueue_xmit_offload(hdr, m, true);
+}
+
+/*
+ * Enqueue a batch of packets, the ids of the descriptors are their ring
+ * indexes as the in-order feature is negotiated.
+ */
+static inline int
+virtqueue_enqueue_batch_packed_vec(struct virtnet_tx *txvq,
+				   struct rte_mbuf **tx_pkts)
+{
+	struct virtqueue *vq = txvq->vq;
+	uint16_t idx = vq->vq_avail_idx;
+	uint64_t addr[PACKED_BATCH_SIZE];
+	uint32_t len[PACKED_BATCH_SIZE];
+	unsigned int i;
+
+	if (vq->vq_free_cnt < PACKED_BATCH_SIZE ||
+	    !virtqueue_batch_aligned_packed(vq, idx))
+		return -1;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		if (!virtio_tx_can_push_packed_vec(vq->hw, tx_pkts[i]))
+			return -1;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		virtio_tx_push_hdr_packed_vec(txvq, tx_pkts[i]);
+		vq->vq_descx[idx + i].cookie = tx_pkts[i];
+		vq->vq_descx[idx + i].ndescs = 1;
+		addr[i] = VIRTIO_MBUF_DATA_DMA_ADDR(tx_pkts[i], vq);
+		len[i] = tx_pkts[i]->data_len;
+	}
+
+	virtqueue_batch_write_packed(vq, &vq->vq_packed.ring.desc[idx],
+		addr, len, idx, vq->vq_packed.cached_flags);
+	virtqueue_avail_advance_packed(vq, PACKED_BATCH_SIZE);
+	return 0;
+}
+
+static inline void
+virtqueue_enqueue_single_packed_vec(struct virtnet_tx *txvq,
+				    struct rte_mbuf *m)
+{
+	struct virtqueue *vq = txvq->vq;
+	uint16_t idx = vq->vq_avail_idx;
+	struct vring_packed_desc *desc = &vq->vq_packed.ring.desc[idx];
+
+	virtio_tx_push_hdr_packed_vec(txvq, m);
+	vq->vq_descx[idx].cookie = m;
+	vq->vq_descx[idx].ndescs = 1;
+
+	desc->addr = VIRTIO_MBUF_DATA_DMA_ADDR(m, vq);
+	desc->len = m->data_len;
+	desc->id = idx;
+	virtio_wmb(vq->hw->weak_barriers);
+	desc->flags = vq->vq_packed.cached_flags;
+
+	virtqueue_avail_advance_packed(vq, 1);
+}
+
+static inline uint16_t
+virtio_xmit_pkts_packed_batch(struct virtnet_tx *txvq,
+			      struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	struct virtqueue *vq = txvq->vq;
+	struct virtio_hw *hw = vq->hw;
+	uint16_t nb_tx = 0;
+	int fallback = 0;
+
+	if (unlikely(hw->started == 0 && tx_pkts != hw->inject_pkts))
+		return nb_tx;
+
+	if (unlikely(nb_pkts < 1))
+		return nb_pkts;
+
+	PMD_TX_LOG(DEBUG, "%d packets to xmit", nb_pkts);
+
+	if (nb_pkts > vq->vq_free_cnt)
+		virtio_xmit_cleanup_inorder_packed(vq,
+			nb_pkts - vq->vq_free_cnt);
+
+	while (nb_tx < nb_pkts) {
+		if (nb_pkts - nb_tx >= PACKED_BATCH_SIZE &&
+		    virtqueue_enqueue_batch_packed_vec(txvq,
+						       &tx_pkts[nb_tx]) == 0) {
+			nb_tx += PACKED_BATCH_SIZE;
+			continue;
+		}
+
+		if (!virtio_tx_can_push_packed_vec(hw, tx_pkts[nb_tx])) {
+			fallback = 1;
+			break;
+		}
+
+		if (unlikely(vq->vq_free_cnt == 0)) {
+			virtio_xmit_cleanup_inorder_packed(vq, 1);
+			if (unlikely(vq->vq_free_cnt == 0)) {
+				PMD_TX_LOG(ERR,
+					"No free tx descriptors to transmit");
+				break;
+			}
+		}
+
+		virtqueue_enqueue_single_packed_vec(txvq, tx_pkts[nb_tx]);
+		nb_tx++;
+	}
+
+	txvq->stats.packets += nb_tx;
+
+	if (likely(nb_tx)) {
+		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
+			virtqueue_notify(vq);
+			PMD_TX_LOG(DEBUG, "Notified backend after xmit");
+		}
+	}
+
+	/* chained or shared mbufs go through the standard path */
+	if (unlikely(fallback))
+		nb_tx += virtio_xmit_pkts_packed(txvq, &tx_pkts[nb_tx],
+						 nb_pkts - nb_tx);
+
+	return nb_tx;
+}
+
+#endif /* _VIRTIO_RXTX_PACKED_H_ */
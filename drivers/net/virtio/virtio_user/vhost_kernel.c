@@ -318,6 +318,24 @@ vhost_kernel_set_backend(int vhostfd, int tapfd)
 	return 0;
 }
 
+/* The queue may already be in the requested state, EINVAL is then ignored */
+static int
+vhost_kernel_tap_queue(int tapfd, uint16_t pair_idx, bool attach)
+{
+	if (vhost_kernel_tap_set_queue(tapfd, attach) < 0 && errno != EINVAL) {
+		PMD_DRV_LOG(ERR, "fail to %s tap queue %u: %s",
+			    attach ? "attach" : "detach", pair_idx,
+			    strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/* The tap queues are only closed with the device, so that the kernel
+ * interface and its configuration persist when the queue pairs are
+ * disabled, on a memory hotplug or a new feature negotiation.
+ */
 static int
 vhost_kernel_enable_queue_pair(struct virtio_user_dev *dev,
 			       uint16_t pair_idx,
@@ -329,14 +347,13 @@ vhost_kernel_enable_queue_pair(struct virtio_user_dev *dev,
 	int req_mq = (dev->max_queue_pairs > 1);
 
 	vhostfd = dev->vhostfds[pair_idx];
+	tapfd = dev->tapfds[pair_idx];
 
 	if (!enable) {
-		if (dev->tapfds[pair_idx] >= 0) {
-			close(dev->tapfds[pair_idx]);
-			dev->tapfds[pair_idx] = -1;
-		}
-		return vhost_kernel_set_backend(vhostfd, -1);
-	} else if (dev->tapfds[pair_idx] >= 0) {
+		if (vhost_kernel_set_backend(vhostfd, -1) < 0)
+			return -1;
+		if (tapfd >= 0 && req_mq)
+			return vhost_kernel_tap_queue(tapfd, pair_idx, false);
 		return 0;
 	}
 
@@ -346,8 +363,27 @@ vhost_kernel_enable_queue_pair(struct virtio_user_dev *dev,
 	else
 		hdr_size = sizeof(struct virtio_net_hdr);
 
+	if (tapfd >= 0) {
+		/* the features may have been negotiated again */
+		if (ioctl(tapfd, TUNSETVNETHDRSZ, &hdr_size) < 0) {
+			PMD_DRV_LOG(ERR, "TUNSETVNETHDRSZ failed: %s",
+				    strerror(errno));
+			return -1;
+		}
+		vhost_kernel_tap_set_offload(tapfd, dev->features);
+
+		if (req_mq && vhost_kernel_tap_queue(tapfd, pair_idx, true) < 0)
+			return -1;
+
+		if (vhost_kernel_set_backend(vhostfd, tapfd) < 0) {
+			PMD_DRV_LOG(ERR, "fail to set backend for vhost kernel");
+			return -1;
+		}
+		return 0;
+	}
+
 	tapfd = vhost_kernel_open_tap(&dev->ifname, hdr_size, req_mq,
-			 (char *)dev->mac_addr, dev->features);
+			 (char *)dev->mac_addr, dev->features, dev->napi);
 	if (tapfd < 0) {
 		PMD_DRV_LOG(ERR, "fail to open tap for vhost kernel");
 		return -1;
@@ -18,7 +18,7 @@
 #include "../virtio_logs.h"
 #include "../virtio_pci.h"
 
-static int
+int
 vhost_kernel_tap_set_offload(int fd, uint64_t features)
 {
 	unsigned int offload = 0;
@@ -52,20 +52,34 @@ vhost_kernel_tap_set_offload(int fd, uint64_t features)
 				return -1;
 			}
 		}
+	} else {
+		/* clear the offloads of a tap queue reused with new features */
+		ioctl(fd, TUNSETOFFLOAD, 0);
 	}
 
 	return 0;
 }
 
+int
+vhost_kernel_tap_set_queue(int fd, bool attach)
+{
+	struct ifreq ifr = {
+		.ifr_flags = attach ? IFF_ATTACH_QUEUE : IFF_DETACH_QUEUE,
+	};
+
+	return ioctl(fd, TUNSETQUEUE, &ifr);
+}
+
 int
 vhost_kernel_open_tap(char **p_ifname, int hdr_size, int req_mq,
-			 const char *mac, uint64_t features)
+			 const char *mac, uint64_t features, bool napi)
 {
 	unsigned int tap_features;
 	char *tap_name = NULL;
 	int sndbuf = INT_MAX;
 	struct ifreq ifr;
 	int tapfd;
+	int ret;
 
 	/* TODO:
 	 * 1. verify we can get/set vnet_hdr_len, tap_probe_vnet_hdr_len
@@ -104,11 +118,28 @@ vhost_kernel_open_tap(char **p_ifname, int hdr_size, int req_mq,
 	if (req_mq)
 		ifr.ifr_flags |= IFF_MULTI_QUEUE;
 
+	/* On request, let the kernel receive the packets written to the tap
+	 * in NAPI context.
+	 */
+	if (napi) {
+		if (tap_features & IFF_NAPI)
+			ifr.ifr_flags |= IFF_NAPI;
+		else
+			PMD_DRV_LOG(WARNING, "TAP does not support IFF_NAPI");
+	}
+
 	if (*p_ifname)
 		strncpy(ifr.ifr_name, *p_ifname, IFNAMSIZ - 1);
 	else
 		strncpy(ifr.ifr_name, "tap%d", IFNAMSIZ - 1);
-	if (ioctl(tapfd, TUNSETIFF, (void *)&ifr) == -1) {
+	ret = ioctl(tapfd, TUNSETIFF, (void *)&ifr);
+	if (ret == -1 && (ifr.ifr_flags & IFF_NAPI)) {
+		PMD_DRV_LOG(WARNING, "TUNSETIFF with IFF_NAPI failed: %s",
+			    strerror(errno));
+		ifr.ifr_flags &= ~IFF_NAPI;
+		ret = ioctl(tapfd, TUNSETIFF, (void *)&ifr);
+	}
+	if (ret == -1) {
 		PMD_DRV_LOG(ERR, "TUNSETIFF failed: %s", strerror(errno));
 		goto error;
 	}
@@ -24,6 +24,7 @@ struct virtio_user_dev {
 
 	/* for vhost_kernel backend */
 	char		*ifname;
+	bool		napi;	    /* tap interface in NAPI mode */
 	int		*vhostfds;
 	int		*tapfds;
 
@@ -61,7 +62,7 @@ int virtio_user_stop_device(struct virtio_user_dev *dev);
 int virtio_user_dev_init(struct virtio_user_dev *dev, char *path, int queues,
 			 int cq, int queue_size, const char *mac, char **ifname,
 			 int server, int mrg_rxbuf, int in_order,
-			 int packed_vq);
+			 int packed_vq, int napi);
 void virtio_user_dev_uninit(struct virtio_user_dev *dev);
 void virtio_user_handle_cq(struct virtio_user_dev *dev, uint16_t queue_idx);
 void virtio_user_handle_cq_packed(struct virtio_user_dev *dev,
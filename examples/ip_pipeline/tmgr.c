@@ -80,6 +80,7 @@ tmgr_pipe_profile_add(struct rte_sched_pipe_params *p)
 struct tmgr_port *
 tmgr_port_create(const char *name, struct tmgr_port_params *params)
 {
+	struct rte_sched_subport_params subport_params;
 	struct rte_sched_port_params p;
 	struct tmgr_port *tmgr_port;
 	struct rte_sched_port *s;
@@ -105,23 +106,29 @@ tmgr_port_create(const char *name, struct tmgr_port_params *params)
 	p.n_subports_per_port = params->n_subports_per_port;
 	p.n_pipes_per_subport = params->n_pipes_per_subport;
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
-		p.qsize[i] = params->qsize[i];
-
-	p.pipe_profiles = pipe_profile;
-	p.n_pipe_profiles = n_pipe_profiles;
-
 	s = rte_sched_port_config(&p);
 	if (s == NULL)
 		return NULL;
 
+	/* All the subports share the queue sizes and the pipe profiles */
+	memcpy(&subport_params, &subport_profile[0], sizeof(subport_params));
+	subport_params.n_pipes_per_subport_enabled =
+		params->n_pipes_per_subport;
+
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
+		subport_params.qsize[i] = params->qsize[i];
+
+	subport_params.pipe_profiles = pipe_profile;
+	subport_params.n_pipe_profiles = n_pipe_profiles;
+	subport_params.n_max_pipe_profiles = n_pipe_profiles;
+
 	for (i = 0; i < params->n_subports_per_port; i++) {
 		int status;
 
 		status = rte_sched_subport_config(
 			s,
 			i,
-			&subport_profile[0]);
+			&subport_params);
 
 		if (status) {
 			rte_sched_port_free(s);
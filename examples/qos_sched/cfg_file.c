@@ -20,6 +20,20 @@
  * for new entries do we add in */
 #define CFG_ALLOC_ENTRY_BATCH 16
 
+static void
+cfg_parse_qsize(const char *entry, uint16_t *qsize)
+{
+	char *next;
+	int j;
+
+	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
+		qsize[j] = (uint16_t)strtol(entry, &next, 10);
+		if (next == NULL)
+			break;
+		entry = next;
+	}
+}
+
 int
 cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params)
 {
@@ -29,9 +43,6 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 	if (!cfg || !port_params)
 		return -1;
 
-	memset(active_queues, 0, sizeof(active_queues));
-	n_active_queues = 0;
-
 	entry = rte_cfgfile_get_entry(cfg, "port", "frame overhead");
 	if (entry)
 		port_params->frame_overhead = (uint32_t)atoi(entry);
@@ -41,33 +52,15 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 		port_params->n_subports_per_port = (uint32_t)atoi(entry);
 
 	entry = rte_cfgfile_get_entry(cfg, "port", "number of pipes per subport");
-	if (entry)
+	if (entry) {
 		port_params->n_pipes_per_subport = (uint32_t)atoi(entry);
+		subport_params[0].n_pipes_per_subport_enabled =
+			port_params->n_pipes_per_subport;
+	}
 
 	entry = rte_cfgfile_get_entry(cfg, "port", "queue sizes");
-	if (entry) {
-		char *next;
-
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
-			port_params->qsize[j] = (uint16_t)strtol(entry, &next, 10);
-			if (next == NULL)
-				break;
-			entry = next;
-		}
-
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASS_BE; j++)
-			if (port_params->qsize[j]) {
-				active_queues[n_active_queues] = j;
-				n_active_queues++;
-			}
-
-		if (port_params->qsize[RTE_SCHED_TRAFFIC_CLASS_BE])
-			for (j = 0; j < RTE_SCHED_BE_QUEUES_PER_PIPE; j++) {
-				active_queues[n_active_queues] =
-					RTE_SCHED_TRAFFIC_CLASS_BE + j;
-				n_active_queues++;
-			}
-	}
+	if (entry)
+		cfg_parse_qsize(entry, subport_params[0].qsize);
 
 #ifdef RTE_SCHED_RED
 	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
@@ -81,7 +74,7 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 			int k;
 			/* for each packet colour (green, yellow, red) */
 			for (k = 0; k < RTE_COLORS; k++) {
-				port_params->red_params[j][k].min_th
+				subport_params[0].red_params[j][k].min_th
 					= (uint16_t)strtol(entry, &next, 10);
 				if (next == NULL)
 					break;
@@ -97,7 +90,7 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 			int k;
 			/* for each packet colour (green, yellow, red) */
 			for (k = 0; k < RTE_COLORS; k++) {
-				port_params->red_params[j][k].max_th
+				subport_params[0].red_params[j][k].max_th
 					= (uint16_t)strtol(entry, &next, 10);
 				if (next == NULL)
 					break;
@@ -113,7 +106,7 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 			int k;
 			/* for each packet colour (green, yellow, red) */
 			for (k = 0; k < RTE_COLORS; k++) {
-				port_params->red_params[j][k].maxp_inv
+				subport_params[0].red_params[j][k].maxp_inv
 					= (uint8_t)strtol(entry, &next, 10);
 
 				if (next == NULL)
@@ -130,7 +123,7 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 			int k;
 			/* for each packet colour (green, yellow, red) */
 			for (k = 0; k < RTE_COLORS; k++) {
-				port_params->red_params[j][k].wq_log2
+				subport_params[0].red_params[j][k].wq_log2
 					= (uint8_t)strtol(entry, &next, 10);
 				if (next == NULL)
 					break;
@@ -140,6 +133,18 @@ cfg_load_port(struct rte_cfgfile *cfg, struct rte_sched_port_params *port_params
 	}
 #endif /* RTE_SCHED_RED */
 
+	/* The port level settings are the defaults of all the subports */
+	for (j = 1; j < MAX_SCHED_SUBPORTS; j++) {
+		subport_params[j].n_pipes_per_subport_enabled =
+			subport_params[0].n_pipes_per_subport_enabled;
+		memcpy(subport_params[j].qsize, subport_params[0].qsize,
+			sizeof(subport_params[j].qsize));
+#ifdef RTE_SCHED_RED
+		memcpy(subport_params[j].red_params, subport_params[0].red_params,
+			sizeof(subport_params[j].red_params));
+#endif
+	}
+
 	return 0;
 }
 
@@ -155,7 +160,11 @@ cfg_load_pipe(struct rte_cfgfile *cfg, struct rte_sched_pipe_params *pipe_params
 		return -1;
 
 	profiles = rte_cfgfile_num_sections(cfg, "pipe profile", sizeof("pipe profile") - 1);
-	port_params.n_pipe_profiles = profiles;
+	for (i = 0; i < MAX_SCHED_SUBPORTS; i++) {
+		subport_params[i].pipe_profiles = pipe_params;
+		subport_params[i].n_pipe_profiles = profiles;
+		subport_params[i].n_max_pipe_profiles = MAX_SCHED_PIPE_PROFILES;
+	}
 
 	for (j = 0; j < profiles; j++) {
 		char pipe_name[32];
@@ -323,6 +332,16 @@ cfg_load_subport(struct rte_cfgfile *cfg, struct rte_sched_subport_params *subpo
 			if (entry)
 				subport_params[i].tc_rate[12] = (uint32_t)atoi(entry);
 
+			entry = rte_cfgfile_get_entry(cfg, sec_name,
+					"number of pipes per subport");
+			if (entry)
+				subport_params[i].n_pipes_per_subport_enabled =
+					(uint32_t)atoi(entry);
+
+			entry = rte_cfgfile_get_entry(cfg, sec_name, "queue sizes");
+			if (entry)
+				cfg_parse_qsize(entry, subport_params[i].qsize);
+
 			int n_entries = rte_cfgfile_section_num_entries(cfg, sec_name);
 			struct rte_cfgfile_entry entries[n_entries];
 
@@ -365,5 +384,22 @@ cfg_load_subport(struct rte_cfgfile *cfg, struct rte_sched_subport_params *subpo
 		}
 	}
 
+	/* The traffic generator uses the queues enabled in subport 0 */
+	memset(active_queues, 0, sizeof(active_queues));
+	n_active_queues = 0;
+
+	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASS_BE; j++)
+		if (subport_params[0].qsize[j]) {
+			active_queues[n_active_queues] = j;
+			n_active_queues++;
+		}
+
+	if (subport_params[0].qsize[RTE_SCHED_TRAFFIC_CLASS_BE])
+		for (j = 0; j < RTE_SCHED_BE_QUEUES_PER_PIPE; j++) {
+			active_queues[n_active_queues] =
+				RTE_SCHED_TRAFFIC_CLASS_BE + j;
+			n_active_queues++;
+		}
+
 	return 0;
 }
@@ -180,13 +180,15 @@ kni_dev_remove(struct kni_dev *dev)
 	if (!dev)
 		return -ENODEV;
 
-	if (dev->net_dev) {
+	if (dev->net_dev)
 		unregister_netdev(dev->net_dev);
-		free_netdev(dev->net_dev);
-	}
 
+	/* dev is freed with its network device */
 	kni_net_release_fifo_phy(dev);
 
+	if (dev->net_dev)
+		free_netdev(dev->net_dev);
+
 	return 0;
 }
 
@@ -9,6 +9,7 @@
 #include <rte_memory.h>
 #include <rte_cycles.h>
 #include <rte_compat.h>
+#include <rte_cpuflags.h>
 #include <rte_memzone.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
@@ -219,35 +220,26 @@ find_match_scalar(struct rte_distributor *d,
 			uint16_t *data_ptr,
 			uint16_t *output_ptr)
 {
-	struct rte_distributor_backlog *bl;
+	unsigned int nb_tags;
 	uint16_t i, j, w;
 
 	/*
 	 * Function overview:
 	 * 1. Loop through all worker ID's
-	 * 2. Compare the current inflights to the incoming tags
-	 * 3. Compare the current backlog to the incoming tags
-	 * 4. Add any matches to the output
+	 * 2. Compare the current inflights and backlog to the incoming tags
+	 * 3. Add any matches to the output
 	 */
 
 	for (j = 0 ; j < RTE_DIST_BURST_SIZE; j++)
 		output_ptr[j] = 0;
 
 	for (i = 0; i < d->num_workers; i++) {
-		bl = &d->backlog[i];
+		nb_tags = RTE_DIST_BURST_SIZE + d->backlog[i].count;
 
-		for (j = 0; j < RTE_DIST_BURST_SIZE ; j++)
+		for (j = 0; j < nb_tags; j++)
 			for (w = 0; w < RTE_DIST_BURST_SIZE; w++)
-				if (d->in_flight_tags[i][j] == data_ptr[w]) {
-					output_ptr[j] = i+1;
-					break;
-				}
-		for (j = 0; j < RTE_DIST_BURST_SIZE; j++)
-			for (w = 0; w < RTE_DIST_BURST_SIZE; w++)
-				if (bl->tags[j] == data_ptr[w]) {
-					output_ptr[j] = i+1;
-					break;
-				}
+				if (d->in_flight_tags[i][j] == data_ptr[w])
+					output_ptr[w] = i+1;
 	}
 
 	/*
@@ -305,7 +297,8 @@ static unsigned int
 release(struct rte_distributor *d, unsigned int wkr)
 {
 	struct rte_distributor_buffer *buf = &(d->bufs[wkr]);
-	unsigned int i;
+	struct rte_distributor_backlog *bl = &d->backlog[wkr];
+	unsigned int i, n;
 
 	while (!(d->bufs[wkr].bufptr64[0] & RTE_DISTRIB_GET_BUF))
 		rte_pause();
@@ -314,10 +307,11 @@ release(struct rte_distributor *d, unsigned int wkr)
 
 	buf->count = 0;
 
-	for (i = 0; i < d->backlog[wkr].count; i++) {
-		d->bufs[wkr].bufptr64[i] = d->backlog[wkr].pkts[i] |
+	n = RTE_MIN(bl->count, (unsigned int)RTE_DIST_BURST_SIZE);
+	for (i = 0; i < n; i++) {
+		d->bufs[wkr].bufptr64[i] = bl->pkts[i] |
 				RTE_DISTRIB_GET_BUF | RTE_DISTRIB_VALID_BUF;
-		d->in_flight_tags[wkr][i] = d->backlog[wkr].tags[i];
+		d->in_flight_tags[wkr][i] = bl->tags[i];
 	}
 	buf->count = i;
 	for ( ; i < RTE_DIST_BURST_SIZE ; i++) {
@@ -325,7 +319,11 @@ release(struct rte_distributor *d, unsigned int wkr)
 		d->in_flight_tags[wkr][i] = 0;
 	}
 
-	d->backlog[wkr].count = 0;
+	/* Move the rest of the backlog up for the next burst */
+	bl->count -= n;
+	memmove(bl->pkts, &bl->pkts[n], bl->count * sizeof(bl->pkts[0]));
+	memmove(bl->tags, &bl->tags[n], bl->count * sizeof(bl->tags[0]));
+	memset(&bl->tags[bl->count], 0, n * sizeof(bl->tags[0]));
 
 	/* Clear the GET bit */
 	buf->bufptr64[0] &= ~RTE_DISTRIB_GET_BUF;
@@ -334,6 +332,18 @@ release(struct rte_distributor *d, unsigned int wkr)
 }
 
 
+/*
+ * Worker to which a flow is pinned: the flow hash is spread, then scaled
+ * to the number of workers.
+ */
+static inline unsigned int
+pinned_worker(const struct rte_distributor *d, uint32_t flow_hash)
+{
+	uint32_t h = flow_hash * RTE_DIST_PIN_HASH_MULT;
+
+	return ((uint64_t)h * d->num_workers) >> 32;
+}
+
 /* process a set of packets to distribute them to workers */
 int
 rte_distributor_process_v1705(struct rte_distributor *d,
@@ -375,22 +385,45 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 		else
 			pkts = RTE_DIST_BURST_SIZE;
 
-		for (i = 0; i < pkts; i++) {
-			if (mbufs[next_idx + i]) {
-				/* flows have to be non-zero */
-				flows[i] = mbufs[next_idx + i]->hash.usr | 1;
-			} else
+		if (d->flow_pinning) {
+			/*
+			 * Each flow always goes to the same worker, so there
+			 * is no need to look for it in flight.
+			 */
+			for (i = 0; i < pkts; i++) {
+				if (mbufs[next_idx + i]) {
+					matches[i] = pinned_worker(d,
+						mbufs[next_idx + i]->hash.usr)
+							+ 1;
+				} else
+					matches[i] = 0;
+				/* no flow to match with unpinned packets */
 				flows[i] = 0;
-		}
-		for (; i < RTE_DIST_BURST_SIZE; i++)
-			flows[i] = 0;
-
-		switch (d->dist_match_fn) {
-		case RTE_DIST_MATCH_VECTOR:
-			find_match_vec(d, &flows[0], &matches[0]);
-			break;
-		default:
-			find_match_scalar(d, &flows[0], &matches[0]);
+			}
+		} else {
+			for (i = 0; i < pkts; i++) {
+				if (mbufs[next_idx + i]) {
+					/* flows have to be non-zero */
+					flows[i] = mbufs[next_idx + i]->hash.usr
+							| 1;
+				} else
+					flows[i] = 0;
+			}
+			for (; i < RTE_DIST_BURST_SIZE; i++)
+				flows[i] = 0;
+
+			switch (d->dist_match_fn) {
+#ifdef CC_AVX2_SUPPORT
+			case RTE_DIST_MATCH_AVX2:
+				find_match_avx2(d, &flows[0], &matches[0]);
+				break;
+#endif
+			case RTE_DIST_MATCH_VECTOR:
+				find_match_vec(d, &flows[0], &matches[0]);
+				break;
+			default:
+				find_match_scalar(d, &flows[0], &matches[0]);
+			}
 		}
 
 		/*
@@ -424,7 +457,7 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 				struct rte_distributor_backlog *bl =
 						&d->backlog[matches[j]-1];
 				if (unlikely(bl->count ==
-						RTE_DIST_BURST_SIZE)) {
+						RTE_DIST_BACKLOG_SIZE)) {
 					release(d, matches[j]-1);
 				}
 
@@ -438,7 +471,7 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 				struct rte_distributor_backlog *bl =
 						&d->backlog[wkr];
 				if (unlikely(bl->count ==
-						RTE_DIST_BURST_SIZE)) {
+						RTE_DIST_BACKLOG_SIZE)) {
 					release(d, wkr);
 				}
 
@@ -580,6 +613,34 @@ BIND_DEFAULT_SYMBOL(rte_distributor_clear_returns, _v1705, 17.05);
 MAP_STATIC_SYMBOL(void rte_distributor_clear_returns(struct rte_distributor *d),
 		rte_distributor_clear_returns_v1705);
 
+/* returns whether a worker still handles a flow of its last burst */
+static int
+tags_in_flight(const struct rte_distributor *d)
+{
+	unsigned int wkr, i;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		for (i = 0; i < RTE_DIST_BURST_SIZE; i++)
+			if (d->in_flight_tags[wkr][i] != 0)
+				return 1;
+
+	return 0;
+}
+
+int
+rte_distributor_flow_pinning_set(struct rte_distributor *d, int enable)
+{
+	if (d == NULL || d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -EINVAL;
+
+	/* Queued or in flight packets may belong to flows pinned elsewhere */
+	if (total_outstanding(d) > 0 || tags_in_flight(d))
+		return -EBUSY;
+
+	d->flow_pinning = !!enable;
+	return 0;
+}
+
 /* creates a distributor instance */
 struct rte_distributor *
 rte_distributor_create_v1705(const char *name,
@@ -598,6 +659,8 @@ rte_distributor_create_v1705(const char *name,
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(*d) & RTE_CACHE_LINE_MASK) != 0);
 	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 7) != 0);
+	RTE_BUILD_BUG_ON(RTE_DISTRIB_MAX_RETURNS <
+			RTE_DISTRIB_MAX_WORKERS * RTE_DIST_TAGS_PER_WORKER);
 
 	if (name == NULL || num_workers >=
 		(unsigned int)RTE_MIN(RTE_DISTRIB_MAX_WORKERS, RTE_MAX_LCORE)) {
@@ -637,7 +700,12 @@ rte_distributor_create_v1705(const char *name,
 	d->dist_match_fn = RTE_DIST_MATCH_SCALAR;
 #if defined(RTE_ARCH_X86)
 	d->dist_match_fn = RTE_DIST_MATCH_VECTOR;
+#ifdef CC_AVX2_SUPPORT
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+		d->dist_match_fn = RTE_DIST_MATCH_AVX2;
+#endif
 #endif
+	d->flow_pinning = 0;
 
 	/*
 	 * Set up the backlog tags so they're pointing at the second cache
@@ -13,6 +13,8 @@
  * one-at-a-time to workers, with dynamic load balancing.
  */
 
+#include <rte_compat.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -132,6 +134,36 @@ rte_distributor_flush(struct rte_distributor *d);
 void
 rte_distributor_clear_returns(struct rte_distributor *d);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable or disable flow pinning in a burst mode distributor.
+ *
+ * With flow pinning, each flow is always sent to the same worker, chosen
+ * from a hash of the full 32-bit tag of the mbuf, e.g. its RSS hash,
+ * instead of going to whichever worker is free unless the flow is already
+ * in flight. This saves looking up the flows in flight and keeps a
+ * long-lived affinity between flows and workers, at the cost of dynamic
+ * load balancing.
+ *
+ * This should only be called on the same lcore as rte_distributor_process(),
+ * once the distributor has been flushed.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param enable
+ *   Non-zero to enable flow pinning, zero to disable it
+ * @return
+ *   - 0 on success
+ *   - -EINVAL if the distributor is not a burst mode one
+ *   - -EBUSY if packets are still queued for the workers, or handled by
+ *     them
+ */
+__rte_experimental
+int
+rte_distributor_flow_pinning_set(struct rte_distributor *d, int enable);
+
 /*  *** APIS to be called on the worker lcores ***  */
 /*
  * The following APIs are the public APIs which are designed for use on
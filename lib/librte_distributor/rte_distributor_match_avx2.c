@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#include <rte_mbuf.h>
+#include "rte_distributor_private.h"
+#include "rte_distributor.h"
+#include "immintrin.h"
+
+
+void
+find_match_avx2(struct rte_distributor *d,
+			uint16_t *data_ptr,
+			uint16_t *output_ptr)
+{
+	/* Setup */
+	__m256i incoming_fids[RTE_DIST_BURST_SIZE];
+	__m256i tag_fids;
+	__m256i mask;
+	unsigned int nb_tags;
+	uint16_t i, j, k;
+
+	/*
+	 * Function overview:
+	 * 1. Broadcast each incoming flow_id into its own ymm reg
+	 * 2. Loop through all worker ID's
+	 *  2a. Load the inflights and backlog tags of that worker, 16 at a
+	 *      time, into a ymm reg
+	 *  2b. Compare them against each incoming flow_id
+	 *  2c. Set the worker ID in the output for any match
+	 */
+
+	for (j = 0; j < RTE_DIST_BURST_SIZE; j++) {
+		incoming_fids[j] = _mm256_set1_epi16(data_ptr[j]);
+		output_ptr[j] = 0;
+	}
+
+	for (i = 0; i < d->num_workers; i++) {
+		nb_tags = RTE_DIST_BURST_SIZE + d->backlog[i].count;
+
+		for (k = 0; k < nb_tags; k += 16) {
+			tag_fids = _mm256_load_si256(
+				(__m256i *)&d->in_flight_tags[i][k]);
+
+			for (j = 0; j < RTE_DIST_BURST_SIZE; j++) {
+				mask = _mm256_cmpeq_epi16(tag_fids,
+						incoming_fids[j]);
+				if (!_mm256_testz_si256(mask, mask))
+					output_ptr[j] = i + 1;
+			}
+		}
+	}
+
+	/*
+	 * At this stage, the output contains 8 16-bit values, with
+	 * each non-zero value containing the worker ID on which the
+	 * corresponding flow is pinned to.
+	 */
+}
@@ -36,7 +36,11 @@ extern "C" {
 #define RTE_DISTRIB_BACKLOG_SIZE 8
 #define RTE_DISTRIB_BACKLOG_MASK (RTE_DISTRIB_BACKLOG_SIZE - 1)
 
-#define RTE_DISTRIB_MAX_RETURNS 128
+/*
+ * Large enough for all the packets queued and in flight in the burst API,
+ * so that flushing the distributor does not overwrite any returned packet.
+ */
+#define RTE_DISTRIB_MAX_RETURNS 2048
 #define RTE_DISTRIB_RETURNS_MASK (RTE_DISTRIB_MAX_RETURNS - 1)
 
 /**
@@ -66,11 +70,22 @@ union rte_distributor_buffer_v20 {
  */
 #define RTE_DIST_BURST_SIZE 8
 
+/*
+ * Packets queued per worker in the burst API while the worker processes
+ * its current burst. The tags of these and of the burst in flight fill
+ * one cache line per worker, compared as a whole by the flow matching.
+ */
+#define RTE_DIST_BACKLOG_SIZE (RTE_DIST_BURST_SIZE * 3)
+#define RTE_DIST_TAGS_PER_WORKER (RTE_DIST_BURST_SIZE + RTE_DIST_BACKLOG_SIZE)
+
+/* Multiplier spreading the flow hash of pinned flows, 2^32 / golden ratio */
+#define RTE_DIST_PIN_HASH_MULT 0x9e3779b1
+
 struct rte_distributor_backlog {
 	unsigned int start;
 	unsigned int count;
-	int64_t pkts[RTE_DIST_BURST_SIZE] __rte_cache_aligned;
-	uint16_t *tags; /* will point to second cacheline of inflights */
+	int64_t pkts[RTE_DIST_BACKLOG_SIZE] __rte_cache_aligned;
+	uint16_t *tags; /* will point after the inflight tags of the worker */
 } __rte_cache_aligned;
 
 
@@ -105,6 +120,7 @@ struct rte_distributor_v20 {
 enum rte_distributor_match_function {
 	RTE_DIST_MATCH_SCALAR = 0,
 	RTE_DIST_MATCH_VECTOR,
+	RTE_DIST_MATCH_AVX2,
 	RTE_DIST_NUM_MATCH_FNS
 };
 
@@ -138,11 +154,11 @@ struct rte_distributor {
 	unsigned int alg_type;                /**< Number of alg types */
 
 	/**>
-	 * First cache line in the this array are the tags inflight
-	 * on the worker core. Second cache line are the backlog
-	 * that are going to go to the worker core.
+	 * First RTE_DIST_BURST_SIZE tags of each worker are the tags inflight
+	 * on the worker core. The rest are the backlog that are going to go
+	 * to the worker core, zero when unused.
 	 */
-	uint16_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS][RTE_DIST_BURST_SIZE*2]
+	uint16_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS][RTE_DIST_TAGS_PER_WORKER]
 			__rte_cache_aligned;
 
 	struct rte_distributor_backlog backlog[RTE_DISTRIB_MAX_WORKERS]
@@ -154,6 +170,8 @@ struct rte_distributor {
 
 	enum rte_distributor_match_function dist_match_fn;
 
+	unsigned int flow_pinning; /**< each flow sent to a fixed worker */
+
 	struct rte_distributor_v20 *d_v20;
 };
 
@@ -167,6 +185,11 @@ find_match_vec(struct rte_distributor *d,
 			uint16_t *data_ptr,
 			uint16_t *output_ptr);
 
+void
+find_match_avx2(struct rte_distributor *d,
+			uint16_t *data_ptr,
+			uint16_t *output_ptr);
+
 #ifdef __cplusplus
 }
 #endif
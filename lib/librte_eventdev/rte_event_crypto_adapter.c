@@ -10,6 +10,7 @@
 #include <rte_errno.h>
 #include <rte_cryptodev.h>
 #include <rte_cryptodev_pmd.h>
+#include <rte_cycles.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
 #include <rte_service_component.h>
@@ -22,12 +23,23 @@
 #define DEFAULT_MAX_NB 128
 #define CRYPTO_ADAPTER_NAME_LEN 32
 #define CRYPTO_ADAPTER_MEM_NAME_LEN 32
-#define CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES 100
 
-/* Flush an instance's enqueue buffers every CRYPTO_ENQ_FLUSH_THRESHOLD
- * iterations of eca_crypto_adapter_enq_run()
+/* Crypto ops buffered per queue pair. A queue pair buffer with less than
+ * BATCH_SIZE free entries stops the adapter from dequeuing more crypto
+ * request events until the cryptodev accepts some of the buffered ops.
  */
-#define CRYPTO_ENQ_FLUSH_THRESHOLD 1024
+#define CRYPTO_ADAPTER_OPS_BUFFER_SZ (3 * BATCH_SIZE)
+#define CRYPTO_ADAPTER_MAX_ENQ_BATCH (2 * BATCH_SIZE)
+
+/* Completion events buffered for the event device. The cryptodevs are not
+ * polled while the buffer has less than BATCH_SIZE free entries.
+ */
+#define CRYPTO_ADAPTER_EV_BUFFER_SZ (2 * BATCH_SIZE)
+
+/* Default time a crypto op waits in a queue pair buffer for its batch to
+ * fill up before being submitted to the cryptodev.
+ */
+#define CRYPTO_ADAPTER_ENQ_FLUSH_TIMEOUT_NS 10000
 
 struct rte_event_crypto_adapter {
 	/* Event device identifier */
@@ -44,8 +56,17 @@ struct rte_event_crypto_adapter {
 	uint16_t next_cdev_id;
 	/* Per crypto device structure */
 	struct crypto_device_info *cdevs;
-	/* Loop counter to flush crypto ops */
-	uint16_t transmit_loop_count;
+	/* Crypto ops submitted to a queue pair once that many are buffered */
+	uint16_t enq_batch_size;
+	/* Buffered crypto ops are submitted after that many timer cycles */
+	uint64_t enq_flush_ticks;
+	/* Crypto ops buffered in all the queue pairs */
+	uint32_t nb_ops_buffered;
+	/* Queue pairs without room for a burst of crypto ops */
+	uint16_t nb_qps_full;
+	/* Completion events the event device has not accepted yet */
+	uint16_t ev_buf_count;
+	struct rte_event ev_buf[CRYPTO_ADAPTER_EV_BUFFER_SZ];
 	/* Per instance stats structure */
 	struct rte_event_crypto_adapter_stats crypto_stats;
 	/* Configuration callback for rte_service configuration */
@@ -95,7 +116,9 @@ struct crypto_queue_pair_info {
 	/* Pointer to hold rte_crypto_ops for batching */
 	struct rte_crypto_op **op_buffer;
 	/* No of crypto ops accumulated */
-	uint8_t len;
+	uint16_t len;
+	/* Timer cycles when the oldest buffered op was added */
+	uint64_t first_op_tsc;
 } __rte_cache_aligned;
 
 static struct rte_event_crypto_adapter **event_crypto_adapter;
@@ -191,6 +214,12 @@ eca_default_config_cb(uint8_t id, uint8_t dev_id,
 	if (started)
 		ret = rte_event_dev_start(dev_id);
 
+	/* Forwarding the completions is only correct when the port does not
+	 * release the dequeued events by itself, otherwise each completion
+	 * would enter the event device without taking a credit.
+	 */
+	adapter->implicit_release_disabled =
+		port_conf->disable_implicit_release;
 	adapter->default_cb_arg = 1;
 	return ret;
 }
@@ -250,6 +279,10 @@ rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
 	adapter->conf_cb = conf_cb;
 	adapter->conf_arg = conf_arg;
 	adapter->mode = mode;
+	adapter->enq_batch_size = BATCH_SIZE;
+	adapter->enq_flush_ticks =
+		(double)CRYPTO_ADAPTER_ENQ_FLUSH_TIMEOUT_NS *
+		rte_get_timer_hz() / 1E9;
 	strcpy(adapter->mem_name, mem_name);
 	adapter->cdevs = rte_zmalloc_socket(adapter->mem_name,
 					rte_cryptodev_count() *
@@ -323,6 +356,62 @@ rte_event_crypto_adapter_free(uint8_t id)
 	return 0;
 }
 
+static inline bool
+eca_qp_is_full(const struct crypto_queue_pair_info *qp_info)
+{
+	return qp_info->len > CRYPTO_ADAPTER_OPS_BUFFER_SZ - BATCH_SIZE;
+}
+
+static inline void
+eca_op_free(struct rte_crypto_op *op)
+{
+	rte_pktmbuf_free(op->sym->m_src);
+	rte_crypto_op_free(op);
+}
+
+/* Submit the crypto ops buffered for a queue pair to the cryptodev. The ops
+ * the cryptodev has no room for stay in the buffer and are submitted again
+ * later on, instead of being dropped.
+ */
+static unsigned int
+eca_qp_flush(struct rte_event_crypto_adapter *adapter, uint8_t cdev_id,
+	     uint16_t qp_id, struct crypto_queue_pair_info *qp_info)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	bool was_full = eca_qp_is_full(qp_info);
+	uint16_t n;
+
+	n = rte_cryptodev_enqueue_burst(cdev_id, qp_id, qp_info->op_buffer,
+					qp_info->len);
+	stats->crypto_enq_count += n;
+
+	if (n < qp_info->len) {
+		stats->crypto_enq_fail += qp_info->len - n;
+		memmove(qp_info->op_buffer, &qp_info->op_buffer[n],
+			(qp_info->len - n) * sizeof(qp_info->op_buffer[0]));
+	}
+
+	qp_info->len -= n;
+	adapter->nb_ops_buffered -= n;
+	adapter->nb_qps_full -= was_full && !eca_qp_is_full(qp_info);
+
+	return n;
+}
+
+/* Free the crypto ops left in the buffer of a queue pair being removed */
+static void
+eca_qp_drop(struct rte_event_crypto_adapter *adapter,
+	    struct crypto_queue_pair_info *qp_info)
+{
+	uint16_t i;
+
+	adapter->nb_qps_full -= eca_qp_is_full(qp_info);
+	adapter->nb_ops_buffered -= qp_info->len;
+	for (i = 0; i < qp_info->len; i++)
+		eca_op_free(qp_info->op_buffer[i]);
+	qp_info->len = 0;
+}
+
 static inline unsigned int
 eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 		 struct rte_event *ev, unsigned int cnt)
@@ -332,11 +421,10 @@ eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 	struct crypto_queue_pair_info *qp_info = NULL;
 	struct rte_crypto_op *crypto_op;
 	unsigned int i, n;
-	uint16_t qp_id, len, ret;
+	uint16_t qp_id;
 	uint8_t cdev_id;
+	uint64_t now = 0;
 
-	len = 0;
-	ret = 0;
 	n = 0;
 	stats->event_deq_count += cnt;
 
@@ -348,116 +436,88 @@ eca_enq_to_cryptodev(struct rte_event_crypto_adapter *adapter,
 			m_data = rte_cryptodev_sym_session_get_user_data(
 					crypto_op->sym->session);
 			if (m_data == NULL) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (!qp_info->qp_enabled) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
+				eca_op_free(crypto_op);
 				continue;
 			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
 		} else if (crypto_op->sess_type == RTE_CRYPTO_OP_SESSIONLESS &&
 				crypto_op->private_data_offset) {
 			m_data = (union rte_event_crypto_metadata *)
 				 ((uint8_t *)crypto_op +
 					crypto_op->private_data_offset);
-			cdev_id = m_data->request_info.cdev_id;
-			qp_id = m_data->request_info.queue_pair_id;
-			qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
-			if (!qp_info->qp_enabled) {
-				rte_pktmbuf_free(crypto_op->sym->m_src);
-				rte_crypto_op_free(crypto_op);
-				continue;
-			}
-			len = qp_info->len;
-			qp_info->op_buffer[len] = crypto_op;
-			len++;
 		} else {
-			rte_pktmbuf_free(crypto_op->sym->m_src);
-			rte_crypto_op_free(crypto_op);
+			eca_op_free(crypto_op);
 			continue;
 		}
 
-		if (len == BATCH_SIZE) {
-			struct rte_crypto_op **op_buffer = qp_info->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp_id,
-							  op_buffer,
-							  BATCH_SIZE);
-
-			stats->crypto_enq_count += ret;
-
-			while (ret < len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
-
-			len = 0;
+		cdev_id = m_data->request_info.cdev_id;
+		qp_id = m_data->request_info.queue_pair_id;
+		qp_info = &adapter->cdevs[cdev_id].qpairs[qp_id];
+		if (!qp_info->qp_enabled) {
+			eca_op_free(crypto_op);
+			continue;
 		}
 
-		if (qp_info)
-			qp_info->len = len;
-		n += ret;
+		if (qp_info->len == 0) {
+			if (now == 0)
+				now = rte_get_timer_cycles();
+			qp_info->first_op_tsc = now;
+		}
+		qp_info->op_buffer[qp_info->len++] = crypto_op;
+		adapter->nb_ops_buffered++;
+		/* the buffer just lost the room for a burst */
+		if (qp_info->len == CRYPTO_ADAPTER_OPS_BUFFER_SZ - BATCH_SIZE + 1)
+			adapter->nb_qps_full++;
+
+		if (qp_info->len >= adapter->enq_batch_size)
+			n += eca_qp_flush(adapter, cdev_id, qp_id, qp_info);
 	}
 
 	return n;
 }
 
+/* Submit the crypto ops of the queue pairs whose oldest buffered op has
+ * waited for longer than the flush timeout, or of all the queue pairs with
+ * buffered ops if flush_all is set.
+ */
 static unsigned int
-eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter)
+eca_crypto_enq_flush(struct rte_event_crypto_adapter *adapter, bool flush_all)
 {
 	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
 	struct crypto_device_info *curr_dev;
 	struct crypto_queue_pair_info *curr_queue;
-	struct rte_crypto_op **op_buffer;
 	struct rte_cryptodev *dev;
 	uint8_t cdev_id;
 	uint16_t qp;
-	uint16_t ret;
+	unsigned int n = 0;
 	uint16_t num_cdev = rte_cryptodev_count();
+	uint64_t now;
+
+	if (adapter->nb_ops_buffered == 0)
+		return 0;
 
-	ret = 0;
+	now = rte_get_timer_cycles();
 	for (cdev_id = 0; cdev_id < num_cdev; cdev_id++) {
 		curr_dev = &adapter->cdevs[cdev_id];
 		dev = curr_dev->dev;
-		if (dev == NULL)
+		if (dev == NULL || curr_dev->qpairs == NULL)
 			continue;
 		for (qp = 0; qp < dev->data->nb_queue_pairs; qp++) {
 
 			curr_queue = &curr_dev->qpairs[qp];
-			if (!curr_queue->qp_enabled)
+			if (!curr_queue->qp_enabled || curr_queue->len == 0)
 				continue;
 
-			op_buffer = curr_queue->op_buffer;
-			ret = rte_cryptodev_enqueue_burst(cdev_id,
-							  qp,
-							  op_buffer,
-							  curr_queue->len);
-			stats->crypto_enq_count += ret;
-
-			while (ret < curr_queue->len) {
-				struct rte_crypto_op *op;
-				op = op_buffer[ret++];
-				stats->crypto_enq_fail++;
-				rte_pktmbuf_free(op->sym->m_src);
-				rte_crypto_op_free(op);
-			}
-			curr_queue->len = 0;
+			if (!flush_all && !eca_qp_is_full(curr_queue) &&
+			    now - curr_queue->first_op_tsc <
+					adapter->enq_flush_ticks)
+				continue;
+
+			stats->crypto_enq_timeout_count += !flush_all;
+			n += eca_qp_flush(adapter, cdev_id, qp, curr_queue);
 		}
 	}
 
-	return ret;
+	return n;
 }
 
 static int
@@ -476,6 +536,17 @@ eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
 		return 0;
 
 	for (nb_enq = 0; nb_enq < max_enq; nb_enq += n) {
+		/* Leave the crypto requests in the event device while a
+		 * queue pair buffer has no room for a full burst.
+		 */
+		if (unlikely(adapter->nb_qps_full)) {
+			nb_enqueued += eca_crypto_enq_flush(adapter, true);
+			if (adapter->nb_qps_full) {
+				stats->event_deq_backpressure_count++;
+				break;
+			}
+		}
+
 		stats->event_poll_count++;
 		n = rte_event_dequeue_burst(event_dev_id,
 					    event_port_id, ev, BATCH_SIZE, 0);
@@ -486,33 +557,49 @@ eca_crypto_adapter_enq_run(struct rte_event_crypto_adapter *adapter,
 		nb_enqueued += eca_enq_to_cryptodev(adapter, ev, n);
 	}
 
-	if ((++adapter->transmit_loop_count &
-		(CRYPTO_ENQ_FLUSH_THRESHOLD - 1)) == 0) {
-		nb_enqueued += eca_crypto_enq_flush(adapter);
-	}
+	nb_enqueued += eca_crypto_enq_flush(adapter, false);
 
 	return nb_enqueued;
 }
 
+/* Enqueue the buffered completion events to the event device. The events it
+ * does not accept stay in the buffer for the next attempt.
+ */
+static inline void
+eca_ev_flush(struct rte_event_crypto_adapter *adapter)
+{
+	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
+	uint16_t n;
+
+	n = rte_event_enqueue_burst(adapter->eventdev_id,
+				    adapter->event_port_id,
+				    adapter->ev_buf, adapter->ev_buf_count);
+	stats->event_enq_count += n;
+
+	if (n < adapter->ev_buf_count) {
+		stats->event_enq_fail_count += adapter->ev_buf_count - n;
+		memmove(adapter->ev_buf, &adapter->ev_buf[n],
+			(adapter->ev_buf_count - n) *
+			sizeof(adapter->ev_buf[0]));
+	}
+
+	adapter->ev_buf_count -= n;
+}
+
 static inline void
 eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 		  struct rte_crypto_op **ops, uint16_t num)
 {
-	struct rte_event_crypto_adapter_stats *stats = &adapter->crypto_stats;
-	union rte_event_crypto_metadata *m_data = NULL;
-	uint8_t event_dev_id = adapter->eventdev_id;
-	uint8_t event_port_id = adapter->event_port_id;
-	struct rte_event events[BATCH_SIZE];
-	uint16_t nb_enqueued, nb_ev;
-	uint8_t retry;
-	uint8_t i;
+	union rte_event_crypto_metadata *m_data;
+	uint8_t op = adapter->implicit_release_disabled ?
+		RTE_EVENT_OP_FORWARD : RTE_EVENT_OP_NEW;
+	uint16_t i;
 
-	nb_ev = 0;
-	retry = 0;
-	nb_enqueued = 0;
 	num = RTE_MIN(num, BATCH_SIZE);
 	for (i = 0; i < num; i++) {
-		struct rte_event *ev = &events[nb_ev++];
+		struct rte_event *ev;
+
+		m_data = NULL;
 		if (ops[i]->sess_type == RTE_CRYPTO_OP_WITH_SESSION) {
 			m_data = rte_cryptodev_sym_session_get_user_data(
 					ops[i]->sym->session);
@@ -524,40 +611,24 @@ eca_ops_enqueue_burst(struct rte_event_crypto_adapter *adapter,
 		}
 
 		if (unlikely(m_data == NULL)) {
-			rte_pktmbuf_free(ops[i]->sym->m_src);
-			rte_crypto_op_free(ops[i]);
+			eca_op_free(ops[i]);
 			continue;
 		}
 
+		ev = &adapter->ev_buf[adapter->ev_buf_count++];
 		rte_memcpy(ev, &m_data->response_info, sizeof(*ev));
 		ev->event_ptr = ops[i];
 		ev->event_type = RTE_EVENT_TYPE_CRYPTODEV;
-		if (adapter->implicit_release_disabled)
-			ev->op = RTE_EVENT_OP_FORWARD;
-		else
-			ev->op = RTE_EVENT_OP_NEW;
+		ev->op = op;
 	}
 
-	do {
-		nb_enqueued += rte_event_enqueue_burst(event_dev_id,
-						  event_port_id,
-						  &events[nb_enqueued],
-						  nb_ev - nb_enqueued);
-	} while (retry++ < CRYPTO_ADAPTER_MAX_EV_ENQ_RETRIES &&
-		 nb_enqueued < nb_ev);
-
-	/* Free mbufs and rte_crypto_ops for failed events */
-	for (i = nb_enqueued; i < nb_ev; i++) {
-		struct rte_crypto_op *op = events[i].event_ptr;
-		rte_pktmbuf_free(op->sym->m_src);
-		rte_crypto_op_free(op);
-	}
-
-	stats->event_enq_fail_count += nb_ev - nb_enqueued;
-	stats->event_enq_count += nb_enqueued;
-	stats->event_enq_retry_count += retry - 1;
+	eca_ev_flush(adapter);
 }
 
+/* Poll the completions of the queue pairs of all the cryptodevs in turn, a
+ * burst from each queue pair per round, resuming at the queue pair following
+ * the last one polled by the previous call.
+ */
 static inline unsigned int
 eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 			unsigned int max_deq)
@@ -569,31 +640,48 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 	uint16_t n, nb_deq;
 	struct rte_cryptodev *dev;
 	uint8_t cdev_id;
-	uint16_t qp, dev_qps;
+	uint16_t qp, dev_qps, queues, i;
 	bool done;
 	uint16_t num_cdev = rte_cryptodev_count();
 
+	if (num_cdev == 0)
+		return 0;
+
+	if (unlikely(adapter->ev_buf_count)) {
+		stats->event_enq_retry_count++;
+		eca_ev_flush(adapter);
+	}
+
 	nb_deq = 0;
 	do {
-		uint16_t queues = 0;
 		done = true;
 
-		for (cdev_id = adapter->next_cdev_id;
-			cdev_id < num_cdev; cdev_id++) {
+		for (i = 0; i < num_cdev; i++) {
+			cdev_id = adapter->next_cdev_id;
 			curr_dev = &adapter->cdevs[cdev_id];
 			dev = curr_dev->dev;
-			if (dev == NULL)
-				continue;
+			if (dev == NULL || curr_dev->qpairs == NULL)
+				goto next_cdev;
 			dev_qps = dev->data->nb_queue_pairs;
 
-			for (qp = curr_dev->next_queue_pair_id;
-				queues < dev_qps; qp = (qp + 1) % dev_qps,
-				queues++) {
+			for (queues = 0; queues < dev_qps; queues++) {
+				qp = curr_dev->next_queue_pair_id;
+				curr_dev->next_queue_pair_id = (qp + 1) %
+					dev_qps;
 
 				curr_queue = &curr_dev->qpairs[qp];
 				if (!curr_queue->qp_enabled)
 					continue;
 
+				/* Leave the completions in the cryptodev
+				 * while the event device is not keeping up.
+				 */
+				if (adapter->ev_buf_count >
+				    CRYPTO_ADAPTER_EV_BUFFER_SZ - BATCH_SIZE) {
+					stats->crypto_deq_backpressure_count++;
+					return nb_deq;
+				}
+
 				n = rte_cryptodev_dequeue_burst(cdev_id, qp,
 					ops, BATCH_SIZE);
 				if (!n)
@@ -604,18 +692,11 @@ eca_crypto_adapter_deq_run(struct rte_event_crypto_adapter *adapter,
 				eca_ops_enqueue_burst(adapter, ops, n);
 				nb_deq += n;
 
-				if (nb_deq > max_deq) {
-					if ((qp + 1) == dev_qps) {
-						adapter->next_cdev_id =
-							(cdev_id + 1)
-							% num_cdev;
-					}
-					curr_dev->next_queue_pair_id = (qp + 1)
-						% dev->data->nb_queue_pairs;
-
+				if (nb_deq >= max_deq)
 					return nb_deq;
-				}
 			}
+next_cdev:
+			adapter->next_cdev_id = (cdev_id + 1) % num_cdev;
 		}
 	} while (done == false);
 	return nb_deq;
@@ -718,11 +799,24 @@ eca_update_qp_info(struct rte_event_crypto_adapter *adapter,
 		} else {
 			adapter->nb_qps -= enabled;
 			dev_info->num_qpairs -= enabled;
+			if (qp_info->op_buffer != NULL)
+				eca_qp_drop(adapter, qp_info);
 		}
 		qp_info->qp_enabled = !!add;
 	}
 }
 
+static void
+eca_free_qpairs(struct crypto_device_info *dev_info)
+{
+	uint16_t i;
+
+	for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++)
+		rte_free(dev_info->qpairs[i].op_buffer);
+	rte_free(dev_info->qpairs);
+	dev_info->qpairs = NULL;
+}
+
 static int
 eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 		uint8_t cdev_id,
@@ -742,13 +836,16 @@ eca_add_queue_pair(struct rte_event_crypto_adapter *adapter,
 			return -ENOMEM;
 
 		qpairs = dev_info->qpairs;
-		qpairs->op_buffer = rte_zmalloc_socket(adapter->mem_name,
-					BATCH_SIZE *
+		for (i = 0; i < dev_info->dev->data->nb_queue_pairs; i++) {
+			qpairs[i].op_buffer = rte_zmalloc_socket(
+					adapter->mem_name,
+					CRYPTO_ADAPTER_OPS_BUFFER_SZ *
 					sizeof(struct rte_crypto_op *),
 					0, adapter->socket_id);
-		if (!qpairs->op_buffer) {
-			rte_free(qpairs);
-			return -ENOMEM;
+			if (qpairs[i].op_buffer == NULL) {
+				eca_free_qpairs(dev_info);
+				return -ENOMEM;
+			}
 		}
 	}
 
@@ -942,17 +1039,14 @@ rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
 		if (queue_pair_id == -1) {
 			for (i = 0; i < dev_info->dev->data->nb_queue_pairs;
 				i++)
-				eca_update_qp_info(adapter, dev_info,
-							queue_pair_id, 0);
+				eca_update_qp_info(adapter, dev_info, i, 0);
 		} else {
 			eca_update_qp_info(adapter, dev_info,
 						(uint16_t)queue_pair_id, 0);
 		}
 
-		if (dev_info->num_qpairs == 0) {
-			rte_free(dev_info->qpairs);
-			dev_info->qpairs = NULL;
-		}
+		if (dev_info->num_qpairs == 0 && dev_info->qpairs != NULL)
+			eca_free_qpairs(dev_info);
 
 		rte_spinlock_unlock(&adapter->lock);
 		rte_service_component_runstate_set(adapter->service_id,
@@ -1096,6 +1190,32 @@ rte_event_crypto_adapter_stats_reset(uint8_t id)
 	return 0;
 }
 
+int
+rte_event_crypto_adapter_enq_batch_set(uint8_t id, uint16_t batch_size,
+				       uint64_t flush_timeout_ns)
+{
+	struct rte_event_crypto_adapter *adapter;
+
+	EVENT_CRYPTO_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	adapter = eca_id_to_adapter(id);
+	if (adapter == NULL)
+		return -EINVAL;
+
+	if (batch_size == 0 || batch_size > CRYPTO_ADAPTER_MAX_ENQ_BATCH) {
+		RTE_EDEV_LOG_ERR("Invalid batch size %" PRIu16, batch_size);
+		return -EINVAL;
+	}
+
+	rte_spinlock_lock(&adapter->lock);
+	adapter->enq_batch_size = batch_size;
+	adapter->enq_flush_ticks = (double)flush_timeout_ns *
+		rte_get_timer_hz() / 1E9;
+	rte_spinlock_unlock(&adapter->lock);
+
+	return 0;
+}
+
 int
 rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id)
 {
@@ -138,6 +138,7 @@
  *  - rte_event_crypto_adapter_stop()
  *  - rte_event_crypto_adapter_stats_get()
  *  - rte_event_crypto_adapter_stats_reset()
+ *  - rte_event_crypto_adapter_enq_batch_set()
 
  * The application creates an instance using rte_event_crypto_adapter_create()
  * or rte_event_crypto_adapter_create_ext().
@@ -162,6 +163,14 @@
  * The rte_crypto_op::private_data_offset provides an offset to locate the
  * request/response information in the rte_crypto_op. This offset is counted
  * from the start of the rte_crypto_op including initialization vector (IV).
+ *
+ * In the RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode, the SW adapter buffers the
+ * crypto operations per queue pair and submits them to the cryptodev once a
+ * batch is complete or the oldest operation has waited for the flush
+ * timeout, both set using rte_event_crypto_adapter_enq_batch_set(). The
+ * operations that a queue pair or the event device does not accept are kept
+ * by the adapter and retried; the adapter stops dequeuing from the side
+ * feeding a full buffer until it drains, instead of dropping operations.
  */
 
 #ifdef __cplusplus
@@ -170,6 +179,8 @@ extern "C" {
 
 #include <stdint.h>
 
+#include <rte_compat.h>
+
 #include "rte_eventdev.h"
 
 /**
@@ -290,7 +301,9 @@ struct rte_event_crypto_adapter_stats {
 	uint64_t crypto_enq_count;
 	/**< Cryptodev enqueue count */
 	uint64_t crypto_enq_fail;
-	/**< Cryptodev enqueue failed count */
+	/**< Cryptodev enqueue failed count, crypto ops not accepted by the
+	 * cryptodev and retried later by the SW adapter
+	 */
 	uint64_t crypto_deq_count;
 	/**< Cryptodev dequeue count */
 	uint64_t event_enq_count;
@@ -298,7 +311,15 @@ struct rte_event_crypto_adapter_stats {
 	uint64_t event_enq_retry_count;
 	/**< Event enqueue retry count */
 	uint64_t event_enq_fail_count;
-	/**< Event enqueue fail count */
+	/**< Event enqueue fail count, events not accepted by the event device
+	 * and retried later by the SW adapter
+	 */
+	uint64_t crypto_enq_timeout_count;
+	/**< Partial batches of crypto ops submitted on flush timeout */
+	uint64_t event_deq_backpressure_count;
+	/**< Event port polls skipped as a queue pair buffer was full */
+	uint64_t crypto_deq_backpressure_count;
+	/**< Cryptodev polls skipped as the event buffer was full */
 };
 
 /**
@@ -487,6 +508,38 @@ rte_event_crypto_adapter_stats_get(uint8_t id,
 int
 rte_event_crypto_adapter_stats_reset(uint8_t id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the batching of the crypto operations a SW adapter submits to the
+ * cryptodev queue pairs in the RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode.
+ * The operations are buffered per queue pair and submitted once
+ * batch_size of them are buffered, or once the oldest one has waited for
+ * flush_timeout_ns. The defaults are a batch of 32 operations and a flush
+ * timeout of 10us.
+ *
+ * @param id
+ *  Adapter identifier.
+ *
+ * @param batch_size
+ *  Number of crypto operations submitted at once to a queue pair, between
+ *  1 and 64.
+ *
+ * @param flush_timeout_ns
+ *  Maximum time in nanoseconds a crypto operation waits for its batch to
+ *  complete, 0 submits the buffered operations on each service function
+ *  call.
+ *
+ * @return
+ *  - 0: Success
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int
+rte_event_crypto_adapter_enq_batch_set(uint8_t id, uint16_t batch_size,
+				       uint64_t flush_timeout_ns);
+
 /**
  * Retrieve the service ID of an adapter. If the adapter doesn't use
  * a rte_service function, this function returns -ESRCH.
@@ -7,6 +7,7 @@
 #endif
 #include <unistd.h>
 
+#include <rte_atomic.h>
 #include <rte_cycles.h>
 #include <rte_common.h>
 #include <rte_dev.h>
@@ -14,7 +15,10 @@
 #include <rte_ethdev.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
 #include <rte_service_component.h>
+#include <rte_tailq.h>
 #include <rte_thash.h>
 #include <rte_interrupts.h>
 
@@ -35,6 +39,17 @@
 /* Sentinel value to detect initialized file handle */
 #define INIT_FD		-1
 
+#define RXA_NSEC2TICK(__ns, __freq) (((__ns) * (__freq)) / 1E9)
+
+/* Event vector limits of the SW adapter */
+#define RXA_VECTOR_MIN_SZ	4
+#define RXA_VECTOR_MAX_SZ	UINT16_MAX
+#define RXA_VECTOR_MIN_TMO_NS	1000
+#define RXA_VECTOR_MAX_TMO_NS	1000000000ULL
+
+/* One sequence number per value of the 20 bit event flow identifier */
+#define RXA_SEQN_NB_FLOWS	(1 << 20)
+
 /*
  * Used to store port and queue ID of interrupting Rx queue
  */
@@ -58,6 +73,32 @@ struct eth_rx_poll_entry {
 	uint16_t eth_rx_qid;
 };
 
+/*
+ * Vector under construction for a Rx queue that has event vectorization
+ * enabled, queued on the adapter vector list while it holds mbufs
+ */
+struct eth_rx_vector_data {
+	TAILQ_ENTRY(eth_rx_vector_data) next;
+	/* Eth port of the Rx queue */
+	uint16_t port;
+	/* Eth Rx queue */
+	uint16_t queue;
+	/* Max number of mbufs in a vector */
+	uint16_t max_vector_count;
+	/* Event used for the vector events of the Rx queue */
+	uint64_t event;
+	/* Timestamp of the first mbuf added to the vector */
+	uint64_t ts;
+	/* Timeout after which a partial vector is enqueued */
+	uint64_t vector_timeout_ticks;
+	/* Mempool the vectors are allocated from */
+	struct rte_mempool *vector_pool;
+	/* Vector being filled, NULL if none */
+	struct rte_event_vector *vector_ev;
+} __rte_cache_aligned;
+
+TAILQ_HEAD(eth_rx_vector_data_list, eth_rx_vector_data);
+
 /* Instance per adapter */
 struct rte_eth_event_enqueue_buffer {
 	/* Count of events in this buffer */
@@ -66,17 +107,17 @@ struct rte_eth_event_enqueue_buffer {
 	struct rte_event events[ETH_EVENT_BUFFER_SIZE];
 };
 
-struct rte_event_eth_rx_adapter {
-	/* RSS key */
-	uint8_t rss_key_be[RSS_KEY_SIZE];
-	/* Event device identifier */
-	uint8_t eventdev_id;
-	/* Per ethernet device structure */
-	struct eth_device_info *eth_devices;
-	/* Event port identifier */
-	uint8_t event_port_id;
+/*
+ * Instance per adapter shard, a shard is a service function polling a subset
+ * of the Rx queues of the adapter
+ */
+struct rxa_shard {
 	/* Lock to serialize config updates with service function */
 	rte_spinlock_t rx_lock;
+	/* Shard identifier */
+	uint16_t id;
+	/* Event port identifier */
+	uint8_t event_port_id;
 	/* Max mbufs processed in any service function invocation */
 	uint32_t max_nb_rx;
 	/* Receive queues that need to be polled */
@@ -89,14 +130,50 @@ struct rte_event_eth_rx_adapter {
 	uint32_t wrr_len;
 	/* Next entry in wrr[] to begin polling */
 	uint32_t wrr_pos;
+	/* eth_rx_poll and wrr_sched arrays installed by the next
+	 * queue add/del
+	 */
+	struct eth_rx_poll_entry *next_rx_poll;
+	uint32_t *next_wrr_sched;
 	/* Event burst buffer */
 	struct rte_eth_event_enqueue_buffer event_enqueue_buffer;
-	/* Per adapter stats */
+	/* Per shard stats */
 	struct rte_event_eth_rx_adapter_stats stats;
+	/* Vectors holding mbufs, in order of creation */
+	struct eth_rx_vector_data_list vector_list;
+	/* Last time the vector list was checked for expired vectors */
+	uint64_t prev_expiry_ts;
+	/* Minimum period between two checks of the vector list */
+	uint64_t vector_tmo_ticks;
+	/* Set if any Rx queue of the shard has event vectorization enabled */
+	uint8_t ena_vector;
 	/* Block count, counts up to BLOCK_CNT_THRESHOLD */
 	uint16_t enq_block_count;
 	/* Block start ts */
 	uint64_t rx_enq_block_start_ts;
+	/* Per shard EAL service */
+	uint32_t service_id;
+	/* Adapter the shard belongs to */
+	struct rte_event_eth_rx_adapter *rx_adapter;
+} __rte_cache_aligned;
+
+struct rte_event_eth_rx_adapter {
+	/* RSS key */
+	uint8_t rss_key_be[RSS_KEY_SIZE];
+	/* Event device identifier */
+	uint8_t eventdev_id;
+	/* Per ethernet device structure */
+	struct eth_device_info *eth_devices;
+	/* Shards of the adapter, shard 0 also services the interrupt
+	 * driven Rx queues
+	 */
+	struct rxa_shard *shards;
+	/* Number of shards */
+	uint16_t nb_shards;
+	/* Num of polled Rx queues, all shards included */
+	uint32_t num_rx_polled;
+	/* Sum of the polling weights, all shards included */
+	uint32_t wrr_len;
 	/* epoll fd used to wait for Rx interrupts */
 	int epd;
 	/* Num of interrupt driven interrupt queues */
@@ -131,12 +208,14 @@ struct rte_event_eth_rx_adapter {
 	uint8_t service_inited;
 	/* Total count of Rx queues in adapter */
 	uint32_t nb_queues;
+	/* Next sequence number of each event flow identifier, allocated
+	 * when the first Rx queue numbering its mbufs is added
+	 */
+	rte_atomic32_t *flow_seqn;
 	/* Memory allocation name */
 	char mem_name[ETH_RX_ADAPTER_MEM_NAME_LEN];
 	/* Socket identifier cached from eventdev */
 	int socket_id;
-	/* Per adapter EAL service */
-	uint32_t service_id;
 	/* Adapter started flag */
 	uint8_t rxa_started;
 	/* Adapter ID */
@@ -200,6 +279,10 @@ struct eth_rx_queue_info {
 	uint16_t wt;		/* Polling weight */
 	uint32_t flow_id_mask;	/* Set to ~0 if app provides flow id else 0 */
 	uint64_t event;
+	int ena_vector;		/* True if mbufs are aggregated in vectors */
+	int ena_seqn;		/* True if mbufs are numbered per flow */
+	uint16_t shard;		/* Shard servicing the queue */
+	struct eth_rx_vector_data vector_data;
 };
 
 static struct rte_event_eth_rx_adapter **event_eth_rx_adapter;
@@ -217,12 +300,6 @@ rxa_validate_id(uint8_t id)
 	} \
 } while (0)
 
-static inline int
-rxa_sw_adapter_queue_count(struct rte_event_eth_rx_adapter *rx_adapter)
-{
-	return rx_adapter->num_rx_polled + rx_adapter->num_rx_intr;
-}
-
 /* Greatest common divisor */
 static uint16_t rxa_gcd_u16(uint16_t a, uint16_t b)
 {
@@ -493,7 +570,7 @@ rxa_alloc_poll(struct rte_event_eth_rx_adapter *rx_adapter,
 {
 	size_t len;
 
-	len  = RTE_ALIGN(num_rx_polled * sizeof(*rx_adapter->eth_rx_poll),
+	len  = RTE_ALIGN(num_rx_polled * sizeof(struct eth_rx_poll_entry),
 							RTE_CACHE_LINE_SIZE);
 	return  rte_zmalloc_socket(rx_adapter->mem_name,
 				len,
@@ -509,7 +586,7 @@ rxa_alloc_wrr(struct rte_event_eth_rx_adapter *rx_adapter, int nb_wrr)
 {
 	size_t len;
 
-	len = RTE_ALIGN(nb_wrr * sizeof(*rx_adapter->wrr_sched),
+	len = RTE_ALIGN(nb_wrr * sizeof(uint32_t),
 			RTE_CACHE_LINE_SIZE);
 	return  rte_zmalloc_socket(rx_adapter->mem_name,
 				len,
@@ -545,9 +622,53 @@ rxa_alloc_poll_arrays(struct rte_event_eth_rx_adapter *rx_adapter,
 	return 0;
 }
 
-/* Precalculate WRR polling sequence for all queues in rx_adapter */
+/* Free the poll arrays allocated for the next queue add/del */
+static void
+rxa_free_next_poll_arrays(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rxa_shard *shard;
+	uint16_t i;
+
+	for (i = 0; i < rx_adapter->nb_shards; i++) {
+		shard = &rx_adapter->shards[i];
+		rte_free(shard->next_rx_poll);
+		rte_free(shard->next_wrr_sched);
+		shard->next_rx_poll = NULL;
+		shard->next_wrr_sched = NULL;
+	}
+}
+
+/* Allocate the poll arrays of every shard for the next queue add/del, a
+ * shard can end up polling all the queues of the adapter so the arrays are
+ * sized for the adapter totals
+ */
+static int
+rxa_alloc_next_poll_arrays(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint32_t nb_poll,
+		uint32_t nb_wrr)
+{
+	struct rxa_shard *shard;
+	uint16_t i;
+	int ret;
+
+	for (i = 0; i < rx_adapter->nb_shards; i++) {
+		shard = &rx_adapter->shards[i];
+		ret = rxa_alloc_poll_arrays(rx_adapter, nb_poll, nb_wrr,
+					&shard->next_rx_poll,
+					&shard->next_wrr_sched);
+		if (ret) {
+			rxa_free_next_poll_arrays(rx_adapter);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/* Precalculate WRR polling sequence for the queues polled by a shard */
 static void
 rxa_calc_wrr_sequence(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct rxa_shard *shard,
 		struct eth_rx_poll_entry *rx_poll,
 		uint32_t *rx_wrr)
 {
@@ -563,6 +684,8 @@ rxa_calc_wrr_sequence(struct rte_event_eth_rx_adapter *rx_adapter,
 	uint16_t max_wt = 0;
 	uint16_t gcd = 0;
 
+	shard->num_rx_polled = 0;
+	shard->wrr_len = 0;
 	if (rx_poll == NULL)
 		return;
 
@@ -578,13 +701,13 @@ rxa_calc_wrr_sequence(struct rte_event_eth_rx_adapter *rx_adapter,
 			continue;
 		if (dev_info->internal_event_port)
 			continue;
-		dev_info->wrr_len = 0;
 		for (q = 0; q < nb_rx_queues; q++) {
 			struct eth_rx_queue_info *queue_info =
 				&dev_info->rx_queue[q];
 			uint16_t wt;
 
-			if (!rxa_polled_queue(dev_info, q))
+			if (!rxa_polled_queue(dev_info, q) ||
+					queue_info->shard != shard->id)
 				continue;
 			wt = queue_info->wt;
 			rx_poll[poll_q].eth_dev_id = d;
@@ -605,6 +728,95 @@ rxa_calc_wrr_sequence(struct rte_event_eth_rx_adapter *rx_adapter,
 				     rx_poll, max_wt, gcd, prev);
 		prev = rx_wrr[i];
 	}
+
+	shard->num_rx_polled = poll_q;
+	shard->wrr_len = max_wrr_pos;
+}
+
+/* Install the poll arrays allocated by rxa_alloc_next_poll_arrays() after
+ * the Rx queues of the adapter have been updated, the caller holds the
+ * locks of all the shards
+ */
+static void
+rxa_install_poll_arrays(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint32_t nb_wrr)
+{
+	struct rxa_shard *shard;
+	uint16_t d;
+	uint16_t i;
+
+	RTE_ETH_FOREACH_DEV(d)
+		rx_adapter->eth_devices[d].wrr_len = 0;
+
+	for (i = 0; i < rx_adapter->nb_shards; i++) {
+		shard = &rx_adapter->shards[i];
+		rxa_calc_wrr_sequence(rx_adapter, shard, shard->next_rx_poll,
+				shard->next_wrr_sched);
+
+		rte_free(shard->eth_rx_poll);
+		rte_free(shard->wrr_sched);
+		if (shard->num_rx_polled == 0) {
+			rte_free(shard->next_rx_poll);
+			rte_free(shard->next_wrr_sched);
+			shard->next_rx_poll = NULL;
+			shard->next_wrr_sched = NULL;
+		}
+		shard->eth_rx_poll = shard->next_rx_poll;
+		shard->wrr_sched = shard->next_wrr_sched;
+		shard->wrr_pos = 0;
+		shard->next_rx_poll = NULL;
+		shard->next_wrr_sched = NULL;
+	}
+
+	rx_adapter->wrr_len = nb_wrr;
+}
+
+/* Return the shard with the lowest sum of polling weights */
+static uint16_t
+rxa_least_loaded_shard(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	uint32_t load, min_load = UINT32_MAX;
+	uint16_t shard_id = 0;
+	uint16_t d, q, i;
+
+	for (i = 0; i < rx_adapter->nb_shards; i++) {
+		load = 0;
+		RTE_ETH_FOREACH_DEV(d) {
+			struct eth_device_info *dev_info =
+					&rx_adapter->eth_devices[d];
+
+			if (dev_info->rx_queue == NULL)
+				continue;
+			for (q = 0; q < dev_info->dev->data->nb_rx_queues; q++)
+				if (rxa_polled_queue(dev_info, q) &&
+					dev_info->rx_queue[q].shard == i)
+					load += dev_info->rx_queue[q].wt;
+		}
+		if (load < min_load) {
+			min_load = load;
+			shard_id = i;
+		}
+	}
+
+	return shard_id;
+}
+
+static void
+rxa_lock_shards(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	uint16_t i;
+
+	for (i = 0; i < rx_adapter->nb_shards; i++)
+		rte_spinlock_lock(&rx_adapter->shards[i].rx_lock);
+}
+
+static void
+rxa_unlock_shards(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	uint16_t i;
+
+	for (i = rx_adapter->nb_shards; i > 0; i--)
+		rte_spinlock_unlock(&rx_adapter->shards[i - 1].rx_lock);
 }
 
 static inline void
@@ -676,53 +888,54 @@ rxa_do_softrss(struct rte_mbuf *m, const uint8_t *rss_key_be)
 }
 
 static inline int
-rxa_enq_blocked(struct rte_event_eth_rx_adapter *rx_adapter)
+rxa_enq_blocked(struct rxa_shard *shard)
 {
-	return !!rx_adapter->enq_block_count;
+	return !!shard->enq_block_count;
 }
 
 static inline void
-rxa_enq_block_start_ts(struct rte_event_eth_rx_adapter *rx_adapter)
+rxa_enq_block_start_ts(struct rxa_shard *shard)
 {
-	if (rx_adapter->rx_enq_block_start_ts)
+	if (shard->rx_enq_block_start_ts)
 		return;
 
-	rx_adapter->enq_block_count++;
-	if (rx_adapter->enq_block_count < BLOCK_CNT_THRESHOLD)
+	shard->enq_block_count++;
+	if (shard->enq_block_count < BLOCK_CNT_THRESHOLD)
 		return;
 
-	rx_adapter->rx_enq_block_start_ts = rte_get_tsc_cycles();
+	shard->rx_enq_block_start_ts = rte_get_tsc_cycles();
 }
 
 static inline void
-rxa_enq_block_end_ts(struct rte_event_eth_rx_adapter *rx_adapter,
+rxa_enq_block_end_ts(struct rxa_shard *shard,
 		    struct rte_event_eth_rx_adapter_stats *stats)
 {
 	if (unlikely(!stats->rx_enq_start_ts))
 		stats->rx_enq_start_ts = rte_get_tsc_cycles();
 
-	if (likely(!rxa_enq_blocked(rx_adapter)))
+	if (likely(!rxa_enq_blocked(shard)))
 		return;
 
-	rx_adapter->enq_block_count = 0;
-	if (rx_adapter->rx_enq_block_start_ts) {
+	shard->enq_block_count = 0;
+	if (shard->rx_enq_block_start_ts) {
 		stats->rx_enq_end_ts = rte_get_tsc_cycles();
 		stats->rx_enq_block_cycles += stats->rx_enq_end_ts -
-		    rx_adapter->rx_enq_block_start_ts;
-		rx_adapter->rx_enq_block_start_ts = 0;
+		    shard->rx_enq_block_start_ts;
+		shard->rx_enq_block_start_ts = 0;
 	}
 }
 
 /* Enqueue buffered events to event device */
 static inline uint16_t
-rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
+rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct rxa_shard *shard)
 {
 	struct rte_eth_event_enqueue_buffer *buf =
-	    &rx_adapter->event_enqueue_buffer;
-	struct rte_event_eth_rx_adapter_stats *stats = &rx_adapter->stats;
+	    &shard->event_enqueue_buffer;
+	struct rte_event_eth_rx_adapter_stats *stats = &shard->stats;
 
 	uint16_t n = rte_event_enqueue_new_burst(rx_adapter->eventdev_id,
-					rx_adapter->event_port_id,
+					shard->event_port_id,
 					buf->events,
 					buf->count);
 	if (n != buf->count) {
@@ -732,8 +945,8 @@ rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
 		stats->rx_enq_retry++;
 	}
 
-	n ? rxa_enq_block_end_ts(rx_adapter, stats) :
-		rxa_enq_block_start_ts(rx_adapter);
+	n ? rxa_enq_block_end_ts(shard, stats) :
+		rxa_enq_block_start_ts(shard);
 
 	buf->count -= n;
 	stats->rx_enq_count += n;
@@ -741,8 +954,138 @@ rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rx_adapter)
 	return n;
 }
 
+static inline void
+rxa_init_vector(struct rxa_shard *shard,
+		struct eth_rx_vector_data *vec)
+{
+	vec->vector_ev->nb_elem = 0;
+	vec->vector_ev->port = vec->port;
+	vec->vector_ev->queue = vec->queue;
+	vec->vector_ev->attr_valid = 1;
+	vec->ts = rte_get_tsc_cycles();
+	TAILQ_INSERT_TAIL(&shard->vector_list, vec, next);
+}
+
+/* Move the vector of the Rx queue to the event at ev */
+static inline void
+rxa_vector_ready(struct rxa_shard *shard,
+		struct eth_rx_vector_data *vec,
+		struct rte_event *ev)
+{
+	ev->event = vec->event;
+	ev->vec = vec->vector_ev;
+	vec->vector_ev = NULL;
+	TAILQ_REMOVE(&shard->vector_list, vec, next);
+}
+
+/* Add mbufs to the vector of the Rx queue, the vectors filled up are
+ * appended to the event buffer, returns the number of events appended
+ */
+static inline uint16_t
+rxa_create_event_vector(struct rxa_shard *shard,
+			struct eth_rx_queue_info *queue_info,
+			struct rte_eth_event_enqueue_buffer *buf,
+			struct rte_mbuf **mbufs, uint16_t num)
+{
+	struct rte_event *ev = &buf->events[buf->count];
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	uint16_t filled = 0;
+	uint16_t space, sz, i;
+
+	while (num) {
+		if (vec->vector_ev == NULL) {
+			if (unlikely(rte_mempool_get(vec->vector_pool,
+					(void **)&vec->vector_ev) < 0)) {
+				vec->vector_ev = NULL;
+				for (i = 0; i < num; i++)
+					rte_pktmbuf_free(mbufs[i]);
+				shard->stats.rx_dropped += num;
+				break;
+			}
+			rxa_init_vector(shard, vec);
+		}
+
+		space = vec->max_vector_count - vec->vector_ev->nb_elem;
+		sz = RTE_MIN(num, space);
+		memcpy(&vec->vector_ev->mbufs[vec->vector_ev->nb_elem], mbufs,
+		       sizeof(void *) * sz);
+		vec->vector_ev->nb_elem += sz;
+		num -= sz;
+		mbufs += sz;
+
+		if (vec->vector_ev->nb_elem == vec->max_vector_count) {
+			rxa_vector_ready(shard, vec, ev);
+			ev++;
+			filled++;
+		}
+	}
+
+	return filled;
+}
+
+/* Enqueue the partial vectors older than their Rx queue timeout */
+static inline void
+rxa_vector_expire(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct rxa_shard *shard)
+{
+	struct rte_eth_event_enqueue_buffer *buf =
+					&shard->event_enqueue_buffer;
+	struct eth_rx_vector_data *vec, *next_vec;
+	uint64_t now = rte_get_tsc_cycles();
+
+	if (now - shard->prev_expiry_ts < shard->vector_tmo_ticks)
+		return;
+
+	TAILQ_FOREACH_SAFE(vec, &shard->vector_list, next, next_vec) {
+		/* the list is in creation order */
+		if (now - vec->ts < vec->vector_timeout_ticks)
+			continue;
+		if (buf->count == ETH_EVENT_BUFFER_SIZE &&
+				rxa_flush_event_buffer(rx_adapter, shard) == 0)
+			break;
+		rxa_vector_ready(shard, vec, &buf->events[buf->count]);
+		buf->count++;
+	}
+
+	if (buf->count > 0)
+		rxa_flush_event_buffer(rx_adapter, shard);
+
+	shard->prev_expiry_ts = now;
+}
+
+/* Release the mbufs held by the partial vector of the Rx queue */
+static void
+rxa_vector_free(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct eth_rx_queue_info *queue_info)
+{
+	struct eth_rx_vector_data *vec = &queue_info->vector_data;
+	uint16_t i;
+
+	if (!queue_info->ena_vector || vec->vector_ev == NULL)
+		return;
+
+	for (i = 0; i < vec->vector_ev->nb_elem; i++)
+		rte_pktmbuf_free(vec->vector_ev->mbufs[i]);
+	rte_mempool_put(vec->vector_pool, vec->vector_ev);
+	vec->vector_ev = NULL;
+	TAILQ_REMOVE(&rx_adapter->shards[queue_info->shard].vector_list, vec,
+		     next);
+}
+
+/* Shards polling different Rx queues may receive the same flow, e.g., when
+ * the application provides the flow identifier, the sequence numbers are
+ * therefore allocated atomically
+ */
+static inline uint32_t
+rxa_flow_seqn_next(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint32_t flow_id)
+{
+	return rte_atomic32_add_return(&rx_adapter->flow_seqn[flow_id], 1) - 1;
+}
+
 static inline void
 rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct rxa_shard *shard,
 		uint16_t eth_dev_id,
 		uint16_t rx_queue_id,
 		struct rte_mbuf **mbufs,
@@ -754,7 +1097,7 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 	struct eth_rx_queue_info *eth_rx_queue_info =
 					&dev_info->rx_queue[rx_queue_id];
 	struct rte_eth_event_enqueue_buffer *buf =
-					&rx_adapter->event_enqueue_buffer;
+					&shard->event_enqueue_buffer;
 	struct rte_event *ev = &buf->events[buf->count];
 	uint64_t event = eth_rx_queue_info->event;
 	uint32_t flow_id_mask = eth_rx_queue_info->flow_id_mask;
@@ -780,20 +1123,30 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 		}
 	}
 
-	for (i = 0; i < num; i++) {
-		m = mbufs[i];
+	if (eth_rx_queue_info->ena_vector) {
+		num = rxa_create_event_vector(shard, eth_rx_queue_info,
+					      buf, mbufs, num);
+	} else {
+		for (i = 0; i < num; i++) {
+			m = mbufs[i];
 
-		rss = do_rss ?
-			rxa_do_softrss(m, rx_adapter->rss_key_be) :
-			m->hash.rss;
-		ev->event = event;
-		ev->flow_id = (rss & ~flow_id_mask) |
-				(ev->flow_id & flow_id_mask);
-		ev->mbuf = m;
-		ev++;
+			rss = do_rss ?
+				rxa_do_softrss(m, rx_adapter->rss_key_be) :
+				m->hash.rss;
+			ev->event = event;
+			ev->flow_id = (rss & ~flow_id_mask) |
+					(ev->flow_id & flow_id_mask);
+			ev->mbuf = m;
+			if (eth_rx_queue_info->ena_seqn)
+				m->seqn = rxa_flow_seqn_next(rx_adapter,
+							     ev->flow_id);
+			ev++;
+		}
+		ev = &buf->events[buf->count];
 	}
 
-	if (dev_info->cb_fn) {
+	/* The callback selects single mbuf events, vectors bypass it */
+	if (num && dev_info->cb_fn && !eth_rx_queue_info->ena_vector) {
 
 		dropped = 0;
 		nb_cb = dev_info->cb_fn(eth_dev_id, rx_queue_id,
@@ -805,7 +1158,7 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 		else
 			num = nb_cb;
 		if (dropped)
-			rx_adapter->stats.rx_dropped += dropped;
+			shard->stats.rx_dropped += dropped;
 	}
 
 	buf->count += num;
@@ -814,6 +1167,7 @@ rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rx_adapter,
 /* Enqueue packets from  <port, q>  to event buffer */
 static inline uint32_t
 rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
+	struct rxa_shard *shard,
 	uint16_t port_id,
 	uint16_t queue_id,
 	uint32_t rx_count,
@@ -822,9 +1176,9 @@ rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 {
 	struct rte_mbuf *mbufs[BATCH_SIZE];
 	struct rte_eth_event_enqueue_buffer *buf =
-					&rx_adapter->event_enqueue_buffer;
+					&shard->event_enqueue_buffer;
 	struct rte_event_eth_rx_adapter_stats *stats =
-					&rx_adapter->stats;
+					&shard->stats;
 	uint16_t n;
 	uint32_t nb_rx = 0;
 
@@ -835,7 +1189,7 @@ rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 	 */
 	while (BATCH_SIZE <= (RTE_DIM(buf->events) - buf->count)) {
 		if (buf->count >= BATCH_SIZE)
-			rxa_flush_event_buffer(rx_adapter);
+			rxa_flush_event_buffer(rx_adapter, shard);
 
 		stats->rx_poll_count++;
 		n = rte_eth_rx_burst(port_id, queue_id, mbufs, BATCH_SIZE);
@@ -844,14 +1198,15 @@ rxa_eth_rx(struct rte_event_eth_rx_adapter *rx_adapter,
 				*rxq_empty = 1;
 			break;
 		}
-		rxa_buffer_mbufs(rx_adapter, port_id, queue_id, mbufs, n);
+		rxa_buffer_mbufs(rx_adapter, shard, port_id, queue_id, mbufs,
+				n);
 		nb_rx += n;
 		if (rx_count + nb_rx > max_rx)
 			break;
 	}
 
 	if (buf->count > 0)
-		rxa_flush_event_buffer(rx_adapter);
+		rxa_flush_event_buffer(rx_adapter, shard);
 
 	return nb_rx;
 }
@@ -972,7 +1327,8 @@ rxa_intr_thread(void *arg)
  * mbufs to eventdev
  */
 static inline uint32_t
-rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
+rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter,
+		struct rxa_shard *shard)
 {
 	uint32_t n;
 	uint32_t nb_rx = 0;
@@ -988,11 +1344,11 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 		&& !rx_adapter->qd_valid)
 		return 0;
 
-	buf = &rx_adapter->event_enqueue_buffer;
+	buf = &shard->event_enqueue_buffer;
 	ring_lock = &rx_adapter->intr_ring_lock;
 
 	if (buf->count >= BATCH_SIZE)
-		rxa_flush_event_buffer(rx_adapter);
+		rxa_flush_event_buffer(rx_adapter, shard);
 
 	while (BATCH_SIZE <= (RTE_DIM(buf->events) - buf->count)) {
 		struct eth_device_info *dev_info;
@@ -1042,13 +1398,13 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 
 				if (!rxa_intr_queue(dev_info, i))
 					continue;
-				n = rxa_eth_rx(rx_adapter, port, i, nb_rx,
-					rx_adapter->max_nb_rx,
+				n = rxa_eth_rx(rx_adapter, shard, port, i,
+					nb_rx, shard->max_nb_rx,
 					&rxq_empty);
 				nb_rx += n;
 
 				enq_buffer_full = !rxq_empty && n == 0;
-				max_done = nb_rx > rx_adapter->max_nb_rx;
+				max_done = nb_rx > shard->max_nb_rx;
 
 				if (enq_buffer_full || max_done) {
 					dev_info->next_q_idx = i;
@@ -1063,18 +1419,18 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
 						RTE_MAX_RXTX_INTR_VEC_ID - 1 :
 						0;
 		} else {
-			n = rxa_eth_rx(rx_adapter, port, queue, nb_rx,
-				rx_adapter->max_nb_rx,
+			n = rxa_eth_rx(rx_adapter, shard, port, queue, nb_rx,
+				shard->max_nb_rx,
 				&rxq_empty);
 			rx_adapter->qd_valid = !rxq_empty;
 			nb_rx += n;
-			if (nb_rx > rx_adapter->max_nb_rx)
+			if (nb_rx > shard->max_nb_rx)
 				break;
 		}
 	}
 
 done:
-	rx_adapter->stats.rx_intr_packets += nb_rx;
+	shard->stats.rx_intr_packets += nb_rx;
 	return nb_rx;
 }
 
@@ -1092,7 +1448,8 @@ rxa_intr_ring_dequeue(struct rte_event_eth_rx_adapter *rx_adapter)
  * it.
  */
 static inline uint32_t
-rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
+rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter,
+	struct rxa_shard *shard)
 {
 	uint32_t num_queue;
 	uint32_t nb_rx = 0;
@@ -1100,35 +1457,35 @@ rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 	uint32_t wrr_pos;
 	uint32_t max_nb_rx;
 
-	wrr_pos = rx_adapter->wrr_pos;
-	max_nb_rx = rx_adapter->max_nb_rx;
-	buf = &rx_adapter->event_enqueue_buffer;
+	wrr_pos = shard->wrr_pos;
+	max_nb_rx = shard->max_nb_rx;
+	buf = &shard->event_enqueue_buffer;
 
 	/* Iterate through a WRR sequence */
-	for (num_queue = 0; num_queue < rx_adapter->wrr_len; num_queue++) {
-		unsigned int poll_idx = rx_adapter->wrr_sched[wrr_pos];
-		uint16_t qid = rx_adapter->eth_rx_poll[poll_idx].eth_rx_qid;
-		uint16_t d = rx_adapter->eth_rx_poll[poll_idx].eth_dev_id;
+	for (num_queue = 0; num_queue < shard->wrr_len; num_queue++) {
+		unsigned int poll_idx = shard->wrr_sched[wrr_pos];
+		uint16_t qid = shard->eth_rx_poll[poll_idx].eth_rx_qid;
+		uint16_t d = shard->eth_rx_poll[poll_idx].eth_dev_id;
 
 		/* Don't do a batch dequeue from the rx queue if there isn't
 		 * enough space in the enqueue buffer.
 		 */
 		if (buf->count >= BATCH_SIZE)
-			rxa_flush_event_buffer(rx_adapter);
+			rxa_flush_event_buffer(rx_adapter, shard);
 		if (BATCH_SIZE > (ETH_EVENT_BUFFER_SIZE - buf->count)) {
-			rx_adapter->wrr_pos = wrr_pos;
+			shard->wrr_pos = wrr_pos;
 			return nb_rx;
 		}
 
-		nb_rx += rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
-				NULL);
+		nb_rx += rxa_eth_rx(rx_adapter, shard, d, qid, nb_rx,
+				max_nb_rx, NULL);
 		if (nb_rx > max_nb_rx) {
-			rx_adapter->wrr_pos =
-				    (wrr_pos + 1) % rx_adapter->wrr_len;
+			shard->wrr_pos =
+				    (wrr_pos + 1) % shard->wrr_len;
 			break;
 		}
 
-		if (++wrr_pos == rx_adapter->wrr_len)
+		if (++wrr_pos == shard->wrr_len)
 			wrr_pos = 0;
 	}
 	return nb_rx;
@@ -1137,20 +1494,24 @@ rxa_poll(struct rte_event_eth_rx_adapter *rx_adapter)
 static int
 rxa_service_func(void *args)
 {
-	struct rte_event_eth_rx_adapter *rx_adapter = args;
+	struct rxa_shard *shard = args;
+	struct rte_event_eth_rx_adapter *rx_adapter = shard->rx_adapter;
 	struct rte_event_eth_rx_adapter_stats *stats;
 
-	if (rte_spinlock_trylock(&rx_adapter->rx_lock) == 0)
+	if (rte_spinlock_trylock(&shard->rx_lock) == 0)
 		return 0;
 	if (!rx_adapter->rxa_started) {
-		rte_spinlock_unlock(&rx_adapter->rx_lock);
+		rte_spinlock_unlock(&shard->rx_lock);
 		return 0;
 	}
 
-	stats = &rx_adapter->stats;
-	stats->rx_packets += rxa_intr_ring_dequeue(rx_adapter);
-	stats->rx_packets += rxa_poll(rx_adapter);
-	rte_spinlock_unlock(&rx_adapter->rx_lock);
+	stats = &shard->stats;
+	if (shard->id == 0)
+		stats->rx_packets += rxa_intr_ring_dequeue(rx_adapter, shard);
+	stats->rx_packets += rxa_poll(rx_adapter, shard);
+	if (shard->ena_vector)
+		rxa_vector_expire(rx_adapter, shard);
+	rte_spinlock_unlock(&shard->rx_lock);
 	return 0;
 }
 
@@ -1583,43 +1944,76 @@ rxa_init_service(struct rte_event_eth_rx_adapter *rx_adapter, uint8_t id)
 	int ret;
 	struct rte_service_spec service;
 	struct rte_event_eth_rx_adapter_conf rx_adapter_conf;
+	struct rxa_shard *shard;
+	uint16_t i;
 
 	if (rx_adapter->service_inited)
 		return 0;
 
-	memset(&service, 0, sizeof(service));
-	snprintf(service.name, ETH_RX_ADAPTER_SERVICE_NAME_LEN,
-		"rte_event_eth_rx_adapter_%d", id);
-	service.socket_id = rx_adapter->socket_id;
-	service.callback = rxa_service_func;
-	service.callback_userdata = rx_adapter;
-	/* Service function handles locking for queue add/del updates */
-	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
-	ret = rte_service_component_register(&service, &rx_adapter->service_id);
-	if (ret) {
-		RTE_EDEV_LOG_ERR("failed to register service %s err = %" PRId32,
-			service.name, ret);
-		return ret;
-	}
+	for (i = 0; i < rx_adapter->nb_shards; i++) {
+		shard = &rx_adapter->shards[i];
 
-	ret = rx_adapter->conf_cb(id, rx_adapter->eventdev_id,
-		&rx_adapter_conf, rx_adapter->conf_arg);
-	if (ret) {
-		RTE_EDEV_LOG_ERR("configuration callback failed err = %" PRId32,
-			ret);
-		goto err_done;
+		memset(&service, 0, sizeof(service));
+		/* shard 0 keeps the service name of an adapter without
+		 * shards
+		 */
+		if (i == 0)
+			snprintf(service.name, ETH_RX_ADAPTER_SERVICE_NAME_LEN,
+				"rte_event_eth_rx_adapter_%d", id);
+		else
+			snprintf(service.name, ETH_RX_ADAPTER_SERVICE_NAME_LEN,
+				"rte_event_eth_rx_adapter_%d_%d", id, i);
+		service.socket_id = rx_adapter->socket_id;
+		service.callback = rxa_service_func;
+		service.callback_userdata = shard;
+		/* Service function handles locking for queue add/del updates */
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+		ret = rte_service_component_register(&service,
+						&shard->service_id);
+		if (ret) {
+			RTE_EDEV_LOG_ERR("failed to register service %s err = %"
+				PRId32, service.name, ret);
+			goto err_done;
+		}
+
+		ret = rx_adapter->conf_cb(id, rx_adapter->eventdev_id,
+			&rx_adapter_conf, rx_adapter->conf_arg);
+		if (ret) {
+			RTE_EDEV_LOG_ERR("configuration callback failed err = %"
+				PRId32, ret);
+			rte_service_component_unregister(shard->service_id);
+			goto err_done;
+		}
+		shard->event_port_id = rx_adapter_conf.event_port_id;
+		shard->max_nb_rx = rx_adapter_conf.max_nb_rx;
 	}
-	rx_adapter->event_port_id = rx_adapter_conf.event_port_id;
-	rx_adapter->max_nb_rx = rx_adapter_conf.max_nb_rx;
+
 	rx_adapter->service_inited = 1;
 	rx_adapter->epd = INIT_FD;
 	return 0;
 
 err_done:
-	rte_service_component_unregister(rx_adapter->service_id);
+	while (i-- > 0)
+		rte_service_component_unregister(
+					rx_adapter->shards[i].service_id);
 	return ret;
 }
 
+/* Run the service functions of the shards that have Rx queues to service */
+static void
+rxa_shards_runstate_set(struct rte_event_eth_rx_adapter *rx_adapter)
+{
+	struct rxa_shard *shard;
+	uint16_t i;
+
+	for (i = 0; i < rx_adapter->nb_shards; i++) {
+		shard = &rx_adapter->shards[i];
+		rte_service_component_runstate_set(shard->service_id,
+			shard->num_rx_polled ||
+			(i == 0 && rx_adapter->num_rx_intr));
+	}
+}
+
 static void
 rxa_update_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 		struct eth_device_info *dev_info,
@@ -1676,6 +2070,9 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	pollq = rxa_polled_queue(dev_info, rx_queue_id);
 	intrq = rxa_intr_queue(dev_info, rx_queue_id);
 	sintrq = rxa_shared_intr(dev_info, rx_queue_id);
+	rxa_vector_free(rx_adapter, &dev_info->rx_queue[rx_queue_id]);
+	dev_info->rx_queue[rx_queue_id].ena_vector = 0;
+	dev_info->rx_queue[rx_queue_id].ena_seqn = 0;
 	rxa_update_queue(rx_adapter, dev_info, rx_queue_id, 0);
 	rx_adapter->num_rx_polled -= pollq;
 	dev_info->nb_rx_poll -= pollq;
@@ -1684,6 +2081,41 @@ rxa_sw_del(struct rte_event_eth_rx_adapter *rx_adapter,
 	dev_info->nb_shared_intr -= intrq && sintrq;
 }
 
+static void
+rxa_set_vector_data(struct rxa_shard *shard,
+		struct eth_rx_queue_info *queue_info,
+		uint16_t port_id,
+		uint16_t qid,
+		const struct rte_event_eth_rx_adapter_queue_conf *conf)
+{
+	struct eth_rx_vector_data *vector_data = &queue_info->vector_data;
+	struct rte_event *vec_ev = (struct rte_event *)&vector_data->event;
+
+	vector_data->max_vector_count = conf->vector_sz;
+	vector_data->port = port_id;
+	vector_data->queue = qid;
+	vector_data->vector_pool = conf->vector_mp;
+	vector_data->vector_timeout_ticks =
+		RXA_NSEC2TICK(conf->vector_timeout_ns, rte_get_tsc_hz());
+	vector_data->ts = 0;
+
+	/* all the mbufs of a vector share the flow ID of the vector, derive
+	 * one from the port and queue unless the application provides it
+	 */
+	vec_ev->event = queue_info->event;
+	vec_ev->event_type = RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR;
+	if (!queue_info->flow_id_mask)
+		vec_ev->flow_id = (qid & 0xFFF) | (port_id & 0xFF) << 12;
+
+	/* check the vector list at least twice per vector timeout */
+	if (shard->vector_tmo_ticks == 0 ||
+			(vector_data->vector_timeout_ticks >> 1) <
+			shard->vector_tmo_ticks)
+		shard->vector_tmo_ticks =
+			vector_data->vector_timeout_ticks >> 1;
+	shard->ena_vector = 1;
+}
+
 static void
 rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	struct eth_device_info *dev_info,
@@ -1712,6 +2144,23 @@ rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	sintrq = rxa_shared_intr(dev_info, rx_queue_id);
 
 	queue_info = &dev_info->rx_queue[rx_queue_id];
+
+	/* mbufs of a partial vector built with the previous configuration
+	 * of the queue are dropped
+	 */
+	rxa_vector_free(rx_adapter, queue_info);
+
+	/* interrupt driven queues are serviced by shard 0, a polled queue
+	 * stays on its shard unless the application selects another one
+	 */
+	if (conf->servicing_weight == 0)
+		queue_info->shard = 0;
+	else if (conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID)
+		queue_info->shard = conf->shard_id;
+	else if (!pollq)
+		queue_info->shard = rxa_least_loaded_shard(rx_adapter);
+
 	queue_info->wt = conf->servicing_weight;
 
 	qi_ev = (struct rte_event *)&queue_info->event;
@@ -1726,6 +2175,16 @@ rxa_add_queue(struct rte_event_eth_rx_adapter *rx_adapter,
 	} else
 		qi_ev->flow_id = 0;
 
+	queue_info->ena_seqn = !!(conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN);
+	queue_info->ena_vector = !!(conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR);
+	if (queue_info->ena_vector)
+		rxa_set_vector_data(&rx_adapter->shards[queue_info->shard],
+				queue_info,
+				dev_info->dev->data->port_id, rx_queue_id,
+				conf);
+
 	rxa_update_queue(rx_adapter, dev_info, rx_queue_id, 1);
 	if (rxa_polled_queue(dev_info, rx_queue_id)) {
 		rx_adapter->num_rx_polled += !pollq;
@@ -1759,9 +2218,7 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 	struct eth_device_info *dev_info = &rx_adapter->eth_devices[eth_dev_id];
 	struct rte_event_eth_rx_adapter_queue_conf temp_conf;
 	int ret;
-	struct eth_rx_poll_entry *rx_poll;
 	struct eth_rx_queue_info *rx_queue;
-	uint32_t *rx_wrr;
 	uint16_t nb_rx_queues;
 	uint32_t nb_rx_poll, nb_wrr;
 	uint32_t nb_rx_intr;
@@ -1792,9 +2249,6 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 		if (dev_info->rx_queue == NULL)
 			return -ENOMEM;
 	}
-	rx_wrr = NULL;
-	rx_poll = NULL;
-
 	rxa_calc_nb_post_add(rx_adapter, dev_info, rx_queue_id,
 			queue_conf->servicing_weight,
 			&nb_rx_poll, &nb_rx_intr, &nb_wrr);
@@ -1803,8 +2257,7 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 		dev_info->multi_intr_cap =
 			rte_intr_cap_multiple(dev_info->dev->intr_handle);
 
-	ret = rxa_alloc_poll_arrays(rx_adapter, nb_rx_poll, nb_wrr,
-				&rx_poll, &rx_wrr);
+	ret = rxa_alloc_next_poll_arrays(rx_adapter, nb_rx_poll, nb_wrr);
 	if (ret)
 		goto err_free_rxqueue;
 
@@ -1857,14 +2310,7 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 
 
 	rxa_add_queue(rx_adapter, dev_info, rx_queue_id, queue_conf);
-	rxa_calc_wrr_sequence(rx_adapter, rx_poll, rx_wrr);
-
-	rte_free(rx_adapter->eth_rx_poll);
-	rte_free(rx_adapter->wrr_sched);
-
-	rx_adapter->eth_rx_poll = rx_poll;
-	rx_adapter->wrr_sched = rx_wrr;
-	rx_adapter->wrr_len = nb_wrr;
+	rxa_install_poll_arrays(rx_adapter, nb_wrr);
 	rx_adapter->num_intr_vec += num_intr_vec;
 	return 0;
 
@@ -1874,8 +2320,7 @@ static int rxa_sw_add(struct rte_event_eth_rx_adapter *rx_adapter,
 		dev_info->rx_queue = NULL;
 	}
 
-	rte_free(rx_poll);
-	rte_free(rx_wrr);
+	rxa_free_next_poll_arrays(rx_adapter);
 
 	return 0;
 }
@@ -1916,12 +2361,44 @@ rxa_ctrl(uint8_t id, int start)
 	}
 
 	if (use_service) {
-		rte_spinlock_lock(&rx_adapter->rx_lock);
+		rxa_lock_shards(rx_adapter);
 		rx_adapter->rxa_started = start;
-		rte_service_runstate_set(rx_adapter->service_id, start);
-		rte_spinlock_unlock(&rx_adapter->rx_lock);
+		for (i = 0; i < rx_adapter->nb_shards; i++)
+			rte_service_runstate_set(
+				rx_adapter->shards[i].service_id, start);
+		rxa_unlock_shards(rx_adapter);
+	}
+
+	return 0;
+}
+
+/* Allocate and initialize the shards of the adapter, replacing the
+ * current ones
+ */
+static int
+rxa_alloc_shards(struct rte_event_eth_rx_adapter *rx_adapter,
+		uint16_t nb_shards)
+{
+	struct rxa_shard *shards;
+	uint16_t i;
+
+	shards = rte_zmalloc_socket(rx_adapter->mem_name,
+				nb_shards * sizeof(*shards),
+				RTE_CACHE_LINE_SIZE,
+				rx_adapter->socket_id);
+	if (shards == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < nb_shards; i++) {
+		rte_spinlock_init(&shards[i].rx_lock);
+		TAILQ_INIT(&shards[i].vector_list);
+		shards[i].id = i;
+		shards[i].rx_adapter = rx_adapter;
 	}
 
+	rte_free(rx_adapter->shards);
+	rx_adapter->shards = shards;
+	rx_adapter->nb_shards = nb_shards;
 	return 0;
 }
 
@@ -1991,7 +2468,14 @@ rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
 		rte_free(rx_adapter);
 		return -ENOMEM;
 	}
-	rte_spinlock_init(&rx_adapter->rx_lock);
+
+	ret = rxa_alloc_shards(rx_adapter, 1);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("failed to get mem for shards\n");
+		rte_free(rx_adapter->eth_devices);
+		rte_free(rx_adapter);
+		return ret;
+	}
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
 		rx_adapter->eth_devices[i].dev = &rte_eth_devices[i];
 
@@ -2043,6 +2527,8 @@ rte_event_eth_rx_adapter_free(uint8_t id)
 
 	if (rx_adapter->default_cb_arg)
 		rte_free(rx_adapter->conf_arg);
+	rte_free(rx_adapter->shards);
+	rte_free(rx_adapter->flow_seqn);
 	rte_free(rx_adapter->eth_devices);
 	rte_free(rx_adapter);
 	event_eth_rx_adapter[id] = NULL;
@@ -2050,6 +2536,40 @@ rte_event_eth_rx_adapter_free(uint8_t id)
 	return 0;
 }
 
+static int
+rxa_check_vector_conf(uint8_t dev_id, uint16_t eth_dev_id, uint32_t cap,
+		const struct rte_event_eth_rx_adapter_queue_conf *queue_conf)
+{
+	struct rte_event_eth_rx_adapter_vector_limits limits;
+	int ret;
+
+	if ((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR) == 0)
+		return -ENOTSUP;
+
+	ret = rte_event_eth_rx_adapter_vector_limits_get(dev_id, eth_dev_id,
+							 &limits);
+	if (ret)
+		return ret;
+
+	if (queue_conf->vector_sz < limits.min_sz ||
+			queue_conf->vector_sz > limits.max_sz ||
+			(limits.log2_sz &&
+			 !rte_is_power_of_2(queue_conf->vector_sz)))
+		return -EINVAL;
+
+	if (queue_conf->vector_timeout_ns < limits.min_timeout_ns ||
+			queue_conf->vector_timeout_ns > limits.max_timeout_ns)
+		return -EINVAL;
+
+	if (queue_conf->vector_mp == NULL ||
+			queue_conf->vector_mp->elt_size <
+			sizeof(struct rte_event_vector) +
+			sizeof(uintptr_t) * queue_conf->vector_sz)
+		return -EINVAL;
+
+	return 0;
+}
+
 int
 rte_event_eth_rx_adapter_queue_add(uint8_t id,
 		uint16_t eth_dev_id,
@@ -2096,6 +2616,40 @@ rte_event_eth_rx_adapter_queue_add(uint8_t id,
 		return -EINVAL;
 	}
 
+	if ((queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID) &&
+		((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT) ||
+		queue_conf->shard_id >= rx_adapter->nb_shards)) {
+		RTE_EDEV_LOG_ERR("Invalid shard %" PRIu16 ","
+				" eth port: %" PRIu16 " adapter id: %" PRIu8,
+				queue_conf->shard_id, eth_dev_id, id);
+		return -EINVAL;
+	}
+
+	if ((queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN) &&
+		((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT) ||
+		(queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR))) {
+		RTE_EDEV_LOG_ERR("Sequence numbers are not supported,"
+				" eth port: %" PRIu16 " adapter id: %" PRIu8,
+				eth_dev_id, id);
+		return -EINVAL;
+	}
+
+	if (queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR) {
+		ret = rxa_check_vector_conf(rx_adapter->eventdev_id,
+					    eth_dev_id, cap, queue_conf);
+		if (ret) {
+			RTE_EDEV_LOG_ERR("Invalid event vector configuration,"
+					 " eth port: %" PRIu16
+					 " adapter id: %" PRIu8,
+					 eth_dev_id, id);
+			return ret;
+		}
+	}
+
 	if (rx_queue_id != -1 && (uint16_t)rx_queue_id >=
 			rte_eth_devices[eth_dev_id].data->nb_rx_queues) {
 		RTE_EDEV_LOG_ERR("Invalid rx queue_id %" PRIu16,
@@ -2129,17 +2683,27 @@ rte_event_eth_rx_adapter_queue_add(uint8_t id,
 					1);
 		}
 	} else {
-		rte_spinlock_lock(&rx_adapter->rx_lock);
+		rxa_lock_shards(rx_adapter);
 		dev_info->internal_event_port = 0;
 		ret = rxa_init_service(rx_adapter, id);
+		if (ret == 0 && rx_adapter->flow_seqn == NULL &&
+			(queue_conf->rx_queue_flags &
+				RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN)) {
+			rx_adapter->flow_seqn = rte_zmalloc_socket(
+					rx_adapter->mem_name,
+					RXA_SEQN_NB_FLOWS *
+					sizeof(rte_atomic32_t),
+					RTE_CACHE_LINE_SIZE,
+					rx_adapter->socket_id);
+			if (rx_adapter->flow_seqn == NULL)
+				ret = -ENOMEM;
+		}
 		if (ret == 0) {
-			uint32_t service_id = rx_adapter->service_id;
 			ret = rxa_sw_add(rx_adapter, eth_dev_id, rx_queue_id,
 					queue_conf);
-			rte_service_component_runstate_set(service_id,
-				rxa_sw_adapter_queue_count(rx_adapter));
+			rxa_shards_runstate_set(rx_adapter);
 		}
-		rte_spinlock_unlock(&rx_adapter->rx_lock);
+		rxa_unlock_shards(rx_adapter);
 	}
 
 	if (ret)
@@ -2160,8 +2724,6 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 	uint32_t nb_rx_poll = 0;
 	uint32_t nb_wrr = 0;
 	uint32_t nb_rx_intr;
-	struct eth_rx_poll_entry *rx_poll = NULL;
-	uint32_t *rx_wrr = NULL;
 	int num_intr_vec;
 
 	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
@@ -2207,12 +2769,12 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 		rxa_calc_nb_post_del(rx_adapter, dev_info, rx_queue_id,
 			&nb_rx_poll, &nb_rx_intr, &nb_wrr);
 
-		ret = rxa_alloc_poll_arrays(rx_adapter, nb_rx_poll, nb_wrr,
-			&rx_poll, &rx_wrr);
+		ret = rxa_alloc_next_poll_arrays(rx_adapter, nb_rx_poll,
+						nb_wrr);
 		if (ret)
 			return ret;
 
-		rte_spinlock_lock(&rx_adapter->rx_lock);
+		rxa_lock_shards(rx_adapter);
 
 		num_intr_vec = 0;
 		if (rx_adapter->num_rx_intr > nb_rx_intr) {
@@ -2232,19 +2794,13 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 		}
 
 		rxa_sw_del(rx_adapter, dev_info, rx_queue_id);
-		rxa_calc_wrr_sequence(rx_adapter, rx_poll, rx_wrr);
-
-		rte_free(rx_adapter->eth_rx_poll);
-		rte_free(rx_adapter->wrr_sched);
+		rxa_install_poll_arrays(rx_adapter, nb_wrr);
 
 		if (nb_rx_intr == 0) {
 			rte_free(dev_info->intr_queue);
 			dev_info->intr_queue = NULL;
 		}
 
-		rx_adapter->eth_rx_poll = rx_poll;
-		rx_adapter->wrr_sched = rx_wrr;
-		rx_adapter->wrr_len = nb_wrr;
 		rx_adapter->num_intr_vec += num_intr_vec;
 
 		if (dev_info->nb_dev_queues == 0) {
@@ -2252,15 +2808,13 @@ rte_event_eth_rx_adapter_queue_del(uint8_t id, uint16_t eth_dev_id,
 			dev_info->rx_queue = NULL;
 		}
 unlock_ret:
-		rte_spinlock_unlock(&rx_adapter->rx_lock);
-		if (ret) {
-			rte_free(rx_poll);
-			rte_free(rx_wrr);
+		if (ret)
+			rxa_free_next_poll_arrays(rx_adapter);
+		else
+			rxa_shards_runstate_set(rx_adapter);
+		rxa_unlock_shards(rx_adapter);
+		if (ret)
 			return ret;
-		}
-
-		rte_service_component_runstate_set(rx_adapter->service_id,
-				rxa_sw_adapter_queue_count(rx_adapter));
 	}
 
 	return ret;
@@ -2278,6 +2832,25 @@ rte_event_eth_rx_adapter_stop(uint8_t id)
 	return rxa_ctrl(id, 0);
 }
 
+/* Add the statistics of a shard to the adapter statistics */
+static void
+rxa_stats_add(struct rte_event_eth_rx_adapter_stats *stats,
+	const struct rte_event_eth_rx_adapter_stats *shard_stats)
+{
+	stats->rx_poll_count += shard_stats->rx_poll_count;
+	stats->rx_packets += shard_stats->rx_packets;
+	stats->rx_enq_count += shard_stats->rx_enq_count;
+	stats->rx_enq_retry += shard_stats->rx_enq_retry;
+	stats->rx_dropped += shard_stats->rx_dropped;
+	stats->rx_enq_block_cycles += shard_stats->rx_enq_block_cycles;
+	stats->rx_intr_packets += shard_stats->rx_intr_packets;
+	if (shard_stats->rx_enq_start_ts && (stats->rx_enq_start_ts == 0 ||
+			shard_stats->rx_enq_start_ts < stats->rx_enq_start_ts))
+		stats->rx_enq_start_ts = shard_stats->rx_enq_start_ts;
+	stats->rx_enq_end_ts = RTE_MAX(stats->rx_enq_end_ts,
+				shard_stats->rx_enq_end_ts);
+}
+
 int
 rte_event_eth_rx_adapter_stats_get(uint8_t id,
 			       struct rte_event_eth_rx_adapter_stats *stats)
@@ -2312,8 +2885,10 @@ rte_event_eth_rx_adapter_stats_get(uint8_t id,
 		dev_stats_sum.rx_enq_count += dev_stats.rx_enq_count;
 	}
 
-	if (rx_adapter->service_inited)
-		*stats = rx_adapter->stats;
+	if (rx_adapter->service_inited) {
+		for (i = 0; i < rx_adapter->nb_shards; i++)
+			rxa_stats_add(stats, &rx_adapter->shards[i].stats);
+	}
 
 	stats->rx_packets += dev_stats_sum.rx_packets;
 	stats->rx_enq_count += dev_stats_sum.rx_enq_count;
@@ -2344,7 +2919,9 @@ rte_event_eth_rx_adapter_stats_reset(uint8_t id)
 							&rte_eth_devices[i]);
 	}
 
-	memset(&rx_adapter->stats, 0, sizeof(rx_adapter->stats));
+	for (i = 0; i < rx_adapter->nb_shards; i++)
+		memset(&rx_adapter->shards[i].stats, 0,
+			sizeof(rx_adapter->shards[i].stats));
 	return 0;
 }
 
@@ -2360,7 +2937,7 @@ rte_event_eth_rx_adapter_service_id_get(uint8_t id, uint32_t *service_id)
 		return -EINVAL;
 
 	if (rx_adapter->service_inited)
-		*service_id = rx_adapter->service_id;
+		*service_id = rx_adapter->shards[0].service_id;
 
 	return rx_adapter->service_inited ? 0 : -ESRCH;
 }
@@ -2402,10 +2979,105 @@ rte_event_eth_rx_adapter_cb_register(uint8_t id,
 		return -EINVAL;
 	}
 
-	rte_spinlock_lock(&rx_adapter->rx_lock);
+	rxa_lock_shards(rx_adapter);
 	dev_info->cb_fn = cb_fn;
 	dev_info->cb_arg = cb_arg;
-	rte_spinlock_unlock(&rx_adapter->rx_lock);
+	rxa_unlock_shards(rx_adapter);
+
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_vector_limits_get(
+	uint8_t dev_id, uint16_t eth_port_id,
+	struct rte_event_eth_rx_adapter_vector_limits *limits)
+{
+	uint32_t cap;
+	int ret;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_port_id, -EINVAL);
+
+	if (limits == NULL)
+		return -EINVAL;
+
+	ret = rte_event_eth_rx_adapter_caps_get(dev_id, eth_port_id, &cap);
+	if (ret) {
+		RTE_EDEV_LOG_ERR("Failed to get adapter caps edev %" PRIu8
+				 "eth port %" PRIu16,
+				 dev_id, eth_port_id);
+		return ret;
+	}
+
+	/* vectors built by an internal port are not supported */
+	if (cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT ||
+			(cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR) == 0)
+		return -ENOTSUP;
+
+	limits->max_sz = RXA_VECTOR_MAX_SZ;
+	limits->min_sz = RXA_VECTOR_MIN_SZ;
+	limits->log2_sz = 0;
+	limits->max_timeout_ns = RXA_VECTOR_MAX_TMO_NS;
+	limits->min_timeout_ns = RXA_VECTOR_MIN_TMO_NS;
+
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_shards_set(uint8_t id, uint16_t nb_shards)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if (rx_adapter == NULL || nb_shards == 0 || nb_shards > RTE_MAX_LCORE)
+		return -EINVAL;
+
+	/* the service functions and event ports of the shards are set up
+	 * when the first SW Rx queue is added
+	 */
+	if (rx_adapter->service_inited)
+		return -EBUSY;
+
+	if (nb_shards == rx_adapter->nb_shards)
+		return 0;
+
+	return rxa_alloc_shards(rx_adapter, nb_shards);
+}
+
+int
+rte_event_eth_rx_adapter_shard_service_id_get(uint8_t id, uint16_t shard_id,
+					      uint32_t *service_id)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if (rx_adapter == NULL || service_id == NULL ||
+			shard_id >= rx_adapter->nb_shards)
+		return -EINVAL;
+
+	if (rx_adapter->service_inited)
+		*service_id = rx_adapter->shards[shard_id].service_id;
+
+	return rx_adapter->service_inited ? 0 : -ESRCH;
+}
+
+int
+rte_event_eth_rx_adapter_shard_stats_get(uint8_t id, uint16_t shard_id,
+			struct rte_event_eth_rx_adapter_stats *stats)
+{
+	struct rte_event_eth_rx_adapter *rx_adapter;
+
+	RTE_EVENT_ETH_RX_ADAPTER_ID_VALID_OR_ERR_RET(id, -EINVAL);
+
+	rx_adapter = rxa_id_to_adapter(id);
+	if (rx_adapter == NULL || stats == NULL ||
+			shard_id >= rx_adapter->nb_shards)
+		return -EINVAL;
 
+	*stats = rx_adapter->shards[shard_id].stats;
 	return 0;
 }
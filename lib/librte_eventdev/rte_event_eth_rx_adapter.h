@@ -37,6 +37,10 @@
  *  - rte_event_eth_rx_adapter_stop()
  *  - rte_event_eth_rx_adapter_stats_get()
  *  - rte_event_eth_rx_adapter_stats_reset()
+ *  - rte_event_eth_rx_adapter_vector_limits_get()
+ *  - rte_event_eth_rx_adapter_shards_set()
+ *  - rte_event_eth_rx_adapter_shard_service_id_get()
+ *  - rte_event_eth_rx_adapter_shard_stats_get()
  *
  * The application creates an ethernet to event adapter using
  * rte_event_eth_rx_adapter_create_ext() or rte_event_eth_rx_adapter_create()
@@ -77,6 +81,35 @@
  * allows the application to register a callback that selects which packets are
  * enqueued to the event device by the SW adapter. The callback interface is
  * event based so the callback can also modify the event data if it needs to.
+ * The callback is not invoked for the Rx queues with event vectorization
+ * enabled.
+ *
+ * When the RTE_EVENT_ETH_RX_ADAPTER_CAP_EVENT_VECTOR capability is set, the
+ * application can request the adapter to aggregate the mbufs received on an
+ * ethdev Rx queue into event vectors by setting the
+ * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag when adding the queue. A
+ * vector event is enqueued once it holds vector_sz mbufs, or once
+ * vector_timeout_ns has elapsed since its first mbuf was added. The vectors
+ * are allocated from vector_mp, a mempool created using
+ * rte_event_vector_pool_create(). The limits supported for the vector size
+ * and timeout can be retrieved using
+ * rte_event_eth_rx_adapter_vector_limits_get().
+ *
+ * A single service core may not be able to poll all the Rx queues added to
+ * a SW adapter at line rate. The poll set of the adapter can be split into
+ * shards using rte_event_eth_rx_adapter_shards_set(), each shard is a
+ * separate service function with its own event port, polling sequence, event
+ * buffer and statistics, so that the shards can be mapped to different
+ * service cores. A polled Rx queue is assigned to the shard with the lowest
+ * sum of servicing weights when it is added, unless the application selects
+ * the shard using the RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID flag.
+ * Interrupt driven Rx queues are always serviced by shard 0.
+ *
+ * A SW adapter can number the mbufs of each flow received on an Rx queue
+ * added with the RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN flag. The sequence
+ * number is stored in rte_mbuf::seqn and lets the event ethernet Tx adapter
+ * restore the order of the flow on transmit after the mbufs went through
+ * parallel event queues, see rte_event_eth_tx_adapter_reorder_set().
  */
 
 #ifdef __cplusplus
@@ -87,6 +120,9 @@ extern "C" {
 
 #include <rte_service.h>
 
+#include <rte_compat.h>
+#include <rte_mempool.h>
+
 #include "rte_eventdev.h"
 
 #define RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE 32
@@ -96,6 +132,20 @@ extern "C" {
 /**< This flag indicates the flow identifier is valid
  * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
  */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR	0x2
+/**< This flag indicates that mbufs arriving on the queue need to be vectorized
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID	0x4
+/**< This flag indicates the shard identifier is valid
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN	0x8
+/**< This flag indicates that mbufs arriving on the queue need to be numbered
+ * per flow in rte_mbuf::seqn, a flow being identified by the event flow
+ * identifier
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
 
 /**
  * Adapter configuration structure that the adapter configuration callback
@@ -120,7 +170,9 @@ struct rte_event_eth_rx_adapter_conf {
  * callback is invoked when creating a SW service for packet transfer from
  * ethdev queues to the event device. The SW service is created within the
  * rte_event_eth_rx_adapter_queue_add() function if SW based packet transfers
- * from ethdev queues to the event device are required.
+ * from ethdev queues to the event device are required. If the adapter is
+ * split into shards, the callback is invoked once per shard and has to
+ * return a different event port each time.
  *
  * @param id
  *  Adapter identifier.
@@ -146,6 +198,9 @@ struct rte_event_eth_rx_adapter_queue_conf {
 	uint32_t rx_queue_flags;
 	 /**< Flags for handling received packets
 	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID
+	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR
+	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID
+	  * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN
 	  */
 	uint16_t servicing_weight;
 	/**< Relative polling frequency of ethernet receive queue when the
@@ -169,7 +224,71 @@ struct rte_event_eth_rx_adapter_queue_conf {
 	 *		addresses.
 	 *
 	 * The event adapter sets ev.event_type to RTE_EVENT_TYPE_ETHDEV in the
-	 * enqueued event.
+	 * enqueued event, or to RTE_EVENT_TYPE_ETH_RX_ADAPTER_VECTOR when the
+	 * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag is set. The flow ID
+	 * of a vector event is the flow_id above if valid, otherwise it is
+	 * derived from the ethdev port and queue identifiers.
+	 */
+	uint16_t vector_sz;
+	/**<
+	 * Indicates the maximum number for mbufs to combine and form a vector.
+	 * Should be within
+	 * @see rte_event_eth_rx_adapter_vector_limits::min_sz
+	 * @see rte_event_eth_rx_adapter_vector_limits::max_sz
+	 * Valid when RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag is set in
+	 * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+	 */
+	uint64_t vector_timeout_ns;
+	/**<
+	 * Indicates the maximum number of nanoseconds to wait for receiving
+	 * mbufs. Should be within vectorization limits of the
+	 * adapter
+	 * @see rte_event_eth_rx_adapter_vector_limits::min_timeout_ns
+	 * @see rte_event_eth_rx_adapter_vector_limits::max_timeout_ns
+	 * Valid when RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag is set in
+	 * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+	 */
+	struct rte_mempool *vector_mp;
+	/**<
+	 * Indicates the mempool that should be used for allocating
+	 * rte_event_vector container.
+	 * Should be created by using `rte_event_vector_pool_create`.
+	 * Valid when RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag is set in
+	 * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags.
+	 */
+	uint16_t shard_id;
+	/**<
+	 * Shard of the SW adapter that polls the Rx queue, lower than the
+	 * number of shards set using rte_event_eth_rx_adapter_shards_set().
+	 * Valid when RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SHARD_VALID flag is set in
+	 * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags, otherwise
+	 * a polled Rx queue is assigned to the least loaded shard.
+	 */
+};
+
+/**
+ * A structure used to retrieve event Rx adapter vector limits.
+ */
+struct rte_event_eth_rx_adapter_vector_limits {
+	uint16_t min_sz;
+	/**< Minimum vector limit configurable.
+	 * @see rte_event_eth_rx_adapter_queue_conf::vector_sz
+	 */
+	uint16_t max_sz;
+	/**< Maximum vector limit configurable.
+	 * @see rte_event_eth_rx_adapter_queue_conf::vector_sz
+	 */
+	uint8_t log2_sz;
+	/**< True if the size configured should be in log2.
+	 * @see rte_event_eth_rx_adapter_queue_conf::vector_sz
+	 */
+	uint64_t min_timeout_ns;
+	/**< Minimum vector timeout configurable.
+	 * @see rte_event_eth_rx_adapter_queue_conf::vector_timeout_ns
+	 */
+	uint64_t max_timeout_ns;
+	/**< Maximum vector timeout configurable.
+	 * @see rte_event_eth_rx_adapter_queue_conf::vector_timeout_ns
 	 */
 };
 
@@ -224,6 +343,11 @@ struct rte_event_eth_rx_adapter_stats {
  * number is used by the adapter to indicate the number of dropped packets
  * as part of its statistics.
  *
+ * The callback is only invoked for the events of single mbufs, the vector
+ * events of the Rx queues added with the
+ * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR flag are enqueued without
+ * invoking it.
+ *
  * @param eth_dev_id
  *  Port identifier of the Ethernet device.
  * @param queue_id
@@ -406,7 +530,8 @@ int rte_event_eth_rx_adapter_start(uint8_t id);
 int rte_event_eth_rx_adapter_stop(uint8_t id);
 
 /**
- * Retrieve statistics for an adapter
+ * Retrieve statistics for an adapter, the statistics of the shards of a SW
+ * adapter are summed up.
  *
  * @param id
  *  Adapter identifier.
@@ -422,7 +547,7 @@ int rte_event_eth_rx_adapter_stats_get(uint8_t id,
 				  struct rte_event_eth_rx_adapter_stats *stats);
 
 /**
- * Reset statistics for an adapter.
+ * Reset statistics for an adapter, including the statistics of its shards.
  *
  * @param id
  *  Adapter identifier.
@@ -435,7 +560,8 @@ int rte_event_eth_rx_adapter_stats_reset(uint8_t id);
 
 /**
  * Retrieve the service ID of an adapter. If the adapter doesn't use
- * a rte_service function, this function returns -ESRCH.
+ * a rte_service function, this function returns -ESRCH. If the adapter is
+ * split into shards, this is the service ID of shard 0.
  *
  * @param id
  *  Adapter identifier.
@@ -471,6 +597,98 @@ int rte_event_eth_rx_adapter_cb_register(uint8_t id, uint16_t eth_dev_id,
 					 rte_event_eth_rx_adapter_cb_fn cb_fn,
 					 void *cb_arg);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve vector limits for a given event dev and eth dev pair.
+ * @see rte_event_eth_rx_adapter_vector_limits
+ *
+ * @param dev_id
+ *  Event device identifier.
+ * @param eth_port_id
+ *  Port identifier of the ethernet device.
+ * @param [out] limits
+ *  A pointer to rte_event_eth_rx_adapter_vector_limits structure that has to
+ *  be filled.
+ *
+ * @return
+ *  - 0: Success.
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int rte_event_eth_rx_adapter_vector_limits_get(
+	uint8_t dev_id, uint16_t eth_port_id,
+	struct rte_event_eth_rx_adapter_vector_limits *limits);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the number of shards of a SW adapter. Each shard is a separate service
+ * function polling a subset of the Rx queues of the adapter, with its own
+ * event port. The number of shards can only be changed before the first Rx
+ * queue using a service function is added to the adapter, the default is a
+ * single shard.
+ *
+ * @param id
+ *  Adapter identifier.
+ * @param nb_shards
+ *  Number of shards, between 1 and RTE_MAX_LCORE.
+ *
+ * @return
+ *  - 0: Success.
+ *  - <0: Error code on failure, if the adapter service functions have
+ *  already been created, this function returns -EBUSY.
+ */
+__rte_experimental
+int rte_event_eth_rx_adapter_shards_set(uint8_t id, uint16_t nb_shards);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the service ID of a shard of an adapter. If the adapter doesn't
+ * use rte_service functions, this function returns -ESRCH.
+ *
+ * @param id
+ *  Adapter identifier.
+ * @param shard_id
+ *  Shard identifier.
+ * @param [out] service_id
+ *  A pointer to a uint32_t, to be filled in with the service id.
+ *
+ * @return
+ *  - 0: Success
+ *  - <0: Error code on failure, if the adapter doesn't use rte_service
+ *  functions, this function returns -ESRCH.
+ */
+__rte_experimental
+int rte_event_eth_rx_adapter_shard_service_id_get(uint8_t id,
+						  uint16_t shard_id,
+						  uint32_t *service_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve the statistics of a shard of a SW adapter.
+ *
+ * @param id
+ *  Adapter identifier.
+ * @param shard_id
+ *  Shard identifier.
+ * @param [out] stats
+ *  A pointer to structure used to retrieve statistics for the shard.
+ *
+ * @return
+ *  - 0: Success, retrieved successfully.
+ *  - <0: Error code on failure.
+ */
+__rte_experimental
+int rte_event_eth_rx_adapter_shard_stats_get(uint8_t id, uint16_t shard_id,
+				struct rte_event_eth_rx_adapter_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
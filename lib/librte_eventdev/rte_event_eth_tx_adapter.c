@@ -4,6 +4,8 @@
 #include <rte_spinlock.h>
 #include <rte_service_component.h>
 #include <rte_ethdev.h>
+#include <rte_hash.h>
+#include <rte_jhash.h>
 
 #include "rte_eventdev_pmd.h"
 #include "rte_event_eth_tx_adapter.h"
@@ -16,6 +18,8 @@
 #define TXA_MAX_NB_TX		128
 #define TXA_INVALID_DEV_ID	INT32_C(-1)
 #define TXA_INVALID_SERVICE_ID	INT64_C(-1)
+#define TXA_REORDER_NB_FLOWS	RTE_EVENT_ETH_TX_ADAPTER_REORDER_NB_FLOWS
+#define TXA_REORDER_EVICT_THRESHOLD	(TXA_REORDER_NB_FLOWS / 2)
 
 #define txa_evdev(id) (&rte_eventdevs[txa_dev_id_array[(id)]])
 
@@ -91,6 +95,40 @@ struct txa_service_queue_info {
 	struct txa_retry txa_retry;
 	/* Tx buffer */
 	struct rte_eth_dev_tx_buffer *tx_buf;
+	/* Reorder state, NULL if reordering is disabled */
+	struct txa_reorder *reorder;
+};
+
+/* Reorder window of a flow */
+struct txa_reorder_flow {
+	/* Sequence number of the next mbuf to transmit */
+	uint32_t head;
+	/* Event flow identifier, key of the flow table */
+	uint32_t flow_id;
+	/* Number of mbufs waiting in the window */
+	uint16_t nb_buffered;
+	/* Head did not move since the last flush */
+	uint8_t stalled;
+	/* No mbuf arrived since the last flush */
+	uint8_t idle;
+	/* Flow is in the flow table */
+	uint8_t used;
+};
+
+/* Reorder state of a Tx queue */
+struct txa_reorder {
+	/* Window size of the flows */
+	uint16_t window;
+	/* Number of flows in the flow table */
+	uint16_t nb_flows;
+	/* Event flow identifier to index in flows */
+	struct rte_hash *flow_table;
+	/* Mbufs waiting in the windows, window entries per flow indexed by
+	 * sequence number
+	 */
+	struct rte_mbuf **mbufs;
+	/* Reorder state of the flows */
+	struct txa_reorder_flow flows[TXA_REORDER_NB_FLOWS];
 };
 
 /* PMD private structure */
@@ -509,6 +547,275 @@ txa_service_buffer_retry(struct rte_mbuf **pkts, uint16_t unsent,
 	stats->tx_dropped += unsent - sent;
 }
 
+static void
+txa_reorder_free(struct txa_reorder *ro)
+{
+	if (ro == NULL)
+		return;
+
+	rte_hash_free(ro->flow_table);
+	rte_free(ro->mbufs);
+	rte_free(ro);
+}
+
+static struct txa_reorder *
+txa_reorder_alloc(struct txa_service_data *txa, uint16_t window_size)
+{
+	struct txa_reorder *ro;
+
+	ro = rte_zmalloc_socket(txa->mem_name, sizeof(*ro),
+				RTE_CACHE_LINE_SIZE, txa->socket_id);
+	if (ro == NULL)
+		goto err;
+
+	ro->mbufs = rte_zmalloc_socket(txa->mem_name,
+				TXA_REORDER_NB_FLOWS * window_size *
+				sizeof(*ro->mbufs),
+				RTE_CACHE_LINE_SIZE, txa->socket_id);
+	if (ro->mbufs == NULL)
+		goto err;
+
+	ro->window = window_size;
+	return ro;
+
+err:
+	RTE_EDEV_LOG_ERR("Failed to allocate reorder windows");
+	txa_reorder_free(ro);
+	return NULL;
+}
+
+static struct rte_hash *
+txa_reorder_table_create(struct txa_service_data *txa, uint16_t port_id,
+			uint16_t tx_queue_id)
+{
+	char name[RTE_HASH_NAMESIZE];
+	struct rte_hash_parameters params = {
+		.name = name,
+		.entries = TXA_REORDER_NB_FLOWS,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.socket_id = txa->socket_id,
+	};
+	struct rte_hash *h;
+
+	snprintf(name, sizeof(name), "txa_reorder_%" PRIu8 "_%" PRIu16
+		"_%" PRIu16, txa->id, port_id, tx_queue_id);
+	h = rte_hash_create(&params);
+	if (h == NULL)
+		RTE_EDEV_LOG_ERR("Failed to create reorder flow table %s",
+				name);
+	return h;
+}
+
+static inline uint16_t
+txa_service_tx_buffer(struct txa_service_queue_info *tqi, struct rte_mbuf *m)
+{
+	return rte_eth_tx_buffer(tqi->txa_retry.port_id,
+				tqi->txa_retry.tx_queue, tqi->tx_buf, m);
+}
+
+/* Transmit the mbufs of the window of a flow that are in sequence */
+static uint16_t
+txa_reorder_drain(struct txa_service_queue_info *tqi,
+		struct txa_reorder_flow *rf, struct rte_mbuf **win)
+{
+	uint32_t mask = tqi->reorder->window - 1;
+	struct rte_mbuf *m;
+	uint16_t nb_tx = 0;
+
+	while (rf->nb_buffered && (m = win[rf->head & mask]) != NULL) {
+		win[rf->head & mask] = NULL;
+		rf->head++;
+		rf->nb_buffered--;
+		rf->stalled = 0;
+		nb_tx += txa_service_tx_buffer(tqi, m);
+	}
+
+	return nb_tx;
+}
+
+/* Move the head of the window of a flow to seqn, transmitting the mbufs
+ * left behind and skipping the missing ones
+ */
+static uint16_t
+txa_reorder_advance(struct txa_service_data *txa,
+		struct txa_service_queue_info *tqi,
+		struct txa_reorder_flow *rf, struct rte_mbuf **win,
+		uint32_t seqn)
+{
+	uint32_t window = tqi->reorder->window;
+	uint32_t i, n;
+	struct rte_mbuf *m;
+	uint16_t nb_tx = 0;
+
+	n = RTE_MIN(seqn - rf->head, window);
+	for (i = 0; i < n && rf->nb_buffered; i++) {
+		m = win[(rf->head + i) & (window - 1)];
+		if (m == NULL) {
+			txa->stats.tx_reorder_skipped++;
+			continue;
+		}
+		win[(rf->head + i) & (window - 1)] = NULL;
+		rf->nb_buffered--;
+		nb_tx += txa_service_tx_buffer(tqi, m);
+	}
+	rf->head = seqn;
+	rf->stalled = 0;
+
+	return nb_tx;
+}
+
+/* Look up the flow of an event flow identifier, adding it to the flow table
+ * if it is not tracked yet. The Rx adapter numbers a flow from 0, the window
+ * of a flow that is tracked again after being idle moves to its first mbuf
+ * as the mbuf falls beyond the window. Returns NULL if the flow table is
+ * full.
+ */
+static struct txa_reorder_flow *
+txa_reorder_flow_get(struct txa_reorder *ro, uint32_t flow_id)
+{
+	struct txa_reorder_flow *rf;
+	int32_t pos;
+
+	pos = rte_hash_lookup(ro->flow_table, &flow_id);
+	if (likely(pos >= 0))
+		return &ro->flows[pos];
+
+	pos = rte_hash_add_key(ro->flow_table, &flow_id);
+	if (pos < 0)
+		return NULL;
+
+	rf = &ro->flows[pos];
+	rf->head = 0;
+	rf->flow_id = flow_id;
+	rf->nb_buffered = 0;
+	rf->stalled = 0;
+	rf->idle = 0;
+	rf->used = 1;
+	ro->nb_flows++;
+	return rf;
+}
+
+/* Insert an mbuf in the window of its flow and transmit the mbufs of the
+ * flow that are now in sequence. The windows are only accessed by the
+ * service function, under tx_lock.
+ */
+static uint16_t
+txa_reorder_tx(struct txa_service_data *txa,
+		struct txa_service_queue_info *tqi, struct rte_event *ev)
+{
+	struct txa_reorder *ro = tqi->reorder;
+	uint32_t window = ro->window;
+	struct rte_mbuf *m = ev->mbuf;
+	struct txa_reorder_flow *rf;
+	struct rte_mbuf **win;
+	uint16_t nb_tx = 0;
+	int32_t offset;
+
+	rf = txa_reorder_flow_get(ro, ev->flow_id);
+	if (unlikely(rf == NULL))
+		return txa_service_tx_buffer(tqi, m);
+
+	win = &ro->mbufs[(rf - ro->flows) * window];
+	rf->idle = 0;
+
+	offset = (int32_t)(m->seqn - rf->head);
+	if (offset < 0) {
+		/* The turn of the mbuf has been skipped */
+		if (offset >= -(int32_t)window) {
+			txa->stats.tx_reorder_late++;
+			return txa_service_tx_buffer(tqi, m);
+		}
+		/* The sequence restarted, e.g., the Rx queue was added again */
+		nb_tx += txa_reorder_advance(txa, tqi, rf, win,
+					     rf->head + window);
+		rf->head = m->seqn;
+	} else if ((uint32_t)offset >= window) {
+		if (rf->nb_buffered)
+			nb_tx += txa_reorder_advance(txa, tqi, rf, win,
+						     m->seqn - window + 1);
+		else
+			rf->head = m->seqn;
+	}
+
+	if (unlikely(win[m->seqn & (window - 1)] != NULL)) {
+		/* Duplicate sequence number */
+		txa->stats.tx_reorder_late++;
+		return nb_tx + txa_service_tx_buffer(tqi, m);
+	}
+
+	win[m->seqn & (window - 1)] = m;
+	rf->nb_buffered++;
+
+	return nb_tx + txa_reorder_drain(tqi, rf, win);
+}
+
+/* Skip the missing mbufs of the flows whose head did not move since the
+ * previous flush, so that a dropped mbuf does not hold its flow back. The
+ * flows that received no mbuf since the previous flush are removed from the
+ * flow table once it is half full, making room for new flows.
+ */
+static uint16_t
+txa_reorder_flush(struct txa_service_data *txa,
+		struct txa_service_queue_info *tqi)
+{
+	struct txa_reorder *ro = tqi->reorder;
+	uint32_t window = ro->window;
+	struct txa_reorder_flow *rf;
+	struct rte_mbuf **win;
+	uint32_t i, seqn;
+	uint16_t nb_tx = 0;
+
+	for (i = 0; i < TXA_REORDER_NB_FLOWS; i++) {
+		rf = &ro->flows[i];
+		if (!rf->used)
+			continue;
+		if (rf->nb_buffered == 0) {
+			if (rf->idle &&
+				ro->nb_flows > TXA_REORDER_EVICT_THRESHOLD) {
+				rte_hash_del_key(ro->flow_table, &rf->flow_id);
+				rf->used = 0;
+				ro->nb_flows--;
+			}
+			rf->idle = 1;
+			continue;
+		}
+		if (!rf->stalled) {
+			rf->stalled = 1;
+			continue;
+		}
+
+		win = &ro->mbufs[i * window];
+		for (seqn = rf->head; win[seqn & (window - 1)] == NULL; seqn++)
+			;
+		nb_tx += txa_reorder_advance(txa, tqi, rf, win, seqn);
+		nb_tx += txa_reorder_drain(tqi, rf, win);
+	}
+
+	return nb_tx;
+}
+
+/* Transmit all the mbufs waiting in the reorder windows of a Tx queue */
+static uint16_t
+txa_reorder_flush_all(struct txa_service_data *txa,
+		struct txa_service_queue_info *tqi)
+{
+	struct txa_reorder *ro = tqi->reorder;
+	struct txa_reorder_flow *rf;
+	uint32_t i;
+	uint16_t nb_tx = 0;
+
+	for (i = 0; i < TXA_REORDER_NB_FLOWS; i++) {
+		rf = &ro->flows[i];
+		if (rf->nb_buffered)
+			nb_tx += txa_reorder_advance(txa, tqi, rf,
+					&ro->mbufs[i * ro->window],
+					rf->head + ro->window);
+	}
+
+	return nb_tx;
+}
+
 static void
 txa_service_tx(struct txa_service_data *txa, struct rte_event *ev,
 	uint32_t n)
@@ -536,7 +843,10 @@ txa_service_tx(struct txa_service_data *txa, struct rte_event *ev,
 			continue;
 		}
 
-		nb_tx += rte_eth_tx_buffer(port, queue, tqi->tx_buf, m);
+		if (tqi->reorder != NULL)
+			nb_tx += txa_reorder_tx(txa, tqi, &ev[i]);
+		else
+			nb_tx += rte_eth_tx_buffer(port, queue, tqi->tx_buf, m);
 	}
 
 	stats->tx_packets += nb_tx;
@@ -595,6 +905,8 @@ txa_service_func(void *args)
 				if (unlikely(tqi == NULL || !tqi->added))
 					continue;
 
+				if (tqi->reorder != NULL)
+					nb_tx += txa_reorder_flush(txa, tqi);
 				nb_tx += rte_eth_tx_buffer_flush(i, q,
 							tqi->tx_buf);
 			}
@@ -843,6 +1155,17 @@ txa_service_queue_del(uint8_t id,
 	if (tqi == NULL || !tqi->added)
 		return 0;
 
+	if (tqi->reorder != NULL) {
+		rte_spinlock_lock(&txa->tx_lock);
+		txa->stats.tx_packets += txa_reorder_flush_all(txa, tqi);
+		txa->stats.tx_packets += rte_eth_tx_buffer_flush(port_id,
+							tx_queue_id,
+							tqi->tx_buf);
+		txa_reorder_free(tqi->reorder);
+		tqi->reorder = NULL;
+		rte_spinlock_unlock(&txa->tx_lock);
+	}
+
 	tb = tqi->tx_buf;
 	tqi->added = 0;
 	tqi->tx_buf = NULL;
@@ -903,6 +1226,73 @@ txa_service_stop(uint8_t id)
 	return txa_service_ctrl(id, 0);
 }
 
+static int
+txa_service_reorder_set(uint8_t id, const struct rte_eth_dev *dev,
+			int32_t tx_queue_id, uint16_t window_size)
+{
+	struct txa_service_data *txa;
+	struct txa_service_queue_info *tqi;
+	struct txa_reorder *ro = NULL;
+	struct txa_reorder *old;
+	uint16_t port_id;
+	int ret = 0;
+
+	txa = txa_service_id_to_data(id);
+	port_id = dev->data->port_id;
+
+	if (tx_queue_id == -1) {
+		uint16_t q;
+
+		for (q = 0; q < dev->data->nb_tx_queues && ret == 0; q++) {
+			if (txa_service_is_queue_added(txa, dev, q))
+				ret = txa_service_reorder_set(id, dev, q,
+							window_size);
+		}
+		return ret;
+	}
+
+	if (!txa_service_is_queue_added(txa, dev, tx_queue_id)) {
+		RTE_EDEV_LOG_ERR("Tx queue %" PRIu16 " of port %" PRIu16
+				" not added", (uint16_t)tx_queue_id, port_id);
+		return -EINVAL;
+	}
+	tqi = txa_service_queue(txa, port_id, tx_queue_id);
+
+	if (window_size) {
+		ro = txa_reorder_alloc(txa, window_size);
+		if (ro == NULL)
+			return -ENOMEM;
+	}
+
+	rte_spinlock_lock(&txa->tx_lock);
+
+	old = tqi->reorder;
+	if (old != NULL) {
+		txa->stats.tx_packets += txa_reorder_flush_all(txa, tqi);
+		if (ro != NULL) {
+			/* The flow table of the queue is kept, its name is
+			 * unique
+			 */
+			rte_hash_reset(old->flow_table);
+			ro->flow_table = old->flow_table;
+			old->flow_table = NULL;
+		}
+	} else if (ro != NULL) {
+		ro->flow_table = txa_reorder_table_create(txa, port_id,
+							tx_queue_id);
+		if (ro->flow_table == NULL) {
+			txa_reorder_free(ro);
+			ro = NULL;
+			ret = -ENOMEM;
+		}
+	}
+	tqi->reorder = ro;
+
+	rte_spinlock_unlock(&txa->tx_lock);
+
+	txa_reorder_free(old);
+	return ret;
+}
 
 int
 rte_event_eth_tx_adapter_create(uint8_t id, uint8_t dev_id,
@@ -1122,6 +1512,10 @@ rte_event_eth_tx_adapter_stats_get(uint8_t id,
 				stats->tx_retry += service_stats.tx_retry;
 				stats->tx_packets += service_stats.tx_packets;
 				stats->tx_dropped += service_stats.tx_dropped;
+				stats->tx_reorder_late +=
+					service_stats.tx_reorder_late;
+				stats->tx_reorder_skipped +=
+					service_stats.tx_reorder_skipped;
 			}
 		} else
 			ret = txa_service_stats_get(id, stats);
@@ -1144,6 +1538,36 @@ rte_event_eth_tx_adapter_stats_reset(uint8_t id)
 	return ret;
 }
 
+int
+rte_event_eth_tx_adapter_reorder_set(uint8_t id, uint16_t eth_dev_id,
+				int32_t queue, uint16_t window_size)
+{
+	struct rte_eth_dev *eth_dev;
+	uint32_t caps;
+
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(eth_dev_id, -EINVAL);
+	TXA_CHECK_OR_ERR_RET(id);
+
+	eth_dev = &rte_eth_devices[eth_dev_id];
+	TXA_CHECK_TXQ(eth_dev, queue);
+
+	if (window_size > RTE_EVENT_ETH_TX_ADAPTER_REORDER_MAX_WINDOW ||
+		(window_size && !rte_is_power_of_2(window_size))) {
+		RTE_EDEV_LOG_ERR("Invalid reorder window size %" PRIu16,
+				window_size);
+		return -EINVAL;
+	}
+
+	caps = 0;
+	if (txa_dev_caps_get(id))
+		txa_dev_caps_get(id)(txa_evdev(id), eth_dev, &caps);
+
+	if (caps & RTE_EVENT_ETH_TX_ADAPTER_CAP_INTERNAL_PORT)
+		return -ENOTSUP;
+
+	return txa_service_reorder_set(id, eth_dev, queue, window_size);
+}
+
 int
 rte_event_eth_tx_adapter_stop(uint8_t id)
 {
@@ -34,6 +34,7 @@
  *  - rte_event_eth_tx_adapter_enqueue()
  *  - rte_event_eth_tx_adapter_event_port_get()
  *  - rte_event_eth_tx_adapter_service_id_get()
+ *  - rte_event_eth_tx_adapter_reorder_set()
  *
  * The application creates the adapter using
  * rte_event_eth_tx_adapter_create() or rte_event_eth_tx_adapter_create_ext().
@@ -68,6 +69,20 @@
  * and rte_event_eth_tx_adapter_txq_get() functions to access the transmit
  * queue index, using these macros will help with minimizing application
  * impact due to a change in how the transmit queue index is specified.
+ *
+ * The common implementation can restore the order of the mbufs of each flow
+ * before transmitting them, so that the application can process them
+ * through parallel event queues instead of atomic ones. The mbufs are
+ * numbered per flow by the event ethernet Rx adapter, see
+ * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN, and the application must keep the
+ * event flow identifier set by the Rx adapter. Reordering is enabled per Tx
+ * queue using rte_event_eth_tx_adapter_reorder_set(), all the mbufs
+ * transmitted on such a queue must have been numbered. The service function
+ * keeps a window of mbufs per event flow identifier and transmits the mbufs
+ * of a flow in sequence number order. The missing mbufs, e.g., dropped by
+ * the application, are skipped once they would fall out of the window or
+ * once the flow has not progressed for two consecutive flushes of the
+ * adapter Tx buffers.
  */
 
 #ifdef __cplusplus
@@ -76,6 +91,7 @@ extern "C" {
 
 #include <stdint.h>
 
+#include <rte_compat.h>
 #include <rte_mbuf.h>
 
 #include "rte_eventdev.h"
@@ -133,8 +149,27 @@ struct rte_event_eth_tx_adapter_stats {
 	/**< Number of packets transmitted */
 	uint64_t tx_dropped;
 	/**< Number of packets dropped */
+	uint64_t tx_reorder_late;
+	/**< Number of packets transmitted out of order, their turn having been
+	 * skipped by the reorder window
+	 */
+	uint64_t tx_reorder_skipped;
+	/**< Number of missing sequence numbers skipped by the reorder window */
 };
 
+#define RTE_EVENT_ETH_TX_ADAPTER_REORDER_MAX_WINDOW	1024
+/**< Maximum size of the reorder window of a flow
+ * @see rte_event_eth_tx_adapter_reorder_set()
+ */
+
+#define RTE_EVENT_ETH_TX_ADAPTER_REORDER_NB_FLOWS	1024
+/**< Maximum number of flows a Tx queue reorders at the same time, the mbufs
+ * of the other flows are transmitted in arrival order. Once half of the
+ * flows are tracked, a flow stops being tracked when it has received no mbuf
+ * for two consecutive flushes of the adapter Tx buffers.
+ * @see rte_event_eth_tx_adapter_reorder_set()
+ */
+
 /**
  * Create a new ethernet Tx adapter with the specified identifier.
  *
@@ -389,6 +424,42 @@ rte_event_eth_tx_adapter_stats_get(uint8_t id,
 int
 rte_event_eth_tx_adapter_stats_reset(uint8_t id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Enable or disable the restoration of the per flow order of the mbufs
+ * transmitted by the adapter service function on a Tx queue. All the mbufs
+ * transmitted on the queue must have been numbered by the event ethernet Rx
+ * adapter, the flow of an mbuf is identified by its event flow identifier.
+ *
+ * Disabling reordering or changing the window size transmits the mbufs
+ * waiting in the windows of the queue.
+ *
+ * @param id
+ *  Adapter identifier.
+ * @param eth_dev_id
+ *  Ethernet Port Identifier.
+ * @param queue
+ *  Tx queue index, -1 for all the Tx queues of the port added to the
+ *  adapter.
+ * @param window_size
+ *  Number of mbufs a flow can have waiting for a missing mbuf, a power of
+ *  2 no larger than RTE_EVENT_ETH_TX_ADAPTER_REORDER_MAX_WINDOW. 0 disables
+ *  reordering.
+ * @return
+ *  - 0: Success.
+ *  - -EINVAL: Invalid parameter or the Tx queue is not added to the adapter.
+ *  - -ENOTSUP: The adapter does not use a service function for the port.
+ *  - <0: Error code on failure.
+ *
+ * @see RTE_EVENT_ETH_RX_ADAPTER_QUEUE_SEQN
+ */
+__rte_experimental
+int
+rte_event_eth_tx_adapter_reorder_set(uint8_t id, uint16_t eth_dev_id,
+				int32_t queue, uint16_t window_size);
+
 /**
  * Retrieve the service ID of an adapter. If the adapter doesn't use
  * a rte_service function, this function returns -ESRCH.
@@ -0,0 +1,170 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _GRO_HASH_H_
+#define _GRO_HASH_H_
+
+#include <rte_common.h>
+#include <rte_hash_crc.h>
+#if defined(RTE_ARCH_X86)
+#include <rte_vect.h>
+#endif
+
+/*
+ * Hash index of the flows of a GRO table. The flows are hashed to
+ * buckets of GRO_HASH_BUCKET_ENTRIES entries, which keep the 16 most
+ * significant bits of the flow hash as signature. A flow which doesn't
+ * fit in its home bucket is stored in one of the following ones, up to
+ * GRO_HASH_MAX_PROBE buckets away, and the home bucket counts it in
+ * nb_overflow, so that the lookups only probe the following buckets
+ * when needed.
+ */
+#define GRO_HASH_BUCKET_ENTRIES 8
+#define GRO_HASH_MAX_PROBE 4
+#define GRO_HASH_FULL_BUCKET ((1U << GRO_HASH_BUCKET_ENTRIES) - 1)
+#define GRO_HASH_INIT_VAL 0xffffffff
+#define GRO_HASH_INVALID_POS 0xffffffffUL
+#define INVALID_ARRAY_INDEX 0xffffffffUL
+/* the hash index keeps the load of the buckets under one half */
+#define GRO_HASH_BUCKET_NUM(flow_num) \
+	rte_align32pow2(RTE_MAX((uint32_t)(flow_num) * 2 / \
+				GRO_HASH_BUCKET_ENTRIES, 1U))
+
+struct gro_hash_bucket {
+	/* signatures of the flows */
+	uint16_t sig[GRO_HASH_BUCKET_ENTRIES];
+	/* indexes of the flows in the flow array */
+	uint32_t flow_idx[GRO_HASH_BUCKET_ENTRIES];
+	/* bitmask of the used entries */
+	uint32_t used_mask;
+	/* number of flows of this bucket stored in the following ones */
+	uint32_t nb_overflow;
+} __rte_cache_aligned;
+
+struct gro_hash {
+	struct gro_hash_bucket *buckets;
+	uint32_t bucket_mask;
+};
+
+/*
+ * Compare the key of the flow at index flow_idx of a GRO table with a
+ * key. Return 1 if they are the same, 0 otherwise.
+ */
+typedef int (*gro_hash_flow_cmp_t)(void *tbl, uint32_t flow_idx, void *key);
+
+static inline void
+gro_hash_init(struct gro_hash *h,
+		struct gro_hash_bucket *buckets,
+		uint32_t nb_buckets)
+{
+	uint32_t i;
+
+	for (i = 0; i < nb_buckets; i++) {
+		buckets[i].used_mask = 0;
+		buckets[i].nb_overflow = 0;
+	}
+	h->buckets = buckets;
+	h->bucket_mask = nb_buckets - 1;
+}
+
+static inline uint32_t
+gro_hash_key(const void *key, uint32_t key_len)
+{
+	return rte_hash_crc(key, key_len, GRO_HASH_INIT_VAL);
+}
+
+/*
+ * Return the bitmask of the used entries of a bucket whose signature
+ * matches, comparing all the signatures of the bucket at once.
+ */
+static inline uint32_t
+gro_hash_match(const struct gro_hash_bucket *b, uint32_t hash)
+{
+	uint16_t sig = hash >> 16;
+#if defined(RTE_ARCH_X86)
+	__m128i cmp;
+
+	cmp = _mm_cmpeq_epi16(_mm_load_si128((const __m128i *)b->sig),
+			_mm_set1_epi16(sig));
+	return _mm_movemask_epi8(_mm_packs_epi16(cmp, _mm_setzero_si128())) &
+		b->used_mask;
+#else
+	uint32_t i, hits = 0;
+
+	for (i = 0; i < GRO_HASH_BUCKET_ENTRIES; i++)
+		hits |= (uint32_t)(b->sig[i] == sig) << i;
+	return hits & b->used_mask;
+#endif
+}
+
+/*
+ * Look up the flow of a key in the hash index of a GRO table. The full
+ * keys are compared with cmp only for the flows whose signature matches.
+ * Return the index of the flow, or INVALID_ARRAY_INDEX if there is none.
+ */
+static __rte_always_inline uint32_t
+gro_hash_lookup(const struct gro_hash *h, uint32_t hash,
+		gro_hash_flow_cmp_t cmp, void *tbl, void *key)
+{
+	const struct gro_hash_bucket *b;
+	uint32_t home = hash & h->bucket_mask;
+	uint32_t i, hits, flow_idx;
+
+	for (i = 0; i < GRO_HASH_MAX_PROBE; i++) {
+		b = &h->buckets[(home + i) & h->bucket_mask];
+		hits = gro_hash_match(b, hash);
+		while (hits) {
+			flow_idx = b->flow_idx[__builtin_ctz(hits)];
+			if (cmp(tbl, flow_idx, key))
+				return flow_idx;
+			hits &= hits - 1;
+		}
+		/* Only probe the following buckets if the home one is full */
+		if (h->buckets[home].nb_overflow == 0)
+			break;
+	}
+	return INVALID_ARRAY_INDEX;
+}
+
+/*
+ * Add a flow to the hash index. Return the position of the flow in
+ * the index, or GRO_HASH_INVALID_POS if the home bucket of the flow and
+ * the following ones are full.
+ */
+static inline uint32_t
+gro_hash_add(struct gro_hash *h, uint32_t hash, uint32_t flow_idx)
+{
+	struct gro_hash_bucket *b;
+	uint32_t home = hash & h->bucket_mask;
+	uint32_t i, idx, entry;
+
+	for (i = 0; i < GRO_HASH_MAX_PROBE; i++) {
+		idx = (home + i) & h->bucket_mask;
+		b = &h->buckets[idx];
+		if (b->used_mask == GRO_HASH_FULL_BUCKET)
+			continue;
+
+		entry = __builtin_ctz(~b->used_mask);
+		b->sig[entry] = hash >> 16;
+		b->flow_idx[entry] = flow_idx;
+		b->used_mask |= 1U << entry;
+		if (idx != home)
+			h->buckets[home].nb_overflow++;
+		return idx * GRO_HASH_BUCKET_ENTRIES + entry;
+	}
+	return GRO_HASH_INVALID_POS;
+}
+
+/* Remove the flow at position pos of the hash index. */
+static inline void
+gro_hash_del(struct gro_hash *h, uint32_t hash, uint32_t pos)
+{
+	uint32_t home = hash & h->bucket_mask;
+	uint32_t idx = pos / GRO_HASH_BUCKET_ENTRIES;
+
+	h->buckets[idx].used_mask &= ~(1U << (pos % GRO_HASH_BUCKET_ENTRIES));
+	if (idx != home)
+		h->buckets[home].nb_overflow--;
+}
+#endif
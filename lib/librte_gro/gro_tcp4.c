@@ -15,8 +15,9 @@ gro_tcp4_tbl_create(uint16_t socket_id,
 		uint16_t max_item_per_flow)
 {
 	struct gro_tcp4_tbl *tbl;
+	struct gro_hash_bucket *buckets;
 	size_t size;
-	uint32_t entries_num, i;
+	uint32_t entries_num, nb_buckets, i;
 
 	entries_num = max_flow_num * max_item_per_flow;
 	entries_num = RTE_MIN(entries_num, GRO_TCP4_TBL_MAX_ITEM_NUM);
@@ -52,6 +53,21 @@ gro_tcp4_tbl_create(uint16_t socket_id,
 		rte_free(tbl);
 		return NULL;
 	}
+
+	nb_buckets = GRO_HASH_BUCKET_NUM(entries_num);
+	size = sizeof(struct gro_hash_bucket) * nb_buckets;
+	buckets = rte_zmalloc_socket(__func__,
+			size,
+			RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (buckets == NULL) {
+		rte_free(tbl->flows);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+	gro_hash_init(&tbl->flow_hash, buckets, nb_buckets);
+
 	/* INVALID_ARRAY_INDEX indicates an empty flow */
 	for (i = 0; i < entries_num; i++)
 		tbl->flows[i].start_index = INVALID_ARRAY_INDEX;
@@ -68,6 +84,7 @@ gro_tcp4_tbl_destroy(void *tbl)
 	if (tcp_tbl) {
 		rte_free(tcp_tbl->items);
 		rte_free(tcp_tbl->flows);
+		rte_free(tcp_tbl->flow_hash.buckets);
 	}
 	rte_free(tcp_tbl);
 }
@@ -149,14 +166,18 @@ delete_item(struct gro_tcp4_tbl *tbl, uint32_t item_idx,
 static inline uint32_t
 insert_new_flow(struct gro_tcp4_tbl *tbl,
 		struct tcp4_flow_key *src,
+		uint32_t hash,
 		uint32_t item_idx)
 {
 	struct tcp4_flow_key *dst;
-	uint32_t flow_idx;
+	uint32_t flow_idx, hash_pos;
 
 	flow_idx = find_an_empty_flow(tbl);
 	if (unlikely(flow_idx == INVALID_ARRAY_INDEX))
 		return INVALID_ARRAY_INDEX;
+	hash_pos = gro_hash_add(&tbl->flow_hash, hash, flow_idx);
+	if (unlikely(hash_pos == GRO_HASH_INVALID_POS))
+		return INVALID_ARRAY_INDEX;
 
 	dst = &(tbl->flows[flow_idx].key);
 
@@ -169,11 +190,22 @@ insert_new_flow(struct gro_tcp4_tbl *tbl,
 	dst->dst_port = src->dst_port;
 
 	tbl->flows[flow_idx].start_index = item_idx;
+	tbl->flows[flow_idx].hash = hash;
+	tbl->flows[flow_idx].hash_pos = hash_pos;
 	tbl->flow_num++;
 
 	return flow_idx;
 }
 
+static int
+tcp4_flow_cmp(void *tbl, uint32_t flow_idx, void *key)
+{
+	struct gro_tcp4_tbl *t = tbl;
+
+	return is_same_tcp4_flow(t->flows[flow_idx].key,
+			*(struct tcp4_flow_key *)key);
+}
+
 /*
  * update the packet length for the flushed packet.
  */
@@ -204,9 +236,8 @@ gro_tcp4_reassemble(struct rte_mbuf *pkt,
 
 	struct tcp4_flow_key key;
 	uint32_t cur_idx, prev_idx, item_idx;
-	uint32_t i, max_flow_num, remaining_flow_num;
+	uint32_t i, hash;
 	int cmp;
-	uint8_t find;
 
 	/*
 	 * Don't process the packet whose TCP header length is greater
@@ -252,30 +283,21 @@ gro_tcp4_reassemble(struct rte_mbuf *pkt,
 	key.recv_ack = tcp_hdr->recv_ack;
 
 	/* Search for a matched flow. */
-	max_flow_num = tbl->max_flow_num;
-	remaining_flow_num = tbl->flow_num;
-	find = 0;
-	for (i = 0; i < max_flow_num && remaining_flow_num; i++) {
-		if (tbl->flows[i].start_index != INVALID_ARRAY_INDEX) {
-			if (is_same_tcp4_flow(tbl->flows[i].key, key)) {
-				find = 1;
-				break;
-			}
-			remaining_flow_num--;
-		}
-	}
+	hash = gro_hash_key(&key, sizeof(key));
+	i = gro_hash_lookup(&tbl->flow_hash, hash, tcp4_flow_cmp,
+			tbl, &key);
 
 	/*
 	 * Fail to find a matched flow. Insert a new flow and store the
 	 * packet into the flow.
 	 */
-	if (find == 0) {
+	if (i == INVALID_ARRAY_INDEX) {
 		item_idx = insert_new_item(tbl, pkt, start_time,
 				INVALID_ARRAY_INDEX, sent_seq, ip_id,
 				is_atomic);
 		if (item_idx == INVALID_ARRAY_INDEX)
 			return -1;
-		if (insert_new_flow(tbl, &key, item_idx) ==
+		if (insert_new_flow(tbl, &key, hash, item_idx) ==
 				INVALID_ARRAY_INDEX) {
 			/*
 			 * Fail to insert a new flow, so delete the
@@ -350,8 +372,12 @@ gro_tcp4_tbl_timeout_flush(struct gro_tcp4_tbl *tbl,
 				 */
 				j = delete_item(tbl, j, INVALID_ARRAY_INDEX);
 				tbl->flows[i].start_index = j;
-				if (j == INVALID_ARRAY_INDEX)
+				if (j == INVALID_ARRAY_INDEX) {
+					gro_hash_del(&tbl->flow_hash,
+							tbl->flows[i].hash,
+							tbl->flows[i].hash_pos);
 					tbl->flow_num--;
+				}
 
 				if (unlikely(k == nb_out))
 					return k;
@@ -8,7 +8,8 @@
 #include <rte_ip.h>
 #include <rte_tcp.h>
 
-#define INVALID_ARRAY_INDEX 0xffffffffUL
+#include "gro_hash.h"
+
 #define GRO_TCP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
 
 /*
@@ -41,6 +42,9 @@ struct gro_tcp4_flow {
 	 * INVALID_ARRAY_INDEX indicates an empty flow.
 	 */
 	uint32_t start_index;
+	/* hash of the key and position of the flow in the hash index */
+	uint32_t hash;
+	uint32_t hash_pos;
 };
 
 struct gro_tcp4_item {
@@ -89,6 +93,8 @@ struct gro_tcp4_tbl {
 	uint32_t max_item_num;
 	/* flow array size */
 	uint32_t max_flow_num;
+	/* hash index of the flow array */
+	struct gro_hash flow_hash;
 };
 
 /**
@@ -33,6 +33,9 @@ struct gro_vxlan_tcp4_flow {
 	 * indicates an empty flow.
 	 */
 	uint32_t start_index;
+	/* hash of the key and position of the flow in the hash index */
+	uint32_t hash;
+	uint32_t hash_pos;
 };
 
 struct gro_vxlan_tcp4_item {
@@ -60,6 +63,8 @@ struct gro_vxlan_tcp4_tbl {
 	uint32_t max_item_num;
 	/* the maximum flow number */
 	uint32_t max_flow_num;
+	/* hash index of the flow array */
+	struct gro_hash flow_hash;
 };
 
 /**
@@ -9,7 +9,10 @@
 
 #include "rte_gro.h"
 #include "gro_tcp4.h"
+#include "gro_tcp6.h"
 #include "gro_vxlan_tcp4.h"
+#include "gro_vxlan_tcp6.h"
+#include "gro_udp4.h"
 
 typedef void *(*gro_tbl_create_fn)(uint16_t socket_id,
 		uint16_t max_flow_num,
@@ -18,27 +21,69 @@ typedef void (*gro_tbl_destroy_fn)(void *tbl);
 typedef uint32_t (*gro_tbl_pkt_count_fn)(void *tbl);
 
 static gro_tbl_create_fn tbl_create_fn[RTE_GRO_TYPE_MAX_NUM] = {
-		gro_tcp4_tbl_create, gro_vxlan_tcp4_tbl_create, NULL};
+		gro_tcp4_tbl_create, gro_vxlan_tcp4_tbl_create,
+		gro_tcp6_tbl_create, gro_vxlan_tcp6_tbl_create,
+		gro_udp4_tbl_create, NULL};
 static gro_tbl_destroy_fn tbl_destroy_fn[RTE_GRO_TYPE_MAX_NUM] = {
 			gro_tcp4_tbl_destroy, gro_vxlan_tcp4_tbl_destroy,
-			NULL};
+			gro_tcp6_tbl_destroy, gro_vxlan_tcp6_tbl_destroy,
+			gro_udp4_tbl_destroy, NULL};
 static gro_tbl_pkt_count_fn tbl_pkt_count_fn[RTE_GRO_TYPE_MAX_NUM] = {
 			gro_tcp4_tbl_pkt_count, gro_vxlan_tcp4_tbl_pkt_count,
-			NULL};
+			gro_tcp6_tbl_pkt_count, gro_vxlan_tcp6_tbl_pkt_count,
+			gro_udp4_tbl_pkt_count, NULL};
 
+/*
+ * The L4, tunnel and inner L3/L4 packet types are enumerations rather
+ * than bit flags, so they are compared under their masks.
+ */
 #define IS_IPV4_TCP_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
-		((ptype & RTE_PTYPE_L4_TCP) == RTE_PTYPE_L4_TCP))
+		((ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_TCP))
+
+#define IS_IPV6_TCP_PKT(ptype) (RTE_ETH_IS_IPV6_HDR(ptype) && \
+		((ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_TCP))
 
-#define IS_IPV4_VXLAN_TCP4_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
-		((ptype & RTE_PTYPE_L4_UDP) == RTE_PTYPE_L4_UDP) && \
-		((ptype & RTE_PTYPE_TUNNEL_VXLAN) == \
+/*
+ * Fragments are usually reported as RTE_PTYPE_L4_FRAG. The UDP/IPv4
+ * reassembly function checks the IPv4 header for the rest.
+ */
+#define IS_IPV4_UDP_FRAG_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
+		(((ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_FRAG) || \
+		 ((ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_UDP)) && \
+		((ptype & RTE_PTYPE_TUNNEL_MASK) == 0))
+
+#define IS_IPV4_VXLAN_TCP_PKT(ptype) (RTE_ETH_IS_IPV4_HDR(ptype) && \
+		((ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_UDP) && \
+		((ptype & RTE_PTYPE_TUNNEL_MASK) == \
 		 RTE_PTYPE_TUNNEL_VXLAN) && \
-		 ((ptype & RTE_PTYPE_INNER_L4_TCP) == \
-		  RTE_PTYPE_INNER_L4_TCP) && \
-		  (((ptype & RTE_PTYPE_INNER_L3_MASK) & \
-		    (RTE_PTYPE_INNER_L3_IPV4 | \
-		     RTE_PTYPE_INNER_L3_IPV4_EXT | \
-		     RTE_PTYPE_INNER_L3_IPV4_EXT_UNKNOWN)) != 0))
+		((ptype & RTE_PTYPE_INNER_L4_MASK) == \
+		 RTE_PTYPE_INNER_L4_TCP))
+
+#define IS_IPV4_VXLAN_TCP4_PKT(ptype) (IS_IPV4_VXLAN_TCP_PKT(ptype) && \
+		(((ptype & RTE_PTYPE_INNER_L3_MASK) == \
+		  RTE_PTYPE_INNER_L3_IPV4) || \
+		 ((ptype & RTE_PTYPE_INNER_L3_MASK) == \
+		  RTE_PTYPE_INNER_L3_IPV4_EXT) || \
+		 ((ptype & RTE_PTYPE_INNER_L3_MASK) == \
+		  RTE_PTYPE_INNER_L3_IPV4_EXT_UNKNOWN)))
+
+#define IS_IPV4_VXLAN_TCP6_PKT(ptype) (IS_IPV4_VXLAN_TCP_PKT(ptype) && \
+		(((ptype & RTE_PTYPE_INNER_L3_MASK) == \
+		  RTE_PTYPE_INNER_L3_IPV6) || \
+		 ((ptype & RTE_PTYPE_INNER_L3_MASK) == \
+		  RTE_PTYPE_INNER_L3_IPV6_EXT) || \
+		 ((ptype & RTE_PTYPE_INNER_L3_MASK) == \
+		  RTE_PTYPE_INNER_L3_IPV6_EXT_UNKNOWN)))
+
+#define GRO_SUPPORTED_TYPES (RTE_GRO_TCP_IPV4 | \
+		RTE_GRO_IPV4_VXLAN_TCP_IPV4 | RTE_GRO_TCP_IPV6 | \
+		RTE_GRO_IPV4_VXLAN_TCP_IPV6 | RTE_GRO_UDP_IPV4)
+
+/* hash buckets of the per-burst tables, i.e. GRO_HASH_BUCKET_NUM() of
+ * RTE_GRO_MAX_BURST_ITEM_NUM flows
+ */
+#define GRO_BURST_BUCKET_NUM \
+	(RTE_GRO_MAX_BURST_ITEM_NUM * 2 / GRO_HASH_BUCKET_ENTRIES)
 
 /*
  * GRO context structure. It keeps the table structures, which are
@@ -121,22 +166,43 @@ rte_gro_reassemble_burst(struct rte_mbuf **pkts,
 	/* allocate a reassembly table for TCP/IPv4 GRO */
 	struct gro_tcp4_tbl tcp_tbl;
 	struct gro_tcp4_flow tcp_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_hash_bucket tcp_buckets[GRO_BURST_BUCKET_NUM];
 	struct gro_tcp4_item tcp_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
 
+	/* allocate a reassembly table for TCP/IPv6 GRO */
+	struct gro_tcp6_tbl tcp6_tbl;
+	struct gro_tcp6_flow tcp6_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_hash_bucket tcp6_buckets[GRO_BURST_BUCKET_NUM];
+	struct gro_tcp4_item tcp6_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
+
 	/* Allocate a reassembly table for VXLAN GRO */
 	struct gro_vxlan_tcp4_tbl vxlan_tbl;
 	struct gro_vxlan_tcp4_flow vxlan_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_hash_bucket vxlan_buckets[GRO_BURST_BUCKET_NUM];
 	struct gro_vxlan_tcp4_item vxlan_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {
 		{{0}, 0, 0} };
 
+	/* Allocate a reassembly table for VXLAN GRO of TCP/IPv6 packets */
+	struct gro_vxlan_tcp6_tbl vxlan6_tbl;
+	struct gro_vxlan_tcp6_flow vxlan6_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_hash_bucket vxlan6_buckets[GRO_BURST_BUCKET_NUM];
+	struct gro_vxlan_tcp6_item vxlan6_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {
+		{{0}, 0, 0} };
+
+	/* allocate a reassembly table for UDP/IPv4 fragment GRO */
+	struct gro_udp4_tbl udp_tbl;
+	struct gro_udp4_flow udp_flows[RTE_GRO_MAX_BURST_ITEM_NUM];
+	struct gro_hash_bucket udp_buckets[GRO_BURST_BUCKET_NUM];
+	struct gro_udp4_item udp_items[RTE_GRO_MAX_BURST_ITEM_NUM] = {{0} };
+
 	struct rte_mbuf *unprocess_pkts[nb_pkts];
 	uint32_t item_num;
 	int32_t ret;
 	uint16_t i, unprocess_num = 0, nb_after_gro = nb_pkts;
-	uint8_t do_tcp4_gro = 0, do_vxlan_gro = 0;
+	uint8_t do_tcp4_gro = 0, do_vxlan_gro = 0, do_tcp6_gro = 0,
+		do_vxlan6_gro = 0, do_udp4_gro = 0;
 
-	if (unlikely((param->gro_types & (RTE_GRO_IPV4_VXLAN_TCP_IPV4 |
-					RTE_GRO_TCP_IPV4)) == 0))
+	if (unlikely((param->gro_types & GRO_SUPPORTED_TYPES) == 0))
 		return nb_pkts;
 
 	/* Get the maximum number of packets */
@@ -154,9 +220,26 @@ rte_gro_reassemble_burst(struct rte_mbuf **pkts,
 		vxlan_tbl.item_num = 0;
 		vxlan_tbl.max_flow_num = item_num;
 		vxlan_tbl.max_item_num = item_num;
+		gro_hash_init(&vxlan_tbl.flow_hash, vxlan_buckets,
+				GRO_HASH_BUCKET_NUM(item_num));
 		do_vxlan_gro = 1;
 	}
 
+	if (param->gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV6) {
+		for (i = 0; i < item_num; i++)
+			vxlan6_flows[i].start_index = INVALID_ARRAY_INDEX;
+
+		vxlan6_tbl.flows = vxlan6_flows;
+		vxlan6_tbl.items = vxlan6_items;
+		vxlan6_tbl.flow_num = 0;
+		vxlan6_tbl.item_num = 0;
+		vxlan6_tbl.max_flow_num = item_num;
+		vxlan6_tbl.max_item_num = item_num;
+		gro_hash_init(&vxlan6_tbl.flow_hash, vxlan6_buckets,
+				GRO_HASH_BUCKET_NUM(item_num));
+		do_vxlan6_gro = 1;
+	}
+
 	if (param->gro_types & RTE_GRO_TCP_IPV4) {
 		for (i = 0; i < item_num; i++)
 			tcp_flows[i].start_index = INVALID_ARRAY_INDEX;
@@ -167,9 +250,41 @@ rte_gro_reassemble_burst(struct rte_mbuf **pkts,
 		tcp_tbl.item_num = 0;
 		tcp_tbl.max_flow_num = item_num;
 		tcp_tbl.max_item_num = item_num;
+		gro_hash_init(&tcp_tbl.flow_hash, tcp_buckets,
+				GRO_HASH_BUCKET_NUM(item_num));
 		do_tcp4_gro = 1;
 	}
 
+	if (param->gro_types & RTE_GRO_TCP_IPV6) {
+		for (i = 0; i < item_num; i++)
+			tcp6_flows[i].start_index = INVALID_ARRAY_INDEX;
+
+		tcp6_tbl.flows = tcp6_flows;
+		tcp6_tbl.items = tcp6_items;
+		tcp6_tbl.flow_num = 0;
+		tcp6_tbl.item_num = 0;
+		tcp6_tbl.max_flow_num = item_num;
+		tcp6_tbl.max_item_num = item_num;
+		gro_hash_init(&tcp6_tbl.flow_hash, tcp6_buckets,
+				GRO_HASH_BUCKET_NUM(item_num));
+		do_tcp6_gro = 1;
+	}
+
+	if (param->gro_types & RTE_GRO_UDP_IPV4) {
+		for (i = 0; i < item_num; i++)
+			udp_flows[i].start_index = INVALID_ARRAY_INDEX;
+
+		udp_tbl.flows = udp_flows;
+		udp_tbl.items = udp_items;
+		udp_tbl.flow_num = 0;
+		udp_tbl.item_num = 0;
+		udp_tbl.max_flow_num = item_num;
+		udp_tbl.max_item_num = item_num;
+		gro_hash_init(&udp_tbl.flow_hash, udp_buckets,
+				GRO_HASH_BUCKET_NUM(item_num));
+		do_udp4_gro = 1;
+	}
+
 	for (i = 0; i < nb_pkts; i++) {
 		/*
 		 * The timestamp is ignored, since all packets
@@ -178,20 +293,26 @@ rte_gro_reassemble_burst(struct rte_mbuf **pkts,
 		if (IS_IPV4_VXLAN_TCP4_PKT(pkts[i]->packet_type) &&
 				do_vxlan_gro) {
 			ret = gro_vxlan_tcp4_reassemble(pkts[i], &vxlan_tbl, 0);
-			if (ret > 0)
-				/* Merge successfully */
-				nb_after_gro--;
-			else if (ret < 0)
-				unprocess_pkts[unprocess_num++] = pkts[i];
+		} else if (IS_IPV4_VXLAN_TCP6_PKT(pkts[i]->packet_type) &&
+				do_vxlan6_gro) {
+			ret = gro_vxlan_tcp6_reassemble(pkts[i], &vxlan6_tbl,
+					0);
 		} else if (IS_IPV4_TCP_PKT(pkts[i]->packet_type) &&
 				do_tcp4_gro) {
 			ret = gro_tcp4_reassemble(pkts[i], &tcp_tbl, 0);
-			if (ret > 0)
-				/* merge successfully */
-				nb_after_gro--;
-			else if (ret < 0)
-				unprocess_pkts[unprocess_num++] = pkts[i];
+		} else if (IS_IPV6_TCP_PKT(pkts[i]->packet_type) &&
+				do_tcp6_gro) {
+			ret = gro_tcp6_reassemble(pkts[i], &tcp6_tbl, 0);
+		} else if (IS_IPV4_UDP_FRAG_PKT(pkts[i]->packet_type) &&
+				do_udp4_gro) {
+			ret = gro_udp4_reassemble(pkts[i], &udp_tbl, 0);
 		} else
+			ret = -1;
+
+		if (ret > 0)
+			/* merge successfully */
+			nb_after_gro--;
+		else if (ret < 0)
 			unprocess_pkts[unprocess_num++] = pkts[i];
 	}
 
@@ -202,16 +323,33 @@ rte_gro_reassemble_burst(struct rte_mbuf **pkts,
 			i = gro_vxlan_tcp4_tbl_timeout_flush(&vxlan_tbl,
 					0, pkts, nb_pkts);
 		}
+		if (do_vxlan6_gro) {
+			i += gro_vxlan_tcp6_tbl_timeout_flush(&vxlan6_tbl,
+					0, &pkts[i], nb_pkts - i);
+		}
 		if (do_tcp4_gro) {
 			i += gro_tcp4_tbl_timeout_flush(&tcp_tbl, 0,
 					&pkts[i], nb_pkts - i);
 		}
+		if (do_tcp6_gro) {
+			i += gro_tcp6_tbl_timeout_flush(&tcp6_tbl, 0,
+					&pkts[i], nb_pkts - i);
+		}
+		if (do_udp4_gro) {
+			i += gro_udp4_tbl_timeout_flush(&udp_tbl, 0,
+					&pkts[i], nb_pkts - i);
+		}
 		/* Copy unprocessed packets */
 		if (unprocess_num > 0) {
 			memcpy(&pkts[i], unprocess_pkts,
 					sizeof(struct rte_mbuf *) *
 					unprocess_num);
 		}
+		/*
+		 * UDP/IPv4 GRO may merge stored fragments together, so
+		 * count the packets that are left.
+		 */
+		nb_after_gro = i + unprocess_num;
 	}
 
 	return nb_after_gro;
@@ -224,37 +362,60 @@ rte_gro_reassemble(struct rte_mbuf **pkts,
 {
 	struct rte_mbuf *unprocess_pkts[nb_pkts];
 	struct gro_ctx *gro_ctx = ctx;
-	void *tcp_tbl, *vxlan_tbl;
+	void *tcp_tbl, *vxlan_tbl, *tcp6_tbl, *vxlan6_tbl, *udp_tbl;
 	uint64_t current_time;
 	uint16_t i, unprocess_num = 0;
-	uint8_t do_tcp4_gro, do_vxlan_gro;
+	uint8_t do_tcp4_gro, do_vxlan_gro, do_tcp6_gro, do_vxlan6_gro,
+		do_udp4_gro;
+	int32_t ret;
 
-	if (unlikely((gro_ctx->gro_types & (RTE_GRO_IPV4_VXLAN_TCP_IPV4 |
-					RTE_GRO_TCP_IPV4)) == 0))
+	if (unlikely((gro_ctx->gro_types & GRO_SUPPORTED_TYPES) == 0))
 		return nb_pkts;
 
 	tcp_tbl = gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX];
 	vxlan_tbl = gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX];
+	tcp6_tbl = gro_ctx->tbls[RTE_GRO_TCP_IPV6_INDEX];
+	vxlan6_tbl = gro_ctx->tbls[RTE_GRO_IPV4_VXLAN_TCP_IPV6_INDEX];
+	udp_tbl = gro_ctx->tbls[RTE_GRO_UDP_IPV4_INDEX];
 
 	do_tcp4_gro = (gro_ctx->gro_types & RTE_GRO_TCP_IPV4) ==
 		RTE_GRO_TCP_IPV4;
 	do_vxlan_gro = (gro_ctx->gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV4) ==
 		RTE_GRO_IPV4_VXLAN_TCP_IPV4;
+	do_tcp6_gro = (gro_ctx->gro_types & RTE_GRO_TCP_IPV6) ==
+		RTE_GRO_TCP_IPV6;
+	do_vxlan6_gro = (gro_ctx->gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV6) ==
+		RTE_GRO_IPV4_VXLAN_TCP_IPV6;
+	do_udp4_gro = (gro_ctx->gro_types & RTE_GRO_UDP_IPV4) ==
+		RTE_GRO_UDP_IPV4;
 
 	current_time = rte_rdtsc();
 
 	for (i = 0; i < nb_pkts; i++) {
 		if (IS_IPV4_VXLAN_TCP4_PKT(pkts[i]->packet_type) &&
 				do_vxlan_gro) {
-			if (gro_vxlan_tcp4_reassemble(pkts[i], vxlan_tbl,
-						current_time) < 0)
-				unprocess_pkts[unprocess_num++] = pkts[i];
+			ret = gro_vxlan_tcp4_reassemble(pkts[i], vxlan_tbl,
+					current_time);
+		} else if (IS_IPV4_VXLAN_TCP6_PKT(pkts[i]->packet_type) &&
+				do_vxlan6_gro) {
+			ret = gro_vxlan_tcp6_reassemble(pkts[i], vxlan6_tbl,
+					current_time);
 		} else if (IS_IPV4_TCP_PKT(pkts[i]->packet_type) &&
 				do_tcp4_gro) {
-			if (gro_tcp4_reassemble(pkts[i], tcp_tbl,
-						current_time) < 0)
-				unprocess_pkts[unprocess_num++] = pkts[i];
+			ret = gro_tcp4_reassemble(pkts[i], tcp_tbl,
+					current_time);
+		} else if (IS_IPV6_TCP_PKT(pkts[i]->packet_type) &&
+				do_tcp6_gro) {
+			ret = gro_tcp6_reassemble(pkts[i], tcp6_tbl,
+					current_time);
+		} else if (IS_IPV4_UDP_FRAG_PKT(pkts[i]->packet_type) &&
+				do_udp4_gro) {
+			ret = gro_udp4_reassemble(pkts[i], udp_tbl,
+					current_time);
 		} else
+			ret = -1;
+
+		if (ret < 0)
 			unprocess_pkts[unprocess_num++] = pkts[i];
 	}
 	if (unprocess_num > 0) {
@@ -283,15 +444,34 @@ rte_gro_timeout_flush(void *ctx,
 		num = gro_vxlan_tcp4_tbl_timeout_flush(gro_ctx->tbls[
 				RTE_GRO_IPV4_VXLAN_TCP_IPV4_INDEX],
 				flush_timestamp, out, max_nb_out);
-		max_nb_out -= num;
 	}
 
 	/* If no available space in 'out', stop flushing. */
-	if ((gro_types & RTE_GRO_TCP_IPV4) && max_nb_out > 0) {
+	if ((gro_types & RTE_GRO_IPV4_VXLAN_TCP_IPV6) && max_nb_out > num) {
+		num += gro_vxlan_tcp6_tbl_timeout_flush(gro_ctx->tbls[
+				RTE_GRO_IPV4_VXLAN_TCP_IPV6_INDEX],
+				flush_timestamp, &out[num], max_nb_out - num);
+	}
+
+	if ((gro_types & RTE_GRO_TCP_IPV4) && max_nb_out > num) {
 		num += gro_tcp4_tbl_timeout_flush(
 				gro_ctx->tbls[RTE_GRO_TCP_IPV4_INDEX],
 				flush_timestamp,
-				&out[num], max_nb_out);
+				&out[num], max_nb_out - num);
+	}
+
+	if ((gro_types & RTE_GRO_TCP_IPV6) && max_nb_out > num) {
+		num += gro_tcp6_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_TCP_IPV6_INDEX],
+				flush_timestamp,
+				&out[num], max_nb_out - num);
+	}
+
+	if ((gro_types & RTE_GRO_UDP_IPV4) && max_nb_out > num) {
+		num += gro_udp4_tbl_timeout_flush(
+				gro_ctx->tbls[RTE_GRO_UDP_IPV4_INDEX],
+				flush_timestamp,
+				&out[num], max_nb_out - num);
 	}
 
 	return num;
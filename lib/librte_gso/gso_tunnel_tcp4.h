@@ -9,10 +9,10 @@
 #include <rte_mbuf.h>
 
 /**
- * Segment a tunneling packet with inner TCP/IPv4 headers. This function
- * doesn't check if the input packet has correct checksums, and doesn't
- * update checksums for output GSO segments. Furthermore, it doesn't
- * process IP fragment packets.
+ * Segment a tunneling packet with inner TCP/IPv4 headers, and outer
+ * IPv4 or IPv6 headers. This function doesn't check if the input packet
+ * has correct checksums, and doesn't update checksums for output GSO
+ * segments. Furthermore, it doesn't process IP fragment packets.
  *
  * @param pkt
  *  The packet mbuf to segment.
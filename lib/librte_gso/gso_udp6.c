@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_random.h>
+
+#include "gso_common.h"
+#include "gso_udp6.h"
+
+#define IPV6_FRAG_MF_BIT 1U
+
+/* IPv6 fragment extension header */
+struct ipv6_frag_hdr {
+	uint8_t next_header;
+	uint8_t reserved;
+	/* fragment offset in bytes, with the M flag as lowest bit */
+	uint16_t frag_data;
+	uint32_t id;
+} __attribute__((__packed__));
+
+static inline int
+update_ipv6_udp_headers(struct rte_mbuf *pkt, struct rte_mbuf **segs,
+		uint16_t nb_segs)
+{
+	struct rte_ipv6_hdr *ipv6_hdr;
+	struct ipv6_frag_hdr *frag_hdr;
+	uint16_t frag_offset = 0, is_mf;
+	uint16_t l2_hdrlen = pkt->l2_len, l3_hdrlen = pkt->l3_len;
+	uint16_t tail_idx = nb_segs - 1, i;
+	uint32_t id = (uint32_t)rte_rand();
+	uint8_t proto;
+	char *hdr;
+
+	ipv6_hdr = rte_pktmbuf_mtod_offset(pkt, struct rte_ipv6_hdr *,
+			l2_hdrlen);
+	proto = ipv6_hdr->proto;
+
+	/*
+	 * Insert a fragment header after the IPv6 header of the output
+	 * segments. All the fragments share the same identification, and
+	 * only the first one has the UDP header.
+	 */
+	for (i = 0; i < nb_segs; i++) {
+		hdr = rte_pktmbuf_prepend(segs[i], sizeof(*frag_hdr));
+		if (unlikely(hdr == NULL))
+			return -ENOMEM;
+		memmove(hdr, hdr + sizeof(*frag_hdr), l2_hdrlen + l3_hdrlen);
+		segs[i]->l3_len += sizeof(*frag_hdr);
+
+		ipv6_hdr = (struct rte_ipv6_hdr *)(hdr + l2_hdrlen);
+		ipv6_hdr->proto = IPPROTO_FRAGMENT;
+		ipv6_hdr->payload_len = rte_cpu_to_be_16(segs[i]->pkt_len -
+				l2_hdrlen - l3_hdrlen);
+
+		is_mf = i < tail_idx ? IPV6_FRAG_MF_BIT : 0;
+		frag_hdr = (struct ipv6_frag_hdr *)(hdr + l2_hdrlen +
+				l3_hdrlen);
+		frag_hdr->next_header = proto;
+		frag_hdr->reserved = 0;
+		frag_hdr->frag_data = rte_cpu_to_be_16(frag_offset | is_mf);
+		frag_hdr->id = rte_cpu_to_be_32(id);
+		frag_offset += segs[i]->pkt_len - l2_hdrlen - l3_hdrlen -
+			sizeof(*frag_hdr);
+	}
+	return 0;
+}
+
+int
+gso_udp6_segment(struct rte_mbuf *pkt,
+		uint16_t gso_size,
+		struct rte_mempool *direct_pool,
+		struct rte_mempool *indirect_pool,
+		struct rte_mbuf **pkts_out,
+		uint16_t nb_pkts_out)
+{
+	uint16_t pyld_unit_size, hdr_offset, i;
+	int ret;
+
+	/*
+	 * Don't process the packet with extension headers, including the
+	 * fragmented packet: the fragment header would have to be inserted
+	 * among them.
+	 */
+	if (unlikely(pkt->l3_len != sizeof(struct rte_ipv6_hdr))) {
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	/*
+	 * As for UDP/IPv4, UDP fragmentation is the same as IP
+	 * fragmentation. Except the first one, other output packets
+	 * just have l2, l3 and fragment headers.
+	 */
+	hdr_offset = pkt->l2_len + pkt->l3_len;
+
+	/* Don't process the packet without data. */
+	if (unlikely(hdr_offset + pkt->l4_len >= pkt->pkt_len)) {
+		pkts_out[0] = pkt;
+		return 1;
+	}
+
+	/* The fragments carry multiples of 8 bytes, except the last one */
+	if (unlikely(gso_size < hdr_offset + sizeof(struct ipv6_frag_hdr) +
+				8))
+		return -EINVAL;
+	pyld_unit_size = RTE_ALIGN_FLOOR(gso_size - hdr_offset -
+			sizeof(struct ipv6_frag_hdr), 8);
+
+	/* Segment the payload */
+	ret = gso_do_segment(pkt, hdr_offset, pyld_unit_size, direct_pool,
+			indirect_pool, pkts_out, nb_pkts_out);
+	if (ret > 1 && update_ipv6_udp_headers(pkt, pkts_out, ret) < 0) {
+		for (i = 0; i < ret; i++)
+			rte_pktmbuf_free(pkts_out[i]);
+		return -ENOMEM;
+	}
+
+	return ret;
+}
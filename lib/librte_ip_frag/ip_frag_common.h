@@ -5,6 +5,11 @@
 #ifndef _IP_FRAG_COMMON_H_
 #define _IP_FRAG_COMMON_H_
 
+#include <rte_prefetch.h>
+#if defined(RTE_ARCH_X86)
+#include <rte_vect.h>
+#endif
+
 #include "rte_ip_frag.h"
 
 /* logging macros. */
@@ -31,6 +36,36 @@
 #define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	do {} while (0)
 #endif /* IP_FRAG_TBL_STAT */
 
+/*
+ * The table entries are indexed by a cuckoo hash: each key may be stored
+ * in two buckets of IP_FRAG_HASH_BUCKET_ENTRIES entries, which keep the
+ * 16 most significant bits of the key hash as signature and the index of
+ * the entry in tbl->pkt[]. The index has twice as many entries as the
+ * table, so that the displacements are rare.
+ */
+#define	IP_FRAG_HASH_BUCKET_ENTRIES	8
+#define	IP_FRAG_HASH_FULL_BUCKET	\
+	((1U << IP_FRAG_HASH_BUCKET_ENTRIES) - 1)
+#define	IP_FRAG_HASH_INVALID_POS	UINT32_MAX
+/* max number of buckets visited to find a cuckoo displacement path */
+#define	IP_FRAG_HASH_MAX_BFS		64
+
+struct ip_frag_hash_bucket {
+	uint16_t sig[IP_FRAG_HASH_BUCKET_ENTRIES];  /**< key signatures */
+	uint32_t idx[IP_FRAG_HASH_BUCKET_ENTRIES];  /**< entry indexes */
+	uint32_t used_mask;                         /**< used entries */
+} __rte_cache_aligned;
+
+#define	IP_FRAG_HASH_SIG(hash)		((uint16_t)((hash) >> 16))
+#define	IP_FRAG_HASH_PRIM(tbl, hash)	((hash) & (tbl)->entry_mask)
+#define	IP_FRAG_HASH_ALT(tbl, bkt, sig)	\
+	(((bkt) ^ (sig)) & (tbl)->entry_mask)
+
+/* timer wheel slot of a table entry */
+#define	IP_FRAG_TW_SLOT(tbl, fp)	\
+	(&(tbl)->timer_wheel[((fp)->start >> (tbl)->tw_shift) & \
+		(IP_FRAG_TIMER_WHEEL_SLOTS - 1)])
+
 /* internal functions declarations */
 struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
 		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
@@ -38,11 +73,16 @@ struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
 
 struct ip_frag_pkt * ip_frag_find(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
-		const struct ip_frag_key *key, uint64_t tms);
+		const struct ip_frag_key *key, uint32_t hash, uint64_t tms);
 
 struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+	const struct ip_frag_key *key, uint32_t hash);
+
+uint32_t ip_frag_hash(const struct ip_frag_key *key);
+
+uint32_t ip_frag_tbl_expire(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms,
+		uint32_t max_del);
 
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf *ipv4_frag_reassemble(struct ip_frag_pkt *fp);
@@ -122,14 +162,60 @@ ip_frag_free_immediate(struct ip_frag_pkt *fp)
 	fp->last_idx = 0;
 }
 
+/*
+ * misc hash index functions
+ */
+
+/* prefetch the first bucket of a key */
+static inline void
+ip_frag_hash_prefetch(const struct rte_ip_frag_tbl *tbl, uint32_t hash)
+{
+	rte_prefetch0(tbl->hash + IP_FRAG_HASH_PRIM(tbl, hash));
+}
+
+/*
+ * Return the bitmask of the used entries of a bucket whose signature
+ * matches, comparing all the signatures of the bucket at once.
+ */
+static inline uint32_t
+ip_frag_hash_match(const struct ip_frag_hash_bucket *b, uint16_t sig)
+{
+#if defined(RTE_ARCH_X86)
+	__m128i cmp;
+
+	cmp = _mm_cmpeq_epi16(_mm_load_si128((const __m128i *)b->sig),
+			_mm_set1_epi16(sig));
+	return _mm_movemask_epi8(_mm_packs_epi16(cmp, _mm_setzero_si128())) &
+		b->used_mask;
+#else
+	uint32_t i, hits = 0;
+
+	for (i = 0; i < IP_FRAG_HASH_BUCKET_ENTRIES; i++)
+		hits |= (uint32_t)(b->sig[i] == sig) << i;
+	return hits & b->used_mask;
+#endif
+}
+
+/* remove the entry from the hash index and the timer wheel, free it */
+static inline void
+ip_frag_tbl_release(struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp)
+{
+	uint32_t pos = fp->hash_pos;
+
+	tbl->hash[pos / IP_FRAG_HASH_BUCKET_ENTRIES].used_mask &=
+		~(1U << (pos % IP_FRAG_HASH_BUCKET_ENTRIES));
+	TAILQ_REMOVE(IP_FRAG_TW_SLOT(tbl, fp), fp, timer);
+	tbl->use_entries--;
+	tbl->free_idx[tbl->nb_entries - tbl->use_entries - 1] =
+		fp - tbl->pkt;
+}
+
 /* if key is empty, mark key as in use */
 static inline void
-ip_frag_inuse(struct rte_ip_frag_tbl *tbl, const struct  ip_frag_pkt *fp)
+ip_frag_inuse(struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp)
 {
-	if (ip_frag_key_is_empty(&fp->key)) {
-		TAILQ_REMOVE(&tbl->lru, fp, lru);
-		tbl->use_entries--;
-	}
+	if (ip_frag_key_is_empty(&fp->key))
+		ip_frag_tbl_release(tbl, fp);
 }
 
 /* reset the fragment */
@@ -157,8 +243,7 @@ ip_frag_tbl_del(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 {
 	ip_frag_free(fp, dr);
 	ip_frag_key_invalidate(&fp->key);
-	TAILQ_REMOVE(&tbl->lru, fp, lru);
-	tbl->use_entries--;
+	ip_frag_tbl_release(tbl, fp);
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, del_num, 1);
 }
 
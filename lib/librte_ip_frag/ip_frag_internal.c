@@ -11,18 +11,11 @@
 
 #define	PRIME_VALUE	0xeaad8405
 
-#define	IP_FRAG_TBL_POS(tbl, sig)	\
-	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
-
+/* add an entry to the timer wheel slot of its creation time */
 static inline void
-ip_frag_tbl_add(struct rte_ip_frag_tbl *tbl,  struct ip_frag_pkt *fp,
-	const struct ip_frag_key *key, uint64_t tms)
+ip_frag_tw_add(struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp)
 {
-	fp->key = key[0];
-	ip_frag_reset(fp, tms);
-	TAILQ_INSERT_TAIL(&tbl->lru, fp, lru);
-	tbl->use_entries++;
-	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, add_num, 1);
+	TAILQ_INSERT_TAIL(IP_FRAG_TW_SLOT(tbl, fp), fp, timer);
 }
 
 static inline void
@@ -30,15 +23,253 @@ ip_frag_tbl_reuse(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	struct ip_frag_pkt *fp, uint64_t tms)
 {
 	ip_frag_free(fp, dr);
+	TAILQ_REMOVE(IP_FRAG_TW_SLOT(tbl, fp), fp, timer);
 	ip_frag_reset(fp, tms);
-	TAILQ_REMOVE(&tbl->lru, fp, lru);
-	TAILQ_INSERT_TAIL(&tbl->lru, fp, lru);
+	ip_frag_tw_add(tbl, fp);
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, reuse_num, 1);
 }
 
-
+/* move the entry of the hash index at position src to position dst */
 static inline void
-ipv4_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+ip_frag_hash_move(struct rte_ip_frag_tbl *tbl, uint32_t src_bkt,
+	uint32_t src, uint32_t dst_bkt, uint32_t dst)
+{
+	struct ip_frag_hash_bucket *s, *d;
+
+	s = tbl->hash + src_bkt;
+	d = tbl->hash + dst_bkt;
+
+	d->sig[dst] = s->sig[src];
+	d->idx[dst] = s->idx[src];
+	d->used_mask |= 1U << dst;
+	s->used_mask &= ~(1U << src);
+	tbl->pkt[d->idx[dst]].hash_pos =
+		dst_bkt * IP_FRAG_HASH_BUCKET_ENTRIES + dst;
+}
+
+/*
+ * Make room in one of the two buckets of a key, whose both buckets are
+ * full, moving entries to their alternative buckets.
+ * The displacement path is searched breadth first, so that it's
+ * as short as possible.
+ * Return the position of the free entry, or IP_FRAG_HASH_INVALID_POS.
+ */
+static uint32_t
+ip_frag_hash_make_space(struct rte_ip_frag_tbl *tbl, uint32_t bkt1,
+	uint32_t bkt2)
+{
+	struct {
+		uint32_t bkt;     /* bucket to move an entry from */
+		int32_t parent;   /* node whose entry moves to this bucket */
+		uint32_t ent;     /* entry of the parent bucket to move */
+	} q[IP_FRAG_HASH_MAX_BFS];
+	const struct ip_frag_hash_bucket *b;
+	uint32_t head, tail, i, alt, free_mask, dst_bkt, dst, ent;
+	int32_t n;
+
+	q[0].bkt = bkt1;
+	q[0].parent = -1;
+	q[0].ent = 0;
+	q[1].bkt = bkt2;
+	q[1].parent = -1;
+	q[1].ent = 0;
+	tail = (bkt1 != bkt2) ? 2 : 1;
+
+	for (head = 0; head != tail; head++) {
+		b = tbl->hash + q[head].bkt;
+		for (i = 0; i != IP_FRAG_HASH_BUCKET_ENTRIES; i++) {
+			alt = IP_FRAG_HASH_ALT(tbl, q[head].bkt, b->sig[i]);
+			if (alt == q[head].bkt)
+				continue;
+
+			free_mask = ~tbl->hash[alt].used_mask &
+				IP_FRAG_HASH_FULL_BUCKET;
+			if (free_mask != 0) {
+				/* found a path: shift the entries along it */
+				dst_bkt = alt;
+				dst = __builtin_ctz(free_mask);
+				n = head;
+				ent = i;
+				while (n >= 0) {
+					ip_frag_hash_move(tbl, q[n].bkt, ent,
+						dst_bkt, dst);
+					dst_bkt = q[n].bkt;
+					dst = ent;
+					ent = q[n].ent;
+					n = q[n].parent;
+				}
+				return dst_bkt * IP_FRAG_HASH_BUCKET_ENTRIES +
+					dst;
+			}
+
+			if (tail != RTE_DIM(q)) {
+				q[tail].bkt = alt;
+				q[tail].parent = head;
+				q[tail].ent = i;
+				tail++;
+			}
+		}
+	}
+
+	return IP_FRAG_HASH_INVALID_POS;
+}
+
+/*
+ * Add a table entry to the hash index.
+ * Return its position in the index, or IP_FRAG_HASH_INVALID_POS if
+ * there is no room for it.
+ */
+static uint32_t
+ip_frag_hash_add(struct rte_ip_frag_tbl *tbl, uint32_t hash, uint32_t idx)
+{
+	struct ip_frag_hash_bucket *b;
+	uint32_t bkt1, bkt2, pos, free_mask;
+	uint16_t sig;
+
+	sig = IP_FRAG_HASH_SIG(hash);
+	bkt1 = IP_FRAG_HASH_PRIM(tbl, hash);
+	bkt2 = IP_FRAG_HASH_ALT(tbl, bkt1, sig);
+
+	free_mask = ~tbl->hash[bkt1].used_mask & IP_FRAG_HASH_FULL_BUCKET;
+	if (free_mask != 0) {
+		pos = bkt1 * IP_FRAG_HASH_BUCKET_ENTRIES +
+			__builtin_ctz(free_mask);
+	} else {
+		free_mask = ~tbl->hash[bkt2].used_mask &
+			IP_FRAG_HASH_FULL_BUCKET;
+		if (free_mask != 0)
+			pos = bkt2 * IP_FRAG_HASH_BUCKET_ENTRIES +
+				__builtin_ctz(free_mask);
+		else
+			pos = ip_frag_hash_make_space(tbl, bkt1, bkt2);
+	}
+
+	if (pos != IP_FRAG_HASH_INVALID_POS) {
+		b = tbl->hash + pos / IP_FRAG_HASH_BUCKET_ENTRIES;
+		b->sig[pos % IP_FRAG_HASH_BUCKET_ENTRIES] = sig;
+		b->idx[pos % IP_FRAG_HASH_BUCKET_ENTRIES] = idx;
+		b->used_mask |= 1U << (pos % IP_FRAG_HASH_BUCKET_ENTRIES);
+	}
+	return pos;
+}
+
+/*
+ * Look for a timed-out entry in the buckets of a key, and delete it.
+ * Return 1 if an entry was deleted.
+ */
+static int
+ip_frag_hash_del_stale(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint32_t hash, uint64_t tms)
+{
+	const struct ip_frag_hash_bucket *b;
+	struct ip_frag_pkt *fp;
+	uint32_t bkt[2], i, k;
+
+	bkt[0] = IP_FRAG_HASH_PRIM(tbl, hash);
+	bkt[1] = IP_FRAG_HASH_ALT(tbl, bkt[0], IP_FRAG_HASH_SIG(hash));
+
+	for (k = 0; k != RTE_DIM(bkt); k++) {
+		b = tbl->hash + bkt[k];
+		for (i = 0; i != IP_FRAG_HASH_BUCKET_ENTRIES; i++) {
+			fp = tbl->pkt + b->idx[i];
+			if (tbl->max_cycles + fp->start < tms) {
+				ip_frag_tbl_del(tbl, dr, fp);
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+ * Allocate a table entry for the key.
+ * If the table is full, then delete the oldest timed-out entry.
+ */
+static struct ip_frag_pkt *
+ip_frag_tbl_add(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	const struct ip_frag_key *key, uint32_t hash, uint64_t tms)
+{
+	struct ip_frag_pkt *fp;
+	uint32_t idx, pos;
+
+	if (tbl->max_entries <= tbl->use_entries &&
+			ip_frag_tbl_expire(tbl, dr, tms, 1) == 0) {
+		IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, fail_nospace, 1);
+		return NULL;
+	}
+
+	idx = tbl->free_idx[tbl->nb_entries - tbl->use_entries - 1];
+	pos = ip_frag_hash_add(tbl, hash, idx);
+	if (pos == IP_FRAG_HASH_INVALID_POS) {
+		/* no room in the hash index, free a timed-out entry */
+		if (ip_frag_hash_del_stale(tbl, dr, hash, tms) == 0)
+			return NULL;
+		idx = tbl->free_idx[tbl->nb_entries - tbl->use_entries - 1];
+		pos = ip_frag_hash_add(tbl, hash, idx);
+	}
+
+	fp = tbl->pkt + idx;
+	fp->key = key[0];
+	fp->hash_pos = pos;
+	ip_frag_reset(fp, tms);
+	ip_frag_tw_add(tbl, fp);
+	tbl->use_entries++;
+	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, add_num, 1);
+	return fp;
+}
+
+/*
+ * Delete the timed-out entries, oldest first, scanning the timer wheel
+ * slots not expired yet, up to the slot of the current time.
+ * Stop after max_del entries, or when the death row is full.
+ * Return the number of deleted entries.
+ */
+uint32_t
+ip_frag_tbl_expire(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms, uint32_t max_del)
+{
+	struct ip_pkt_list *slot;
+	struct ip_frag_pkt *fp, *next;
+	uint64_t tick, last_tick;
+	uint32_t nb_del;
+
+	if (tms <= tbl->max_cycles)
+		return 0;
+
+	/* entries created before the last tick may be timed-out */
+	last_tick = (tms - tbl->max_cycles) >> tbl->tw_shift;
+	tick = tbl->tw_tick;
+	if (last_tick >= tick &&
+			last_tick - tick >= IP_FRAG_TIMER_WHEEL_SLOTS)
+		tick = last_tick - IP_FRAG_TIMER_WHEEL_SLOTS + 1;
+
+	nb_del = 0;
+	for (; tick <= last_tick; tick++) {
+		slot = tbl->timer_wheel +
+			(tick & (IP_FRAG_TIMER_WHEEL_SLOTS - 1));
+
+		/* the entries of a slot are sorted by creation time */
+		for (fp = TAILQ_FIRST(slot); fp != NULL; fp = next) {
+			next = TAILQ_NEXT(fp, timer);
+			if (tbl->max_cycles + fp->start >= tms)
+				break;
+			if (nb_del == max_del || IP_FRAG_DEATH_ROW_MBUF_LEN -
+					dr->cnt < fp->last_idx)
+				return nb_del;
+			ip_frag_tbl_del(tbl, dr, fp);
+			nb_del++;
+		}
+
+		/* the last tick is not over yet, check it again next time */
+		if (tick != last_tick)
+			tbl->tw_tick = tick + 1;
+	}
+
+	return nb_del;
+}
+
+static inline uint32_t
+ipv4_frag_hash(const struct ip_frag_key *key)
 {
 	uint32_t v;
 	const uint32_t *p;
@@ -54,12 +285,11 @@ ipv4_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 	v = rte_jhash_3words(p[0], p[1], key->id, PRIME_VALUE);
 #endif /* RTE_ARCH_X86 */
 
-	*v1 =  v;
-	*v2 = (v << 7) + (v >> 14);
+	return v;
 }
 
-static inline void
-ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+static inline uint32_t
+ipv6_frag_hash(const struct ip_frag_key *key)
 {
 	uint32_t v;
 	const uint32_t *p;
@@ -83,8 +313,17 @@ ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
 	v = rte_jhash_3words(p[6], p[7], key->id, v);
 #endif /* RTE_ARCH_X86 */
 
-	*v1 =  v;
-	*v2 = (v << 7) + (v >> 14);
+	return v;
+}
+
+/* different hashing methods for IPv4 and IPv6 */
+uint32_t
+ip_frag_hash(const struct ip_frag_key *key)
+{
+	if (key->key_len == IPV4_KEYLEN)
+		return ipv4_frag_hash(key);
+	else
+		return ipv6_frag_hash(key);
 }
 
 struct rte_mbuf *
@@ -221,59 +460,22 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
  */
 struct ip_frag_pkt *
 ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
-	const struct ip_frag_key *key, uint64_t tms)
+	const struct ip_frag_key *key, uint32_t hash, uint64_t tms)
 {
-	struct ip_frag_pkt *pkt, *free, *stale, *lru;
-	uint64_t max_cycles;
-
-	/*
-	 * Actually the two line below are totally redundant.
-	 * they are here, just to make gcc 4.6 happy.
-	 */
-	free = NULL;
-	stale = NULL;
-	max_cycles = tbl->max_cycles;
+	struct ip_frag_pkt *pkt;
 
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
 
-	if ((pkt = ip_frag_lookup(tbl, key, tms, &free, &stale)) == NULL) {
-
-		/*timed-out entry, free and invalidate it*/
-		if (stale != NULL) {
-			ip_frag_tbl_del(tbl, dr, stale);
-			free = stale;
-
-		/*
-		 * we found a free entry, check if we can use it.
-		 * If we run out of free entries in the table, then
-		 * check if we have a timed out entry to delete.
-		 */
-		} else if (free != NULL &&
-				tbl->max_entries <= tbl->use_entries) {
-			lru = TAILQ_FIRST(&tbl->lru);
-			if (max_cycles + lru->start < tms) {
-				ip_frag_tbl_del(tbl, dr, lru);
-			} else {
-				free = NULL;
-				IP_FRAG_TBL_STAT_UPDATE(&tbl->stat,
-					fail_nospace, 1);
-			}
-		}
-
-		/* found a free entry to reuse. */
-		if (free != NULL) {
-			ip_frag_tbl_add(tbl,  free, key, tms);
-			pkt = free;
-		}
+	if ((pkt = ip_frag_lookup(tbl, key, hash)) == NULL)
+		pkt = ip_frag_tbl_add(tbl, dr, key, hash, tms);
 
 	/*
 	 * we found the flow, but it is already timed out,
-	 * so free associated resources, reposition it in the LRU list,
+	 * so free associated resources, reposition it in the timer wheel,
 	 * and reuse it.
 	 */
-	} else if (max_cycles + pkt->start < tms) {
+	else if (tbl->max_cycles + pkt->start < tms)
 		ip_frag_tbl_reuse(tbl, dr, pkt, tms);
-	}
 
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, fail_total, (pkt == NULL));
 
@@ -281,89 +483,47 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	return pkt;
 }
 
+/* look for the key in its two buckets, comparing their signatures first */
 struct ip_frag_pkt *
 ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
+	const struct ip_frag_key *key, uint32_t hash)
 {
-	struct ip_frag_pkt *p1, *p2;
-	struct ip_frag_pkt *empty, *old;
-	uint64_t max_cycles;
-	uint32_t i, assoc, sig1, sig2;
-
-	empty = NULL;
-	old = NULL;
-
-	max_cycles = tbl->max_cycles;
-	assoc = tbl->bucket_entries;
+	const struct ip_frag_hash_bucket *b;
+	struct ip_frag_pkt *fp;
+	uint32_t bkt, hits, i;
+	uint16_t sig;
 
 	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
 		return tbl->last;
 
-	/* different hashing methods for IPv4 and IPv6 */
-	if (key->key_len == IPV4_KEYLEN)
-		ipv4_frag_hash(key, &sig1, &sig2);
-	else
-		ipv6_frag_hash(key, &sig1, &sig2);
-
-	p1 = IP_FRAG_TBL_POS(tbl, sig1);
-	p2 = IP_FRAG_TBL_POS(tbl, sig2);
-
-	for (i = 0; i != assoc; i++) {
-		if (p1->key.key_len == IPV4_KEYLEN)
-			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
-					"tbl: %p, max_entries: %u, use_entries: %u\n"
-					"ipv4_frag_pkt line0: %p, index: %u from %u\n"
-			"key: <%" PRIx64 ", %#x>, start: %" PRIu64 "\n",
-					__func__, __LINE__,
-					tbl, tbl->max_entries, tbl->use_entries,
-					p1, i, assoc,
-			p1[i].key.src_dst[0], p1[i].key.id, p1[i].start);
-		else
-			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
-					"tbl: %p, max_entries: %u, use_entries: %u\n"
-					"ipv6_frag_pkt line0: %p, index: %u from %u\n"
-			"key: <" IPv6_KEY_BYTES_FMT ", %#x>, start: %" PRIu64 "\n",
-					__func__, __LINE__,
-					tbl, tbl->max_entries, tbl->use_entries,
-					p1, i, assoc,
-			IPv6_KEY_BYTES(p1[i].key.src_dst), p1[i].key.id, p1[i].start);
-
-		if (ip_frag_key_cmp(key, &p1[i].key) == 0)
-			return p1 + i;
-		else if (ip_frag_key_is_empty(&p1[i].key))
-			empty = (empty == NULL) ? (p1 + i) : empty;
-		else if (max_cycles + p1[i].start < tms)
-			old = (old == NULL) ? (p1 + i) : old;
-
-		if (p2->key.key_len == IPV4_KEYLEN)
-			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
-					"tbl: %p, max_entries: %u, use_entries: %u\n"
-					"ipv4_frag_pkt line1: %p, index: %u from %u\n"
-			"key: <%" PRIx64 ", %#x>, start: %" PRIu64 "\n",
-					__func__, __LINE__,
-					tbl, tbl->max_entries, tbl->use_entries,
-					p2, i, assoc,
-			p2[i].key.src_dst[0], p2[i].key.id, p2[i].start);
-		else
-			IP_FRAG_LOG(DEBUG, "%s:%d:\n"
-					"tbl: %p, max_entries: %u, use_entries: %u\n"
-					"ipv6_frag_pkt line1: %p, index: %u from %u\n"
-			"key: <" IPv6_KEY_BYTES_FMT ", %#x>, start: %" PRIu64 "\n",
-					__func__, __LINE__,
-					tbl, tbl->max_entries, tbl->use_entries,
-					p2, i, assoc,
-			IPv6_KEY_BYTES(p2[i].key.src_dst), p2[i].key.id, p2[i].start);
-
-		if (ip_frag_key_cmp(key, &p2[i].key) == 0)
-			return p2 + i;
-		else if (ip_frag_key_is_empty(&p2[i].key))
-			empty = (empty == NULL) ?( p2 + i) : empty;
-		else if (max_cycles + p2[i].start < tms)
-			old = (old == NULL) ? (p2 + i) : old;
+	sig = IP_FRAG_HASH_SIG(hash);
+	bkt = IP_FRAG_HASH_PRIM(tbl, hash);
+
+	b = tbl->hash + bkt;
+	hits = ip_frag_hash_match(b, sig);
+	while (hits != 0) {
+		i = __builtin_ctz(hits);
+		fp = tbl->pkt + b->idx[i];
+		if (ip_frag_key_cmp(key, &fp->key) == 0)
+			return fp;
+		hits &= hits - 1;
 	}
 
-	*free = empty;
-	*stale = old;
+	b = tbl->hash + IP_FRAG_HASH_ALT(tbl, bkt, sig);
+	hits = ip_frag_hash_match(b, sig);
+	while (hits != 0) {
+		i = __builtin_ctz(hits);
+		fp = tbl->pkt + b->idx[i];
+		if (ip_frag_key_cmp(key, &fp->key) == 0)
+			return fp;
+		hits &= hits - 1;
+	}
+
+	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
+		"tbl: %p, max_entries: %u, use_entries: %u\n"
+		"key not found, hash: %#x\n",
+		__func__, __LINE__,
+		tbl, tbl->max_entries, tbl->use_entries, hash);
+
 	return NULL;
 }
@@ -62,12 +62,13 @@ struct ip_frag_key {
  * First two entries in the frags[] array are for the last and first fragments.
  */
 struct ip_frag_pkt {
-	TAILQ_ENTRY(ip_frag_pkt) lru;   /**< LRU list */
+	TAILQ_ENTRY(ip_frag_pkt) timer;   /**< timer wheel slot list */
 	struct ip_frag_key key;           /**< fragmentation key */
 	uint64_t             start;       /**< creation timestamp */
 	uint32_t             total_size;  /**< expected reassembled size */
 	uint32_t             frag_size;   /**< size of fragments received */
 	uint32_t             last_idx;    /**< index of next entry to fill */
+	uint32_t             hash_pos;    /**< position in the hash index */
 	struct ip_frag       frags[IP_MAX_FRAG_NUM]; /**< fragments */
 } __rte_cache_aligned;
 
@@ -85,6 +86,11 @@ struct rte_ip_frag_death_row {
 
 TAILQ_HEAD(ip_pkt_list, ip_frag_pkt); /**< @internal fragments tailq */
 
+/** @internal number of slots of the timer wheel, power of two */
+#define IP_FRAG_TIMER_WHEEL_SLOTS 256
+
+struct ip_frag_hash_bucket;
+
 /** fragmentation table statistics */
 struct ip_frag_tbl_stat {
 	uint64_t find_num;      /**< total # of find/insert attempts. */
@@ -105,7 +111,12 @@ struct rte_ip_frag_tbl {
 	uint32_t             nb_entries;      /**< total size of the table. */
 	uint32_t             nb_buckets;      /**< num of associativity lines. */
 	struct ip_frag_pkt *last;         /**< last used entry. */
-	struct ip_pkt_list lru;           /**< LRU list for table entries. */
+	struct ip_frag_hash_bucket *hash; /**< cuckoo hash index of entries. */
+	uint32_t *free_idx;               /**< stack of the free entries. */
+	uint32_t tw_shift;                /**< log2 of cycles per wheel slot. */
+	uint64_t tw_tick;                 /**< first wheel tick not expired. */
+	struct ip_pkt_list timer_wheel[IP_FRAG_TIMER_WHEEL_SLOTS];
+	/**< table entries sorted by creation time. */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
 	__extension__ struct ip_frag_pkt pkt[0]; /**< hash table. */
 };
@@ -295,6 +306,36 @@ struct rte_mbuf * rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		struct rte_mbuf *mb, uint64_t tms, struct rte_ipv4_hdr *ip_hdr);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * This function implements reassembly of a burst of IPv4 packets.
+ * The keys of all the fragments are hashed first, and their hash
+ * buckets prefetched, before they are added to the table.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to. It should have room for the mbufs
+ *   freed while processing nb_pkts packets, e.g. it should be empty
+ *   if nb_pkts is IP_FRAG_DEATH_ROW_LEN.
+ * @param pkts
+ *   Incoming IPv4 packets. On return, it holds the packets which are
+ *   not fragmented, and the reassembled packets.
+ * @param nb_pkts
+ *   Number of incoming packets.
+ * @param tms
+ *   Packets arrival timestamp.
+ * @return
+ *   Number of packets returned in pkts.
+ */
+__rte_experimental
+uint16_t rte_ipv4_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts,
+		uint16_t nb_pkts, uint64_t tms);
+
 /**
  * Check if the IPv4 packet is fragmented
  *
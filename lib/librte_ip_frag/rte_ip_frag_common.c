@@ -42,8 +42,9 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	uint32_t max_entries, uint64_t max_cycles, int socket_id)
 {
 	struct rte_ip_frag_tbl *tbl;
-	size_t sz;
-	uint64_t nb_entries;
+	size_t sz, hash_ofs, free_ofs;
+	uint64_t nb_entries, tw_cycles;
+	uint32_t i, nb_hash_buckets;
 
 	nb_entries = rte_align32pow2(bucket_num);
 	nb_entries *= bucket_entries;
@@ -57,7 +58,14 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 		return NULL;
 	}
 
-	sz = sizeof (*tbl) + nb_entries * sizeof (tbl->pkt[0]);
+	/* the hash index has twice as many entries as the table */
+	nb_hash_buckets = RTE_MAX(nb_entries * IP_FRAG_HASH_FNUM /
+		IP_FRAG_HASH_BUCKET_ENTRIES, 1UL);
+
+	hash_ofs = sizeof(*tbl) + nb_entries * sizeof(tbl->pkt[0]);
+	free_ofs = hash_ofs + nb_hash_buckets *
+		sizeof(struct ip_frag_hash_bucket);
+	sz = free_ofs + nb_entries * sizeof(tbl->free_idx[0]);
 	if ((tbl = rte_zmalloc_socket(__func__, sz, RTE_CACHE_LINE_SIZE,
 			socket_id)) == NULL) {
 		RTE_LOG(ERR, USER1,
@@ -74,9 +82,20 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	tbl->nb_entries = (uint32_t)nb_entries;
 	tbl->nb_buckets = bucket_num;
 	tbl->bucket_entries = bucket_entries;
-	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
+	tbl->entry_mask = nb_hash_buckets - 1;
+	tbl->hash = RTE_PTR_ADD(tbl, hash_ofs);
+	tbl->free_idx = RTE_PTR_ADD(tbl, free_ofs);
+
+	/* allocate the entries in order */
+	for (i = 0; i != tbl->nb_entries; i++)
+		tbl->free_idx[i] = tbl->nb_entries - i - 1;
+
+	/* the timer wheel spans at least twice the entries ttl */
+	tw_cycles = RTE_MAX(max_cycles * 2 / IP_FRAG_TIMER_WHEEL_SLOTS, 1UL);
+	tbl->tw_shift = rte_log2_u64(tw_cycles);
+	for (i = 0; i != IP_FRAG_TIMER_WHEEL_SLOTS; i++)
+		TAILQ_INIT(&tbl->timer_wheel[i]);
 
-	TAILQ_INIT(&(tbl->lru));
 	return tbl;
 }
 
@@ -85,10 +104,11 @@ void
 rte_ip_frag_table_destroy(struct rte_ip_frag_tbl *tbl)
 {
 	struct ip_frag_pkt *fp;
+	uint32_t i;
 
-	TAILQ_FOREACH(fp, &tbl->lru, lru) {
-		ip_frag_free_immediate(fp);
-	}
+	for (i = 0; i != IP_FRAG_TIMER_WHEEL_SLOTS; i++)
+		TAILQ_FOREACH(fp, &tbl->timer_wheel[i], timer)
+			ip_frag_free_immediate(fp);
 
 	rte_free(tbl);
 }
@@ -127,18 +147,5 @@ void
 rte_frag_table_del_expired_entries(struct rte_ip_frag_tbl *tbl,
 	struct rte_ip_frag_death_row *dr, uint64_t tms)
 {
-	uint64_t max_cycles;
-	struct ip_frag_pkt *fp;
-
-	max_cycles = tbl->max_cycles;
-
-	TAILQ_FOREACH(fp, &tbl->lru, lru)
-		if (max_cycles + fp->start < tms) {
-			/* check that death row has enough space */
-			if (IP_FRAG_DEATH_ROW_MBUF_LEN - dr->cnt >= fp->last_idx)
-				ip_frag_tbl_del(tbl, dr, fp);
-			else
-				return;
-		} else
-			return;
+	ip_frag_tbl_expire(tbl, dr, tms, UINT32_MAX);
 }
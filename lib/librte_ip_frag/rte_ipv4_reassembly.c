@@ -78,45 +78,46 @@ ipv4_frag_reassemble(struct ip_frag_pkt *fp)
 	return m;
 }
 
-/*
- * Process new mbuf with fragment of IPV4 packet.
- * Incoming mbuf should have it's l2_len/l3_len fields setuped correclty.
- * @param tbl
- *   Table where to lookup/add the fragmented packet.
- * @param mb
- *   Incoming mbuf with IPV4 fragment.
- * @param tms
- *   Fragment arrival timestamp.
- * @param ip_hdr
- *   Pointer to the IPV4 header inside the fragment.
- * @return
- *   Pointer to mbuf for reassembled packet, or NULL if:
- *   - an error occurred.
- *   - not all fragments of the packet are collected yet.
- */
-struct rte_mbuf *
-rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
-	struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb, uint64_t tms,
-	struct rte_ipv4_hdr *ip_hdr)
-{
-	struct ip_frag_pkt *fp;
+/* fragment parameters, computed before the table lookup */
+struct ipv4_frag_info {
 	struct ip_frag_key key;
+	uint32_t hash;
+	int32_t len;
+	uint16_t ofs;
+	uint16_t flag;
+};
+
+static inline void
+ipv4_frag_info_get(struct ipv4_frag_info *fi, const struct rte_mbuf *mb,
+	const struct rte_ipv4_hdr *ip_hdr)
+{
 	const unaligned_uint64_t *psd;
-	uint16_t flag_offset, ip_ofs, ip_flag;
-	int32_t ip_len;
+	uint16_t flag_offset;
 
 	flag_offset = rte_be_to_cpu_16(ip_hdr->fragment_offset);
-	ip_ofs = (uint16_t)(flag_offset & RTE_IPV4_HDR_OFFSET_MASK);
-	ip_flag = (uint16_t)(flag_offset & RTE_IPV4_HDR_MF_FLAG);
+	fi->ofs = (uint16_t)(flag_offset & RTE_IPV4_HDR_OFFSET_MASK);
+	fi->flag = (uint16_t)(flag_offset & RTE_IPV4_HDR_MF_FLAG);
 
-	psd = (unaligned_uint64_t *)&ip_hdr->src_addr;
+	psd = (const unaligned_uint64_t *)&ip_hdr->src_addr;
 	/* use first 8 bytes only */
-	key.src_dst[0] = psd[0];
-	key.id = ip_hdr->packet_id;
-	key.key_len = IPV4_KEYLEN;
+	fi->key.src_dst[0] = psd[0];
+	fi->key.id = ip_hdr->packet_id;
+	fi->key.key_len = IPV4_KEYLEN;
+
+	fi->ofs *= RTE_IPV4_HDR_OFFSET_UNITS;
+	fi->len = rte_be_to_cpu_16(ip_hdr->total_length) - mb->l3_len;
+	fi->hash = ip_frag_hash(&fi->key);
+}
 
-	ip_ofs *= RTE_IPV4_HDR_OFFSET_UNITS;
-	ip_len = rte_be_to_cpu_16(ip_hdr->total_length) - mb->l3_len;
+/*
+ * Add the fragment to the table entry of its datagram, and reassemble
+ * the datagram once all its fragments are collected.
+ */
+static inline struct rte_mbuf *
+ipv4_frag_add(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	struct rte_mbuf *mb, uint64_t tms, const struct ipv4_frag_info *fi)
+{
+	struct ip_frag_pkt *fp;
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
 		"mbuf: %p, tms: %" PRIu64
@@ -124,18 +125,18 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		"tbl: %p, max_cycles: %" PRIu64 ", entry_mask: %#x, "
 		"max_entries: %u, use_entries: %u\n\n",
 		__func__, __LINE__,
-		mb, tms, key.src_dst[0], key.id, ip_ofs, ip_len, ip_flag,
-		tbl, tbl->max_cycles, tbl->entry_mask, tbl->max_entries,
-		tbl->use_entries);
+		mb, tms, fi->key.src_dst[0], fi->key.id, fi->ofs, fi->len,
+		fi->flag, tbl, tbl->max_cycles, tbl->entry_mask,
+		tbl->max_entries, tbl->use_entries);
 
 	/* check that fragment length is greater then zero. */
-	if (ip_len <= 0) {
+	if (fi->len <= 0) {
 		IP_FRAG_MBUF2DR(dr, mb);
 		return NULL;
 	}
 
 	/* try to find/add entry into the fragment's table. */
-	if ((fp = ip_frag_find(tbl, dr, &key, tms)) == NULL) {
+	if ((fp = ip_frag_find(tbl, dr, &fi->key, fi->hash, tms)) == NULL) {
 		IP_FRAG_MBUF2DR(dr, mb);
 		return NULL;
 	}
@@ -151,7 +152,7 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len, ip_flag);
+	mb = ip_frag_process(fp, dr, mb, fi->ofs, fi->len, fi->flag);
 	ip_frag_inuse(tbl, fp);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -166,3 +167,73 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return mb;
 }
+
+/*
+ * Process new mbuf with fragment of IPV4 packet.
+ * Incoming mbuf should have it's l2_len/l3_len fields setuped correclty.
+ * @param tbl
+ *   Table where to lookup/add the fragmented packet.
+ * @param mb
+ *   Incoming mbuf with IPV4 fragment.
+ * @param tms
+ *   Fragment arrival timestamp.
+ * @param ip_hdr
+ *   Pointer to the IPV4 header inside the fragment.
+ * @return
+ *   Pointer to mbuf for reassembled packet, or NULL if:
+ *   - an error occurred.
+ *   - not all fragments of the packet are collected yet.
+ */
+struct rte_mbuf *
+rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb, uint64_t tms,
+	struct rte_ipv4_hdr *ip_hdr)
+{
+	struct ipv4_frag_info fi;
+
+	ipv4_frag_info_get(&fi, mb, ip_hdr);
+	return ipv4_frag_add(tbl, dr, mb, tms, &fi);
+}
+
+/*
+ * Process a burst of IPV4 packets: the keys of the fragments are computed
+ * and their hash buckets prefetched first, then the fragments are added
+ * to the table. The packets which are not fragmented are kept.
+ */
+uint16_t
+rte_ipv4_frag_reassemble_burst(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts,
+	uint16_t nb_pkts, uint64_t tms)
+{
+	struct ipv4_frag_info fi[IP_FRAG_DEATH_ROW_LEN];
+	struct rte_ipv4_hdr *ip_hdr;
+	struct rte_mbuf *mb;
+	uint16_t i, j, n, nb_out;
+
+	nb_out = 0;
+	for (i = 0; i != nb_pkts; i += n) {
+		n = RTE_MIN(nb_pkts - i, IP_FRAG_DEATH_ROW_LEN);
+
+		for (j = 0; j != n; j++) {
+			mb = pkts[i + j];
+			ip_hdr = rte_pktmbuf_mtod_offset(mb,
+				struct rte_ipv4_hdr *, mb->l2_len);
+			if (rte_ipv4_frag_pkt_is_fragmented(ip_hdr)) {
+				ipv4_frag_info_get(&fi[j], mb, ip_hdr);
+				ip_frag_hash_prefetch(tbl, fi[j].hash);
+			} else {
+				ip_frag_key_invalidate(&fi[j].key);
+			}
+		}
+
+		for (j = 0; j != n; j++) {
+			mb = pkts[i + j];
+			if (!ip_frag_key_is_empty(&fi[j].key))
+				mb = ipv4_frag_add(tbl, dr, mb, tms, &fi[j]);
+			if (mb != NULL)
+				pkts[nb_out++] = mb;
+		}
+	}
+
+	return nb_out;
+}
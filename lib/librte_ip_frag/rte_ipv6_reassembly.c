@@ -178,7 +178,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 	}
 
 	/* try to find/add entry into the fragment's table. */
-	fp = ip_frag_find(tbl, dr, &key, tms);
+	fp = ip_frag_find(tbl, dr, &key, ip_frag_hash(&key), tms);
 	if (fp == NULL) {
 		IP_FRAG_MBUF2DR(dr, mb);
 		return NULL;
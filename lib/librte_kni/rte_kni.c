@@ -601,7 +601,7 @@ kni_allocate_mbufs(struct rte_kni *kni)
 	int i, ret;
 	struct rte_mbuf *pkts[MAX_MBUF_BURST_NUM];
 	void *phys[MAX_MBUF_BURST_NUM];
-	int allocq_free;
+	unsigned int allocq_free;
 
 	RTE_BUILD_BUG_ON(offsetof(struct rte_mbuf, pool) !=
 			 offsetof(struct rte_kni_mbuf, pool));
@@ -624,31 +624,25 @@ kni_allocate_mbufs(struct rte_kni *kni)
 		return;
 	}
 
-	allocq_free = (kni->alloc_q->read - kni->alloc_q->write - 1)
-			& (MAX_MBUF_BURST_NUM - 1);
-	for (i = 0; i < allocq_free; i++) {
-		pkts[i] = rte_pktmbuf_alloc(kni->pktmbuf_pool);
-		if (unlikely(pkts[i] == NULL)) {
-			/* Out of memory */
-			RTE_LOG(ERR, KNI, "Out of memory\n");
-			break;
-		}
-		phys[i] = va2pa(pkts[i]);
-	}
-
-	/* No pkt mbuf allocated */
-	if (i <= 0)
+	/* Refill up to a burst, allocated at once from the mempool */
+	allocq_free = RTE_MIN(kni_fifo_free_count(kni->alloc_q),
+			      (unsigned int)MAX_MBUF_BURST_NUM);
+	if (allocq_free == 0)
 		return;
+	if (unlikely(rte_pktmbuf_alloc_bulk(kni->pktmbuf_pool, pkts,
+					    allocq_free) != 0)) {
+		/* Out of memory */
+		RTE_LOG(ERR, KNI, "Out of memory\n");
+		return;
+	}
+	for (i = 0; i < (int)allocq_free; i++)
+		phys[i] = va2pa(pkts[i]);
 
-	ret = kni_fifo_put(kni->alloc_q, phys, i);
+	ret = kni_fifo_put(kni->alloc_q, phys, allocq_free);
 
 	/* Check if any mbufs not put into alloc_q, and then free them */
-	if (ret >= 0 && ret < i && ret < MAX_MBUF_BURST_NUM) {
-		int j;
-
-		for (j = ret; j < i; j++)
-			rte_pktmbuf_free(pkts[j]);
-	}
+	for (i = ret; i < (int)allocq_free; i++)
+		rte_pktmbuf_free(pkts[i]);
 }
 
 struct rte_kni *
@@ -0,0 +1,512 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ethdev.h>
+#include <rte_log.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+
+#include "rte_pcapng.h"
+#include "pcapng_proto.h"
+
+/* Timestamps are recorded with nanosecond resolution (10^-9 s) */
+#define PCAPNG_TSRESOL 9
+
+static int pcapng_logtype;
+
+#define PCAPNG_LOG(lvl, fmt, args...) \
+	rte_log(RTE_LOG_ ## lvl, pcapng_logtype, "%s(): " fmt "\n", \
+		__func__, ##args)
+
+/* Format of the capture file */
+struct rte_pcapng {
+	int outfd;		/* output file */
+	uint64_t tsc_hz;	/* TSC frequency */
+	uint64_t tsc_base;	/* TSC value ... */
+	uint64_t ns_base;	/* ... at this time since the Epoch */
+	uint32_t nb_interfaces;	/* number of IDB written */
+	int32_t port_index[RTE_MAX_ETHPORTS]; /* port to interface index */
+};
+
+static inline uint32_t
+pcapng_optlen(uint16_t len)
+{
+	return sizeof(struct pcapng_option) + RTE_ALIGN(len, sizeof(uint32_t));
+}
+
+static inline uint32_t
+pcapng_stroptlen(const char *str)
+{
+	return str == NULL ? 0 : pcapng_optlen(strlen(str) + 1);
+}
+
+static struct pcapng_option *
+pcapng_add_option(struct pcapng_option *popt, uint16_t code,
+		  const void *data, uint16_t len)
+{
+	popt->code = code;
+	popt->length = len;
+	if (len > 0) {
+		memcpy(popt->data, data, len);
+		memset(popt->data + len, 0,
+		       RTE_ALIGN(len, sizeof(uint32_t)) - len);
+	}
+
+	return (struct pcapng_option *)((uint8_t *)popt + pcapng_optlen(len));
+}
+
+static struct pcapng_option *
+pcapng_add_stroption(struct pcapng_option *popt, uint16_t code,
+		     const char *str)
+{
+	if (str == NULL)
+		return popt;
+
+	return pcapng_add_option(popt, code, str, strlen(str) + 1);
+}
+
+/* Write a complete block, the trailing length is filled in here */
+static int
+pcapng_write_block(struct rte_pcapng *self, void *buf, uint32_t len)
+{
+	ssize_t ret;
+
+	*(uint32_t *)((uint8_t *)buf + len - sizeof(uint32_t)) = len;
+
+	ret = write(self->outfd, buf, len);
+	if (ret != (ssize_t)len) {
+		PCAPNG_LOG(ERR, "write of %u bytes failed: %s",
+			   len, ret < 0 ? strerror(errno) : "short write");
+		rte_errno = ret < 0 ? errno : EIO;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+pcapng_section_block(struct rte_pcapng *self,
+		     const char *os, const char *hw,
+		     const char *app, const char *comment)
+{
+	struct pcapng_section_header *hdr;
+	struct pcapng_option *opt;
+	uint32_t len;
+	int ret;
+
+	len = sizeof(*hdr) + pcapng_stroptlen(hw) + pcapng_stroptlen(os) +
+		pcapng_stroptlen(app) + pcapng_stroptlen(comment) +
+		pcapng_optlen(0) + sizeof(uint32_t);
+
+	hdr = calloc(1, len);
+	if (hdr == NULL) {
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
+	hdr->block_type = PCAPNG_SECTION_BLOCK;
+	hdr->block_length = len;
+	hdr->byte_order_magic = PCAPNG_BYTE_ORDER_MAGIC;
+	hdr->major_version = PCAPNG_MAJOR_VERS;
+	hdr->minor_version = PCAPNG_MINOR_VERS;
+	hdr->section_length = UINT64_MAX;
+
+	opt = (struct pcapng_option *)(hdr + 1);
+	opt = pcapng_add_stroption(opt, PCAPNG_SHB_HARDWARE, hw);
+	opt = pcapng_add_stroption(opt, PCAPNG_SHB_OS, os);
+	opt = pcapng_add_stroption(opt, PCAPNG_SHB_USERAPPL, app);
+	opt = pcapng_add_stroption(opt, PCAPNG_OPT_COMMENT, comment);
+	pcapng_add_option(opt, PCAPNG_OPT_END, NULL, 0);
+
+	ret = pcapng_write_block(self, hdr, len);
+	free(hdr);
+
+	return ret;
+}
+
+int
+rte_pcapng_add_interface(struct rte_pcapng *self, uint16_t port,
+			 const char *ifname, const char *ifdescr)
+{
+	char name[RTE_ETH_NAME_MAX_LEN];
+	struct pcapng_interface_block *hdr;
+	struct pcapng_option *opt;
+	const uint8_t tsresol = PCAPNG_TSRESOL;
+	uint32_t len;
+	int ret;
+
+	if (self == NULL || port >= RTE_MAX_ETHPORTS) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	if (self->port_index[port] >= 0) {
+		PCAPNG_LOG(ERR, "port %u already added", port);
+		rte_errno = EEXIST;
+		return -1;
+	}
+
+	if (ifname == NULL) {
+		if (rte_eth_dev_get_name_by_port(port, name) < 0)
+			snprintf(name, sizeof(name), "port%u", port);
+		ifname = name;
+	}
+
+	len = sizeof(*hdr) + pcapng_stroptlen(ifname) +
+		pcapng_stroptlen(ifdescr) + pcapng_optlen(sizeof(tsresol)) +
+		pcapng_optlen(0) + sizeof(uint32_t);
+
+	hdr = calloc(1, len);
+	if (hdr == NULL) {
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
+	hdr->block_type = PCAPNG_INTERFACE_BLOCK;
+	hdr->block_length = len;
+	hdr->link_type = PCAPNG_LINKTYPE_ETHERNET;
+	hdr->snap_len = 0;	/* no limit */
+
+	opt = (struct pcapng_option *)(hdr + 1);
+	opt = pcapng_add_stroption(opt, PCAPNG_IFB_NAME, ifname);
+	opt = pcapng_add_stroption(opt, PCAPNG_IFB_DESCRIPTION, ifdescr);
+	opt = pcapng_add_option(opt, PCAPNG_IFB_TSRESOL,
+				&tsresol, sizeof(tsresol));
+	pcapng_add_option(opt, PCAPNG_OPT_END, NULL, 0);
+
+	ret = pcapng_write_block(self, hdr, len);
+	free(hdr);
+	if (ret < 0)
+		return ret;
+
+	self->port_index[port] = self->nb_interfaces;
+	return self->nb_interfaces++;
+}
+
+/* Size of the options and trailer appended after the packet data */
+static inline uint32_t
+pcapng_epb_tail_len(uint32_t data_len)
+{
+	return RTE_ALIGN(data_len, sizeof(uint32_t)) - data_len +
+		pcapng_optlen(sizeof(uint32_t)) +	/* flags */
+		pcapng_optlen(sizeof(uint32_t)) +	/* queue */
+		pcapng_optlen(0) +			/* end */
+		sizeof(uint32_t);			/* block length */
+}
+
+uint32_t
+rte_pcapng_mbuf_size(uint32_t length)
+{
+	return sizeof(struct pcapng_enhance_packet_block) + length +
+		pcapng_epb_tail_len(length);
+}
+
+/* Reserve len contiguous bytes at the end of the packet */
+static void *
+pcapng_append(struct rte_mbuf *mc, struct rte_mempool *mp, uint16_t len)
+{
+	struct rte_mbuf *last = rte_pktmbuf_lastseg(mc);
+	void *tail;
+
+	if (rte_pktmbuf_tailroom(last) < len) {
+		struct rte_mbuf *seg = rte_pktmbuf_alloc(mp);
+
+		if (unlikely(seg == NULL))
+			return NULL;
+		last->next = seg;
+		last = seg;
+		mc->nb_segs++;
+	}
+
+	tail = rte_pktmbuf_mtod_offset(last, void *, last->data_len);
+	last->data_len += len;
+	mc->pkt_len += len;
+
+	return tail;
+}
+
+/* Copy len bytes of packet data, chaining new segments as needed */
+static int
+pcapng_copy_data(struct rte_mbuf *mc, const struct rte_mbuf *m,
+		 uint32_t len, struct rte_mempool *mp)
+{
+	struct rte_mbuf *last = mc;
+	uint32_t off = 0;
+
+	while (len > 0) {
+		uint32_t n = RTE_MIN(len, (uint32_t)rte_pktmbuf_tailroom(last));
+		const void *src;
+		void *dst;
+
+		if (n == 0) {
+			struct rte_mbuf *seg = rte_pktmbuf_alloc(mp);
+
+			if (unlikely(seg == NULL))
+				return -1;
+			last->next = seg;
+			last = seg;
+			mc->nb_segs++;
+			continue;
+		}
+
+		dst = rte_pktmbuf_mtod_offset(last, void *, last->data_len);
+		src = rte_pktmbuf_read(m, off, n, dst);
+		if (src != dst)
+			rte_memcpy(dst, src, n);
+
+		last->data_len += n;
+		mc->pkt_len += n;
+		off += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+struct rte_mbuf *
+rte_pcapng_copy(uint16_t port_id, uint32_t queue,
+		const struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t length, uint64_t tsc,
+		enum rte_pcapng_direction direction)
+{
+	struct pcapng_enhance_packet_block *epb;
+	struct pcapng_option *opt;
+	uint32_t orig_len, data_len, tail_len, padding, flags;
+	struct rte_mbuf *mc;
+	uint8_t *tail;
+
+	orig_len = rte_pktmbuf_pkt_len(m);
+	data_len = RTE_MIN(orig_len, length);
+
+	mc = rte_pktmbuf_alloc(mp);
+	if (unlikely(mc == NULL))
+		return NULL;
+
+	epb = (struct pcapng_enhance_packet_block *)
+		rte_pktmbuf_append(mc, sizeof(*epb));
+	if (unlikely(epb == NULL))
+		goto fail;
+
+	if (unlikely(pcapng_copy_data(mc, m, data_len, mp) < 0))
+		goto fail;
+
+	tail_len = pcapng_epb_tail_len(data_len);
+	tail = pcapng_append(mc, mp, tail_len);
+	if (unlikely(tail == NULL))
+		goto fail;
+
+	padding = RTE_ALIGN(data_len, sizeof(uint32_t)) - data_len;
+	memset(tail, 0, padding);
+
+	switch (direction) {
+	case RTE_PCAPNG_DIRECTION_IN:
+		flags = PCAPNG_IFB_INBOUND;
+		break;
+	case RTE_PCAPNG_DIRECTION_OUT:
+		flags = PCAPNG_IFB_OUTBOUND;
+		break;
+	default:
+		flags = 0;
+	}
+
+	opt = (struct pcapng_option *)(tail + padding);
+	opt = pcapng_add_option(opt, PCAPNG_EPB_FLAGS, &flags, sizeof(flags));
+	opt = pcapng_add_option(opt, PCAPNG_EPB_QUEUE, &queue, sizeof(queue));
+	opt = pcapng_add_option(opt, PCAPNG_OPT_END, NULL, 0);
+	*(uint32_t *)opt = rte_pktmbuf_pkt_len(mc);
+
+	/*
+	 * The interface index is only known to the writer, store the
+	 * port for now. The raw TSC value is converted on write as well,
+	 * keeping this function cheap enough for the data path.
+	 */
+	epb->block_type = PCAPNG_ENHANCED_PACKET_BLOCK;
+	epb->block_length = rte_pktmbuf_pkt_len(mc);
+	epb->interface_id = port_id;
+	epb->timestamp_hi = tsc >> 32;
+	epb->timestamp_lo = (uint32_t)tsc;
+	epb->capture_length = data_len;
+	epb->original_length = orig_len;
+
+	mc->port = port_id;
+
+	return mc;
+
+fail:
+	rte_pktmbuf_free(mc);
+	return NULL;
+}
+
+static inline uint64_t
+pcapng_tsc_to_ns(const struct rte_pcapng *self, uint64_t tsc)
+{
+	uint64_t delta = tsc - self->tsc_base;
+
+	return self->ns_base + (delta / self->tsc_hz) * NS_PER_S +
+		(delta % self->tsc_hz) * NS_PER_S / self->tsc_hz;
+}
+
+static ssize_t
+pcapng_writev(struct rte_pcapng *self, struct iovec *iov, int cnt,
+	      size_t len)
+{
+	ssize_t ret;
+
+	ret = writev(self->outfd, iov, cnt);
+	if (unlikely(ret != (ssize_t)len)) {
+		PCAPNG_LOG(ERR, "writev of %zu bytes failed: %s",
+			   len, ret < 0 ? strerror(errno) : "short write");
+		rte_errno = ret < 0 ? errno : EIO;
+		return -1;
+	}
+
+	return ret;
+}
+
+ssize_t
+rte_pcapng_write_packets(struct rte_pcapng *self,
+			 struct rte_mbuf *pkts[], uint16_t nb_pkts)
+{
+	/* a block takes at least two iovecs: its header and the data */
+	struct pcapng_enhance_packet_block epbs[IOV_MAX / 2];
+	struct iovec iov[IOV_MAX];
+	ssize_t total = 0, ret;
+	size_t len = 0;
+	unsigned int nb_epb = 0;
+	int cnt = 0;
+	uint16_t i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		struct rte_mbuf *m = pkts[i];
+		const struct pcapng_enhance_packet_block *src;
+		struct pcapng_enhance_packet_block *epb;
+		uint64_t ts;
+
+		src = rte_pktmbuf_mtod(m,
+			const struct pcapng_enhance_packet_block *);
+		if (unlikely(rte_pktmbuf_data_len(m) < sizeof(*src) ||
+			     src->block_type != PCAPNG_ENHANCED_PACKET_BLOCK ||
+			     m->port >= RTE_MAX_ETHPORTS ||
+			     self->port_index[m->port] < 0)) {
+			PCAPNG_LOG(ERR, "mbuf not formatted for port %u",
+				   m->port);
+			rte_errno = EINVAL;
+			return -1;
+		}
+
+		if (unlikely(cnt + m->nb_segs + 1 > IOV_MAX ||
+			     nb_epb == RTE_DIM(epbs))) {
+			ret = pcapng_writev(self, iov, cnt, len);
+			if (ret < 0)
+				return ret;
+			total += ret;
+			cnt = 0;
+			len = 0;
+			nb_epb = 0;
+		}
+
+		/*
+		 * The interface index and the timestamp are filled in a
+		 * copy of the block header, the mbuf is left untouched.
+		 */
+		epb = &epbs[nb_epb++];
+		*epb = *src;
+		epb->interface_id = self->port_index[m->port];
+		ts = pcapng_tsc_to_ns(self,
+			((uint64_t)src->timestamp_hi << 32) |
+			src->timestamp_lo);
+		epb->timestamp_hi = ts >> 32;
+		epb->timestamp_lo = (uint32_t)ts;
+
+		iov[cnt].iov_base = epb;
+		iov[cnt].iov_len = sizeof(*epb);
+		len += sizeof(*epb);
+		cnt++;
+		if (rte_pktmbuf_data_len(m) > sizeof(*epb)) {
+			iov[cnt].iov_base = rte_pktmbuf_mtod_offset(m, void *,
+					sizeof(*epb));
+			iov[cnt].iov_len = rte_pktmbuf_data_len(m) -
+				sizeof(*epb);
+			len += iov[cnt].iov_len;
+			cnt++;
+		}
+
+		while ((m = m->next) != NULL) {
+			iov[cnt].iov_base = rte_pktmbuf_mtod(m, void *);
+			iov[cnt].iov_len = rte_pktmbuf_data_len(m);
+			len += rte_pktmbuf_data_len(m);
+			cnt++;
+		}
+	}
+
+	if (cnt > 0) {
+		ret = pcapng_writev(self, iov, cnt, len);
+		if (ret < 0)
+			return ret;
+		total += ret;
+	}
+
+	return total;
+}
+
+struct rte_pcapng *
+rte_pcapng_fdopen(int fd, const char *osname, const char *hardware,
+		  const char *appname, const char *comment)
+{
+	struct rte_pcapng *self;
+	struct timespec ts;
+	uint16_t i;
+
+	self = calloc(1, sizeof(*self));
+	if (self == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	self->outfd = fd;
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++)
+		self->port_index[i] = -1;
+
+	self->tsc_hz = rte_get_tsc_hz();
+	clock_gettime(CLOCK_REALTIME, &ts);
+	self->tsc_base = rte_rdtsc();
+	self->ns_base = (uint64_t)ts.tv_sec * NS_PER_S + ts.tv_nsec;
+
+	if (pcapng_section_block(self, osname, hardware,
+				 appname, comment) < 0) {
+		free(self);
+		return NULL;
+	}
+
+	return self;
+}
+
+void
+rte_pcapng_close(struct rte_pcapng *self)
+{
+	if (self == NULL)
+		return;
+
+	close(self->outfd);
+	free(self);
+}
+
+RTE_INIT(pcapng_init_log)
+{
+	pcapng_logtype = rte_log_register("lib.pcapng");
+	if (pcapng_logtype >= 0)
+		rte_log_set_level(pcapng_logtype, RTE_LOG_NOTICE);
+}
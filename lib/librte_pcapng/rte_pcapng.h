@@ -0,0 +1,176 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_PCAPNG_H_
+#define _RTE_PCAPNG_H_
+
+/**
+ * @file
+ * RTE pcapng
+ *
+ * @warning
+ * @b EXPERIMENTAL: all functions in this file may change without prior notice
+ *
+ * Packet capture writer for the pcapng file format
+ * (https://github.com/pcapng/pcapng).
+ *
+ * Captured packets are converted into Enhanced Packet Blocks at the time of
+ * capture by rte_pcapng_copy(): the block header and trailer are stored in
+ * the mbuf together with the packet data, so that a burst of copies can be
+ * written to the file with a single writev() call by
+ * rte_pcapng_write_packets(). Timestamps are taken from the TSC and stored
+ * in the file with nanosecond resolution. The receive queue and the
+ * direction of each packet are stored as options of the packet block.
+ */
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <rte_compat.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Opaque handle of a pcapng output file. */
+struct rte_pcapng;
+
+/** Direction of a captured packet, stored in the epb_flags option. */
+enum rte_pcapng_direction {
+	RTE_PCAPNG_DIRECTION_UNKNOWN = 0,
+	RTE_PCAPNG_DIRECTION_IN  = 1,
+	RTE_PCAPNG_DIRECTION_OUT = 2,
+};
+
+/**
+ * Write a pcapng section header to a file and return a handle for it.
+ *
+ * @param fd
+ *   File descriptor opened for writing. The handle takes ownership
+ *   of the descriptor, it is closed by rte_pcapng_close().
+ * @param osname
+ *   Optional operating system name recorded in the section header.
+ * @param hardware
+ *   Optional hardware description recorded in the section header.
+ * @param appname
+ *   Optional name of the capturing application.
+ * @param comment
+ *   Optional comment recorded in the section header.
+ *
+ * @return
+ *   Handle on success, NULL on error with rte_errno set.
+ */
+__rte_experimental
+struct rte_pcapng *
+rte_pcapng_fdopen(int fd, const char *osname, const char *hardware,
+		  const char *appname, const char *comment);
+
+/**
+ * Flush and close a pcapng output file.
+ *
+ * @param self
+ *   Handle returned by rte_pcapng_fdopen().
+ */
+__rte_experimental
+void
+rte_pcapng_close(struct rte_pcapng *self);
+
+/**
+ * Write an Interface Description Block for an ethdev port.
+ *
+ * Every port whose packets are written to the file must be added first.
+ * Interfaces are numbered in the file in the order they are added.
+ *
+ * @param self
+ *   Handle returned by rte_pcapng_fdopen().
+ * @param port
+ *   Ethdev port identifier.
+ * @param ifname
+ *   Interface name, the device name of the port is used if NULL.
+ * @param ifdescr
+ *   Optional interface description.
+ *
+ * @return
+ *   Interface index in the file on success, -1 on error with rte_errno set.
+ */
+__rte_experimental
+int
+rte_pcapng_add_interface(struct rte_pcapng *self, uint16_t port,
+			 const char *ifname, const char *ifdescr);
+
+/**
+ * Return the number of bytes that rte_pcapng_copy() adds around
+ * the packet data, useful to size the data room of capture mempools.
+ *
+ * @param length
+ *   Length of packet data to be captured.
+ *
+ * @return
+ *   Number of bytes needed to store a captured packet of given length.
+ */
+__rte_experimental
+uint32_t
+rte_pcapng_mbuf_size(uint32_t length);
+
+/**
+ * Copy a packet into an mbuf formatted as a pcapng Enhanced Packet Block.
+ *
+ * This function is meant to be called in the data path (e.g. from an
+ * Rx/Tx callback), the returned mbuf is later passed to
+ * rte_pcapng_write_packets().
+ *
+ * @param port_id
+ *   Port the packet was received on or sent to.
+ * @param queue
+ *   Queue the packet was received on or sent to.
+ * @param m
+ *   Packet to copy, possibly multi-segment.
+ * @param mp
+ *   Mempool to allocate the copy from.
+ * @param length
+ *   Maximum number of packet bytes to capture (snap length).
+ * @param tsc
+ *   TSC value at time of capture, typically rte_rdtsc().
+ * @param direction
+ *   Direction of the packet.
+ *
+ * @return
+ *   Copy of the packet on success, NULL if allocation failed.
+ */
+__rte_experimental
+struct rte_mbuf *
+rte_pcapng_copy(uint16_t port_id, uint32_t queue,
+		const struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t length, uint64_t tsc,
+		enum rte_pcapng_direction direction);
+
+/**
+ * Write a burst of packets returned by rte_pcapng_copy() to the file.
+ *
+ * All blocks of the burst are gathered and written with as few
+ * writev() calls as possible. The mbufs are neither modified nor freed,
+ * so that they can be written to several files.
+ *
+ * @param self
+ *   Handle returned by rte_pcapng_fdopen().
+ * @param pkts
+ *   Packets formatted by rte_pcapng_copy().
+ * @param nb_pkts
+ *   Number of packets in the burst.
+ *
+ * @return
+ *   Number of bytes written on success, -1 on error with rte_errno set.
+ */
+__rte_experimental
+ssize_t
+rte_pcapng_write_packets(struct rte_pcapng *self,
+			 struct rte_mbuf *pkts[], uint16_t nb_pkts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_PCAPNG_H_ */
@@ -9,6 +9,10 @@
 #include <rte_log.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
+#include <rte_cycles.h>
+#ifdef RTE_LIBRTE_PCAPNG
+#include <rte_pcapng.h>
+#endif
 
 #include "rte_pdump.h"
 
@@ -61,6 +65,7 @@ static struct pdump_rxtx_cbs {
 	struct rte_mempool *mp;
 	const struct rte_eth_rxtx_callback *cb;
 	void *filter;
+	uint32_t flags;
 } rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT],
 tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
@@ -132,8 +137,46 @@ pdump_pktmbuf_copy(struct rte_mbuf *m, struct rte_mempool *mp)
 	return m_dup;
 }
 
+#ifdef RTE_LIBRTE_PCAPNG
+/* Copy a burst as pcapng blocks, dir is RTE_PDUMP_FLAG_RX or _TX */
+static inline uint16_t
+pdump_pcapng_copy(uint16_t port, uint16_t queue, uint32_t dir,
+	struct rte_mbuf **pkts, uint16_t nb_pkts, struct rte_mempool *mp,
+	struct rte_mbuf **dup_bufs)
+{
+	enum rte_pcapng_direction direction;
+	uint16_t i, d_pkts = 0;
+	struct rte_mbuf *p;
+	uint64_t tsc;
+
+	direction = dir == RTE_PDUMP_FLAG_RX ? RTE_PCAPNG_DIRECTION_IN :
+		RTE_PCAPNG_DIRECTION_OUT;
+	/* one timestamp for the whole burst */
+	tsc = rte_rdtsc();
+	for (i = 0; i < nb_pkts; i++) {
+		p = rte_pcapng_copy(port, queue, pkts[i], mp, UINT32_MAX, tsc,
+				direction);
+		if (p)
+			dup_bufs[d_pkts++] = p;
+	}
+
+	return d_pkts;
+}
+#else
+/* RTE_PDUMP_FLAG_PCAPNG is rejected without the pcapng library */
+static inline uint16_t
+pdump_pcapng_copy(uint16_t port __rte_unused, uint16_t queue __rte_unused,
+	uint32_t dir __rte_unused, struct rte_mbuf **pkts __rte_unused,
+	uint16_t nb_pkts __rte_unused, struct rte_mempool *mp __rte_unused,
+	struct rte_mbuf **dup_bufs __rte_unused)
+{
+	return 0;
+}
+#endif
+
 static inline void
-pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
+pdump_copy(uint16_t port, uint16_t queue, uint32_t dir,
+	struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 {
 	unsigned i;
 	int ring_enq;
@@ -147,10 +190,15 @@ pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 	cbs  = user_params;
 	ring = cbs->ring;
 	mp = cbs->mp;
-	for (i = 0; i < nb_pkts; i++) {
-		p = pdump_pktmbuf_copy(pkts[i], mp);
-		if (p)
-			dup_bufs[d_pkts++] = p;
+	if (cbs->flags & RTE_PDUMP_FLAG_PCAPNG) {
+		d_pkts = pdump_pcapng_copy(port, queue, dir, pkts, nb_pkts,
+				mp, dup_bufs);
+	} else {
+		for (i = 0; i < nb_pkts; i++) {
+			p = pdump_pktmbuf_copy(pkts[i], mp);
+			if (p)
+				dup_bufs[d_pkts++] = p;
+		}
 	}
 
 	ring_enq = rte_ring_enqueue_burst(ring, (void *)dup_bufs, d_pkts, NULL);
@@ -164,27 +212,29 @@ pdump_copy(struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 }
 
 static uint16_t
-pdump_rx(uint16_t port __rte_unused, uint16_t qidx __rte_unused,
+pdump_rx(uint16_t port, uint16_t qidx,
 	struct rte_mbuf **pkts, uint16_t nb_pkts,
 	uint16_t max_pkts __rte_unused,
 	void *user_params)
 {
-	pdump_copy(pkts, nb_pkts, user_params);
+	pdump_copy(port, qidx, RTE_PDUMP_FLAG_RX,
+			pkts, nb_pkts, user_params);
 	return nb_pkts;
 }
 
 static uint16_t
-pdump_tx(uint16_t port __rte_unused, uint16_t qidx __rte_unused,
+pdump_tx(uint16_t port, uint16_t qidx,
 		struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 {
-	pdump_copy(pkts, nb_pkts, user_params);
+	pdump_copy(port, qidx, RTE_PDUMP_FLAG_TX,
+			pkts, nb_pkts, user_params);
 	return nb_pkts;
 }
 
 static int
 pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 				struct rte_ring *ring, struct rte_mempool *mp,
-				uint16_t operation)
+				uint32_t flags, uint16_t operation)
 {
 	uint16_t qid;
 	struct pdump_rxtx_cbs *cbs = NULL;
@@ -202,6 +252,7 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 			}
 			cbs->ring = ring;
 			cbs->mp = mp;
+			cbs->flags = flags;
 			cbs->cb = rte_eth_add_first_rx_callback(port, qid,
 								pdump_rx, cbs);
 			if (cbs->cb == NULL) {
@@ -238,7 +289,7 @@ pdump_register_rx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 static int
 pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 				struct rte_ring *ring, struct rte_mempool *mp,
-				uint16_t operation)
+				uint32_t flags, uint16_t operation)
 {
 
 	uint16_t qid;
@@ -257,6 +308,7 @@ pdump_register_tx_callbacks(uint16_t end_q, uint16_t port, uint16_t queue,
 			}
 			cbs->ring = ring;
 			cbs->mp = mp;
+			cbs->flags = flags;
 			cbs->cb = rte_eth_add_tx_callback(port, qid, pdump_tx,
 								cbs);
 			if (cbs->cb == NULL) {
@@ -354,7 +406,7 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 			return -EINVAL;
 		}
 		if ((nb_tx_q == 0 || nb_rx_q == 0) &&
-			flags == RTE_PDUMP_FLAG_RXTX) {
+			(flags & RTE_PDUMP_FLAG_RXTX) == RTE_PDUMP_FLAG_RXTX) {
 			RTE_LOG(ERR, PDUMP,
 				"both tx&rx queues must be non zero\n");
 			return -EINVAL;
@@ -365,7 +417,7 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	if (flags & RTE_PDUMP_FLAG_RX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_rx_q : queue + 1;
 		ret = pdump_register_rx_callbacks(end_q, port, queue, ring, mp,
-							operation);
+							flags, operation);
 		if (ret < 0)
 			return ret;
 	}
@@ -374,7 +426,7 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	if (flags & RTE_PDUMP_FLAG_TX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_tx_q : queue + 1;
 		ret = pdump_register_tx_callbacks(end_q, port, queue, ring, mp,
-							operation);
+							flags, operation);
 		if (ret < 0)
 			return ret;
 	}
@@ -457,13 +509,23 @@ pdump_validate_ring_mp(struct rte_ring *ring, struct rte_mempool *mp)
 static int
 pdump_validate_flags(uint32_t flags)
 {
-	if (flags != RTE_PDUMP_FLAG_RX && flags != RTE_PDUMP_FLAG_TX &&
-		flags != RTE_PDUMP_FLAG_RXTX) {
+	uint32_t dir = flags & ~RTE_PDUMP_FLAG_PCAPNG;
+
+	if (dir != RTE_PDUMP_FLAG_RX && dir != RTE_PDUMP_FLAG_TX &&
+		dir != RTE_PDUMP_FLAG_RXTX) {
 		RTE_LOG(ERR, PDUMP,
 			"invalid flags, should be either rx/tx/rxtx\n");
 		rte_errno = EINVAL;
 		return -1;
 	}
+#ifndef RTE_LIBRTE_PCAPNG
+	if (flags & RTE_PDUMP_FLAG_PCAPNG) {
+		RTE_LOG(ERR, PDUMP,
+			"pcapng format not supported, pcapng library disabled\n");
+		rte_errno = ENOTSUP;
+		return -1;
+	}
+#endif
 
 	return 0;
 }
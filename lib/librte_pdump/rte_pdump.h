@@ -26,7 +26,9 @@ enum {
 	RTE_PDUMP_FLAG_RX = 1,  /* receive direction */
 	RTE_PDUMP_FLAG_TX = 2,  /* transmit direction */
 	/* both receive and transmit directions */
-	RTE_PDUMP_FLAG_RXTX = (RTE_PDUMP_FLAG_RX|RTE_PDUMP_FLAG_TX)
+	RTE_PDUMP_FLAG_RXTX = (RTE_PDUMP_FLAG_RX|RTE_PDUMP_FLAG_TX),
+	/* format copies as pcapng blocks, see rte_pcapng_copy() */
+	RTE_PDUMP_FLAG_PCAPNG = 4,
 };
 
 /**
@@ -63,6 +65,8 @@ rte_pdump_uninit(void);
  * @param flags
  *  flags specifies RTE_PDUMP_FLAG_RX/RTE_PDUMP_FLAG_TX/RTE_PDUMP_FLAG_RXTX
  *  on which packet capturing should be enabled for a given port and queue.
+ *  RTE_PDUMP_FLAG_PCAPNG may be or'ed in to get the copies formatted as
+ *  pcapng blocks, ready for rte_pcapng_write_packets().
  * @param ring
  *  ring on which captured packets will be enqueued for user.
  * @param mp
@@ -113,6 +117,8 @@ rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags);
  * @param flags
  *  flags specifies RTE_PDUMP_FLAG_RX/RTE_PDUMP_FLAG_TX/RTE_PDUMP_FLAG_RXTX
  *  on which packet capturing should be enabled for a given port and queue.
+ *  RTE_PDUMP_FLAG_PCAPNG may be or'ed in to get the copies formatted as
+ *  pcapng blocks, ready for rte_pcapng_write_packets().
  * @param ring
  *  ring on which captured packets will be enqueued for user.
  * @param mp
@@ -11,6 +11,7 @@
 #include <rte_eal_memconfig.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
+#include <rte_pause.h>
 #include <rte_tailq.h>
 
 #include "rte_reorder.h"
@@ -23,6 +24,7 @@ static struct rte_tailq_elem rte_reorder_tailq = {
 EAL_REGISTER_TAILQ(rte_reorder_tailq)
 
 #define NO_FLAGS 0
+#define RTE_REORDER_VALID_FLAGS RTE_REORDER_F_MP_INSERT
 #define RTE_REORDER_PREFIX "RO_"
 #define RTE_REORDER_NAMESIZE 32
 
@@ -45,15 +47,16 @@ struct rte_reorder_buffer {
 	unsigned int memsize; /**< memory area size of reorder buffer */
 	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
 	struct cir_buffer order_buf; /**< buffer used to reorder entries */
-	int is_initialized;
+	int is_initialized; /**< 1 once min_seqn is set, -1 while setting it */
+	unsigned int flags; /**< RTE_REORDER_F_* flags given at creation */
 } __rte_cache_aligned;
 
 static void
 rte_reorder_free_mbufs(struct rte_reorder_buffer *b);
 
-struct rte_reorder_buffer *
-rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
-		const char *name, unsigned int size)
+static struct rte_reorder_buffer *
+reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
+		const char *name, unsigned int size, unsigned int flags)
 {
 	const unsigned int min_bufsize = sizeof(*b) +
 					(2 * size * sizeof(struct rte_mbuf *));
@@ -86,6 +89,7 @@ rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
 	memset(b, 0, bufsize);
 	strlcpy(b->name, name, sizeof(b->name));
 	b->memsize = bufsize;
+	b->flags = flags;
 	b->order_buf.size = b->ready_buf.size = size;
 	b->order_buf.mask = b->ready_buf.mask = size - 1;
 	b->ready_buf.entries = (void *)&b[1];
@@ -95,8 +99,16 @@ rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
 	return b;
 }
 
-struct rte_reorder_buffer*
-rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+struct rte_reorder_buffer *
+rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
+		const char *name, unsigned int size)
+{
+	return reorder_init(b, bufsize, name, size, NO_FLAGS);
+}
+
+static struct rte_reorder_buffer *
+reorder_create(const char *name, unsigned int socket_id, unsigned int size,
+		unsigned int flags)
 {
 	struct rte_reorder_buffer *b = NULL;
 	struct rte_tailq_entry *te;
@@ -119,6 +131,12 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 		rte_errno = EINVAL;
 		return NULL;
 	}
+	if ((flags & ~RTE_REORDER_VALID_FLAGS) != 0) {
+		RTE_LOG(ERR, REORDER, "Invalid reorder buffer flags: 0x%x\n",
+				flags);
+		rte_errno = EINVAL;
+		return NULL;
+	}
 
 	rte_mcfg_tailq_write_lock();
 
@@ -147,7 +165,7 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 		rte_errno = ENOMEM;
 		rte_free(te);
 	} else {
-		rte_reorder_init(b, bufsize, name, size);
+		reorder_init(b, bufsize, name, size, flags);
 		te->data = (void *)b;
 		TAILQ_INSERT_TAIL(reorder_list, te, next);
 	}
@@ -157,6 +175,19 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 	return b;
 }
 
+struct rte_reorder_buffer*
+rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+{
+	return reorder_create(name, socket_id, size, NO_FLAGS);
+}
+
+struct rte_reorder_buffer *
+rte_reorder_create_with_flags(const char *name, unsigned int socket_id,
+		unsigned int size, unsigned int flags)
+{
+	return reorder_create(name, socket_id, size, flags);
+}
+
 void
 rte_reorder_reset(struct rte_reorder_buffer *b)
 {
@@ -165,7 +196,7 @@ rte_reorder_reset(struct rte_reorder_buffer *b)
 	rte_reorder_free_mbufs(b);
 	strlcpy(name, b->name, sizeof(name));
 	/* No error checking as current values should be valid */
-	rte_reorder_init(b, b->memsize, name, b->order_buf.size);
+	reorder_init(b, b->memsize, name, b->order_buf.size, b->flags);
 }
 
 static void
@@ -173,13 +204,16 @@ rte_reorder_free_mbufs(struct rte_reorder_buffer *b)
 {
 	unsigned i;
 
-	/* Free up the mbufs of order buffer & ready buffer */
+	/* Free up the mbufs of order buffer */
 	for (i = 0; i < b->order_buf.size; i++) {
 		if (b->order_buf.entries[i])
 			rte_pktmbuf_free(b->order_buf.entries[i]);
-		if (b->ready_buf.entries[i])
-			rte_pktmbuf_free(b->ready_buf.entries[i]);
 	}
+
+	/* Drained entries are left behind in the ready buffer, skip them */
+	for (i = b->ready_buf.tail; i != b->ready_buf.head;
+			i = (i + 1) & b->ready_buf.mask)
+		rte_pktmbuf_free(b->ready_buf.entries[i]);
 }
 
 void
@@ -276,7 +310,9 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 		}
 
 		/* Move all ready entries that fit to the ready_buf */
-		while (order_buf->entries[order_buf->head] != NULL) {
+		while (order_buf->entries[order_buf->head] != NULL &&
+				((ready_buf->head + 1) & ready_buf->mask) !=
+				ready_buf->tail) {
 			ready_buf->entries[ready_buf->head] =
 					order_buf->entries[order_buf->head];
 
@@ -284,10 +320,6 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 			order_head_adv++;
 
 			order_buf->head = (order_buf->head + 1) & order_buf->mask;
-
-			if (((ready_buf->head + 1) & ready_buf->mask) == ready_buf->tail)
-				break;
-
 			ready_buf->head = (ready_buf->head + 1) & ready_buf->mask;
 		}
 	}
@@ -297,16 +329,11 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 	return order_head_adv;
 }
 
-int
-rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+static int
+reorder_insert_sp(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 {
-	uint32_t offset, position;
 	struct cir_buffer *order_buf;
-
-	if (b == NULL || mbuf == NULL) {
-		rte_errno = EINVAL;
-		return -1;
-	}
+	uint32_t offset, position;
 
 	order_buf = &b->order_buf;
 	if (!b->is_initialized) {
@@ -363,6 +390,141 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	return 0;
 }
 
+static int
+reorder_insert_mp(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	struct rte_mbuf *entry = NULL;
+	uint32_t offset, position;
+	int state;
+
+	/*
+	 * The first producer to get here sets the start of the window, any
+	 * other producer waits for it so that all of them use the same base.
+	 */
+	state = __atomic_load_n(&b->is_initialized, __ATOMIC_ACQUIRE);
+	if (unlikely(state != 1)) {
+		state = 0;
+		if (__atomic_compare_exchange_n(&b->is_initialized, &state, -1,
+				0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			b->min_seqn = mbuf->seqn;
+			order_buf->head = mbuf->seqn & order_buf->mask;
+			__atomic_store_n(&b->is_initialized, 1,
+					__ATOMIC_RELEASE);
+		} else {
+			while (__atomic_load_n(&b->is_initialized,
+					__ATOMIC_ACQUIRE) != 1)
+				rte_pause();
+		}
+	}
+
+	/*
+	 * Only the draining thread moves the window, so producers cannot
+	 * make room for early mbufs themselves: they get ENOSPC and retry
+	 * once the window has been drained. The head of the order buffer is
+	 * kept equal to min_seqn modulo the size, which lets each mbuf be
+	 * placed with its sequence number alone.
+	 */
+	offset = mbuf->seqn - __atomic_load_n(&b->min_seqn, __ATOMIC_ACQUIRE);
+	if (offset >= order_buf->size) {
+		rte_errno = offset < 2 * order_buf->size ? ENOSPC : ERANGE;
+		return -1;
+	}
+
+	position = mbuf->seqn & order_buf->mask;
+	if (!__atomic_compare_exchange_n(&order_buf->entries[position], &entry,
+			mbuf, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+		/* Slot still holds a late mbuf or one with the same seqn */
+		rte_errno = ENOSPC;
+		return -1;
+	}
+	return 0;
+}
+
+int
+rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	if (b == NULL || mbuf == NULL) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_insert_mp(b, mbuf);
+	return reorder_insert_sp(b, mbuf);
+}
+
+unsigned int
+rte_reorder_insert_bulk(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int nb_mbufs)
+{
+	unsigned int i;
+
+	if (b == NULL || (mbufs == NULL && nb_mbufs != 0)) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	if (b->flags & RTE_REORDER_F_MP_INSERT) {
+		for (i = 0; i < nb_mbufs; i++)
+			if (reorder_insert_mp(b, mbufs[i]) != 0)
+				break;
+	} else {
+		for (i = 0; i < nb_mbufs; i++)
+			if (reorder_insert_sp(b, mbufs[i]) != 0)
+				break;
+	}
+
+	return i;
+}
+
+/*
+ * Multi-producer drain. Slots are taken with an atomic exchange as producers
+ * may fill them concurrently. A slot can hold a late mbuf whose producer
+ * raced with the window moving past its sequence number: it is returned
+ * as is, without moving the window.
+ */
+static unsigned int
+reorder_drain_mp(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int max_mbufs, int up_to_seqn, uint32_t seqn)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	unsigned int drain_cnt = 0, skipped = 0;
+	struct rte_mbuf *entry;
+
+	if (__atomic_load_n(&b->is_initialized, __ATOMIC_ACQUIRE) != 1)
+		return 0;
+
+	while (drain_cnt < max_mbufs) {
+		if (up_to_seqn && (int32_t)(seqn - b->min_seqn) <= 0)
+			break;
+
+		entry = __atomic_exchange_n(&order_buf->entries[order_buf->head],
+				NULL, __ATOMIC_ACQUIRE);
+		if (entry == NULL) {
+			if (!up_to_seqn)
+				break;
+			/* Whole window empty, jump straight to seqn */
+			if (++skipped == order_buf->size) {
+				order_buf->head = seqn & order_buf->mask;
+				__atomic_store_n(&b->min_seqn, seqn,
+						__ATOMIC_RELEASE);
+				break;
+			}
+		} else {
+			mbufs[drain_cnt++] = entry;
+			if (entry->seqn != b->min_seqn)
+				continue;
+			skipped = 0;
+		}
+		order_buf->head = (order_buf->head + 1) & order_buf->mask;
+		__atomic_store_n(&b->min_seqn, b->min_seqn + 1,
+				__ATOMIC_RELEASE);
+	}
+
+	return drain_cnt;
+}
+
 unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs)
@@ -372,6 +534,9 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 	struct cir_buffer *order_buf = &b->order_buf,
 			*ready_buf = &b->ready_buf;
 
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_drain_mp(b, mbufs, max_mbufs, 0, 0);
+
 	/* Try to fetch requested number of mbufs from ready buffer */
 	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
 		mbufs[drain_cnt++] = ready_buf->entries[ready_buf->tail];
@@ -392,3 +557,47 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 
 	return drain_cnt;
 }
+
+unsigned int
+rte_reorder_drain_up_to_seqn(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned int max_mbufs, uint32_t seqn)
+{
+	unsigned int drain_cnt = 0, skipped = 0;
+
+	struct cir_buffer *order_buf = &b->order_buf,
+			*ready_buf = &b->ready_buf;
+
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_drain_mp(b, mbufs, max_mbufs, 1, seqn);
+
+	/* Everything in the ready buffer precedes min_seqn */
+	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
+		mbufs[drain_cnt++] = ready_buf->entries[ready_buf->tail];
+		ready_buf->tail = (ready_buf->tail + 1) & ready_buf->mask;
+	}
+
+	if (!b->is_initialized)
+		return drain_cnt;
+
+	/*
+	 * Walk the order buffer up to seqn, skipping the gaps: the mbufs
+	 * missing there are considered lost.
+	 */
+	while ((drain_cnt < max_mbufs) && (int32_t)(seqn - b->min_seqn) > 0) {
+		if (order_buf->entries[order_buf->head] != NULL) {
+			mbufs[drain_cnt++] = order_buf->entries[order_buf->head];
+			order_buf->entries[order_buf->head] = NULL;
+			skipped = 0;
+		} else if (++skipped == order_buf->size) {
+			/* Whole window empty, jump straight to seqn */
+			order_buf->head = (order_buf->head +
+					seqn - b->min_seqn) & order_buf->mask;
+			b->min_seqn = seqn;
+			break;
+		}
+		b->min_seqn++;
+		order_buf->head = (order_buf->head + 1) & order_buf->mask;
+	}
+
+	return drain_cnt;
+}
@@ -15,6 +15,7 @@
  *
  */
 
+#include <rte_compat.h>
 #include <rte_mbuf.h>
 
 #ifdef __cplusplus
@@ -23,6 +24,16 @@ extern "C" {
 
 struct rte_reorder_buffer;
 
+/**
+ * Flag for rte_reorder_create_with_flags(): several threads may insert mbufs
+ * concurrently, while a single thread drains the buffer. Inserting is then
+ * lock-free, but only the drain functions move the reorder window: an early
+ * mbuf gets ENOSPC instead of pushing the window forward. A late mbuf whose
+ * insertion races with the window moving past it is returned by the next
+ * drain, out of sequence order.
+ */
+#define RTE_REORDER_F_MP_INSERT 0x1
+
 /**
  * Create a new reorder buffer instance
  *
@@ -45,6 +56,35 @@ struct rte_reorder_buffer;
 struct rte_reorder_buffer *
 rte_reorder_create(const char *name, unsigned socket_id, unsigned int size);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new reorder buffer instance with extra behaviour flags
+ *
+ * Same as rte_reorder_create(), the flags being kept across
+ * rte_reorder_reset().
+ *
+ * @param name
+ *   The name to be given to the reorder buffer instance.
+ * @param socket_id
+ *   The NUMA node on which the memory for the reorder buffer
+ *   instance is to be reserved.
+ * @param size
+ *   Max number of elements that can be stored in the reorder buffer
+ * @param flags
+ *   Zero or RTE_REORDER_F_MP_INSERT.
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - EINVAL - invalid parameters
+ */
+__rte_experimental
+struct rte_reorder_buffer *
+rte_reorder_create_with_flags(const char *name, unsigned int socket_id,
+		unsigned int size, unsigned int flags);
+
 /**
  * Initializes given reorder buffer instance
  *
@@ -83,6 +123,8 @@ rte_reorder_find_existing(const char *name);
 /**
  * Reset the given reorder buffer instance with initial values.
  *
+ * Must not be called while mbufs are being inserted or drained.
+ *
  * @param b
  *   Reorder buffer instance which has to be reset
  */
@@ -125,6 +167,34 @@ rte_reorder_free(struct rte_reorder_buffer *b);
 int
 rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Insert a burst of mbufs in reorder buffer in their correct positions
+ *
+ * Same as calling rte_reorder_insert() on each mbuf in turn, stopping at the
+ * first one which cannot be inserted.
+ *
+ * @param b
+ *   Reorder buffer where the mbufs have to be inserted.
+ * @param mbufs
+ *   Array of mbufs, none of them NULL.
+ * @param nb_mbufs
+ *   Number of mbufs in the array.
+ * @return
+ *   Number of mbufs inserted, from the start of the array. If lower than
+ *   nb_mbufs, rte_errno is set as by rte_reorder_insert() for the mbuf
+ *   which failed, the remaining ones being left untouched:
+ *    - EINVAL - invalid parameters
+ *    - ENOSPC - no room for this mbuf yet, retry after a drain
+ *    - ERANGE - mbuf out of range of the window
+ */
+__rte_experimental
+unsigned int
+rte_reorder_insert_bulk(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int nb_mbufs);
+
 /**
  * Fetch reordered buffers
  *
@@ -146,6 +216,34 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Fetch reordered buffers up to a sequence number
+ *
+ * Returns in-order buffers whose sequence number is lower than seqn,
+ * skipping over the missing ones: the window is moved to seqn even if
+ * some mbufs before it have not been inserted, and such mbufs are then
+ * considered late. This lets a caller bound the time spent waiting for
+ * lost packets.
+ *
+ * @param b
+ *   Reorder buffer instance from which packets are to be drained
+ * @param mbufs
+ *   array of mbufs where reordered packets will be inserted from reorder buffer
+ * @param max_mbufs
+ *   the number of elements in the mbufs array.
+ * @param seqn
+ *   Sequence number to drain up to, excluded.
+ * @return
+ *   number of mbuf pointers written to mbufs. 0 <= N <= max_mbufs.
+ */
+__rte_experimental
+unsigned int
+rte_reorder_drain_up_to_seqn(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned int max_mbufs, uint32_t seqn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -131,6 +131,36 @@ struct rte_sched_subport_params {
 
 	/** Enforcement period for rates (measured in milliseconds) */
 	uint32_t tc_period;
+
+	/** Number of subport pipes.
+	 * The subport can enable/allocate fewer pipes than the maximum
+	 * number set through struct port_params::n_pipes_per_subport,
+	 * as needed, to avoid memory allocation for the queues of the
+	 * pipes that are not really needed.
+	 */
+	uint32_t n_pipes_per_subport_enabled;
+
+	/** Packet queue size for each traffic class.
+	 * All the pipes within the same subport share the similar
+	 * configuration for the queues.
+	 */
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+
+	/** Pipe profile table.
+	 * Every pipe is configured using one of the profiles from this table.
+	 */
+	struct rte_sched_pipe_params *pipe_profiles;
+
+	/** Profiles in the pipe profile table */
+	uint32_t n_pipe_profiles;
+
+	/** Max allowed profiles in the pipe profile table */
+	uint32_t n_max_pipe_profiles;
+
+#ifdef RTE_SCHED_RED
+	/** RED parameters */
+	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][RTE_COLORS];
+#endif
 };
 
 /** Subport statistics */
@@ -224,30 +254,26 @@ struct rte_sched_port_params {
 	/** Number of subports */
 	uint32_t n_subports_per_port;
 
-	/** Number of subport_pipes */
-	uint32_t n_pipes_per_subport;
-
-	/** Packet queue size for each traffic class.
-	 * All the pipes within the same subport share the similar
-	 * configuration for the queues.
+	/** Maximum number of subport pipes.
+	 * This parameter is used to reserve a fixed number of bits
+	 * in struct rte_mbuf::sched.queue_id for the pipe_id for all
+	 * the subports of the same port.
 	 */
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-
-	/** Pipe profile table.
-	 * Every pipe is configured using one of the profiles from this table.
-	 */
-	struct rte_sched_pipe_params *pipe_profiles;
+	uint32_t n_pipes_per_subport;
+};
 
-	/** Profiles in the pipe profile table */
-	uint32_t n_pipe_profiles;
+/** Port shaper configuration parameters. */
+struct rte_sched_shaper_params {
+	/** CPU socket ID */
+	int socket;
 
-	/** Max profiles allowed in the pipe profile table */
-	uint32_t n_max_pipe_profiles;
+	/** Output port rate (measured in bytes per second) */
+	uint64_t rate;
 
-#ifdef RTE_SCHED_RED
-	/** RED parameters */
-	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][RTE_COLORS];
-#endif
+	/** Token bucket size (measured in bytes), i.e. the burst size shared
+	 * by all the ports attached to the shaper.
+	 */
+	uint64_t tb_size;
 };
 
 /*
@@ -279,26 +305,70 @@ rte_sched_port_free(struct rte_sched_port *port);
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice.
  *
- * Hierarchical scheduler pipe profile add
+ * Hierarchical scheduler port shaper create
+ *
+ * A physical port can be split into several scheduler ports (shards),
+ * each one run by a different lcore. All the shards are configured with
+ * the same port parameters, each shard configuring only the subports it
+ * owns, and the packets of a subport must only be enqueued to the shard
+ * owning it. The port shaper enforces the physical port rate for all the
+ * shards attached to it: each dequeue grabs the credits it may need from
+ * the shared token bucket, stops when they are consumed and gives the
+ * unused ones back.
+ *
+ * @param params
+ *   Port shaper configuration parameter structure
+ * @return
+ *   Handle to port shaper instance upon success or NULL otherwise.
+ */
+__rte_experimental
+struct rte_sched_shaper *
+rte_sched_shaper_create(struct rte_sched_shaper_params *params);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port shaper free
+ *
+ * The ports attached to the shaper must be detached or freed first.
+ *
+ * @param shaper
+ *   Handle to port shaper instance
+ */
+__rte_experimental
+void
+rte_sched_shaper_free(struct rte_sched_shaper *shaper);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler port shaper attach
+ *
+ * Must not be called while the port is being dequeued.
  *
  * @param port
  *   Handle to port scheduler instance
- * @param params
- *   Pipe profile parameters
- * @param pipe_profile_id
- *   Set to valid profile id when profile is added successfully.
+ * @param shaper
+ *   Handle to port shaper instance, NULL to detach the port from its shaper
  * @return
  *   0 upon success, error code otherwise
  */
 __rte_experimental
 int
-rte_sched_port_pipe_profile_add(struct rte_sched_port *port,
-	struct rte_sched_pipe_params *params,
-	uint32_t *pipe_profile_id);
+rte_sched_port_shaper_attach(struct rte_sched_port *port,
+	struct rte_sched_shaper *shaper);
 
 /**
  * Hierarchical scheduler subport configuration
  *
+ * The first call for a given subport allocates the subport data structures
+ * (pipes, queues, pipe profile table) on the port CPU socket, as sized by
+ * the n_pipes_per_subport_enabled, qsize and n_max_pipe_profiles fields.
+ * Subsequent calls for the same subport only update its token bucket and
+ * traffic class rates, the other fields are ignored.
+ *
  * @param port
  *   Handle to port scheduler instance
  * @param subport_id
@@ -313,6 +383,30 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	uint32_t subport_id,
 	struct rte_sched_subport_params *params);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler subport pipe profile add
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param params
+ *   Pipe profile parameters
+ * @param pipe_profile_id
+ *   Set to valid profile id when profile is added successfully.
+ * @return
+ *   0 upon success, error code otherwise
+ */
+__rte_experimental
+int
+rte_sched_subport_pipe_profile_add(struct rte_sched_port *port,
+	uint32_t subport_id,
+	struct rte_sched_pipe_params *params,
+	uint32_t *pipe_profile_id);
+
 /**
  * Hierarchical scheduler pipe configuration
  *
@@ -323,7 +417,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
  * @param pipe_id
  *   Pipe ID within subport
  * @param pipe_profile
- *   ID of port-level pre-configured pipe profile
+ *   ID of subport-level pre-configured pipe profile
  * @return
  *   0 upon success, error code otherwise
  */
@@ -336,13 +430,16 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 /**
  * Hierarchical scheduler memory footprint size per port
  *
- * @param params
+ * @param port_params
  *   Port scheduler configuration parameter structure
+ * @param subport_params
+ *   Array of subport parameter structures, one entry per subport
  * @return
  *   Memory footprint size in bytes upon success, 0 otherwise
  */
 uint32_t
-rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
+rte_sched_port_get_memory_footprint(struct rte_sched_port_params *port_params,
+	struct rte_sched_subport_params **subport_params);
 
 /*
  * Statistics
@@ -456,7 +553,10 @@ rte_sched_port_pkt_read_color(const struct rte_mbuf *pkt);
  * identified by reading the hierarchy path from the packet
  * descriptor; if the queue is full or congested and the packet is not
  * written to the queue, then the packet is automatically dropped
- * without any action required from the caller.
+ * without any action required from the caller. Packets whose subport is
+ * not configured on this port or whose pipe is not enabled in its subport
+ * (see n_pipes_per_subport_enabled) are dropped the same way; they are not
+ * counted in any statistics, as their queue does not exist.
  *
  * @param port
  *   Handle to port scheduler instance
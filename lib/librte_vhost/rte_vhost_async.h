@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_VHOST_ASYNC_H_
+#define _RTE_VHOST_ASYNC_H_
+
+/**
+ * @file
+ * Interface to offload the data copies of the vhost enqueue path to a
+ * copy engine, the CPU of another lcore or a DMA engine.
+ *
+ * The packets of an enqueue burst are submitted to the copy engine, and
+ * returned to the guest once the engine reported their copies done.
+ */
+
+#include <stdint.h>
+
+#include <rte_compat.h>
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A copy of contiguous memory, from a mbuf to a guest buffer.
+ */
+struct rte_vhost_async_seg {
+	void *src; /**< source address */
+	void *dst; /**< destination address */
+	uint32_t len; /**< number of bytes to copy */
+};
+
+/**
+ * The copies of one packet.
+ */
+struct rte_vhost_async_desc {
+	struct rte_vhost_async_seg *segs; /**< copies of the packet */
+	uint16_t nr_segs; /**< number of copies */
+};
+
+/**
+ * Operations of a copy engine, never called concurrently on a virtqueue.
+ * They are also called from the vhost-user thread, to complete the packets
+ * in flight when the guest memory is about to be unmapped.
+ */
+struct rte_vhost_async_channel_ops {
+	/**
+	 * Submit the copies of packets to the copy engine.
+	 * The descriptors are only valid during the call.
+	 *
+	 * @param vid
+	 *  The identifier of the vhost device.
+	 * @param queue_id
+	 *  The virtqueue index.
+	 * @param descs
+	 *  The copies of each packet.
+	 * @param count
+	 *  The number of packets.
+	 * @return
+	 *  The number of packets accepted, from the first one,
+	 *  or a negative value on error.
+	 */
+	int32_t (*transfer_data)(int vid, uint16_t queue_id,
+			const struct rte_vhost_async_desc *descs,
+			uint16_t count);
+	/**
+	 * Check the completion of submitted packets.
+	 * The packets are completed in the order they are submitted.
+	 *
+	 * @param vid
+	 *  The identifier of the vhost device.
+	 * @param queue_id
+	 *  The virtqueue index.
+	 * @param max_packets
+	 *  The maximum number of packets to report.
+	 * @return
+	 *  The number of packets whose copies all completed since the
+	 *  previous call, or a negative value on error.
+	 */
+	int32_t (*check_completed_copies)(int vid, uint16_t queue_id,
+			uint16_t max_packets);
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Register a copy engine for the enqueue path of a virtqueue.
+ * Only the split ring is supported. Once registered, the virtqueue
+ * is used with rte_vhost_submit_enqueue_burst() and
+ * rte_vhost_poll_enqueue_completed() instead of
+ * rte_vhost_enqueue_burst().
+ *
+ * @param vid
+ *  The identifier of the vhost device.
+ * @param queue_id
+ *  The virtqueue index.
+ * @param threshold
+ *  Packets shorter than this number of bytes are copied by the CPU
+ *  calling rte_vhost_submit_enqueue_burst().
+ * @param ops
+ *  The operations of the copy engine.
+ * @return
+ *  0 on success, -1 on failure.
+ */
+__rte_experimental
+int
+rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+		uint32_t threshold, struct rte_vhost_async_channel_ops *ops);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Unregister the copy engine of a virtqueue.
+ * All the submitted packets must have been completed.
+ *
+ * @param vid
+ *  The identifier of the vhost device.
+ * @param queue_id
+ *  The virtqueue index.
+ * @return
+ *  0 on success, -1 on failure.
+ */
+__rte_experimental
+int
+rte_vhost_async_channel_unregister(int vid, uint16_t queue_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Reserve guest buffers for a burst of packets and submit their copies.
+ * The packets shorter than the threshold of the channel, or all the
+ * packets while the dirty pages are logged, are copied synchronously.
+ * The submitted packets are owned by vhost until they are returned by
+ * rte_vhost_poll_enqueue_completed().
+ *
+ * @param vid
+ *  The identifier of the vhost device.
+ * @param queue_id
+ *  The virtqueue index.
+ * @param pkts
+ *  The packets to enqueue.
+ * @param count
+ *  The number of packets.
+ * @return
+ *  The number of packets submitted.
+ */
+__rte_experimental
+uint16_t
+rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Return to the guest the submitted packets whose copies are completed,
+ * in submission order, and give them back to the caller. The packets in
+ * flight when the device is destroyed, reset or given a new memory table
+ * are waited for and freed by vhost.
+ *
+ * @param vid
+ *  The identifier of the vhost device.
+ * @param queue_id
+ *  The virtqueue index.
+ * @param pkts
+ *  The array filled with the completed packets.
+ * @param count
+ *  The size of the array.
+ * @return
+ *  The number of completed packets.
+ */
+__rte_experimental
+uint16_t
+rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+		struct rte_mbuf **pkts, uint16_t count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Get the number of packets submitted to a virtqueue and not completed.
+ *
+ * @param vid
+ *  The identifier of the vhost device.
+ * @param queue_id
+ *  The virtqueue index.
+ * @return
+ *  The number of packets in flight, or -1 on failure.
+ */
+__rte_experimental
+int
+rte_vhost_async_get_inflight(int vid, uint16_t queue_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_VHOST_ASYNC_H_ */
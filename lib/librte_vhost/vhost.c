@@ -257,6 +257,20 @@ cleanup_device(struct virtio_net *dev, int destroy)
 		cleanup_vq(dev->virtqueue[i], destroy);
 }
 
+static void
+vhost_free_async_mem(struct vhost_virtqueue *vq)
+{
+	rte_free(vq->async_pkts_info);
+	rte_free(vq->async_used);
+	rte_free(vq->async_descs);
+	rte_free(vq->async_segs);
+
+	vq->async_pkts_info = NULL;
+	vq->async_used = NULL;
+	vq->async_descs = NULL;
+	vq->async_segs = NULL;
+}
+
 void
 free_vq(struct virtio_net *dev, struct vhost_virtqueue *vq)
 {
@@ -265,6 +279,7 @@ free_vq(struct virtio_net *dev, struct vhost_virtqueue *vq)
 	else
 		rte_free(vq->shadow_used_split);
 	rte_free(vq->batch_copy_elems);
+	vhost_free_async_mem(vq);
 	rte_mempool_free(vq->iotlb_pool);
 	rte_free(vq);
 }
@@ -428,7 +443,16 @@ reset_vring_queue(struct virtio_net *dev, uint32_t vring_idx)
 	}
 
 	vq = dev->virtqueue[vring_idx];
+	/* The copy engine still owns the buffers of the packets in flight */
+	if (vq->async_pkts_inflight_n) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) async copies in flight, vring %u not reset\n",
+			dev->vid, vring_idx);
+		return;
+	}
+
 	callfd = vq->callfd;
+	vhost_free_async_mem(vq);
 	init_vring_queue(dev, vring_idx);
 	vq->callfd = callfd;
 }
@@ -976,3 +1000,129 @@ int rte_vhost_extern_callback_register(int vid,
 	dev->extern_data = ctx;
 	return 0;
 }
+
+int rte_vhost_async_channel_register(int vid, uint16_t queue_id,
+		uint32_t threshold, struct rte_vhost_async_channel_ops *ops)
+{
+	struct vhost_virtqueue *vq;
+	struct virtio_net *dev = get_device(vid);
+	int ret = -1;
+
+	if (dev == NULL || ops == NULL)
+		return -1;
+
+	if (queue_id >= VHOST_MAX_VRING)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (vq == NULL || vq->size == 0)
+		return -1;
+
+	if (vq_is_packed(dev)) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) async copy is not supported on packed ring.\n",
+			vid);
+		return -1;
+	}
+
+	if (ops->transfer_data == NULL ||
+			ops->check_completed_copies == NULL)
+		return -1;
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (vq->async_registered) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) async copy already registered on queue %u.\n",
+			vid, queue_id);
+		goto out;
+	}
+
+	vq->async_pkts_info = rte_malloc(NULL,
+			vq->size * sizeof(struct async_inflight_info),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_used = rte_malloc(NULL,
+			vq->size * sizeof(struct vring_used_elem),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_descs = rte_malloc(NULL,
+			MAX_PKT_BURST * sizeof(struct rte_vhost_async_desc),
+			RTE_CACHE_LINE_SIZE);
+	vq->async_segs = rte_malloc(NULL,
+			VHOST_MAX_ASYNC_VEC *
+			sizeof(struct rte_vhost_async_seg),
+			RTE_CACHE_LINE_SIZE);
+	if (vq->async_pkts_info == NULL || vq->async_used == NULL ||
+			vq->async_descs == NULL || vq->async_segs == NULL) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) failed to allocate async copy memory.\n", vid);
+		vhost_free_async_mem(vq);
+		goto out;
+	}
+
+	vq->async_ops = *ops;
+	vq->async_threshold = threshold;
+	vq->async_pkts_idx = 0;
+	vq->async_pkts_inflight_n = 0;
+	vq->async_done = 0;
+	vq->async_used_idx = 0;
+	vq->async_last_used_idx = 0;
+	vq->async_registered = true;
+	ret = 0;
+
+out:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return ret;
+}
+
+int rte_vhost_async_channel_unregister(int vid, uint16_t queue_id)
+{
+	struct vhost_virtqueue *vq;
+	struct virtio_net *dev = get_device(vid);
+	int ret = -1;
+
+	if (dev == NULL || queue_id >= VHOST_MAX_VRING)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (vq == NULL)
+		return -1;
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (!vq->async_registered) {
+		ret = 0;
+		goto out;
+	}
+
+	if (vq->async_pkts_inflight_n) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"(%d) %u async packets in flight on queue %u.\n",
+			vid, vq->async_pkts_inflight_n, queue_id);
+		goto out;
+	}
+
+	vhost_free_async_mem(vq);
+	vq->async_registered = false;
+	ret = 0;
+
+out:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return ret;
+}
+
+int rte_vhost_async_get_inflight(int vid, uint16_t queue_id)
+{
+	struct vhost_virtqueue *vq;
+	struct virtio_net *dev = get_device(vid);
+
+	if (dev == NULL || queue_id >= VHOST_MAX_VRING)
+		return -1;
+
+	vq = dev->virtqueue[queue_id];
+	if (vq == NULL || !vq->async_registered)
+		return -1;
+
+	return vq->async_pkts_inflight_n;
+}
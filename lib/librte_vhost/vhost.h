@@ -22,6 +22,7 @@
 
 #include "rte_vhost.h"
 #include "rte_vdpa.h"
+#include "rte_vhost_async.h"
 
 /* Used to indicate that the device is running on a data core */
 #define VIRTIO_DEV_RUNNING 1
@@ -37,8 +38,13 @@
 
 #define BUF_VECTOR_MAX 256
 
+#define MAX_PKT_BURST 32
+
 #define VHOST_LOG_CACHE_NR 32
 
+/* Max number of copies submitted to a copy engine in a burst */
+#define VHOST_MAX_ASYNC_VEC 2048
+
 /**
  * Structure contains buffer address, length and descriptor index
  * from vring to do scatter RX.
@@ -64,6 +70,15 @@ struct zcopy_mbuf {
 };
 TAILQ_HEAD(zcopy_mbuf_list, zcopy_mbuf);
 
+/*
+ * Structure contains the info of a packet submitted to a copy engine.
+ */
+struct async_inflight_info {
+	struct rte_mbuf *mbuf;
+	uint16_t descs; /* number of used ring entries of the packet */
+	uint16_t async; /* copied by the copy engine */
+};
+
 /*
  * Structure contains the info for each batched memory copy.
  */
@@ -155,6 +170,23 @@ struct vhost_virtqueue {
 	TAILQ_HEAD(, vhost_iotlb_entry) iotlb_list;
 	int				iotlb_cache_nr;
 	TAILQ_HEAD(, vhost_iotlb_entry) iotlb_pending_list;
+
+	/* Enqueue copies offloaded to a copy engine */
+	struct rte_vhost_async_channel_ops async_ops;
+	/* Packets in flight, indexed by submission order */
+	struct async_inflight_info *async_pkts_info;
+	/* Used ring entries of the packets in flight */
+	struct vring_used_elem *async_used;
+	struct rte_vhost_async_desc *async_descs;
+	struct rte_vhost_async_seg *async_segs;
+	uint32_t		async_threshold;
+	uint16_t		async_pkts_idx;
+	uint16_t		async_pkts_inflight_n;
+	/* Completions reported by the engine, not yet returned */
+	uint16_t		async_done;
+	uint16_t		async_used_idx;
+	uint16_t		async_last_used_idx;
+	bool			async_registered;
 } __rte_cache_aligned;
 
 /* Old kernels have no such macros defined */
@@ -463,6 +495,7 @@ get_device(int vid)
 int vhost_new_device(void);
 void cleanup_device(struct virtio_net *dev, int destroy);
 void reset_device(struct virtio_net *dev);
+void vhost_async_drain(struct virtio_net *dev, uint16_t queue_id);
 void vhost_destroy_device(int);
 void vhost_destroy_device_notify(struct virtio_net *dev);
 
@@ -134,6 +134,10 @@ free_mem_region(struct virtio_net *dev)
 		}
 	}
 
+	/* The copy engine may still write to the guest memory */
+	for (i = 0; i < dev->nr_vring; i++)
+		vhost_async_drain(dev, i);
+
 	for (i = 0; i < dev->mem->nregions; i++) {
 		reg = &dev->mem->regions[i];
 		if (reg->host_user_addr) {
@@ -1270,6 +1274,9 @@ vhost_user_get_vring_base(struct virtio_net **pdev,
 	/* We have to stop the queue (virtio) if it is running. */
 	vhost_destroy_device_notify(dev);
 
+	/* The packets in flight are used before the ring is stopped */
+	vhost_async_drain(dev, msg->payload.state.index);
+
 	dev->flags &= ~VIRTIO_DEV_READY;
 	dev->flags &= ~VIRTIO_DEV_VDPA_CONFIGURED;
 
@@ -4,6 +4,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <unistd.h>
 #include <linux/virtio_net.h>
 
 #include <rte_mbuf.h>
@@ -21,10 +22,17 @@
 #include "iotlb.h"
 #include "vhost.h"
 
-#define MAX_PKT_BURST 32
-
 #define MAX_BATCH_LEN 256
 
+/* Descriptors of a packed ring processed as one group, one cache line */
+#define PACKED_BATCH_SIZE ((uint16_t)(RTE_CACHE_LINE_SIZE / \
+			   sizeof(struct vring_packed_desc)))
+#define PACKED_BATCH_MASK (PACKED_BATCH_SIZE - 1)
+#define PACKED_SINGLE_DESC_FLAGS (VRING_DESC_F_NEXT | VRING_DESC_F_INDIRECT)
+
+/* Time without async completion after which a drain gives up */
+#define VHOST_ASYNC_DRAIN_TIMEOUT_MS 1000
+
 static  __rte_always_inline bool
 rxvq_is_mergeable(struct virtio_net *dev)
 {
@@ -169,6 +177,52 @@ update_shadow_used_ring_packed(struct vhost_virtqueue *vq,
 	vq->shadow_used_packed[i].count = count;
 }
 
+/*
+ * Return a batch of single descriptors to the driver. The shadow used
+ * ring must be empty, so that the used entries of the batch are written
+ * over its avail descriptors. The ids and lengths of the whole batch are
+ * written before its flags, which are written together after a single
+ * barrier.
+ */
+static __rte_always_inline void
+flush_used_batch_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			uint16_t *ids, uint32_t *lens, uint16_t flags)
+{
+	uint16_t used_idx = vq->last_used_idx;
+	uint16_t i;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		vq->desc_packed[used_idx + i].id = ids[i];
+		vq->desc_packed[used_idx + i].len = lens[i];
+	}
+
+	if (vq->used_wrap_counter)
+		flags |= VRING_DESC_F_USED | VRING_DESC_F_AVAIL;
+
+	rte_smp_wmb();
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		vq->desc_packed[used_idx + i].flags = flags;
+
+	vhost_log_cache_used_vring(dev, vq,
+				used_idx * sizeof(struct vring_packed_desc),
+				sizeof(struct vring_packed_desc) *
+				PACKED_BATCH_SIZE);
+	vhost_log_cache_sync(dev, vq);
+
+	vq->last_used_idx += PACKED_BATCH_SIZE;
+	if (vq->last_used_idx >= vq->size) {
+		vq->used_wrap_counter ^= 1;
+		vq->last_used_idx -= vq->size;
+	}
+
+	vq->last_avail_idx += PACKED_BATCH_SIZE;
+	if (vq->last_avail_idx >= vq->size) {
+		vq->avail_wrap_counter ^= 1;
+		vq->last_avail_idx -= vq->size;
+	}
+}
+
 static inline void
 do_data_copy_enqueue(struct virtio_net *dev, struct vhost_virtqueue *vq)
 {
@@ -613,6 +667,57 @@ reserve_avail_buf_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return 0;
 }
 
+/*
+ * Returns -1 if the next descriptors are not an aligned batch of
+ * available single descriptors, 0 on success with their buffers mapped.
+ */
+static __rte_always_inline int
+reserve_avail_batch_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			   uint64_t *desc_addrs, uint64_t *lens, uint16_t *ids,
+			   uint8_t perm)
+{
+	struct vring_packed_desc *descs = vq->desc_packed;
+	uint16_t avail_idx = vq->last_avail_idx;
+	uint64_t buf_lens[PACKED_BATCH_SIZE];
+	uint16_t i;
+
+	if (unlikely(avail_idx & PACKED_BATCH_MASK))
+		return -1;
+
+	if (unlikely((uint32_t)(avail_idx + PACKED_BATCH_SIZE) > vq->size))
+		return -1;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(!desc_is_avail(&descs[avail_idx + i],
+					    vq->avail_wrap_counter)))
+			return -1;
+	}
+
+	rte_smp_rmb();
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(descs[avail_idx + i].flags &
+			     PACKED_SINGLE_DESC_FLAGS))
+			return -1;
+		lens[i] = descs[avail_idx + i].len;
+		ids[i] = descs[avail_idx + i].id;
+	}
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		buf_lens[i] = lens[i];
+		desc_addrs[i] = vhost_iova_to_vva(dev, vq,
+						  descs[avail_idx + i].addr,
+						  &buf_lens[i], perm);
+	}
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(!desc_addrs[i] || buf_lens[i] != lens[i]))
+			return -1;
+	}
+
+	return 0;
+}
+
 static __rte_noinline void
 copy_vnet_hdr_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 		struct buf_vector *buf_vec,
@@ -774,6 +879,105 @@ copy_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return error;
 }
 
+/*
+ * Same as copy_mbuf_to_desc(), except that the data copies are
+ * described in segs for a copy engine instead of being done.
+ */
+static __rte_always_inline int
+async_mbuf_to_desc(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			struct rte_mbuf *m, struct buf_vector *buf_vec,
+			uint16_t nr_vec, uint16_t num_buffers,
+			struct rte_vhost_async_seg *segs, uint16_t *nr_segs,
+			uint16_t max_segs)
+{
+	uint32_t vec_idx = 0;
+	uint32_t mbuf_offset, mbuf_avail;
+	uint32_t buf_offset, buf_avail;
+	uint64_t buf_addr, buf_len;
+	uint32_t cpy_len;
+	struct virtio_net_hdr_mrg_rxbuf tmp_hdr, *hdr;
+	uint16_t seg_idx = 0;
+
+	if (unlikely(m == NULL))
+		return -1;
+
+	buf_addr = buf_vec[vec_idx].buf_addr;
+	buf_len = buf_vec[vec_idx].buf_len;
+
+	if (unlikely(buf_len < dev->vhost_hlen && nr_vec <= 1))
+		return -1;
+
+	if (unlikely(buf_len < dev->vhost_hlen))
+		hdr = &tmp_hdr;
+	else
+		hdr = (struct virtio_net_hdr_mrg_rxbuf *)(uintptr_t)buf_addr;
+
+	/* the header is small, it is written by the CPU */
+	virtio_enqueue_offload(m, &hdr->hdr);
+	if (rxvq_is_mergeable(dev))
+		ASSIGN_UNLESS_EQUAL(hdr->num_buffers, num_buffers);
+
+	if (unlikely(hdr == &tmp_hdr)) {
+		copy_vnet_hdr_to_desc(dev, vq, buf_vec, hdr);
+
+		buf_offset = dev->vhost_hlen - buf_len;
+		vec_idx++;
+		buf_addr = buf_vec[vec_idx].buf_addr;
+		buf_len = buf_vec[vec_idx].buf_len;
+		buf_avail = buf_len - buf_offset;
+	} else {
+		PRINT_PACKET(dev, (uintptr_t)buf_addr, dev->vhost_hlen, 0);
+
+		buf_offset = dev->vhost_hlen;
+		buf_avail = buf_len - dev->vhost_hlen;
+	}
+
+	mbuf_avail  = rte_pktmbuf_data_len(m);
+	mbuf_offset = 0;
+	while (mbuf_avail != 0 || m->next != NULL) {
+		/* done with current buf, get the next one */
+		if (buf_avail == 0) {
+			vec_idx++;
+			if (unlikely(vec_idx >= nr_vec))
+				return -1;
+
+			buf_addr = buf_vec[vec_idx].buf_addr;
+			buf_len = buf_vec[vec_idx].buf_len;
+
+			buf_offset = 0;
+			buf_avail  = buf_len;
+		}
+
+		/* done with current mbuf, get the next one */
+		if (mbuf_avail == 0) {
+			m = m->next;
+
+			mbuf_offset = 0;
+			mbuf_avail  = rte_pktmbuf_data_len(m);
+		}
+
+		if (unlikely(seg_idx >= max_segs))
+			return -1;
+
+		cpy_len = RTE_MIN(buf_avail, mbuf_avail);
+
+		segs[seg_idx].src = rte_pktmbuf_mtod_offset(m, void *,
+				mbuf_offset);
+		segs[seg_idx].dst = (void *)(uintptr_t)(buf_addr + buf_offset);
+		segs[seg_idx].len = cpy_len;
+		seg_idx++;
+
+		mbuf_avail  -= cpy_len;
+		mbuf_offset += cpy_len;
+		buf_avail  -= cpy_len;
+		buf_offset += cpy_len;
+	}
+
+	*nr_segs = seg_idx;
+
+	return 0;
+}
+
 static __rte_noinline uint32_t
 virtio_dev_rx_split(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	struct rte_mbuf **pkts, uint32_t count)
@@ -831,6 +1035,69 @@ virtio_dev_rx_split(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return pkt_idx;
 }
 
+/*
+ * Enqueue a batch of single segment packets into single descriptors.
+ * Returns -1 when the batch cannot be done at once, nothing is consumed
+ * then.
+ */
+static __rte_always_inline int
+virtio_dev_rx_batch_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			   struct rte_mbuf **pkts)
+{
+	struct vring_packed_desc *descs = vq->desc_packed;
+	uint16_t avail_idx = vq->last_avail_idx;
+	uint32_t buf_offset = dev->vhost_hlen;
+	uint64_t desc_addrs[PACKED_BATCH_SIZE];
+	uint64_t lens[PACKED_BATCH_SIZE];
+	uint32_t used_lens[PACKED_BATCH_SIZE];
+	uint16_t ids[PACKED_BATCH_SIZE];
+	struct virtio_net_hdr_mrg_rxbuf *hdr;
+	uint16_t i;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(pkts[i]->next != NULL))
+			return -1;
+	}
+
+	if (reserve_avail_batch_packed(dev, vq, desc_addrs, lens, ids,
+				       VHOST_ACCESS_RW) < 0)
+		return -1;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		used_lens[i] = pkts[i]->pkt_len + buf_offset;
+		if (unlikely(used_lens[i] > lens[i]))
+			return -1;
+	}
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		rte_prefetch0((void *)(uintptr_t)desc_addrs[i]);
+
+	/* Previous packets must be returned before the batch */
+	if (unlikely(vq->shadow_used_idx)) {
+		do_data_copy_enqueue(dev, vq);
+		flush_shadow_used_ring_packed(dev, vq);
+	}
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		hdr = (struct virtio_net_hdr_mrg_rxbuf *)
+			(uintptr_t)desc_addrs[i];
+		virtio_enqueue_offload(pkts[i], &hdr->hdr);
+		if (rxvq_is_mergeable(dev))
+			ASSIGN_UNLESS_EQUAL(hdr->num_buffers, 1);
+
+		rte_memcpy((void *)(uintptr_t)(desc_addrs[i] + buf_offset),
+			   rte_pktmbuf_mtod(pkts[i], void *),
+			   pkts[i]->pkt_len);
+		vhost_log_cache_write(dev, vq, descs[avail_idx + i].addr,
+				      used_lens[i]);
+		PRINT_PACKET(dev, (uintptr_t)desc_addrs[i], used_lens[i], 0);
+	}
+
+	flush_used_batch_packed(dev, vq, ids, used_lens, VRING_DESC_F_WRITE);
+
+	return 0;
+}
+
 static __rte_noinline uint32_t
 virtio_dev_rx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	struct rte_mbuf **pkts, uint32_t count)
@@ -839,11 +1106,17 @@ virtio_dev_rx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	uint16_t num_buffers;
 	struct buf_vector buf_vec[BUF_VECTOR_MAX];
 
-	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+	while (pkt_idx < count) {
 		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + dev->vhost_hlen;
 		uint16_t nr_vec = 0;
 		uint16_t nr_descs = 0;
 
+		if (count - pkt_idx >= PACKED_BATCH_SIZE &&
+		    virtio_dev_rx_batch_packed(dev, vq, &pkts[pkt_idx]) == 0) {
+			pkt_idx += PACKED_BATCH_SIZE;
+			continue;
+		}
+
 		if (unlikely(reserve_avail_buf_packed(dev, vq,
 						pkt_len, buf_vec, &nr_vec,
 						&num_buffers, &nr_descs) < 0)) {
@@ -870,14 +1143,17 @@ virtio_dev_rx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			vq->last_avail_idx -= vq->size;
 			vq->avail_wrap_counter ^= 1;
 		}
+
+		pkt_idx++;
 	}
 
 	do_data_copy_enqueue(dev, vq);
 
-	if (likely(vq->shadow_used_idx)) {
+	if (likely(vq->shadow_used_idx))
 		flush_shadow_used_ring_packed(dev, vq);
+
+	if (likely(pkt_idx))
 		vhost_vring_call_packed(dev, vq);
-	}
 
 	return pkt_idx;
 }
@@ -903,6 +1179,13 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	if (unlikely(vq->enabled == 0))
 		goto out_access_unlock;
 
+	if (unlikely(vq->async_registered)) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%d) %s: async copy registered on queue %d.\n",
+			dev->vid, __func__, queue_id);
+		goto out_access_unlock;
+	}
+
 	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
 		vhost_user_iotlb_rd_lock(vq);
 
@@ -948,6 +1231,371 @@ rte_vhost_enqueue_burst(int vid, uint16_t queue_id,
 	return virtio_dev_rx(dev, queue_id, pkts, count);
 }
 
+/*
+ * Reserve the guest buffers of the packets and submit their copies to
+ * the copy engine. The used ring entries of the packets are kept in
+ * async_used until their copies are completed.
+ */
+static __rte_noinline uint32_t
+virtio_dev_rx_async_submit_split(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint32_t count)
+{
+	struct async_inflight_info *pkts_info = vq->async_pkts_info;
+	struct rte_vhost_async_desc *descs = vq->async_descs;
+	struct rte_vhost_async_seg *segs = vq->async_segs;
+	struct buf_vector buf_vec[BUF_VECTOR_MAX];
+	uint16_t ring_mask = vq->size - 1;
+	uint16_t num_buffers, avail_head, nr_segs;
+	uint16_t seg_idx = 0, n_async = 0;
+	uint32_t pkt_idx, i;
+	int32_t n_xfer;
+	bool cpu_copy;
+	int err;
+
+	/* the dirty pages are logged when the CPU copies */
+	cpu_copy = !!(dev->features & (1ULL << VHOST_F_LOG_ALL));
+
+	avail_head = *((volatile uint16_t *)&vq->avail->idx);
+
+	/*
+	 * The ordering between avail index and
+	 * desc reads needs to be enforced.
+	 */
+	rte_smp_rmb();
+
+	rte_prefetch0(&vq->avail->ring[vq->last_avail_idx & (vq->size - 1)]);
+
+	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + dev->vhost_hlen;
+		struct async_inflight_info *info;
+		uint16_t nr_vec = 0;
+
+		if (unlikely(reserve_avail_buf_split(dev, vq,
+						pkt_len, buf_vec, &num_buffers,
+						avail_head, &nr_vec) < 0)) {
+			VHOST_LOG_DEBUG(VHOST_DATA,
+				"(%d) failed to get enough desc from vring\n",
+				dev->vid);
+			vq->shadow_used_idx -= num_buffers;
+			break;
+		}
+
+		info = &pkts_info[(vq->async_pkts_idx + pkt_idx) & ring_mask];
+		info->mbuf = pkts[pkt_idx];
+		info->descs = num_buffers;
+		info->async = !cpu_copy &&
+			pkts[pkt_idx]->pkt_len >= vq->async_threshold;
+
+		if (info->async) {
+			err = async_mbuf_to_desc(dev, vq, pkts[pkt_idx],
+					buf_vec, nr_vec, num_buffers,
+					&segs[seg_idx], &nr_segs,
+					VHOST_MAX_ASYNC_VEC - seg_idx);
+			if (likely(err == 0)) {
+				descs[n_async].segs = &segs[seg_idx];
+				descs[n_async].nr_segs = nr_segs;
+				n_async++;
+				seg_idx += nr_segs;
+			}
+		} else {
+			err = copy_mbuf_to_desc(dev, vq, pkts[pkt_idx],
+					buf_vec, nr_vec, num_buffers);
+		}
+		if (unlikely(err < 0)) {
+			vq->shadow_used_idx -= num_buffers;
+			break;
+		}
+
+		vq->last_avail_idx += num_buffers;
+	}
+
+	do_data_copy_enqueue(dev, vq);
+
+	if (n_async) {
+		n_xfer = vq->async_ops.transfer_data(dev->vid, queue_id,
+				descs, n_async);
+		if (unlikely(n_xfer < 0)) {
+			RTE_LOG(ERR, VHOST_DATA,
+				"(%d) %s: failed to transfer data for queue %d.\n",
+				dev->vid, __func__, queue_id);
+			n_xfer = 0;
+		}
+
+		/* give back the buffers from the first packet not accepted */
+		if (unlikely(n_xfer < n_async)) {
+			struct async_inflight_info *info;
+			uint32_t n_pkts;
+
+			for (n_pkts = 0; n_pkts < pkt_idx; n_pkts++) {
+				info = &pkts_info[(vq->async_pkts_idx +
+						n_pkts) & ring_mask];
+				if (info->async && n_xfer-- == 0)
+					break;
+			}
+			for (i = n_pkts; i < pkt_idx; i++) {
+				info = &pkts_info[(vq->async_pkts_idx + i) &
+						ring_mask];
+				vq->last_avail_idx -= info->descs;
+				vq->shadow_used_idx -= info->descs;
+			}
+			pkt_idx = n_pkts;
+		}
+	}
+
+	for (i = 0; i < vq->shadow_used_idx; i++)
+		vq->async_used[(vq->async_used_idx + i) & ring_mask] =
+			vq->shadow_used_split[i];
+	vq->async_used_idx += vq->shadow_used_idx;
+	vq->shadow_used_idx = 0;
+
+	vq->async_pkts_idx += pkt_idx;
+	vq->async_pkts_inflight_n += pkt_idx;
+
+	return pkt_idx;
+}
+
+/*
+ * Return to the guest the packets whose copies are completed, in
+ * submission order. The used ring is left untouched when the guest
+ * rings are not accessible.
+ */
+static __rte_noinline uint16_t
+virtio_dev_rx_async_poll_split(struct virtio_net *dev,
+	struct vhost_virtqueue *vq, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count, bool to_guest)
+{
+	struct async_inflight_info *pkts_info = vq->async_pkts_info;
+	uint16_t ring_mask = vq->size - 1;
+	uint16_t start, from, size;
+	uint16_t n_descs = 0;
+	uint16_t i;
+	int32_t n_cpl;
+
+	count = RTE_MIN(count, vq->async_pkts_inflight_n);
+	if (count == 0)
+		return 0;
+
+	if (vq->async_done < count) {
+		n_cpl = vq->async_ops.check_completed_copies(dev->vid,
+				queue_id, count - vq->async_done);
+		if (likely(n_cpl > 0)) {
+			vq->async_done += n_cpl;
+			/* the copies are done before the used ring update */
+			rte_smp_rmb();
+		}
+	}
+
+	start = vq->async_pkts_idx - vq->async_pkts_inflight_n;
+	for (i = 0; i < count; i++) {
+		struct async_inflight_info *info;
+
+		info = &pkts_info[(start + i) & ring_mask];
+		if (info->async) {
+			if (vq->async_done == 0)
+				break;
+			vq->async_done--;
+		}
+		pkts[i] = info->mbuf;
+		n_descs += info->descs;
+	}
+
+	if (i == 0)
+		return 0;
+
+	if (unlikely(!to_guest)) {
+		vq->async_last_used_idx += n_descs;
+		vq->async_pkts_inflight_n -= i;
+		return i;
+	}
+
+	from = vq->async_last_used_idx & ring_mask;
+	if (from + n_descs <= vq->size) {
+		rte_memcpy(vq->shadow_used_split, &vq->async_used[from],
+				n_descs * sizeof(struct vring_used_elem));
+	} else {
+		size = vq->size - from;
+		rte_memcpy(vq->shadow_used_split, &vq->async_used[from],
+				size * sizeof(struct vring_used_elem));
+		rte_memcpy(&vq->shadow_used_split[size], vq->async_used,
+				(n_descs - size) *
+				sizeof(struct vring_used_elem));
+	}
+	vq->shadow_used_idx = n_descs;
+	vq->async_last_used_idx += n_descs;
+	vq->async_pkts_inflight_n -= i;
+
+	flush_shadow_used_ring_split(dev, vq);
+	vhost_vring_call_split(dev, vq);
+
+	return i;
+}
+
+/*
+ * Lock and check a virtqueue for the async enqueue API, the iotlb lock
+ * is held on success.
+ */
+static __rte_always_inline struct vhost_virtqueue *
+async_vq_get(struct virtio_net *dev, uint16_t queue_id, const char *func)
+{
+	struct vhost_virtqueue *vq;
+
+	if (unlikely(!(dev->flags & VIRTIO_DEV_BUILTIN_VIRTIO_NET))) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%d) %s: built-in vhost net backend is disabled.\n",
+			dev->vid, func);
+		return NULL;
+	}
+
+	if (unlikely(!is_valid_virt_queue_idx(queue_id, 0, dev->nr_vring))) {
+		RTE_LOG(ERR, VHOST_DATA, "(%d) %s: invalid virtqueue idx %d.\n",
+			dev->vid, func, queue_id);
+		return NULL;
+	}
+
+	vq = dev->virtqueue[queue_id];
+
+	rte_spinlock_lock(&vq->access_lock);
+
+	if (unlikely(!vq->async_registered)) {
+		RTE_LOG(ERR, VHOST_DATA,
+			"(%d) %s: async copy not registered on queue %d.\n",
+			dev->vid, func, queue_id);
+		goto out_access_unlock;
+	}
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	if (unlikely(vq->access_ok == 0))
+		if (unlikely(vring_translate(dev, vq) < 0))
+			goto out;
+
+	return vq;
+
+out:
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+out_access_unlock:
+	rte_spinlock_unlock(&vq->access_lock);
+
+	return NULL;
+}
+
+static __rte_always_inline void
+async_vq_put(struct virtio_net *dev, struct vhost_virtqueue *vq)
+{
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+
+	rte_spinlock_unlock(&vq->access_lock);
+}
+
+uint16_t
+rte_vhost_submit_enqueue_burst(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	uint32_t nb_tx = 0;
+
+	if (!dev)
+		return 0;
+
+	vq = async_vq_get(dev, queue_id, __func__);
+	if (vq == NULL)
+		return 0;
+
+	if (likely(vq->enabled)) {
+		count = RTE_MIN(count, MAX_PKT_BURST);
+		count = RTE_MIN(count,
+				vq->size - vq->async_pkts_inflight_n);
+		if (count)
+			nb_tx = virtio_dev_rx_async_submit_split(dev, vq,
+					queue_id, pkts, count);
+	}
+
+	async_vq_put(dev, vq);
+
+	return nb_tx;
+}
+
+uint16_t
+rte_vhost_poll_enqueue_completed(int vid, uint16_t queue_id,
+	struct rte_mbuf **pkts, uint16_t count)
+{
+	struct virtio_net *dev = get_device(vid);
+	struct vhost_virtqueue *vq;
+	uint16_t n_pkts;
+
+	if (!dev)
+		return 0;
+
+	vq = async_vq_get(dev, queue_id, __func__);
+	if (vq == NULL)
+		return 0;
+
+	n_pkts = virtio_dev_rx_async_poll_split(dev, vq, queue_id,
+			pkts, count, true);
+
+	async_vq_put(dev, vq);
+
+	return n_pkts;
+}
+
+/*
+ * Wait for the copy engine to complete the packets in flight on a
+ * virtqueue, before its guest memory is unmapped. The completed packets
+ * are returned to the guest while its rings are accessible, and freed
+ * since the application can't poll them anymore. If the engine completes
+ * nothing for VHOST_ASYNC_DRAIN_TIMEOUT_MS, the remaining packets are left
+ * in flight. Called with the virtqueue lock held or with the device
+ * stopped.
+ */
+void
+vhost_async_drain(struct virtio_net *dev, uint16_t queue_id)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[queue_id];
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	unsigned int idle_ms = 0;
+	uint16_t n_pkts, i;
+
+	if (vq == NULL || !vq->async_registered ||
+			vq->async_pkts_inflight_n == 0)
+		return;
+
+	RTE_LOG(INFO, VHOST_CONFIG,
+		"(%d) waiting for %u async packets in flight on queue %u\n",
+		dev->vid, vq->async_pkts_inflight_n, queue_id);
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_lock(vq);
+
+	while (vq->async_pkts_inflight_n) {
+		n_pkts = virtio_dev_rx_async_poll_split(dev, vq, queue_id,
+				pkts, MAX_PKT_BURST, vq->access_ok &&
+				vq->shadow_used_split != NULL);
+		for (i = 0; i < n_pkts; i++)
+			rte_pktmbuf_free(pkts[i]);
+		if (n_pkts != 0) {
+			idle_ms = 0;
+			continue;
+		}
+		/* the copy engine may have failed, don't hang the device */
+		if (++idle_ms > VHOST_ASYNC_DRAIN_TIMEOUT_MS) {
+			RTE_LOG(ERR, VHOST_CONFIG,
+				"(%d) giving up on %u async packets in flight on queue %u\n",
+				dev->vid, vq->async_pkts_inflight_n, queue_id);
+			break;
+		}
+		usleep(1000);
+	}
+
+	if (dev->features & (1ULL << VIRTIO_F_IOMMU_PLATFORM))
+		vhost_user_iotlb_rd_unlock(vq);
+}
+
 static inline bool
 virtio_net_with_host_offload(struct virtio_net *dev)
 {
@@ -1409,6 +2057,78 @@ virtio_dev_tx_split(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return i;
 }
 
+/*
+ * Dequeue a batch of single descriptors into single segment packets.
+ * Returns -1 when the batch cannot be done at once, nothing is consumed
+ * then.
+ */
+static __rte_always_inline int
+virtio_dev_tx_batch_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
+			   struct rte_mempool *mbuf_pool,
+			   struct rte_mbuf **pkts)
+{
+	uint32_t buf_offset = dev->vhost_hlen;
+	uint64_t desc_addrs[PACKED_BATCH_SIZE];
+	uint64_t lens[PACKED_BATCH_SIZE];
+	uint32_t used_lens[PACKED_BATCH_SIZE];
+	uint16_t ids[PACKED_BATCH_SIZE];
+	uint16_t i;
+
+	if (reserve_avail_batch_packed(dev, vq, desc_addrs, lens, ids,
+				       VHOST_ACCESS_RO) < 0)
+		return -1;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(lens[i] <= buf_offset))
+			return -1;
+		rte_prefetch0((void *)(uintptr_t)desc_addrs[i]);
+	}
+
+	if (unlikely(rte_pktmbuf_alloc_bulk(mbuf_pool, pkts,
+					    PACKED_BATCH_SIZE) < 0))
+		return -1;
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(lens[i] - buf_offset >
+			     rte_pktmbuf_tailroom(pkts[i])))
+			goto free_buf;
+	}
+
+	/* Previous packets must be returned before the batch */
+	if (unlikely(vq->shadow_used_idx)) {
+		do_data_copy_dequeue(vq);
+		flush_shadow_used_ring_packed(dev, vq);
+	}
+
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		pkts[i]->pkt_len = lens[i] - buf_offset;
+		pkts[i]->data_len = pkts[i]->pkt_len;
+		rte_memcpy(rte_pktmbuf_mtod(pkts[i], void *),
+			   (void *)(uintptr_t)(desc_addrs[i] + buf_offset),
+			   pkts[i]->pkt_len);
+		PRINT_PACKET(dev, (uintptr_t)(desc_addrs[i] + buf_offset),
+			     pkts[i]->pkt_len, 0);
+		used_lens[i] = 0;
+	}
+
+	if (virtio_net_with_host_offload(dev)) {
+		for (i = 0; i < PACKED_BATCH_SIZE; i++)
+			vhost_dequeue_offload((struct virtio_net_hdr *)
+					      (uintptr_t)desc_addrs[i],
+					      pkts[i]);
+	}
+
+	flush_used_batch_packed(dev, vq, ids, used_lens, 0);
+
+	return 0;
+
+free_buf:
+	for (i = 0; i < PACKED_BATCH_SIZE; i++)
+		rte_pktmbuf_free(pkts[i]);
+
+	return -1;
+}
+
 static __rte_noinline uint16_t
 virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count)
@@ -1448,13 +2168,22 @@ virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	VHOST_LOG_DEBUG(VHOST_DATA, "(%d) about to dequeue %u buffers\n",
 			dev->vid, count);
 
-	for (i = 0; i < count; i++) {
+	i = 0;
+	while (i < count) {
 		struct buf_vector buf_vec[BUF_VECTOR_MAX];
 		uint16_t buf_id;
 		uint32_t dummy_len;
 		uint16_t desc_count, nr_vec = 0;
 		int err;
 
+		if (likely(dev->dequeue_zero_copy == 0) &&
+		    count - i >= PACKED_BATCH_SIZE &&
+		    virtio_dev_tx_batch_packed(dev, vq, mbuf_pool,
+					       &pkts[i]) == 0) {
+			i += PACKED_BATCH_SIZE;
+			continue;
+		}
+
 		if (unlikely(fill_vec_buf_packed(dev, vq,
 						vq->last_avail_idx, &desc_count,
 						buf_vec, &nr_vec,
@@ -1462,10 +2191,6 @@ virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 						VHOST_ACCESS_RO) < 0))
 			break;
 
-		if (likely(dev->dequeue_zero_copy == 0))
-			update_shadow_used_ring_packed(vq, buf_id, 0,
-					desc_count);
-
 		pkts[i] = rte_pktmbuf_alloc(mbuf_pool);
 		if (unlikely(pkts[i] == NULL)) {
 			RTE_LOG(ERR, VHOST_DATA,
@@ -1480,6 +2205,10 @@ virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			break;
 		}
 
+		if (likely(dev->dequeue_zero_copy == 0))
+			update_shadow_used_ring_packed(vq, buf_id, 0,
+					desc_count);
+
 		if (unlikely(dev->dequeue_zero_copy)) {
 			struct zcopy_mbuf *zmbuf;
 
@@ -1509,16 +2238,16 @@ virtio_dev_tx_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 			vq->last_avail_idx -= vq->size;
 			vq->avail_wrap_counter ^= 1;
 		}
+
+		i++;
 	}
 
 	if (likely(dev->dequeue_zero_copy == 0)) {
 		do_data_copy_dequeue(vq);
-		if (unlikely(i < count))
-			vq->shadow_used_idx = i;
-		if (likely(vq->shadow_used_idx)) {
+		if (likely(vq->shadow_used_idx))
 			flush_shadow_used_ring_packed(dev, vq);
+		if (likely(i))
 			vhost_vring_call_packed(dev, vq);
-		}
 	}
 
 	return i;